@@ -24,6 +24,14 @@ struct null_mutex
 #define MADARA_LOCK_TYPE madara::null_mutex
 #define MADARA_LOCK_LOCK lock
 #define MADARA_LOCK_UNLOCK unlock
+#elif defined _MADARA_SHARED_LOCK_
+#include "madara/utility/SharedRecursiveMutex.h"
+
+#define MADARA_LOCK_TYPE madara::utility::SharedRecursiveMutex
+#define MADARA_LOCK_LOCK lock
+#define MADARA_LOCK_UNLOCK unlock
+#define MADARA_READ_GUARD_TYPE \
+  madara::utility::SharedGuard<madara::utility::SharedRecursiveMutex>
 #else
 #define MADARA_LOCK_TYPE std::recursive_mutex
 #define MADARA_LOCK_LOCK lock
@@ -31,6 +39,12 @@ struct null_mutex
 #endif  // !_MADARA_NULL_LOCK_
 
 #define MADARA_GUARD_TYPE std::lock_guard<MADARA_LOCK_TYPE>
+
+// read-only sections may share the lock if the lock type supports it
+#ifndef MADARA_READ_GUARD_TYPE
+#define MADARA_READ_GUARD_TYPE MADARA_GUARD_TYPE
+#endif
+
 #define MADARA_CONDITION_TYPE std::condition_variable_any
 #define MADARA_CONDITION_NOTIFY_ONE notify_one
 #define MADARA_CONDITION_NOTIFY_ALL notify_all
@@ -0,0 +1,876 @@
+/* -*- C++ -*- */
+#ifndef _MADARA_EXPRESSION_BYTECODE_CPP_
+#define _MADARA_EXPRESSION_BYTECODE_CPP_
+
+#ifndef _MADARA_NO_KARL_
+
+#include <cmath>
+#include <sstream>
+
+#include "madara/expression/Bytecode.h"
+#include "madara/expression/VariableNode.h"
+#include "madara/knowledge/ThreadSafeContext.h"
+#include "madara/exceptions/UninitializedException.h"
+
+namespace madara
+{
+namespace expression
+{
+namespace
+{
+typedef knowledge::KnowledgeRecord KnowledgeRecord;
+typedef KnowledgeRecord::Integer Integer;
+typedef Bytecode::Register Register;
+
+/// default settings, which VariableNode uses to mark changes
+const knowledge::KnowledgeUpdateSettings default_settings;
+
+/// the value of an unboxed register as a double
+inline double real(const Register& reg)
+{
+  return reg.type == KnowledgeRecord::DOUBLE ? reg.real : (double)reg.integer;
+}
+
+/// true if an unboxed register is an integer type, including EMPTY
+inline bool integral(const Register& reg)
+{
+  return reg.type != KnowledgeRecord::DOUBLE;
+}
+
+/// KnowledgeRecord::is_true for an unboxed register
+inline bool truth(const Register& reg)
+{
+  if (reg.type == KnowledgeRecord::DOUBLE)
+    return reg.real < 0 || reg.real > 0;
+
+  return reg.integer != 0;
+}
+
+/// KnowledgeRecord::operator== for unboxed registers
+inline bool equal(const Register& lhs, const Register& rhs)
+{
+  if (lhs.type == KnowledgeRecord::EMPTY)
+    return !truth(rhs);
+  else if (integral(lhs) && integral(rhs))
+    return lhs.integer == rhs.integer;
+  else
+    return real(lhs) == real(rhs);
+}
+
+/// KnowledgeRecord::operator< for unboxed registers
+inline bool less(const Register& lhs, const Register& rhs)
+{
+  if (integral(lhs) && integral(rhs))
+    return lhs.integer < rhs.integer;
+  else
+    return real(lhs) < real(rhs);
+}
+
+/// KnowledgeRecord::operator<= for unboxed registers
+inline bool less_equal(const Register& lhs, const Register& rhs)
+{
+  if (integral(lhs) && integral(rhs))
+    return lhs.integer <= rhs.integer;
+  else
+    return real(lhs) <= real(rhs);
+}
+
+/// sets a register to an integer with no metadata
+inline void set_integer(Register& reg, Integer value)
+{
+  reg.type = KnowledgeRecord::INTEGER;
+  reg.integer = value;
+  reg.source = nullptr;
+}
+
+/// sets a register to a double with the metadata of source
+inline void set_real(
+    Register& reg, double value, const KnowledgeRecord* source = nullptr)
+{
+  reg.type = KnowledgeRecord::DOUBLE;
+  reg.real = value;
+  reg.source = source;
+}
+
+/// copies a record into a register, boxing it if it is not numeric
+inline void read(
+    Register& reg, KnowledgeRecord& box, const KnowledgeRecord& record)
+{
+  uint32_t type = record.has_history() ? Bytecode::BOXED : record.type();
+
+  if (type == KnowledgeRecord::INTEGER)
+  {
+    reg.type = type;
+    reg.integer = record.to_integer();
+  }
+  else if (type == KnowledgeRecord::DOUBLE)
+  {
+    reg.type = type;
+    reg.real = record.to_double();
+  }
+  else if (type == KnowledgeRecord::EMPTY)
+  {
+    reg.type = type;
+    reg.integer = 0;
+  }
+  else
+  {
+    reg.type = Bytecode::BOXED;
+    box = record;
+  }
+
+  reg.source = &record;
+}
+
+/// the record a register holds, as the tree would have it
+inline KnowledgeRecord to_record(
+    const Register& reg, const KnowledgeRecord& box)
+{
+  if (reg.type == Bytecode::BOXED)
+    return box;
+
+  KnowledgeRecord result;
+
+  if (reg.source)
+    result.copy_metadata(*reg.source);
+
+  if (reg.type == KnowledgeRecord::INTEGER)
+    result.set_value(reg.integer);
+  else if (reg.type == KnowledgeRecord::DOUBLE)
+    result.set_value(reg.real);
+
+  return result;
+}
+
+/// applies an operator to registers, as the tree's operators would
+inline void operate(const Bytecode::Instruction& i, Register* registers,
+    KnowledgeRecord* boxes)
+{
+  Register& dest = registers[i.dest];
+  const Register& lhs = registers[i.a];
+  const Register& rhs = registers[i.b];
+
+  switch (i.op)
+  {
+  case Bytecode::ADD:
+  case Bytecode::SUBTRACT:
+  case Bytecode::MULTIPLY:
+    if (lhs.type == Bytecode::BOXED || rhs.type == Bytecode::BOXED)
+    {
+      KnowledgeRecord left = to_record(lhs, boxes[i.a]);
+      KnowledgeRecord right = to_record(rhs, boxes[i.b]);
+
+      if (i.op == Bytecode::ADD)
+        boxes[i.dest] = left + right;
+      else if (i.op == Bytecode::SUBTRACT)
+        boxes[i.dest] = left - right;
+      else
+        boxes[i.dest] = left * right;
+
+      dest.type = Bytecode::BOXED;
+    }
+    else if (integral(lhs) && integral(rhs))
+    {
+      Integer value = i.op == Bytecode::ADD ?
+          lhs.integer + rhs.integer :
+          i.op == Bytecode::SUBTRACT ? lhs.integer - rhs.integer :
+          lhs.integer * rhs.integer;
+
+      // the result is a copy of the left operand
+      const KnowledgeRecord* source = lhs.source;
+      set_integer(dest, value);
+      dest.source = source;
+    }
+    else
+    {
+      double value = i.op == Bytecode::ADD ? real(lhs) + real(rhs) :
+          i.op == Bytecode::SUBTRACT ? real(lhs) - real(rhs) :
+          real(lhs) * real(rhs);
+
+      set_real(dest, value, lhs.source);
+    }
+    break;
+  case Bytecode::DIVIDE:
+    if (lhs.type == Bytecode::BOXED || rhs.type == Bytecode::BOXED)
+    {
+      boxes[i.dest] =
+          to_record(lhs, boxes[i.a]) / to_record(rhs, boxes[i.b]);
+      dest.type = Bytecode::BOXED;
+    }
+    else if (integral(lhs) && integral(rhs))
+    {
+      const KnowledgeRecord* source = lhs.source;
+
+      if (rhs.integer == 0)
+        set_real(dest, NAN, source);
+      else
+      {
+        set_integer(dest, lhs.integer / rhs.integer);
+        dest.source = source;
+      }
+    }
+    else
+    {
+      double denominator = real(rhs);
+      set_real(dest, denominator == 0 ? NAN : real(lhs) / denominator,
+          lhs.source);
+    }
+    break;
+  case Bytecode::MODULUS:
+    if (lhs.type == Bytecode::BOXED || rhs.type == Bytecode::BOXED)
+    {
+      boxes[i.dest] =
+          to_record(lhs, boxes[i.a]) % to_record(rhs, boxes[i.b]);
+      dest.type = Bytecode::BOXED;
+    }
+    else if (integral(lhs) && integral(rhs))
+    {
+      const KnowledgeRecord* source = lhs.source;
+
+      if (rhs.integer == 0)
+        set_real(dest, NAN, source);
+      else
+      {
+        set_integer(dest, lhs.integer % rhs.integer);
+        dest.source = source;
+      }
+    }
+    else
+    {
+      // a double modulus leaves the left operand as it is
+      dest = lhs;
+    }
+    break;
+  case Bytecode::EQUAL:
+  case Bytecode::NOT_EQUAL:
+  {
+    bool result;
+
+    if (lhs.type == Bytecode::BOXED || rhs.type == Bytecode::BOXED)
+      result = to_record(lhs, boxes[i.a]) == to_record(rhs, boxes[i.b]);
+    else
+      result = equal(lhs, rhs);
+
+    set_integer(dest, i.op == Bytecode::EQUAL ? result : !result);
+    break;
+  }
+  case Bytecode::LESS:
+  case Bytecode::LESS_EQUAL:
+  case Bytecode::GREATER:
+  case Bytecode::GREATER_EQUAL:
+  {
+    bool result;
+
+    if (lhs.type == Bytecode::BOXED || rhs.type == Bytecode::BOXED)
+    {
+      KnowledgeRecord left = to_record(lhs, boxes[i.a]);
+      KnowledgeRecord right = to_record(rhs, boxes[i.b]);
+
+      result = i.op == Bytecode::LESS ?
+          left < right :
+          i.op == Bytecode::LESS_EQUAL ? left <= right :
+          i.op == Bytecode::GREATER ? left > right : left >= right;
+    }
+    else
+    {
+      result = i.op == Bytecode::LESS ?
+          less(lhs, rhs) :
+          i.op == Bytecode::LESS_EQUAL ? less_equal(lhs, rhs) :
+          i.op == Bytecode::GREATER ? less(rhs, lhs) : less_equal(rhs, lhs);
+    }
+
+    set_integer(dest, result);
+    break;
+  }
+  case Bytecode::MINIMUM:
+  case Bytecode::MAXIMUM:
+  {
+    bool replace;
+
+    if (lhs.type == Bytecode::BOXED || rhs.type == Bytecode::BOXED)
+    {
+      KnowledgeRecord left = to_record(lhs, boxes[i.a]);
+      KnowledgeRecord right = to_record(rhs, boxes[i.b]);
+
+      replace = i.op == Bytecode::MINIMUM ? right < left : right > left;
+    }
+    else
+    {
+      replace = i.op == Bytecode::MINIMUM ? less(rhs, lhs) : less(lhs, rhs);
+    }
+
+    uint32_t source = replace ? i.b : i.a;
+
+    if (source != i.dest)
+    {
+      dest = registers[source];
+      if (dest.type == Bytecode::BOXED)
+        boxes[i.dest] = boxes[source];
+    }
+    break;
+  }
+  case Bytecode::NOT:
+    set_integer(dest,
+        lhs.type == Bytecode::BOXED ? !boxes[i.a] : !truth(lhs));
+    break;
+  case Bytecode::NEGATE:
+    if (lhs.type == Bytecode::BOXED)
+    {
+      boxes[i.dest] = -boxes[i.a];
+      dest.type = Bytecode::BOXED;
+    }
+    else
+    {
+      dest = lhs;
+      if (dest.type == KnowledgeRecord::INTEGER)
+        dest.integer = -dest.integer;
+      else if (dest.type == KnowledgeRecord::DOUBLE)
+        dest.real = -dest.real;
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+/// checks a read of a variable, as VariableNode::evaluate does
+inline void check_exists(const knowledge::VariableReference& ref,
+    const knowledge::KnowledgeUpdateSettings& settings)
+{
+  if (settings.exception_on_unitialized &&
+      !ref.get_record_unsafe()->exists())
+  {
+    std::stringstream buffer;
+    buffer << "madara::expression::VariableNode::evaluate: ";
+    buffer << "ERROR: settings do not allow reads of unset vars and ";
+    buffer << ref.get_name() << " is uninitialized";
+    throw exceptions::UninitializedException(buffer.str());
+  }
+}
+}
+
+Bytecode::Bytecode(knowledge::ThreadSafeContext& context) : context_(context)
+{
+}
+
+bool Bytecode::compile(const ComponentNode* root)
+{
+  int result = root->lower(*this);
+
+  if (result < 0)
+    return false;
+
+  // code that only evaluates subtrees is slower than the tree itself
+  bool native = false;
+
+  for (const Instruction& instruction : code_)
+  {
+    if (instruction.op != EVALUATE && instruction.op != MOVE &&
+        instruction.op != CONSTANT)
+    {
+      native = true;
+      break;
+    }
+  }
+
+  if (!native)
+    return false;
+
+  result_ = result;
+  boxes_.resize(registers_.size());
+
+  return true;
+}
+
+size_t Bytecode::size(void) const
+{
+  return code_.size();
+}
+
+knowledge::KnowledgeRecord Bytecode::run(
+    const knowledge::KnowledgeUpdateSettings& settings)
+{
+  // a function called from the bytecode may evaluate it again, so nested
+  // runs need registers of their own
+  if (running_)
+  {
+    std::vector<Register> registers(registers_.size());
+    std::vector<KnowledgeRecord> boxes(boxes_.size());
+
+    return execute(settings, registers.data(), boxes.data());
+  }
+
+  struct Running
+  {
+    bool& flag;
+    ~Running()
+    {
+      flag = false;
+    }
+  } running{running_};
+
+  running_ = true;
+
+  return execute(settings, registers_.data(), boxes_.data());
+}
+
+knowledge::KnowledgeRecord Bytecode::execute(
+    const knowledge::KnowledgeUpdateSettings& settings, Register* registers,
+    KnowledgeRecord* boxes)
+{
+  const Instruction* begin = code_.data();
+  const Instruction* end = begin + code_.size();
+
+  for (const Instruction* i = begin; i < end; ++i)
+  {
+    Register& dest = registers[i->dest];
+
+    switch (i->op)
+    {
+    case LOAD:
+    {
+      const knowledge::VariableReference& ref = slots_[i->a];
+      check_exists(ref, settings);
+      read(dest, boxes[i->dest], *ref.get_record_unsafe());
+      break;
+    }
+    case CONSTANT:
+      dest = constants_[i->a];
+      if (dest.type == Bytecode::BOXED)
+        boxes[i->dest] = constant_records_[dest.integer];
+      break;
+    case MOVE:
+      if (i->dest != i->a)
+      {
+        dest = registers[i->a];
+        if (dest.type == Bytecode::BOXED)
+          boxes[i->dest] = boxes[i->a];
+      }
+      break;
+    case EVALUATE:
+      boxes[i->dest] = nodes_[i->a]->evaluate(settings);
+      dest.type = Bytecode::BOXED;
+      break;
+    case STORE:
+      store(i->a, registers[i->b], boxes[i->b], settings);
+      if (i->dest != i->b)
+      {
+        dest = registers[i->b];
+        if (dest.type == Bytecode::BOXED)
+          boxes[i->dest] = boxes[i->b];
+      }
+      break;
+    case PREINCREMENT:
+    case PREDECREMENT:
+    case POSTINCREMENT:
+    case POSTDECREMENT:
+    {
+      // as VariableNode::inc and dec do, with the value read before by
+      // a post increment or decrement
+      const knowledge::VariableReference& ref = slots_[i->a];
+      KnowledgeRecord* record = ref.get_record_unsafe();
+
+      if (i->op == POSTINCREMENT || i->op == POSTDECREMENT)
+      {
+        check_exists(ref, settings);
+        read(dest, boxes[i->dest], *record);
+      }
+
+      if (settings.always_overwrite ||
+          record->write_quality >= record->quality)
+      {
+        if (record->write_quality != record->quality)
+          record->quality = record->write_quality;
+
+        if (i->op == PREINCREMENT || i->op == POSTINCREMENT)
+          ++(*record);
+        else
+          --(*record);
+
+        context_.mark_and_signal(ref, default_settings);
+      }
+
+      if (i->op == PREINCREMENT || i->op == PREDECREMENT)
+        read(dest, boxes[i->dest], *record);
+      break;
+    }
+    case ADD:
+    case SUBTRACT:
+    case MULTIPLY:
+    case DIVIDE:
+    case MODULUS:
+    case EQUAL:
+    case NOT_EQUAL:
+    case LESS:
+    case LESS_EQUAL:
+    case GREATER:
+    case GREATER_EQUAL:
+    case MINIMUM:
+    case MAXIMUM:
+    case NOT:
+    case NEGATE:
+      operate(*i, registers, boxes);
+      break;
+    case JUMP:
+      i = begin + i->b - 1;
+      break;
+    case JUMP_IF_FALSE:
+    case JUMP_IF_TRUE:
+    {
+      const Register& condition = registers[i->a];
+      bool value = condition.type == Bytecode::BOXED ?
+          boxes[i->a].is_true() :
+          truth(condition);
+
+      if (value == (i->op == JUMP_IF_TRUE))
+        i = begin + i->b - 1;
+      break;
+    }
+    case COUNT:
+      ++dest.integer;
+      break;
+    }
+  }
+
+  return to_record(registers[result_], boxes[result_]);
+}
+
+void Bytecode::store(uint32_t slot, const Register& reg,
+    const knowledge::KnowledgeRecord& box,
+    const knowledge::KnowledgeUpdateSettings& settings)
+{
+  // as VariableNode::set does, with the value copied before the quality
+  // of the variable changes
+  const knowledge::VariableReference& ref = slots_[slot];
+  KnowledgeRecord* record = ref.get_record_unsafe();
+  KnowledgeRecord value = to_record(reg, box);
+
+  if (!settings.always_overwrite && record->write_quality < record->quality)
+    return;
+
+  if (record->write_quality != record->quality)
+    record->quality = record->write_quality;
+
+  *record = std::move(value);
+
+  context_.mark_and_signal(ref, default_settings);
+}
+
+int Bytecode::lower(const ComponentNode* node)
+{
+  if (!node)
+    return constant(KnowledgeRecord());
+
+  int reg = node->lower(*this);
+
+  if (reg < 0)
+  {
+    reg = allocate();
+    nodes_.push_back(const_cast<ComponentNode*>(node));
+    emit(EVALUATE, reg, (int)nodes_.size() - 1);
+  }
+
+  return reg;
+}
+
+int Bytecode::constant(const knowledge::KnowledgeRecord& value)
+{
+  int dest = allocate();
+  emit(CONSTANT, dest, intern(value));
+  return dest;
+}
+
+int Bytecode::load(const knowledge::VariableReference& ref)
+{
+  int dest = allocate();
+  emit(LOAD, dest, slot(ref));
+  return dest;
+}
+
+int Bytecode::slot(const knowledge::VariableReference& ref)
+{
+  const KnowledgeRecord* record = ref.get_record_unsafe();
+  auto found = slot_index_.find(record);
+
+  if (found != slot_index_.end())
+    return found->second;
+
+  slots_.push_back(ref);
+  slot_index_[record] = (int)slots_.size() - 1;
+
+  return (int)slots_.size() - 1;
+}
+
+int Bytecode::unary(Opcode op, const ComponentNode* node)
+{
+  int dest = allocate();
+  emit(op, dest, lower(node));
+  release(dest);
+  return dest;
+}
+
+int Bytecode::binary(
+    Opcode op, const ComponentNode* left, const ComponentNode* right)
+{
+  int dest = allocate();
+  int lhs = lower(left);
+  int rhs = lower(right);
+  emit(op, dest, lhs, rhs);
+  release(dest);
+  return dest;
+}
+
+int Bytecode::fold(Opcode op, const ComponentNodes& nodes)
+{
+  if (nodes.empty())
+    return constant(KnowledgeRecord());
+
+  int dest = allocate();
+
+  for (ComponentNodes::const_iterator i = nodes.begin(); i != nodes.end();
+       ++i)
+  {
+    int value = lower(*i);
+
+    if (i == nodes.begin())
+      emit(MOVE, dest, value);
+    else
+      emit(op, dest, dest, value);
+
+    release(dest);
+  }
+
+  return dest;
+}
+
+int Bytecode::sequence(const ComponentNodes& nodes)
+{
+  if (nodes.empty())
+    return constant(KnowledgeRecord());
+
+  int dest = allocate();
+
+  for (ComponentNodes::const_iterator i = nodes.begin(); i != nodes.end();
+       ++i)
+  {
+    int value = lower(*i);
+
+    if (i + 1 == nodes.end())
+      emit(MOVE, dest, value);
+
+    release(dest);
+  }
+
+  return dest;
+}
+
+int Bytecode::logical_and(const ComponentNodes& nodes)
+{
+  int dest = allocate();
+  std::vector<size_t> jumps;
+
+  for (const ComponentNode* node : nodes)
+  {
+    jumps.push_back(emit(JUMP_IF_FALSE, dest, lower(node)));
+    release(dest);
+  }
+
+  emit(CONSTANT, dest, intern(KnowledgeRecord(1)));
+  size_t done = emit(JUMP, dest);
+
+  for (size_t jump : jumps)
+    land(jump);
+
+  emit(CONSTANT, dest, intern(KnowledgeRecord(0)));
+  land(done);
+
+  return dest;
+}
+
+int Bytecode::logical_or(const ComponentNodes& nodes)
+{
+  int dest = allocate();
+  std::vector<size_t> jumps;
+
+  for (const ComponentNode* node : nodes)
+  {
+    jumps.push_back(emit(JUMP_IF_TRUE, dest, lower(node)));
+    release(dest);
+  }
+
+  emit(CONSTANT, dest, intern(KnowledgeRecord()));
+  size_t done = emit(JUMP, dest);
+
+  for (size_t jump : jumps)
+    land(jump);
+
+  emit(CONSTANT, dest, intern(KnowledgeRecord(1)));
+  land(done);
+
+  return dest;
+}
+
+int Bytecode::implies(const ComponentNode* left, const ComponentNode* right)
+{
+  int dest = allocate();
+  emit(MOVE, dest, lower(left));
+  release(dest);
+
+  size_t skip = emit(JUMP_IF_FALSE, dest, dest);
+  lower(right);
+  release(dest);
+  land(skip);
+
+  return dest;
+}
+
+int Bytecode::loop(const ComponentNode* precondition,
+    const ComponentNode* condition, const ComponentNode* postcondition,
+    const ComponentNode* body)
+{
+  int dest = allocate();
+
+  lower(precondition);
+  release(dest);
+
+  emit(CONSTANT, dest, intern(KnowledgeRecord(0)));
+
+  size_t start = code_.size();
+  size_t done = emit(JUMP_IF_FALSE, dest, lower(condition));
+  release(dest);
+
+  lower(body);
+  release(dest);
+  lower(postcondition);
+  release(dest);
+
+  emit(COUNT, dest);
+  emit(JUMP, dest, 0, (int)start);
+  land(done);
+
+  return dest;
+}
+
+int Bytecode::modify(Opcode op, const VariableNode* var)
+{
+  int variable = var ? var->slot(*this) : -1;
+
+  if (variable < 0)
+    return -1;
+
+  int dest = allocate();
+  emit(op, dest, variable);
+  return dest;
+}
+
+int Bytecode::assign(const VariableNode* var, const ComponentNode* rhs)
+{
+  int variable = var ? var->slot(*this) : -1;
+
+  if (variable < 0)
+    return -1;
+
+  int dest = allocate();
+  emit(STORE, dest, variable, lower(rhs));
+  release(dest);
+  return dest;
+}
+
+int Bytecode::compound(Opcode op, const VariableNode* var,
+    const ComponentNode* rhs, const knowledge::KnowledgeRecord& value)
+{
+  int variable = var ? var->slot(*this) : -1;
+
+  if (variable < 0)
+    return -1;
+
+  int dest = allocate();
+  int operand = rhs ? lower(rhs) : constant(value);
+
+  emit(LOAD, dest, variable);
+  emit(op, dest, dest, operand);
+  emit(STORE, dest, variable, dest);
+  release(dest);
+  return dest;
+}
+
+int Bytecode::compare(Opcode op, const VariableNode* var,
+    const ComponentNode* rhs, const knowledge::KnowledgeRecord& value)
+{
+  int variable = var ? var->slot(*this) : -1;
+
+  if (variable < 0)
+    return -1;
+
+  int dest = allocate();
+  emit(LOAD, dest, variable);
+  emit(op, dest, dest, rhs ? lower(rhs) : constant(value));
+  release(dest);
+  return dest;
+}
+
+int Bytecode::intern(const knowledge::KnowledgeRecord& value)
+{
+  Register reg;
+  reg.source = nullptr;
+
+  uint32_t type = value.has_history() ? BOXED : value.type();
+
+  if (type == KnowledgeRecord::INTEGER || type == KnowledgeRecord::EMPTY)
+  {
+    reg.type = type;
+    reg.integer = value.to_integer();
+  }
+  else if (type == KnowledgeRecord::DOUBLE)
+  {
+    reg.type = type;
+    reg.real = value.to_double();
+  }
+  else
+  {
+    reg.type = Bytecode::BOXED;
+    reg.integer = (Integer)constant_records_.size();
+    constant_records_.push_back(value);
+  }
+
+  constants_.push_back(reg);
+  return (int)constants_.size() - 1;
+}
+
+size_t Bytecode::emit(Opcode op, int dest, int a, int b)
+{
+  Instruction instruction;
+  instruction.op = op;
+  instruction.dest = (uint32_t)dest;
+  instruction.a = (uint32_t)a;
+  instruction.b = (uint32_t)b;
+
+  code_.push_back(instruction);
+  return code_.size() - 1;
+}
+
+void Bytecode::land(size_t jump)
+{
+  code_[jump].b = (uint32_t)code_.size();
+}
+
+int Bytecode::allocate(void)
+{
+  int reg = top_++;
+
+  if ((size_t)top_ > registers_.size())
+    registers_.resize(top_);
+
+  return reg;
+}
+
+void Bytecode::release(int reg)
+{
+  top_ = reg + 1;
+}
+}
+}
+
+#endif  // _MADARA_NO_KARL_
+
+#endif  // _MADARA_EXPRESSION_BYTECODE_CPP_
@@ -0,0 +1,386 @@
+/* -*- C++ -*- */
+#ifndef _MADARA_EXPRESSION_BYTECODE_H_
+#define _MADARA_EXPRESSION_BYTECODE_H_
+
+#ifndef _MADARA_NO_KARL_
+
+/**
+ * @file Bytecode.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the Bytecode class, which evaluates a pruned
+ * expression tree from a flat list of instructions
+ **/
+
+#include <vector>
+#include <map>
+#include "madara/knowledge/KnowledgeRecord.h"
+#include "madara/knowledge/KnowledgeUpdateSettings.h"
+#include "madara/knowledge/VariableReference.h"
+#include "madara/expression/ComponentNode.h"
+
+namespace madara
+{
+namespace knowledge
+{
+class ThreadSafeContext;
+}
+
+namespace expression
+{
+class VariableNode;
+
+/**
+ * @class Bytecode
+ * @brief A pruned expression tree lowered into a flat list of instructions
+ *        over a file of registers. Registers hold integers and doubles
+ *        directly, and variables are read and written through references
+ *        that are resolved when the bytecode is built. Values that are
+ *        neither, e.g., strings or arrays, are kept in KnowledgeRecords and
+ *        handled with the same operators as the tree, and nodes that
+ *        cannot be lowered, e.g., function calls, are evaluated as trees
+ *        from the bytecode, so results match tree evaluation.
+ *
+ *        Nodes lower themselves through ComponentNode::lower, using the
+ *        helpers below.
+ **/
+class Bytecode
+{
+public:
+  /**
+   * Instructions. Each writes register dest from registers a and b, except:
+   * LOAD reads the variable in slot a, CONSTANT reads constant a and
+   * EVALUATE evaluates tree node a. STORE assigns b to the variable in slot
+   * a and to dest. The increments and decrements modify the variable in
+   * slot a. MINIMUM and MAXIMUM keep a unless b is less or greater. JUMP,
+   * JUMP_IF_FALSE and JUMP_IF_TRUE continue at instruction b, the latter
+   * two depending on a. COUNT increments the integer in dest.
+   **/
+  enum Opcode : uint32_t
+  {
+    LOAD,
+    CONSTANT,
+    MOVE,
+    EVALUATE,
+    STORE,
+    PREINCREMENT,
+    PREDECREMENT,
+    POSTINCREMENT,
+    POSTDECREMENT,
+    ADD,
+    SUBTRACT,
+    MULTIPLY,
+    DIVIDE,
+    MODULUS,
+    EQUAL,
+    NOT_EQUAL,
+    LESS,
+    LESS_EQUAL,
+    GREATER,
+    GREATER_EQUAL,
+    MINIMUM,
+    MAXIMUM,
+    NOT,
+    NEGATE,
+    JUMP,
+    JUMP_IF_FALSE,
+    JUMP_IF_TRUE,
+    COUNT
+  };
+
+  /// a single instruction
+  struct Instruction
+  {
+    Opcode op;
+    uint32_t dest;
+    uint32_t a;
+    uint32_t b;
+  };
+
+  /// a register type for values kept in a KnowledgeRecord
+  static const uint32_t BOXED = 0xffffffff;
+
+  /**
+   * A register. A copied record keeps the quality, clock and toi of its
+   * source, so a register also points to the record its value came from.
+   **/
+  struct Register
+  {
+    /// KnowledgeRecord::EMPTY, INTEGER or DOUBLE, or BOXED
+    uint32_t type;
+
+    union
+    {
+      knowledge::KnowledgeRecord::Integer integer;
+      double real;
+    };
+
+    /// the record whose metadata the value has, or null if none
+    const knowledge::KnowledgeRecord* source;
+  };
+
+  /**
+   * Constructor
+   * @param  context   the context of the variables in the tree
+   **/
+  Bytecode(knowledge::ThreadSafeContext& context);
+
+  /**
+   * Lowers an expression tree
+   * @param  root   the root of the tree, which must outlive the bytecode
+   * @return true if the root could be lowered into code that does more
+   *         than evaluate subtrees. If not, the tree should be evaluated.
+   **/
+  bool compile(const ComponentNode* root);
+
+  /**
+   * Evaluates the bytecode. The caller must hold the context's lock.
+   * @param  settings   settings for evaluating the expression
+   * @return the value of the expression
+   **/
+  knowledge::KnowledgeRecord run(
+      const knowledge::KnowledgeUpdateSettings& settings);
+
+  /**
+   * Gets the number of instructions
+   * @return the instructions in the bytecode
+   **/
+  size_t size(void) const;
+
+  /**
+   * Lowers a node, or adds an instruction to evaluate it as a tree if it
+   * cannot be lowered
+   * @param  node   the node
+   * @return the register holding the value of the node
+   **/
+  int lower(const ComponentNode* node);
+
+  /**
+   * Lowers a constant
+   * @param  value   the constant
+   * @return the register holding the constant
+   **/
+  int constant(const knowledge::KnowledgeRecord& value);
+
+  /**
+   * Lowers a read of a variable
+   * @param  ref   the variable
+   * @return the register holding the value of the variable
+   **/
+  int load(const knowledge::VariableReference& ref);
+
+  /**
+   * Gets the slot of a variable, adding it if necessary
+   * @param  ref   the variable
+   * @return the slot of the variable
+   **/
+  int slot(const knowledge::VariableReference& ref);
+
+  /**
+   * Lowers an operator with one operand
+   * @param  op     the operator
+   * @param  node   the operand
+   * @return the register holding the result
+   **/
+  int unary(Opcode op, const ComponentNode* node);
+
+  /**
+   * Lowers an operator with two operands
+   * @param  op      the operator
+   * @param  left    the left operand
+   * @param  right   the right operand
+   * @return the register holding the result
+   **/
+  int binary(Opcode op, const ComponentNode* left, const ComponentNode* right);
+
+  /**
+   * Lowers an operator applied from left to right over a list of operands
+   * @param  op      the operator
+   * @param  nodes   the operands
+   * @return the register holding the result
+   **/
+  int fold(Opcode op, const ComponentNodes& nodes);
+
+  /**
+   * Lowers a list of nodes whose value is that of the last
+   * @param  nodes   the nodes
+   * @return the register holding the result
+   **/
+  int sequence(const ComponentNodes& nodes);
+
+  /**
+   * Lowers a logical and, which is 1 if every node is true and 0 at the
+   * first node that is not
+   * @param  nodes   the nodes
+   * @return the register holding the result
+   **/
+  int logical_and(const ComponentNodes& nodes);
+
+  /**
+   * Lowers a logical or, which is 1 at the first node that is true and
+   * an empty record if none are
+   * @param  nodes   the nodes
+   * @return the register holding the result
+   **/
+  int logical_or(const ComponentNodes& nodes);
+
+  /**
+   * Lowers an implication, which evaluates the right node only if the left
+   * node is true, and is the value of the left node
+   * @param  left    the condition
+   * @param  right   the node to evaluate if the condition is true
+   * @return the register holding the result
+   **/
+  int implies(const ComponentNode* left, const ComponentNode* right);
+
+  /**
+   * Lowers a for loop, whose value is the number of times the body ran
+   * @param  precondition    evaluated once before the loop
+   * @param  condition       the loop runs while this is true
+   * @param  postcondition   evaluated after each run of the body
+   * @param  body            the body of the loop
+   * @return the register holding the result
+   **/
+  int loop(const ComponentNode* precondition, const ComponentNode* condition,
+      const ComponentNode* postcondition, const ComponentNode* body);
+
+  /**
+   * Lowers an increment or decrement of a variable
+   * @param  op    PREINCREMENT, PREDECREMENT, POSTINCREMENT or POSTDECREMENT
+   * @param  var   the variable
+   * @return the register holding the result, or -1 if the variable cannot
+   *         be lowered
+   **/
+  int modify(Opcode op, const VariableNode* var);
+
+  /**
+   * Lowers an assignment to a variable
+   * @param  var   the variable
+   * @param  rhs   the value to assign
+   * @return the register holding the result, or -1 if the variable cannot
+   *         be lowered
+   **/
+  int assign(const VariableNode* var, const ComponentNode* rhs);
+
+  /**
+   * Lowers an operator applied to a variable and a value whose result is
+   * assigned to the variable, e.g., +=. The value is evaluated first.
+   * @param  op       the operator
+   * @param  var      the variable
+   * @param  rhs      the value, or null to use @a value
+   * @param  value    the value if rhs is null
+   * @return the register holding the result, or -1 if the variable cannot
+   *         be lowered
+   **/
+  int compound(Opcode op, const VariableNode* var, const ComponentNode* rhs,
+      const knowledge::KnowledgeRecord& value);
+
+  /**
+   * Lowers a comparison of a variable with a value. The variable is read
+   * first.
+   * @param  op       the comparison
+   * @param  var      the variable
+   * @param  rhs      the value, or null to use @a value
+   * @param  value    the value if rhs is null
+   * @return the register holding the result, or -1 if the variable cannot
+   *         be lowered
+   **/
+  int compare(Opcode op, const VariableNode* var, const ComponentNode* rhs,
+      const knowledge::KnowledgeRecord& value);
+
+private:
+  /**
+   * Runs the instructions
+   * @param  settings    settings for evaluating the expression
+   * @param  registers   the register file
+   * @param  boxes       the values of boxed registers
+   * @return the value of the expression
+   **/
+  knowledge::KnowledgeRecord execute(
+      const knowledge::KnowledgeUpdateSettings& settings, Register* registers,
+      knowledge::KnowledgeRecord* boxes);
+
+  /**
+   * Assigns a register to a variable, as VariableNode::set does
+   * @param  slot       the slot of the variable
+   * @param  reg        the register
+   * @param  box        the value of the register if it is boxed
+   * @param  settings   settings for evaluating the expression
+   **/
+  void store(uint32_t slot, const Register& reg,
+      const knowledge::KnowledgeRecord& box,
+      const knowledge::KnowledgeUpdateSettings& settings);
+
+  /**
+   * Adds a constant
+   * @param  value   the constant
+   * @return the index of the constant
+   **/
+  int intern(const knowledge::KnowledgeRecord& value);
+
+  /**
+   * Adds an instruction
+   * @return the index of the instruction
+   **/
+  size_t emit(Opcode op, int dest, int a = 0, int b = 0);
+
+  /**
+   * Points a jump at the next instruction
+   * @param  jump   the index of the jump
+   **/
+  void land(size_t jump);
+
+  /**
+   * Allocates a register above those in use
+   * @return the register
+   **/
+  int allocate(void);
+
+  /**
+   * Frees every register above one
+   * @param  reg   the last register still in use
+   **/
+  void release(int reg);
+
+  /// the context of the variables
+  knowledge::ThreadSafeContext& context_;
+
+  /// the instructions
+  std::vector<Instruction> code_;
+
+  /// the variables read or written
+  std::vector<knowledge::VariableReference> slots_;
+
+  /// the slots of the variables, by record
+  std::map<const knowledge::KnowledgeRecord*, int> slot_index_;
+
+  /// the constants
+  std::vector<Register> constants_;
+
+  /// the values of boxed constants
+  std::vector<knowledge::KnowledgeRecord> constant_records_;
+
+  /// nodes evaluated as trees
+  std::vector<ComponentNode*> nodes_;
+
+  /// registers in use while lowering
+  int top_ = 0;
+
+  /// the register file
+  std::vector<Register> registers_;
+
+  /// the values of boxed registers
+  std::vector<knowledge::KnowledgeRecord> boxes_;
+
+  /// the register holding the value of the root
+  int result_ = 0;
+
+  /// true while running, e.g., if a function evaluates us again
+  bool running_ = false;
+};
+}
+}
+
+#endif  // _MADARA_NO_KARL_
+
+#endif  // _MADARA_EXPRESSION_BYTECODE_H_
@@ -50,6 +50,17 @@ void madara::expression::ComponentNode::set_logger(logger::Logger& logger)
   logger_ = &logger;
 }
 
+bool madara::expression::ComponentNode::dependencies(
+    std::vector<const madara::knowledge::KnowledgeRecord*>&) const
+{
+  return false;
+}
+
+int madara::expression::ComponentNode::lower(Bytecode&) const
+{
+  return -1;
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* _COMPONENT_NODE_CPP_ */
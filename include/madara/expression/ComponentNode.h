@@ -6,6 +6,7 @@
 
 #include <string>
 #include <deque>
+#include <vector>
 #include <stdexcept>
 #include "madara/knowledge/KnowledgeRecord.h"
 #include "madara/knowledge/KnowledgeUpdateSettings.h"
@@ -22,8 +23,9 @@ class ThreadSafeContext;
 
 namespace expression
 {
-// Forward declaration.
+// Forward declarations.
 class Visitor;
+class Bytecode;
 
 /**
  * @class ComponentNode
@@ -85,6 +87,28 @@ public:
    **/
   virtual void accept(Visitor& visitor) const;
 
+  /**
+   * Adds the records this node reads to a list. Nodes that may read
+   * records that are not known until they are evaluated, e.g., function
+   * calls or variables with expanded names, return false, since any
+   * change could affect their value.
+   * @param  records   the list of records read
+   * @return false if the node may read records that are not known until
+   *         it is evaluated
+   **/
+  virtual bool dependencies(
+      std::vector<const madara::knowledge::KnowledgeRecord*>& records) const;
+
+  /**
+   * Lowers the node into bytecode. Nodes that cannot be lowered return -1
+   * without adding anything to the bytecode, and are evaluated as trees
+   * when the bytecode runs.
+   * @param  bytecode   the bytecode being built
+   * @return the register holding the value of the node, or -1 if the node
+   *         cannot be lowered
+   **/
+  virtual int lower(Bytecode& bytecode) const;
+
   /**
    * Sets the logger for printing errors and debugging info
    * @param  logger the logger to use
@@ -10,6 +10,7 @@
 #include "madara/expression/ComponentNode.h"
 #include "madara/expression/Visitor.h"
 #include "madara/expression/CompositeAddNode.h"
+#include "madara/expression/Bytecode.h"
 #include "madara/expression/LeafNode.h"
 
 // Ctor
@@ -98,6 +99,11 @@ void madara::expression::CompositeAddNode::accept(Visitor& visitor) const
   visitor.visit(*this);
 }
 
+int madara::expression::CompositeAddNode::lower(Bytecode& bytecode) const
+{
+  return bytecode.fold(Bytecode::ADD, nodes_);
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* _ADD_NODE_CPP_ */
@@ -10,6 +10,7 @@
 #include "madara/expression/ComponentNode.h"
 #include "madara/expression/Visitor.h"
 #include "madara/expression/CompositeAndNode.h"
+#include "madara/expression/Bytecode.h"
 #include "madara/expression/LeafNode.h"
 
 // Ctor
@@ -94,6 +95,11 @@ void madara::expression::CompositeAndNode::accept(Visitor& visitor) const
   visitor.visit(*this);
 }
 
+int madara::expression::CompositeAndNode::lower(Bytecode& bytecode) const
+{
+  return bytecode.logical_and(nodes_);
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* COMPOSITE_AND_NODE_CPP */
@@ -66,6 +66,17 @@ void madara::expression::CompositeArrayReference::accept(Visitor& visitor) const
   visitor.visit(*this);
 }
 
+bool madara::expression::CompositeArrayReference::dependencies(
+    std::vector<const madara::knowledge::KnowledgeRecord*>& records) const
+{
+  // an expanded name is only known when the node is evaluated
+  if (key_expansion_necessary_)
+    return false;
+
+  records.push_back(ref_.get_record_unsafe());
+  return right_ == 0 || right_->dependencies(records);
+}
+
 madara::knowledge::KnowledgeRecord
 madara::expression::CompositeArrayReference::item() const
 {
@@ -281,23 +292,9 @@ int madara::expression::CompositeArrayReference::set(
 
   if (ref_.is_valid())
   {
-    auto record = ref_.get_record_unsafe();
-
-    // notice that we assume the context is locked
-    // check if we have the appropriate write quality
-    if (!settings.always_overwrite && record->write_quality < record->quality)
-      return -2;
-
-    // cheaper to read than write, so check to see if
-    // we actually need to update quality and status
-    if (record->write_quality != record->quality)
-      record->quality = record->write_quality;
-
-    record->set_index(index, value);
-
-    context_.mark_and_signal(ref_);
-
-    return 0;
+    // notice that we assume the context is locked. The context stamps
+    // the change, so that transports can tell which indices changed.
+    return context_.set_index_unsafe(ref_, index, value, settings);
   }
   else
     return context_.set_index(expand_key(), index, value, settings);
@@ -310,23 +307,9 @@ int madara::expression::CompositeArrayReference::set(
 
   if (ref_.is_valid())
   {
-    auto record = ref_.get_record_unsafe();
-
-    // notice that we assume the context is locked
-    // check if we have the appropriate write quality
-    if (!settings.always_overwrite && record->write_quality < record->quality)
-      return -2;
-
-    // cheaper to read than write, so check to see if
-    // we actually need to update quality and status
-    if (record->write_quality != record->quality)
-      record->quality = record->write_quality;
-
-    record->set_index(index, value);
-
-    context_.mark_and_signal(ref_);
-
-    return 0;
+    // notice that we assume the context is locked. The context stamps
+    // the change, so that transports can tell which indices changed.
+    return context_.set_index_unsafe(ref_, index, value, settings);
   }
   else
     return context_.set_index(expand_key(), index, value, settings);
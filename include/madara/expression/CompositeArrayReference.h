@@ -86,6 +86,11 @@ public:
   /// Define the @a accept() operation used for the Visitor pattern.
   virtual void accept(Visitor& visitor) const;
 
+  /// Adds the records this node reads to records, returning false if it
+  /// may read records that are only known when it is evaluated
+  virtual bool dependencies(
+      std::vector<const madara::knowledge::KnowledgeRecord*>& records) const;
+
   /**
    * Retrieves the underlying knowledge::KnowledgeRecord in the context (useful
    *for system calls).
@@ -10,6 +10,7 @@
 #include "madara/expression/ComponentNode.h"
 #include "madara/expression/Visitor.h"
 #include "madara/expression/CompositeAssignmentNode.h"
+#include "madara/expression/Bytecode.h"
 #include "madara/expression/LeafNode.h"
 
 // Ctor
@@ -123,6 +124,11 @@ void madara::expression::CompositeAssignmentNode::accept(Visitor& visitor) const
   visitor.visit(*this);
 }
 
+int madara::expression::CompositeAssignmentNode::lower(Bytecode& bytecode) const
+{
+  return bytecode.assign(var_, right_);
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* _ASSIGNMENT_NODE_CPP_ */
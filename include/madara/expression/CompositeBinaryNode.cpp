@@ -26,6 +26,13 @@ madara::expression::CompositeBinaryNode::left(void) const
   return left_;
 }
 
+bool madara::expression::CompositeBinaryNode::dependencies(
+    std::vector<const madara::knowledge::KnowledgeRecord*>& records) const
+{
+  return (left_ == 0 || left_->dependencies(records)) &&
+         (right_ == 0 || right_->dependencies(records));
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* _COMPOSITE_LR_NODE_CPP_ */
@@ -11,6 +11,7 @@
 #include "madara/expression/ComponentNode.h"
 #include "madara/expression/Visitor.h"
 #include "madara/expression/CompositeBothNode.h"
+#include "madara/expression/Bytecode.h"
 #include "madara/expression/LeafNode.h"
 
 // Ctor
@@ -83,6 +84,11 @@ void madara::expression::CompositeBothNode::accept(Visitor& visitor) const
   visitor.visit(*this);
 }
 
+int madara::expression::CompositeBothNode::lower(Bytecode& bytecode) const
+{
+  return bytecode.fold(Bytecode::MAXIMUM, nodes_);
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* _COMPOSITE_BOTH_NODE_CPP */
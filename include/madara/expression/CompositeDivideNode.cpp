@@ -9,6 +9,7 @@
 
 #include "madara/expression/CompositeBinaryNode.h"
 #include "madara/expression/CompositeDivideNode.h"
+#include "madara/expression/Bytecode.h"
 #include "madara/expression/Visitor.h"
 #include "madara/expression/LeafNode.h"
 
@@ -109,6 +110,11 @@ void madara::expression::CompositeDivideNode::accept(Visitor& visitor) const
   visitor.visit(*this);
 }
 
+int madara::expression::CompositeDivideNode::lower(Bytecode& bytecode) const
+{
+  return bytecode.binary(Bytecode::DIVIDE, left_, right_);
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* _DIVIDE_NODE_CPP_ */
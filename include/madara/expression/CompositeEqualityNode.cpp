@@ -10,6 +10,7 @@
 #include "madara/expression/ComponentNode.h"
 #include "madara/expression/Visitor.h"
 #include "madara/expression/CompositeEqualityNode.h"
+#include "madara/expression/Bytecode.h"
 #include "madara/expression/LeafNode.h"
 
 // Ctor
@@ -100,6 +101,11 @@ void madara::expression::CompositeEqualityNode::accept(Visitor& visitor) const
   visitor.visit(*this);
 }
 
+int madara::expression::CompositeEqualityNode::lower(Bytecode& bytecode) const
+{
+  return bytecode.binary(Bytecode::EQUAL, left_, right_);
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* _EQUALITY_NODE_CPP_ */
@@ -10,6 +10,7 @@
 #include "madara/expression/CompositeUnaryNode.h"
 #include "madara/expression/Visitor.h"
 #include "madara/expression/CompositeForLoop.h"
+#include "madara/expression/Bytecode.h"
 #include "madara/expression/LeafNode.h"
 #include "madara/expression/CompositeAssignmentNode.h"
 
@@ -92,6 +93,20 @@ void madara::expression::CompositeForLoop::accept(Visitor& visitor) const
   visitor.visit(*this);
 }
 
+bool madara::expression::CompositeForLoop::dependencies(
+    std::vector<const madara::knowledge::KnowledgeRecord*>& records) const
+{
+  return (precondition_ == 0 || precondition_->dependencies(records)) &&
+         (condition_ == 0 || condition_->dependencies(records)) &&
+         (postcondition_ == 0 || postcondition_->dependencies(records)) &&
+         (body_ == 0 || body_->dependencies(records));
+}
+
+int madara::expression::CompositeForLoop::lower(Bytecode& bytecode) const
+{
+  return bytecode.loop(precondition_, condition_, postcondition_, body_);
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* _FOR_LOOP_CPP_ */
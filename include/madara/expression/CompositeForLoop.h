@@ -67,6 +67,23 @@ public:
    **/
   virtual void accept(Visitor& visitor) const;
 
+  /**
+   * Adds the records this node reads to a list
+   * @param  records   the list of records read
+   * @return false if the node may read records that are not known until
+   *         it is evaluated
+   **/
+  virtual bool dependencies(
+      std::vector<const madara::knowledge::KnowledgeRecord*>& records) const;
+
+  /**
+   * Lowers the node into bytecode
+   * @param  bytecode   the bytecode being built
+   * @return the register holding the value of the node, or -1 if the node
+   *         cannot be lowered
+   **/
+  virtual int lower(Bytecode& bytecode) const;
+
 private:
   // variables context
   // madara::knowledge::ThreadSafeContext & context_;
@@ -4,6 +4,7 @@
 
 #ifndef _MADARA_NO_KARL_
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 
@@ -15,6 +16,7 @@
 
 #include "madara/knowledge/Functions.h"
 #include "madara/knowledge/Variables.h"
+#include "madara/knowledge/CallFrame.h"
 #include "madara/exceptions/KarlException.h"
 
 #ifdef _MADARA_PYTHON_CALLBACKS_
@@ -31,6 +33,47 @@
 
 #endif
 
+namespace
+{
+/**
+ * Binds the arguments of a call to the argument variables (.0, .1, etc.),
+ * and when the call returns, gives them back the values of the call that
+ * made it, so nested and recursive calls do not clobber them
+ **/
+class BoundArguments
+{
+public:
+  BoundArguments(std::vector<madara::knowledge::KnowledgeRecord*>& records,
+      madara::knowledge::CallFrame& frame)
+    : records_(records), frame_(frame)
+  {
+    const madara::knowledge::FunctionArguments& args = frame_.args();
+
+    for (size_t i = 0; i < args.size(); ++i)
+      *records_[i] = args[i];
+
+    frame_.bind();
+  }
+
+  ~BoundArguments()
+  {
+    const madara::knowledge::FunctionArguments* caller = frame_.caller();
+
+    if (caller)
+    {
+      size_t size = std::min(caller->size(), frame_.args().size());
+
+      for (size_t i = 0; i < size; ++i)
+        *records_[i] = (*caller)[i];
+    }
+  }
+
+private:
+  std::vector<madara::knowledge::KnowledgeRecord*>& records_;
+  madara::knowledge::CallFrame& frame_;
+};
+}
+
 // Ctor
 
 madara::expression::CompositeFunctionNode::CompositeFunctionNode(
@@ -100,19 +143,21 @@ madara::knowledge::KnowledgeRecord
 madara::expression::CompositeFunctionNode::evaluate(
     const madara::knowledge::KnowledgeUpdateSettings& settings)
 {
-  madara::knowledge::FunctionArguments args;
+  // the arguments are held in a frame of the thread's call stack, which
+  // is reused from call to call
+  madara::knowledge::CallFrame frame(nodes_.size());
+  madara::knowledge::FunctionArguments& args = frame.args();
   madara::knowledge::KnowledgeRecord result;
 
-  args.resize(nodes_.size());
-
   int j = 0;
 
   for (ComponentNodes::iterator i = nodes_.begin(); i != nodes_.end(); ++i, ++j)
   {
     args[j] = (*i)->evaluate(settings);
-    *(compiled_args_[j]) = args[j];
   }
 
+  BoundArguments bound(compiled_args_, frame);
+
   madara::knowledge::Variables variables;
   variables.context_ = &context_;
 
@@ -227,6 +272,13 @@ void madara::expression::CompositeFunctionNode::accept(Visitor& visitor) const
   visitor.visit(*this);
 }
 
+bool madara::expression::CompositeFunctionNode::dependencies(
+    std::vector<const madara::knowledge::KnowledgeRecord*>&) const
+{
+  // functions may read any variable
+  return false;
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* _FUNCTION_NODE_CPP_ */
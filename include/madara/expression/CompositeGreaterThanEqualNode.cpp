@@ -10,6 +10,7 @@
 #include "madara/expression/ComponentNode.h"
 #include "madara/expression/Visitor.h"
 #include "madara/expression/CompositeGreaterThanEqualNode.h"
+#include "madara/expression/Bytecode.h"
 #include "madara/expression/LeafNode.h"
 
 // Ctor
@@ -104,6 +105,11 @@ void madara::expression::CompositeGreaterThanEqualNode::accept(
   visitor.visit(*this);
 }
 
+int madara::expression::CompositeGreaterThanEqualNode::lower(Bytecode& bytecode) const
+{
+  return bytecode.binary(Bytecode::GREATER_EQUAL, left_, right_);
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* _COMPOSITE_GREATER_THAN_EQUAL_NODE_CPP_ */
@@ -10,6 +10,7 @@
 #include "madara/expression/ComponentNode.h"
 #include "madara/expression/Visitor.h"
 #include "madara/expression/CompositeGreaterThanNode.h"
+#include "madara/expression/Bytecode.h"
 #include "madara/expression/LeafNode.h"
 
 // Ctor
@@ -101,6 +102,11 @@ void madara::expression::CompositeGreaterThanNode::accept(
   visitor.visit(*this);
 }
 
+int madara::expression::CompositeGreaterThanNode::lower(Bytecode& bytecode) const
+{
+  return bytecode.binary(Bytecode::GREATER, left_, right_);
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* _COMPOSITE_GREATER_THAN_NODE_CPP_ */
@@ -10,6 +10,7 @@
 #include "madara/expression/ComponentNode.h"
 #include "madara/expression/Visitor.h"
 #include "madara/expression/CompositeImpliesNode.h"
+#include "madara/expression/Bytecode.h"
 #include "madara/expression/LeafNode.h"
 
 // Ctor
@@ -108,6 +109,11 @@ void madara::expression::CompositeImpliesNode::accept(Visitor& visitor) const
   visitor.visit(*this);
 }
 
+int madara::expression::CompositeImpliesNode::lower(Bytecode& bytecode) const
+{
+  return bytecode.implies(left_, right_);
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* _COMPOSITE_IMPLIES_NODE_CPP */
@@ -10,6 +10,7 @@
 #include "madara/expression/ComponentNode.h"
 #include "madara/expression/Visitor.h"
 #include "madara/expression/CompositeInequalityNode.h"
+#include "madara/expression/Bytecode.h"
 #include "madara/expression/LeafNode.h"
 
 // Ctor
@@ -101,6 +102,11 @@ void madara::expression::CompositeInequalityNode::accept(Visitor& visitor) const
   visitor.visit(*this);
 }
 
+int madara::expression::CompositeInequalityNode::lower(Bytecode& bytecode) const
+{
+  return bytecode.binary(Bytecode::NOT_EQUAL, left_, right_);
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* _INEQUALITY_NODE_CPP_ */
@@ -10,6 +10,7 @@
 #include "madara/expression/ComponentNode.h"
 #include "madara/expression/Visitor.h"
 #include "madara/expression/CompositeLessThanEqualNode.h"
+#include "madara/expression/Bytecode.h"
 #include "madara/expression/LeafNode.h"
 
 // Ctor
@@ -103,6 +104,11 @@ void madara::expression::CompositeLessThanEqualNode::accept(
   visitor.visit(*this);
 }
 
+int madara::expression::CompositeLessThanEqualNode::lower(Bytecode& bytecode) const
+{
+  return bytecode.binary(Bytecode::LESS_EQUAL, left_, right_);
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* _COMPOSITE_LESS_THAN_EQUAL_NODE_CPP_ */
@@ -59,6 +59,14 @@ public:
    * @param    visitor   visitor instance to use
    **/
   virtual void accept(Visitor& visitor) const;
+
+  /**
+   * Lowers the node into bytecode
+   * @param  bytecode   the bytecode being built
+   * @return the register holding the value of the node, or -1 if the node
+   *         cannot be lowered
+   **/
+  virtual int lower(Bytecode& bytecode) const;
 };
 }
 }
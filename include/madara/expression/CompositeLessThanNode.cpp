@@ -10,6 +10,7 @@
 #include "madara/expression/ComponentNode.h"
 #include "madara/expression/Visitor.h"
 #include "madara/expression/CompositeLessThanNode.h"
+#include "madara/expression/Bytecode.h"
 #include "madara/expression/LeafNode.h"
 
 madara::expression::CompositeLessThanNode::CompositeLessThanNode(
@@ -100,6 +101,11 @@ void madara::expression::CompositeLessThanNode::accept(Visitor& visitor) const
   visitor.visit(*this);
 }
 
+int madara::expression::CompositeLessThanNode::lower(Bytecode& bytecode) const
+{
+  return bytecode.binary(Bytecode::LESS, left_, right_);
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* _COMPOSITE_LESS_THAN_NODE_CPP_ */
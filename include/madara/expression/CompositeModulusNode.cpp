@@ -9,6 +9,7 @@
 #include "madara/expression/ComponentNode.h"
 #include "madara/expression/CompositeBinaryNode.h"
 #include "madara/expression/CompositeModulusNode.h"
+#include "madara/expression/Bytecode.h"
 #include "madara/expression/Visitor.h"
 #include "madara/expression/LeafNode.h"
 
@@ -113,6 +114,11 @@ void madara::expression::CompositeModulusNode::accept(Visitor& visitor) const
   visitor.visit(*this);
 }
 
+int madara::expression::CompositeModulusNode::lower(Bytecode& bytecode) const
+{
+  return bytecode.binary(Bytecode::MODULUS, left_, right_);
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* _MODULUS_NODE_CPP_ */
@@ -9,6 +9,7 @@
 #include "madara/expression/ComponentNode.h"
 #include "madara/expression/CompositeBinaryNode.h"
 #include "madara/expression/CompositeMultiplyNode.h"
+#include "madara/expression/Bytecode.h"
 #include "madara/expression/Visitor.h"
 #include "madara/expression/LeafNode.h"
 
@@ -102,6 +103,11 @@ void madara::expression::CompositeMultiplyNode::accept(Visitor& visitor) const
   visitor.visit(*this);
 }
 
+int madara::expression::CompositeMultiplyNode::lower(Bytecode& bytecode) const
+{
+  return bytecode.fold(Bytecode::MULTIPLY, nodes_);
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* _MULTIPLY_NODE_CPP_ */
@@ -10,6 +10,7 @@
 #include "madara/expression/CompositeUnaryNode.h"
 #include "madara/expression/Visitor.h"
 #include "madara/expression/CompositeNegateNode.h"
+#include "madara/expression/Bytecode.h"
 #include "madara/expression/LeafNode.h"
 
 madara::expression::CompositeNegateNode::CompositeNegateNode(
@@ -83,6 +84,11 @@ void madara::expression::CompositeNegateNode::accept(Visitor& visitor) const
   visitor.visit(*this);
 }
 
+int madara::expression::CompositeNegateNode::lower(Bytecode& bytecode) const
+{
+  return bytecode.unary(Bytecode::NEGATE, right_);
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* _NEGATE_NODE_CPP_ */
@@ -10,6 +10,7 @@
 #include "madara/expression/CompositeUnaryNode.h"
 #include "madara/expression/Visitor.h"
 #include "madara/expression/CompositeNotNode.h"
+#include "madara/expression/Bytecode.h"
 #include "madara/expression/LeafNode.h"
 
 madara::expression::CompositeNotNode::CompositeNotNode(
@@ -79,6 +80,11 @@ void madara::expression::CompositeNotNode::accept(Visitor& visitor) const
   visitor.visit(*this);
 }
 
+int madara::expression::CompositeNotNode::lower(Bytecode& bytecode) const
+{
+  return bytecode.unary(Bytecode::NOT, right_);
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* _NOT_NODE_CPP_ */
@@ -10,6 +10,7 @@
 #include "madara/expression/ComponentNode.h"
 #include "madara/expression/Visitor.h"
 #include "madara/expression/CompositeOrNode.h"
+#include "madara/expression/Bytecode.h"
 #include "madara/expression/LeafNode.h"
 
 madara::expression::CompositeOrNode::CompositeOrNode(
@@ -92,6 +93,11 @@ void madara::expression::CompositeOrNode::accept(Visitor& visitor) const
   visitor.visit(*this);
 }
 
+int madara::expression::CompositeOrNode::lower(Bytecode& bytecode) const
+{
+  return bytecode.logical_or(nodes_);
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* COMPOSITE_OR_NODE_CPP */
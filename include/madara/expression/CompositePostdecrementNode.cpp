@@ -10,6 +10,7 @@
 #include "madara/expression/CompositeUnaryNode.h"
 #include "madara/expression/Visitor.h"
 #include "madara/expression/CompositePostdecrementNode.h"
+#include "madara/expression/Bytecode.h"
 #include "madara/expression/LeafNode.h"
 #include "madara/expression/VariableNode.h"
 
@@ -118,6 +119,11 @@ void madara::expression::CompositePostdecrementNode::accept(
   visitor.visit(*this);
 }
 
+int madara::expression::CompositePostdecrementNode::lower(Bytecode& bytecode) const
+{
+  return bytecode.modify(Bytecode::POSTDECREMENT, var_);
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* _COMPOSITE_PREDECREMENT_NODE_CPP_ */
@@ -10,6 +10,7 @@
 #include "madara/expression/CompositeUnaryNode.h"
 #include "madara/expression/Visitor.h"
 #include "madara/expression/CompositePostincrementNode.h"
+#include "madara/expression/Bytecode.h"
 #include "madara/expression/LeafNode.h"
 #include "madara/expression/VariableNode.h"
 
@@ -118,6 +119,11 @@ void madara::expression::CompositePostincrementNode::accept(
   visitor.visit(*this);
 }
 
+int madara::expression::CompositePostincrementNode::lower(Bytecode& bytecode) const
+{
+  return bytecode.modify(Bytecode::POSTINCREMENT, var_);
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* _COMPOSITE_PREINCREMENT_NODE_CPP_ */
@@ -10,6 +10,7 @@
 #include "madara/expression/CompositeUnaryNode.h"
 #include "madara/expression/Visitor.h"
 #include "madara/expression/CompositePredecrementNode.h"
+#include "madara/expression/Bytecode.h"
 #include "madara/expression/LeafNode.h"
 #include "madara/expression/VariableNode.h"
 
@@ -105,6 +106,11 @@ void madara::expression::CompositePredecrementNode::accept(
   visitor.visit(*this);
 }
 
+int madara::expression::CompositePredecrementNode::lower(Bytecode& bytecode) const
+{
+  return bytecode.modify(Bytecode::PREDECREMENT, var_);
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* _COMPOSITE_PREDECREMENT_NODE_CPP_ */
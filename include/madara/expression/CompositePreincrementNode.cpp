@@ -10,6 +10,7 @@
 #include "madara/expression/CompositeUnaryNode.h"
 #include "madara/expression/Visitor.h"
 #include "madara/expression/CompositePreincrementNode.h"
+#include "madara/expression/Bytecode.h"
 #include "madara/expression/LeafNode.h"
 #include "madara/expression/VariableNode.h"
 
@@ -105,6 +106,11 @@ void madara::expression::CompositePreincrementNode::accept(
   visitor.visit(*this);
 }
 
+int madara::expression::CompositePreincrementNode::lower(Bytecode& bytecode) const
+{
+  return bytecode.modify(Bytecode::PREINCREMENT, var_);
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* _COMPOSITE_PREINCREMENT_NODE_CPP_ */
@@ -11,6 +11,7 @@
 #include "madara/expression/ComponentNode.h"
 #include "madara/expression/Visitor.h"
 #include "madara/expression/CompositeReturnRightNode.h"
+#include "madara/expression/Bytecode.h"
 #include "madara/expression/LeafNode.h"
 
 madara::expression::CompositeReturnRightNode::CompositeReturnRightNode(
@@ -83,6 +84,11 @@ void madara::expression::CompositeReturnRightNode::accept(
   visitor.visit(*this);
 }
 
+int madara::expression::CompositeReturnRightNode::lower(Bytecode& bytecode) const
+{
+  return bytecode.sequence(nodes_);
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* _COMPOSITE_RETURN_RIGHT_NODE_CPP_ */
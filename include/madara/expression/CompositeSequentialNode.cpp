@@ -11,6 +11,7 @@
 #include "madara/expression/ComponentNode.h"
 #include "madara/expression/Visitor.h"
 #include "madara/expression/CompositeSequentialNode.h"
+#include "madara/expression/Bytecode.h"
 #include "madara/expression/LeafNode.h"
 
 madara::expression::CompositeSequentialNode::CompositeSequentialNode(
@@ -81,6 +82,11 @@ void madara::expression::CompositeSequentialNode::accept(Visitor& visitor) const
   visitor.visit(*this);
 }
 
+int madara::expression::CompositeSequentialNode::lower(Bytecode& bytecode) const
+{
+  return bytecode.fold(Bytecode::MINIMUM, nodes_);
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* _COMPOSITE_SEQUENTIAL_NODE_CPP */
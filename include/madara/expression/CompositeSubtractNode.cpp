@@ -8,6 +8,7 @@
 #include "madara/expression/Visitor.h"
 #include "madara/expression/CompositeBinaryNode.h"
 #include "madara/expression/CompositeSubtractNode.h"
+#include "madara/expression/Bytecode.h"
 #include "madara/expression/LeafNode.h"
 
 madara::expression::CompositeSubtractNode::CompositeSubtractNode(
@@ -108,6 +109,11 @@ void madara::expression::CompositeSubtractNode::accept(Visitor& visitor) const
   visitor.visit(*this);
 }
 
+int madara::expression::CompositeSubtractNode::lower(Bytecode& bytecode) const
+{
+  return bytecode.binary(Bytecode::SUBTRACT, left_, right_);
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* _SUBTRACT_NODE_CPP_ */
@@ -42,6 +42,19 @@ void madara::expression::CompositeTernaryNode::accept(
   (void)visitor;
 }
 
+bool madara::expression::CompositeTernaryNode::dependencies(
+    std::vector<const madara::knowledge::KnowledgeRecord*>& records) const
+{
+  for (ComponentNodes::const_iterator i = nodes_.begin(); i != nodes_.end();
+       ++i)
+  {
+    if (!(*i)->dependencies(records))
+      return false;
+  }
+
+  return true;
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* _TERNARY_NODE_CPP_ */
@@ -25,6 +25,12 @@ madara::expression::CompositeUnaryNode::right(void) const
   return right_;
 }
 
+bool madara::expression::CompositeUnaryNode::dependencies(
+    std::vector<const madara::knowledge::KnowledgeRecord*>& records) const
+{
+  return right_ == 0 || right_->dependencies(records);
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* _COMPOSITE_NODE_CPP_ */
@@ -37,6 +37,15 @@ public:
    **/
   virtual ComponentNode* right(void) const;
 
+  /**
+   * Adds the records this node reads to a list
+   * @param  records   the list of records read
+   * @return false if the node may read records that are not known until
+   *         it is evaluated
+   **/
+  virtual bool dependencies(
+      std::vector<const madara::knowledge::KnowledgeRecord*>& records) const;
+
 protected:
   /// Right expression
   ComponentNode* right_;
@@ -16,6 +16,7 @@
 #include "madara/expression/IteratorImpl.h"
 #include "madara/expression/ExpressionTree.h"
 #include "madara/expression/LeafNode.h"
+#include "madara/expression/Bytecode.h"
 
 namespace madara
 {
@@ -166,7 +167,7 @@ madara::expression::ExpressionTree::ExpressionTree(logger::Logger& logger,
 
 madara::expression::ExpressionTree::ExpressionTree(
     logger::Logger& logger, const madara::expression::ExpressionTree& t)
-  : logger_(&logger), root_(t.root_)
+  : logger_(&logger), root_(t.root_), bytecode_(t.bytecode_)
 {
 }
 
@@ -181,6 +182,7 @@ void madara::expression::ExpressionTree::operator=(
   {
     logger_ = t.logger_;
     root_ = t.root_;
+    bytecode_ = t.bytecode_;
   }
 }
 
@@ -207,6 +209,9 @@ madara::knowledge::KnowledgeRecord madara::expression::ExpressionTree::prune(
   bool root_can_change = false;
   madara::knowledge::KnowledgeRecord root_value;
 
+  // the bytecode refers to nodes that pruning may delete
+  bytecode_.reset();
+
   if (this->root_.get_ptr())
   {
     root_value = this->root_->prune(root_can_change);
@@ -224,7 +229,9 @@ madara::knowledge::KnowledgeRecord madara::expression::ExpressionTree::prune(
 madara::knowledge::KnowledgeRecord madara::expression::ExpressionTree::evaluate(
     const madara::knowledge::KnowledgeUpdateSettings& settings)
 {
-  if (root_.get_ptr() != 0)
+  if (bytecode_)
+    return bytecode_->run(settings);
+  else if (root_.get_ptr() != 0)
     return root_->evaluate(settings);
   else
     return madara::knowledge::KnowledgeRecord(0);
@@ -310,6 +317,42 @@ void madara::expression::ExpressionTree::accept(Visitor& visitor) const
   root_->accept(visitor);
 }
 
+bool madara::expression::ExpressionTree::dependencies(
+    std::vector<const madara::knowledge::KnowledgeRecord*>& records) const
+{
+  if (root_.get_ptr() != 0)
+    return root_.get_ptr()->dependencies(records);
+  else
+    return true;
+}
+
+bool madara::expression::ExpressionTree::compile_bytecode(
+    madara::knowledge::ThreadSafeContext& context)
+{
+  bytecode_.reset();
+
+  if (root_.get_ptr() == 0)
+    return false;
+
+  std::shared_ptr<Bytecode> bytecode(new Bytecode(context));
+
+  if (!bytecode->compile(root_.get_ptr()))
+    return false;
+
+  bytecode_ = bytecode;
+  return true;
+}
+
+bool madara::expression::ExpressionTree::has_bytecode(void) const
+{
+  return (bool)bytecode_;
+}
+
+void madara::expression::ExpressionTree::clear_bytecode(void)
+{
+  bytecode_.reset();
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* _EXPRESSION_TREE_CPP_ */
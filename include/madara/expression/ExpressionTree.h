@@ -7,6 +7,7 @@
 
 #include <string>
 #include <stdexcept>
+#include <memory>
 #include "madara/utility/Refcounter.h"
 
 #include "madara/logger/GlobalLogger.h"
@@ -20,6 +21,7 @@ namespace expression
 // Forward declarations.
 class ExpressionTreeIterator;
 class ExpressionTreeConstIterator;
+class Bytecode;
 
 /**
  * @class ExpressionTree
@@ -149,12 +151,43 @@ public:
    **/
   void accept(Visitor& visitor) const;
 
+  /**
+   * Adds the records the expression reads to a list
+   * @param    records   the list of records read
+   * @return   false if the expression may read records that are not
+   *           known until it is evaluated, e.g., in function calls
+   **/
+  bool dependencies(
+      std::vector<const madara::knowledge::KnowledgeRecord*>& records) const;
+
+  /**
+   * Lowers the tree into bytecode, which evaluate will then run instead
+   * of the tree
+   * @param    context   the context of the variables in the tree
+   * @return   true if the tree was lowered, false if its root cannot be
+   **/
+  bool compile_bytecode(madara::knowledge::ThreadSafeContext& context);
+
+  /**
+   * Checks if the tree has been lowered into bytecode
+   * @return   true if evaluate runs bytecode
+   **/
+  bool has_bytecode(void) const;
+
+  /**
+   * Discards the bytecode of the tree, so evaluate walks the tree again
+   **/
+  void clear_bytecode(void);
+
 private:
   /// handle for logging information
   logger::Logger* logger_;
 
   /// root of the expression tree
   madara::utility::Refcounter<ComponentNode> root_;
+
+  /// the tree lowered into bytecode, shared by copies of the tree
+  std::shared_ptr<Bytecode> bytecode_;
 };
 }
 }
@@ -5423,6 +5423,21 @@ void madara::expression::Interpreter::system_call_insert(
         {
           call = new ToDoubles(context);
         }
+        else if (name == "#dot")
+        {
+          using namespace madara::knowledge;
+
+          call = new GenericSystemCall(context, "#dot",
+              [](std::vector<KnowledgeRecord> recs) -> KnowledgeRecord {
+                if (recs.size() != 2)
+                {
+                  throw exceptions::KarlException(
+                      "#dot: expects 2 arguments");
+                }
+
+                return recs[0].dot(recs[1]);
+              });
+        }
         break;
       case 'e':
         if (name == "#eval" || name == "#evaluate")
@@ -5507,6 +5522,36 @@ void madara::expression::Interpreter::system_call_insert(
                 return KnowledgeRecord(std::move(ret));
               });
         }
+        else if (name == "#max")
+        {
+          using namespace madara::knowledge;
+
+          call = new GenericSystemCall(context, "#max",
+              [](std::vector<KnowledgeRecord> recs) -> KnowledgeRecord {
+                if (recs.size() != 1)
+                {
+                  throw exceptions::KarlException(
+                      "#max: expects 1 argument");
+                }
+
+                return recs[0].maximum();
+              });
+        }
+        else if (name == "#min")
+        {
+          using namespace madara::knowledge;
+
+          call = new GenericSystemCall(context, "#min",
+              [](std::vector<KnowledgeRecord> recs) -> KnowledgeRecord {
+                if (recs.size() != 1)
+                {
+                  throw exceptions::KarlException(
+                      "#min: expects 1 argument");
+                }
+
+                return recs[0].minimum();
+              });
+        }
         break;
       case 'p':
         if (name == "#pow")
@@ -5581,6 +5626,21 @@ void madara::expression::Interpreter::system_call_insert(
         {
           call = new ToString(context);
         }
+        else if (name == "#sum")
+        {
+          using namespace madara::knowledge;
+
+          call = new GenericSystemCall(context, "#sum",
+              [](std::vector<KnowledgeRecord> recs) -> KnowledgeRecord {
+                if (recs.size() != 1)
+                {
+                  throw exceptions::KarlException(
+                      "#sum: expects 1 argument");
+                }
+
+                return recs[0].sum();
+              });
+        }
         break;
       case 't':
         if (name == "#tan")
@@ -6639,9 +6699,20 @@ madara::expression::ExpressionTree madara::expression::Interpreter::interpret(
     knowledge::ThreadSafeContext& context, const std::string& input)
 {
   // return the cached expression tree if it exists
-  ExpressionTreeMap::const_iterator found = cache_.find(input);
+  ExpressionTreeMap::iterator found = cache_.find(input);
   if (found != cache_.end())
+  {
+    // the tree may have been cached before bytecode was enabled or disabled
+    if (context.uses_bytecode() != found->second.has_bytecode())
+    {
+      if (context.uses_bytecode())
+        found->second.compile_bytecode(context);
+      else
+        found->second.clear_bytecode();
+    }
+
     return found->second;
+  }
 
   ::std::list<Symbol*> list;
   // list.clear ();
@@ -6696,6 +6767,10 @@ madara::expression::ExpressionTree madara::expression::Interpreter::interpret(
     tree.prune();
     delete list.back();
 
+    // lower the optimized tree into bytecode, if enabled
+    if (context.uses_bytecode())
+      tree.compile_bytecode(context);
+
     // store this optimized tree into cached memory
     cache_[input] = tree;
 
@@ -9,6 +9,7 @@
 #include "madara/expression/ComponentNode.h"
 #include "madara/expression/Visitor.h"
 #include "madara/expression/LeafNode.h"
+#include "madara/expression/Bytecode.h"
 
 // Ctor
 madara::expression::LeafNode::LeafNode(
@@ -78,6 +79,17 @@ void madara::expression::LeafNode::accept(Visitor& visitor) const
   visitor.visit(*this);
 }
 
+bool madara::expression::LeafNode::dependencies(
+    std::vector<const madara::knowledge::KnowledgeRecord*>&) const
+{
+  return true;
+}
+
+int madara::expression::LeafNode::lower(Bytecode& bytecode) const
+{
+  return bytecode.constant(item_);
+}
+
 #endif  // _MADARA_NO_KARL_
 
 #endif /* _LEAF_NODE_CPP_ */
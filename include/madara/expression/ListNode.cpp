@@ -24,6 +24,19 @@ void madara::expression::ListNode::accept(Visitor& visitor) const
   visitor.visit(*this);
 }
 
+bool madara::expression::ListNode::dependencies(
+    std::vector<const madara::knowledge::KnowledgeRecord*>& records) const
+{
+  for (std::list<ComponentNode*>::const_iterator i = list_.begin();
+       i != list_.end(); ++i)
+  {
+    if (!(*i)->dependencies(records))
+      return false;
+  }
+
+  return true;
+}
+
 madara::knowledge::KnowledgeRecord madara::expression::ListNode::item() const
 {
   return madara::knowledge::KnowledgeRecord(
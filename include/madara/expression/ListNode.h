@@ -49,6 +49,11 @@ public:
   /// Define the @a accept() operation used for the Visitor pattern.
   virtual void accept(Visitor& visitor) const;
 
+  /// Adds the records this node reads to records, returning false if it
+  /// may read records that are only known when it is evaluated
+  virtual bool dependencies(
+      std::vector<const madara::knowledge::KnowledgeRecord*>& records) const;
+
 private:
   // variables context
   // madara::knowledge::ThreadSafeContext & context_;
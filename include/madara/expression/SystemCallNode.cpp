@@ -32,4 +32,11 @@ void madara::expression::SystemCallNode::accept(
   (void)visitor;
 }
 
+bool madara::expression::SystemCallNode::dependencies(
+    std::vector<const madara::knowledge::KnowledgeRecord*>&) const
+{
+  // system calls may read the clock, files or variables by name
+  return false;
+}
+
 #endif  // _MADARA_NO_KARL_
@@ -89,6 +89,10 @@ madara::expression::SystemCallPrintSystemCalls::prune(bool& can_change)
         "  expressions or variable references (including container\n"
         "  classes such as Integer, Double, Vector, etc.)\n";
 
+    calls_["#dot"] = "\n#dot (a, b):\n"
+                     "  Returns the sum of the products of the elements of\n"
+                     "  two arrays, up to the length of the shorter one.\n";
+
     calls_["#eval"] =
         "\n#eval (expression) or #evaluate (expression):\n"
         "  Evaluates the KaRL expression and returns a result. Works "
@@ -156,6 +160,12 @@ madara::expression::SystemCallPrintSystemCalls::prune(bool& can_change)
         "  5. Trace events\n"
         "  6. Detailed logging\n";
 
+    calls_["#max"] = "\n#max (array):\n"
+                     "  Returns the largest element of an array\n";
+
+    calls_["#min"] = "\n#min (array):\n"
+                     "  Returns the smallest element of an array\n";
+
     calls_["#pow"] = "\n#pow (base, power):\n"
                      "  Returns the base taken to a power (exponent)\n";
 
@@ -224,6 +234,9 @@ madara::expression::SystemCallPrintSystemCalls::prune(bool& can_change)
     calls_["#sqrt"] = "\n#sqrt (value):\n"
                       "  Returns the square root of a value\n";
 
+    calls_["#sum"] = "\n#sum (array):\n"
+                     "  Returns the sum of the elements of an array\n";
+
     calls_["#tan"] = "\n#tan (value):\n"
                      "  Returns the tangent of a term (radians)\n";
 
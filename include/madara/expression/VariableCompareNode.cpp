@@ -3,6 +3,7 @@
 #include "madara/expression/Visitor.h"
 #include "madara/expression/LeafNode.h"
 #include "madara/expression/VariableCompareNode.h"
+#include "madara/expression/Bytecode.h"
 #include "madara/utility/Utility.h"
 
 typedef madara::knowledge::KnowledgeRecord KnowledgeRecord;
@@ -37,6 +38,38 @@ void madara::expression::VariableCompareNode::accept(Visitor& visitor) const
   visitor.visit(*this);
 }
 
+bool madara::expression::VariableCompareNode::dependencies(
+    std::vector<const madara::knowledge::KnowledgeRecord*>& records) const
+{
+  if (var_)
+  {
+    if (!var_->dependencies(records))
+      return false;
+  }
+  else if (array_ && !array_->dependencies(records))
+  {
+    return false;
+  }
+
+  return rhs_ == 0 || rhs_->dependencies(records);
+}
+
+int madara::expression::VariableCompareNode::lower(Bytecode& bytecode) const
+{
+  Bytecode::Opcode op = Bytecode::GREATER;
+
+  if (compare_type_ == LESS_THAN)
+    op = Bytecode::LESS;
+  else if (compare_type_ == LESS_THAN_EQUAL)
+    op = Bytecode::LESS_EQUAL;
+  else if (compare_type_ == EQUAL)
+    op = Bytecode::EQUAL;
+  else if (compare_type_ == GREATER_THAN_EQUAL)
+    op = Bytecode::GREATER_EQUAL;
+
+  return bytecode.compare(op, var_, rhs_, value_);
+}
+
 KnowledgeRecord madara::expression::VariableCompareNode::item() const
 {
   knowledge::KnowledgeRecord value;
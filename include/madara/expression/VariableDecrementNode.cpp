@@ -3,6 +3,7 @@
 #include "madara/expression/Visitor.h"
 #include "madara/expression/LeafNode.h"
 #include "madara/expression/VariableDecrementNode.h"
+#include "madara/expression/Bytecode.h"
 #include "madara/utility/Utility.h"
 
 #include <string>
@@ -33,6 +34,27 @@ void madara::expression::VariableDecrementNode::accept(Visitor& visitor) const
   visitor.visit(*this);
 }
 
+bool madara::expression::VariableDecrementNode::dependencies(
+    std::vector<const madara::knowledge::KnowledgeRecord*>& records) const
+{
+  if (var_)
+  {
+    if (!var_->dependencies(records))
+      return false;
+  }
+  else if (array_ && !array_->dependencies(records))
+  {
+    return false;
+  }
+
+  return rhs_ == 0 || rhs_->dependencies(records);
+}
+
+int madara::expression::VariableDecrementNode::lower(Bytecode& bytecode) const
+{
+  return bytecode.compound(Bytecode::SUBTRACT, var_, rhs_, value_);
+}
+
 madara::knowledge::KnowledgeRecord
 madara::expression::VariableDecrementNode::item() const
 {
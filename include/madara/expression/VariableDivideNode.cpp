@@ -3,6 +3,7 @@
 #include "madara/expression/Visitor.h"
 #include "madara/expression/LeafNode.h"
 #include "madara/expression/VariableDivideNode.h"
+#include "madara/expression/Bytecode.h"
 #include "madara/utility/Utility.h"
 
 #include <math.h>
@@ -35,6 +36,27 @@ void madara::expression::VariableDivideNode::accept(Visitor& visitor) const
   visitor.visit(*this);
 }
 
+bool madara::expression::VariableDivideNode::dependencies(
+    std::vector<const madara::knowledge::KnowledgeRecord*>& records) const
+{
+  if (var_)
+  {
+    if (!var_->dependencies(records))
+      return false;
+  }
+  else if (array_ && !array_->dependencies(records))
+  {
+    return false;
+  }
+
+  return rhs_ == 0 || rhs_->dependencies(records);
+}
+
+int madara::expression::VariableDivideNode::lower(Bytecode& bytecode) const
+{
+  return bytecode.compound(Bytecode::DIVIDE, var_, rhs_, value_);
+}
+
 madara::knowledge::KnowledgeRecord
 madara::expression::VariableDivideNode::item() const
 {
@@ -60,6 +60,15 @@ public:
   /// Define the @a accept() operation used for the Visitor pattern.
   virtual void accept(Visitor& visitor) const;
 
+  /// Adds the records this node reads to records, returning false if it
+  /// may read records that are only known when it is evaluated
+  virtual bool dependencies(
+      std::vector<const madara::knowledge::KnowledgeRecord*>& records) const;
+
+  /// Lowers the node into bytecode, returning the register holding its
+  /// value, or -1 if it cannot be lowered
+  virtual int lower(Bytecode& bytecode) const;
+
 private:
   /// variable holder
   VariableNode* var_;
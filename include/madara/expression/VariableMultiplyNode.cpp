@@ -2,6 +2,7 @@
 #ifndef _MADARA_NO_KARL_
 #include "madara/expression/Visitor.h"
 #include "madara/expression/VariableMultiplyNode.h"
+#include "madara/expression/Bytecode.h"
 #include "madara/expression/LeafNode.h"
 #include "madara/utility/Utility.h"
 
@@ -33,6 +34,27 @@ void madara::expression::VariableMultiplyNode::accept(Visitor& visitor) const
   visitor.visit(*this);
 }
 
+bool madara::expression::VariableMultiplyNode::dependencies(
+    std::vector<const madara::knowledge::KnowledgeRecord*>& records) const
+{
+  if (var_)
+  {
+    if (!var_->dependencies(records))
+      return false;
+  }
+  else if (array_ && !array_->dependencies(records))
+  {
+    return false;
+  }
+
+  return rhs_ == 0 || rhs_->dependencies(records);
+}
+
+int madara::expression::VariableMultiplyNode::lower(Bytecode& bytecode) const
+{
+  return bytecode.compound(Bytecode::MULTIPLY, var_, rhs_, value_);
+}
+
 madara::knowledge::KnowledgeRecord
 madara::expression::VariableMultiplyNode::item() const
 {
@@ -2,6 +2,7 @@
 #ifndef _MADARA_NO_KARL_
 #include "madara/expression/Visitor.h"
 #include "madara/expression/VariableNode.h"
+#include "madara/expression/Bytecode.h"
 #include "madara/utility/Utility.h"
 #include "VariableExpander.h"
 #include "madara/exceptions/UninitializedException.h"
@@ -222,6 +223,34 @@ void madara::expression::VariableNode::accept(Visitor& visitor) const
   visitor.visit(*this);
 }
 
+bool madara::expression::VariableNode::dependencies(
+    std::vector<const madara::knowledge::KnowledgeRecord*>& records) const
+{
+  // an expanded name is only known when the node is evaluated
+  if (key_expansion_necessary_)
+    return false;
+
+  records.push_back(ref_.get_record_unsafe());
+  return true;
+}
+
+int madara::expression::VariableNode::lower(Bytecode& bytecode) const
+{
+  // an expanded name is only known when the node is evaluated
+  if (key_expansion_necessary_ || !ref_.is_valid())
+    return -1;
+
+  return bytecode.load(ref_);
+}
+
+int madara::expression::VariableNode::slot(Bytecode& bytecode) const
+{
+  if (key_expansion_necessary_ || !ref_.is_valid())
+    return -1;
+
+  return bytecode.slot(ref_);
+}
+
 madara::knowledge::KnowledgeRecord madara::expression::VariableNode::item()
     const
 {
@@ -0,0 +1,66 @@
+
+
+#ifndef _MADARA_FILTERS_KEYED_RECORD_FILTER_H_
+#define _MADARA_FILTERS_KEYED_RECORD_FILTER_H_
+
+/**
+ * @file KeyedRecordFilter.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains a filter functor for individual records that
+ * receives the record and its name by reference
+ **/
+
+#include <string>
+#include "madara/knowledge/KnowledgeRecord.h"
+#include "madara/knowledge/Variables.h"
+
+namespace madara
+{
+namespace transport
+{
+class TransportContext;
+}
+
+namespace filters
+{
+/**
+ * Abstract base class for implementing individual record filters that
+ * change the record in place. Unlike RecordFilter, no FunctionArguments
+ * are built for the call, so this is the cheapest record filter to run
+ * on every record of every message. When subclassing this class, create
+ * a new instance with the new operator, and the pointer will be managed
+ * by the underlying MADARA infrastructure.
+ **/
+class KeyedRecordFilter
+{
+public:
+  /**
+   * Destructor
+   **/
+  virtual ~KeyedRecordFilter() {}
+
+  /**
+   * User-implementable method for performing a filter on network
+   * data. This is a pure abstract function that must be overridden
+   * when implementing a subclass.
+   * @param   name        the name of the record ("" if unnamed)
+   * @param   record      the record to filter, which may be changed in
+   *                      place. ON_SEND/REBROADCAST will send the record
+   *                      as it is left. ON_RECEIVE will set it in the
+   *                      knowledge base. If the record is left without a
+   *                      value (e.g., with clear_value), the variable is
+   *                      removed from the operation.
+   * @param   context     the operation, bandwidth, times, domain and
+   *                      originator of the update. Records added to it
+   *                      with add_record are sent along with the update.
+   * @param   vars        variable context for querying current state
+   **/
+  virtual void filter(const std::string& name,
+      knowledge::KnowledgeRecord& record, transport::TransportContext& context,
+      knowledge::Variables& vars) = 0;
+};
+}
+}
+
+#endif  // _MADARA_FILTERS_KEYED_RECORD_FILTER_H_
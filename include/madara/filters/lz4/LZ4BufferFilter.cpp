@@ -2,24 +2,208 @@
 #ifdef _USE_LZ4_
 
 #include <string.h>
+#include <vector>
+
+// the dictionary functions are only in static builds of LZ4, which
+// MADARA is, as lz4_filters compiles LZ4 in
+#define LZ4_STATIC_LINKING_ONLY
+#define LZ4_HC_STATIC_LINKING_ONLY
+
 #include "LZ4BufferFilter.h"
 #include "lz4.h"
+#include "lz4hc.h"
 #include "madara/utility/Utility.h"
 #include "madara/logger/GlobalLogger.h"
 
+/**
+ * A dictionary and the LZ4 streams it is loaded into. Loading a
+ * dictionary is slow, so it is loaded once and attached to the
+ * stream of each packet.
+ **/
+struct madara::filters::LZ4BufferFilter::Dictionary
+{
+  Dictionary(const std::string& t_data)
+    : data(t_data), fast(LZ4_createStream()), hc(LZ4_createStreamHC())
+  {
+    LZ4_loadDict(fast, data.c_str(), (int)data.size());
+    LZ4_loadDictHC(hc, data.c_str(), (int)data.size());
+  }
+
+  ~Dictionary()
+  {
+    LZ4_freeStream(fast);
+    LZ4_freeStreamHC(hc);
+  }
+
+  Dictionary(const Dictionary&) = delete;
+  Dictionary& operator=(const Dictionary&) = delete;
+
+  /// the dictionary, which the streams point into
+  const std::string data;
+
+  /// the dictionary loaded for fast compression
+  LZ4_stream_t* fast;
+
+  /// the dictionary loaded for HC compression
+  LZ4_streamHC_t* hc;
+};
+
+namespace
+{
+/**
+ * The space and LZ4 state a thread compresses with
+ **/
+struct LZ4Scratch
+{
+  LZ4Scratch() : fast(LZ4_createStream()), hc(0) {}
+
+  ~LZ4Scratch()
+  {
+    LZ4_freeStream(fast);
+
+    if (hc)
+    {
+      LZ4_freeStreamHC(hc);
+    }
+  }
+
+  LZ4Scratch(const LZ4Scratch&) = delete;
+  LZ4Scratch& operator=(const LZ4Scratch&) = delete;
+
+  /// returns buffer with at least size bytes
+  char* reserve(int size)
+  {
+    if (buffer.size() < (size_t)size)
+    {
+      buffer.resize((size_t)size);
+    }
+
+    return buffer.data();
+  }
+
+  /// returns hc, creating it when first needed
+  LZ4_streamHC_t* get_hc(void)
+  {
+    if (!hc)
+    {
+      hc = LZ4_createStreamHC();
+    }
+
+    return hc;
+  }
+
+  /// holds the packet while it is encoded or decoded
+  std::vector<char> buffer;
+
+  /// the state for fast compression
+  LZ4_stream_t* fast;
+
+  /// the state for HC compression, which is far larger
+  LZ4_streamHC_t* hc;
+};
+
+#ifndef MADARA_NO_THREAD_LOCAL
+/// the calling thread's scratch. A plain pointer is cheaper to reach than
+/// a thread local object with a destructor.
+thread_local LZ4Scratch* thread_scratch = 0;
+
+/// frees the calling thread's scratch when the thread exits
+thread_local std::unique_ptr<LZ4Scratch> thread_scratch_owner;
+#endif
+
+/**
+ * Gets the calling thread's scratch, or if there is no thread local
+ * storage, scratch that lasts as long as the holder
+ **/
+class ScratchHolder
+{
+public:
+  LZ4Scratch& get(void)
+  {
+#ifndef MADARA_NO_THREAD_LOCAL
+    if (!thread_scratch)
+    {
+      thread_scratch_owner.reset(new LZ4Scratch);
+      thread_scratch = thread_scratch_owner.get();
+    }
+
+    return *thread_scratch;
+#else
+    if (!local_)
+    {
+      local_.reset(new LZ4Scratch);
+    }
+
+    return *local_;
+#endif
+  }
+
+private:
+#ifdef MADARA_NO_THREAD_LOCAL
+  std::unique_ptr<LZ4Scratch> local_;
+#endif
+};
+}
+
 int madara::filters::LZ4BufferFilter::encode(
     char* source, int size, int max_size) const
 {
-  char* source_copy = new char[buffer_size];
-  memcpy(source_copy, source, size);
+  ScratchHolder holder;
+  LZ4Scratch& scratch = holder.get();
+
+  // the packet can be no larger than it can be compressed to, or max_size
+  int capacity = LZ4_compressBound(size);
+  if (capacity > max_size)
+  {
+    capacity = max_size;
+  }
+
+  char* compressed = scratch.reserve(capacity);
 
   madara_logger_ptr_log(logger::global_logger.get_ptr(), logger::LOG_MINOR,
-      "LZ4BufferFilter::encode: calling LZ4_compress_default(%d,%d).\n", size,
-      max_size);
+      "LZ4BufferFilter::encode: compressing %d bytes into at most %d,"
+      " acceleration=%d, hc_level=%d, dictionary=%d.\n",
+      size, capacity, acceleration, hc_level,
+      dictionary_ ? (int)dictionary_->data.size() : 0);
+
+  int new_size = 0;
 
-  int new_size =
-      LZ4_compress_default(source_copy, (char*)source, size, max_size);
-  delete[] source_copy;
+  if (hc_level > 0)
+  {
+    LZ4_streamHC_t* stream = scratch.get_hc();
+
+    if (dictionary_)
+    {
+      LZ4_resetStreamHC_fast(stream, hc_level);
+      LZ4_attach_HC_dictionary(stream, dictionary_->hc);
+      new_size =
+          LZ4_compress_HC_continue(stream, source, compressed, size, capacity);
+    }
+    else
+    {
+      new_size = LZ4_compress_HC_extStateHC_fastReset(
+          stream, source, compressed, size, capacity, hc_level);
+    }
+  }
+  else if (dictionary_)
+  {
+    LZ4_resetStream_fast(scratch.fast);
+    LZ4_attach_dictionary(scratch.fast, dictionary_->fast);
+    new_size = LZ4_compress_fast_continue(
+        scratch.fast, source, compressed, size, capacity, acceleration);
+  }
+  else
+  {
+    // unlike LZ4_compress_fast_extState, does not clear all of the
+    // state, which would take longer than compressing most packets
+    new_size = LZ4_compress_fast_extState_fastReset(
+        scratch.fast, source, compressed, size, capacity, acceleration);
+  }
+
+  if (new_size > 0)
+  {
+    memcpy(source, compressed, (size_t)new_size);
+  }
 
   madara_logger_ptr_log(logger::global_logger.get_ptr(), logger::LOG_MINOR,
       "LZ4BufferFilter::encode: new_size=%d.\n", new_size);
@@ -32,16 +216,30 @@ int madara::filters::LZ4BufferFilter::encode(
 int madara::filters::LZ4BufferFilter::decode(
     char* source, int size, int max_size) const
 {
-  char* source_copy = new char[buffer_size];
-  memcpy(source_copy, source, size);
+  ScratchHolder holder;
+  LZ4Scratch& scratch = holder.get();
+
+  // the packet is decompressed over itself, so only the compressed bytes
+  // need to be moved out of the way
+  char* compressed = scratch.reserve(size);
+  memcpy(compressed, source, (size_t)size);
 
   madara_logger_ptr_log(logger::global_logger.get_ptr(), logger::LOG_MINOR,
-      "LZ4BufferFilter::decode: calling LZ4_decompress_safe(%d,%d).\n", size,
-      max_size);
+      "LZ4BufferFilter::decode: decompressing %d bytes into at most %d,"
+      " dictionary=%d.\n",
+      size, max_size, dictionary_ ? (int)dictionary_->data.size() : 0);
 
-  int new_size =
-      LZ4_decompress_safe(source_copy, (char*)source, size, max_size);
-  delete[] source_copy;
+  int new_size = 0;
+
+  if (dictionary_)
+  {
+    new_size = LZ4_decompress_safe_usingDict(compressed, source, size,
+        max_size, dictionary_->data.c_str(), (int)dictionary_->data.size());
+  }
+  else
+  {
+    new_size = LZ4_decompress_safe(compressed, source, size, max_size);
+  }
 
   madara_logger_ptr_log(logger::global_logger.get_ptr(), logger::LOG_MINOR,
       "LZ4BufferFilter::decode: new_size=%d.\n", new_size);
@@ -51,6 +249,27 @@ int madara::filters::LZ4BufferFilter::decode(
   return new_size > 0 ? new_size : 0;
 }
 
+void madara::filters::LZ4BufferFilter::set_dictionary(
+    const std::string& dictionary)
+{
+  if (dictionary.empty())
+  {
+    dictionary_.reset();
+  }
+  else
+  {
+    dictionary_ = std::make_shared<const Dictionary>(dictionary);
+  }
+}
+
+const std::string& madara::filters::LZ4BufferFilter::get_dictionary(
+    void) const
+{
+  static const std::string empty;
+
+  return dictionary_ ? dictionary_->data : empty;
+}
+
 std::string madara::filters::LZ4BufferFilter::get_id(void)
 {
   return "lz4";
@@ -61,4 +280,4 @@ uint32_t madara::filters::LZ4BufferFilter::get_version(void)
   return madara::utility::get_uint_version("1.0.0");
 }
 
-#endif  // _USE_SSL_
+#endif  // _USE_LZ4_
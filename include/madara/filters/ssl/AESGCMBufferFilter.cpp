@@ -0,0 +1,359 @@
+
+#ifdef _USE_SSL_
+
+#include <algorithm>
+#include <memory>
+#include <string.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include "AESGCMBufferFilter.h"
+
+#include "madara/utility/Utility.h"
+
+#include "madara/logger/GlobalLogger.h"
+
+namespace
+{
+/// the bytes of a nonce
+const int NONCE_SIZE = 12;
+
+/// the bytes of an authentication tag
+const int TAG_SIZE = 16;
+
+/// the next id to give a key, starting at 1 so no context has it yet
+std::atomic<uint64_t> next_key_id(1);
+
+/**
+ * The cipher contexts and nonces of a thread
+ **/
+struct GCMScratch
+{
+  GCMScratch()
+    : encrypt(EVP_CIPHER_CTX_new()),
+      decrypt(EVP_CIPHER_CTX_new()),
+      encrypt_key(0),
+      decrypt_key(0),
+      sequence(0)
+  {
+    // each thread starts its nonces from a random point, so nonces are not
+    // reused across threads, filters or processes that share a key
+    if (RAND_bytes(nonce, NONCE_SIZE) != 1)
+    {
+      madara_logger_ptr_log(madara::logger::global_logger.get_ptr(),
+          madara::logger::LOG_ERROR,
+          "AESGCMBufferFilter: RAND_bytes failed. Nonces use the clock.\n");
+
+      int64_t now = madara::utility::get_time();
+      memcpy(nonce, &now, sizeof(now));
+      memcpy(nonce + sizeof(now), &encrypt, NONCE_SIZE - sizeof(now));
+    }
+
+    memcpy(&sequence, nonce + NONCE_SIZE - sizeof(sequence),
+        sizeof(sequence));
+  }
+
+  ~GCMScratch()
+  {
+    EVP_CIPHER_CTX_free(encrypt);
+    EVP_CIPHER_CTX_free(decrypt);
+  }
+
+  GCMScratch(const GCMScratch&) = delete;
+  GCMScratch& operator=(const GCMScratch&) = delete;
+
+  /// moves to the next nonce, counting in its last 8 bytes
+  const unsigned char* next_nonce(void)
+  {
+    ++sequence;
+    memcpy(nonce + NONCE_SIZE - sizeof(sequence), &sequence,
+        sizeof(sequence));
+    return nonce;
+  }
+
+  /// the context that encrypts
+  EVP_CIPHER_CTX* encrypt;
+
+  /// the context that decrypts
+  EVP_CIPHER_CTX* decrypt;
+
+  /// the id of the key set up in encrypt, or 0
+  uint64_t encrypt_key;
+
+  /// the id of the key set up in decrypt, or 0
+  uint64_t decrypt_key;
+
+  /// the last nonce used
+  unsigned char nonce[NONCE_SIZE];
+
+  /// the counting part of nonce
+  uint64_t sequence;
+};
+
+#ifndef MADARA_NO_THREAD_LOCAL
+/// the calling thread's scratch. A plain pointer is cheaper to reach than
+/// a thread local object with a destructor.
+thread_local GCMScratch* thread_scratch = 0;
+
+/// frees the calling thread's scratch when the thread exits
+thread_local std::unique_ptr<GCMScratch> thread_scratch_owner;
+#endif
+
+/**
+ * Gets the calling thread's scratch, or if there is no thread local
+ * storage, scratch that lasts as long as the holder
+ **/
+class ScratchHolder
+{
+public:
+  GCMScratch& get(void)
+  {
+#ifndef MADARA_NO_THREAD_LOCAL
+    if (!thread_scratch)
+    {
+      thread_scratch_owner.reset(new GCMScratch);
+      thread_scratch = thread_scratch_owner.get();
+    }
+
+    return *thread_scratch;
+#else
+    if (!local_)
+    {
+      local_.reset(new GCMScratch);
+    }
+
+    return *local_;
+#endif
+  }
+
+private:
+#ifdef MADARA_NO_THREAD_LOCAL
+  std::unique_ptr<GCMScratch> local_;
+#endif
+};
+}
+
+madara::filters::AESGCMBufferFilter::AESGCMBufferFilter() : rejected_(0)
+{
+  memset(key_, 0, sizeof(key_));
+  new_key();
+}
+
+madara::filters::AESGCMBufferFilter::AESGCMBufferFilter(
+    const AESGCMBufferFilter& input)
+  : key_id_(input.key_id_), rejected_(0)
+{
+  memcpy(key_, input.key_, sizeof(key_));
+}
+
+madara::filters::AESGCMBufferFilter::AESGCMBufferFilter(
+    const unsigned char* key, int key_length)
+  : rejected_(0)
+{
+  memset(key_, 0, sizeof(key_));
+  memcpy(key_, key, std::min((int)sizeof(key_), std::max(key_length, 0)));
+  new_key();
+}
+
+void madara::filters::AESGCMBufferFilter::new_key(void)
+{
+  key_id_ = next_key_id++;
+}
+
+int madara::filters::AESGCMBufferFilter::generate_key(
+    const std::string& password)
+{
+  int i, rounds = 10000;
+
+  // use the salt of AESBufferFilter
+  int64_t salt = 0x70e4ed2d19a447ef;
+  unsigned char iv[16];
+
+  i = EVP_BytesToKey(EVP_aes_256_cbc(), EVP_sha256(), (unsigned char*)&salt,
+      (unsigned char*)password.c_str(), (int)password.length(), rounds, key_,
+      iv);
+
+  new_key();
+
+  if (i != 32)
+  {
+    madara_logger_ptr_log(logger::global_logger.get_ptr(), logger::LOG_ERROR,
+        " Unable to initialize 256 bit AES-GCM. Only received %d bytes.\n", i);
+
+    return -1;
+  }
+
+  return 0;
+}
+
+int madara::filters::AESGCMBufferFilter::encode(
+    char* source, int size, int max_size) const
+{
+  if (size < 0 || size > max_size - OVERHEAD)
+  {
+    madara_logger_ptr_log(logger::global_logger.get_ptr(), logger::LOG_ERROR,
+        "AESGCMBufferFilter::encode: %d bytes and a %d byte nonce and tag"
+        " cannot fit in %d byte buffer.\n",
+        size, OVERHEAD, max_size);
+
+    return 0;
+  }
+
+  ScratchHolder holder;
+  GCMScratch& scratch = holder.get();
+  EVP_CIPHER_CTX* ctx = scratch.encrypt;
+
+  unsigned char* text = (unsigned char*)source;
+  unsigned char* nonce = text + size;
+  unsigned char* tag = nonce + NONCE_SIZE;
+
+  memcpy(nonce, scratch.next_nonce(), NONCE_SIZE);
+
+  int result = 1;
+
+  // setting up the key is the slow part, so only do it when it changes
+  if (scratch.encrypt_key != key_id_)
+  {
+    result = EVP_EncryptInit_ex(ctx, EVP_aes_256_gcm(), NULL, key_, nonce);
+    scratch.encrypt_key = result == 1 ? key_id_ : 0;
+  }
+  else
+  {
+    result = EVP_EncryptInit_ex(ctx, NULL, NULL, NULL, nonce);
+  }
+
+  if (result != 1)
+  {
+    madara_logger_ptr_log(logger::global_logger.get_ptr(), logger::LOG_ERROR,
+        "AESGCMBufferFilter::encode: Cannot init key/nonce. Result=%d.\n",
+        result);
+
+    return 0;
+  }
+
+  int len = 0, final_len = 0;
+
+  result = EVP_EncryptUpdate(ctx, text, &len, text, size);
+
+  if (result == 1)
+  {
+    result = EVP_EncryptFinal_ex(ctx, text + len, &final_len);
+  }
+
+  if (result == 1)
+  {
+    result = EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, TAG_SIZE, tag);
+  }
+
+  if (result != 1 || len + final_len != size)
+  {
+    madara_logger_ptr_log(logger::global_logger.get_ptr(), logger::LOG_ERROR,
+        "AESGCMBufferFilter::encode: Cannot perform encrypt. Result=%d.\n",
+        result);
+
+    return 0;
+  }
+
+  madara_logger_ptr_log(logger::global_logger.get_ptr(), logger::LOG_MINOR,
+      "AESGCMBufferFilter::encode: encrypted %d bytes.\n", size);
+
+  return size + OVERHEAD;
+}
+
+int madara::filters::AESGCMBufferFilter::decode(
+    char* source, int size, int max_size) const
+{
+  size = std::min(size, max_size);
+
+  if (size < OVERHEAD)
+  {
+    madara_logger_ptr_log(logger::global_logger.get_ptr(), logger::LOG_MAJOR,
+        "AESGCMBufferFilter::decode: %d bytes is too short for a nonce and"
+        " tag. Dropping it.\n",
+        size);
+
+    ++rejected_;
+    return 0;
+  }
+
+  ScratchHolder holder;
+  GCMScratch& scratch = holder.get();
+  EVP_CIPHER_CTX* ctx = scratch.decrypt;
+
+  int text_size = size - OVERHEAD;
+  unsigned char* text = (unsigned char*)source;
+  unsigned char* nonce = text + text_size;
+  unsigned char* tag = nonce + NONCE_SIZE;
+
+  int result = 1;
+
+  if (scratch.decrypt_key != key_id_)
+  {
+    result = EVP_DecryptInit_ex(ctx, EVP_aes_256_gcm(), NULL, key_, nonce);
+    scratch.decrypt_key = result == 1 ? key_id_ : 0;
+  }
+  else
+  {
+    result = EVP_DecryptInit_ex(ctx, NULL, NULL, NULL, nonce);
+  }
+
+  if (result != 1)
+  {
+    madara_logger_ptr_log(logger::global_logger.get_ptr(), logger::LOG_ERROR,
+        "AESGCMBufferFilter::decode: Cannot init key/nonce. Result=%d.\n",
+        result);
+
+    return 0;
+  }
+
+  int len = 0, final_len = 0;
+
+  result = EVP_DecryptUpdate(ctx, text, &len, text, text_size);
+
+  if (result == 1)
+  {
+    result = EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, TAG_SIZE, tag);
+  }
+
+  // checks the tag
+  if (result == 1)
+  {
+    result = EVP_DecryptFinal_ex(ctx, text + len, &final_len);
+  }
+
+  if (result != 1)
+  {
+    // do not leave text that failed authentication lying in the buffer
+    memset(text, 0, (size_t)text_size);
+
+    ++rejected_;
+
+    madara_logger_ptr_log(logger::global_logger.get_ptr(), logger::LOG_MAJOR,
+        "AESGCMBufferFilter::decode: %d bytes failed authentication."
+        " Dropping them.\n",
+        size);
+
+    return 0;
+  }
+
+  madara_logger_ptr_log(logger::global_logger.get_ptr(), logger::LOG_MINOR,
+      "AESGCMBufferFilter::decode: decrypted %d bytes.\n", text_size);
+
+  return text_size;
+}
+
+std::string madara::filters::AESGCMBufferFilter::get_id(void)
+{
+  return "aesgcm";
+}
+
+uint32_t madara::filters::AESGCMBufferFilter::get_version(void)
+{
+  return madara::utility::get_uint_version("1.0.0");
+}
+
+uint64_t madara::filters::AESGCMBufferFilter::get_rejected(void) const
+{
+  return rejected_;
+}
+
+#endif  // _USE_SSL_
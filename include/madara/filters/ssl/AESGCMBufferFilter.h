@@ -0,0 +1,132 @@
+#ifndef _MADARA_FILTERS_SSL_AES_GCM_H_
+#define _MADARA_FILTERS_SSL_AES_GCM_H_
+
+/**
+ * @file AESGCMBufferFilter.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains a filter functor for authenticated 256 bit AES-GCM
+ * encryption
+ **/
+
+#ifdef _USE_SSL_
+
+#include <string>
+#include <atomic>
+
+#include "madara/MadaraExport.h"
+#include "madara/utility/StdInt.h"
+#include "../BufferFilter.h"
+
+namespace madara
+{
+namespace filters
+{
+/**
+ * @class AESGCMBufferFilter
+ * @brief Encrypts and authenticates a buffer with 256 bit AES-GCM via
+ *        OpenSSL, which uses the AES and carry-less multiply instructions
+ *        of the processor where it has them. Unlike AESBufferFilter, each
+ *        message has its own nonce, so equal messages do not encrypt the
+ *        same, and messages that were changed or forged are dropped rather
+ *        than decoded into garbage.
+ *
+ *        Messages are encrypted in place, without padding, and followed by
+ *        their nonce and tag: [ciphertext][12 byte nonce][16 byte tag].
+ *        Each thread keeps its cipher contexts, with the key already set
+ *        up, and its own sequence of nonces.
+ */
+class MADARA_EXPORT AESGCMBufferFilter : public BufferFilter
+{
+public:
+  /// the bytes added to each message
+  static const int OVERHEAD = 28;
+
+  /**
+   * Constructor, with a key of zeros
+   **/
+  AESGCMBufferFilter();
+
+  /**
+   * Copy constructor
+   * @param  input   the buffer filter to copy
+   **/
+  AESGCMBufferFilter(const AESGCMBufferFilter& input);
+
+  /**
+   * 256 bit key constructor
+   * @param  key         the key to use for encryption
+   * @param  key_length  the length of the key
+   **/
+  AESGCMBufferFilter(const unsigned char* key, int key_length);
+
+  /**
+   * Destructor
+   **/
+  virtual ~AESGCMBufferFilter() = default;
+
+  /**
+   * Generates a 256 bit key from a password, as AESBufferFilter does
+   * @param  password   a password to seed the key with
+   * @return  0 on success, -1 on error
+   **/
+  int generate_key(const std::string& password);
+
+  /**
+   * Encrypts the buffer in place and appends its nonce and tag
+   * @param   source           the source and destination buffer
+   * @param   size             the amount of data in the buffer in bytes
+   * @param   max_size         the amount of bytes the buffer can hold,
+   *                           which must be at least size + OVERHEAD
+   * @return  the new size after encoding, or 0 on error
+   **/
+  virtual int encode(char* source, int size, int max_size) const;
+
+  /**
+   * Checks and decrypts the buffer in place
+   * @param   source           the source and destination buffer
+   * @param   size             the amount of data in the buffer in bytes
+   * @param   max_size         the amount of bytes the buffer can hold
+   * @return  the new size after decoding, or 0 if the message failed
+   *          authentication, which drops it
+   **/
+  virtual int decode(char* source, int size, int max_size) const;
+
+  /**
+   * Gets the id of the filter. This is used in the serialization process
+   * for transports and checkpoints to identify which filter is used.
+   **/
+  virtual std::string get_id(void);
+
+  /**
+   * Gets the version of the filter. @see madara::utility::get_uint_version
+   * for one way to get this from a string version
+   **/
+  virtual uint32_t get_version(void);
+
+  /**
+   * Returns the number of messages this filter has dropped because they
+   * failed authentication, e.g., because they were changed, forged or
+   * encrypted with another key
+   **/
+  uint64_t get_rejected(void) const;
+
+private:
+  /// gives the key a new id, so threads set it up in their contexts
+  void new_key(void);
+
+  /// the user's cypher key
+  unsigned char key_[32];
+
+  /// identifies key_ to the cipher contexts of each thread
+  uint64_t key_id_;
+
+  /// messages that failed authentication
+  mutable std::atomic<uint64_t> rejected_;
+};
+}
+}
+
+#endif  // _USE_SSL_
+
+#endif  // _MADARA_FILTERS_SSL_AES_GCM_H_
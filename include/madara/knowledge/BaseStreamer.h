@@ -33,6 +33,21 @@ public:
    * @param record a copy of the new value
    **/
   virtual void enqueue(std::string name, KnowledgeRecord record) = 0;
+
+  /**
+   * Called by the KnowledgeBase instead of the other overload, so that
+   * streamers which keep their own copy of the name need not construct a
+   * std::string for every modification. By default, forwards to the other
+   * overload.
+   *
+   * @param name the variable name of the KnowledgeRecord, which is only
+   *   valid during the call
+   * @param record the new value
+   **/
+  virtual void enqueue(const char* name, const KnowledgeRecord& record)
+  {
+    enqueue(std::string(name), record);
+  }
 };
 }
 }  // namespace madara::knowledge
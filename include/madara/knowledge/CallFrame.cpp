@@ -0,0 +1,116 @@
+#include <deque>
+#include <memory>
+
+#include "madara/knowledge/CallFrame.h"
+
+#ifndef MADARA_NO_THREAD_LOCAL
+
+namespace madara
+{
+namespace knowledge
+{
+/// a thread's stack of frames
+struct CallStack
+{
+  /// a frame on the stack
+  struct Frame
+  {
+    /// the arguments of the call
+    FunctionArguments args;
+
+    /// true if the arguments have been bound to .0, .1, etc.
+    bool bound = false;
+  };
+
+  /// the frames, including popped ones. A deque keeps the arguments of
+  /// frames in place as it grows.
+  std::deque<Frame> frames;
+
+  /// the number of frames in use
+  size_t top = 0;
+};
+}
+}
+
+namespace
+{
+/// the calling thread's stack. A plain pointer is cheaper to reach than
+/// a thread local object with a destructor.
+thread_local madara::knowledge::CallStack* current = 0;
+
+/// frees the calling thread's stack when the thread exits
+thread_local std::unique_ptr<madara::knowledge::CallStack> owner;
+}
+
+#endif
+
+madara::knowledge::CallFrame::CallFrame(size_t size)
+  : args_(&local_), depth_(0)
+{
+#ifndef MADARA_NO_THREAD_LOCAL
+  stack_ = 0;
+
+  // a call without arguments has nothing to hold or to bind
+  if (size == 0)
+    return;
+
+  if (current == 0)
+  {
+    owner.reset(new CallStack());
+    current = owner.get();
+  }
+
+  stack_ = current;
+  depth_ = stack_->top++;
+
+  if (depth_ == stack_->frames.size())
+    stack_->frames.emplace_back();
+
+  CallStack::Frame& frame = stack_->frames[depth_];
+  frame.bound = false;
+  args_ = &frame.args;
+#endif
+
+  args_->resize(size);
+}
+
+madara::knowledge::CallFrame::~CallFrame()
+{
+#ifndef MADARA_NO_THREAD_LOCAL
+  if (stack_ != 0)
+  {
+    // release strings and arrays now, rather than when the frame is reused
+    for (KnowledgeRecord& arg : *args_)
+      arg.clear_value();
+
+    --stack_->top;
+  }
+#endif
+}
+
+void madara::knowledge::CallFrame::bind(void)
+{
+#ifndef MADARA_NO_THREAD_LOCAL
+  if (stack_ != 0)
+    stack_->frames[depth_].bound = true;
+#endif
+}
+
+const madara::knowledge::FunctionArguments*
+madara::knowledge::CallFrame::caller(void) const
+{
+#ifndef MADARA_NO_THREAD_LOCAL
+  if (stack_ == 0)
+    return 0;
+
+  for (size_t i = depth_; i > 0; --i)
+  {
+    const CallStack::Frame& frame = stack_->frames[i - 1];
+
+    if (frame.bound)
+      return &frame.args;
+  }
+#endif
+
+  return 0;
+}
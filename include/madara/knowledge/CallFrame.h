@@ -0,0 +1,93 @@
+#ifndef _MADARA_KNOWLEDGE_CALL_FRAME_H_
+#define _MADARA_KNOWLEDGE_CALL_FRAME_H_
+
+/**
+ * @file CallFrame.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the CallFrame class, which holds the arguments of a
+ * function call on a stack that each thread reuses from call to call
+ **/
+
+#include <stddef.h>
+
+#include "madara/MadaraExport.h"
+#include "madara/knowledge/FunctionArguments.h"
+
+namespace madara
+{
+namespace knowledge
+{
+struct CallStack;
+
+/**
+ * @class CallFrame
+ * @brief The arguments of a function call, pushed onto the calling
+ *        thread's stack of frames for the life of the call. Frames are
+ *        kept when popped, so once the stack has grown to the deepest
+ *        nesting of calls, calls no longer allocate for their arguments.
+ *
+ *        Calls without arguments are not put on the stack. Without
+ *        thread local storage (MADARA_NO_THREAD_LOCAL), no frames are,
+ *        so each frame holds its own arguments and no frame has a
+ *        caller.
+ **/
+class MADARA_EXPORT CallFrame
+{
+public:
+  /**
+   * Constructor. Pushes a frame onto the calling thread's stack.
+   * @param  size   the number of arguments
+   **/
+  CallFrame(size_t size);
+
+  /**
+   * Destructor. Pops the frame, which must be the top of the stack.
+   **/
+  ~CallFrame();
+
+  CallFrame(const CallFrame&) = delete;
+  CallFrame& operator=(const CallFrame&) = delete;
+
+  /**
+   * Gets the arguments of the call
+   * @return the arguments
+   **/
+  FunctionArguments& args(void)
+  {
+    return *args_;
+  }
+
+  /**
+   * Marks the arguments as bound to the argument variables (.0, .1, etc.)
+   **/
+  void bind(void);
+
+  /**
+   * Gets the arguments of the innermost call below this frame that has
+   * bound its arguments, i.e., the values the argument variables should
+   * have once this call returns
+   * @return the arguments of the caller, or 0 if there is no such call
+   **/
+  const FunctionArguments* caller(void) const;
+
+private:
+  /// the arguments of the call
+  FunctionArguments* args_;
+
+  /// the number of frames below this one on the stack
+  size_t depth_;
+
+#ifndef MADARA_NO_THREAD_LOCAL
+  /// the stack of the thread that made the call, or 0 if the frame is
+  /// not on the stack
+  CallStack* stack_;
+#endif
+
+  /// the arguments, if the frame is not on the stack
+  FunctionArguments local_;
+};
+}
+}
+
+#endif  // _MADARA_KNOWLEDGE_CALL_FRAME_H_
@@ -0,0 +1,276 @@
+#include <algorithm>
+#include <string.h>
+
+#include "CheckpointIndex.h"
+#include "madara/utility/Utility.h"
+
+namespace madara
+{
+namespace knowledge
+{
+namespace
+{
+/// marks the start and the end of an index footer
+const char index_type[8] = {'K', 'a', 'R', 'L', 'I', 'd', 'x', '1'};
+
+/// the size of the offset and index_type that end the file
+const uint64_t trailer_size = sizeof(uint64_t) + sizeof(index_type);
+
+void write_uint64(std::string& buffer, uint64_t value)
+{
+  value = utility::endian_swap(value);
+  buffer.append((const char*)&value, sizeof(value));
+}
+
+/**
+ * Reads values from an index footer, failing rather than reading past the
+ * end of it
+ **/
+class FooterReader
+{
+public:
+  FooterReader(const std::vector<char>& buffer)
+    : current_(buffer.data()), remaining_(buffer.size())
+  {
+  }
+
+  bool read(uint64_t& value)
+  {
+    if (remaining_ < sizeof(value))
+    {
+      return false;
+    }
+
+    memcpy(&value, current_, sizeof(value));
+    value = utility::endian_swap(value);
+    current_ += sizeof(value);
+    remaining_ -= sizeof(value);
+    return true;
+  }
+
+  bool read(std::string& value, uint64_t size)
+  {
+    if (remaining_ < size)
+    {
+      return false;
+    }
+
+    value.assign(current_, (size_t)size);
+    current_ += size;
+    remaining_ -= size;
+    return true;
+  }
+
+  /// checks there is room left for count entries of a given size
+  bool fits(uint64_t count, uint64_t size) const
+  {
+    return count <= remaining_ / size;
+  }
+
+private:
+  const char* current_;
+  uint64_t remaining_;
+};
+}
+
+void CheckpointIndex::add_state(uint64_t offset, uint64_t clock)
+{
+  State state{offset, 0, clock};
+
+  if (states_.size() > 0)
+  {
+    state.toi = states_.back().toi;
+    state.clock = std::max(state.clock, states_.back().clock);
+  }
+
+  states_.push_back(state);
+}
+
+void CheckpointIndex::add_name(const std::string& name, uint64_t toi)
+{
+  uint64_t current = states_.size() - 1;
+
+  State& state = states_.back();
+  state.toi = std::max(state.toi, toi);
+
+  Runs& runs = names_[name];
+
+  if (runs.size() > 0 && runs.back().second >= current)
+  {
+    runs.back().second = current + 1;
+  }
+  else
+  {
+    runs.push_back(Run(current, current + 1));
+  }
+}
+
+size_t CheckpointIndex::find_toi(uint64_t toi) const
+{
+  return std::lower_bound(states_.begin(), states_.end(), toi,
+             [](const State& state, uint64_t value) {
+               return state.toi < value;
+             }) -
+         states_.begin();
+}
+
+size_t CheckpointIndex::find_clock(uint64_t clock) const
+{
+  return std::lower_bound(states_.begin(), states_.end(), clock,
+             [](const State& state, uint64_t value) {
+               return state.clock < value;
+             }) -
+         states_.begin();
+}
+
+const CheckpointIndex::Runs* CheckpointIndex::find(
+    const std::string& name) const
+{
+  auto found = names_.find(name);
+
+  return found != names_.end() ? &found->second : 0;
+}
+
+void CheckpointIndex::clear(void)
+{
+  states_.clear();
+  names_.clear();
+  end_ = 0;
+}
+
+bool CheckpointIndex::read(std::istream& file, uint64_t end)
+{
+  clear();
+
+  file.clear();
+  file.seekg(0, file.end);
+  uint64_t length = (uint64_t)file.tellg();
+
+  // the smallest index has no states or names
+  if (!file || length < end + sizeof(index_type) + sizeof(uint64_t) * 2 +
+                            trailer_size)
+  {
+    file.clear();
+    return false;
+  }
+
+  char trailer[trailer_size];
+  file.seekg(length - trailer_size, file.beg);
+
+  if (!file.read(trailer, trailer_size) ||
+      memcmp(trailer + sizeof(uint64_t), index_type, sizeof(index_type)) != 0)
+  {
+    file.clear();
+    return false;
+  }
+
+  uint64_t offset;
+  memcpy(&offset, trailer, sizeof(offset));
+
+  if (utility::endian_swap(offset) != end)
+  {
+    return false;
+  }
+
+  std::vector<char> buffer((size_t)(length - trailer_size - end));
+  file.seekg(end, file.beg);
+
+  if (!file.read(buffer.data(), buffer.size()) ||
+      memcmp(buffer.data(), index_type, sizeof(index_type)) != 0)
+  {
+    file.clear();
+    return false;
+  }
+
+  std::string type;
+  FooterReader reader(buffer);
+  reader.read(type, sizeof(index_type));
+
+  uint64_t states = 0;
+  if (!reader.read(states) || !reader.fits(states, sizeof(State)))
+  {
+    return false;
+  }
+
+  states_.resize((size_t)states);
+  for (State& state : states_)
+  {
+    reader.read(state.offset);
+    reader.read(state.toi);
+    reader.read(state.clock);
+  }
+
+  uint64_t names = 0;
+  if (!reader.read(names))
+  {
+    clear();
+    return false;
+  }
+
+  for (uint64_t i = 0; i < names; ++i)
+  {
+    uint64_t size = 0, count = 0;
+    std::string name;
+
+    if (!reader.read(size) || !reader.read(name, size) ||
+        !reader.read(count) || !reader.fits(count, sizeof(Run)))
+    {
+      clear();
+      return false;
+    }
+
+    Runs& runs = names_[name];
+    runs.resize((size_t)count);
+
+    for (Run& run : runs)
+    {
+      reader.read(run.first);
+      reader.read(run.second);
+    }
+  }
+
+  end_ = end;
+
+  return true;
+}
+
+void CheckpointIndex::write(std::ostream& file, uint64_t end)
+{
+  std::string buffer;
+  buffer.reserve(sizeof(index_type) + sizeof(uint64_t) * 2 +
+                 states_.size() * sizeof(State) + trailer_size);
+
+  buffer.append(index_type, sizeof(index_type));
+
+  write_uint64(buffer, states_.size());
+  for (const State& state : states_)
+  {
+    write_uint64(buffer, state.offset);
+    write_uint64(buffer, state.toi);
+    write_uint64(buffer, state.clock);
+  }
+
+  write_uint64(buffer, names_.size());
+  for (const auto& name : names_)
+  {
+    write_uint64(buffer, name.first.size());
+    buffer.append(name.first);
+
+    write_uint64(buffer, name.second.size());
+    for (const Run& run : name.second)
+    {
+      write_uint64(buffer, run.first);
+      write_uint64(buffer, run.second);
+    }
+  }
+
+  write_uint64(buffer, end);
+  buffer.append(index_type, sizeof(index_type));
+
+  file.seekp(end, file.beg);
+  file.write(buffer.data(), buffer.size());
+
+  end_ = end;
+}
+}
+}
@@ -0,0 +1,193 @@
+#ifndef _MADARA_KNOWLEDGE_CHECKPOINT_INDEX_H_
+#define _MADARA_KNOWLEDGE_CHECKPOINT_INDEX_H_
+
+/**
+ * @file CheckpointIndex.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the CheckpointIndex class, which locates the states
+ * of a checkpoint file by time, lamport clock and variable name
+ **/
+
+#include <string>
+#include <vector>
+#include <map>
+#include <istream>
+#include <ostream>
+
+#include "madara/utility/StdInt.h"
+#include "madara/MadaraExport.h"
+
+namespace madara
+{
+namespace knowledge
+{
+/**
+ * @class CheckpointIndex
+ * @brief An index of the states in a checkpoint file, which is saved as a
+ *        footer after the last state when CheckpointSettings::keep_index
+ *        is set. Readers that do not know about the footer ignore it,
+ *        since it lies past the size given in the FileHeader.
+ *
+ *        Format:
+ *
+ *       [00] [8 byte index_type = "KaRLIdx1"] <br />
+ *       [08] [64 bit states] <br />
+ *       [16] [states * (64 bit offset, 64 bit toi, 64 bit clock)] <br />
+ *       [..] [64 bit names] <br />
+ *       [..] [names * (64 bit length, name, 64 bit runs,
+ *                      runs * (64 bit first state, 64 bit end state))] <br />
+ *       [..] [64 bit offset of the index in the file] <br />
+ *       [..] [8 byte index_type = "KaRLIdx1"]
+ *
+ *        The toi and clock of a state are the largest of any state up to
+ *        and including it, so both only increase from state to state and
+ *        can be searched by bisection. The states that update a variable
+ *        are kept as runs of consecutive states, so a variable saved in
+ *        every state costs the same as one saved once.
+ */
+class MADARA_EXPORT CheckpointIndex
+{
+public:
+  /**
+   * Where a state is in the file and how far it reaches in time
+   **/
+  struct State
+  {
+    /// the offset of the state in the file
+    uint64_t offset;
+
+    /// the largest record toi of this state or any before it
+    uint64_t toi;
+
+    /// the largest lamport clock of this state or any before it
+    uint64_t clock;
+  };
+
+  /**
+   * A run of consecutive states [first, end)
+   **/
+  typedef std::pair<uint64_t, uint64_t> Run;
+
+  /**
+   * The runs of states that updated a variable, in order
+   **/
+  typedef std::vector<Run> Runs;
+
+  /**
+   * Adds a state to the index. Names added afterwards belong to it.
+   * @param  offset   the offset of the state in the file
+   * @param  clock    the lamport clock of the state
+   **/
+  void add_state(uint64_t offset, uint64_t clock);
+
+  /**
+   * Notes that the last state added updates a variable
+   * @param  name     the name of the variable
+   * @param  toi      the time of the update
+   **/
+  void add_name(const std::string& name, uint64_t toi);
+
+  /**
+   * Returns the number of states in the index
+   **/
+  size_t size(void) const
+  {
+    return states_.size();
+  }
+
+  /**
+   * Returns a state in the index
+   * @param  state    the ordinal of the state, less than size ()
+   **/
+  const State& state(size_t state) const
+  {
+    return states_[state];
+  }
+
+  /**
+   * Finds the first state whose updates reach a time
+   * @param  toi      the time to find
+   * @return the first state with a record at or after toi, or size ()
+   *         if the checkpoint ends before it
+   **/
+  size_t find_toi(uint64_t toi) const;
+
+  /**
+   * Finds the first state that reaches a lamport clock
+   * @param  clock    the clock to find
+   * @return the first state with a clock at or after clock, or size ()
+   *         if the checkpoint ends before it
+   **/
+  size_t find_clock(uint64_t clock) const;
+
+  /**
+   * Finds the states that update a variable
+   * @param  name     the name of the variable
+   * @return the runs of states, or 0 if no state updates the variable
+   **/
+  const Runs* find(const std::string& name) const;
+
+  /**
+   * Returns the runs of states of every variable, by name
+   **/
+  const std::map<std::string, Runs>& names(void) const
+  {
+    return names_;
+  }
+
+  /**
+   * Returns the offset just past the last state, which is where the
+   * index was read from or last written to
+   **/
+  uint64_t end(void) const
+  {
+    return end_;
+  }
+
+  /**
+   * Sets the offset just past the last state
+   * @param  end      the offset
+   **/
+  void set_end(uint64_t end)
+  {
+    end_ = end;
+  }
+
+  /**
+   * Removes all states and names from the index
+   **/
+  void clear(void);
+
+  /**
+   * Reads the index from the footer of a checkpoint file
+   * @param  file     the checkpoint file
+   * @param  end      the offset just past the last state, i.e., the size
+   *                  in the FileHeader plus the size of the FileHeader
+   * @return true if the file has an index at end. Footers left over from
+   *         before a state was appended without an index are not
+   *         mistaken for one, since they do not point at end.
+   **/
+  bool read(std::istream& file, uint64_t end);
+
+  /**
+   * Writes the index into a checkpoint file as a footer
+   * @param  file     the checkpoint file
+   * @param  end      the offset just past the last state
+   **/
+  void write(std::ostream& file, uint64_t end);
+
+private:
+  /// the states, in the order they are in the file
+  std::vector<State> states_;
+
+  /// the states that update each variable
+  std::map<std::string, Runs> names_;
+
+  /// the offset just past the last state
+  uint64_t end_ = 0;
+};
+}
+}
+
+#endif  // _MADARA_KNOWLEDGE_CHECKPOINT_INDEX_H_
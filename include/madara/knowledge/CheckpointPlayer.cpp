@@ -1,5 +1,7 @@
 #include <fstream>
 #include <chrono>
+#include <algorithm>
+#include <map>
 
 #include "madara/logger/GlobalLogger.h"
 #include "madara/exceptions/MemoryException.h"
@@ -18,6 +20,12 @@ namespace madara
 {
 namespace knowledge
 {
+namespace
+{
+/// how much of a mapped file to read before giving its pages back
+const size_t release_size = 4 * 1024 * 1024;
+}
+
 void CheckpointReader::start()
 {
   if (stage != 0)
@@ -47,8 +55,28 @@ void CheckpointReader::start()
   max_buffer = checkpoint_settings.buffer_size;
   buffer_remaining = max_buffer;
 
-  buffer = new char[max_buffer];
-  current = buffer.get_ptr();
+  // decode straight from a mapping of the file, unless buffer filters
+  // need a buffer to decode into
+  if (checkpoint_settings.map_file &&
+      checkpoint_settings.buffer_filters.size() == 0 &&
+      !mapping.open(checkpoint_settings.filename))
+  {
+    madara_logger_ptr_log(logger_, logger::LOG_MAJOR,
+        "ThreadSafeContext::load_context:"
+        " could not map file %s. Reading it instead.\n",
+        checkpoint_settings.filename.c_str());
+  }
+
+  if (mapping.is_open())
+  {
+    // the mapping is only ever read from
+    current = const_cast<char*>(mapping.data());
+  }
+  else
+  {
+    buffer = new char[max_buffer];
+    current = buffer.get_ptr();
+  }
 
   file.seekg(0, file.end);
   int length = file.tellg();
@@ -59,7 +87,12 @@ void CheckpointReader::start()
       " file contains %d bytes.\n",
       (int)length);
 
-  if (!file.read(buffer.get(), FileHeader::encoded_size()))
+  bool has_header =
+      mapping.is_open()
+          ? mapping.size() >= FileHeader::encoded_size()
+          : (bool)file.read(buffer.get(), FileHeader::encoded_size());
+
+  if (!has_header)
   {
     std::stringstream message;
     message << "ThreadSafeContext::load_context: ";
@@ -68,7 +101,8 @@ void CheckpointReader::start()
     message << " does not have enough room for an appropriate header";
     throw exceptions::FileException(message.str());
   }
-  total_read = file.tellg();
+  total_read = mapping.is_open() ? (int64_t)FileHeader::encoded_size()
+                                 : (int64_t)file.tellg();
 
   buffer_remaining = (int64_t)total_read;
 
@@ -119,166 +153,287 @@ void CheckpointReader::start()
   state = 0;
 }
 
-std::pair<std::string, KnowledgeRecord> CheckpointReader::next()
+void CheckpointReader::read_buffered_state()
 {
-  if (stage == 0)
+  // set the file pointer to the checkpoint header start
+  // fseek (file, (long)checkpoint_start, SEEK_SET);
+  file.clear();
+  file.seekg(checkpoint_start, file.beg);
+
+  if (!file.read((char*)&checkpoint_size, sizeof(checkpoint_size)))
   {
-    start();
+    std::stringstream message;
+    message << "ThreadSafeContext::load_context: ";
+    message << "file ";
+    message << checkpoint_settings.filename;
+    message << " does not have enough room for a checkpoint";
+    throw exceptions::FileException(message.str());
   }
 
-  if (stage == 9)
+  // total_read = fread (&checkpoint_size,
+  //   1, sizeof (checkpoint_size), file);
+
+  total_read = sizeof(checkpoint_size);
+
+  checkpoint_size = utility::endian_swap(checkpoint_size);
+
+  if (checkpoint_settings.buffer_filters.size() > 0)
   {
-    return {};
+    checkpoint_size += filters::BufferFilterHeader::encoded_size();
   }
 
-  // Outer loop for progressing through stages
-  for (;;)
+  madara_logger_ptr_log(logger_, logger::LOG_MINOR,
+      "ThreadSafeContext::load_context:"
+      " %d state checkpoint size is %d\n",
+      (int)state, (int)checkpoint_size);
+
+  // set the file pointer to the checkpoint header start
+  file.seekg(checkpoint_start, file.beg);
+
+  checkpoint_start += checkpoint_size;
+
+  madara_logger_ptr_log(logger_, logger::LOG_MINOR,
+      "ThreadSafeContext::load_context:"
+      " reading %d bytes for full checkpoint\n",
+      (int)checkpoint_size);
+
+  if (!file.read(buffer.get(), checkpoint_size))
   {
-    // We're iterating to next state
-    if (stage == 1)
-    {
-      if (state >= meta.states || state > checkpoint_settings.last_state)
-      {
-        madara_logger_ptr_log(logger_, logger::LOG_MINOR,
-            "ThreadSafeContext::load_context:"
-            " done at state=%d of meta.states=%d\n",
-            (int)state, (int)meta.states);
-        stage = 9;
-        return {};
-      }
+    std::stringstream message;
+    message << "ThreadSafeContext::load_context: ";
+    message << "file ";
+    message << checkpoint_settings.filename;
+    message << " does not have enough room for ";
+    message << checkpoint_size;
+    message << " bytes noted in header";
+    throw exceptions::FileException(message.str());
+  }
+  total_read = (int64_t)checkpoint_size;
 
-      madara_logger_ptr_log(logger_, logger::LOG_MINOR,
-          "ThreadSafeContext::load_context:"
-          " reading 64bit unsigned size at %d byte file offset\n",
-          (int)checkpoint_start);
+  current = buffer.get_ptr();
 
-      // set the file pointer to the checkpoint header start
-      // fseek (file, (long)checkpoint_start, SEEK_SET);
-      file.seekg(checkpoint_start, file.beg);
+  madara_logger_ptr_log(logger_, logger::LOG_MINOR,
+      "ThreadSafeContext::load_context:"
+      " read %d bytes\n",
+      (int)total_read);
+}
 
-      if (!file.read((char*)&checkpoint_size, sizeof(checkpoint_size)))
-      {
-        std::stringstream message;
-        message << "ThreadSafeContext::load_context: ";
-        message << "file ";
-        message << checkpoint_settings.filename;
-        message << " does not have enough room for a checkpoint";
-        throw exceptions::FileException(message.str());
-      }
+void CheckpointReader::read_mapped_state()
+{
+  // give back the pages of what was read before this state
+  if (checkpoint_start < released)
+  {
+    released = checkpoint_start;
+  }
+  else
+  {
+    mapping.release(released, checkpoint_start - released);
+    released = checkpoint_start;
+  }
 
-      // total_read = fread (&checkpoint_size,
-      //   1, sizeof (checkpoint_size), file);
+  if (mapping.size() < checkpoint_start + sizeof(checkpoint_size))
+  {
+    std::stringstream message;
+    message << "ThreadSafeContext::load_context: ";
+    message << "file ";
+    message << checkpoint_settings.filename;
+    message << " does not have enough room for a checkpoint";
+    throw exceptions::FileException(message.str());
+  }
 
-      total_read = sizeof(checkpoint_size);
+  memcpy(&checkpoint_size, mapping.data() + checkpoint_start,
+      sizeof(checkpoint_size));
+  checkpoint_size = utility::endian_swap(checkpoint_size);
 
-      checkpoint_size = utility::endian_swap(checkpoint_size);
+  madara_logger_ptr_log(logger_, logger::LOG_MINOR,
+      "ThreadSafeContext::load_context:"
+      " %d state checkpoint size is %d\n",
+      (int)state, (int)checkpoint_size);
 
-      if (checkpoint_settings.buffer_filters.size() > 0)
-      {
-        checkpoint_size += filters::BufferFilterHeader::encoded_size();
-      }
+  if (mapping.size() - checkpoint_start < checkpoint_size)
+  {
+    std::stringstream message;
+    message << "ThreadSafeContext::load_context: ";
+    message << "file ";
+    message << checkpoint_settings.filename;
+    message << " does not have enough room for ";
+    message << checkpoint_size;
+    message << " bytes noted in header";
+    throw exceptions::FileException(message.str());
+  }
 
-      madara_logger_ptr_log(logger_, logger::LOG_MINOR,
-          "ThreadSafeContext::load_context:"
-          " %d state checkpoint size is %d\n",
-          (int)state, (int)checkpoint_size);
+  // the mapping is only ever read from
+  current = const_cast<char*>(mapping.data() + checkpoint_start);
+  checkpoint_start += checkpoint_size;
+  total_read = (int64_t)checkpoint_size;
+}
 
-      // set the file pointer to the checkpoint header start
-      file.seekg(checkpoint_start, file.beg);
+uint64_t CheckpointReader::read_state()
+{
+  madara_logger_ptr_log(logger_, logger::LOG_MINOR,
+      "ThreadSafeContext::load_context:"
+      " reading 64bit unsigned size at %d byte file offset\n",
+      (int)checkpoint_start);
 
-      checkpoint_start += checkpoint_size;
+  if (mapping.is_open())
+  {
+    read_mapped_state();
+  }
+  else
+  {
+    read_buffered_state();
+  }
 
-      madara_logger_ptr_log(logger_, logger::LOG_MINOR,
-          "ThreadSafeContext::load_context:"
-          " reading %d bytes for full checkpoint\n",
-          (int)checkpoint_size);
+  buffer_remaining = (int64_t)total_read;
 
-      if (!file.read(buffer.get(), checkpoint_size))
-      {
-        std::stringstream message;
-        message << "ThreadSafeContext::load_context: ";
-        message << "file ";
-        message << checkpoint_settings.filename;
-        message << " does not have enough room for ";
-        message << checkpoint_size;
-        message << " bytes noted in header";
-        throw exceptions::FileException(message.str());
-      }
-      total_read = (int64_t)checkpoint_size;
+  madara_logger_ptr_log(logger_, logger::LOG_MINOR,
+      "ThreadSafeContext::load_context:"
+      " decoding with %d buffer filters with initial size of "
+      "%d bytes and total buffer of %d bytes\n",
+      (int)checkpoint_settings.buffer_filters.size(), (int)total_read,
+      (int)max_buffer);
 
-      current = buffer.get_ptr();
+  // call decode with any buffer filters
+  buffer_remaining = (int64_t)checkpoint_settings.decode(
+      current, (int)total_read, (int)max_buffer);
 
-      madara_logger_ptr_log(logger_, logger::LOG_MINOR,
-          "ThreadSafeContext::load_context:"
-          " read %d bytes\n",
-          (int)total_read);
+  if (buffer_remaining <= 0)
+  {
+    stage = 9;
+    throw exceptions::FilterException(
+        "ThreadSafeContext::load_context: "
+        "decode () returned a negative encoding size. Bad filter/encode.");
+  }
 
-      buffer_remaining = (int64_t)total_read;
+  if (buffer_remaining <
+      (int64_t)transport::MessageHeader::static_encoded_size())
+  {
+    stage = 9;
+    throw exceptions::MemoryException(
+        "ThreadSafeContext::load_context: "
+        "Not enough room in buffer for message header");
+  }
 
-      madara_logger_ptr_log(logger_, logger::LOG_MINOR,
-          "ThreadSafeContext::load_context:"
-          " decoding with %d buffer filters with initial size of "
-          "%d bytes and total buffer of %d bytes\n",
-          (int)checkpoint_settings.buffer_filters.size(), (int)total_read,
-          (int)max_buffer);
+  madara_logger_ptr_log(logger_, logger::LOG_MINOR,
+      "ThreadSafeContext::load_context:"
+      " Reading a checkpoint header with %d byte buffer remaining\n",
+      (int)buffer_remaining);
 
-      // call decode with any buffer filters
-      buffer_remaining = (int64_t)checkpoint_settings.decode(
-          current, (int)total_read, (int)max_buffer);
+  current = (char*)checkpoint_header.read(current, buffer_remaining);
 
-      if (buffer_remaining <= 0)
-      {
-        stage = 9;
-        throw exceptions::FilterException(
-            "ThreadSafeContext::load_context: "
-            "decode () returned a negative encoding size. Bad filter/encode.");
-      }
+  if (state == 0)
+  {
+    checkpoint_settings.initial_lamport_clock = checkpoint_header.clock;
+  }
 
-      if (buffer_remaining <
-          (int64_t)transport::MessageHeader::static_encoded_size())
-      {
-        stage = 9;
-        throw exceptions::MemoryException(
-            "ThreadSafeContext::load_context: "
-            "Not enough room in buffer for message header");
-      }
+  if (state == meta.states - 1)
+  {
+    checkpoint_settings.last_lamport_clock = checkpoint_header.clock;
+  }
 
-      madara_logger_ptr_log(logger_, logger::LOG_MINOR,
-          "ThreadSafeContext::load_context:"
-          " Reading a checkpoint header with %d byte buffer remaining\n",
-          (int)buffer_remaining);
+  uint64_t updates_size =
+      checkpoint_header.size - checkpoint_header.encoded_size();
 
-      current = (char*)checkpoint_header.read(current, buffer_remaining);
+  madara_logger_ptr_log(logger_, logger::LOG_MINOR,
+      "ThreadSafeContext::load_context:"
+      " read Checkpoint header. header.size=%d, updates.size=%d\n",
+      (int)checkpoint_header.size, (int)updates_size);
 
-      if (state == 0)
-      {
-        checkpoint_settings.initial_lamport_clock = checkpoint_header.clock;
-      }
+  /**
+   * What we read into the checkpoint_header will dictate our
+   * max_buffer. We want to make this checkpoint_header size into
+   * something reasonable.
+   **/
+  if (updates_size > (uint64_t)buffer_remaining)
+  {
+    throw exceptions::MemoryException(
+        "ThreadSafeContext::load_context: "
+        "Not enough room in buffer for checkpoint");
+  }  // end if allocation is needed
 
-      if (state == meta.states - 1)
-      {
-        checkpoint_settings.last_lamport_clock = checkpoint_header.clock;
-      }
+  return updates_size;
+}
 
-      uint64_t updates_size =
-          checkpoint_header.size - checkpoint_header.encoded_size();
+std::pair<std::string, KnowledgeRecord> CheckpointReader::read_update()
+{
+  std::pair<std::string, KnowledgeRecord> result;
+  result.second.clock = checkpoint_header.clock;
+  result.second.set_toi(checkpoint_settings.last_timestamp);
+  current =
+      (char*)result.second.read(current, result.first, buffer_remaining);
+
+  // give back the pages of large states as they are read
+  if (mapping.is_open())
+  {
+    size_t offset = current - mapping.data();
+
+    if (offset - released >= release_size)
+    {
+      mapping.release(released, offset - released);
+      released = offset;
+    }
+  }
 
+  return result;
+}
+
+bool CheckpointReader::has_prefix(const std::string& key) const
+{
+  // check if the prefix is allowed
+  if (checkpoint_settings.prefixes.size() > 0)
+  {
+    for (size_t j = 0; j < checkpoint_settings.prefixes.size(); ++j)
+    {
       madara_logger_ptr_log(logger_, logger::LOG_MINOR,
           "ThreadSafeContext::load_context:"
-          " read Checkpoint header. header.size=%d, updates.size=%d\n",
-          (int)checkpoint_header.size, (int)updates_size);
-
-      /**
-       * What we read into the checkpoint_header will dictate our
-       * max_buffer. We want to make this checkpoint_header size into
-       * something reasonable.
-       **/
-      if (updates_size > (uint64_t)buffer_remaining)
+          " checking record %s against prefix %s\n",
+          key.c_str(), checkpoint_settings.prefixes[j].c_str());
+
+      if (madara::utility::begins_with(key, checkpoint_settings.prefixes[j]))
+      {
+        madara_logger_ptr_log(logger_, logger::LOG_MINOR,
+            "ThreadSafeContext::load_context:"
+            " record has the correct prefix.\n");
+
+        return true;
+      }  // end if prefix success
+    }    // end for all prefixes
+
+    return false;
+  }  // end if there are prefixes in the checkpoint settings
+
+  return true;
+}
+
+std::pair<std::string, KnowledgeRecord> CheckpointReader::next()
+{
+  if (stage == 0)
+  {
+    start();
+  }
+
+  if (stage == 9)
+  {
+    return {};
+  }
+
+  // Outer loop for progressing through stages
+  for (;;)
+  {
+    // We're iterating to next state
+    if (stage == 1)
+    {
+      if (state >= meta.states || state > checkpoint_settings.last_state)
       {
-        throw exceptions::MemoryException(
-            "ThreadSafeContext::load_context: "
-            "Not enough room in buffer for checkpoint");
-      }  // end if allocation is needed
+        madara_logger_ptr_log(logger_, logger::LOG_MINOR,
+            "ThreadSafeContext::load_context:"
+            " done at state=%d of meta.states=%d\n",
+            (int)state, (int)meta.states);
+        stage = 9;
+        return {};
+      }
+
+      uint64_t updates_size = read_state();
 
       madara_logger_ptr_log(logger_, logger::LOG_MINOR,
           "ThreadSafeContext::load_context:"
@@ -313,55 +468,259 @@ std::pair<std::string, KnowledgeRecord> CheckpointReader::next()
         continue;
       }
 
-      std::string key;
-      knowledge::KnowledgeRecord record;
-      record.clock = checkpoint_header.clock;
-      record.set_toi(checkpoint_settings.last_timestamp);
-      current = (char*)record.read(current, key, buffer_remaining);
+      auto cur = read_update();
 
       madara_logger_ptr_log(logger_, logger::LOG_MINOR,
           "ThreadSafeContext::load_context:"
           " read record (%d of %d): %s\n",
-          (int)update, (int)checkpoint_header.updates, key.c_str());
+          (int)update, (int)checkpoint_header.updates, cur.first.c_str());
 
-      // check if the prefix is allowed
-      if (checkpoint_settings.prefixes.size() > 0)
+      if (!has_prefix(cur.first))
       {
-        bool prefix_found = false;
-        for (size_t j = 0;
-             j < checkpoint_settings.prefixes.size() && !prefix_found; ++j)
+        madara_logger_ptr_log(logger_, logger::LOG_MINOR,
+            "ThreadSafeContext::load_context:"
+            " record does not have the correct prefix. Rejected.\n");
+
+        ++update;
+        continue;
+      }  // end if prefix found
+
+      ++update;
+      return cur;
+    }  // end for all updates
+  }
+}
+
+bool CheckpointReader::has_states()
+{
+  if (stage == 0)
+  {
+    start();
+  }
+
+  return file.is_open() && meta.states > 0;
+}
+
+bool CheckpointReader::has_index()
+{
+  if (!has_states())
+  {
+    return false;
+  }
+
+  if (!index_read)
+  {
+    index_read = true;
+    index_saved = checkpoint_index.read(
+        file, meta.size + (uint64_t)FileHeader::encoded_size());
+
+    // an index that does not cover every state is of no use
+    if (index_saved && checkpoint_index.size() != meta.states)
+    {
+      madara_logger_ptr_log(logger_, logger::LOG_MAJOR,
+          "CheckpointReader::has_index:"
+          " index has %d states, but file has %d. Ignoring it.\n",
+          (int)checkpoint_index.size(), (int)meta.states);
+
+      checkpoint_index.clear();
+      index_saved = false;
+    }
+  }
+
+  return index_saved;
+}
+
+const CheckpointIndex& CheckpointReader::get_index()
+{
+  if (has_index() || index_built || !has_states())
+  {
+    return checkpoint_index;
+  }
+
+  madara_logger_ptr_log(logger_, logger::LOG_MAJOR,
+      "CheckpointReader::get_index:"
+      " %s has no index. Reading %d states to build one.\n",
+      checkpoint_settings.filename.c_str(), (int)meta.states);
+
+  CheckpointIndex index;
+  checkpoint_start = (size_t)FileHeader::encoded_size();
+
+  for (state = 0; state < meta.states; ++state)
+  {
+    uint64_t offset = checkpoint_start;
+    read_state();
+    index.add_state(offset, checkpoint_header.clock);
+
+    for (uint64_t i = 0; i < checkpoint_header.updates; ++i)
+    {
+      auto cur = read_update();
+      index.add_name(cur.first, cur.second.toi());
+    }
+  }
+
+  index.set_end(checkpoint_start);
+
+  checkpoint_index = std::move(index);
+  index_built = true;
+
+  seek_state(0);
+
+  return checkpoint_index;
+}
+
+bool CheckpointReader::seek_state(uint64_t target)
+{
+  if (!has_states() || target >= meta.states)
+  {
+    stage = 9;
+    return false;
+  }
+
+  if (target == 0)
+  {
+    checkpoint_start = (size_t)FileHeader::encoded_size();
+  }
+  else
+  {
+    checkpoint_start = (size_t)get_index().state((size_t)target).offset;
+  }
+
+  state = target;
+  stage = 1;
+
+  return true;
+}
+
+bool CheckpointReader::seek_toi(uint64_t toi)
+{
+  if (!has_states())
+  {
+    return false;
+  }
+
+  return seek_state(get_index().find_toi(toi));
+}
+
+bool CheckpointReader::seek_clock(uint64_t clock)
+{
+  if (!has_states())
+  {
+    return false;
+  }
+
+  return seek_state(get_index().find_clock(clock));
+}
+
+std::vector<KnowledgeRecord> CheckpointReader::history(const std::string& name)
+{
+  std::vector<KnowledgeRecord> result;
+
+  if (!has_states())
+  {
+    return result;
+  }
+
+  const CheckpointIndex::Runs* runs = get_index().find(name);
+
+  if (runs)
+  {
+    for (const CheckpointIndex::Run& run : *runs)
+    {
+      for (state = run.first; state < run.second; ++state)
+      {
+        checkpoint_start = (size_t)checkpoint_index.state((size_t)state).offset;
+        read_state();
+
+        for (uint64_t i = 0; i < checkpoint_header.updates; ++i)
         {
-          madara_logger_ptr_log(logger_, logger::LOG_MINOR,
-              "ThreadSafeContext::load_context:"
-              " checking record %s against prefix %s\n",
-              key.c_str(), checkpoint_settings.prefixes[j].c_str());
+          auto cur = read_update();
 
-          if (madara::utility::begins_with(
-                  key, checkpoint_settings.prefixes[j]))
+          if (cur.first == name)
           {
-            madara_logger_ptr_log(logger_, logger::LOG_MINOR,
-                "ThreadSafeContext::load_context:"
-                " record has the correct prefix.\n");
+            result.push_back(std::move(cur.second));
+          }
+        }
+      }
+    }
+  }
 
-            prefix_found = true;
-          }  // end if prefix success
-        }    // end for all prefixes
+  seek_state(0);
 
-        if (!prefix_found)
-        {
-          madara_logger_ptr_log(logger_, logger::LOG_MINOR,
-              "ThreadSafeContext::load_context:"
-              " record does not have the correct prefix. Rejected.\n");
+  return result;
+}
 
-          ++update;
-          continue;
-        }  // end if prefix found
-      }    // end if there are prefixes in the checkpoint settings
+std::vector<std::pair<std::string, KnowledgeRecord>>
+CheckpointReader::latest_before(uint64_t target)
+{
+  std::vector<std::pair<std::string, KnowledgeRecord>> result;
 
-      ++update;
-      return {key, record};
-    }  // end for all updates
+  if (!has_states())
+  {
+    return result;
+  }
+
+  const CheckpointIndex& index = get_index();
+
+  // the states next would have returned updates from
+  uint64_t first = checkpoint_settings.initial_state;
+  uint64_t end = std::min(target, meta.states);
+
+  if (checkpoint_settings.last_state < end)
+  {
+    end = checkpoint_settings.last_state + 1;
+  }
+
+  // find the last state before end that updates each variable
+  std::map<std::string, uint64_t> latest;
+  std::vector<uint64_t> states;
+
+  for (const auto& name : index.names())
+  {
+    if (!has_prefix(name.first))
+    {
+      continue;
+    }
+
+    const CheckpointIndex::Runs& runs = name.second;
+    auto run = std::find_if(runs.rbegin(), runs.rend(),
+        [end](const CheckpointIndex::Run& run) { return run.first < end; });
+
+    if (run != runs.rend())
+    {
+      uint64_t last = std::min(run->second, end) - 1;
+
+      if (last >= first)
+      {
+        latest[name.first] = last;
+        states.push_back(last);
+      }
+    }
   }
+
+  std::sort(states.begin(), states.end());
+  states.erase(std::unique(states.begin(), states.end()), states.end());
+
+  for (uint64_t cur_state : states)
+  {
+    state = cur_state;
+    checkpoint_start = (size_t)index.state((size_t)state).offset;
+    read_state();
+
+    for (uint64_t i = 0; i < checkpoint_header.updates; ++i)
+    {
+      auto cur = read_update();
+      auto found = latest.find(cur.first);
+
+      if (found != latest.end() && found->second == cur_state)
+      {
+        result.push_back(std::move(cur));
+      }
+    }
+  }
+
+  seek_state(target);
+
+  return result;
 }
 
 void CheckpointPlayer::thread_main(CheckpointPlayer* self)
@@ -420,6 +779,20 @@ void CheckpointPlayer::thread_main(CheckpointPlayer* self)
 bool CheckpointPlayer::play_until(uint64_t target_toi)
 {
   init_reader();
+
+  // skip to the state that reaches target_toi, applying only the last
+  // updates of each variable in the states before it
+  if (reader_->has_index())
+  {
+    uint64_t target = reader_->get_index().find_toi(target_toi);
+
+    for (auto& cur : reader_->latest_before(target))
+    {
+      context_->update_record_from_external(
+          cur.first, cur.second, update_settings_);
+    }
+  }
+
   for (;;)
   {
     auto cur = reader_->next();
@@ -4,9 +4,12 @@
 #include <fstream>
 #include <thread>
 #include <memory>
+#include <vector>
 
 #include "madara/utility/ScopedArray.h"
+#include "madara/utility/MappedFile.h"
 #include "madara/knowledge/CheckpointSettings.h"
+#include "madara/knowledge/CheckpointIndex.h"
 #include "madara/knowledge/FileHeader.h"
 #include "madara/transport/MessageHeader.h"
 
@@ -90,7 +93,99 @@ public:
     return checkpoint_settings;
   }
 
+  /**
+   * Check if the file was saved with an index (see
+   * CheckpointSettings::keep_index). Does not read through the file.
+   **/
+  bool has_index();
+
+  /**
+   * Get the index of the file's states. If the file was saved without
+   * one, reads through the whole file to build it, and then starts over
+   * from the first state.
+   **/
+  const CheckpointIndex& get_index();
+
+  /**
+   * Position the reader so that next returns the updates of a state.
+   *
+   * @param state the ordinal of the state, counting from 0
+   * @return false if the file has no such state
+   **/
+  bool seek_state(uint64_t state);
+
+  /**
+   * Position the reader at the first state with an update at or after a
+   * time, so that next returns that state's updates. Uses get_index.
+   *
+   * @return false if the file ends before toi
+   **/
+  bool seek_toi(uint64_t toi);
+
+  /**
+   * Position the reader at the first state at or after a lamport clock,
+   * so that next returns that state's updates. Uses get_index.
+   *
+   * @return false if the file ends before clock
+   **/
+  bool seek_clock(uint64_t clock);
+
+  /**
+   * Read every value saved for a variable, reading only the states that
+   * update it. Ignores prefixes, initial_state and last_state. Afterwards,
+   * the reader starts over from the first state. Uses get_index.
+   *
+   * @return the values, oldest first
+   **/
+  std::vector<KnowledgeRecord> history(const std::string& name);
+
+  /**
+   * Read the last updates of each variable saved before a state, reading
+   * only the states that hold them, and position the reader at the state.
+   * Applying the updates gives the same knowledge as applying all that
+   * next would have returned up to the state, including prefixes,
+   * initial_state and last_state. Uses get_index.
+   *
+   * @param state the ordinal of the state, counting from 0
+   * @return the updates, in the order they were saved
+   **/
+  std::vector<std::pair<std::string, KnowledgeRecord>> latest_before(
+      uint64_t state);
+
 private:
+  /**
+   * Check that the file has been started and has states to read
+   **/
+  bool has_states();
+
+  /**
+   * Read the state at checkpoint_start, up to its first update, and move
+   * checkpoint_start past it
+   *
+   * @return the size of the state's updates in bytes
+   **/
+  uint64_t read_state();
+
+  /**
+   * Read the state at checkpoint_start into the buffer from the file
+   **/
+  void read_buffered_state();
+
+  /**
+   * Point at the state at checkpoint_start in the mapping of the file
+   **/
+  void read_mapped_state();
+
+  /**
+   * Read the next update of the state in the buffer
+   **/
+  std::pair<std::string, KnowledgeRecord> read_update();
+
+  /**
+   * Check if a variable has one of the prefixes of the settings
+   **/
+  bool has_prefix(const std::string& key) const;
+
   CheckpointSettings& checkpoint_settings;
 
   logger::Logger* logger_;
@@ -107,6 +202,12 @@ private:
   uint64_t checkpoint_size;
   transport::MessageHeader checkpoint_header;
   uint64_t update;
+  CheckpointIndex checkpoint_index;
+  bool index_read = false;
+  bool index_saved = false;
+  bool index_built = false;
+  utility::MappedFile mapping;
+  size_t released = 0;
 };
 
 /**
@@ -189,6 +290,8 @@ public:
   /**
    * Loads values from checkpoint until it reaches or exceeds toi given.
    * Do not call while playback is active. Call before calling start().
+   * If the checkpoint was saved with an index, only the states that hold
+   * the last value of each variable before target_toi are read.
    *
    * @return true if target_toi is reached before hitting end of checkpoint.
    *         false otherwise.
@@ -25,6 +25,7 @@ namespace knowledge
 {
 class ThreadSafeContext;
 class VariablesLister;
+class CheckpointIndex;
 
 /**
  * @class CheckpointSettings
@@ -40,6 +41,11 @@ public:
    **/
   friend ThreadSafeContext;
 
+  /**
+   * Allow for CheckpointStreamer to write the index when it stops
+   **/
+  friend class CheckpointStreamer;
+
   /**
    * Constructor
    **/
@@ -463,12 +469,85 @@ public:
    **/
   VariablesLister* variables_lister = nullptr;
 
+  /**
+   * If true, saves keep an index of the checkpoint's states after the
+   * last state (see CheckpointIndex), which lets CheckpointReader seek to
+   * a time or a variable without reading the states before it. Each save
+   * rewrites the index, in time proportional to the number of states, so
+   * CheckpointStreamer only writes it once, when it stops. A file that was
+   * saved without an index is read through once to build one. The index
+   * is not passed through buffer_filters, so it exposes variable names
+   * and times.
+   **/
+  bool keep_index = false;
+
+  /**
+   * If true, loads map the checkpoint file into memory and decode records
+   * straight from the mapping, rather than reading each state into a
+   * buffer of buffer_size bytes, so states larger than buffer_size can
+   * be loaded. Pages of the mapping are given back as they are decoded.
+   * Ignored if there are buffer_filters, which need a buffer to decode
+   * into.
+   **/
+  bool map_file = false;
+
+  /**
+   * What a CheckpointStreamer does with an update when its queue is full
+   **/
+  enum StreamOverflow
+  {
+    /// drop the oldest update in the queue to make room for it
+    STREAM_DROP_OLDEST,
+
+    /// drop the update
+    STREAM_DROP_NEWEST,
+
+    /// wait for the streamer to write out the queue
+    STREAM_BLOCK
+  };
+
+  /**
+   * If nonzero, a CheckpointStreamer holds updates in a lock-free queue of
+   * this many updates, rather than in a buffer that grows without limit
+   * and is guarded by the context lock. Queued updates share their values
+   * with the context and refer to variable names by id, so enqueuing does
+   * not copy either. Updates that do not fit are handled according to
+   * stream_overflow, and counted by CheckpointStreamer::dropped.
+   **/
+  size_t stream_queue_size = 0;
+
+  /**
+   * What a CheckpointStreamer with a stream_queue_size does when it falls
+   * behind. STREAM_BLOCK stalls the thread updating the context, which
+   * holds the context lock, until the queue has room.
+   **/
+  StreamOverflow stream_overflow = STREAM_DROP_OLDEST;
+
+  /**
+   * If nonzero, a CheckpointStreamer saves its states through a
+   * CheckpointWriter, which runs buffer_filters on this many threads and
+   * writes to the file on another, rather than doing all three on its
+   * writer thread
+   **/
+  size_t write_threads = 0;
+
 private:
   /**
    * a thread-safe ref-counted file handle for quick access to an open
    * checkpoint binary file
    **/
   std::shared_ptr<FILE> checkpoint_file;
+
+  /**
+   * the index of the last save with these settings, reused by the next
+   * save to the same file rather than read back from it
+   **/
+  mutable std::shared_ptr<CheckpointIndex> checkpoint_index;
+
+  /**
+   * if true, saves keep checkpoint_index up to date without writing it
+   **/
+  bool defer_index = false;
 };
 
 class VariablesLister
@@ -6,12 +6,16 @@
  * to serialized temporal knowledge (STK) checkpoints.
  **/
 
+#include <algorithm>
 #include <chrono>
+#include <fstream>
+#include <string.h>
 
 #include "CheckpointStreamer.h"
 
 #include "madara/logger/Logger.h"
 #include "madara/knowledge/ContextGuard.h"
+#include "madara/knowledge/CheckpointIndex.h"
 
 namespace sc = std::chrono;
 
@@ -21,11 +25,116 @@ namespace knowledge
 {
 void CheckpointStreamer::enqueue(std::string name, KnowledgeRecord record)
 {
+  if (queue_)
+  {
+    entry_type entry(intern(name.c_str()), std::move(record));
+    push(entry);
+    return;
+  }
+
   ContextGuard context_guard(*context_);
 
   in_buffer.emplace_back(std::move(name), std::move(record));
 }
 
+void CheckpointStreamer::enqueue(
+    const char* name, const KnowledgeRecord& record)
+{
+  if (queue_)
+  {
+    // the record shares its value, so only the name would be copied
+    entry_type entry(intern(name), record);
+    push(entry);
+    return;
+  }
+
+  ContextGuard context_guard(*context_);
+
+  in_buffer.emplace_back(name, record);
+}
+
+size_t CheckpointStreamer::NameHash::operator()(const char* name) const
+{
+  // FNV-1a
+  size_t hash = (size_t)14695981039346656037ULL;
+
+  for (; *name; ++name)
+  {
+    hash = (hash ^ (unsigned char)*name) * (size_t)1099511628211ULL;
+  }
+
+  return hash;
+}
+
+bool CheckpointStreamer::NameEqual::operator()(
+    const char* lhs, const char* rhs) const
+{
+  return strcmp(lhs, rhs) == 0;
+}
+
+uint32_t CheckpointStreamer::intern(const char* name)
+{
+  std::lock_guard<std::mutex> guard(names_mutex_);
+
+  auto found = ids_.find(name);
+
+  if (found != ids_.end())
+  {
+    return found->second;
+  }
+
+  uint32_t id = (uint32_t)names_.size();
+
+  names_.emplace_back(name);
+  ids_.emplace(names_.back().c_str(), id);
+
+  return id;
+}
+
+void CheckpointStreamer::push(entry_type& entry)
+{
+  bool woken = false;
+
+  while (!queue_->try_push(entry))
+  {
+    if (overflow_ == CheckpointSettings::STREAM_DROP_NEWEST)
+    {
+      ++dropped_;
+      return;
+    }
+    else if (overflow_ == CheckpointSettings::STREAM_DROP_OLDEST)
+    {
+      entry_type oldest;
+
+      if (queue_->try_pop(oldest))
+      {
+        ++dropped_;
+      }
+    }
+    else if (!writing_.load())
+    {
+      // nobody is left to make room
+      ++dropped_;
+      return;
+    }
+    else
+    {
+      if (!woken)
+      {
+        {
+          std::lock_guard<std::mutex> guard(wake_mutex_);
+          wake_requested_ = true;
+        }
+
+        wake_.notify_one();
+        woken = true;
+      }
+
+      std::this_thread::yield();
+    }
+  }
+}
+
 namespace
 {
 class CheckpointStreamerLister : public VariablesLister
@@ -64,6 +173,111 @@ private:
   const vector_type* vec_;
   iterator_type iter_;
 };
+
+class CheckpointStreamerQueueLister : public VariablesLister
+{
+public:
+  using entry_type = std::pair<uint32_t, KnowledgeRecord>;
+
+  CheckpointStreamerQueueLister(const std::vector<const char*>& names,
+      const std::vector<entry_type>& entries)
+    : names_(&names), entries_(&entries)
+  {
+  }
+
+  void start(const CheckpointSettings& settings) override
+  {
+    (void)settings;
+    index_ = 0;
+  }
+
+  std::pair<const char*, const KnowledgeRecord*> next() override
+  {
+    std::pair<const char*, const KnowledgeRecord*> ret{nullptr, nullptr};
+
+    if (index_ == entries_->size())
+    {
+      return ret;
+    }
+
+    ret.first = (*names_)[index_];
+    ret.second = &(*entries_)[index_].second;
+
+    ++index_;
+
+    return ret;
+  }
+
+private:
+  const std::vector<const char*>* names_;
+  const std::vector<entry_type>* entries_;
+  size_t index_ = 0;
+};
+}
+
+void CheckpointStreamer::write_queued(void)
+{
+  // stop at what fits in the queue, or busy producers would keep us here
+  entry_type entry;
+  for (size_t i = queue_->capacity(); i > 0 && queue_->try_pop(entry); --i)
+  {
+    queued_.push_back(std::move(entry));
+  }
+
+  uint64_t dropped = dropped_.load();
+
+  if (dropped != logged_dropped_)
+  {
+    madara_logger_ptr_log(logger_, logger::LOG_MAJOR,
+        "CheckpointStreamer::write_queued:"
+        " queue was full, dropped %d updates (%d in total)\n",
+        (int)(dropped - logged_dropped_), (int)dropped);
+
+    logged_dropped_ = dropped;
+  }
+
+  if (queued_.size() == 0)
+  {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(names_mutex_);
+
+    for (const entry_type& cur : queued_)
+    {
+      queued_names_.push_back(names_[cur.first].c_str());
+    }
+  }
+
+  // the context is not locked to read its clock, so the state takes the
+  // latest clock of its updates
+  uint64_t clock = 0;
+  for (const entry_type& cur : queued_)
+  {
+    clock = std::max(clock, cur.second.clock);
+  }
+
+  CheckpointStreamerQueueLister lister{queued_names_, queued_};
+  save(lister, clock);
+
+  queued_.clear();
+  queued_names_.clear();
+}
+
+void CheckpointStreamer::save(VariablesLister& lister, uint64_t clock)
+{
+  if (writer_)
+  {
+    writer_->save(lister, clock);
+    return;
+  }
+
+  settings_.variables_lister = &lister;
+
+  context_->save_checkpoint(settings_);
+
+  settings_.variables_lister = nullptr;
 }
 
 void CheckpointStreamer::thread_main(CheckpointStreamer* self)
@@ -71,22 +285,54 @@ void CheckpointStreamer::thread_main(CheckpointStreamer* self)
   auto period = sc::microseconds(int64_t(1000000 / self->write_hertz_));
   auto wakeup = sc::steady_clock::now() + period;
 
-  madara_logger_log(self->context_->get_logger(), logger::LOG_MINOR,
+  madara_logger_ptr_log(self->logger_, logger::LOG_MINOR,
       "CheckpointStreamer::thread_main:"
       " created thread at %f hertz (%d ns period)\n",
       self->write_hertz_, sc::duration_cast<sc::nanoseconds>(period).count());
 
   self->settings_.variables_lister = nullptr;
 
+  // rewriting the index with every period's save would cost more the
+  // longer the recording, so it is only written once we are done
+  self->settings_.defer_index = true;
+
+  if (self->settings_.write_threads > 0)
+  {
+    self->writer_.reset(
+        new CheckpointWriter(self->settings_, self->settings_.write_threads));
+  }
+
   while (self->keep_running_.test_and_set())
   {
+    if (self->queue_)
+    {
+      self->write_queued();
+
+      // a producer waiting on a full queue wakes us before the period ends
+      std::unique_lock<std::mutex> lock(self->wake_mutex_);
+
+      if (self->wake_.wait_until(
+              lock, wakeup, [self] { return self->wake_requested_; }))
+      {
+        self->wake_requested_ = false;
+        continue;
+      }
+
+      wakeup += period;
+      continue;
+    }
+
+    uint64_t clock;
+
     {
       ContextGuard context_guard(*self->context_);
 
       using std::swap;
       swap(self->in_buffer, self->out_buffer);
 
-      madara_logger_log(self->context_->get_logger(), logger::LOG_TRACE,
+      clock = self->context_->get_clock();
+
+      madara_logger_ptr_log(self->logger_, logger::LOG_TRACE,
           "CheckpointStreamer::thread_main:"
           " woke up after %d ns and found %d updates\n",
           sc::duration_cast<sc::nanoseconds>(period).count(),
@@ -96,11 +342,7 @@ void CheckpointStreamer::thread_main(CheckpointStreamer* self)
     if (self->out_buffer.size() > 0)
     {
       CheckpointStreamerLister lister{self->out_buffer};
-      self->settings_.variables_lister = &lister;
-
-      self->context_->save_checkpoint(self->settings_);
-
-      self->settings_.variables_lister = nullptr;
+      self->save(lister, clock);
 
       self->out_buffer.clear();
     }
@@ -108,6 +350,36 @@ void CheckpointStreamer::thread_main(CheckpointStreamer* self)
     std::this_thread::sleep_until(wakeup);
     wakeup += period;
   }
+
+  if (self->queue_)
+  {
+    self->writing_ = false;
+    self->write_queued();
+  }
+
+  if (self->writer_)
+  {
+    // writes the states that are left, and the index
+    self->writer_.reset();
+  }
+
+  std::shared_ptr<CheckpointIndex> index = self->settings_.checkpoint_index;
+
+  if (self->settings_.keep_index && index)
+  {
+    madara_logger_ptr_log(self->logger_, logger::LOG_MINOR,
+        "CheckpointStreamer::thread_main:"
+        " writing index of %d states\n",
+        (int)index->size());
+
+    std::fstream file(self->settings_.filename,
+        std::ios::in | std::ios::out | std::ios::binary);
+
+    if (file)
+    {
+      index->write(file, index->end());
+    }
+  }
 }
 
 CheckpointStreamer::~CheckpointStreamer()
@@ -3,7 +3,11 @@
 
 #include <memory>
 #include <vector>
+#include <deque>
+#include <unordered_map>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <atomic>
 #include <chrono>
 
@@ -11,6 +15,8 @@
 #include "madara/knowledge/CheckpointSettings.h"
 #include "madara/knowledge/KnowledgeBase.h"
 #include "madara/knowledge/BaseStreamer.h"
+#include "madara/knowledge/CheckpointWriter.h"
+#include "madara/utility/BoundedQueue.h"
 
 /**
  * @file CheckpointStreamer.h
@@ -28,6 +34,14 @@ namespace knowledge
  * Implementation of BaseStreamer which writes updates to a Madara checkpoint
  * file. Updates are kept in an in-memory buffer, and written to disk at the
  * hertz rate specified in the constructor.
+ *
+ * If CheckpointSettings::stream_queue_size is set, updates are instead kept
+ * in a bounded lock-free queue, so that updating the context does not wait
+ * on the writer thread, and memory stays bounded if the disk falls behind.
+ *
+ * If CheckpointSettings::write_threads is set, states are saved through a
+ * CheckpointWriter, so that buffer_filters such as compression run on
+ * several threads rather than on the writer thread.
  **/
 class MADARA_EXPORT CheckpointStreamer : public BaseStreamer
 {
@@ -39,13 +53,20 @@ public:
    *   ThreadSafeContext::save_checkpoint. The variables_lister and
    *   reset_checkpoint fields given are ignored.
    * @param context ThreadSafeContext this object is attached to. This context
-   *   will be locked for a short time each period.
+   *   will be locked for a short time each period, unless the settings have
+   *   a stream_queue_size.
    * @param write_hertz hertz rate for periodic write to disk.
    **/
   CheckpointStreamer(CheckpointSettings settings, ThreadSafeContext& context,
       double write_hertz = 10)
     : settings_(std::move(settings)),
       context_(&context),
+      logger_(&context.get_logger()),
+      queue_(settings_.stream_queue_size > 0
+                 ? new utility::BoundedQueue<entry_type>(
+                       settings_.stream_queue_size)
+                 : nullptr),
+      overflow_(settings_.stream_overflow),
       write_hertz_(write_hertz),
       thread_(thread_main, (keep_running_.test_and_set(), this))
   {
@@ -73,6 +94,22 @@ public:
    **/
   void enqueue(std::string name, KnowledgeRecord record) override;
 
+  /**
+   * Implementation of BaseStreamer::enqueue, which stores the given parameters
+   * in an in-memory buffer, for later write to disk. The name is interned
+   * rather than copied if the settings have a stream_queue_size.
+   **/
+  void enqueue(const char* name, const KnowledgeRecord& record) override;
+
+  /**
+   * Returns the number of updates dropped because the queue was full, or
+   * because the streamer had stopped writing under STREAM_BLOCK
+   **/
+  uint64_t dropped(void) const
+  {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
   // This object spawns a thread which holds a pointer back to this object,
   // so it cannot be safely copied or moved.
   CheckpointStreamer(const CheckpointStreamer&) = delete;
@@ -85,6 +122,30 @@ public:
 private:
   static void thread_main(CheckpointStreamer* self);
 
+  using entry_type = std::pair<uint32_t, KnowledgeRecord>;
+
+  /// returns the id of a variable name, adding it if it is new
+  uint32_t intern(const char* name);
+
+  /// adds an update to the queue, or handles it as stream_overflow says
+  void push(entry_type& entry);
+
+  /// writes what is in the queue to the checkpoint as one state
+  void write_queued(void);
+
+  /// saves a state, through writer_ if there is one
+  void save(VariablesLister& lister, uint64_t clock);
+
+  struct NameHash
+  {
+    size_t operator()(const char* name) const;
+  };
+
+  struct NameEqual
+  {
+    bool operator()(const char* lhs, const char* rhs) const;
+  };
+
   void terminate()
   {
     keep_running_.clear();
@@ -97,11 +158,51 @@ private:
   CheckpointSettings settings_;
   ThreadSafeContext* context_;
 
+  /// the logger of context_, taken once so that logging from the writer
+  /// thread never waits on the context lock
+  logger::Logger* logger_;
+
   using pair_type = std::pair<std::string, KnowledgeRecord>;
 
   std::vector<pair_type> in_buffer;
   std::vector<pair_type> out_buffer;
 
+  /// updates waiting to be written, if there is a stream_queue_size
+  std::unique_ptr<utility::BoundedQueue<entry_type>> queue_;
+
+  /// what to do with updates that do not fit in queue_
+  CheckpointSettings::StreamOverflow overflow_;
+
+  /// the number of updates that were not written
+  std::atomic<uint64_t> dropped_{0};
+
+  /// the interned names, which never move once added
+  std::deque<std::string> names_;
+
+  /// the ids of the interned names, keyed by the strings in names_
+  std::unordered_map<const char*, uint32_t, NameHash, NameEqual> ids_;
+
+  /// guards names_ and ids_
+  std::mutex names_mutex_;
+
+  /// the updates taken from queue_ for the next write, and their names
+  std::vector<entry_type> queued_;
+  std::vector<const char*> queued_names_;
+
+  /// lets a producer wake the writer thread when the queue is full
+  std::mutex wake_mutex_;
+  std::condition_variable wake_;
+  bool wake_requested_ = false;
+
+  /// false once the writer thread has finished
+  std::atomic<bool> writing_{true};
+
+  /// dropped_ as of the last write, to log new drops
+  uint64_t logged_dropped_ = 0;
+
+  /// saves states, if there are write_threads
+  std::unique_ptr<CheckpointWriter> writer_;
+
   double write_hertz_ = 10;
 
   std::atomic_flag keep_running_;
@@ -0,0 +1,552 @@
+#include <string.h>
+
+#include "CheckpointWriter.h"
+#include "CheckpointPlayer.h"
+#include "madara/transport/MessageHeader.h"
+#include "madara/exceptions/FileException.h"
+#include "madara/exceptions/FilterException.h"
+#include "madara/exceptions/MemoryException.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Utility.h"
+
+namespace madara
+{
+namespace knowledge
+{
+namespace
+{
+class KnowledgeMapLister : public VariablesLister
+{
+public:
+  KnowledgeMapLister(const KnowledgeMap& records) : records_(&records) {}
+
+  void start(const CheckpointSettings& settings) override
+  {
+    (void)settings;
+    iter_ = records_->begin();
+  }
+
+  std::pair<const char*, const KnowledgeRecord*> next() override
+  {
+    std::pair<const char*, const KnowledgeRecord*> ret{nullptr, nullptr};
+
+    if (iter_ == records_->end())
+    {
+      return ret;
+    }
+
+    ret.first = iter_->first.c_str();
+    ret.second = &iter_->second;
+
+    ++iter_;
+
+    return ret;
+  }
+
+private:
+  const KnowledgeMap* records_;
+  KnowledgeMap::const_iterator iter_;
+};
+
+bool has_prefix(const CheckpointSettings& settings, const char* name)
+{
+  if (settings.prefixes.size() == 0)
+  {
+    return true;
+  }
+
+  for (const std::string& prefix : settings.prefixes)
+  {
+    if (strncmp(name, prefix.c_str(), prefix.size()) == 0)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+}
+
+CheckpointWriter::CheckpointWriter(
+    CheckpointSettings settings, size_t threads, size_t write_size)
+  : settings_(std::move(settings)),
+    write_size_(write_size),
+    keep_index_(settings_.keep_index)
+{
+  open();
+
+  if (threads == 0)
+  {
+    threads = 1;
+  }
+
+  // enough blocks to keep every thread busy while others are written
+  blocks_.resize(threads * 2 + 2);
+  for (Block& block : blocks_)
+  {
+    block.buffer.reset(new char[settings_.buffer_size]);
+    free_.push_back(&block);
+  }
+
+  for (size_t i = 0; i < threads; ++i)
+  {
+    filter_threads_.emplace_back(&CheckpointWriter::filter_main, this);
+  }
+
+  write_thread_ = std::thread(&CheckpointWriter::write_main, this);
+}
+
+CheckpointWriter::~CheckpointWriter()
+{
+  try
+  {
+    close();
+  }
+  catch (std::exception& e)
+  {
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ERROR,
+        "CheckpointWriter::~CheckpointWriter:"
+        " error while closing %s: %s\n",
+        settings_.filename.c_str(), e.what());
+  }
+}
+
+void CheckpointWriter::open(void)
+{
+  uint32_t header_size = FileHeader::encoded_size();
+  std::vector<char> buffer(header_size);
+
+  file_.open(
+      settings_.filename, std::ios::in | std::ios::out | std::ios::binary);
+
+  if (file_)
+  {
+    if (!file_.read(buffer.data(), header_size) ||
+        !FileHeader::file_header_test(buffer.data()))
+    {
+      throw exceptions::FileException("CheckpointWriter::open: " +
+                                      settings_.filename +
+                                      " is not a checkpoint");
+    }
+
+    int64_t buffer_remaining = header_size;
+    meta_.read(buffer.data(), buffer_remaining);
+
+    uint64_t end = meta_.size + header_size;
+
+    if (keep_index_ && !index_.read(file_, end))
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+          "CheckpointWriter::open:"
+          " %s has no index. Reading its %d states to build one.\n",
+          settings_.filename.c_str(), (int)meta_.states);
+
+      CheckpointSettings scan(settings_);
+      CheckpointReader reader(scan);
+      index_ = reader.get_index();
+    }
+
+    if (keep_index_ && (index_.size() != meta_.states || index_.end() != end))
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ERROR,
+          "CheckpointWriter::open:"
+          " could not index %s. Writing without an index.\n",
+          settings_.filename.c_str());
+
+      keep_index_ = false;
+    }
+
+    file_.clear();
+    file_.seekp(end, file_.beg);
+  }
+  else
+  {
+    file_.clear();
+    file_.open(settings_.filename, std::ios::out | std::ios::binary);
+
+    if (!file_)
+    {
+      throw exceptions::FileException("CheckpointWriter::open: "
+                                      "unable to create " +
+                                      settings_.filename);
+    }
+
+    meta_.size = 0;
+    meta_.states = 0;
+  }
+
+  if (settings_.originator != "")
+  {
+    strncpy(meta_.originator, settings_.originator.c_str(),
+        sizeof(meta_.originator) - 1);
+    meta_.originator[sizeof(meta_.originator) - 1] = 0;
+  }
+
+  if (settings_.override_timestamp)
+  {
+    meta_.initial_timestamp = settings_.initial_timestamp;
+    meta_.last_timestamp = settings_.last_timestamp;
+  }
+
+  saved_ = meta_.states;
+
+  write_header();
+}
+
+void CheckpointWriter::write_header(void)
+{
+  char buffer[256];
+  int64_t buffer_remaining = sizeof(buffer);
+
+  meta_.write(buffer, buffer_remaining);
+
+  file_.seekp(0, file_.beg);
+  file_.write(buffer, FileHeader::encoded_size());
+  file_.seekp(meta_.size + FileHeader::encoded_size(), file_.beg);
+}
+
+int64_t CheckpointWriter::save(VariablesLister& lister, uint64_t clock)
+{
+  Block* block = nullptr;
+
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    block_freed_.wait(lock, [this] { return !free_.empty() || error_; });
+
+    if (error_)
+    {
+      std::rethrow_exception(error_);
+    }
+
+    block = free_.back();
+    free_.pop_back();
+  }
+
+  try
+  {
+    transport::MessageHeader header;
+    header.clock =
+        settings_.override_lamport ? settings_.initial_lamport_clock : clock;
+    header.size = header.encoded_size();
+
+    int64_t buffer_remaining = (int64_t)settings_.buffer_size;
+    char* current = header.write(block->buffer.get(), buffer_remaining);
+
+    lister.start(settings_);
+    for (auto cur = lister.next(); cur.second != nullptr; cur = lister.next())
+    {
+      const KnowledgeRecord* record = cur.second;
+
+      if (!record->exists() || !has_prefix(settings_, cur.first))
+      {
+        continue;
+      }
+
+      std::string name(cur.first);
+      int64_t encoded_size = record->get_encoded_size(name);
+
+      if (encoded_size > buffer_remaining)
+      {
+        throw exceptions::MemoryException(
+            "CheckpointWriter::save: "
+            "state does not fit in CheckpointSettings.buffer_size");
+      }
+
+      char* pre_write = current;
+      current = record->write(current, name, buffer_remaining);
+
+      ++header.updates;
+      header.size += (uint64_t)(current - pre_write);
+
+      if (keep_index_)
+      {
+        block->names.emplace_back(std::move(name), record->toi());
+      }
+    }
+
+    if (header.updates == 0)
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      free_.push_back(block);
+      return 0;
+    }
+
+    // rewrite the header with the final size and updates
+    int64_t header_remaining = header.encoded_size();
+    header.write(block->buffer.get(), header_remaining);
+
+    block->size = (int)(current - block->buffer.get());
+    block->clock = header.clock;
+  }
+  catch (...)
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    block->names.clear();
+    free_.push_back(block);
+    throw;
+  }
+
+  // the block belongs to the other threads once it is queued
+  int64_t size = block->size;
+
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    ++saved_;
+    filter_queue_.push_back(block);
+    write_queue_.push_back(block);
+  }
+
+  filter_ready_.notify_one();
+
+  return size;
+}
+
+int64_t CheckpointWriter::save(const KnowledgeMap& records, uint64_t clock)
+{
+  KnowledgeMapLister lister(records);
+
+  return save(lister, clock);
+}
+
+void CheckpointWriter::flush(void)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  block_freed_.wait(lock, [this] { return write_queue_.empty() || error_; });
+
+  if (error_)
+  {
+    std::rethrow_exception(error_);
+  }
+}
+
+void CheckpointWriter::close(void)
+{
+  if (closed_)
+  {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stopping_ = true;
+  }
+
+  filter_ready_.notify_all();
+  write_ready_.notify_all();
+
+  for (std::thread& thread : filter_threads_)
+  {
+    thread.join();
+  }
+
+  write_thread_.join();
+
+  if (keep_index_ && !error_)
+  {
+    index_.write(file_, meta_.size + FileHeader::encoded_size());
+  }
+
+  file_.close();
+  closed_ = true;
+
+  if (error_)
+  {
+    std::rethrow_exception(error_);
+  }
+}
+
+uint64_t CheckpointWriter::states(void) const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+
+  return saved_;
+}
+
+void CheckpointWriter::filter_main(void)
+{
+  for (;;)
+  {
+    Block* block;
+
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      filter_ready_.wait(
+          lock, [this] { return stopping_ || !filter_queue_.empty(); });
+
+      if (filter_queue_.empty())
+      {
+        return;
+      }
+
+      block = filter_queue_.front();
+      filter_queue_.pop_front();
+    }
+
+    try
+    {
+      int size = settings_.encode(
+          block->buffer.get(), block->size, (int)settings_.buffer_size);
+
+      if (size <= 0)
+      {
+        throw exceptions::FilterException("CheckpointWriter::filter_main: "
+                                          "encode () returned a bad encoding "
+                                          "size. Bad filter/encode.");
+      }
+
+      block->size = size;
+    }
+    catch (...)
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+
+      if (!error_)
+      {
+        error_ = std::current_exception();
+      }
+
+      // the writer skips states that failed
+      block->size = 0;
+    }
+
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      block->filtered = true;
+    }
+
+    write_ready_.notify_one();
+  }
+}
+
+void CheckpointWriter::write_main(void)
+{
+  std::vector<char> gathered;
+  std::vector<Block*> batch;
+
+  for (;;)
+  {
+    size_t bytes = 0;
+
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      for (;;)
+      {
+        while (!write_queue_.empty() && write_queue_.front()->filtered &&
+               bytes < write_size_)
+        {
+          batch.push_back(write_queue_.front());
+          bytes += (size_t)write_queue_.front()->size;
+          write_queue_.pop_front();
+        }
+
+        // wait for more only while the states after these are filtering
+        if (bytes >= write_size_ || (!batch.empty() && write_queue_.empty()))
+        {
+          break;
+        }
+
+        if (batch.empty() && write_queue_.empty() && stopping_)
+        {
+          return;
+        }
+
+        write_ready_.wait(lock);
+      }
+    }
+
+    try
+    {
+      uint64_t offset = meta_.size + FileHeader::encoded_size();
+      uint64_t states = 0;
+
+      // a single state is written from its own buffer
+      const char* data = batch.size() == 1 ? batch[0]->buffer.get() : 0;
+      size_t length = batch.size() == 1 ? (size_t)batch[0]->size : 0;
+
+      gathered.clear();
+      for (Block* block : batch)
+      {
+        if (block->size == 0)
+        {
+          continue;
+        }
+
+        if (keep_index_)
+        {
+          index_.add_state(offset, block->clock);
+          for (const auto& name : block->names)
+          {
+            index_.add_name(name.first, name.second);
+          }
+        }
+
+        offset += (uint64_t)block->size;
+        ++states;
+
+        if (!data)
+        {
+          gathered.insert(gathered.end(), block->buffer.get(),
+              block->buffer.get() + block->size);
+        }
+      }
+
+      if (!data)
+      {
+        data = gathered.data();
+        length = gathered.size();
+      }
+
+      if (length > 0)
+      {
+        file_.write(data, length);
+
+        meta_.size += length;
+        meta_.states += states;
+
+        // keep the file readable up to here
+        write_header();
+
+        if (!file_)
+        {
+          throw exceptions::FileException("CheckpointWriter::write_main: "
+                                          "unable to write to " +
+                                          settings_.filename);
+        }
+
+        madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MINOR,
+            "CheckpointWriter::write_main:"
+            " wrote %d states in %d bytes\n",
+            (int)states, (int)length);
+      }
+    }
+    catch (...)
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+
+      if (!error_)
+      {
+        error_ = std::current_exception();
+      }
+    }
+
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+
+      for (Block* block : batch)
+      {
+        block->names.clear();
+        block->filtered = false;
+        free_.push_back(block);
+      }
+    }
+
+    batch.clear();
+    block_freed_.notify_all();
+  }
+}
+}
+}
@@ -0,0 +1,211 @@
+#ifndef _MADARA_KNOWLEDGE_CHECKPOINT_WRITER_H_
+#define _MADARA_KNOWLEDGE_CHECKPOINT_WRITER_H_
+
+/**
+ * @file CheckpointWriter.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the CheckpointWriter class, which saves states to a
+ * checkpoint file in a pipeline of threads
+ **/
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <fstream>
+
+#include "madara/MadaraExport.h"
+#include "madara/knowledge/CheckpointSettings.h"
+#include "madara/knowledge/CheckpointIndex.h"
+#include "madara/knowledge/FileHeader.h"
+
+namespace madara
+{
+namespace knowledge
+{
+/**
+ * @class CheckpointWriter
+ * @brief Appends states to a checkpoint file, like
+ *        ThreadSafeContext::save_checkpoint, but splits each save into
+ *        stages. The records of a state are encoded on the thread that
+ *        calls save, the buffer_filters of the settings (e.g., compression)
+ *        are run on a pool of threads, several states at a time, and
+ *        another thread writes the finished states to the file in the order
+ *        they were saved, batching states that are finished together into
+ *        one write. The file is the same as one written by save_checkpoint
+ *        and can be read by CheckpointReader.
+ *
+ *        The buffer_filters must be safe to call from several threads at
+ *        once, which the filters in MADARA are. Errors on the other threads,
+ *        such as filters failing, are thrown from the next call to save,
+ *        flush or close.
+ **/
+class MADARA_EXPORT CheckpointWriter
+{
+public:
+  /**
+   * Constructor. Opens the file in the settings, adding to it if it is
+   * already a checkpoint file, and starts the threads.
+   * @param  settings   the settings of the checkpoint. Uses filename,
+   *                    buffer_size (the most a state may take, before or
+   *                    after filtering), buffer_filters, prefixes,
+   *                    originator, keep_index and the override_timestamp
+   *                    and override_lamport fields.
+   * @param  threads    the number of threads to run buffer_filters on
+   * @param  write_size the number of bytes of finished states to gather
+   *                    before writing them to the file, if more states
+   *                    are being filtered
+   * @throw exceptions::FileException  the file could not be created, or
+   *                    exists but is not a checkpoint
+   **/
+  CheckpointWriter(CheckpointSettings settings, size_t threads = 2,
+      size_t write_size = 1024 * 1024);
+
+  /**
+   * Destructor. Closes the file, writing any states that are left.
+   **/
+  ~CheckpointWriter();
+
+  CheckpointWriter(const CheckpointWriter&) = delete;
+  CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+  /**
+   * Encodes a state and queues it to be filtered and written. Waits if
+   * every buffer is in use by states that have not been written yet.
+   * @param  lister     lists the records of the state
+   * @param  clock      the lamport clock of the state
+   * @return the number of bytes of the state, before filtering. States
+   *         with no records are not saved, and return 0.
+   * @throw exceptions::MemoryException  the state does not fit in
+   *                    buffer_size
+   **/
+  int64_t save(VariablesLister& lister, uint64_t clock);
+
+  /**
+   * Encodes a state of every record in a map
+   * @param  records    the records of the state
+   * @param  clock      the lamport clock of the state
+   * @return the number of bytes of the state, before filtering
+   **/
+  int64_t save(const KnowledgeMap& records, uint64_t clock);
+
+  /**
+   * Waits until every state saved so far is written to the file
+   **/
+  void flush(void);
+
+  /**
+   * Writes any states that are left and closes the file. Called by the
+   * destructor, which does not throw.
+   **/
+  void close(void);
+
+  /**
+   * Returns the number of states in the file, including those that are
+   * not written yet
+   **/
+  uint64_t states(void) const;
+
+private:
+  /**
+   * A state on its way to the file
+   **/
+  struct Block
+  {
+    /// the encoded state
+    std::unique_ptr<char[]> buffer;
+
+    /// the bytes of buffer in use
+    int size = 0;
+
+    /// the lamport clock of the state
+    uint64_t clock = 0;
+
+    /// the names and times of its records, for the index
+    std::vector<std::pair<std::string, uint64_t>> names;
+
+    /// true once the buffer_filters have been run on it
+    bool filtered = false;
+  };
+
+  /// opens the file, reading its header and index if it exists
+  void open(void);
+
+  /// runs buffer_filters on blocks
+  void filter_main(void);
+
+  /// writes filtered blocks in order
+  void write_main(void);
+
+  /// writes meta_ to the front of the file
+  void write_header(void);
+
+  /// the settings of the checkpoint
+  const CheckpointSettings settings_;
+
+  /// the bytes of filtered states to gather before writing
+  const size_t write_size_;
+
+  /// true if the file has an index
+  bool keep_index_;
+
+  /// the checkpoint file
+  std::fstream file_;
+
+  /// the header of the file, as of the last write
+  FileHeader meta_;
+
+  /// the index of the file, if keep_index
+  CheckpointIndex index_;
+
+  /// every block, each of buffer_size bytes
+  std::vector<Block> blocks_;
+
+  /// blocks that can be saved into
+  std::vector<Block*> free_;
+
+  /// blocks waiting for the buffer_filters, in order
+  std::deque<Block*> filter_queue_;
+
+  /// blocks in order, from the next to be written
+  std::deque<Block*> write_queue_;
+
+  /// the number of states saved, including those not written
+  uint64_t saved_ = 0;
+
+  /// guards the queues, free_, saved_, error_ and stopping_
+  mutable std::mutex mutex_;
+
+  /// signals blocks to filter, or stopping_
+  std::condition_variable filter_ready_;
+
+  /// signals filtered blocks, or stopping_
+  std::condition_variable write_ready_;
+
+  /// signals free blocks and flushed writes
+  std::condition_variable block_freed_;
+
+  /// the first error on the other threads
+  std::exception_ptr error_;
+
+  /// true once the threads should finish
+  bool stopping_ = false;
+
+  /// true once the file is closed
+  bool closed_ = false;
+
+  /// the threads running filter_main
+  std::vector<std::thread> filter_threads_;
+
+  /// the thread running write_main
+  std::thread write_thread_;
+};
+}
+}
+
+#endif  // _MADARA_KNOWLEDGE_CHECKPOINT_WRITER_H_
@@ -27,6 +27,7 @@ class ThreadSafeContext;
 class KnolwedgeBaseImpl;
 class Variables;
 class KnowledgeBase;
+class Subscription;
 
 /**
  * @class CompiledExpression
@@ -40,6 +41,7 @@ public:
   friend class KnowledgeBaseImpl;
   friend class Variables;
   friend class KnowledgeBase;
+  friend class Subscription;
   friend class expression::SystemCallEval;
 
   /**
@@ -9,6 +9,7 @@
 #include "madara/knowledge/KnowledgeUpdateSettings.h"
 #include "madara/expression/ExpressionTree.h"
 #include "madara/filters/RecordFilter.h"
+#include "madara/filters/KeyedRecordFilter.h"
 #include "madara/logger/GlobalLogger.h"
 
 #ifdef _MADARA_JAVA_
@@ -55,7 +56,8 @@ public:
     KARL_EXPRESSION = 3,
     PYTHON_CALLABLE = 4,
     JAVA_CALLABLE = 5,
-    FUNCTOR = 6
+    FUNCTOR = 6,
+    KEYED_FUNCTOR = 7
   };
 
   /**
@@ -70,6 +72,7 @@ public:
 #endif  // _MADARA_NO_KARL_
 
       functor(0),
+      keyed_functor(0),
       type(UNINITIALIZED)
   {
   }
@@ -86,6 +89,7 @@ public:
 #endif  // _MADARA_NO_KARL_
 
       functor(0),
+      keyed_functor(0),
       type(EXTERN_UNNAMED)
   {
   }
@@ -102,6 +106,7 @@ public:
 #endif  // _MADARA_NO_KARL_
 
       functor(0),
+      keyed_functor(0),
       type(EXTERN_NAMED)
   {
   }
@@ -115,6 +120,7 @@ public:
       extern_unnamed(0),
       function_contents(func),
       functor(0),
+      keyed_functor(0),
       type(KARL_EXPRESSION)
   {
   }
@@ -133,10 +139,28 @@ public:
 #endif  // _MADARA_NO_KARL_
 
       functor(filter),
+      keyed_functor(0),
       type(FUNCTOR)
   {
   }
 
+  /**
+   * Constructor for a filter that takes the record by reference
+   **/
+  Function(filters::KeyedRecordFilter* filter)
+    : extern_named(0),
+      extern_unnamed(0),
+
+#ifndef _MADARA_NO_KARL_
+      function_contents(*logger::global_logger.get()),
+#endif  // _MADARA_NO_KARL_
+
+      functor(0),
+      keyed_functor(filter),
+      type(KEYED_FUNCTOR)
+  {
+  }
+
   inline bool is_extern_unnamed(void) const
   {
     return type == EXTERN_UNNAMED && extern_unnamed;
@@ -157,6 +181,11 @@ public:
     return type == FUNCTOR;
   }
 
+  inline bool is_keyed_functor(void) const
+  {
+    return type == KEYED_FUNCTOR;
+  }
+
   inline bool is_uninitialized(void) const
   {
     return type == UNINITIALIZED;
@@ -176,6 +205,8 @@ public:
 
   filters::RecordFilter* functor;
 
+  filters::KeyedRecordFilter* keyed_functor;
+
   // type of function definition
   int type;
 
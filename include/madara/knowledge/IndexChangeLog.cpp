@@ -0,0 +1,121 @@
+#include "IndexChangeLog.h"
+
+#include <algorithm>
+
+namespace madara
+{
+namespace knowledge
+{
+void IndexChangeLog::add(uint64_t prev, uint64_t toi, size_t begin, size_t end)
+{
+  // if something other than set_index made the value before this
+  // change, no older value can be followed to the new one
+  if (!entries_.empty() && entries_.back().toi != prev)
+  {
+    entries_.clear();
+  }
+
+  if (entries_.empty() || entries_.back().taken)
+  {
+    if (entries_.size() >= MAX_ENTRIES)
+    {
+      entries_.erase(entries_.begin());
+    }
+
+    entries_.push_back(Entry{prev, toi, IndexRanges(), false});
+  }
+
+  Entry& entry = entries_.back();
+  entry.toi = toi;
+
+  // set_index is usually called for neighboring indices in order
+  if (!entry.ranges.empty() && begin <= entry.ranges.back().second &&
+      end >= entry.ranges.back().first)
+  {
+    IndexRange& last = entry.ranges.back();
+    last.first = std::min(last.first, begin);
+    last.second = std::max(last.second, end);
+  }
+  else
+  {
+    entry.ranges.emplace_back(begin, end);
+
+    if (entry.ranges.size() > MAX_RANGES)
+    {
+      normalize(entry.ranges, MAX_RANGES / 2);
+    }
+  }
+}
+
+void IndexChangeLog::mark_taken(void)
+{
+  if (!entries_.empty())
+  {
+    entries_.back().taken = true;
+  }
+}
+
+bool IndexChangeLog::changed(
+    uint64_t since, uint64_t until, IndexRanges& ranges) const
+{
+  ranges.clear();
+
+  if (since == until)
+  {
+    return true;
+  }
+
+  // find the change that made the newer value
+  size_t i = entries_.size();
+  while (i > 0 && entries_[i - 1].toi != until)
+  {
+    --i;
+  }
+
+  // and follow the chain back to the older one
+  for (; i > 0; --i)
+  {
+    const Entry& entry = entries_[i - 1];
+    ranges.insert(ranges.end(), entry.ranges.begin(), entry.ranges.end());
+
+    if (entry.prev == since)
+    {
+      normalize(ranges, MAX_RANGES);
+      return true;
+    }
+  }
+
+  ranges.clear();
+  return false;
+}
+
+void IndexChangeLog::normalize(IndexRanges& ranges, size_t max)
+{
+  std::sort(ranges.begin(), ranges.end());
+
+  // merge ranges whose gap is at most gap, widening it until few enough
+  // ranges are left. The first pass merges only overlaps and neighbors.
+  for (size_t gap = 0; ranges.size() > 1; gap = gap ? gap * 2 : 1)
+  {
+    size_t last = 0;
+    for (size_t i = 1; i < ranges.size(); ++i)
+    {
+      if (ranges[i].first <= ranges[last].second + gap)
+      {
+        ranges[last].second = std::max(ranges[last].second, ranges[i].second);
+      }
+      else
+      {
+        ranges[++last] = ranges[i];
+      }
+    }
+    ranges.resize(last + 1);
+
+    if (ranges.size() <= max)
+    {
+      break;
+    }
+  }
+}
+}
+}
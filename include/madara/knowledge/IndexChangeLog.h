@@ -0,0 +1,112 @@
+#ifndef _MADARA_KNOWLEDGE_INDEXCHANGELOG_H_
+#define _MADARA_KNOWLEDGE_INDEXCHANGELOG_H_
+
+/**
+ * @file IndexChangeLog.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains a log of the index ranges set_index changes in an
+ * array record, used by transports to send only the changed elements
+ **/
+
+#include <vector>
+#include <utility>
+#include "madara/MadaraExport.h"
+#include "madara/utility/IntTypes.h"
+
+namespace madara
+{
+namespace knowledge
+{
+/// a range of array indices, from first up to but not including second
+typedef std::pair<size_t, size_t> IndexRange;
+
+/// a list of index ranges
+typedef std::vector<IndexRange> IndexRanges;
+
+/**
+ * @class IndexChangeLog
+ * @brief The index ranges that set_index changed in an array record.
+ *
+ *        Values of the record are told apart by their toi. Each entry
+ *        holds the ranges that turned the value with toi prev into the
+ *        value with toi toi, so the ranges that changed between two
+ *        values can be found by following entries from the newer value
+ *        back to the older one. Anything other than set_index that
+ *        modifies the record breaks the chain, and the log starts over.
+ *
+ *        Changes are merged into the newest entry until its value is
+ *        taken to be sent (@see mark_taken), as only values that were
+ *        sent are ever asked about. Only the newest MAX_ENTRIES entries
+ *        are kept.
+ *
+ *        This class is not thread-safe. ThreadSafeContext only modifies
+ *        it while holding its lock.
+ **/
+class MADARA_EXPORT IndexChangeLog
+{
+public:
+  /// the most entries kept
+  static const size_t MAX_ENTRIES = 16;
+
+  /// the most ranges an entry or result has before nearby ranges merge
+  static const size_t MAX_RANGES = 128;
+
+  /**
+   * Notes that set_index changed a range of the record
+   * @param  prev    the toi of the value before the change
+   * @param  toi     the toi of the value after the change
+   * @param  begin   the first index changed
+   * @param  end     one past the last index changed
+   **/
+  void add(uint64_t prev, uint64_t toi, size_t begin, size_t end);
+
+  /**
+   * Notes that the current value is being sent, so that later changes
+   * are kept apart from it
+   **/
+  void mark_taken(void);
+
+  /**
+   * Gets the ranges that changed between two values
+   * @param  since   the toi of the older value
+   * @param  until   the toi of the newer value
+   * @param  ranges  filled with sorted, disjoint ranges
+   * @return true if every change between the values is known
+   **/
+  bool changed(uint64_t since, uint64_t until, IndexRanges& ranges) const;
+
+  /**
+   * Returns the number of entries
+   * @return  the number of entries kept
+   **/
+  size_t size(void) const
+  {
+    return entries_.size();
+  }
+
+  /**
+   * Sorts ranges, merges those that overlap or touch, and then merges
+   * the closest neighbors until there are at most max ranges
+   * @param  ranges   the ranges to normalize
+   * @param  max      the most ranges to leave
+   **/
+  static void normalize(IndexRanges& ranges, size_t max);
+
+private:
+  /// the changes from one value to the next
+  struct Entry
+  {
+    uint64_t prev;
+    uint64_t toi;
+    IndexRanges ranges;
+    bool taken;
+  };
+
+  /// entries from oldest to newest
+  std::vector<Entry> entries_;
+};
+}
+}
+
+#endif  // _MADARA_KNOWLEDGE_INDEXCHANGELOG_H_
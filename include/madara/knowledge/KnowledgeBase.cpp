@@ -44,6 +44,16 @@ KnowledgeRecord KnowledgeBase::wait(
     if (settings.pre_print_statement != "")
       context_->print(settings.pre_print_statement, logger::LOG_ALWAYS);
 
+    // without polling, only changes to what the expression reads wake us
+    Subscription subscription(*context_);
+    if (settings.poll_frequency <= 0)
+      subscription.add(expression);
+
+    utility::TimeValue deadline = utility::TimeValue::max();
+    if (settings.max_wait_time >= 0)
+      deadline = utility::add_seconds(
+          utility::get_time_value(), settings.max_wait_time);
+
     {
       ContextGuard context_guard(*context_);
 
@@ -59,6 +69,8 @@ KnowledgeRecord KnowledgeBase::wait(
           " completed first eval to get %s\n",
           last_value.to_string().c_str());
 
+      subscription.poll();
+
       send_modifieds("KnowledgeBase:wait", settings);
     }
 
@@ -77,7 +89,7 @@ KnowledgeRecord KnowledgeBase::wait(
         enforcer.sleep_until_next();
       }
       else
-        context_->wait_for_change(true);
+        subscription.wait_until(deadline);
 
       // relock - basically we need to evaluate the tree again, and
       // we can't have a bunch of people changing the variables as
@@ -97,10 +109,11 @@ KnowledgeRecord KnowledgeBase::wait(
             " completed eval to get %s\n",
             last_value.to_string().c_str());
 
+        // our own changes to what we read should not wake us
+        subscription.poll();
+
         send_modifieds("KnowledgeBase:wait", settings);
       }
-
-      context_->signal();
     }  // end while (!last)
 
     if (enforcer.is_done())
@@ -5,6 +5,8 @@
 #include "madara/transport/udp/UdpTransport.h"
 #include "madara/transport/udp/UdpRegistryServer.h"
 #include "madara/transport/udp/UdpRegistryClient.h"
+#include "madara/transport/tcp/TcpTransport.h"
+#include "madara/transport/shmem/ShmemTransport.h"
 #include "madara/transport/multicast/MulticastTransport.h"
 #include "madara/transport/broadcast/BroadcastTransport.h"
 #include "madara/utility/EpochEnforcer.h"
@@ -139,6 +141,15 @@ size_t KnowledgeBaseImpl::attach_transport(
     transport =
         new madara::transport::UdpTransport(originator, map_, settings, true);
   }
+  else if (settings.type == madara::transport::TCP)
+  {
+    madara_logger_log(map_.get_logger(), logger::LOG_MAJOR,
+        "KnowledgeBaseImpl::activate_transport:"
+        " creating TCP transport.\n");
+
+    transport =
+        new madara::transport::TcpTransport(originator, map_, settings, true);
+  }
   else if (settings.type == madara::transport::ZMQ)
   {
 #ifdef _MADARA_USING_ZMQ_
@@ -152,6 +163,22 @@ size_t KnowledgeBaseImpl::attach_transport(
     madara_logger_log(map_.get_logger(), logger::LOG_MAJOR,
         "KnowledgeBaseImpl::activate_transport:"
         " project was not generated with zmq=1. Transport is invalid.\n");
+#endif
+  }
+  else if (settings.type == madara::transport::SHMEM)
+  {
+#ifdef _MADARA_USE_SHMEM_
+    madara_logger_log(map_.get_logger(), logger::LOG_MAJOR,
+        "KnowledgeBaseImpl::activate_transport:"
+        " creating shared memory transport.\n");
+
+    transport =
+        new madara::transport::ShmemTransport(originator, map_, settings, true);
+#else
+    madara_logger_log(map_.get_logger(), logger::LOG_MAJOR,
+        "KnowledgeBaseImpl::activate_transport:"
+        " shared memory is not supported on this platform. Transport is "
+        "invalid.\n");
 #endif
   }
   else if (settings.type == madara::transport::REGISTRY_SERVER)
@@ -186,6 +213,9 @@ size_t KnowledgeBaseImpl::attach_transport(
     if (transport != 0)
     {
       transports_.emplace_back(transport);
+      send_queues_.emplace_back(transport->settings().send_async
+                                    ? new transport::SendQueue(*transport, map_)
+                                    : nullptr);
     }
 
     return transports_.size();
@@ -195,14 +225,21 @@ size_t KnowledgeBaseImpl::attach_transport(
 void KnowledgeBaseImpl::close_transport(void)
 {
   decltype(transports_) old_transports;
+  decltype(send_queues_) old_send_queues;
   {
     MADARA_GUARD_TYPE guard(transport_mutex_);
     using std::swap;
     swap(old_transports, transports_);
+    swap(old_send_queues, send_queues_);
   }
 
-  for (auto& transport : old_transports)
+  for (size_t i = 0; i < old_transports.size(); ++i)
   {
+    auto& transport = old_transports[i];
+
+    // sends anything still queued before the transport goes away
+    old_send_queues[i].reset();
+
     transport->close();
 
     madara_logger_log(map_.get_logger(), logger::LOG_MAJOR,
@@ -240,6 +277,16 @@ KnowledgeRecord KnowledgeBaseImpl::wait(
   if (settings.pre_print_statement != "")
     map_.print(settings.pre_print_statement, logger::LOG_EMERGENCY);
 
+  // without polling, only changes to what the expression reads wake us
+  Subscription subscription(map_);
+  if (settings.poll_frequency <= 0)
+    subscription.add(ce);
+
+  utility::TimeValue deadline = utility::TimeValue::max();
+  if (settings.max_wait_time >= 0)
+    deadline = utility::add_seconds(
+        utility::get_time_value(), settings.max_wait_time);
+
   // lock the context
 
   KnowledgeRecord last_value;
@@ -258,6 +305,8 @@ KnowledgeRecord KnowledgeBaseImpl::wait(
         " completed first eval to get %s\n",
         last_value.to_string().c_str());
 
+    subscription.poll();
+
     send_modifieds("KnowledgeBaseImpl:wait", settings);
   }
 
@@ -277,7 +326,7 @@ KnowledgeRecord KnowledgeBaseImpl::wait(
     }
     else
     {
-      map_.wait_for_change(true);
+      subscription.wait_until(deadline);
     }
 
     // relock - basically we need to evaluate the tree again, and
@@ -298,10 +347,11 @@ KnowledgeRecord KnowledgeBaseImpl::wait(
           " completed eval to get %s\n",
           last_value.to_string().c_str());
 
+      // our own changes to what we read should not wake us
+      subscription.poll();
+
       send_modifieds("KnowledgeBaseImpl:wait", settings);
     }
-    map_.signal();
-
   }  // end while (!last)
 
   if (enforcer.is_done())
@@ -409,9 +459,16 @@ int KnowledgeBaseImpl::send_modifieds(
     if (modified.size() > 0)
     {
       // send across each transport
-      for (auto& transport : transports_)
+      for (size_t i = 0; i < transports_.size(); ++i)
       {
-        transport->send_data(modified);
+        if (send_queues_[i])
+        {
+          send_queues_[i]->enqueue(modified);
+        }
+        else
+        {
+          transports_[i]->send_data(modified);
+        }
       }
 
       map_.inc_clock(settings);
@@ -23,6 +23,7 @@
 #include "madara/MadaraExport.h"
 #include "madara/knowledge/ThreadSafeContext.h"
 #include "madara/transport/Transport.h"
+#include "madara/transport/SendQueue.h"
 #include "madara/expression/Interpreter.h"
 
 namespace madara
@@ -1135,6 +1136,9 @@ private:
   mutable MADARA_LOCK_TYPE transport_mutex_;
 
   std::vector<std::unique_ptr<transport::Base>> transports_;
+
+  /// per-transport sender threads, null unless the transport's send_async
+  std::vector<std::unique_ptr<transport::SendQueue>> send_queues_;
 };
 }
 }
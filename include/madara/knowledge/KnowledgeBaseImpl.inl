@@ -395,6 +395,9 @@ inline size_t KnowledgeBaseImpl::attach_transport(transport::Base* transport)
   MADARA_GUARD_TYPE guard(transport_mutex_);
 
   transports_.emplace_back(transport);
+  send_queues_.emplace_back(transport->settings().send_async
+                                ? new transport::SendQueue(*transport, map_)
+                                : nullptr);
   return transports_.size();
 }
 
@@ -408,6 +411,7 @@ inline size_t KnowledgeBaseImpl::get_num_transports(void)
 inline size_t KnowledgeBaseImpl::remove_transport(size_t index)
 {
   std::unique_ptr<transport::Base> transport;
+  std::unique_ptr<transport::SendQueue> send_queue;
   size_t size = 0;
   {
     MADARA_GUARD_TYPE guard(transport_mutex_);
@@ -417,11 +421,16 @@ inline size_t KnowledgeBaseImpl::remove_transport(size_t index)
     {
       using std::swap;
       swap(transport, transports_[index]);
+      swap(send_queue, send_queues_[index]);
       transports_.erase(transports_.begin() + index);
+      send_queues_.erase(send_queues_.begin() + index);
       size = transports_.size();
     }
   }
 
+  // sends anything still queued before the transport goes away
+  send_queue.reset();
+
   if (transport)
   {
     transport->close();
@@ -0,0 +1,194 @@
+#include "KnowledgeMapIndex.h"
+
+#include <cstdint>
+
+namespace madara
+{
+namespace knowledge
+{
+KnowledgeMapIndex::KnowledgeMapIndex()
+  : size_(0), erased_(0), enabled_(false)
+{
+}
+
+void KnowledgeMapIndex::enable(bool enable, KnowledgeMap& map)
+{
+  std::vector<Slot>().swap(slots_);
+  size_ = 0;
+  erased_ = 0;
+  enabled_ = enable;
+
+  if (enable)
+  {
+    rehash(map.size());
+
+    for (auto& entry : map)
+    {
+      insert(&entry);
+    }
+  }
+}
+
+KnowledgeMapIndex::pair_ptr KnowledgeMapIndex::find(
+    const std::string& key) const
+{
+  if (size_ == 0)
+    return nullptr;
+
+  const size_t mask = slots_.size() - 1;
+  const size_t key_hash = hash(key);
+
+  for (size_t i = key_hash & mask;; i = (i + 1) & mask)
+  {
+    const Slot& slot = slots_[i];
+
+    if (slot.entry == nullptr)
+      return nullptr;
+
+    if (slot.hash == key_hash && slot.entry != tombstone() &&
+        slot.entry->first == key)
+      return slot.entry;
+  }
+}
+
+void KnowledgeMapIndex::insert(pair_ptr entry)
+{
+  // keep the load factor (including tombstones) at or below one half
+  if ((size_ + erased_ + 1) * 2 > slots_.size())
+  {
+    rehash(size_ + 1);
+  }
+
+  const size_t mask = slots_.size() - 1;
+  const size_t key_hash = hash(entry->first);
+  Slot* reuse = nullptr;
+
+  for (size_t i = key_hash & mask;; i = (i + 1) & mask)
+  {
+    Slot& slot = slots_[i];
+
+    if (slot.entry == nullptr)
+    {
+      if (reuse)
+      {
+        --erased_;
+      }
+      else
+      {
+        reuse = &slot;
+      }
+      break;
+    }
+    else if (slot.entry == tombstone())
+    {
+      if (!reuse)
+        reuse = &slot;
+    }
+    else if (slot.hash == key_hash && slot.entry->first == entry->first)
+    {
+      // a map never holds two nodes with the same key
+      slot.entry = entry;
+      return;
+    }
+  }
+
+  reuse->hash = key_hash;
+  reuse->entry = entry;
+  ++size_;
+}
+
+void KnowledgeMapIndex::erase(const std::string& key)
+{
+  if (size_ == 0)
+    return;
+
+  const size_t mask = slots_.size() - 1;
+  const size_t key_hash = hash(key);
+
+  for (size_t i = key_hash & mask;; i = (i + 1) & mask)
+  {
+    Slot& slot = slots_[i];
+
+    if (slot.entry == nullptr)
+      return;
+
+    if (slot.hash == key_hash && slot.entry != tombstone() &&
+        slot.entry->first == key)
+    {
+      slot.entry = tombstone();
+      --size_;
+      ++erased_;
+      return;
+    }
+  }
+}
+
+void KnowledgeMapIndex::clear(void)
+{
+  for (auto& slot : slots_)
+  {
+    slot.entry = nullptr;
+  }
+
+  size_ = 0;
+  erased_ = 0;
+}
+
+size_t KnowledgeMapIndex::hash(const std::string& key)
+{
+  uint64_t result = 14695981039346656037ULL;
+
+  for (unsigned char c : key)
+  {
+    result ^= c;
+    result *= 1099511628211ULL;
+  }
+
+  return (size_t)result;
+}
+
+KnowledgeMapIndex::pair_ptr KnowledgeMapIndex::tombstone(void)
+{
+  // never dereferenced, only compared against
+  static KnowledgeMap::value_type* const marker =
+      reinterpret_cast<KnowledgeMap::value_type*>(
+          reinterpret_cast<uintptr_t>(&marker));
+  return marker;
+}
+
+void KnowledgeMapIndex::rehash(size_t capacity)
+{
+  size_t new_size = 16;
+
+  while (new_size < capacity * 2)
+  {
+    new_size *= 2;
+  }
+
+  std::vector<Slot> old;
+  old.swap(slots_);
+
+  slots_.resize(new_size, Slot{0, nullptr});
+  size_ = 0;
+  erased_ = 0;
+
+  const size_t mask = new_size - 1;
+
+  for (auto& slot : old)
+  {
+    if (slot.entry != nullptr && slot.entry != tombstone())
+    {
+      size_t i = slot.hash & mask;
+
+      while (slots_[i].entry != nullptr)
+      {
+        i = (i + 1) & mask;
+      }
+
+      slots_[i] = slot;
+      ++size_;
+    }
+  }
+}
+}
+}
@@ -0,0 +1,129 @@
+#ifndef _MADARA_KNOWLEDGE_KNOWLEDGEMAPINDEX_H_
+#define _MADARA_KNOWLEDGE_KNOWLEDGEMAPINDEX_H_
+
+/**
+ * @file KnowledgeMapIndex.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains an open-addressing hash index over the entries of
+ * a KnowledgeMap, used by ThreadSafeContext for constant-time lookups
+ **/
+
+#include <string>
+#include <vector>
+#include "madara/MadaraExport.h"
+#include "madara/knowledge/KnowledgeRecord.h"
+
+namespace madara
+{
+namespace knowledge
+{
+/**
+ * @class KnowledgeMapIndex
+ * @brief Open-addressing (linear probing) hash table from variable names to
+ *        the entries of a KnowledgeMap.
+ *
+ *        The index does not own keys or records. Each slot points at a
+ *        std::map node, which is address-stable until erased, so entries
+ *        handed out by the index are the same pointers VariableReference
+ *        holds. The KnowledgeMap remains the ordered index used for prefix
+ *        scans. Any entry erased from the map must also be erased from the
+ *        index (or the index cleared) before the next lookup.
+ *
+ *        This class is not thread-safe. ThreadSafeContext only modifies it
+ *        while holding its exclusive lock.
+ **/
+class MADARA_EXPORT KnowledgeMapIndex
+{
+public:
+  /// pointer to a node in a KnowledgeMap
+  typedef KnowledgeMap::value_type* pair_ptr;
+
+  /**
+   * Constructor
+   **/
+  KnowledgeMapIndex();
+
+  /**
+   * Checks if the index is enabled
+   * @return  true if lookups should use the index
+   **/
+  bool enabled(void) const
+  {
+    return enabled_;
+  }
+
+  /**
+   * Enables the index and populates it with every entry in a map, or
+   * disables the index and releases its memory
+   * @param  enable   true to enable, false to disable
+   * @param  map      the map to index
+   **/
+  void enable(bool enable, KnowledgeMap& map);
+
+  /**
+   * Finds an entry by name
+   * @param  key      the variable name
+   * @return  the map entry, or nullptr if not indexed
+   **/
+  pair_ptr find(const std::string& key) const;
+
+  /**
+   * Adds an entry to the index. Entries already indexed are ignored.
+   * @param  entry    a node in the indexed KnowledgeMap
+   **/
+  void insert(pair_ptr entry);
+
+  /**
+   * Removes an entry from the index
+   * @param  key      the variable name
+   **/
+  void erase(const std::string& key);
+
+  /**
+   * Removes all entries from the index. The index stays enabled.
+   **/
+  void clear(void);
+
+  /**
+   * Returns the number of indexed entries
+   * @return  the number of indexed entries
+   **/
+  size_t size(void) const
+  {
+    return size_;
+  }
+
+private:
+  /// a slot in the open-addressing table
+  struct Slot
+  {
+    size_t hash;
+    pair_ptr entry;
+  };
+
+  /// hashes a key (FNV-1a)
+  static size_t hash(const std::string& key);
+
+  /// marker for slots whose entry was erased
+  static pair_ptr tombstone(void);
+
+  /// grows or compacts the table to hold at least capacity entries
+  void rehash(size_t capacity);
+
+  /// the table. Size is always zero or a power of two.
+  std::vector<Slot> slots_;
+
+  /// number of live entries
+  size_t size_;
+
+  /// number of tombstones
+  size_t erased_;
+
+  /// true if lookups should use the index
+  bool enabled_;
+};
+}
+}
+
+#endif  // _MADARA_KNOWLEDGE_KNOWLEDGEMAPINDEX_H_
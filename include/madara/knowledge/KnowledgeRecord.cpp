@@ -5,9 +5,11 @@
 #include "madara/knowledge/ThreadSafeContext.h"
 
 #include "madara/utility/Utility.h"
+#include "madara/utility/SimdMath.h"
 #include <sstream>
 #include <algorithm>
 #include <stdlib.h>
+#include <math.h>
 #include <iomanip>
 #include <iostream>
 #include "madara/utility/IntTypes.h"
@@ -17,6 +19,45 @@ namespace
 int madara_double_precision(-1);
 
 bool madara_use_scientific(false);
+
+namespace simd = madara::utility::simd;
+
+/// an operand of an element-wise operation, either an array or a scalar
+template<typename T>
+struct Operand
+{
+  const T* array = 0;
+  T scalar = 0;
+
+  T at(size_t i) const
+  {
+    return array ? array[i] : scalar;
+  }
+};
+
+/// applies an operation to operands, at least one of which is an array
+template<typename Op, typename T>
+void apply_elements(
+    T* out, const Operand<T>& a, const Operand<T>& b, size_t size)
+{
+  if (a.array && b.array)
+    simd::apply<Op>(out, a.array, b.array, size);
+  else if (a.array)
+    simd::apply<Op>(out, a.array, b.scalar, size);
+  else
+    simd::apply<Op>(out, a.scalar, b.array, size);
+}
+
+/// compares an array operand with an operand
+template<typename Op, typename T>
+void compare_elements(
+    int64_t* out, const Operand<T>& a, const Operand<T>& b, size_t size)
+{
+  if (b.array)
+    simd::compare<Op>(out, a.array, b.array, size);
+  else
+    simd::compare<Op>(out, a.array, b.scalar, size);
+}
 }
 
 namespace madara
@@ -1311,6 +1352,457 @@ int KnowledgeRecord::apply(ThreadSafeContext& context, const std::string& key,
   return result;
 }
 
+void KnowledgeRecord::apply_array(
+    ArrayOperation operation, const KnowledgeRecord& rhs)
+{
+  size_t count = size();
+
+  if (!is_array_type(type_))
+    count = rhs.size();
+  else if (is_array_type(rhs.type_))
+    count = std::min(count, (size_t)rhs.size());
+
+  if (is_integer_type(type_) && is_integer_type(rhs.type_))
+  {
+    auto operand = [](const KnowledgeRecord& record) {
+      Operand<Integer> result;
+      if (record.type_ == INTEGER_ARRAY)
+        result.array = record.int_array_->data();
+      else
+        result.scalar = record.to_integer();
+      return result;
+    };
+
+    Operand<Integer> a = operand(*this);
+    Operand<Integer> b = operand(rhs);
+
+    bool by_zero = false;
+
+    if (operation == ARRAY_DIVIDE || operation == ARRAY_MODULUS)
+    {
+      by_zero = b.array ? std::find(b.array, b.array + count, 0) !=
+                              b.array + count :
+                          b.scalar == 0;
+    }
+
+    if (by_zero)
+    {
+      // as with scalars, dividing by zero gives a NaN, so the result
+      // becomes a double array
+      std::vector<double> result(count);
+
+      for (size_t i = 0; i < count; ++i)
+      {
+        Integer divisor = b.at(i);
+
+        if (divisor == 0)
+          result[i] = NAN;
+        else if (operation == ARRAY_DIVIDE)
+          result[i] = (double)(a.at(i) / divisor);
+        else
+          result[i] = (double)(a.at(i) % divisor);
+      }
+
+      emplace_doubles(std::move(result));
+      return;
+    }
+
+    // write over our own array if nothing else holds it
+    bool in_place = type_ == INTEGER_ARRAY && int_array_.use_count() == 1;
+    std::vector<Integer> result;
+    Integer* out;
+
+    if (in_place)
+      out = int_array_->data();
+    else
+    {
+      result.resize(count);
+      out = result.data();
+    }
+
+    switch (operation)
+    {
+    case ARRAY_ADD:
+      apply_elements<simd::Add>(out, a, b, count);
+      break;
+    case ARRAY_SUBTRACT:
+      apply_elements<simd::Subtract>(out, a, b, count);
+      break;
+    case ARRAY_MULTIPLY:
+      apply_elements<simd::Multiply>(out, a, b, count);
+      break;
+    case ARRAY_DIVIDE:
+      apply_elements<simd::Divide>(out, a, b, count);
+      break;
+    case ARRAY_MODULUS:
+      apply_elements<simd::Modulus>(out, a, b, count);
+      break;
+    default:
+      break;
+    }
+
+    if (in_place)
+      int_array_->resize(count);
+    else
+      emplace_integers(std::move(result));
+
+    return;
+  }
+
+  // as with scalars, the modulus of doubles leaves the left operand as is
+  if (operation == ARRAY_MODULUS)
+    return;
+
+  // integer arrays are converted to doubles first
+  std::vector<double> left, right;
+
+  auto operand = [count](
+                     const KnowledgeRecord& record, std::vector<double>& copy) {
+    Operand<double> result;
+    if (record.type_ == DOUBLE_ARRAY)
+      result.array = record.double_array_->data();
+    else if (record.type_ == INTEGER_ARRAY)
+    {
+      const Integer* source = record.int_array_->data();
+      copy.assign(source, source + count);
+      result.array = copy.data();
+    }
+    else
+      result.scalar = record.to_double();
+    return result;
+  };
+
+  Operand<double> a = operand(*this, left);
+  Operand<double> b = operand(rhs, right);
+
+  bool in_place = type_ == DOUBLE_ARRAY && double_array_.use_count() == 1;
+  double* out;
+
+  if (in_place)
+    out = double_array_->data();
+  else
+  {
+    // a converted left array is overwritten with the result
+    if (type_ != INTEGER_ARRAY)
+      left.resize(count);
+
+    out = left.data();
+  }
+
+  switch (operation)
+  {
+  case ARRAY_ADD:
+    apply_elements<simd::Add>(out, a, b, count);
+    break;
+  case ARRAY_SUBTRACT:
+    apply_elements<simd::Subtract>(out, a, b, count);
+    break;
+  case ARRAY_MULTIPLY:
+    apply_elements<simd::Multiply>(out, a, b, count);
+    break;
+  case ARRAY_DIVIDE:
+    apply_elements<simd::Divide>(out, a, b, count);
+
+    // as with scalars, dividing by zero gives a NaN
+    for (size_t i = 0; i < count; ++i)
+      if (b.at(i) == 0)
+        out[i] = NAN;
+    break;
+  default:
+    break;
+  }
+
+  if (in_place)
+    double_array_->resize(count);
+  else
+    emplace_doubles(std::move(left));
+}
+
+KnowledgeRecord KnowledgeRecord::compare_array(
+    ArrayOperation operation, const KnowledgeRecord& rhs) const
+{
+  if (!is_array_type(type_) && !is_array_type(rhs.type_))
+  {
+    bool result = false;
+
+    switch (operation)
+    {
+    case ARRAY_LESS:
+      result = *this < rhs;
+      break;
+    case ARRAY_LESS_EQUAL:
+      result = *this <= rhs;
+      break;
+    case ARRAY_GREATER:
+      result = *this > rhs;
+      break;
+    case ARRAY_GREATER_EQUAL:
+      result = *this >= rhs;
+      break;
+    case ARRAY_EQUAL:
+      result = *this == rhs;
+      break;
+    case ARRAY_NOT_EQUAL:
+      result = *this != rhs;
+      break;
+    default:
+      break;
+    }
+
+    return KnowledgeRecord(Integer(result ? 1 : 0));
+  }
+
+  // the kernels compare an array with an operand, so a scalar on the
+  // left trades places with the array and the comparison is reversed
+  const KnowledgeRecord* left = this;
+  const KnowledgeRecord* right = &rhs;
+
+  if (!is_array_type(type_))
+  {
+    std::swap(left, right);
+
+    if (operation == ARRAY_LESS)
+      operation = ARRAY_GREATER;
+    else if (operation == ARRAY_LESS_EQUAL)
+      operation = ARRAY_GREATER_EQUAL;
+    else if (operation == ARRAY_GREATER)
+      operation = ARRAY_LESS;
+    else if (operation == ARRAY_GREATER_EQUAL)
+      operation = ARRAY_LESS_EQUAL;
+  }
+
+  size_t count = left->size();
+
+  if (is_array_type(right->type_))
+    count = std::min(count, (size_t)right->size());
+
+  std::vector<Integer> result(count);
+
+  if (is_integer_type(left->type_) && is_integer_type(right->type_))
+  {
+    Operand<Integer> a, b;
+    a.array = left->int_array_->data();
+
+    if (right->type_ == INTEGER_ARRAY)
+      b.array = right->int_array_->data();
+    else
+      b.scalar = right->to_integer();
+
+    switch (operation)
+    {
+    case ARRAY_LESS:
+      compare_elements<simd::Less>(result.data(), a, b, count);
+      break;
+    case ARRAY_LESS_EQUAL:
+      compare_elements<simd::LessEqual>(result.data(), a, b, count);
+      break;
+    case ARRAY_GREATER:
+      compare_elements<simd::Greater>(result.data(), a, b, count);
+      break;
+    case ARRAY_GREATER_EQUAL:
+      compare_elements<simd::GreaterEqual>(result.data(), a, b, count);
+      break;
+    case ARRAY_EQUAL:
+      compare_elements<simd::Equal>(result.data(), a, b, count);
+      break;
+    case ARRAY_NOT_EQUAL:
+      compare_elements<simd::NotEqual>(result.data(), a, b, count);
+      break;
+    default:
+      break;
+    }
+  }
+  else
+  {
+    // integer arrays are converted to doubles first
+    std::vector<double> left_copy, right_copy;
+    Operand<double> a, b;
+
+    if (left->type_ == DOUBLE_ARRAY)
+      a.array = left->double_array_->data();
+    else
+    {
+      const Integer* source = left->int_array_->data();
+      left_copy.assign(source, source + count);
+      a.array = left_copy.data();
+    }
+
+    if (right->type_ == DOUBLE_ARRAY)
+      b.array = right->double_array_->data();
+    else if (right->type_ == INTEGER_ARRAY)
+    {
+      const Integer* source = right->int_array_->data();
+      right_copy.assign(source, source + count);
+      b.array = right_copy.data();
+    }
+    else
+      b.scalar = right->to_double();
+
+    switch (operation)
+    {
+    case ARRAY_LESS:
+      compare_elements<simd::Less>(result.data(), a, b, count);
+      break;
+    case ARRAY_LESS_EQUAL:
+      compare_elements<simd::LessEqual>(result.data(), a, b, count);
+      break;
+    case ARRAY_GREATER:
+      compare_elements<simd::Greater>(result.data(), a, b, count);
+      break;
+    case ARRAY_GREATER_EQUAL:
+      compare_elements<simd::GreaterEqual>(result.data(), a, b, count);
+      break;
+    case ARRAY_EQUAL:
+      compare_elements<simd::Equal>(result.data(), a, b, count);
+      break;
+    case ARRAY_NOT_EQUAL:
+      compare_elements<simd::NotEqual>(result.data(), a, b, count);
+      break;
+    default:
+      break;
+    }
+  }
+
+  KnowledgeRecord record;
+  record.emplace_integers(std::move(result));
+  return record;
+}
+
+KnowledgeRecord KnowledgeRecord::compare_less(
+    const KnowledgeRecord& rhs) const
+{
+  return compare_array(ARRAY_LESS, rhs);
+}
+
+KnowledgeRecord KnowledgeRecord::compare_less_equal(
+    const KnowledgeRecord& rhs) const
+{
+  return compare_array(ARRAY_LESS_EQUAL, rhs);
+}
+
+KnowledgeRecord KnowledgeRecord::compare_greater(
+    const KnowledgeRecord& rhs) const
+{
+  return compare_array(ARRAY_GREATER, rhs);
+}
+
+KnowledgeRecord KnowledgeRecord::compare_greater_equal(
+    const KnowledgeRecord& rhs) const
+{
+  return compare_array(ARRAY_GREATER_EQUAL, rhs);
+}
+
+KnowledgeRecord KnowledgeRecord::compare_equal(
+    const KnowledgeRecord& rhs) const
+{
+  return compare_array(ARRAY_EQUAL, rhs);
+}
+
+KnowledgeRecord KnowledgeRecord::compare_not_equal(
+    const KnowledgeRecord& rhs) const
+{
+  return compare_array(ARRAY_NOT_EQUAL, rhs);
+}
+
+KnowledgeRecord KnowledgeRecord::sum(void) const
+{
+  if (type_ == INTEGER_ARRAY)
+    return KnowledgeRecord(
+        simd::sum(int_array_->data(), int_array_->size()));
+  else if (type_ == DOUBLE_ARRAY)
+    return KnowledgeRecord(
+        simd::sum(double_array_->data(), double_array_->size()));
+  else if (is_integer_type(type_))
+    return KnowledgeRecord(to_integer());
+  else
+    return KnowledgeRecord(to_double());
+}
+
+KnowledgeRecord KnowledgeRecord::minimum(void) const
+{
+  if (type_ == INTEGER_ARRAY)
+  {
+    if (int_array_->empty())
+      return KnowledgeRecord();
+
+    return KnowledgeRecord(
+        simd::minimum(int_array_->data(), int_array_->size()));
+  }
+  else if (type_ == DOUBLE_ARRAY)
+  {
+    if (double_array_->empty())
+      return KnowledgeRecord();
+
+    return KnowledgeRecord(
+        simd::minimum(double_array_->data(), double_array_->size()));
+  }
+  else if (is_integer_type(type_))
+    return KnowledgeRecord(to_integer());
+  else
+    return KnowledgeRecord(to_double());
+}
+
+KnowledgeRecord KnowledgeRecord::maximum(void) const
+{
+  if (type_ == INTEGER_ARRAY)
+  {
+    if (int_array_->empty())
+      return KnowledgeRecord();
+
+    return KnowledgeRecord(
+        simd::maximum(int_array_->data(), int_array_->size()));
+  }
+  else if (type_ == DOUBLE_ARRAY)
+  {
+    if (double_array_->empty())
+      return KnowledgeRecord();
+
+    return KnowledgeRecord(
+        simd::maximum(double_array_->data(), double_array_->size()));
+  }
+  else if (is_integer_type(type_))
+    return KnowledgeRecord(to_integer());
+  else
+    return KnowledgeRecord(to_double());
+}
+
+KnowledgeRecord KnowledgeRecord::dot(const KnowledgeRecord& rhs) const
+{
+  // a scalar multiplies the sum of the other operand
+  if (!is_array_type(type_) || !is_array_type(rhs.type_))
+    return sum() * rhs.sum();
+
+  size_t count = std::min(size(), rhs.size());
+
+  if (type_ == INTEGER_ARRAY && rhs.type_ == INTEGER_ARRAY)
+    return KnowledgeRecord(
+        simd::dot(int_array_->data(), rhs.int_array_->data(), count));
+
+  // integer arrays are converted to doubles first
+  std::vector<double> left_copy, right_copy;
+  const double* a;
+  const double* b;
+
+  if (type_ == DOUBLE_ARRAY)
+    a = double_array_->data();
+  else
+  {
+    left_copy.assign(int_array_->begin(), int_array_->begin() + count);
+    a = left_copy.data();
+  }
+
+  if (rhs.type_ == DOUBLE_ARRAY)
+    b = rhs.double_array_->data();
+  else
+  {
+    right_copy.assign(
+        rhs.int_array_->begin(), rhs.int_array_->begin() + count);
+    b = right_copy.data();
+  }
+
+  return KnowledgeRecord(simd::dot(a, b, count));
+}
+
 bool KnowledgeRecord::is_true(void) const
 {
   madara_logger_ptr_log(logger_, logger::LOG_MAJOR,
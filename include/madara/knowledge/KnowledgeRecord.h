@@ -1193,6 +1193,42 @@ public:
 private:
   void clear_union(void) noexcept;
 
+  /// element-wise operations on integer and double arrays
+  enum ArrayOperation
+  {
+    ARRAY_ADD,
+    ARRAY_SUBTRACT,
+    ARRAY_MULTIPLY,
+    ARRAY_DIVIDE,
+    ARRAY_MODULUS,
+    ARRAY_LESS,
+    ARRAY_LESS_EQUAL,
+    ARRAY_GREATER,
+    ARRAY_GREATER_EQUAL,
+    ARRAY_EQUAL,
+    ARRAY_NOT_EQUAL
+  };
+
+  /**
+   * Checks if an arithmetic operator should work element by element,
+   * i.e., if this record is an integer or double array, or if it is an
+   * integer or double and rhs is such an array
+   **/
+  bool is_array_operation(const KnowledgeRecord& rhs) const;
+
+  /**
+   * Applies an arithmetic operation element by element, in place if
+   * this record is the only holder of its array. Arrays of different
+   * lengths are combined up to the length of the shorter one.
+   **/
+  void apply_array(ArrayOperation operation, const KnowledgeRecord& rhs);
+
+  /**
+   * Compares element by element
+   **/
+  KnowledgeRecord compare_array(
+      ArrayOperation operation, const KnowledgeRecord& rhs) const;
+
 public:
   /**
    * clears any dynamic values. This method does not attempt to set
@@ -1452,6 +1488,86 @@ public:
    **/
   KnowledgeRecord operator-(const KnowledgeRecord& rhs) const;
 
+  /**
+   * Sums the elements of an integer or double array
+   * @return the sum, or the value of a record that is not an array
+   *         as an integer or double
+   **/
+  KnowledgeRecord sum(void) const;
+
+  /**
+   * Finds the smallest element of an integer or double array. NaNs
+   * are skipped unless every element is a NaN.
+   * @return the smallest element, an empty record if the array has
+   *         no elements, or the value of a record that is not an array
+   *         as an integer or double
+   **/
+  KnowledgeRecord minimum(void) const;
+
+  /**
+   * Finds the largest element of an integer or double array. NaNs
+   * are skipped unless every element is a NaN.
+   * @return the largest element, an empty record if the array has
+   *         no elements, or the value of a record that is not an array
+   *         as an integer or double
+   **/
+  KnowledgeRecord maximum(void) const;
+
+  /**
+   * Multiplies the elements of two arrays pairwise and sums the
+   * products, up to the length of the shorter array. A record that is
+   * not an array is treated as a scalar that multiplies each element.
+   * @param rhs   the other operand
+   * @return the dot product, an integer if both operands are integers
+   *         and a double otherwise
+   **/
+  KnowledgeRecord dot(const KnowledgeRecord& rhs) const;
+
+  /**
+   * Element-wise less than. Arrays are compared pairwise, up to the
+   * length of the shorter array, and a record that is not an array is
+   * compared with each element.
+   * @param rhs   the other operand
+   * @return an integer array with 1 where the comparison holds and 0
+   *         where it does not, or 1 or 0 if neither operand is an array
+   **/
+  KnowledgeRecord compare_less(const KnowledgeRecord& rhs) const;
+
+  /**
+   * Element-wise less than or equal to. See compare_less.
+   * @param rhs   the other operand
+   * @return a mask of the elements where the comparison holds
+   **/
+  KnowledgeRecord compare_less_equal(const KnowledgeRecord& rhs) const;
+
+  /**
+   * Element-wise greater than. See compare_less.
+   * @param rhs   the other operand
+   * @return a mask of the elements where the comparison holds
+   **/
+  KnowledgeRecord compare_greater(const KnowledgeRecord& rhs) const;
+
+  /**
+   * Element-wise greater than or equal to. See compare_less.
+   * @param rhs   the other operand
+   * @return a mask of the elements where the comparison holds
+   **/
+  KnowledgeRecord compare_greater_equal(const KnowledgeRecord& rhs) const;
+
+  /**
+   * Element-wise equal to. See compare_less.
+   * @param rhs   the other operand
+   * @return a mask of the elements where the comparison holds
+   **/
+  KnowledgeRecord compare_equal(const KnowledgeRecord& rhs) const;
+
+  /**
+   * Element-wise not equal to. See compare_less.
+   * @param rhs   the other operand
+   * @return a mask of the elements where the comparison holds
+   **/
+  KnowledgeRecord compare_not_equal(const KnowledgeRecord& rhs) const;
+
   /**
    * Explicit bool cast
    *
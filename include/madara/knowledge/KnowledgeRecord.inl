@@ -433,6 +433,10 @@ inline KnowledgeRecord KnowledgeRecord::operator-(void) const
   {
     record.set_value(-double_value_);
   }
+  else if (is_array_type(type_))
+  {
+    record.set_value(KnowledgeRecord(Integer(0)) - *this);
+  }
   else if (has_history())
   {
     record.set_value(-get_newest());
@@ -447,6 +451,12 @@ inline KnowledgeRecord KnowledgeRecord::operator-(void) const
 inline KnowledgeRecord& KnowledgeRecord::operator+=(
     const knowledge::KnowledgeRecord& rhs)
 {
+  if (is_array_operation(rhs))
+  {
+    apply_array(ARRAY_ADD, rhs);
+    return *this;
+  }
+
   if (is_integer_type(type_))
   {
     if (is_integer_type(rhs.type_))
@@ -514,6 +524,12 @@ inline KnowledgeRecord& KnowledgeRecord::operator++(void)
 inline KnowledgeRecord& KnowledgeRecord::operator-=(
     const knowledge::KnowledgeRecord& rhs)
 {
+  if (is_array_operation(rhs))
+  {
+    apply_array(ARRAY_SUBTRACT, rhs);
+    return *this;
+  }
+
   if (is_integer_type(type_))
   {
     if (is_integer_type(rhs.type_))
@@ -536,6 +552,12 @@ inline KnowledgeRecord& KnowledgeRecord::operator-=(
 inline KnowledgeRecord& KnowledgeRecord::operator*=(
     const knowledge::KnowledgeRecord& rhs)
 {
+  if (is_array_operation(rhs))
+  {
+    apply_array(ARRAY_MULTIPLY, rhs);
+    return *this;
+  }
+
   if (is_integer_type(type_))
   {
     if (is_integer_type(rhs.type_))
@@ -558,6 +580,12 @@ inline KnowledgeRecord& KnowledgeRecord::operator*=(
 inline KnowledgeRecord& KnowledgeRecord::operator/=(
     const knowledge::KnowledgeRecord& rhs)
 {
+  if (is_array_operation(rhs))
+  {
+    apply_array(ARRAY_DIVIDE, rhs);
+    return *this;
+  }
+
   if (is_integer_type(type_))
   {
     if (is_integer_type(rhs.type_))
@@ -600,6 +628,12 @@ inline KnowledgeRecord& KnowledgeRecord::operator/=(
 inline KnowledgeRecord& KnowledgeRecord::operator%=(
     const knowledge::KnowledgeRecord& rhs)
 {
+  if (is_array_operation(rhs))
+  {
+    apply_array(ARRAY_MODULUS, rhs);
+    return *this;
+  }
+
   if (is_integer_type(type_))
   {
     if (is_integer_type(rhs.type_))
@@ -666,6 +700,16 @@ inline KnowledgeRecord KnowledgeRecord::operator+(
   return ret_value += rhs;
 }
 
+inline bool KnowledgeRecord::is_array_operation(
+    const KnowledgeRecord& rhs) const
+{
+  if (is_array_type(type_))
+    return true;
+
+  return is_array_type(rhs.type_) &&
+         (type_ == EMPTY || type_ == INTEGER || type_ == DOUBLE);
+}
+
 inline bool KnowledgeRecord::is_false(void) const
 {
   return !is_true();
@@ -1124,15 +1168,8 @@ inline const char* KnowledgeRecord::read(
 
     else if (type == INTEGER_ARRAY)
     {
-      std::vector<Integer> tmp;
-      tmp.reserve(size);
-
-      for (uint32_t i = 0; i < size; ++i)
-      {
-        Integer cur;
-        memcpy(&cur, buffer + i * sizeof(cur), sizeof(cur));
-        tmp.emplace_back(madara::utility::endian_swap(cur));
-      }
+      std::vector<Integer> tmp(size);
+      madara::utility::endian_swap_array(tmp.data(), buffer, size);
 
       emplace_integers(std::move(tmp));
     }
@@ -1146,15 +1183,8 @@ inline const char* KnowledgeRecord::read(
 
     else if (type == DOUBLE_ARRAY)
     {
-      std::vector<double> tmp;
-      tmp.reserve(size);
-
-      for (uint32_t i = 0; i < size; ++i)
-      {
-        double cur;
-        memcpy(&cur, buffer + i * sizeof(cur), sizeof(cur));
-        tmp.emplace_back(madara::utility::endian_swap(cur));
-      }
+      std::vector<double> tmp(size);
+      madara::utility::endian_swap_array(tmp.data(), buffer, size);
 
       emplace_doubles(std::move(tmp));
     }
@@ -1244,6 +1274,11 @@ inline const char* KnowledgeRecord::read(
     // read the type and data
     buffer = read(buffer, buffer_remaining);
   }
+  else
+  {
+    // as with a key that does not fit, tell the caller the buffer ran out
+    buffer_remaining -= sizeof(key_id);
+  }
 
   return buffer;
 }
@@ -1757,14 +1792,7 @@ inline char* KnowledgeRecord::write(
       if (buffer_remaining >= int64_t(size * sizeof(Integer)))
       {
         // convert integers to network byte order
-        const Integer* ptr_temp = &(*int_array_)[0];
-        Integer* target_buffer = (Integer*)buffer;
-
-        for (uint32_t i = 0; i < size; ++i, ++ptr_temp, ++target_buffer)
-        {
-          integer_temp = madara::utility::endian_swap(*ptr_temp);
-          memcpy(target_buffer, &integer_temp, sizeof(Integer));
-        }
+        madara::utility::endian_swap_array(buffer, int_array_->data(), size);
 
         size_intermediate = size * sizeof(Integer);
       }
@@ -1783,15 +1811,9 @@ inline char* KnowledgeRecord::write(
     {
       if (buffer_remaining >= int64_t(size * sizeof(double)))
       {
-        // convert integers to network byte order
-        const double* ptr_temp = &(*double_array_)[0];
-        double* target_buffer = (double*)buffer;
-
-        for (uint32_t i = 0; i < size; ++i, ++ptr_temp, ++target_buffer)
-        {
-          double_temp = madara::utility::endian_swap(*ptr_temp);
-          memcpy(target_buffer, &double_temp, sizeof(double_temp));
-        }
+        // convert doubles to network byte order
+        madara::utility::endian_swap_array(
+            buffer, double_array_->data(), size);
 
         size_intermediate = size * sizeof(double);
 
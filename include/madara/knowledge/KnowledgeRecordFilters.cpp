@@ -20,6 +20,96 @@
 
 #endif
 
+namespace
+{
+/// the arguments and variables passed to record filters
+struct FilterScratch
+{
+  madara::knowledge::FunctionArguments arguments;
+
+  // JVMs appear to do strange things with the stack on jni_attach, so
+  // the variables are never on the stack
+  madara::knowledge::Variables variables;
+
+  /// true while a filter chain of the thread is using the scratch
+  bool busy = false;
+};
+
+#ifndef MADARA_NO_THREAD_LOCAL
+/// the calling thread's scratch. A plain pointer is cheaper to reach than
+/// a thread local object with a destructor.
+thread_local FilterScratch* thread_scratch = 0;
+
+/// frees the calling thread's scratch when the thread exits
+thread_local std::unique_ptr<FilterScratch> thread_scratch_owner;
+#endif
+
+/**
+ * Lends the calling thread's scratch to a filter chain, once the chain
+ * first needs it. A filter that sends or receives from within a filter
+ * chain gets scratch of its own.
+ **/
+class ScratchLease
+{
+public:
+  ScratchLease() : scratch_(0) {}
+
+  ~ScratchLease()
+  {
+    if (scratch_ != 0 && !local_)
+    {
+      // release the record and anything a filter added, but keep the
+      // strings, which are often the same for the next record
+      scratch_->arguments.resize(madara::filters::TOTAL_ARGUMENTS);
+      scratch_->arguments[madara::filters::RECORD].clear_value();
+      scratch_->busy = false;
+    }
+  }
+
+  FilterScratch& get(void)
+  {
+    if (scratch_ == 0)
+    {
+#ifndef MADARA_NO_THREAD_LOCAL
+      if (thread_scratch == 0)
+      {
+        thread_scratch_owner.reset(new FilterScratch());
+        thread_scratch = thread_scratch_owner.get();
+      }
+
+      if (!thread_scratch->busy)
+      {
+        scratch_ = thread_scratch;
+        scratch_->busy = true;
+        return *scratch_;
+      }
+#endif
+
+      local_.reset(new FilterScratch());
+      scratch_ = local_.get();
+    }
+
+    return *scratch_;
+  }
+
+private:
+  FilterScratch* scratch_;
+
+  std::unique_ptr<FilterScratch> local_;
+};
+
+/// sets a string argument, unless it already holds the value
+inline void set_argument(
+    madara::knowledge::KnowledgeRecord& argument, const std::string& value)
+{
+  if (argument.type() != madara::knowledge::KnowledgeRecord::STRING ||
+      *argument.share_string() != value)
+  {
+    argument.set_value(value);
+  }
+}
+}
+
 madara::knowledge::KnowledgeRecordFilters::KnowledgeRecordFilters()
   : context_(0)
 {
@@ -140,6 +230,32 @@ void madara::knowledge::KnowledgeRecordFilters::add(
   }
 }
 
+void madara::knowledge::KnowledgeRecordFilters::add(
+    uint32_t types, filters::KeyedRecordFilter* functor)
+{
+  if (functor != 0)
+  {
+    madara_logger_cond_log(context_, context_->get_logger(),
+        logger::global_logger.get(), logger::LOG_MAJOR,
+        "KnowledgeRecordFilters::add: "
+        "Adding keyed record filter to types\n");
+
+    // start with 1st bit, check every bit until types is 0
+    for (uint32_t cur = 1; types > 0; cur <<= 1)
+    {
+      // if current is set in the bitmask
+      if (madara::utility::bitmask_check(types, cur))
+      {
+        // remove the filter list from the type cur
+        filters_[cur].push_back(Function(functor));
+      }
+
+      // remove the current flag from the types
+      types = madara::utility::bitmask_remove(types, cur);
+    }
+  }
+}
+
 #ifdef _MADARA_JAVA_
 
 void madara::knowledge::KnowledgeRecordFilters::add(
@@ -295,20 +411,34 @@ madara::knowledge::KnowledgeRecordFilters::filter(
         "Entering record filter logic\n");
 
     const FilterChain& chain = type_match->second;
-    FunctionArguments arguments;
-
-    // JVMs appear to do strange things with the stack on jni_attach
-    std::unique_ptr<Variables> heap_variables(new Variables());
-
-    heap_variables->context_ = context_;
+    ScratchLease scratch;
 
     for (FilterChain::const_iterator i = chain.begin(); i != chain.end(); ++i)
     {
+      // keyed filters take the record as is, without arguments
+      if (i->is_keyed_functor())
+      {
+        madara_logger_cond_log(context_, context_->get_logger(),
+            logger::global_logger.get(), logger::LOG_MAJOR,
+            "KnowledgeRecordFilters::filter: "
+            "Calling keyed functor filter\n");
+
+        Variables& variables = scratch.get().variables;
+        variables.context_ = context_;
+
+        i->keyed_functor->filter(name, result, transport_context, variables);
+        continue;
+      }
+
       madara_logger_cond_log(context_, context_->get_logger(),
           logger::global_logger.get(), logger::LOG_MAJOR,
           "KnowledgeRecordFilters::filter: "
           "Preparing args for filter\n");
 
+      FunctionArguments& arguments = scratch.get().arguments;
+      Variables* heap_variables = &scratch.get().variables;
+      heap_variables->context_ = context_;
+
       /**
        * arguments vector is modifiable by filter, so we have to
        * resize every filter call to make sure we have adequate space
@@ -319,7 +449,11 @@ madara::knowledge::KnowledgeRecordFilters::filter(
       if (name != "")
       {
         // second argument is the variable name, if applicable
-        arguments[1].set_value(name);
+        set_argument(arguments[1], name);
+      }
+      else
+      {
+        arguments[1].clear_value();
       }
 
       // third argument is the operation being performed
@@ -343,10 +477,10 @@ madara::knowledge::KnowledgeRecordFilters::filter(
           KnowledgeRecord::Integer(transport_context.get_current_time()));
 
       // seventh argument is the networking domain
-      arguments[7].set_value(transport_context.get_domain());
+      set_argument(arguments[7], transport_context.get_domain());
 
       // eighth argument is the update originator
-      arguments[8].set_value(transport_context.get_originator());
+      set_argument(arguments[8], transport_context.get_originator());
 
       // setup arguments to the function
       arguments[0] = result;
@@ -364,7 +498,7 @@ madara::knowledge::KnowledgeRecordFilters::filter(
             "KnowledgeRecordFilters::filter: "
             "Calling functor filter\n");
 
-        result = i->functor->filter(arguments, *heap_variables.get());
+        result = i->functor->filter(arguments, *heap_variables);
       }
 #ifdef _MADARA_JAVA_
       else if (i->is_java_callable())
@@ -388,7 +522,7 @@ madara::knowledge::KnowledgeRecordFilters::filter(
         jmethodID fromPointerCall = jvm.env->GetStaticMethodID(
             jvarClass, "fromPointer", "(J)Lai/madara/knowledge/Variables;");
         jobject jvariables = jvm.env->CallStaticObjectMethod(
-            jvarClass, fromPointerCall, (jlong)heap_variables.get());
+            jvarClass, fromPointerCall, (jlong)heap_variables);
 
         // prep to create the KnowledgeList
         jmethodID listConstructor =
@@ -495,7 +629,7 @@ madara::knowledge::KnowledgeRecordFilters::filter(
         // some guides have stated that we should let python handle exceptions
         result = boost::python::call<madara::knowledge::KnowledgeRecord>(
             i->python_function.ptr(), boost::ref(arguments),
-            boost::ref(*heap_variables.get()));
+            boost::ref(*heap_variables));
       }
 #endif
 
@@ -507,7 +641,7 @@ madara::knowledge::KnowledgeRecordFilters::filter(
             "KnowledgeRecordFilters::filter: "
             "Calling unnamed C filter\n");
 
-        result = i->extern_unnamed(arguments, *heap_variables.get());
+        result = i->extern_unnamed(arguments, *heap_variables);
       }
 
       // did the filter add records to be sent?
@@ -23,6 +23,7 @@
 #include "madara/utility/StdInt.h"
 #include "madara/MadaraExport.h"
 #include "madara/filters/RecordFilter.h"
+#include "madara/filters/KeyedRecordFilter.h"
 #include "madara/filters/AggregateFilter.h"
 #include "madara/filters/BufferFilter.h"
 
@@ -108,6 +109,14 @@ public:
    **/
   void add(uint32_t types, filters::RecordFilter* filter);
 
+  /**
+   * Adds an individual record filter functor that changes the record
+   * in place, without the FunctionArguments of other record filters
+   * @param   types      the types to add the filter to
+   * @param   filter     the functor that will filter the records
+   **/
+  void add(uint32_t types, filters::KeyedRecordFilter* filter);
+
 #ifdef _MADARA_JAVA_
 
   /**
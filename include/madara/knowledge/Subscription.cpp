@@ -0,0 +1,168 @@
+#include "Subscription.h"
+#include "KnowledgeBase.h"
+#include "ThreadSafeContext.h"
+
+#include <algorithm>
+
+namespace madara
+{
+namespace knowledge
+{
+Subscription::Subscription(KnowledgeBase& knowledge)
+  : context_(knowledge.get_context())
+{
+}
+
+Subscription::Subscription(ThreadSafeContext& context) : context_(context) {}
+
+Subscription::~Subscription()
+{
+  MADARA_GUARD_TYPE guard(context_.mutex_);
+
+  for (const KnowledgeRecord* record : records_)
+  {
+    auto found = context_.record_subscriptions_.find(record);
+
+    if (found != context_.record_subscriptions_.end())
+    {
+      std::vector<Subscription*>& subscriptions = found->second;
+      subscriptions.erase(
+          std::remove(subscriptions.begin(), subscriptions.end(), this),
+          subscriptions.end());
+
+      if (subscriptions.empty())
+        context_.record_subscriptions_.erase(found);
+    }
+  }
+
+  typedef std::pair<std::string, Subscription*> PrefixEntry;
+
+  auto& prefixes = context_.prefix_subscriptions_;
+  prefixes.erase(std::remove_if(prefixes.begin(), prefixes.end(),
+                     [this](const PrefixEntry& entry) {
+                       return entry.second == this;
+                     }),
+      prefixes.end());
+
+  auto& all = context_.all_subscriptions_;
+  all.erase(std::remove(all.begin(), all.end(), this), all.end());
+
+  context_.subscriptions_ -=
+      records_.size() + prefixes_.size() + (all_ ? 1 : 0);
+}
+
+void Subscription::add(const std::string& key)
+{
+  add(context_.get_ref(key));
+}
+
+void Subscription::add(const VariableReference& variable)
+{
+  if (!variable.is_valid())
+    return;
+
+  MADARA_GUARD_TYPE guard(context_.mutex_);
+
+  add_record_unsafe(variable.get_record_unsafe());
+}
+
+void Subscription::add_prefix(const std::string& prefix)
+{
+  MADARA_GUARD_TYPE guard(context_.mutex_);
+
+  if (std::find(prefixes_.begin(), prefixes_.end(), prefix) != prefixes_.end())
+    return;
+
+  prefixes_.push_back(prefix);
+  context_.prefix_subscriptions_.emplace_back(prefix, this);
+  ++context_.subscriptions_;
+}
+
+void Subscription::add_all(void)
+{
+  MADARA_GUARD_TYPE guard(context_.mutex_);
+
+  if (all_)
+    return;
+
+  all_ = true;
+  context_.all_subscriptions_.push_back(this);
+  ++context_.subscriptions_;
+}
+
+#ifndef _MADARA_NO_KARL_
+void Subscription::add(const CompiledExpression& expression)
+{
+  std::vector<const KnowledgeRecord*> records;
+
+  MADARA_GUARD_TYPE guard(context_.mutex_);
+
+  if (!expression.expression.dependencies(records))
+  {
+    add_all();
+    return;
+  }
+
+  for (const KnowledgeRecord* record : records)
+  {
+    add_record_unsafe(record);
+  }
+}
+#endif  // _MADARA_NO_KARL_
+
+uint64_t Subscription::wait(double max_wait)
+{
+  if (max_wait < 0)
+    return wait_until(utility::TimeValue::max());
+
+  return wait_until(utility::add_seconds(utility::get_time_value(), max_wait));
+}
+
+uint64_t Subscription::wait_until(utility::TimeValue deadline)
+{
+  std::unique_lock<MADARA_LOCK_TYPE> lock(context_.mutex_);
+
+  auto has_changes = [this]() { return pending_ > 0; };
+
+  if (deadline == utility::TimeValue::max())
+  {
+    changed_.wait(lock, has_changes);
+  }
+  else if (!changed_.wait_until(lock, deadline, has_changes))
+  {
+    return 0;
+  }
+
+  uint64_t changes = pending_;
+  pending_ = 0;
+
+  return changes;
+}
+
+uint64_t Subscription::poll(void)
+{
+  MADARA_GUARD_TYPE guard(context_.mutex_);
+
+  uint64_t changes = pending_;
+  pending_ = 0;
+
+  return changes;
+}
+
+void Subscription::add_record_unsafe(const KnowledgeRecord* record)
+{
+  if (std::find(records_.begin(), records_.end(), record) != records_.end())
+    return;
+
+  records_.push_back(record);
+  context_.record_subscriptions_[record].push_back(this);
+  ++context_.subscriptions_;
+}
+
+void Subscription::notify_unsafe(void)
+{
+  ++pending_;
+  changed_.MADARA_CONDITION_NOTIFY_ALL();
+}
+}
+}
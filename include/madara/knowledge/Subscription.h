@@ -0,0 +1,151 @@
+#ifndef _MADARA_KNOWLEDGE_SUBSCRIPTION_H_
+#define _MADARA_KNOWLEDGE_SUBSCRIPTION_H_
+
+/**
+ * @file Subscription.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the Subscription class, which lets a thread wait for
+ * changes to particular variables of a context
+ **/
+
+#include <string>
+#include <vector>
+
+#include "madara/MadaraExport.h"
+#include "madara/LockType.h"
+#include "madara/utility/Utility.h"
+#include "madara/knowledge/VariableReference.h"
+
+namespace madara
+{
+namespace knowledge
+{
+class KnowledgeBase;
+class ThreadSafeContext;
+class CompiledExpression;
+
+/**
+ * @class Subscription
+ * @brief Counts changes to a set of variables, to variables that start
+ *        with a prefix, or to the whole context, and lets threads block
+ *        until one happens. An update only wakes the subscriptions of the
+ *        record it changed. Like KnowledgeBase::wait_for_change, only
+ *        updates that signal changes (see KnowledgeUpdateSettings) count.
+ **/
+class MADARA_EXPORT Subscription
+{
+public:
+  /**
+   * Constructor. The subscription starts with no variables.
+   * @param  knowledge   the knowledge base to watch
+   **/
+  Subscription(KnowledgeBase& knowledge);
+
+  /**
+   * Constructor. The subscription starts with no variables.
+   * @param  context     the context to watch
+   **/
+  Subscription(ThreadSafeContext& context);
+
+  /**
+   * Destructor. Threads must not be waiting on the subscription.
+   **/
+  ~Subscription();
+
+  Subscription(const Subscription&) = delete;
+  Subscription& operator=(const Subscription&) = delete;
+
+  /**
+   * Subscribes to a variable, creating it if it does not exist
+   * @param  key   the name of the variable
+   **/
+  void add(const std::string& key);
+
+  /**
+   * Subscribes to a variable
+   * @param  variable   a reference to the variable
+   **/
+  void add(const VariableReference& variable);
+
+  /**
+   * Subscribes to every variable whose name starts with a prefix,
+   * including variables created later
+   * @param  prefix   the prefix, e.g., "agent.0."
+   **/
+  void add_prefix(const std::string& prefix);
+
+  /**
+   * Subscribes to every change to the context
+   **/
+  void add_all(void);
+
+#ifndef _MADARA_NO_KARL_
+  /**
+   * Subscribes to the variables that an expression reads. Expressions
+   * that call functions or system calls, or that expand variable names,
+   * may read anything, so they subscribe to every change.
+   * @param  expression   a compiled expression
+   **/
+  void add(const CompiledExpression& expression);
+#endif  // _MADARA_NO_KARL_
+
+  /**
+   * Waits for a change to a subscribed variable. Changes made since the
+   * last wait or poll return immediately. Do not hold the context lock
+   * while waiting.
+   * @param  max_wait   the seconds to wait. Negative waits forever.
+   * @return the number of changes, or 0 if the wait timed out
+   **/
+  uint64_t wait(double max_wait = -1.0);
+
+  /**
+   * Waits for a change to a subscribed variable until a deadline
+   * @param  deadline   when to stop waiting. TimeValue::max () waits
+   *                    forever.
+   * @return the number of changes, or 0 if the wait timed out
+   **/
+  uint64_t wait_until(utility::TimeValue deadline);
+
+  /**
+   * Takes the changes made since the last wait or poll without blocking
+   * @return the number of changes
+   **/
+  uint64_t poll(void);
+
+private:
+  friend class ThreadSafeContext;
+
+  /**
+   * Subscribes to a record. Caller must hold the lock.
+   * @param  record   the record
+   **/
+  void add_record_unsafe(const KnowledgeRecord* record);
+
+  /**
+   * Counts a change and wakes the waiters. Caller must hold the lock.
+   **/
+  void notify_unsafe(void);
+
+  /// the context being watched
+  ThreadSafeContext& context_;
+
+  /// subscribed records
+  std::vector<const KnowledgeRecord*> records_;
+
+  /// subscribed prefixes
+  std::vector<std::string> prefixes_;
+
+  /// whether every change is subscribed
+  bool all_ = false;
+
+  /// changes since the last wait or poll, protected by the context lock
+  uint64_t pending_ = 0;
+
+  /// signaled when a subscribed variable changes
+  MADARA_CONDITION_TYPE changed_;
+};
+}
+}
+
+#endif  // _MADARA_KNOWLEDGE_SUBSCRIPTION_H_
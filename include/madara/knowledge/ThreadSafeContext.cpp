@@ -22,6 +22,7 @@
 #include "madara/transport/Transport.h"
 
 #include "madara/knowledge/CheckpointPlayer.h"
+#include "madara/knowledge/CheckpointIndex.h"
 
 namespace madara
 {
@@ -76,9 +77,18 @@ KnowledgeRecord* ThreadSafeContext::get_record(
   if (*key_ptr == "")
     return 0;
 
-  // if the variable doesn't exist, hash maps create a record automatically
-  // when used in this manner
-  return &map_[*key_ptr];
+  KnowledgeMap::value_type* entry = find_entry_unsafe(*key_ptr);
+
+  if (entry == nullptr)
+  {
+    entry = &*map_.emplace(std::piecewise_construct,
+        std::forward_as_tuple(*key_ptr), std::forward_as_tuple()).first;
+
+    if (index_.enabled())
+      index_.insert(entry);
+  }
+
+  return &entry->second;
 }
 
 VariableReference ThreadSafeContext::get_ref(
@@ -102,6 +112,15 @@ VariableReference ThreadSafeContext::get_ref(
     return {};
   }
 
+  if (index_.enabled())
+  {
+    KnowledgeMap::value_type* entry = index_.find(*key_ptr);
+    if (entry)
+    {
+      return entry;
+    }
+  }
+
   auto iter = map_.lower_bound(*key_ptr);
   if (iter == map_.end() || iter->first != *key_ptr)
   {
@@ -109,6 +128,9 @@ VariableReference ThreadSafeContext::get_ref(
         std::forward_as_tuple(*key_ptr), std::forward_as_tuple());
   }
 
+  if (index_.enabled())
+    index_.insert(&*iter);
+
   return &*iter;
 }
 
@@ -117,7 +139,7 @@ VariableReference ThreadSafeContext::get_ref(
 {
   std::string key_actual;
   const std::string* key_ptr;
-  MADARA_GUARD_TYPE guard(mutex_);
+  MADARA_READ_GUARD_TYPE guard(mutex_);
 
   VariableReference record;
 
@@ -135,8 +157,7 @@ VariableReference ThreadSafeContext::get_ref(
     return {};
   }
 
-  KnowledgeMap::const_iterator found = map_.find(*key_ptr);
-  return {const_cast<VariableReference::pair_ptr>(&*found)};
+  return {find_entry_unsafe(*key_ptr)};
 }
 
 // set the value of a variable
@@ -710,6 +731,10 @@ int ThreadSafeContext::update_record_from_external(const std::string& key,
     {
       ret.first->second = rhs;
     }
+    else if (index_.enabled())
+    {
+      index_.insert(&*found);
+    }
 
     mark_and_signal(&*found, settings);
   }
@@ -776,7 +801,7 @@ void ThreadSafeContext::set_changed(void)
 // print all variables and their values
 void ThreadSafeContext::print(unsigned int level) const
 {
-  MADARA_GUARD_TYPE guard(mutex_);
+  MADARA_READ_GUARD_TYPE guard(mutex_);
   for (KnowledgeMap::const_iterator i = map_.begin(); i != map_.end(); ++i)
   {
     if (i->second.exists())
@@ -792,7 +817,7 @@ void ThreadSafeContext::to_string(std::string& target,
     const std::string& array_delimiter, const std::string& record_delimiter,
     const std::string& key_val_delimiter) const
 {
-  MADARA_GUARD_TYPE guard(mutex_);
+  MADARA_READ_GUARD_TYPE guard(mutex_);
   std::stringstream buffer;
 
   bool first = true;
@@ -847,7 +872,7 @@ std::string ThreadSafeContext::expand_statement(
     const std::string& statement) const
 {
   // enter the mutex
-  MADARA_GUARD_TYPE guard(mutex_);
+  MADARA_READ_GUARD_TYPE guard(mutex_);
 
   // vectors for holding parsed tokens and pivot_list
   size_t subcount = 0;
@@ -1129,7 +1154,7 @@ size_t ThreadSafeContext::to_map(const std::string& expression,
   const char* subject_ptr = subject.c_str();
 
   // enter the mutex
-  MADARA_GUARD_TYPE guard(mutex_);
+  MADARA_READ_GUARD_TYPE guard(mutex_);
 
   // if expression is blank, assume the user wants all variables
   if (expression.size() == 0)
@@ -1230,7 +1255,7 @@ size_t ThreadSafeContext::to_map(const std::string& prefix,
   std::string last_key("");
 
   // enter the mutex
-  MADARA_GUARD_TYPE guard(mutex_);
+  MADARA_READ_GUARD_TYPE guard(mutex_);
 
   KnowledgeMap::iterator i = map_.begin();
 
@@ -1306,55 +1331,56 @@ void ThreadSafeContext::delete_prefix(
   std::pair<KnowledgeMap::iterator, KnowledgeMap::iterator> iters(
       get_prefix_range(prefix));
 
-  map_.erase(iters.first, iters.second);
-
+  // the changed maps are keyed by pointers into map_, so purge them first
   {
     // check the changed map
-    std::pair<VariableReferenceMap::iterator, VariableReferenceMap::iterator>
-        changed(changed_map_.lower_bound(prefix.c_str()), changed_map_.end());
+    VariableReferenceMap::iterator first =
+        changed_map_.lower_bound(prefix.c_str());
+    VariableReferenceMap::iterator last = first;
 
-    // does our lower bound actually contain the prefix?
-    if (prefix.compare(0, prefix.size(), changed.first->first, prefix.size()) ==
-        0)
+    // until we find an entry that does not begin with prefix, loop
+    while (last != changed_map_.end() &&
+           prefix.compare(0, prefix.size(), last->first, prefix.size()) == 0)
     {
-      changed.second = changed.first;
-
-      // until we find an entry that does not begin with prefix, loop
-      for (++changed.second; (prefix.compare(0, prefix.size(),
-                                  changed.second->first, prefix.size()) == 0) &&
-                             changed.second != changed_map_.end();
-           ++changed.second)
-      {
-      }
-
-      changed_map_.erase(changed.first, changed.second);
+      ++last;
     }
+
+    changed_map_.erase(first, last);
   }
 
   {
     // check the local changed map
-    std::pair<VariableReferenceMap::iterator, VariableReferenceMap::iterator>
-        local_changed(local_changed_map_.lower_bound(prefix.c_str()),
-            local_changed_map_.end());
+    VariableReferenceMap::iterator first =
+        local_changed_map_.lower_bound(prefix.c_str());
+    VariableReferenceMap::iterator last = first;
 
-    // does our lower bound actually contain the prefix?
-    if (prefix.compare(
-            0, prefix.size(), local_changed.first->first, prefix.size()) == 0)
+    // until we find an entry that does not begin with prefix, loop
+    while (last != local_changed_map_.end() &&
+           prefix.compare(0, prefix.size(), last->first, prefix.size()) == 0)
     {
-      local_changed.second = local_changed.first;
-
-      // until we find an entry that does not begin with prefix, loop
-      for (++local_changed.second;
-           (prefix.compare(0, prefix.size(), local_changed.second->first,
-                prefix.size()) == 0) &&
-           local_changed.second != local_changed_map_.end();
-           ++local_changed.second)
-      {
-      }
+      ++last;
+    }
+
+    local_changed_map_.erase(first, last);
+  }
 
-      local_changed_map_.erase(local_changed.first, local_changed.second);
+  if (index_.enabled())
+  {
+    for (auto i = iters.first; i != iters.second; ++i)
+    {
+      index_.erase(i->first);
     }
   }
+
+  if (subscriptions_ > 0)
+  {
+    for (auto i = iters.first; i != iters.second; ++i)
+    {
+      notify_subscriptions_unsafe(i->first.c_str(), &i->second);
+    }
+  }
+
+  map_.erase(iters.first, iters.second);
 }
 
 std::pair<KnowledgeMap::iterator, KnowledgeMap::iterator>
@@ -1404,7 +1430,7 @@ ThreadSafeContext::get_prefix_range(const std::string& prefix) const
 KnowledgeMap ThreadSafeContext::to_map(const std::string& prefix) const
 {
   // enter the mutex
-  MADARA_GUARD_TYPE guard(mutex_);
+  MADARA_READ_GUARD_TYPE guard(mutex_);
 
   std::pair<KnowledgeMap::const_iterator, KnowledgeMap::const_iterator> iters(
       get_prefix_range(prefix));
@@ -1416,7 +1442,7 @@ KnowledgeMap ThreadSafeContext::to_map(const std::string& prefix) const
 KnowledgeMap ThreadSafeContext::to_map_stripped(const std::string& prefix) const
 {
   // enter the mutex
-  MADARA_GUARD_TYPE guard(mutex_);
+  MADARA_READ_GUARD_TYPE guard(mutex_);
 
   std::pair<KnowledgeMap::const_iterator, KnowledgeMap::const_iterator> iters(
       get_prefix_range(prefix));
@@ -1445,6 +1471,8 @@ void ThreadSafeContext::copy(const ThreadSafeContext& source,
         " clearing knowledge in target context\n");
 
     map_.clear();
+    index_.clear();
+    index_changes_.clear();
   }
 
   if (reqs.predicates.size() != 0)
@@ -1559,7 +1587,11 @@ void ThreadSafeContext::copy(const ThreadSafeContext& source,
 {
   // if we need to clean first, clear the map
   if (clean_copy)
+  {
     map_.clear();
+    index_.clear();
+    index_changes_.clear();
+  }
 
   // if the copy set is empty, copy everything
   if (copy_set.size() == 0)
@@ -2407,7 +2439,8 @@ static void checkpoint_write_record(logger::Logger* logger_,
     const std::string& name, const KnowledgeRecord* record,
     const CheckpointSettings& settings,
     transport::MessageHeader& checkpoint_header, char*& current,
-    utility::ScopedArray<char>& buffer, int64_t& buffer_remaining)
+    utility::ScopedArray<char>& buffer, int64_t& buffer_remaining,
+    CheckpointIndex* index)
 {
   if (record->exists())
   {
@@ -2479,6 +2512,11 @@ static void checkpoint_write_record(logger::Logger* logger_,
     ++checkpoint_header.updates;
     checkpoint_header.size += (uint64_t)encoded_size;
 
+    if (index)
+    {
+      index->add_name(name, record->toi());
+    }
+
     madara_logger_ptr_log(logger_, logger::LOG_MINOR,
         "ThreadSafeContext::save_checkpoint:"
         " chkpt.header.size=%d, current->buffer delta=%d\n",
@@ -2542,7 +2580,8 @@ private:
 static void checkpoint_write_records(const ThreadSafeContext& context,
     logger::Logger* logger_, const CheckpointSettings& settings,
     transport::MessageHeader& checkpoint_header, char*& current,
-    utility::ScopedArray<char>& buffer, int64_t& buffer_remaining)
+    utility::ScopedArray<char>& buffer, int64_t& buffer_remaining,
+    CheckpointIndex* index)
 {
   ContextLocalModifiedsLister default_lister(context);
 
@@ -2565,14 +2604,83 @@ static void checkpoint_write_records(const ThreadSafeContext& context,
     auto record = e.second;
 
     checkpoint_write_record(logger_, e.first, record, settings,
-        checkpoint_header, current, buffer, buffer_remaining);
+        checkpoint_header, current, buffer, buffer_remaining, index);
+  }
+}
+
+/**
+ * Gets the index of a checkpoint file to add the next state to, or nullptr
+ * if the settings do not keep one. The index of the last save with the
+ * same settings (index) is reused while it still matches the file.
+ **/
+static CheckpointIndex* checkpoint_index_of(logger::Logger* logger_,
+    const CheckpointSettings& settings, std::fstream& file,
+    const FileHeader& meta, std::shared_ptr<CheckpointIndex>& index)
+{
+  if (!settings.keep_index)
+  {
+    index.reset();
+    return nullptr;
+  }
+
+  uint64_t end = meta.size + (uint64_t)FileHeader::encoded_size();
+
+  if (index && index->size() == meta.states && index->end() == end)
+  {
+    return index.get();
+  }
+
+  index = std::make_shared<CheckpointIndex>();
+
+  if (index->read(file, end))
+  {
+    madara_logger_ptr_log(logger_, logger::LOG_MINOR,
+        "ThreadSafeContext::save_checkpoint:"
+        " read index of %d states\n",
+        (int)index->size());
+
+    if (index->size() == meta.states)
+    {
+      return index.get();
+    }
   }
+
+  madara_logger_ptr_log(logger_, logger::LOG_MAJOR,
+      "ThreadSafeContext::save_checkpoint:"
+      " %s has no index. Reading its %d states to build one.\n",
+      settings.filename.c_str(), (int)meta.states);
+
+  try
+  {
+    CheckpointSettings scan(settings);
+    CheckpointReader reader(scan);
+    *index = reader.get_index();
+  }
+  catch (exceptions::MadaraException& e)
+  {
+    madara_logger_ptr_log(logger_, logger::LOG_ERROR,
+        "ThreadSafeContext::save_checkpoint:"
+        " could not build index: %s. Saving without one.\n",
+        e.what());
+
+    index.reset();
+    return nullptr;
+  }
+
+  if (index->size() != meta.states || index->end() != end)
+  {
+    index.reset();
+    return nullptr;
+  }
+
+  return index.get();
 }
 
 static void checkpoint_do_incremental(const ThreadSafeContext& context,
     logger::Logger* logger_, uint64_t clock_,
     const CheckpointSettings& settings, std::fstream& file, FileHeader& meta,
-    transport::MessageHeader& checkpoint_header)
+    transport::MessageHeader& checkpoint_header,
+    std::shared_ptr<CheckpointIndex>& index_cache, bool defer_index)
 {
   int64_t total_written(0);
 
@@ -2586,6 +2694,14 @@ static void checkpoint_do_incremental(const ThreadSafeContext& context,
   if (settings.variables_lister != nullptr ||
       context.get_local_modified().size() != 0)
   {
+    CheckpointIndex* index =
+        checkpoint_index_of(logger_, settings, file, meta, index_cache);
+
+    if (index)
+    {
+      index->add_state(checkpoint_start, checkpoint_header.clock);
+    }
+
     // skip over the checkpoint header. We'll write this later with the records
 
     madara_logger_ptr_log(logger_, logger::LOG_MINOR,
@@ -2607,7 +2723,7 @@ static void checkpoint_do_incremental(const ThreadSafeContext& context,
         (int)(current - buffer.get_ptr()));
 
     checkpoint_write_records(context, logger_, settings, checkpoint_header,
-        current, buffer, buffer_remaining);
+        current, buffer, buffer_remaining, index);
 
     ++meta.states;
 
@@ -2666,6 +2782,20 @@ static void checkpoint_do_incremental(const ThreadSafeContext& context,
           total_encoded, (int)meta.size);
     }
 
+    if (index && defer_index)
+    {
+      index->set_end(meta.size + FileHeader::encoded_size());
+    }
+    else if (index)
+    {
+      madara_logger_ptr_log(logger_, logger::LOG_MINOR,
+          "ThreadSafeContext::save_checkpoint:"
+          " writing index of %d states at offset %d bytes\n",
+          (int)index->size(), (int)(meta.size + FileHeader::encoded_size()));
+
+      index->write(file, meta.size + FileHeader::encoded_size());
+    }
+
     buffer_remaining = max_buffer;
     // fseek (file, (long)checkpoint_start, SEEK_SET);
     file.seekp(0, file.beg);
@@ -2698,7 +2828,8 @@ static void checkpoint_do_incremental(const ThreadSafeContext& context,
 static void checkpoint_do_initial(const ThreadSafeContext& context,
     logger::Logger* logger_, uint64_t clock_,
     const CheckpointSettings& settings, std::fstream& file, FileHeader& meta,
-    transport::MessageHeader& checkpoint_header)
+    transport::MessageHeader& checkpoint_header,
+    std::shared_ptr<CheckpointIndex>& index_cache, bool defer_index)
 {
   int file_header_size = (int)FileHeader::encoded_size();
 
@@ -2709,12 +2840,25 @@ static void checkpoint_do_initial(const ThreadSafeContext& context,
   char* current = init_checkpoint_header(logger_, clock_, settings, meta,
       checkpoint_header, buffer_remaining, buffer);
 
+  CheckpointIndex* index = nullptr;
+
+  if (settings.keep_index)
+  {
+    index_cache = std::make_shared<CheckpointIndex>();
+    index = index_cache.get();
+    index->add_state(file_header_size, checkpoint_header.clock);
+  }
+  else
+  {
+    index_cache.reset();
+  }
+
   madara_logger_ptr_log(logger_, logger::LOG_MINOR,
       "ThreadSafeContext::save_checkpoint:"
       " writing diff records\n");
 
   checkpoint_write_records(context, logger_, settings, checkpoint_header,
-      current, buffer, buffer_remaining);
+      current, buffer, buffer_remaining, index);
 
   char* final_position = current;
   int full_buffer = final_position - buffer.get_ptr();
@@ -2765,6 +2909,15 @@ static void checkpoint_do_initial(const ThreadSafeContext& context,
       " wrote: %d bytes to file from beginning.\n",
       (int)total + (int)FileHeader::encoded_size());
 
+  if (index && defer_index)
+  {
+    index->set_end((uint64_t)total + (uint64_t)file_header_size);
+  }
+  else if (index)
+  {
+    index->write(file, (uint64_t)total + (uint64_t)file_header_size);
+  }
+
   // fclose (file);
   file.close();
 }
@@ -2787,8 +2940,8 @@ int64_t ThreadSafeContext::save_checkpoint(
 
   if (file)
   {
-    checkpoint_do_incremental(
-        *this, logger_, clock_, settings, file, meta, checkpoint_header);
+    checkpoint_do_incremental(*this, logger_, clock_, settings, file, meta,
+        checkpoint_header, settings.checkpoint_index, settings.defer_index);
   }  // if file is opened
   else
   {
@@ -2815,8 +2968,8 @@ int64_t ThreadSafeContext::save_checkpoint(
       return -1;
     }
 
-    checkpoint_do_initial(
-        *this, logger_, clock_, settings, file, meta, checkpoint_header);
+    checkpoint_do_initial(*this, logger_, clock_, settings, file, meta,
+        checkpoint_header, settings.checkpoint_index, settings.defer_index);
   }  // end if we need to create a new file
 
   return checkpoint_header.size;
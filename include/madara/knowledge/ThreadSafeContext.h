@@ -13,6 +13,7 @@
 
 #include <string>
 #include <map>
+#include <unordered_map>
 #include <memory>
 #include <fstream>
 #include "madara/utility/IntTypes.h"
@@ -20,6 +21,8 @@
 #include "madara/MadaraExport.h"
 #include "madara/LockType.h"
 #include "madara/knowledge/KnowledgeRecord.h"
+#include "madara/knowledge/KnowledgeMapIndex.h"
+#include "madara/knowledge/IndexChangeLog.h"
 #include "madara/knowledge/KnowledgeRequirements.h"
 #include "madara/knowledge/VariableReference.h"
 #include "madara/knowledge/FunctionMap.h"
@@ -28,6 +31,7 @@
 #include "madara/knowledge/CompiledExpression.h"
 #include "madara/knowledge/CheckpointSettings.h"
 #include "madara/knowledge/BaseStreamer.h"
+#include "madara/knowledge/Subscription.h"
 #include "madara/transport/MessageHeader.h"
 
 #ifdef _MADARA_JAVA_
@@ -46,6 +50,7 @@ namespace expression
 class Interpreter;
 class CompositeArrayReference;
 class VariableNode;
+class Bytecode;
 }
 
 namespace knowledge
@@ -82,7 +87,9 @@ public:
   friend class KnowledgeBaseImpl;
   friend class expression::CompositeArrayReference;
   friend class expression::VariableNode;
+  friend class expression::Bytecode;
   friend class rcw::BaseTracker;
+  friend class Subscription;
 
   /**
    * Constructor.
@@ -1725,6 +1732,9 @@ public:
    * Reading the map is then generally safe, but writting to it will bypass
    * important mechanisms such as modification tracking. Make sure you know
    * what you're doing, and consider whether other methods fit your needs.
+   * If the hash index is enabled (@see use_hash_index), erasing entries
+   * through this reference leaves the index dangling; call
+   * use_hash_index (true) again afterwards to rebuild it.
    *
    * @return a reference to this context's KnowledgeMap
    **/
@@ -1750,6 +1760,68 @@ public:
     return map_;
   }
 
+  /**
+   * Enables or disables a hash index over variable names. When enabled,
+   * lookups by name (get, exists, get_ref, etc.) are resolved through an
+   * open-addressing hash table instead of a search of the ordered map.
+   * The ordered map is still used for prefix operations (to_map,
+   * delete_prefix, get_matches). Enabling rebuilds the index from the
+   * current contents of the context. VariableReferences remain valid.
+   * @param  enable   true to enable the hash index, false to disable it
+   **/
+  void use_hash_index(bool enable = true);
+
+  /**
+   * Checks if the hash index is enabled
+   * @return  true if lookups by name use the hash index
+   **/
+  bool uses_hash_index(void) const;
+
+  /**
+   * Enables or disables tracking of the index ranges set_index changes
+   * in array records, so that transports can send only the changed
+   * elements (@see TransportSettings::send_deltas). Disabling forgets
+   * the ranges tracked so far.
+   * @param  enable   true to track index changes
+   **/
+  void track_index_changes(bool enable = true);
+
+  /**
+   * Checks if index changes are tracked
+   * @return  true if set_index changes are tracked
+   **/
+  bool tracks_index_changes(void) const;
+
+  /**
+   * Gets the index ranges that changed between two values of an array
+   * record. Only changes made by set_index while tracking are known, so
+   * this fails if the record was modified any other way in between.
+   * @param  key      the name of the record
+   * @param  since    the toi of the older value
+   * @param  until    the toi of the newer value
+   * @param  ranges   filled with the sorted, disjoint ranges that changed
+   * @return true if every change between the values is known
+   **/
+  bool get_index_changes(const std::string& key, uint64_t since,
+      uint64_t until, IndexRanges& ranges) const;
+
+  /**
+   * Enables or disables lowering of compiled expressions into bytecode.
+   * Bytecode keeps values in typed registers and reads and writes
+   * variables through references resolved at compile time, so it avoids
+   * most of the virtual calls and KnowledgeRecord copies of evaluating
+   * the tree. Results are the same either way. Expressions compiled
+   * afterwards, including cached ones, follow the setting.
+   * @param  enable   true to lower expressions into bytecode
+   **/
+  void use_bytecode(bool enable = true);
+
+  /**
+   * Checks if compiled expressions are lowered into bytecode
+   * @return  true if expressions are lowered into bytecode
+   **/
+  bool uses_bytecode(void) const;
+
   template<typename Callable>
   auto invoke(const std::string& key, Callable&& callable,
       const KnowledgeUpdateSettings& settings = KnowledgeUpdateSettings())
@@ -1866,8 +1938,49 @@ private:
   std::pair<KnowledgeMap::iterator, KnowledgeMap::iterator> get_prefix_range(
       const std::string& prefix);
 
-  /// Hash table containing variable names and values.
+  /**
+   * Finds an existing entry by name, using the hash index if enabled.
+   * Caller must hold the lock.
+   * @param  key   the expanded variable name
+   * @return the map entry, or nullptr if the variable does not exist
+   **/
+  KnowledgeMap::value_type* find_entry_unsafe(const std::string& key) const;
+
+  /**
+   * Wakes the subscriptions to a record. Caller must hold the lock.
+   * @param  name     the name of the record
+   * @param  record   the record that changed
+   **/
+  void notify_subscriptions_unsafe(
+      const char* name, const KnowledgeRecord* record);
+
+  /**
+   * Keeps the index changes made so far to a record apart from later
+   * ones, as its current value is about to be sent. Caller must hold
+   * the lock.
+   * @param  record   the record being sent
+   **/
+  void mark_index_changes_taken_unsafe(const KnowledgeRecord* record);
+
+  /**
+   * Wakes every subscription, e.g., after records are deleted or reset.
+   * Caller must hold the lock.
+   **/
+  void notify_all_subscriptions_unsafe(void);
+
+  /// Ordered map containing variable names and values.
   madara::knowledge::KnowledgeMap map_;
+
+  /// Optional hash index over the entries of map_
+  KnowledgeMapIndex index_;
+
+  /// if true, the index ranges set_index changes are kept in
+  /// index_changes_
+  bool track_index_changes_ = false;
+
+  /// index ranges set_index changed, by record. Logs of erased records
+  /// are harmless, as a new record starts a new chain of changes.
+  std::unordered_map<const KnowledgeRecord*, IndexChangeLog> index_changes_;
   mutable MADARA_LOCK_TYPE mutex_;
   mutable MADARA_CONDITION_TYPE changed_;
   std::vector<std::string> expansion_splitters_;
@@ -1881,11 +1994,27 @@ private:
   /// KaRL interpreter
   madara::expression::Interpreter* interpreter_;
 
+  /// if true, compiled expressions are lowered into bytecode
+  bool use_bytecode_ = false;
+
   /// Logger for printing
   mutable logger::Logger* logger_;
 
   /// Streaming provider for saving all updates
   std::unique_ptr<BaseStreamer> streamer_ = nullptr;
+
+  /// subscriptions to particular records
+  std::unordered_map<const KnowledgeRecord*, std::vector<Subscription*>>
+      record_subscriptions_;
+
+  /// subscriptions to records whose names start with a prefix
+  std::vector<std::pair<std::string, Subscription*>> prefix_subscriptions_;
+
+  /// subscriptions to every change
+  std::vector<Subscription*> all_subscriptions_;
+
+  /// entries over all subscription lists, so updates can skip the lookups
+  size_t subscriptions_ = 0;
 };
 }
 }
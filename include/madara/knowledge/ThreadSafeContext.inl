@@ -27,6 +27,9 @@ inline int ThreadSafeContext::read_file(const std::string& key,
 inline KnowledgeRecord ThreadSafeContext::get(
     const std::string& key, const KnowledgeReferenceSettings& settings) const
 {
+  // hold the lock while the record is copied out
+  MADARA_READ_GUARD_TYPE guard(mutex_);
+
   const KnowledgeRecord* ret = with(key, settings);
   if (ret)
   {
@@ -63,6 +66,9 @@ inline KnowledgeRecord ThreadSafeContext::get(
 inline KnowledgeRecord ThreadSafeContext::get(const VariableReference& variable,
     const KnowledgeReferenceSettings& settings) const
 {
+  // hold the lock while the record is copied out
+  MADARA_READ_GUARD_TYPE guard(mutex_);
+
   const KnowledgeRecord* ret = with(variable, settings);
   if (ret)
   {
@@ -99,6 +105,9 @@ inline KnowledgeRecord ThreadSafeContext::get(const VariableReference& variable,
 inline KnowledgeRecord ThreadSafeContext::get_actual(
     const std::string& key, const KnowledgeReferenceSettings& settings) const
 {
+  // hold the lock while the record is copied out
+  MADARA_READ_GUARD_TYPE guard(mutex_);
+
   const KnowledgeRecord* ret = with(key, settings);
   if (ret)
   {
@@ -119,6 +128,9 @@ inline KnowledgeRecord ThreadSafeContext::get_actual(
     const VariableReference& variable,
     const KnowledgeReferenceSettings& settings) const
 {
+  // hold the lock while the record is copied out
+  MADARA_READ_GUARD_TYPE guard(mutex_);
+
   const KnowledgeRecord* ret = with(variable, settings);
   if (ret)
   {
@@ -138,21 +150,21 @@ inline KnowledgeRecord ThreadSafeContext::get_actual(
 inline KnowledgeRecord* ThreadSafeContext::with(
     const std::string& key, const KnowledgeReferenceSettings& settings)
 {
-  KnowledgeMap::iterator found;
+  KnowledgeMap::value_type* found;
 
   MADARA_GUARD_TYPE guard(mutex_);
 
   if (settings.expand_variables)
   {
     std::string cur_key = expand_statement(key);
-    found = map_.find(cur_key);
+    found = find_entry_unsafe(cur_key);
   }
   else
   {
-    found = map_.find(key);
+    found = find_entry_unsafe(key);
   }
 
-  if (found != map_.end())
+  if (found != nullptr)
   {
     return &found->second;
   }
@@ -183,21 +195,21 @@ inline KnowledgeRecord* ThreadSafeContext::with(
 inline const KnowledgeRecord* ThreadSafeContext::with(
     const std::string& key, const KnowledgeReferenceSettings& settings) const
 {
-  KnowledgeMap::const_iterator found;
+  const KnowledgeMap::value_type* found;
 
-  MADARA_GUARD_TYPE guard(mutex_);
+  MADARA_READ_GUARD_TYPE guard(mutex_);
 
   if (settings.expand_variables)
   {
     std::string cur_key = expand_statement(key);
-    found = map_.find(cur_key);
+    found = find_entry_unsafe(cur_key);
   }
   else
   {
-    found = map_.find(key);
+    found = find_entry_unsafe(key);
   }
 
-  if (found != map_.end())
+  if (found != nullptr)
   {
     if (settings.exception_on_unitialized && !found->second.exists())
     {
@@ -218,7 +230,7 @@ inline const KnowledgeRecord* ThreadSafeContext::with(
     const VariableReference& variable,
     const KnowledgeReferenceSettings& settings) const
 {
-  MADARA_GUARD_TYPE guard(mutex_);
+  MADARA_READ_GUARD_TYPE guard(mutex_);
 
   KnowledgeRecord* ret = variable.get_record_unsafe();
 
@@ -238,7 +250,7 @@ inline bool ThreadSafeContext::exists(
     const VariableReference& variable,
     const KnowledgeReferenceSettings& settings) const
 {
-  MADARA_GUARD_TYPE guard(mutex_);
+  MADARA_READ_GUARD_TYPE guard(mutex_);
 
   auto ret = variable.get_record_unsafe();
 
@@ -508,10 +520,33 @@ inline int ThreadSafeContext::set_index_unsafe_impl(
   else
     record->quality = 0;
 
+  uint64_t prev_toi = record->toi();
+  uint32_t prev_type = record->type();
+  size_t prev_size = record->size();
+
   record->set_index(index, std::forward<T>(value));
   record->quality = record->write_quality;
   record->clock = clock_;
-  record->set_toi(utility::get_time());
+
+  uint64_t toi = utility::get_time();
+
+  if (track_index_changes_)
+  {
+    // tois tell the values of a record apart, so each needs its own
+    if (toi <= prev_toi)
+    {
+      toi = prev_toi + 1;
+    }
+
+    // growing or converting the array changes more than the index
+    if (record->type() == prev_type && record->size() == prev_size &&
+        !record->has_history())
+    {
+      index_changes_[record].add(prev_toi, toi, index, index + 1);
+    }
+  }
+
+  record->set_toi(toi);
 
   return 0;
 }
@@ -651,7 +686,16 @@ inline bool ThreadSafeContext::delete_variable(
   changed_map_.erase(key_ptr->c_str());
   local_changed_map_.erase(key_ptr->c_str());
 
-  // erase the map
+  if (subscriptions_ > 0)
+  {
+    KnowledgeMap::iterator found = map_.find(*key_ptr);
+
+    if (found != map_.end())
+      notify_subscriptions_unsafe(found->first.c_str(), &found->second);
+  }
+
+  // erase the index and the map
+  index_.erase(*key_ptr);
   result = map_.erase(*key_ptr) == 1;
 
   return result;
@@ -668,7 +712,11 @@ inline bool ThreadSafeContext::delete_variable(
   changed_map_.erase(var.entry_->first.c_str());
   local_changed_map_.erase(var.entry_->first.c_str());
 
-  // erase the map
+  if (subscriptions_ > 0)
+    notify_subscriptions_unsafe(var.entry_->first.c_str(), &var.entry_->second);
+
+  // erase the index and the map
+  index_.erase(var.entry_->first);
   return map_.erase(var.entry_->first.c_str()) == 1;
 }
 
@@ -679,6 +727,10 @@ inline void ThreadSafeContext::delete_variables(KnowledgeMap::iterator begin,
   {
     changed_map_.erase(cur->first.c_str());
     local_changed_map_.erase(cur->first.c_str());
+    index_.erase(cur->first);
+
+    if (subscriptions_ > 0)
+      notify_subscriptions_unsafe(cur->first.c_str(), &cur->second);
   }
   map_.erase(begin, end);
 }
@@ -690,7 +742,7 @@ inline bool ThreadSafeContext::exists(
   // enter the mutex
   std::string key_actual;
   const std::string* key_ptr;
-  MADARA_GUARD_TYPE guard(mutex_);
+  MADARA_READ_GUARD_TYPE guard(mutex_);
 
   if (settings.expand_variables)
   {
@@ -704,10 +756,10 @@ inline bool ThreadSafeContext::exists(
   if (*key_ptr != "")
   {
     // find the key in the knowledge base
-    KnowledgeMap::const_iterator found = map_.find(*key_ptr);
+    const KnowledgeMap::value_type* found = find_entry_unsafe(*key_ptr);
 
     // if it's found, then return the value
-    if (found != map_.end())
+    if (found != nullptr)
       return found->second.status() != knowledge::KnowledgeRecord::UNCREATED;
   }
 
@@ -833,7 +885,7 @@ inline uint64_t ThreadSafeContext::inc_clock(
 /// than our current clock get discarded)
 inline uint64_t ThreadSafeContext::get_clock(void) const
 {
-  MADARA_GUARD_TYPE guard(mutex_);
+  MADARA_READ_GUARD_TYPE guard(mutex_);
   return clock_;
 }
 
@@ -856,7 +908,7 @@ inline uint64_t ThreadSafeContext::get_clock(
   // enter the mutex
   std::string key_actual;
   const std::string* key_ptr;
-  MADARA_GUARD_TYPE guard(mutex_);
+  MADARA_READ_GUARD_TYPE guard(mutex_);
 
   if (settings.expand_variables)
   {
@@ -871,10 +923,10 @@ inline uint64_t ThreadSafeContext::get_clock(
     return 0;
 
   // find the key in the knowledge base
-  KnowledgeMap::const_iterator found = map_.find(*key_ptr);
+  const KnowledgeMap::value_type* found = find_entry_unsafe(*key_ptr);
 
   // if it's found, then compare the value
-  if (found != map_.end())
+  if (found != nullptr)
   {
     return found->second.clock;
   }
@@ -883,6 +935,94 @@ inline uint64_t ThreadSafeContext::get_clock(
     return 0;
 }
 
+inline KnowledgeMap::value_type* ThreadSafeContext::find_entry_unsafe(
+    const std::string& key) const
+{
+  if (index_.enabled())
+  {
+    KnowledgeMap::value_type* entry = index_.find(key);
+    if (entry)
+      return entry;
+  }
+
+  KnowledgeMap::const_iterator found = map_.find(key);
+
+  if (found != map_.end())
+  {
+    return const_cast<KnowledgeMap::value_type*>(&*found);
+  }
+
+  return nullptr;
+}
+
+inline void ThreadSafeContext::use_hash_index(bool enable)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  index_.enable(enable, map_);
+}
+
+inline bool ThreadSafeContext::uses_hash_index(void) const
+{
+  MADARA_READ_GUARD_TYPE guard(mutex_);
+
+  return index_.enabled();
+}
+
+inline void ThreadSafeContext::track_index_changes(bool enable)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  track_index_changes_ = enable;
+
+  if (!enable)
+  {
+    index_changes_.clear();
+  }
+}
+
+inline bool ThreadSafeContext::tracks_index_changes(void) const
+{
+  MADARA_READ_GUARD_TYPE guard(mutex_);
+
+  return track_index_changes_;
+}
+
+inline bool ThreadSafeContext::get_index_changes(const std::string& key,
+    uint64_t since, uint64_t until, IndexRanges& ranges) const
+{
+  MADARA_READ_GUARD_TYPE guard(mutex_);
+
+  KnowledgeMap::value_type* entry = find_entry_unsafe(key);
+
+  if (entry)
+  {
+    auto found = index_changes_.find(&entry->second);
+
+    if (found != index_changes_.end())
+    {
+      return found->second.changed(since, until, ranges);
+    }
+  }
+
+  ranges.clear();
+  return false;
+}
+
+inline void ThreadSafeContext::use_bytecode(bool enable)
+{
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  use_bytecode_ = enable;
+}
+
+inline bool ThreadSafeContext::uses_bytecode(void) const
+{
+  MADARA_READ_GUARD_TYPE guard(mutex_);
+
+  return use_bytecode_;
+}
+
 /// Lock the mutex on this context. Warning: this will cause
 /// all operations to block until the unlock call is made.
 inline void ThreadSafeContext::lock(void) const
@@ -922,6 +1062,8 @@ inline void ThreadSafeContext::clear(bool erase)
   if (erase)
   {
     map_.clear();
+    index_.clear();
+    index_changes_.clear();
   }
   else
   {
@@ -931,6 +1073,8 @@ inline void ThreadSafeContext::clear(bool erase)
     }
   }
 
+  notify_all_subscriptions_unsafe();
+
   changed_.MADARA_CONDITION_NOTIFY_ONE();
 }
 
@@ -1040,7 +1184,54 @@ inline void ThreadSafeContext::mark_and_signal(
   }
 
   if (settings.signal_changes)
+  {
     changed_.MADARA_CONDITION_NOTIFY_ALL();
+
+    if (subscriptions_ > 0)
+      notify_subscriptions_unsafe(ref.get_name(), ref.get_record_unsafe());
+  }
+}
+
+inline void ThreadSafeContext::notify_subscriptions_unsafe(
+    const char* name, const KnowledgeRecord* record)
+{
+  if (!record_subscriptions_.empty())
+  {
+    auto found = record_subscriptions_.find(record);
+
+    if (found != record_subscriptions_.end())
+    {
+      for (Subscription* subscription : found->second)
+        subscription->notify_unsafe();
+    }
+  }
+
+  for (auto& prefix : prefix_subscriptions_)
+  {
+    if (strncmp(name, prefix.first.c_str(), prefix.first.size()) == 0)
+      prefix.second->notify_unsafe();
+  }
+
+  for (Subscription* subscription : all_subscriptions_)
+    subscription->notify_unsafe();
+}
+
+inline void ThreadSafeContext::notify_all_subscriptions_unsafe(void)
+{
+  if (subscriptions_ == 0)
+    return;
+
+  for (auto& record : record_subscriptions_)
+  {
+    for (Subscription* subscription : record.second)
+      subscription->notify_unsafe();
+  }
+
+  for (auto& prefix : prefix_subscriptions_)
+    prefix.second->notify_unsafe();
+
+  for (Subscription* subscription : all_subscriptions_)
+    subscription->notify_unsafe();
 }
 
 inline void ThreadSafeContext::mark_modified(
@@ -1066,7 +1257,7 @@ inline void ThreadSafeContext::mark_modified(
 
 inline std::string ThreadSafeContext::debug_modifieds(void) const
 {
-  MADARA_GUARD_TYPE guard(mutex_);
+  MADARA_READ_GUARD_TYPE guard(mutex_);
   std::stringstream result;
 
   result << changed_map_.size() << " modifications ready to send:\n";
@@ -1117,6 +1308,17 @@ inline const VariableReferenceMap& ThreadSafeContext::get_modifieds(void) const
   return changed_map_;
 }
 
+inline void ThreadSafeContext::mark_index_changes_taken_unsafe(
+    const KnowledgeRecord* record)
+{
+  auto found = index_changes_.find(record);
+
+  if (found != index_changes_.end())
+  {
+    found->second.mark_taken();
+  }
+}
+
 inline KnowledgeMap ThreadSafeContext::get_modifieds_current(
   const std::map<std::string, bool> & send_list, bool reset)
 {
@@ -1133,6 +1335,11 @@ inline KnowledgeMap ThreadSafeContext::get_modifieds_current(
       map.emplace_hint (map.end(),
         i->first, *i->second.get_record_unsafe());
 
+      if (track_index_changes_)
+      {
+        mark_index_changes_taken_unsafe(i->second.get_record_unsafe());
+      }
+
       if (reset)
       {
         i = changed_map_.erase(i);
@@ -1153,6 +1360,12 @@ inline KnowledgeMap ThreadSafeContext::get_modifieds_current(
         {
           map.emplace_hint(
             map.end(), found->first, *found->second.get_record_unsafe());
+
+          if (track_index_changes_)
+          {
+            mark_index_changes_taken_unsafe(found->second.get_record_unsafe());
+          }
+
           changed_map_.erase(found);
         }
       }
@@ -1167,6 +1380,11 @@ inline KnowledgeMap ThreadSafeContext::get_modifieds_current(
           map.emplace_hint (map.end(),
             i->first, *i->second.get_record_unsafe());
 
+          if (track_index_changes_)
+          {
+            mark_index_changes_taken_unsafe(i->second.get_record_unsafe());
+          }
+
           if (reset)
           {
             i = changed_map_.erase (i);
@@ -126,7 +126,9 @@ struct WaitSettings : public EvalSettings
   }
 
   /**
-   * Frequency to poll an expression for truth (in seconds)
+   * Frequency to poll an expression for truth (in seconds). If zero or
+   * negative, the expression is only reevaluated when a variable it
+   * reads changes (see Subscription).
    **/
   double poll_frequency;
 
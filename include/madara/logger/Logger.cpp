@@ -5,6 +5,84 @@
 #include <madara/utility/Utility.h>
 #include <boost/lexical_cast.hpp>
 #include <iomanip>
+#include <algorithm>
+#include <string.h>
+
+/**
+ * Messages from one thread, waiting for the background thread. Only the
+ * logging thread moves head and only the background thread moves tail.
+ * Each message is a Header followed by its text, padded to 8 bytes.
+ **/
+struct madara::logger::Logger::AsyncRing
+{
+  struct Header
+  {
+    uint32_t length;
+    int32_t level;
+  };
+
+  AsyncRing(size_t size) : buffer(size < 64 ? 64 : size) {}
+
+  /// copies bytes in at a position, wrapping around the end
+  void copy_in(uint64_t position, const void* source, size_t length)
+  {
+    size_t start = (size_t)(position % buffer.size());
+    size_t first = std::min(length, buffer.size() - start);
+
+    memcpy(buffer.data() + start, source, first);
+    memcpy(buffer.data(), (const char*)source + first, length - first);
+  }
+
+  /// copies bytes out from a position, wrapping around the end
+  void copy_out(uint64_t position, void* target, size_t length) const
+  {
+    size_t start = (size_t)(position % buffer.size());
+    size_t first = std::min(length, buffer.size() - start);
+
+    memcpy(target, buffer.data() + start, first);
+    memcpy((char*)target + first, buffer.data(), length - first);
+  }
+
+  std::vector<char> buffer;
+
+  /// bytes ever written
+  std::atomic<uint64_t> head{0};
+
+  /// bytes ever read
+  std::atomic<uint64_t> tail{0};
+
+  /// set when the logging thread exits
+  std::atomic<bool> closed{false};
+
+  /// set when the logger stops reading the ring
+  std::atomic<bool> retired{false};
+};
+
+/**
+ * The rings a thread logs to, by the async id of their logger. The
+ * logger reads a ring until its thread exits.
+ **/
+struct madara::logger::Logger::ThreadRings
+{
+  ~ThreadRings()
+  {
+    for (auto& entry : rings)
+    {
+      entry.second->closed = true;
+    }
+  }
+
+  std::vector<std::pair<uint64_t, std::shared_ptr<AsyncRing>>> rings;
+};
+
+namespace
+{
+/// source of ids that tell the rings of loggers apart
+std::atomic<uint64_t> next_async_id(0);
+
+/// how long the background thread waits when there are no messages
+const std::chrono::milliseconds async_idle_wait(10);
+}
 
 #ifndef MADARA_NO_THREAD_LOCAL
 thread_local int madara::logger::Logger::thread_level_(
@@ -14,6 +92,9 @@ thread_local std::string madara::logger::Logger::thread_name_("");
 
 thread_local double madara::logger::Logger::thread_hertz_(
     madara::logger::TLS_THREAD_HZ_DEFAULT);
+
+thread_local madara::logger::Logger::ThreadRings
+    madara::logger::Logger::thread_rings_;
 #endif
 
 madara::logger::Logger::Logger(bool log_to_terminal)
@@ -32,6 +113,7 @@ madara::logger::Logger::Logger(bool log_to_terminal)
 
 madara::logger::Logger::~Logger()
 {
+  disable_async();
   clear();
 }
 
@@ -142,15 +224,23 @@ void madara::logger::Logger::log(int level, const char* message, ...)
        *
        * First, search and replace the custom key string for local thread.
        * The return value is a copy of the potential prefix with the custom
-       * key string data embedded the number of times it was used.
+       * key string data embedded the number of times it was used. Custom
+       * key strings all start with %M, so most messages skip this.
        **/
-      std::string mad_str = message;
-      mad_str = search_and_insert_custom_tstamp(mad_str, MADARA_GET_TIME_MGT_);
-      mad_str = search_and_insert_custom_tstamp(mad_str, MADARA_THREAD_NAME_);
-      mad_str = search_and_insert_custom_tstamp(mad_str, MADARA_THREAD_HERTZ_);
+      const char* format = message;
+      std::string mad_str;
 
-      char custom_buffer[10240];
-      std::strcpy(custom_buffer, mad_str.c_str());
+      if (strstr(message, "%M") != 0)
+      {
+        mad_str = message;
+        mad_str =
+            search_and_insert_custom_tstamp(mad_str, MADARA_GET_TIME_MGT_);
+        mad_str = search_and_insert_custom_tstamp(mad_str, MADARA_THREAD_NAME_);
+        mad_str =
+            search_and_insert_custom_tstamp(mad_str, MADARA_THREAD_HERTZ_);
+
+        format = mad_str.c_str();
+      }
 
       /**
        * Prepare string to write into copy of the message buffer.
@@ -165,21 +255,31 @@ void madara::logger::Logger::log(int level, const char* message, ...)
       time(&raw_time);
       time_info = localtime(&raw_time);
 
-      mad_str = search_and_insert_custom_tstamp(
-          timestamp_format_, MADARA_GET_TIME_MGT_);
-      mad_str = search_and_insert_custom_tstamp(mad_str, MADARA_THREAD_NAME_);
-      mad_str = search_and_insert_custom_tstamp(mad_str, MADARA_THREAD_HERTZ_);
+      const char* timestamp_format = timestamp_format_.c_str();
+      std::string timestamp_str;
+
+      if (timestamp_format_.find("%M") != std::string::npos)
+      {
+        timestamp_str = search_and_insert_custom_tstamp(
+            timestamp_format_, MADARA_GET_TIME_MGT_);
+        timestamp_str =
+            search_and_insert_custom_tstamp(timestamp_str, MADARA_THREAD_NAME_);
+        timestamp_str = search_and_insert_custom_tstamp(
+            timestamp_str, MADARA_THREAD_HERTZ_);
+
+        timestamp_format = timestamp_str.c_str();
+      }
 
       /**
        * Process the normal message buffer and write into final copy to
        * return.
        **/
       size_t chars_written =
-          strftime(begin, remaining_buffer, mad_str.c_str(), time_info);
+          strftime(begin, remaining_buffer, timestamp_format, time_info);
 
       remaining_buffer -= chars_written;
       begin += chars_written;
-      vsnprintf(begin, remaining_buffer, custom_buffer, argptr);
+      vsnprintf(begin, remaining_buffer, format, argptr);
     }
     else
     {
@@ -188,42 +288,292 @@ void madara::logger::Logger::log(int level, const char* message, ...)
 
     va_end(argptr);
 
+#ifndef MADARA_NO_THREAD_LOCAL
+    if (async_.load(std::memory_order_acquire))
+    {
+      push(level, buffer, strlen(buffer));
+      return;
+    }
+#endif
+
     MADARA_GUARD_TYPE guard(mutex_);
 
+    write(level, buffer);
+  }
+}
+
+void madara::logger::Logger::write(int level, const char* buffer)
+{
 #ifdef _MADARA_ANDROID_
-    if (this->term_added_ || this->syslog_added_)
+  if (this->term_added_ || this->syslog_added_)
+  {
+    if (level == LOG_ERROR)
     {
-      if (level == LOG_ERROR)
-      {
-        __android_log_write(ANDROID_LOG_ERROR, tag_.c_str(), buffer);
-      }
-      else if (level == LOG_WARNING)
+      __android_log_write(ANDROID_LOG_ERROR, tag_.c_str(), buffer);
+    }
+    else if (level == LOG_WARNING)
+    {
+      __android_log_write(ANDROID_LOG_WARN, tag_.c_str(), buffer);
+    }
+    else
+    {
+      __android_log_write(ANDROID_LOG_INFO, tag_.c_str(), buffer);
+    }
+  }
+#else  // end if _USING_ANDROID_
+  if (this->term_added_ || this->syslog_added_)
+  {
+    fprintf(stderr, "%s", buffer);
+  }
+#endif
+
+  int file_num = 0;
+  for (FileVectors::iterator i = files_.begin(); i != files_.end(); ++i)
+  {
+    if (level >= LOG_DETAILED)
+    {
+      fprintf(stderr, "Logger::log: writing to file num %d", file_num);
+
+      // file_num is only important if logging is detailed
+      ++file_num;
+    }
+    fprintf(*i, "%s", buffer);
+  }
+}
+
+void madara::logger::Logger::push(
+    int level, const char* message, size_t length)
+{
+#ifndef MADARA_NO_THREAD_LOCAL
+  uint64_t id = async_id_.load(std::memory_order_acquire);
+  AsyncRing* ring = 0;
+
+  for (auto& entry : thread_rings_.rings)
+  {
+    if (entry.first == id)
+    {
+      ring = entry.second.get();
+      break;
+    }
+  }
+
+  if (!ring)
+  {
+    // forget rings of loggers that have stopped reading them
+    auto& rings = thread_rings_.rings;
+    rings.erase(std::remove_if(rings.begin(), rings.end(),
+                    [](const std::pair<uint64_t, std::shared_ptr<AsyncRing>>&
+                            entry) { return entry.second->retired.load(); }),
+        rings.end());
+
+    std::shared_ptr<AsyncRing> created(new AsyncRing(ring_size_));
+
+    {
+      std::lock_guard<std::mutex> guard(rings_mutex_);
+      rings_.push_back(created);
+    }
+
+    rings.emplace_back(id, created);
+    ring = created.get();
+  }
+
+  AsyncRing::Header header;
+  header.length = (uint32_t)length;
+  header.level = level;
+
+  uint64_t size = (sizeof(header) + length + 7) & ~(uint64_t)7;
+  uint64_t head = ring->head.load(std::memory_order_relaxed);
+  uint64_t used = head - ring->tail.load(std::memory_order_acquire);
+
+  if (used + size > ring->buffer.size())
+  {
+    ++dropped_;
+    return;
+  }
+
+  ring->copy_in(head, &header, sizeof(header));
+  ring->copy_in(head + sizeof(header), message, length);
+  ring->head.store(head + size, std::memory_order_release);
+
+  // the background thread would otherwise notice at its next wakeup
+  if ((used + size) * 2 > ring->buffer.size() &&
+      writer_idle_.load(std::memory_order_relaxed))
+  {
+    writer_wake_.notify_one();
+  }
+#else
+  (void)level;
+  (void)message;
+  (void)length;
+#endif
+}
+
+size_t madara::logger::Logger::drain(void)
+{
+  size_t written = 0;
+
+  {
+    std::lock_guard<std::mutex> guard(rings_mutex_);
+    draining_ = rings_;
+  }
+
+  bool closed = false;
+
+  {
+    MADARA_GUARD_TYPE guard(mutex_);
+
+    for (auto& ring : draining_)
+    {
+      // read the closed flag first, so nothing logged before it is missed
+      closed = closed || ring->closed.load(std::memory_order_acquire);
+
+      uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+      uint64_t head = ring->head.load(std::memory_order_acquire);
+
+      while (tail < head)
       {
-        __android_log_write(ANDROID_LOG_WARN, tag_.c_str(), buffer);
+        AsyncRing::Header header;
+        ring->copy_out(tail, &header, sizeof(header));
+
+        message_.resize(header.length + 1);
+        ring->copy_out(tail + sizeof(header), message_.data(), header.length);
+        message_[header.length] = 0;
+
+        write(header.level, message_.data());
+        ++written;
+
+        tail += (sizeof(header) + header.length + 7) & ~(uint64_t)7;
       }
-      else
+
+      ring->tail.store(tail, std::memory_order_release);
+    }
+  }
+
+  if (closed)
+  {
+    // the rings of threads that have exited are empty by now
+    std::lock_guard<std::mutex> guard(rings_mutex_);
+
+    for (auto& ring : draining_)
+    {
+      if (ring->closed.load(std::memory_order_relaxed) &&
+          ring->tail.load() == ring->head.load())
       {
-        __android_log_write(ANDROID_LOG_INFO, tag_.c_str(), buffer);
+        ring->retired = true;
+
+        auto found = std::find(rings_.begin(), rings_.end(), ring);
+        if (found != rings_.end())
+          rings_.erase(found);
       }
     }
-#else  // end if _USING_ANDROID_
-    if (this->term_added_ || this->syslog_added_)
+  }
+
+  draining_.clear();
+
+  return written;
+}
+
+void madara::logger::Logger::write_async(void)
+{
+#ifndef MADARA_NO_THREAD_LOCAL
+  set_thread_name("logger");
+#endif
+
+  while (!stopping_.load(std::memory_order_acquire))
+  {
+    if (drain() == 0)
     {
-      fprintf(stderr, "%s", buffer);
+      std::unique_lock<std::mutex> lock(writer_mutex_);
+
+      writer_idle_ = true;
+      writer_wake_.wait_for(lock, async_idle_wait);
+      writer_idle_ = false;
     }
+  }
+}
+
+void madara::logger::Logger::enable_async(size_t ring_size)
+{
+#ifndef MADARA_NO_THREAD_LOCAL
+  if (async_)
+    return;
+
+  ring_size_ = ring_size;
+  async_id_ = ++next_async_id;
+  stopping_ = false;
+
+  writer_ = std::thread(&Logger::write_async, this);
+
+  async_ = true;
+#else
+  (void)ring_size;
+
+  madara_logger_ptr_log(this, LOG_ERROR,
+      "Logger::enable_async: thread local storage is disabled, so logging "
+      "stays synchronous\n");
 #endif
+}
+
+void madara::logger::Logger::disable_async(void)
+{
+  if (!async_)
+    return;
+
+  // messages logged while we stop are dropped with their rings
+  async_ = false;
+
+  {
+    std::lock_guard<std::mutex> guard(writer_mutex_);
+    stopping_ = true;
+    writer_wake_.notify_one();
+  }
+
+  writer_.join();
+
+  drain();
+
+  std::lock_guard<std::mutex> guard(rings_mutex_);
+
+  for (auto& ring : rings_)
+  {
+    ring->retired = true;
+  }
+
+  rings_.clear();
+}
+
+void madara::logger::Logger::flush(void)
+{
+  if (async_)
+  {
+    std::vector<std::shared_ptr<AsyncRing>> rings;
 
-    int file_num = 0;
-    for (FileVectors::iterator i = files_.begin(); i != files_.end(); ++i)
     {
-      if (level >= LOG_DETAILED)
-      {
-        fprintf(stderr, "Logger::log: writing to file num %d", file_num);
+      std::lock_guard<std::mutex> guard(rings_mutex_);
+      rings = rings_;
+    }
 
-        // file_num is only important if logging is detailed
-        ++file_num;
+    // wait for the background thread to catch up with what is logged now
+    std::vector<uint64_t> heads;
+    for (auto& ring : rings)
+    {
+      heads.push_back(ring->head.load(std::memory_order_acquire));
+    }
+
+    for (size_t i = 0; i < rings.size(); ++i)
+    {
+      while (async_ && rings[i]->tail.load(std::memory_order_acquire) < heads[i])
+      {
+        writer_wake_.notify_one();
+        std::this_thread::yield();
       }
-      fprintf(*i, "%s", buffer);
     }
   }
+
+  MADARA_GUARD_TYPE guard(mutex_);
+
+  for (FileVectors::iterator i = files_.begin(); i != files_.end(); ++i)
+  {
+    fflush(*i);
+  }
 }
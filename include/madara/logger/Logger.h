@@ -6,6 +6,10 @@
 #include <vector>
 #include <atomic>
 #include <string>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <stdio.h>
 #include "madara/utility/IntTypes.h"
 
@@ -215,6 +219,41 @@ public:
    **/
   void set_timestamp_format(const std::string& format = "%x %X: ");
 
+  /**
+   * Moves writing to log outputs onto a background thread. Each thread
+   * that logs formats its messages into its own lock-free ring, which
+   * the background thread drains, so callers never wait on outputs or on
+   * each other. Messages that do not fit in their ring are dropped and
+   * counted. Messages from different threads may be written out of order.
+   * Requires thread local storage. Without it, logging stays synchronous.
+   * @param  ring_size  the bytes buffered for each thread that logs
+   **/
+  void enable_async(size_t ring_size = 256 * 1024);
+
+  /**
+   * Writes all buffered messages and goes back to writing them on the
+   * thread that logs them
+   **/
+  void disable_async(void);
+
+  /**
+   * Checks if messages are written by a background thread
+   * @return true if enable_async is in effect
+   **/
+  bool is_async(void) const;
+
+  /**
+   * Waits until messages logged before this call have been written, and
+   * flushes the log files
+   **/
+  void flush(void);
+
+  /**
+   * Gets the number of messages dropped because their ring was full
+   * @return  the number of dropped messages
+   **/
+  uint64_t get_dropped(void) const;
+
   /**
    * Fetches thread local storage value for thread level
    * @return the log level of the local thread
@@ -254,12 +293,45 @@ public:
 #endif
 
 private:
+  /// buffered messages from one thread, defined in Logger.cpp
+  struct AsyncRing;
+
+  /// the rings a thread logs to, defined in Logger.cpp
+  struct ThreadRings;
+
 #ifndef MADARA_NO_THREAD_LOCAL
   static thread_local int thread_level_;
   static thread_local std::string thread_name_;
   static thread_local double thread_hertz_;
+  static thread_local ThreadRings thread_rings_;
 #endif
 
+  /**
+   * Writes a message to all outputs. mutex_ must be held.
+   * @param  level    the logging level
+   * @param  message  the formatted message
+   **/
+  void write(int level, const char* message);
+
+  /**
+   * Buffers a message in the calling thread's ring
+   * @param  level    the logging level
+   * @param  message  the formatted message
+   * @param  length   the length of the message
+   **/
+  void push(int level, const char* message, size_t length);
+
+  /**
+   * Writes the buffered messages of every thread
+   * @return the number of messages written
+   **/
+  size_t drain(void);
+
+  /**
+   * The background thread that writes buffered messages
+   **/
+  void write_async(void);
+
   /**
    * Set thread local storage value for hertz
    * @param buf - message buffer that holds the proprietary key
@@ -317,6 +389,43 @@ private:
 
   /// key string cosntant for hertz value for local thread
   const char* MADARA_THREAD_HERTZ_ = "%MTZ";
+
+  /// true while messages are written by a background thread
+  std::atomic<bool> async_{false};
+
+  /// identifies the rings of this enable_async to logging threads
+  std::atomic<uint64_t> async_id_{0};
+
+  /// messages dropped because their ring was full
+  std::atomic<uint64_t> dropped_{0};
+
+  /// bytes buffered per thread
+  size_t ring_size_ = 0;
+
+  /// protects rings_
+  std::mutex rings_mutex_;
+
+  /// the rings of every thread that has logged since enable_async
+  std::vector<std::shared_ptr<AsyncRing>> rings_;
+
+  /// the rings being drained, reused by the background thread
+  std::vector<std::shared_ptr<AsyncRing>> draining_;
+
+  /// a message being written by the background thread
+  std::vector<char> message_;
+
+  /// the background thread
+  std::thread writer_;
+
+  /// tells the background thread to stop
+  std::atomic<bool> stopping_{false};
+
+  /// true while the background thread waits for messages
+  std::atomic<bool> writer_idle_{false};
+
+  /// lets a logging thread wake the background thread
+  std::mutex writer_mutex_;
+  std::condition_variable writer_wake_;
 };
 
 }  // end logger namespace
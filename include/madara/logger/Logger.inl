@@ -133,6 +133,16 @@ inline void madara::logger::Logger::clear(void)
   files_.clear();
 }
 
+inline bool madara::logger::Logger::is_async(void) const
+{
+  return async_;
+}
+
+inline uint64_t madara::logger::Logger::get_dropped(void) const
+{
+  return dropped_;
+}
+
 inline void madara::logger::Logger::set_timestamp_format(
     const std::string& format)
 {
@@ -28,6 +28,7 @@ void madara::threads::Threader::pause(const std::string name)
   if (found != threads_.end())
   {
     control_.set(name + ".paused", knowledge::KnowledgeRecord::Integer(1));
+    found->second->paused_ = true;
   }
 }
 
@@ -37,6 +38,7 @@ void madara::threads::Threader::pause(void)
        ++i)
   {
     control_.set(i->first + ".paused", knowledge::KnowledgeRecord::Integer(1));
+    i->second->paused_ = true;
   }
 }
 
@@ -47,6 +49,7 @@ void madara::threads::Threader::resume(const std::string name)
   if (found != threads_.end())
   {
     control_.set(name + ".paused", knowledge::KnowledgeRecord::Integer(0));
+    found->second->paused_ = false;
   }
 }
 
@@ -56,6 +59,7 @@ void madara::threads::Threader::resume(void)
        ++i)
   {
     control_.set(i->first + ".paused", knowledge::KnowledgeRecord::Integer(0));
+    i->second->paused_ = false;
   }
 }
 
@@ -68,12 +72,23 @@ void madara::threads::Threader::run(
         new WorkerThread(name, thread, control_, data_));
 
     if (paused)
+    {
       thread->paused = 1;
+      worker->paused_ = true;
+    }
 
     if (debug_)
+    {
       worker->debug_ = 1;
+      worker->debugging_ = true;
+    }
+
+    WorkerThread* started = (threads_[name] = std::move(worker)).get();
 
-    (threads_[name] = std::move(worker))->run();
+    if (pool_)
+      pool_->add(started);
+    else
+      started->run();
   }
   else if (thread != 0 && name == "")
   {
@@ -138,12 +153,23 @@ void madara::threads::Threader::run(
         new WorkerThread(name, thread, control_, data_, hertz));
 
     if (paused)
+    {
       thread->paused = 1;
+      worker->paused_ = true;
+    }
 
     if (debug_)
+    {
       worker->debug_ = 1;
+      worker->debugging_ = true;
+    }
 
-    (threads_[name] = std::move(worker))->run();
+    WorkerThread* started = (threads_[name] = std::move(worker)).get();
+
+    if (pool_)
+      pool_->add(started);
+    else
+      started->run();
   }
   else if (thread != 0 && name == "")
   {
@@ -178,6 +204,7 @@ void madara::threads::Threader::terminate(const std::string name)
   if (found != threads_.end())
   {
     control_.set(name + ".terminated", knowledge::KnowledgeRecord::Integer(1));
+    found->second->terminated_ = true;
   }
 }
 
@@ -188,7 +215,20 @@ void madara::threads::Threader::terminate(void)
   {
     control_.set(
         i->first + ".terminated", knowledge::KnowledgeRecord::Integer(1));
+    i->second->terminated_ = true;
+  }
+}
+
+void madara::threads::Threader::use_pool(size_t size)
+{
+  if (pool_)
+  {
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ERROR,
+        "Threader::use_pool: the pool has already been set.\n");
+    return;
   }
+
+  pool_.reset(new WorkerPool(size));
 }
 
 bool madara::threads::Threader::wait(
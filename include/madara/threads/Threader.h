@@ -18,6 +18,7 @@
 #include "madara/knowledge/KnowledgeBase.h"
 #include "BaseThread.h"
 #include "WorkerThread.h"
+#include "WorkerPool.h"
 #include "madara/MadaraExport.h"
 
 #ifdef _MADARA_JAVA_
@@ -196,6 +197,16 @@ public:
    **/
   void terminate(const std::string name);
 
+  /**
+   * Runs new threads on a fixed pool of OS threads instead of starting
+   * an OS thread for each. Pooled threads are run one iteration at a time
+   * and wait for their next hertz epoch without holding an OS thread, so
+   * their run methods should not block. Threads that are already running
+   * are not moved. The pool can only be set once.
+   * @param size    the number of pool threads. 0 uses one per core.
+   **/
+  void use_pool(size_t size = 0);
+
   /**
    * Requests all debugging for threads go into the data plane
    * KB instead of the control plane. This will impact performance
@@ -286,6 +297,12 @@ private:
    * go to the data plane at this prefix
    **/
   std::string debug_to_kb_prefix_;
+
+  /**
+   * if set, new threads run on this pool. It stops before the threads
+   * it runs are destroyed.
+   **/
+  std::unique_ptr<WorkerPool> pool_;
 };
 }
 }
@@ -16,16 +16,37 @@ inline void madara::threads::Threader::change_hertz(
     const std::string name, double hertz)
 {
   control_.set(name + ".hertz", hertz);
+
+  NamedWorkerThreads::iterator found = threads_.find(name);
+
+  if (found != threads_.end())
+  {
+    found->second->requested_hertz_ = hertz;
+  }
 }
 
 inline void madara::threads::Threader::enable_debug(const std::string name)
 {
   control_.set(name + ".debug", true);
+
+  NamedWorkerThreads::iterator found = threads_.find(name);
+
+  if (found != threads_.end())
+  {
+    found->second->debugging_ = true;
+  }
 }
 
 inline void madara::threads::Threader::disable_debug(const std::string name)
 {
   control_.set(name + ".debug", false);
+
+  NamedWorkerThreads::iterator found = threads_.find(name);
+
+  if (found != threads_.end())
+  {
+    found->second->debugging_ = false;
+  }
 }
 
 inline void madara::threads::Threader::debug_to_kb(const std::string prefix)
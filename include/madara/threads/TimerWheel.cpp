@@ -0,0 +1,100 @@
+#include "TimerWheel.h"
+
+namespace madara
+{
+namespace threads
+{
+TimerWheel::TimerWheel(utility::Duration tick, size_t slots)
+  : origin_(utility::get_time_value()),
+    tick_(tick),
+    slots_(slots > 0 ? slots : 1)
+{
+}
+
+uint64_t TimerWheel::to_tick(utility::TimeValue time) const
+{
+  if (time <= origin_)
+    return 0;
+
+  utility::Duration elapsed = time - origin_;
+
+  return (uint64_t)((elapsed.count() + tick_.count() - 1) / tick_.count());
+}
+
+void TimerWheel::schedule(WorkerThread* thread, utility::TimeValue due)
+{
+  uint64_t tick = to_tick(due);
+
+  if (tick < current_)
+    tick = current_;
+
+  slots_[tick % slots_.size()].push_back(Timer{thread, tick});
+  ++size_;
+}
+
+void TimerWheel::expire(
+    utility::TimeValue now, std::vector<WorkerThread*>& expired)
+{
+  if (now < origin_)
+    return;
+
+  // the last tick that has started
+  uint64_t last = (uint64_t)((now - origin_).count() / tick_.count());
+
+  if (last < current_)
+    return;
+
+  if (size_ == 0)
+  {
+    current_ = last + 1;
+    return;
+  }
+
+  // after a turn of the wheel, every slot has to be checked once
+  uint64_t first = current_;
+  if (last - first >= slots_.size())
+    first = last + 1 - slots_.size();
+
+  for (uint64_t tick = first; tick <= last && size_ > 0; ++tick)
+  {
+    std::vector<Timer>& slot = slots_[tick % slots_.size()];
+
+    size_t kept = 0;
+    for (size_t i = 0; i < slot.size(); ++i)
+    {
+      if (slot[i].tick <= last)
+      {
+        expired.push_back(slot[i].thread);
+        --size_;
+      }
+      else
+      {
+        slot[kept++] = slot[i];
+      }
+    }
+
+    slot.resize(kept);
+  }
+
+  current_ = last + 1;
+}
+
+utility::TimeValue TimerWheel::next_expiration(void) const
+{
+  uint64_t tick = current_;
+
+  for (size_t i = 0; i < slots_.size() && size_ > 0; ++i, ++tick)
+  {
+    if (!slots_[tick % slots_.size()].empty())
+      break;
+  }
+
+  return origin_ + tick_ * (int64_t)tick;
+}
+
+size_t TimerWheel::size(void) const
+{
+  return size_;
+}
+}
+}
@@ -0,0 +1,104 @@
+#ifndef _MADARA_THREADS_TIMER_WHEEL_H_
+#define _MADARA_THREADS_TIMER_WHEEL_H_
+
+/**
+ * @file TimerWheel.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the TimerWheel class, which schedules periodic
+ * threads for a WorkerPool
+ **/
+
+#include <vector>
+
+#include "madara/utility/Utility.h"
+
+namespace madara
+{
+namespace threads
+{
+class WorkerThread;
+
+/**
+ * @class TimerWheel
+ * @brief A hashed timer wheel. Timers land in the slot of the tick they
+ *        are due in, so scheduling and expiring are constant time no
+ *        matter how many threads are waiting. Timers further out than one
+ *        turn of the wheel wait in their slot for later turns. Timers
+ *        expire at the first tick at or after their due time. Not thread
+ *        safe.
+ **/
+class TimerWheel
+{
+public:
+  /**
+   * Constructor
+   * @param  tick    the resolution of the wheel
+   * @param  slots   the number of ticks in one turn of the wheel
+   **/
+  TimerWheel(utility::Duration tick = std::chrono::milliseconds(1),
+      size_t slots = 1024);
+
+  /**
+   * Schedules a thread
+   * @param  thread  the thread to schedule
+   * @param  due     when the thread should run. Times in the past expire
+   *                 on the next call to expire.
+   **/
+  void schedule(WorkerThread* thread, utility::TimeValue due);
+
+  /**
+   * Removes every timer that has expired
+   * @param  now      the current time
+   * @param  expired  the threads that were due are appended here
+   **/
+  void expire(utility::TimeValue now, std::vector<WorkerThread*>& expired);
+
+  /**
+   * Gets the time of the first tick that has timers. Timers in that tick
+   * may be for a later turn of the wheel, so this is a lower bound.
+   * @return the tick time, or the end of the current turn if no timer is
+   *         in it
+   **/
+  utility::TimeValue next_expiration(void) const;
+
+  /**
+   * Gets the number of scheduled timers
+   * @return the number of timers
+   **/
+  size_t size(void) const;
+
+private:
+  /// a scheduled thread
+  struct Timer
+  {
+    WorkerThread* thread;
+    uint64_t tick;
+  };
+
+  /**
+   * Converts a time to the tick it expires in
+   * @param  time   the time
+   * @return the first tick at or after the time
+   **/
+  uint64_t to_tick(utility::TimeValue time) const;
+
+  /// the start of tick 0
+  utility::TimeValue origin_;
+
+  /// the resolution of the wheel
+  utility::Duration tick_;
+
+  /// the next tick to expire
+  uint64_t current_ = 0;
+
+  /// timers, by their tick modulo the number of slots
+  std::vector<std::vector<Timer>> slots_;
+
+  /// the number of scheduled timers
+  size_t size_ = 0;
+};
+}
+}
+
+#endif  // _MADARA_THREADS_TIMER_WHEEL_H_
@@ -0,0 +1,219 @@
+#include "WorkerPool.h"
+#include "WorkerThread.h"
+#include "madara/logger/GlobalLogger.h"
+
+#ifdef _MADARA_JAVA_
+#include "madara/utility/java/Acquire_VM.h"
+#endif
+
+#include <sstream>
+
+namespace madara
+{
+namespace threads
+{
+WorkerPool::WorkerPool(size_t size)
+{
+  if (size == 0)
+    size = std::thread::hardware_concurrency();
+  if (size == 0)
+    size = 1;
+
+  for (size_t i = 0; i < size; ++i)
+  {
+    queues_.emplace_back(new Queue());
+  }
+
+  wake_time_ = utility::TimeValue::max();
+
+  for (size_t i = 0; i < size; ++i)
+  {
+    workers_.emplace_back(&WorkerPool::work, this, i);
+  }
+
+  timer_ = std::thread(&WorkerPool::time, this);
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+      "WorkerPool::WorkerPool:"
+      " started %d pool threads\n",
+      (int)size);
+}
+
+WorkerPool::~WorkerPool()
+{
+  stopping_ = true;
+
+  {
+    std::lock_guard<std::mutex> guard(idle_mutex_);
+    work_ready_.notify_all();
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(timer_mutex_);
+    timer_changed_.notify_all();
+  }
+
+  for (std::thread& worker : workers_)
+  {
+    worker.join();
+  }
+
+  timer_.join();
+}
+
+void WorkerPool::add(WorkerThread* thread)
+{
+  std::lock_guard<std::mutex> guard(timer_mutex_);
+
+  push(thread, next_queue_);
+  next_queue_ = (next_queue_ + 1) % queues_.size();
+}
+
+size_t WorkerPool::size(void) const
+{
+  return workers_.size();
+}
+
+void WorkerPool::push(WorkerThread* thread, size_t id)
+{
+  {
+    std::lock_guard<std::mutex> guard(queues_[id]->mutex);
+    queues_[id]->threads.push_back(thread);
+  }
+
+  ++ready_;
+
+  // an idle pool thread either sees ready_ before it waits, or is waiting
+  // by the time we get the lock
+  if (idle_ > 0)
+  {
+    std::lock_guard<std::mutex> guard(idle_mutex_);
+    work_ready_.notify_one();
+  }
+}
+
+WorkerThread* WorkerPool::pop(size_t id)
+{
+  // our own queue is first in, first out, so every ready thread gets a turn
+  {
+    Queue& queue = *queues_[id];
+    std::lock_guard<std::mutex> guard(queue.mutex);
+
+    if (!queue.threads.empty())
+    {
+      WorkerThread* thread = queue.threads.front();
+      queue.threads.pop_front();
+      --ready_;
+      return thread;
+    }
+  }
+
+  // steal the most recently queued thread of another pool thread
+  for (size_t i = 1; i < queues_.size(); ++i)
+  {
+    Queue& queue = *queues_[(id + i) % queues_.size()];
+    std::lock_guard<std::mutex> guard(queue.mutex);
+
+    if (!queue.threads.empty())
+    {
+      WorkerThread* thread = queue.threads.back();
+      queue.threads.pop_back();
+      --ready_;
+      return thread;
+    }
+  }
+
+  return nullptr;
+}
+
+void WorkerPool::schedule(WorkerThread* thread, utility::TimeValue due)
+{
+  std::lock_guard<std::mutex> guard(timer_mutex_);
+
+  wheel_.schedule(thread, due);
+
+  // only wake the timer thread if it would sleep past this timer
+  if (due < wake_time_)
+  {
+    wake_time_ = due;
+    timer_changed_.notify_one();
+  }
+}
+
+void WorkerPool::work(size_t id)
+{
+#ifdef _MADARA_JAVA_
+  // Java threads need the pool thread attached to the VM
+  utility::java::Acquire_VM jvm(false);
+#endif
+
+#ifndef MADARA_NO_THREAD_LOCAL
+  std::stringstream name;
+  name << "pool" << id;
+  madara::logger::Logger::set_thread_name(name.str());
+#endif
+
+  while (!stopping_)
+  {
+    WorkerThread* thread = pop(id);
+
+    if (!thread)
+    {
+      std::unique_lock<std::mutex> lock(idle_mutex_);
+
+      ++idle_;
+      work_ready_.wait(lock, [this]() { return ready_ > 0 || stopping_; });
+      --idle_;
+
+      continue;
+    }
+
+    utility::TimeValue next;
+
+    // a finished thread may already be deleted, so we forget it
+    if (thread->step(next))
+    {
+      if (next <= thread->current_)
+      {
+        push(thread, id);
+      }
+      else
+      {
+        schedule(thread, next);
+      }
+    }
+  }
+}
+
+void WorkerPool::time(void)
+{
+  std::vector<WorkerThread*> expired;
+
+  std::unique_lock<std::mutex> lock(timer_mutex_);
+
+  while (!stopping_)
+  {
+    wheel_.expire(utility::get_time_value(), expired);
+
+    for (WorkerThread* thread : expired)
+    {
+      push(thread, next_queue_);
+      next_queue_ = (next_queue_ + 1) % queues_.size();
+    }
+
+    expired.clear();
+
+    if (wheel_.size() > 0)
+    {
+      wake_time_ = wheel_.next_expiration();
+      timer_changed_.wait_until(lock, wake_time_);
+    }
+    else
+    {
+      wake_time_ = utility::TimeValue::max();
+      timer_changed_.wait(lock);
+    }
+  }
+}
+}
+}
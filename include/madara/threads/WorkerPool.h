@@ -0,0 +1,151 @@
+#ifndef _MADARA_THREADS_WORKER_POOL_H_
+#define _MADARA_THREADS_WORKER_POOL_H_
+
+/**
+ * @file WorkerPool.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the WorkerPool class, which runs many threads on a
+ * fixed number of OS threads
+ **/
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include "madara/threads/TimerWheel.h"
+
+namespace madara
+{
+namespace threads
+{
+class WorkerThread;
+
+/**
+ * @class WorkerPool
+ * @brief Runs WorkerThreads one iteration at a time on a fixed number of
+ *        OS threads. Each pool thread has a deque of threads that are
+ *        ready to run, and takes work from the other deques when its own
+ *        is empty. Threads that run at a hertz rate wait on a TimerWheel
+ *        until their next epoch. A user thread's run should not block,
+ *        since it holds up a pool thread while it does.
+ **/
+class WorkerPool
+{
+public:
+  /**
+   * Constructor
+   * @param  size   the number of OS threads. 0 uses one per core.
+   **/
+  WorkerPool(size_t size);
+
+  /**
+   * Destructor. Stops the pool threads. Threads that have not finished
+   * are not run again.
+   **/
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  /**
+   * Starts running a thread. The thread must stay alive until it sets its
+   * finished flag.
+   * @param  thread   the thread to run
+   **/
+  void add(WorkerThread* thread);
+
+  /**
+   * Gets the number of OS threads
+   * @return the number of pool threads
+   **/
+  size_t size(void) const;
+
+private:
+  /// threads that are ready to run on one pool thread
+  struct Queue
+  {
+    std::mutex mutex;
+    std::deque<WorkerThread*> threads;
+  };
+
+  /**
+   * The loop of a pool thread
+   * @param  id   the index of the pool thread and its queue
+   **/
+  void work(size_t id);
+
+  /**
+   * The loop of the timer thread, which moves threads whose epoch has
+   * arrived onto the queues
+   **/
+  void time(void);
+
+  /**
+   * Queues a thread that is ready to run
+   * @param  thread   the thread
+   * @param  id       the queue to use
+   **/
+  void push(WorkerThread* thread, size_t id);
+
+  /**
+   * Takes a thread from our own queue, or steals one from another
+   * @param  id   the queue of the calling pool thread
+   * @return a thread, or nullptr if none are ready
+   **/
+  WorkerThread* pop(size_t id);
+
+  /**
+   * Schedules a thread to run at a later time
+   * @param  thread   the thread
+   * @param  due      when it should run
+   **/
+  void schedule(WorkerThread* thread, utility::TimeValue due);
+
+  /// one queue per pool thread
+  std::vector<std::unique_ptr<Queue>> queues_;
+
+  /// the pool threads
+  std::vector<std::thread> workers_;
+
+  /// the timer thread
+  std::thread timer_;
+
+  /// threads that are ready to run, over all queues
+  std::atomic<size_t> ready_{0};
+
+  /// pool threads waiting for work
+  std::atomic<size_t> idle_{0};
+
+  /// set when the pool is stopping
+  std::atomic<bool> stopping_{false};
+
+  /// the queue for the next thread from the timer
+  size_t next_queue_ = 0;
+
+  /// protects idle pool threads from missing work
+  std::mutex idle_mutex_;
+
+  /// signaled when work is queued and a pool thread is idle
+  std::condition_variable work_ready_;
+
+  /// protects the timer wheel
+  std::mutex timer_mutex_;
+
+  /// signaled when a timer is due before the timer thread would wake
+  std::condition_variable timer_changed_;
+
+  /// threads waiting for their next epoch
+  TimerWheel wheel_;
+
+  /// when the timer thread will next wake
+  utility::TimeValue wake_time_;
+};
+}
+}
+
+#endif  // _MADARA_THREADS_WORKER_POOL_H_
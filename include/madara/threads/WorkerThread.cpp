@@ -19,6 +19,17 @@ namespace madara
 {
 namespace threads
 {
+/// how often flags written directly to the control plane are picked up
+static const utility::Duration control_sync_period =
+    std::chrono::milliseconds(10);
+
+/// iterations between clock checks for threads running at infinite hertz
+static const uint64_t blaster_clock_checks = 64;
+
+/// how often a paused thread at infinite hertz is checked on a WorkerPool
+static const utility::Duration pool_pause_period =
+    std::chrono::milliseconds(1);
+
 WorkerThread::WorkerThread(const std::string& name, BaseThread* thread,
     knowledge::KnowledgeBase control, knowledge::KnowledgeBase data,
     double hertz)
@@ -59,9 +70,14 @@ WorkerThread::WorkerThread(const std::string& name, BaseThread* thread,
 
     debug_.set_name(base_string.str() + ".debug", control);
 
+    terminated_ref_ = control_.get_ref(name + ".terminated");
+    paused_ref_ = control_.get_ref(name + ".paused");
+
     finished_ = 0;
     started_ = 0;
     new_hertz_ = hertz_;
+    requested_hertz_ = hertz_;
+    control_hertz_ = hertz_;
   }
 }
 
@@ -146,6 +162,217 @@ void WorkerThread::run(void)
   }
 }
 
+void WorkerThread::sync_control_plane(void)
+{
+  knowledge::ContextGuard guard(control_);
+
+  // only values that changed since the last sync were written directly to
+  // the control plane. The Threader mirrors its requests here before
+  // setting our flags, so an unchanged value never undoes a request.
+  knowledge::KnowledgeRecord::Integer value =
+      control_.get(terminated_ref_).to_integer();
+  if (value != control_terminated_)
+  {
+    control_terminated_ = value;
+    if (value != 0)
+      terminated_.store(true, std::memory_order_release);
+  }
+
+  value = control_.get(paused_ref_).to_integer();
+  if (value != control_paused_)
+  {
+    control_paused_ = value;
+    paused_.store(value != 0, std::memory_order_release);
+  }
+
+  value = *debug_;
+  if (value != control_debug_)
+  {
+    control_debug_ = value;
+    debugging_.store(value != 0, std::memory_order_relaxed);
+  }
+
+  double hertz = *new_hertz_;
+  if (hertz != control_hertz_)
+  {
+    control_hertz_ = hertz;
+    requested_hertz_.store(hertz, std::memory_order_relaxed);
+  }
+
+  if (executions_pending_ > 0)
+  {
+    executions_ += executions_pending_;
+    executions_pending_ = 0;
+
+    last_start_time_ = last_start_time_pending_;
+    end_time_ = end_time_pending_;
+    last_duration_ = last_duration_pending_;
+    min_duration_ = min_duration_pending_;
+    max_duration_ = max_duration_pending_;
+  }
+}
+
+void WorkerThread::start(void)
+{
+  started_ = 1;
+
+  thread_->init(data_);
+
+  current_ = utility::get_time_value();
+
+  // pick up flags set before we started, e.g., a paused launch
+  sync_control_plane();
+
+  // change thread frequency
+  change_frequency(
+      hertz_, current_, frequency_, next_epoch_, one_shot_, blaster_);
+
+  if (debugging_)
+  {
+    start_time_ = utility::get_time();
+  }
+}
+
+void WorkerThread::execute(void)
+{
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+      "WorkerThread(%s)::svc:"
+      " thread checking for pause\n",
+      name_.c_str());
+
+  if (paused_.load(std::memory_order_acquire))
+    return;
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+      "WorkerThread(%s)::svc:"
+      " thread calling run function\n",
+      name_.c_str());
+
+  try
+  {
+    int64_t start_time = 0, end_time = 0;
+    bool debug = debugging_.load(std::memory_order_relaxed);
+
+    if (debug)
+    {
+      start_time = utility::get_time();
+    }
+
+    thread_->run();
+
+    if (debug)
+    {
+      end_time = utility::get_time();
+
+      // durations are mirrored into the control plane on sync
+      ++executions_pending_;
+      last_start_time_pending_ = start_time;
+      end_time_pending_ = end_time;
+      last_duration_pending_ = end_time - start_time;
+
+      if (min_duration_pending_ == -1 ||
+          last_duration_pending_ < min_duration_pending_)
+      {
+        min_duration_pending_ = last_duration_pending_;
+      }
+      if (last_duration_pending_ > max_duration_pending_)
+      {
+        max_duration_pending_ = last_duration_pending_;
+      }
+    }  // end if debug
+  }    // end try of the run
+  catch (const std::exception& e)
+  {
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_EMERGENCY,
+        "WorkerThread(%s)::svc:"
+        " exception thrown: %s\n",
+        name_.c_str(), e.what());
+  }
+}
+
+void WorkerThread::check_hertz(void)
+{
+  double requested_hertz = requested_hertz_.load(std::memory_order_relaxed);
+  if (requested_hertz != hertz_)
+  {
+    change_frequency(requested_hertz, current_, frequency_, next_epoch_,
+        one_shot_, blaster_);
+  }
+}
+
+void WorkerThread::finish(void)
+{
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+      "WorkerThread(%s)::svc:"
+      " calling thread cleanup method\n",
+      name_.c_str());
+
+  thread_->cleanup();
+
+  // mirror the final debug statistics
+  sync_control_plane();
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+      "WorkerThread(%s)::svc:"
+      " setting finished to 1\n",
+      finished_.get_name().c_str());
+
+  // the Threader may delete us as soon as this is set
+  finished_ = 1;
+}
+
+bool WorkerThread::step(utility::TimeValue& next)
+{
+  if (!initialized_)
+  {
+    initialized_ = true;
+    start();
+  }
+  else
+  {
+    current_ = utility::get_time_value();
+
+    if (current_ >= next_sync_)
+    {
+      sync_control_plane();
+      next_sync_ = current_ + control_sync_period;
+    }
+  }
+
+  if (terminated_.load(std::memory_order_acquire))
+  {
+    finish();
+    return false;
+  }
+
+  execute();
+
+  if (one_shot_)
+  {
+    finish();
+    return false;
+  }
+
+  check_hertz();
+
+  if (!blaster_)
+  {
+    next = next_epoch_;
+    next_epoch_ += frequency_;
+  }
+  else if (paused_.load(std::memory_order_relaxed))
+  {
+    // a paused blaster would otherwise keep its pool worker busy
+    next = current_ + pool_pause_period;
+  }
+  else
+  {
+    next = current_;
+  }
+
+  return true;
+}
+
 int WorkerThread::svc(void)
 {
   madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
@@ -155,8 +382,6 @@ int WorkerThread::svc(void)
 
   if (thread_)
   {
-    started_ = 1;
-
 #ifdef _MADARA_JAVA_
     // try detaching one more time, just to make sure.
     utility::java::Acquire_VM jvm(false);
@@ -166,171 +391,61 @@ int WorkerThread::svc(void)
     madara::logger::Logger::set_thread_name(name_);
 #endif
 
-    thread_->init(data_);
-
-    {
-      utility::TimeValue current = utility::get_time_value();
-      utility::TimeValue next_epoch;
-      utility::Duration frequency;
-
-      // only allow one-way communication of durations. We never read control
-      int64_t min_duration = -1;
-      int64_t max_duration = 0;
-      int64_t last_duration = 0;
-      bool max_duration_changed = true;
-      bool min_duration_changed = true;
+    start();
 
-      bool one_shot = true;
-      bool blaster = false;
+    uint64_t iterations = 0;
 
-      bool debug = debug_.is_true();
-
-      knowledge::VariableReference terminated;
-      knowledge::VariableReference paused;
+    while (!terminated_.load(std::memory_order_acquire))
+    {
+      execute();
 
-      terminated = control_.get_ref(name_ + ".terminated");
-      paused = control_.get_ref(name_ + ".paused");
+      if (one_shot_)
+        break;
 
-      // change thread frequency
-      change_frequency(
-          hertz_, current, frequency, next_epoch, one_shot, blaster);
-#ifndef MADARA_NO_THREAD_LOCAL
-      madara::logger::Logger::set_thread_hertz(hertz_);
-#endif
+      check_hertz();
 
-      if (debug)
+      if (!blaster_)
       {
-        start_time_ = utility::get_time();
-      }
+        current_ = utility::get_time_value();
 
-      while (control_.get(terminated).is_false())
-      {
         madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
             "WorkerThread(%s)::svc:"
-            " thread checking for pause\n",
+            " thread checking for next hertz epoch\n",
             name_.c_str());
 
-        if (control_.get(paused).is_false())
-        {
-          madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
-              "WorkerThread(%s)::svc:"
-              " thread calling run function\n",
-              name_.c_str());
-
-          try
-          {
-            int64_t start_time = 0, end_time = 0;
-            debug = debug_.is_true();
-
-            if (debug)
-            {
-              start_time = utility::get_time();
-              ++executions_;
-            }
-
-            thread_->run();
-
-            if (debug)
-            {
-              end_time = utility::get_time();
-
-              // update duration information
-              last_duration = end_time - start_time;
-              if (min_duration == -1 || last_duration < min_duration)
-              {
-                min_duration = last_duration;
-                min_duration_changed = true;
-              }
-              if (last_duration > max_duration)
-              {
-                max_duration = last_duration;
-                max_duration_changed = true;
-              }
-
-              // lock control plane and update
-              {
-                // write updates to control
-                knowledge::ContextGuard guard(control_);
-                last_start_time_ = start_time;
-                end_time_ = end_time;
-
-                last_duration_ = last_duration;
-                if (max_duration_changed)
-                {
-                  max_duration_ = max_duration;
-                }
-                if (min_duration_changed)
-                {
-                  min_duration_ = min_duration;
-                }
-              }  // end lock of control plane
-            }    // end if debug
-          }      // end try of the run
-          catch (const std::exception& e)
-          {
-            madara_logger_ptr_log(logger::global_logger.get(),
-                logger::LOG_EMERGENCY,
-                "WorkerThread(%s)::svc:"
-                " exception thrown: %s\n",
-                name_.c_str(), e.what());
-          }
-        }
-
-        if (one_shot)
-          break;
-
-        // check for a change in frequency/hertz
-        if (new_hertz_ != hertz_)
-        {
-          change_frequency(
-              *new_hertz_, current, frequency, next_epoch, one_shot, blaster);
-        }
-
-        if (!blaster)
-        {
-          current = utility::get_time_value();
-
-          madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
-              "WorkerThread(%s)::svc:"
-              " thread checking for next hertz epoch\n",
-              name_.c_str());
-
-          if (current < next_epoch)
-            utility::sleep(next_epoch - current);
-
-          madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
-              "WorkerThread(%s)::svc:"
-              " thread past epoch\n",
-              name_.c_str());
-
-          next_epoch += frequency;
-        }
-      }  // end while !terminated
-
-      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
-          "WorkerThread(%s)::svc:"
-          " thread has been terminated\n",
-          name_.c_str());
-    }
+        if (current_ < next_epoch_)
+          utility::sleep(next_epoch_ - current_);
 
-    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
-        "WorkerThread(%s)::svc:"
-        " calling thread cleanup method\n",
-        name_.c_str());
+        madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+            "WorkerThread(%s)::svc:"
+            " thread past epoch\n",
+            name_.c_str());
 
-    thread_->cleanup();
+        next_epoch_ += frequency_;
+      }
+      else if (++iterations % blaster_clock_checks != 0)
+      {
+        // blasters only look at the clock every few iterations
+        continue;
+      }
+      else
+      {
+        current_ = utility::get_time_value();
+      }
 
-    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
-        "WorkerThread(%s)::svc:"
-        " deleting thread\n",
-        name_.c_str());
+      if (current_ >= next_sync_)
+      {
+        sync_control_plane();
+        next_sync_ = current_ + control_sync_period;
+      }
+    }  // end while !terminated
 
     madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
         "WorkerThread(%s)::svc:"
-        " setting finished to 1\n",
-        finished_.get_name().c_str());
+        " thread has been terminated\n",
+        name_.c_str());
 
-    finished_ = 1;
+    finish();
   }
   else
   {
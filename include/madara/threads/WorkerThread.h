@@ -24,6 +24,7 @@ namespace madara
 namespace threads
 {
 class Threader;
+class WorkerPool;
 
 /**
  * @class WorkerThread
@@ -35,6 +36,9 @@ public:
   /// give access to our status flags to the Threader class
   friend class Threader;
 
+  /// lets a WorkerPool run us one iteration at a time
+  friend class WorkerPool;
+
   /**
    * Default constructor
    **/
@@ -72,7 +76,8 @@ public:
       knowledge::KnowledgeBase control, knowledge::KnowledgeBase data,
       double hertz = -1.0);
 
-  WorkerThread(WorkerThread&& other) = default;
+  /// the running thread refers to this instance, so it cannot move
+  WorkerThread(WorkerThread&& other) = delete;
   /**
    * Destructor
    **/
@@ -97,6 +102,35 @@ protected:
    **/
   void run(void);
 
+  /**
+   * Runs one iteration on a WorkerPool, initializing the thread first if
+   * needed and cleaning it up once it is done
+   * @param  next   set to when the next iteration is due
+   * @return false if the thread has finished, true otherwise
+   **/
+  bool step(utility::TimeValue& next);
+
+  /**
+   * Initializes the user thread and the schedule for its hertz rate
+   **/
+  void start(void);
+
+  /**
+   * Calls the user thread's run, unless paused, and records debug
+   * statistics
+   **/
+  void execute(void);
+
+  /**
+   * Applies a hertz rate requested through change_hertz
+   **/
+  void check_hertz(void);
+
+  /**
+   * Cleans up the user thread and marks it finished
+   **/
+  void finish(void);
+
   /**
    * Changes the frequency given a hertz rate
    * @param  hertz      the new hertz rate
@@ -111,6 +145,14 @@ protected:
       utility::Duration& frequency, utility::TimeValue& next_epoch,
       bool& one_shot, bool& blaster);
 
+  /**
+   * Picks up flags written directly to the control plane (e.g., through
+   * BaseThread::terminated) since the last read, and mirrors debug
+   * statistics into it. This is the only place the control plane is
+   * locked once the thread is running.
+   **/
+  void sync_control_plane(void);
+
   /// the name of the contained thread
   std::string name_;
 
@@ -185,6 +227,42 @@ protected:
    * hertz rate for worker thread executions
    **/
   double hertz_ = -1;
+
+  /**
+   * Requests from the Threader, which are checked on every iteration
+   * without locking. Each is mirrored into the control plane.
+   **/
+  std::atomic<bool> terminated_{false};
+  std::atomic<bool> paused_{false};
+  std::atomic<bool> debugging_{false};
+  std::atomic<double> requested_hertz_{-1};
+
+  /// control plane flags, as of the last sync_control_plane
+  knowledge::VariableReference terminated_ref_;
+  knowledge::VariableReference paused_ref_;
+  knowledge::KnowledgeRecord::Integer control_terminated_ = 0;
+  knowledge::KnowledgeRecord::Integer control_paused_ = 0;
+  knowledge::KnowledgeRecord::Integer control_debug_ = 0;
+  double control_hertz_ = -1;
+
+  /// schedule of executions, kept between iterations
+  utility::TimeValue current_;
+  utility::TimeValue next_epoch_;
+  utility::TimeValue next_sync_;
+  utility::Duration frequency_;
+  bool one_shot_ = true;
+  bool blaster_ = false;
+
+  /// true once a WorkerPool has called start
+  bool initialized_ = false;
+
+  /// debug statistics not yet mirrored into the control plane
+  knowledge::KnowledgeRecord::Integer executions_pending_ = 0;
+  int64_t last_start_time_pending_ = 0;
+  int64_t end_time_pending_ = 0;
+  int64_t last_duration_pending_ = 0;
+  int64_t min_duration_pending_ = -1;
+  int64_t max_duration_pending_ = 0;
 };
 
 /**
@@ -30,6 +30,7 @@ inline void WorkerThread::change_frequency(double hertz,
         name_.c_str(), hertz_);
 
     one_shot = false;
+    blaster = false;
 
     frequency = utility::seconds_to_duration(1.0 / hertz_);
 
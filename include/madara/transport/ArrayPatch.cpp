@@ -0,0 +1,347 @@
+#include <sstream>
+#include <string.h>
+
+#include "ArrayPatch.h"
+#include "madara/exceptions/MemoryException.h"
+#include "madara/utility/Utility.h"
+
+namespace madara
+{
+namespace transport
+{
+namespace
+{
+/// the bytes before the ranges of a body
+const int64_t BODY_HEADER_SIZE =
+    sizeof(uint32_t) * 2 + sizeof(uint64_t) + sizeof(uint32_t);
+
+/// the bytes before the body
+const int64_t HEADER_SIZE = sizeof(uint32_t) * 2 + sizeof(uint64_t);
+
+inline char* write_uint32(char* buffer, uint32_t value)
+{
+  value = utility::endian_swap(value);
+  memcpy(buffer, &value, sizeof(value));
+  return buffer + sizeof(value);
+}
+
+inline char* write_uint64(char* buffer, uint64_t value)
+{
+  value = utility::endian_swap(value);
+  memcpy(buffer, &value, sizeof(value));
+  return buffer + sizeof(value);
+}
+
+inline const char* read_uint32(const char* buffer, uint32_t& value)
+{
+  memcpy(&value, buffer, sizeof(value));
+  value = utility::endian_swap(value);
+  return buffer + sizeof(value);
+}
+
+inline const char* read_uint64(const char* buffer, uint64_t& value)
+{
+  memcpy(&value, buffer, sizeof(value));
+  value = utility::endian_swap(value);
+  return buffer + sizeof(value);
+}
+
+void throw_too_large(const char* method, int64_t size, int64_t remaining)
+{
+  std::stringstream buffer;
+  buffer << "ArrayPatch::" << method << ": ";
+  buffer << size << " byte patch cannot fit in ";
+  buffer << remaining << " byte buffer\n";
+
+  throw exceptions::MemoryException(buffer.str());
+}
+}
+
+int64_t ArrayPatch::encoded_size(const knowledge::IndexRanges& ranges)
+{
+  int64_t size = HEADER_SIZE + BODY_HEADER_SIZE;
+
+  for (auto& range : ranges)
+  {
+    size += sizeof(uint32_t) * 2 +
+            sizeof(uint64_t) * (range.second - range.first);
+  }
+
+  return size;
+}
+
+char* ArrayPatch::write(char* buffer, const std::string& key,
+    const knowledge::KnowledgeRecord& record, uint64_t base_toi,
+    const knowledge::IndexRanges& ranges, int64_t& buffer_remaining)
+{
+  uint32_t key_size = (uint32_t)key.size() + 1;
+  int64_t size = sizeof(key_size) + key_size + encoded_size(ranges);
+
+  if (buffer_remaining < size)
+  {
+    throw_too_large("write", size, buffer_remaining);
+  }
+
+  buffer = write_uint32(buffer, key_size);
+  memcpy(buffer, key.c_str(), key_size);
+  buffer += key_size;
+  buffer_remaining -= sizeof(key_size) + key_size;
+
+  return write_body(buffer, record, base_toi, ranges, buffer_remaining);
+}
+
+char* ArrayPatch::write(char* buffer, uint32_t key_id,
+    const knowledge::KnowledgeRecord& record, uint64_t base_toi,
+    const knowledge::IndexRanges& ranges, int64_t& buffer_remaining)
+{
+  int64_t size = sizeof(key_id) + encoded_size(ranges);
+
+  if (buffer_remaining < size)
+  {
+    throw_too_large("write", size, buffer_remaining);
+  }
+
+  buffer = write_uint32(buffer, key_id);
+  buffer_remaining -= sizeof(key_id);
+
+  return write_body(buffer, record, base_toi, ranges, buffer_remaining);
+}
+
+char* ArrayPatch::write_body(char* buffer,
+    const knowledge::KnowledgeRecord& record, uint64_t base_toi,
+    const knowledge::IndexRanges& ranges, int64_t& buffer_remaining)
+{
+  // callers have checked that the patch fits
+  int64_t size = encoded_size(ranges);
+
+  buffer = write_uint32(buffer, TYPE);
+  buffer = write_uint32(buffer, (uint32_t)(size - HEADER_SIZE));
+  buffer = write_uint64(buffer, record.toi());
+
+  buffer = write_uint32(buffer, record.type());
+  buffer = write_uint32(buffer, (uint32_t)record.size());
+  buffer = write_uint64(buffer, base_toi);
+  buffer = write_uint32(buffer, (uint32_t)ranges.size());
+
+  // the values are shared with the record, not copied
+  const void* values;
+  if (record.type() == knowledge::KnowledgeRecord::INTEGER_ARRAY)
+  {
+    values = record.share_integers()->data();
+  }
+  else
+  {
+    values = record.share_doubles()->data();
+  }
+
+  for (auto& range : ranges)
+  {
+    uint32_t count = (uint32_t)(range.second - range.first);
+
+    buffer = write_uint32(buffer, (uint32_t)range.first);
+    buffer = write_uint32(buffer, count);
+
+    utility::endian_swap_array(
+        buffer, (const uint64_t*)values + range.first, count);
+    buffer += sizeof(uint64_t) * count;
+  }
+
+  buffer_remaining -= size;
+
+  return buffer;
+}
+
+bool ArrayPatch::is_patch(
+    const char* buffer, bool keyed, int64_t buffer_remaining)
+{
+  int64_t offset = sizeof(uint32_t);
+
+  if (!keyed)
+  {
+    uint32_t key_size;
+
+    if (buffer_remaining < offset)
+    {
+      return false;
+    }
+
+    read_uint32(buffer, key_size);
+    offset += key_size;
+  }
+
+  uint32_t type;
+
+  if (buffer_remaining < offset + (int64_t)sizeof(type))
+  {
+    return false;
+  }
+
+  read_uint32(buffer + offset, type);
+
+  return type == TYPE;
+}
+
+const char* ArrayPatch::read(
+    const char* buffer, std::string& key, int64_t& buffer_remaining)
+{
+  uint32_t key_size = 0;
+
+  if (buffer_remaining >= (int64_t)sizeof(key_size))
+  {
+    buffer = read_uint32(buffer, key_size);
+  }
+  buffer_remaining -= sizeof(key_size);
+
+  if (buffer_remaining < (int64_t)key_size || key_size == 0)
+  {
+    buffer_remaining = -1;
+    return buffer;
+  }
+
+  key.assign(buffer, key_size - 1);
+  buffer += key_size;
+  buffer_remaining -= key_size;
+
+  return read_body(buffer, buffer_remaining);
+}
+
+const char* ArrayPatch::read(
+    const char* buffer, uint32_t& key_id, int64_t& buffer_remaining)
+{
+  if (buffer_remaining < (int64_t)sizeof(key_id))
+  {
+    buffer_remaining = -1;
+    return buffer;
+  }
+
+  buffer = read_uint32(buffer, key_id);
+  buffer_remaining -= sizeof(key_id);
+
+  return read_body(buffer, buffer_remaining);
+}
+
+const char* ArrayPatch::read_body(
+    const char* buffer, int64_t& buffer_remaining)
+{
+  uint32_t patch_type, body_size, num_ranges;
+
+  ranges.clear();
+  values_.clear();
+
+  if (buffer_remaining < HEADER_SIZE + BODY_HEADER_SIZE)
+  {
+    buffer_remaining = -1;
+    return buffer;
+  }
+
+  buffer = read_uint32(buffer, patch_type);
+  buffer = read_uint32(buffer, body_size);
+  buffer = read_uint64(buffer, toi);
+  buffer_remaining -= HEADER_SIZE;
+
+  if (patch_type != TYPE || body_size < BODY_HEADER_SIZE ||
+      buffer_remaining < (int64_t)body_size)
+  {
+    buffer_remaining = -1;
+    return buffer;
+  }
+
+  const char* end = buffer + body_size;
+
+  buffer = read_uint32(buffer, type);
+  buffer = read_uint32(buffer, length);
+  buffer = read_uint64(buffer, base_toi);
+  buffer = read_uint32(buffer, num_ranges);
+
+  if (type != knowledge::KnowledgeRecord::INTEGER_ARRAY &&
+      type != knowledge::KnowledgeRecord::DOUBLE_ARRAY)
+  {
+    buffer_remaining = -1;
+    return buffer;
+  }
+
+  // each range is checked against the body and the array, so a
+  // malformed patch cannot write outside of either
+  size_t next = 0;
+  for (uint32_t i = 0; i < num_ranges; ++i)
+  {
+    uint32_t first, count;
+
+    if (end - buffer < (int64_t)sizeof(uint32_t) * 2)
+    {
+      buffer_remaining = -1;
+      return buffer;
+    }
+
+    buffer = read_uint32(buffer, first);
+    buffer = read_uint32(buffer, count);
+
+    if (first < next || (uint64_t)first + count > length ||
+        (uint64_t)(end - buffer) < (uint64_t)count * sizeof(uint64_t))
+    {
+      buffer_remaining = -1;
+      return buffer;
+    }
+
+    ranges.emplace_back(first, first + count);
+    values_.insert(values_.end(), buffer, buffer + sizeof(uint64_t) * count);
+
+    buffer += sizeof(uint64_t) * count;
+    next = first + count;
+  }
+
+  if (buffer != end)
+  {
+    buffer_remaining = -1;
+    return buffer;
+  }
+
+  buffer_remaining -= body_size;
+
+  return buffer;
+}
+
+bool ArrayPatch::apply(const knowledge::KnowledgeRecord& base,
+    knowledge::KnowledgeRecord& result) const
+{
+  if (base.type() != type || base.size() != length)
+  {
+    return false;
+  }
+
+  const char* values = values_.data();
+
+  if (type == knowledge::KnowledgeRecord::INTEGER_ARRAY)
+  {
+    std::vector<knowledge::KnowledgeRecord::Integer> patched(
+        *base.share_integers());
+
+    for (auto& range : ranges)
+    {
+      size_t count = range.second - range.first;
+      utility::endian_swap_array(patched.data() + range.first, values, count);
+      values += sizeof(uint64_t) * count;
+    }
+
+    result.emplace_integers(std::move(patched));
+  }
+  else
+  {
+    std::vector<double> patched(*base.share_doubles());
+
+    for (auto& range : ranges)
+    {
+      size_t count = range.second - range.first;
+      utility::endian_swap_array(patched.data() + range.first, values, count);
+      values += sizeof(uint64_t) * count;
+    }
+
+    result.emplace_doubles(std::move(patched));
+  }
+
+  result.set_toi(toi);
+
+  return true;
+}
+}
+}
@@ -0,0 +1,171 @@
+#ifndef _MADARA_TRANSPORT_ARRAY_PATCH_H_
+#define _MADARA_TRANSPORT_ARRAY_PATCH_H_
+
+/**
+ * @file ArrayPatch.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the patches that transports send in place of array
+ * records when only a few elements changed (@see
+ * TransportSettings::send_deltas)
+ **/
+
+#include <string>
+#include <vector>
+
+#include "madara/utility/StdInt.h"
+#include "madara/MadaraExport.h"
+#include "madara/knowledge/KnowledgeRecord.h"
+#include "madara/knowledge/IndexChangeLog.h"
+
+namespace madara
+{
+namespace transport
+{
+/**
+ * @class ArrayPatch
+ * @brief The elements of an integer or double array that changed since
+ *        a value the sender sent before. A patch takes the place of a
+ *        record in an update, and has a type no record has, so that
+ *        receivers can tell them apart:
+ *
+ *        [key or key id][32 bit unsigned TYPE][32 bit unsigned body
+ *        size][64 bit toi][body]
+ *
+ *        Body format:
+ *
+ *        [32 bit unsigned array type][32 bit unsigned array length]
+ *        [64 bit toi of the base value][32 bit unsigned number of ranges]
+ *        [list of ranges]
+ *
+ *        Range format:
+ *
+ *        [32 bit unsigned first index][32 bit unsigned count][count 64
+ *        bit values]
+ *
+ *        Receivers apply a patch only to the value it was made against,
+ *        which they know by the toi its sender gave it (@see
+ *        ReceiveScratch::array_bases).
+ **/
+class MADARA_EXPORT ArrayPatch
+{
+public:
+  /// the record type that marks an update as a patch
+  static const uint32_t TYPE = 1u << 30;
+
+  /**
+   * Returns the encoded size of a patch, without its key
+   * @param  ranges   the ranges that changed
+   * @return the bytes needed
+   **/
+  static int64_t encoded_size(const knowledge::IndexRanges& ranges);
+
+  /**
+   * Writes a patch of a record
+   * @param     buffer     the buffer to write to
+   * @param     key        the key of the record
+   * @param     record     the new value of the record
+   * @param     base_toi   the toi of the value the patch applies to
+   * @param     ranges     the sorted, disjoint ranges that changed
+   * @param     buffer_remaining  the count of bytes remaining in the
+   *                              buffer
+   * @return    current buffer position for next write
+   * @throw exceptions::MemoryException  not enough buffer to encode
+   **/
+  static char* write(char* buffer, const std::string& key,
+      const knowledge::KnowledgeRecord& record, uint64_t base_toi,
+      const knowledge::IndexRanges& ranges, int64_t& buffer_remaining);
+
+  /**
+   * Writes a patch of a record, for keyed messages
+   * @param     buffer     the buffer to write to
+   * @param     key_id     the id of the key of the record
+   * @param     record     the new value of the record
+   * @param     base_toi   the toi of the value the patch applies to
+   * @param     ranges     the sorted, disjoint ranges that changed
+   * @param     buffer_remaining  the count of bytes remaining in the
+   *                              buffer
+   * @return    current buffer position for next write
+   * @throw exceptions::MemoryException  not enough buffer to encode
+   **/
+  static char* write(char* buffer, uint32_t key_id,
+      const knowledge::KnowledgeRecord& record, uint64_t base_toi,
+      const knowledge::IndexRanges& ranges, int64_t& buffer_remaining);
+
+  /**
+   * Checks if the next update is a patch, without reading it
+   * @param     buffer     the start of the update
+   * @param     keyed      true if updates start with a key id
+   * @param     buffer_remaining  the count of bytes remaining in the
+   *                              buffer
+   * @return    true if the update is a patch
+   **/
+  static bool is_patch(
+      const char* buffer, bool keyed, int64_t buffer_remaining);
+
+  /**
+   * Reads a patch
+   * @param     buffer     the buffer to read from
+   * @param     key        the key of the record
+   * @param     buffer_remaining  the count of bytes remaining in the
+   *                              buffer to read. Negative if the patch
+   *                              did not fit or is malformed.
+   * @return    current buffer position for next read
+   **/
+  const char* read(
+      const char* buffer, std::string& key, int64_t& buffer_remaining);
+
+  /**
+   * Reads a patch from a keyed message
+   * @param     buffer     the buffer to read from
+   * @param     key_id     the id of the key of the record
+   * @param     buffer_remaining  the count of bytes remaining in the
+   *                              buffer to read. Negative if the patch
+   *                              did not fit or is malformed.
+   * @return    current buffer position for next read
+   **/
+  const char* read(
+      const char* buffer, uint32_t& key_id, int64_t& buffer_remaining);
+
+  /**
+   * Makes the new value of a record from the value the patch was made
+   * against. Metadata other than the toi is left to the caller, as is
+   * checking that base is the value with toi base_toi.
+   * @param  base     the current value of the record
+   * @param  result   set to the patched value
+   * @return true if base has the type and length of the patched array
+   **/
+  bool apply(const knowledge::KnowledgeRecord& base,
+      knowledge::KnowledgeRecord& result) const;
+
+  /// the type of the array
+  uint32_t type = 0;
+
+  /// the length of the array
+  uint32_t length = 0;
+
+  /// the toi of the patched value
+  uint64_t toi = 0;
+
+  /// the toi of the value the patch applies to
+  uint64_t base_toi = 0;
+
+  /// the ranges that changed
+  knowledge::IndexRanges ranges;
+
+private:
+  /// writes everything after the key
+  static char* write_body(char* buffer,
+      const knowledge::KnowledgeRecord& record, uint64_t base_toi,
+      const knowledge::IndexRanges& ranges, int64_t& buffer_remaining);
+
+  /// reads everything after the key
+  const char* read_body(const char* buffer, int64_t& buffer_remaining);
+
+  /// the values of the ranges, as they were on the wire
+  std::vector<char> values_;
+};
+}
+}
+
+#endif  // _MADARA_TRANSPORT_ARRAY_PATCH_H_
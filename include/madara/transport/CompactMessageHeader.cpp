@@ -0,0 +1,392 @@
+#include <string.h>
+#include <sstream>
+
+#include "madara/exceptions/MemoryException.h"
+#include "CompactMessageHeader.h"
+#include "TransportSettings.h"
+
+namespace
+{
+/// the bytes value takes as a varint
+inline uint32_t varint_size(uint64_t value)
+{
+  uint32_t size = 1;
+  while (value >= 0x80)
+  {
+    value >>= 7;
+    ++size;
+  }
+  return size;
+}
+
+/// writes value as a varint, which the caller has made room for
+inline char* write_varint(char* buffer, uint64_t value)
+{
+  while (value >= 0x80)
+  {
+    *buffer++ = (char)(value | 0x80);
+    value >>= 7;
+  }
+  *buffer++ = (char)value;
+  return buffer;
+}
+
+/// reads a varint, returning 0 if it runs past end or is too long
+inline const char* read_varint(
+    const char* buffer, const char* end, uint64_t& value)
+{
+  value = 0;
+  for (int shift = 0; shift < 64 && buffer < end; shift += 7)
+  {
+    unsigned char byte = (unsigned char)*buffer++;
+    value |= (uint64_t)(byte & 0x7f) << shift;
+
+    if (!(byte & 0x80))
+    {
+      return buffer;
+    }
+  }
+  return 0;
+}
+
+/// reads a varint that must fit in 32 bits
+inline const char* read_varint(
+    const char* buffer, const char* end, uint32_t& value)
+{
+  uint64_t temp;
+  buffer = read_varint(buffer, end, temp);
+  value = (uint32_t)temp;
+  return temp <= 0xffffffff ? buffer : 0;
+}
+
+/// reads a varint length and that many characters into a field of
+/// field_size bytes, which is null terminated
+inline const char* read_name(
+    const char* buffer, const char* end, char* field, size_t field_size)
+{
+  uint64_t length;
+  buffer = read_varint(buffer, end, length);
+
+  if (!buffer || length >= field_size || length > (uint64_t)(end - buffer))
+  {
+    return 0;
+  }
+
+  memcpy(field, buffer, (size_t)length);
+  field[length] = 0;
+  return buffer + length;
+}
+}
+
+void madara::transport::InternedNames::define(
+    uint32_t session, const char* originator, const char* domain)
+{
+  auto found = sessions_.find(session);
+
+  if (found == sessions_.end())
+  {
+    // sessions of senders that have restarted are never seen again, so
+    // rather than track their age, start over when there are too many
+    if (sessions_.size() >= MAX_SESSIONS)
+    {
+      sessions_.clear();
+    }
+
+    found = sessions_.emplace(session, Names()).first;
+  }
+
+  found->second.originator.assign(originator);
+  found->second.domain.assign(domain);
+}
+
+bool madara::transport::InternedNames::find(
+    uint32_t session, MessageHeader& header) const
+{
+  auto found = sessions_.find(session);
+
+  if (found == sessions_.end())
+  {
+    return false;
+  }
+
+  // define only keeps names that fit
+  memcpy(header.originator, found->second.originator.c_str(),
+      found->second.originator.size() + 1);
+  memcpy(header.domain, found->second.domain.c_str(),
+      found->second.domain.size() + 1);
+
+  return true;
+}
+
+size_t madara::transport::InternedNames::size(void) const
+{
+  return sessions_.size();
+}
+
+void madara::transport::InternedNames::clear(void)
+{
+  sessions_.clear();
+}
+
+madara::transport::CompactMessageHeader::CompactMessageHeader()
+  : KeyedMessageHeader(), session(0), flags(0), names(0)
+{
+  memcpy(madara_id, COMPACT_MADARA_ID, COMPACT_MADARA_ID_LENGTH);
+  madara_id[COMPACT_MADARA_ID_LENGTH] = 0;
+  type = MULTIASSIGN;
+  size = encoded_size();
+}
+
+madara::transport::CompactMessageHeader::~CompactMessageHeader() {}
+
+uint32_t madara::transport::CompactMessageHeader::encoded_size(void) const
+{
+  uint32_t result = COMPACT_MADARA_ID_LENGTH + 1 + varint_size(size) +
+                    varint_size(session) + varint_size(updates) +
+                    varint_size(clock);
+
+  if (flags & NAMES)
+  {
+    size_t originator_length = strnlen(originator, MAX_ORIGINATOR_LENGTH);
+    size_t domain_length = strnlen(domain, MADARA_DOMAIN_MAX_LENGTH);
+
+    result += varint_size(originator_length) + (uint32_t)originator_length +
+              varint_size(domain_length) + (uint32_t)domain_length;
+  }
+
+  if (quality != 0)
+    result += varint_size(quality);
+  if (flags & TIMESTAMP)
+    result += varint_size(timestamp);
+  if (ttl != 0)
+    result += 1;
+  if (type != MULTIASSIGN)
+    result += varint_size(type);
+  if (flags & KEYED)
+    result += varint_size(definitions);
+
+  return result;
+}
+
+void madara::transport::CompactMessageHeader::set_payload_size(
+    uint64_t payload)
+{
+  // the size is part of what it counts, so grow it until it holds itself
+  size = payload;
+  uint64_t total = payload + encoded_size();
+
+  while (total != size)
+  {
+    size = total;
+    total = payload + encoded_size();
+  }
+}
+
+const char* madara::transport::CompactMessageHeader::read(
+    const char* buffer, int64_t& buffer_remaining)
+{
+  const char* start = buffer;
+  const char* end = buffer + (buffer_remaining > 0 ? buffer_remaining : 0);
+
+  // any field that does not fit leaves buffer at 0
+  if (end - buffer < COMPACT_MADARA_ID_LENGTH + 1 ||
+      !compact_message_header_test(buffer))
+  {
+    buffer_remaining = -1;
+    return start;
+  }
+
+  flags = (unsigned char)buffer[COMPACT_MADARA_ID_LENGTH];
+  buffer += COMPACT_MADARA_ID_LENGTH + 1;
+
+  buffer = read_varint(buffer, end, size);
+  if (buffer)
+    buffer = read_varint(buffer, end, session);
+
+  if (buffer && (flags & NAMES))
+  {
+    buffer = read_name(buffer, end, originator, MAX_ORIGINATOR_LENGTH);
+    if (buffer)
+      buffer = read_name(buffer, end, domain, MADARA_DOMAIN_MAX_LENGTH);
+
+    if (buffer && names)
+    {
+      names->define(session, originator, domain);
+    }
+  }
+  else if (buffer && !(names && names->find(session, *this)))
+  {
+    originator[0] = 0;
+    domain[0] = 0;
+  }
+
+  if (buffer)
+    buffer = read_varint(buffer, end, updates);
+  if (buffer)
+    buffer = read_varint(buffer, end, clock);
+
+  quality = 0;
+  if (buffer && (flags & QUALITY))
+    buffer = read_varint(buffer, end, quality);
+
+  timestamp = 0;
+  if (buffer && (flags & TIMESTAMP))
+    buffer = read_varint(buffer, end, timestamp);
+
+  ttl = 0;
+  if (buffer && (flags & TTL))
+  {
+    if (buffer < end)
+      ttl = (unsigned char)*buffer++;
+    else
+      buffer = 0;
+  }
+
+  type = MULTIASSIGN;
+  if (buffer && (flags & TYPE))
+    buffer = read_varint(buffer, end, type);
+
+  definitions = 0;
+  if (buffer && (flags & KEYED))
+    buffer = read_varint(buffer, end, definitions);
+
+  epoch = session;
+
+  if (!buffer)
+  {
+    buffer_remaining = -1;
+    return start;
+  }
+
+  buffer_remaining -= buffer - start;
+  return buffer;
+}
+
+char* madara::transport::CompactMessageHeader::write(
+    char* buffer, int64_t& buffer_remaining)
+{
+  flags &= NAMES | TIMESTAMP | KEYED;
+
+  if (quality != 0)
+    flags |= QUALITY;
+  if (ttl != 0)
+    flags |= TTL;
+  if (type != MULTIASSIGN)
+    flags |= TYPE;
+
+  int64_t encoded = encoded_size();
+
+  if (buffer_remaining < encoded)
+  {
+    std::stringstream buffer;
+    buffer << "CompactMessageHeader::write: ";
+    buffer << encoded << " byte encoding cannot fit in ";
+    buffer << buffer_remaining << " byte buffer\n";
+
+    throw exceptions::MemoryException(buffer.str());
+  }
+
+  memcpy(buffer, COMPACT_MADARA_ID, COMPACT_MADARA_ID_LENGTH);
+  buffer += COMPACT_MADARA_ID_LENGTH;
+  *buffer++ = (char)flags;
+
+  buffer = write_varint(buffer, size);
+  buffer = write_varint(buffer, session);
+
+  if (flags & NAMES)
+  {
+    size_t length = strnlen(originator, MAX_ORIGINATOR_LENGTH);
+    buffer = write_varint(buffer, length);
+    memcpy(buffer, originator, length);
+    buffer += length;
+
+    length = strnlen(domain, MADARA_DOMAIN_MAX_LENGTH);
+    buffer = write_varint(buffer, length);
+    memcpy(buffer, domain, length);
+    buffer += length;
+  }
+
+  buffer = write_varint(buffer, updates);
+  buffer = write_varint(buffer, clock);
+
+  if (flags & QUALITY)
+    buffer = write_varint(buffer, quality);
+  if (flags & TIMESTAMP)
+    buffer = write_varint(buffer, timestamp);
+  if (flags & TTL)
+    *buffer++ = (char)ttl;
+  if (flags & TYPE)
+    buffer = write_varint(buffer, type);
+  if (flags & KEYED)
+    buffer = write_varint(buffer, definitions);
+
+  buffer_remaining -= encoded;
+
+  return buffer;
+}
+
+char* madara::transport::CompactMessageHeader::write_full(
+    char* buffer, int64_t& buffer_remaining)
+{
+  char id[MADARA_IDENTIFIER_LENGTH];
+  memcpy(id, madara_id, sizeof(id));
+
+  if (flags & KEYED)
+  {
+    memcpy(madara_id, KEYED_MADARA_ID, 7);
+    madara_id[7] = 0;
+    buffer = KeyedMessageHeader::write(buffer, buffer_remaining);
+  }
+  else
+  {
+    memcpy(madara_id, MADARA_IDENTIFIER, 7);
+    madara_id[7] = 0;
+    buffer = MessageHeader::write(buffer, buffer_remaining);
+  }
+
+  memcpy(madara_id, id, sizeof(id));
+
+  return buffer;
+}
+
+uint32_t madara::transport::CompactMessageHeader::full_encoded_size(
+    void) const
+{
+  return flags & KEYED ? KeyedMessageHeader::static_encoded_size()
+                       : MessageHeader::static_encoded_size();
+}
+
+std::string madara::transport::CompactMessageHeader::to_string(void)
+{
+  std::stringstream buffer;
+
+  buffer << encoded_size() << ": size (" << size << "), ";
+  buffer << "encoding (" << madara_id << "), ";
+  buffer << "flags (" << (int)flags << "), ";
+  buffer << "session (" << session << "), ";
+  buffer << "domain (" << domain << "), ";
+  buffer << "orig (" << originator << "), ";
+  buffer << "type (" << type << "), ";
+  buffer << "numupdates (" << updates << "), ";
+  buffer << "quality (" << quality << "), ";
+  buffer << "clock (" << clock << "), ";
+  buffer << "wallclock (" << timestamp << "), ";
+  buffer << "ttl (" << (int)ttl << "), ";
+  buffer << "definitions (" << definitions << "), ";
+
+  return buffer.str();
+}
+
+bool madara::transport::CompactMessageHeader::equals(const MessageHeader& other)
+{
+  const CompactMessageHeader* compact =
+      dynamic_cast<const CompactMessageHeader*>(&other);
+
+  return compact && size == other.size && type == other.type &&
+         updates == other.updates && quality == other.quality &&
+         clock == other.clock && ttl == other.ttl &&
+         session == compact->session &&
+         definitions == compact->definitions &&
+         strncmp(domain, other.domain, MADARA_DOMAIN_MAX_LENGTH) == 0 &&
+         strncmp(originator, other.originator, MAX_ORIGINATOR_LENGTH) == 0;
+}
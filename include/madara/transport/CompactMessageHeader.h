@@ -0,0 +1,232 @@
+#ifndef _MADARA_COMPACT_MESSAGE_HEADER_H_
+#define _MADARA_COMPACT_MESSAGE_HEADER_H_
+
+/**
+ * @file CompactMessageHeader.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains a variable length message header for small messages
+ **/
+
+#include <string>
+#include <unordered_map>
+#include "madara/utility/StdInt.h"
+#include "madara/MadaraExport.h"
+#include "madara/transport/KeyedMessageHeader.h"
+
+namespace madara
+{
+namespace transport
+{
+#define COMPACT_MADARA_ID "Kc"
+#define COMPACT_MADARA_ID_LENGTH 2
+
+/**
+ * @class InternedNames
+ * @brief The originator and domain of each sender of compact messages,
+ *        by session. Not thread-safe. A receive thread should own one,
+ *        e.g., in its ReceiveScratch.
+ **/
+class MADARA_EXPORT InternedNames
+{
+public:
+  /// the most sessions kept. Older sessions are forgotten after this.
+  static const size_t MAX_SESSIONS = 4096;
+
+  /**
+   * Remembers the names of a session
+   * @param  session     the session of a sender
+   * @param  originator  the originator of the sender
+   * @param  domain      the domain of the sender
+   **/
+  void define(uint32_t session, const char* originator, const char* domain);
+
+  /**
+   * Copies the names of a session into a header
+   * @param  session     the session of a sender
+   * @param  header      the header whose originator and domain to set
+   * @return true if the session is known
+   **/
+  bool find(uint32_t session, MessageHeader& header) const;
+
+  /**
+   * Returns the number of sessions known
+   **/
+  size_t size(void) const;
+
+  /**
+   * Forgets all sessions
+   **/
+  void clear(void);
+
+private:
+  /// the names of a session
+  struct Names
+  {
+    std::string originator;
+    std::string domain;
+  };
+
+  /// names by session
+  std::unordered_map<uint32_t, Names> sessions_;
+};
+
+/**
+ * @class CompactMessageHeader
+ * @brief Defines a variable length message header for small messages,
+ *        such as heartbeats, whose MessageHeader would be most of the
+ *        message. Integers are written as varints (7 bits a byte, low
+ *        bits first). The originator and domain are interned: each
+ *        sender has a random session, and writes its names with it in
+ *        its first message and every TransportSettings::key_id_refresh
+ *        messages. Receivers drop messages from sessions they do not
+ *        know. Quality, ttl and type are only written if they are not
+ *        their defaults (0, 0 and MULTIASSIGN), and the timestamp only if
+ *        the sender asks for it, e.g., because receivers use deadlines.
+ *        read leaves the timestamp of messages without one at 0, and
+ *        process_received_update stamps them when they arrive. Because
+ *        sizes and counts are not known until the updates are written,
+ *        the header is written last.
+ *
+ *        If the message is keyed (@see KeyedMessageHeader), the session
+ *        is also the epoch of the key ids.
+ *
+ *        Format:
+ *
+ *        [0] [2 byte transport id "Kc"]<br />
+ *        [2] [8 bit flags of the optional fields]<br />
+ *        [3] [varint size of the header plus the updates]<br />
+ *        [ ] [varint session]<br />
+ *        [ ] [varint length, originator] if flags has NAMES<br />
+ *        [ ] [varint length, domain] if flags has NAMES<br />
+ *        [ ] [varint num updates]<br />
+ *        [ ] [varint Lamport clock]<br />
+ *        [ ] [varint quality] if flags has QUALITY<br />
+ *        [ ] [varint wall clock timestamp] if flags has TIMESTAMP<br />
+ *        [ ] [8 bit ttl] if flags has TTL<br />
+ *        [ ] [varint type] if flags has TYPE<br />
+ *        [ ] [varint num key definitions] if flags has KEYED<br />
+ *        [ ] [key definitions, then knowledge updates start here]
+ */
+class MADARA_EXPORT CompactMessageHeader : public KeyedMessageHeader
+{
+public:
+  /// flags of the optional fields
+  enum Flags
+  {
+    NAMES = 1,
+    QUALITY = 2,
+    TIMESTAMP = 4,
+    TTL = 8,
+    TYPE = 16,
+    KEYED = 32
+  };
+
+  /// the most bytes the header can take
+  static const uint32_t MAX_ENCODED_SIZE = COMPACT_MADARA_ID_LENGTH + 1 +
+                                           10 + 5 + 5 + MAX_ORIGINATOR_LENGTH +
+                                           5 + MADARA_DOMAIN_MAX_LENGTH + 5 +
+                                           10 + 5 + 10 + 1 + 5 + 5;
+
+  /**
+   * Constructor
+   **/
+  CompactMessageHeader();
+
+  /**
+   * Destructor
+   **/
+  virtual ~CompactMessageHeader();
+
+  /**
+   * Returns the size of the encoded header with its current fields
+   **/
+  virtual uint32_t encoded_size(void) const;
+
+  /**
+   * Sets size to the size of the header plus the updates, which
+   * changes the size of the header
+   * @param  payload   the bytes after the header
+   **/
+  void set_payload_size(uint64_t payload);
+
+  /**
+   * Reads a CompactMessageHeader instance from a buffer and updates
+   * the amount of buffer room remaining. If names is set, the
+   * originator and domain are looked up in it, or remembered in it if
+   * the message has them. Otherwise they are empty unless the message
+   * has them.
+   * @param     buffer     the readable buffer where data is stored
+   * @param     buffer_remaining  the count of bytes remaining in the
+   *                              buffer to read. Negative if the header
+   *                              is malformed or does not fit.
+   * @return    current buffer position for next read
+   **/
+  virtual const char* read(const char* buffer, int64_t& buffer_remaining);
+
+  /**
+   * Writes a CompactMessageHeader instance to a buffer and updates
+   * the amount of buffer room remaining.
+   * @param     buffer     the readable buffer where data is stored
+   * @param     buffer_remaining  the count of bytes remaining in the
+   *                              buffer to read
+   * @return    current buffer position for next write
+   * @throw exceptions::MemoryException  not enough buffer to encode
+   **/
+  virtual char* write(char* buffer, int64_t& buffer_remaining);
+
+  /**
+   * Writes the fields as a KeyedMessageHeader if the message is keyed,
+   * or else as a MessageHeader, for messages too large for the compact
+   * header, e.g., ones that will be fragmented
+   * @param     buffer     the readable buffer where data is stored
+   * @param     buffer_remaining  the count of bytes remaining in the
+   *                              buffer to read
+   * @return    current buffer position for next write
+   * @throw exceptions::MemoryException  not enough buffer to encode
+   **/
+  char* write_full(char* buffer, int64_t& buffer_remaining);
+
+  /**
+   * Returns the size of the header write_full writes
+   **/
+  uint32_t full_encoded_size(void) const;
+
+  /**
+   * Converts the relevant fields to a printable string
+   * @return  the printable string of fields in the header
+   **/
+  virtual std::string to_string(void);
+
+  /**
+   * Compares the fields of this instance to another instance
+   * @param     other      the other instance to compare against
+   * @return    true if equal, false otherwise
+   **/
+  virtual bool equals(const MessageHeader& other);
+
+  /**
+   * Tests the buffer for a compact message identifier. Other headers
+   * start with a 64 bit size, whose first byte is always 0.
+   * @return   true if identifier indicates compact message header
+   **/
+  static inline bool compact_message_header_test(const char* buffer)
+  {
+    return buffer[0] == COMPACT_MADARA_ID[0] &&
+           buffer[1] == COMPACT_MADARA_ID[1];
+  }
+
+  /// the session of the sender
+  uint32_t session;
+
+  /// the optional fields written or read. NAMES, TIMESTAMP and KEYED
+  /// are set by the sender, and the rest by write from the fields.
+  unsigned char flags;
+
+  /// the names of the senders the receiver knows, or 0
+  InternedNames* names;
+};
+}
+}
+
+#endif  // _MADARA_COMPACT_MESSAGE_HEADER_H_
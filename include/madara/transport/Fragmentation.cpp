@@ -1,5 +1,6 @@
 #include "Fragmentation.h"
 #include "ReducedMessageHeader.h"
+#include "KeyedMessageHeader.h"
 #include "madara/utility/Utility.h"
 #include "madara/logger/GlobalLogger.h"
 
@@ -272,7 +273,9 @@ char* madara::transport::defrag(FragmentMap& map)
           " the map is large enough to contain updates\n");
 
       int64_t size = 0;
-      if (MessageHeader::message_header_test(buffer))
+      // keyed messages start with a normal message header
+      if (MessageHeader::message_header_test(buffer) ||
+          KeyedMessageHeader::keyed_message_header_test(buffer))
       {
         madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_DETAILED,
             "transport::defrag:"
@@ -555,7 +558,9 @@ void madara::transport::frag(
     const char* buffer = source;
     uint64_t total_size;
     FragmentMessageHeader header;
-    if (MessageHeader::message_header_test(source))
+    // keyed messages start with a normal message header
+    if (MessageHeader::message_header_test(source) ||
+        KeyedMessageHeader::keyed_message_header_test(source))
     {
       madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_DETAILED,
           "transport::frag:"
@@ -0,0 +1,192 @@
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string.h>
+
+#include "KeyDictionary.h"
+#include "madara/exceptions/MemoryException.h"
+#include "madara/utility/Utility.h"
+
+namespace madara
+{
+namespace transport
+{
+namespace
+{
+/// a random epoch, which also differs between dictionaries made at once
+uint32_t new_epoch(void)
+{
+  std::random_device random;
+  return (uint32_t)random() ^ (uint32_t)utility::get_time();
+}
+}
+
+KeyDictionary::KeyDictionary()
+  : epoch_(new_epoch()), messages_(0), refresh_(0)
+{
+}
+
+void KeyDictionary::start_message(uint32_t refresh)
+{
+  definitions_.clear();
+  refresh_ = refresh;
+  ++messages_;
+}
+
+uint32_t KeyDictionary::get_id(const std::string& key)
+{
+  auto found = ids_.find(key);
+
+  if (found == ids_.end())
+  {
+    Entry entry;
+    entry.id = (uint32_t)ids_.size();
+
+    // keys that are new together are refreshed apart, so that no message
+    // carries all of the definitions again
+    entry.expires = refresh_ == 0
+                        ? std::numeric_limits<uint64_t>::max()
+                        : messages_ + refresh_ - entry.id % refresh_;
+
+    found = ids_.emplace(key, entry).first;
+    definitions_.emplace_back(entry.id, &found->first);
+  }
+  else if (messages_ >= found->second.expires)
+  {
+    found->second.expires = refresh_ == 0
+                                ? std::numeric_limits<uint64_t>::max()
+                                : messages_ + refresh_;
+
+    definitions_.emplace_back(found->second.id, &found->first);
+  }
+
+  return found->second.id;
+}
+
+char* KeyDictionary::write_definitions(
+    char* buffer, int64_t& buffer_remaining) const
+{
+  for (auto& definition : definitions_)
+  {
+    uint32_t key_size = (uint32_t)definition.second->size() + 1;
+    int64_t encoded_size = sizeof(uint32_t) * 2 + key_size;
+
+    if (buffer_remaining < encoded_size)
+    {
+      std::stringstream buffer;
+      buffer << "KeyDictionary::write_definitions: ";
+      buffer << encoded_size << " byte definition cannot fit in ";
+      buffer << buffer_remaining << " byte buffer\n";
+
+      throw exceptions::MemoryException(buffer.str());
+    }
+
+    uint32_t temp = utility::endian_swap(definition.first);
+    memcpy(buffer, &temp, sizeof(temp));
+    buffer += sizeof(temp);
+
+    temp = utility::endian_swap(key_size);
+    memcpy(buffer, &temp, sizeof(temp));
+    buffer += sizeof(temp);
+
+    memcpy(buffer, definition.second->c_str(), key_size);
+    buffer += key_size;
+
+    buffer_remaining -= encoded_size;
+  }
+
+  return buffer;
+}
+
+uint32_t KeyDictionary::get_definitions(void) const
+{
+  return (uint32_t)definitions_.size();
+}
+
+uint32_t KeyDictionary::get_epoch(void) const
+{
+  return epoch_;
+}
+
+size_t KeyDictionary::size(void) const
+{
+  return ids_.size();
+}
+
+void KeyDictionary::clear(void)
+{
+  ids_.clear();
+  definitions_.clear();
+  epoch_ = new_epoch();
+}
+
+PeerKeyDictionaries::PeerKeyDictionaries() : current_(0) {}
+
+const char* PeerKeyDictionaries::read_definitions(
+    const KeyedMessageHeader& header, const char* buffer,
+    int64_t& buffer_remaining)
+{
+  originator_.assign(header.originator);
+  current_ = &peers_[originator_];
+
+  if (current_->epoch != header.epoch)
+  {
+    current_->epoch = header.epoch;
+    current_->keys.clear();
+  }
+
+  for (uint32_t i = 0; i < header.definitions; ++i)
+  {
+    uint32_t id, key_size;
+
+    if (buffer_remaining < (int64_t)sizeof(uint32_t) * 2)
+    {
+      buffer_remaining = -1;
+      break;
+    }
+
+    memcpy(&id, buffer, sizeof(id));
+    id = utility::endian_swap(id);
+    buffer += sizeof(id);
+
+    memcpy(&key_size, buffer, sizeof(key_size));
+    key_size = utility::endian_swap(key_size);
+    buffer += sizeof(key_size);
+
+    buffer_remaining -= sizeof(uint32_t) * 2;
+
+    // keys are null terminated, and ids are bounded so that a bad
+    // definition cannot take all of our memory
+    if (key_size < 2 || buffer_remaining < (int64_t)key_size ||
+        buffer[key_size - 1] != 0 || id >= MAX_KEY_ID)
+    {
+      buffer_remaining = -1;
+      break;
+    }
+
+    if (id >= current_->keys.size())
+    {
+      current_->keys.resize(id + 1);
+    }
+
+    current_->keys[id].assign(buffer, key_size - 1);
+
+    buffer += key_size;
+    buffer_remaining -= key_size;
+  }
+
+  return buffer;
+}
+
+size_t PeerKeyDictionaries::size(void) const
+{
+  return peers_.size();
+}
+
+void PeerKeyDictionaries::clear(void)
+{
+  peers_.clear();
+  current_ = 0;
+}
+}
+}
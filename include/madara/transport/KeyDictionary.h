@@ -0,0 +1,200 @@
+#ifndef _MADARA_TRANSPORT_KEY_DICTIONARY_H_
+#define _MADARA_TRANSPORT_KEY_DICTIONARY_H_
+
+/**
+ * @file KeyDictionary.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the dictionaries of key ids that transports use to
+ * send and receive keyed messages (@see KeyedMessageHeader)
+ **/
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "madara/utility/StdInt.h"
+#include "madara/MadaraExport.h"
+#include "madara/transport/KeyedMessageHeader.h"
+
+namespace madara
+{
+namespace transport
+{
+/**
+ * @class KeyDictionary
+ * @brief Gives the keys a sender sends 32 bit ids, and tracks which
+ *        definitions of ids the next message must carry. A key is
+ *        defined in the first message that has it, and again every
+ *        refresh messages, so receivers that join late or lose a packet
+ *        learn it. Ids are only valid within an epoch, which is random
+ *        for each dictionary, so receivers forget the ids of a sender
+ *        that restarts.
+ *
+ *        Definition format:
+ *
+ *        [32 bit unsigned id][32 bit unsigned key size][key, null
+ *        terminated]
+ **/
+class MADARA_EXPORT KeyDictionary
+{
+public:
+  /**
+   * Constructor
+   **/
+  KeyDictionary();
+
+  /**
+   * Starts a message, which will carry the definitions that get_id finds
+   * are due
+   * @param  refresh   messages between definitions of a key. 0 defines
+   *                   each key only once.
+   **/
+  void start_message(uint32_t refresh);
+
+  /**
+   * Gets the id of a key, giving it the next id if it has none, and
+   * adds its definition to the message if it is new or due
+   * @param  key   the key of an update in the message
+   * @return the id of the key
+   **/
+  uint32_t get_id(const std::string& key);
+
+  /**
+   * Writes the definitions of the message
+   * @param     buffer     the buffer to write to
+   * @param     buffer_remaining  the count of bytes remaining in the
+   *                              buffer
+   * @return    current buffer position for next write
+   * @throw exceptions::MemoryException  not enough buffer to encode
+   **/
+  char* write_definitions(char* buffer, int64_t& buffer_remaining) const;
+
+  /**
+   * Returns the number of definitions in the message
+   **/
+  uint32_t get_definitions(void) const;
+
+  /**
+   * Returns the epoch of the ids
+   **/
+  uint32_t get_epoch(void) const;
+
+  /**
+   * Returns the number of keys with ids
+   **/
+  size_t size(void) const;
+
+  /**
+   * Forgets all ids and starts a new epoch
+   **/
+  void clear(void);
+
+private:
+  /// the id of a key and when it was last defined
+  struct Entry
+  {
+    /// the id of the key
+    uint32_t id;
+
+    /// the message after which the key must be defined again
+    uint64_t expires;
+  };
+
+  /// the ids of keys
+  std::unordered_map<std::string, Entry> ids_;
+
+  /// the ids and keys to define in the message. Keys point into ids_.
+  std::vector<std::pair<uint32_t, const std::string*>> definitions_;
+
+  /// the epoch of the ids
+  uint32_t epoch_;
+
+  /// the number of messages started
+  uint64_t messages_;
+
+  /// the refresh of the message
+  uint32_t refresh_;
+};
+
+/**
+ * @class PeerKeyDictionaries
+ * @brief Keeps the key ids that each sender has defined, for a receiver.
+ *        Not thread-safe. A receive thread should own one, e.g., in its
+ *        ReceiveScratch.
+ **/
+class MADARA_EXPORT PeerKeyDictionaries
+{
+public:
+  /// the largest id a sender may define, which bounds the memory used
+  static const uint32_t MAX_KEY_ID = 1 << 20;
+
+  /**
+   * Constructor
+   **/
+  PeerKeyDictionaries();
+
+  /**
+   * Reads the definitions of a keyed message, and makes its originator
+   * the sender that get_key looks up ids for. The ids of the originator
+   * are forgotten if the header has a new epoch.
+   * @param     header     the header of the message
+   * @param     buffer     the definitions after the header
+   * @param     buffer_remaining  the count of bytes remaining in the
+   *                              buffer to read. Negative if the
+   *                              definitions did not fit.
+   * @return    current buffer position for next read
+   **/
+  const char* read_definitions(const KeyedMessageHeader& header,
+      const char* buffer, int64_t& buffer_remaining);
+
+  /**
+   * Gets the key of an id from the originator of the last message read
+   * @param  id   the id of a key
+   * @return the key, or 0 if the originator has not defined the id
+   **/
+  inline const std::string* get_key(uint32_t id) const
+  {
+    if (current_ && id < current_->keys.size() &&
+        !current_->keys[id].empty())
+    {
+      return &current_->keys[id];
+    }
+
+    return 0;
+  }
+
+  /**
+   * Returns the number of senders whose ids are known
+   **/
+  size_t size(void) const;
+
+  /**
+   * Forgets the ids of all senders
+   **/
+  void clear(void);
+
+private:
+  /// the ids of a sender
+  struct Peer
+  {
+    /// the epoch of the ids
+    uint32_t epoch = 0;
+
+    /// keys by id. Ids that have not been defined have empty keys.
+    std::vector<std::string> keys;
+  };
+
+  /// the ids of each sender, by originator
+  std::unordered_map<std::string, Peer> peers_;
+
+  /// the originator of the last message read
+  Peer* current_;
+
+  /// reused for looking up originators
+  std::string originator_;
+};
+}
+}
+
+#endif  // _MADARA_TRANSPORT_KEY_DICTIONARY_H_
@@ -0,0 +1,139 @@
+#include <string.h>
+#include <sstream>
+
+#include "madara/exceptions/MemoryException.h"
+#include "KeyedMessageHeader.h"
+#include "madara/utility/Utility.h"
+
+madara::transport::KeyedMessageHeader::KeyedMessageHeader()
+  : MessageHeader(), epoch(0), definitions(0)
+{
+  memcpy(madara_id, KEYED_MADARA_ID, 7);
+  madara_id[7] = 0;
+  size = encoded_size();
+}
+
+madara::transport::KeyedMessageHeader::~KeyedMessageHeader() {}
+
+uint32_t madara::transport::KeyedMessageHeader::encoded_size(void) const
+{
+  return static_encoded_size();
+}
+
+uint32_t madara::transport::KeyedMessageHeader::static_encoded_size(void)
+{
+  return MessageHeader::static_encoded_size() +
+         sizeof(uint32_t) * 2;  // epoch, definitions
+}
+
+const char* madara::transport::KeyedMessageHeader::read(
+    const char* buffer, int64_t& buffer_remaining)
+{
+  buffer = MessageHeader::read(buffer, buffer_remaining);
+
+  // Remove epoch field from the buffer and update accordingly
+  if (buffer_remaining >= (int64_t)sizeof(epoch))
+  {
+    memcpy(&epoch, buffer, sizeof(epoch));
+    epoch = madara::utility::endian_swap(epoch);
+    buffer += sizeof(epoch);
+  }
+  else
+  {
+    std::stringstream buffer;
+    buffer << "KeyedMessageHeader::read: ";
+    buffer << sizeof(epoch) << " byte epoch encoding cannot";
+    buffer << " fit in ";
+    buffer << buffer_remaining << " byte buffer\n";
+
+    throw exceptions::MemoryException(buffer.str());
+  }
+  buffer_remaining -= sizeof(epoch);
+
+  // Remove definitions field from the buffer and update accordingly
+  if (buffer_remaining >= (int64_t)sizeof(definitions))
+  {
+    memcpy(&definitions, buffer, sizeof(definitions));
+    definitions = madara::utility::endian_swap(definitions);
+    buffer += sizeof(definitions);
+  }
+  else
+  {
+    std::stringstream buffer;
+    buffer << "KeyedMessageHeader::read: ";
+    buffer << sizeof(definitions) << " byte definitions encoding cannot";
+    buffer << " fit in ";
+    buffer << buffer_remaining << " byte buffer\n";
+
+    throw exceptions::MemoryException(buffer.str());
+  }
+  buffer_remaining -= sizeof(definitions);
+
+  return buffer;
+}
+
+char* madara::transport::KeyedMessageHeader::write(
+    char* buffer, int64_t& buffer_remaining)
+{
+  buffer = MessageHeader::write(buffer, buffer_remaining);
+
+  // Write epoch field to the buffer and update accordingly
+  if (buffer_remaining >= (int64_t)sizeof(epoch))
+  {
+    uint32_t temp = madara::utility::endian_swap(epoch);
+    memcpy(buffer, &temp, sizeof(temp));
+    buffer += sizeof(epoch);
+  }
+  else
+  {
+    std::stringstream buffer;
+    buffer << "KeyedMessageHeader::write: ";
+    buffer << sizeof(epoch) << " byte epoch encoding cannot";
+    buffer << " fit in ";
+    buffer << buffer_remaining << " byte buffer\n";
+
+    throw exceptions::MemoryException(buffer.str());
+  }
+  buffer_remaining -= sizeof(epoch);
+
+  // Write definitions field to the buffer and update accordingly
+  if (buffer_remaining >= (int64_t)sizeof(definitions))
+  {
+    uint32_t temp = madara::utility::endian_swap(definitions);
+    memcpy(buffer, &temp, sizeof(temp));
+    buffer += sizeof(definitions);
+  }
+  else
+  {
+    std::stringstream buffer;
+    buffer << "KeyedMessageHeader::write: ";
+    buffer << sizeof(definitions) << " byte definitions encoding cannot";
+    buffer << " fit in ";
+    buffer << buffer_remaining << " byte buffer\n";
+
+    throw exceptions::MemoryException(buffer.str());
+  }
+  buffer_remaining -= sizeof(definitions);
+
+  return buffer;
+}
+
+std::string madara::transport::KeyedMessageHeader::to_string(void)
+{
+  std::stringstream buffer;
+
+  buffer << MessageHeader::to_string();
+  buffer << "epoch (4:" << epoch << "), ";
+  buffer << "definitions (4:" << definitions << "), ";
+
+  return buffer.str();
+}
+
+bool madara::transport::KeyedMessageHeader::equals(const MessageHeader& other)
+{
+  const KeyedMessageHeader* keyed =
+      dynamic_cast<const KeyedMessageHeader*>(&other);
+
+  return keyed && MessageHeader::equals(other) && epoch == keyed->epoch &&
+         definitions == keyed->definitions;
+}
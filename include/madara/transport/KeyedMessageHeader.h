@@ -0,0 +1,130 @@
+#ifndef _MADARA_KEYED_MESSAGE_HEADER_H_
+#define _MADARA_KEYED_MESSAGE_HEADER_H_
+
+/**
+ * @file KeyedMessageHeader.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the message header for messages whose updates are
+ * keyed by 32 bit ids instead of key strings
+ **/
+
+#include <string.h>
+#include "madara/utility/StdInt.h"
+#include "madara/MadaraExport.h"
+#include "madara/transport/MessageHeader.h"
+
+namespace madara
+{
+namespace transport
+{
+#define KEYED_MADARA_ID "KaRLkey"
+
+/**
+ * @class KeyedMessageHeader
+ * @brief Defines a message header for updates that are keyed by ids
+ *        rather than key strings. The header is a MessageHeader followed
+ *        by the epoch of the sender's key ids and the number of key
+ *        definitions. The definitions follow the header and precede the
+ *        updates. @see KeyDictionary
+ *
+ *        Format:
+ *
+ *        [0] [64 bit unsigned size]<br />
+ *        [8] [8 byte transport id]<br />
+ *        [16] [32 byte domain name]<br />
+ *        [48] [64 byte originator (generally host:port)]<br />
+ *        [112] [32 bit unsigned type]<br />
+ *        [116] [32 bit unsigned num updates]<br />
+ *        [120] [32 bit unsigned quality (type of priority)]<br />
+ *        [124] [64 bit unsigned Lamport clock]<br />
+ *        [132] [64 bit unsigned wall clock timestamp]<br />
+ *        [140] [8 bit unsigned ttl--for rebroadcasts]<br />
+ *        [141] [32 bit unsigned epoch of the key ids]<br />
+ *        [145] [32 bit unsigned num key definitions]<br />
+ *        [149] [key definitions, then knowledge updates start here]
+ */
+
+class MADARA_EXPORT KeyedMessageHeader : public MessageHeader
+{
+public:
+  /**
+   * Constructor
+   **/
+  KeyedMessageHeader();
+
+  /**
+   * Destructor
+   **/
+  virtual ~KeyedMessageHeader();
+
+  /**
+   * Returns the size of the encoded KeyedMessageHeader class
+   **/
+  virtual uint32_t encoded_size(void) const;
+
+  /**
+   * Returns the size of the encoded KeyedMessageHeader class. Unlike
+   * MessageHeader::static_encoded_size, this refers to the keyed header.
+   **/
+  static uint32_t static_encoded_size(void);
+
+  /**
+   * Reads a KeyedMessageHeader instance from a buffer and updates
+   * the amount of buffer room remaining.
+   * @param     buffer     the readable buffer where data is stored
+   * @param     buffer_remaining  the count of bytes remaining in the
+   *                              buffer to read
+   * @return    current buffer position for next read
+   * @throw exceptions::MemoryException  not enough buffer to encode
+   **/
+  virtual const char* read(const char* buffer, int64_t& buffer_remaining);
+
+  /**
+   * Writes a KeyedMessageHeader instance to a buffer and updates
+   * the amount of buffer room remaining.
+   * @param     buffer     the readable buffer where data is stored
+   * @param     buffer_remaining  the count of bytes remaining in the
+   *                              buffer to read
+   * @return    current buffer position for next write
+   * @throw exceptions::MemoryException  not enough buffer to encode
+   **/
+  virtual char* write(char* buffer, int64_t& buffer_remaining);
+
+  /**
+   * Converts the relevant fields to a printable string
+   * @return  the printable string of fields in the header
+   **/
+  virtual std::string to_string(void);
+
+  /**
+   * Compares the fields of this instance to another instance
+   * @param     other      the other instance to compare against
+   * @return    true if equal, false otherwise
+   **/
+  virtual bool equals(const MessageHeader& other);
+
+  /**
+   * Tests the buffer for a keyed message identifier
+   * @return   true if identifier indicates keyed message header
+   **/
+  static inline bool keyed_message_header_test(const char* buffer)
+  {
+    return strncmp(&(buffer[8]), KEYED_MADARA_ID, 7) == 0;
+  }
+
+  /**
+   * the epoch of the sender's key ids. A sender that changes epoch has
+   * forgotten the ids it gave before.
+   **/
+  uint32_t epoch;
+
+  /**
+   * the number of key definitions after the header
+   **/
+  uint32_t definitions;
+};
+}
+}
+
+#endif  // _MADARA_KEYED_MESSAGE_HEADER_H_
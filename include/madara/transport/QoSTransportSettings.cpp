@@ -1,4 +1,5 @@
 #include "madara/transport/QoSTransportSettings.h"
+#include "madara/transport/CompactMessageHeader.h"
 #include "madara/knowledge/KnowledgeBase.h"
 #include "madara/knowledge/containers/StringVector.h"
 #include "madara/knowledge/containers/Map.h"
@@ -238,6 +239,12 @@ void madara::transport::QoSTransportSettings::add_send_filter(
   send_filters_.add(types, functor);
 }
 
+void madara::transport::QoSTransportSettings::add_send_filter(
+    uint32_t types, filters::KeyedRecordFilter* functor)
+{
+  send_filters_.add(types, functor);
+}
+
 void madara::transport::QoSTransportSettings::add_send_filter(void (*function)(
     knowledge::KnowledgeMap&, const TransportContext&, knowledge::Variables&))
 {
@@ -275,6 +282,12 @@ void madara::transport::QoSTransportSettings::add_receive_filter(
   receive_filters_.add(types, functor);
 }
 
+void madara::transport::QoSTransportSettings::add_receive_filter(
+    uint32_t types, filters::KeyedRecordFilter* functor)
+{
+  receive_filters_.add(types, functor);
+}
+
 void madara::transport::QoSTransportSettings::add_receive_filter(
     void (*function)(knowledge::KnowledgeMap&, const TransportContext&,
         knowledge::Variables&))
@@ -295,6 +308,12 @@ void madara::transport::QoSTransportSettings::add_rebroadcast_filter(
   rebroadcast_filters_.add(types, functor);
 }
 
+void madara::transport::QoSTransportSettings::add_rebroadcast_filter(
+    uint32_t types, filters::KeyedRecordFilter* functor)
+{
+  rebroadcast_filters_.add(types, functor);
+}
+
 void madara::transport::QoSTransportSettings::add_rebroadcast_filter(
     void (*function)(knowledge::KnowledgeMap&, const TransportContext&,
         knowledge::Variables&))
@@ -507,7 +526,14 @@ int madara::transport::QoSTransportSettings::filter_encode(
 int madara::transport::QoSTransportSettings::filter_decode(
     char* source, int size, int max_size) const
 {
-  if (buffer_filters_.size() == 0)
+  if (buffer_filters_.size() == 0 && size > COMPACT_MADARA_ID_LENGTH &&
+      CompactMessageHeader::compact_message_header_test(source))
+  {
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+        "QoSTransportSettings::filter_decode: header: "
+        " Detected compact message header\n");
+  }
+  else if (buffer_filters_.size() == 0)
   {
     // if we don't have buffer filters, do a check to see if we should
     filters::BufferFilterHeader header;
@@ -18,6 +18,7 @@
 #include "madara/MadaraExport.h"
 #include "madara/filters/AggregateFilter.h"
 #include "madara/filters/RecordFilter.h"
+#include "madara/filters/KeyedRecordFilter.h"
 #include "madara/filters/BufferFilter.h"
 #include "madara/knowledge/KnowledgeRecordFilters.h"
 
@@ -97,6 +98,16 @@ public:
    **/
   void add_send_filter(uint32_t types, filters::RecordFilter* filter);
 
+  /**
+   * Adds a filter that will be applied to certain types before sending
+   * @param   types      the types to add the filter to
+   * @param   filter     an instance of a record filter that changes
+   *                     records in place, which will be managed by the
+   *                     underlying infrastructure
+   **/
+  void add_send_filter(
+      uint32_t types, filters::KeyedRecordFilter* filter);
+
   /**
    * Adds an aggregate update filter that will be applied before sending,
    * after individual record filters.
@@ -138,6 +149,16 @@ public:
    **/
   void add_receive_filter(uint32_t types, filters::RecordFilter* filter);
 
+  /**
+   * Adds a filter that will be applied to certain types after receiving
+   * @param   types      the types to add the filter to
+   * @param   filter     an instance of a record filter that changes
+   *                     records in place, which will be managed by the
+   *                     underlying infrastructure
+   **/
+  void add_receive_filter(
+      uint32_t types, filters::KeyedRecordFilter* filter);
+
   /**
    * Adds an aggregate update filter that will be applied after receiving,
    * after individual record filters.
@@ -174,6 +195,17 @@ public:
    **/
   void add_rebroadcast_filter(uint32_t types, filters::RecordFilter* filter);
 
+  /**
+   * Adds a filter that will be applied to certain types after receiving
+   * and before rebroadcasting (if TTL > 0)
+   * @param   types      the types to add the filter to
+   * @param   filter     an instance of a record filter that changes
+   *                     records in place, which will be managed by the
+   *                     underlying infrastructure
+   **/
+  void add_rebroadcast_filter(
+      uint32_t types, filters::KeyedRecordFilter* filter);
+
   /**
    * Adds an aggregate update filter that will be applied before
    * rebroadcasting, after individual record filters.
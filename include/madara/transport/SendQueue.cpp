@@ -0,0 +1,201 @@
+#include "SendQueue.h"
+
+#include <chrono>
+
+#include "madara/utility/Utility.h"
+
+namespace madara
+{
+namespace transport
+{
+SendQueue::SendQueue(Base& transport, knowledge::ThreadSafeContext& context)
+  : transport_(transport),
+    context_(context),
+    max_depth_(transport.settings().send_queue_length),
+    policy_(transport.settings().send_queue_policy),
+    timeout_((uint64_t)(transport.settings().send_queue_timeout * 1000000000)),
+    pending_since_(0),
+    sending_(false),
+    terminated_(false),
+    dropped_(0),
+    coalesced_(0),
+    debug_(transport.settings().debug_to_kb_prefix != "")
+{
+  if (debug_)
+  {
+    const std::string& prefix = transport.settings().debug_to_kb_prefix;
+
+    queue_depth_ = context.get_ref(prefix + ".send_queue_depth");
+    queue_max_depth_ = context.get_ref(prefix + ".send_queue_max_depth");
+    queue_dropped_ = context.get_ref(prefix + ".send_queue_dropped");
+    queue_coalesced_ = context.get_ref(prefix + ".send_queue_coalesced");
+    send_latency_ = context.get_ref(prefix + ".send_latency");
+    send_latency_max_ = context.get_ref(prefix + ".send_latency_max");
+  }
+
+  thread_ = std::thread(&SendQueue::run, this);
+}
+
+SendQueue::~SendQueue()
+{
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    terminated_ = true;
+  }
+
+  pending_cond_.notify_one();
+  drained_cond_.notify_all();
+
+  if (thread_.joinable())
+  {
+    thread_.join();
+  }
+}
+
+size_t SendQueue::enqueue(const knowledge::KnowledgeMap& updates)
+{
+  size_t dropped = 0;
+  bool timed_out = false;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  // a batch larger than the queue is still sent if the queue is empty
+  const bool admit_all = pending_.empty();
+
+  if (admit_all)
+  {
+    pending_since_ = utility::get_time();
+  }
+
+  for (const auto& update : updates)
+  {
+    auto found = pending_.find(update.first);
+
+    if (found != pending_.end())
+    {
+      found->second = update.second;
+      ++coalesced_;
+      continue;
+    }
+
+    if (pending_.size() >= max_depth_ && !admit_all &&
+        policy_ == SEND_QUEUE_BLOCK && !timed_out && !terminated_)
+    {
+      // the caller may hold the context lock, which send filters need, so
+      // never wait indefinitely for the sender thread
+      auto deadline = std::chrono::steady_clock::now() +
+                      std::chrono::nanoseconds(timeout_);
+
+      timed_out = !drained_cond_.wait_until(lock, deadline, [this] {
+        return pending_.size() < max_depth_ || terminated_;
+      });
+
+      if (pending_.empty())
+      {
+        pending_since_ = utility::get_time();
+      }
+    }
+
+    if (pending_.size() >= max_depth_ && !admit_all)
+    {
+      ++dropped;
+      continue;
+    }
+
+    pending_.emplace(update.first, update.second);
+  }
+
+  dropped_ += dropped;
+
+  lock.unlock();
+  pending_cond_.notify_one();
+
+  return dropped;
+}
+
+void SendQueue::flush(void)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  drained_cond_.wait(lock, [this] { return pending_.empty() && !sending_; });
+}
+
+size_t SendQueue::depth(void) const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  return pending_.size();
+}
+
+uint64_t SendQueue::dropped(void) const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  return dropped_;
+}
+
+uint64_t SendQueue::coalesced(void) const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  return coalesced_;
+}
+
+void SendQueue::run(void)
+{
+  knowledge::KnowledgeMap batch;
+  uint64_t max_depth = 0;
+  uint64_t max_latency = 0;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  for (;;)
+  {
+    pending_cond_.wait(
+        lock, [this] { return !pending_.empty() || terminated_; });
+
+    // pending updates are always sent, even after termination
+    if (pending_.empty())
+    {
+      break;
+    }
+
+    batch.swap(pending_);
+    uint64_t since = pending_since_;
+    uint64_t depth = batch.size();
+    uint64_t dropped = dropped_;
+    uint64_t coalesced = coalesced_;
+    sending_ = true;
+
+    lock.unlock();
+    drained_cond_.notify_all();
+
+    transport_.send_data(batch);
+    batch.clear();
+
+    uint64_t latency = utility::get_time() - since;
+
+    if (debug_)
+    {
+      if (depth > max_depth)
+        max_depth = depth;
+      if (latency > max_latency)
+        max_latency = latency;
+
+      typedef knowledge::KnowledgeRecord::Integer Integer;
+
+      context_.set(queue_depth_, (Integer)depth);
+      context_.set(queue_max_depth_, (Integer)max_depth);
+      context_.set(queue_dropped_, (Integer)dropped);
+      context_.set(queue_coalesced_, (Integer)coalesced);
+      context_.set(send_latency_, (Integer)latency);
+      context_.set(send_latency_max_, (Integer)max_latency);
+    }
+
+    lock.lock();
+    sending_ = false;
+    drained_cond_.notify_all();
+  }
+
+  sending_ = false;
+  drained_cond_.notify_all();
+}
+}
+}
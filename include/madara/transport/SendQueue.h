@@ -0,0 +1,150 @@
+#ifndef _MADARA_TRANSPORT_SENDQUEUE_H_
+#define _MADARA_TRANSPORT_SENDQUEUE_H_
+
+/**
+ * @file SendQueue.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the SendQueue class, which sends knowledge updates
+ * over a transport from a dedicated thread
+ **/
+
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+#include "madara/MadaraExport.h"
+#include "madara/knowledge/KnowledgeRecord.h"
+#include "madara/knowledge/ThreadSafeContext.h"
+#include "madara/transport/Transport.h"
+
+namespace madara
+{
+namespace transport
+{
+/**
+ * @class SendQueue
+ * @brief Decouples a transport from the threads that modify knowledge.
+ *        Updates handed to enqueue are coalesced by key into a pending
+ *        map, which a dedicated sender thread swaps out and passes to
+ *        the transport's send_data. Settings are read from the
+ *        transport: send_queue_length, send_queue_policy,
+ *        send_queue_timeout and debug_to_kb_prefix.
+ *
+ *        The transport must outlive the queue. Destroying the queue
+ *        sends anything still pending.
+ **/
+class MADARA_EXPORT SendQueue
+{
+public:
+  /**
+   * Constructor. Starts the sender thread.
+   * @param  transport    the transport to send over
+   * @param  context      the context the transport is attached to
+   **/
+  SendQueue(Base& transport, knowledge::ThreadSafeContext& context);
+
+  /**
+   * Destructor. Sends pending updates and stops the sender thread.
+   **/
+  ~SendQueue();
+
+  SendQueue(const SendQueue&) = delete;
+  SendQueue& operator=(const SendQueue&) = delete;
+
+  /**
+   * Adds updates to the queue. Updates to keys that are already pending
+   * replace the pending value and never count against the queue length.
+   * New keys that do not fit are dropped with SEND_QUEUE_DROP. With
+   * SEND_QUEUE_BLOCK, the caller waits up to send_queue_timeout for the
+   * sender thread to make room, and then drops them.
+   * @param  updates      the updates to send
+   * @return  the number of records that were dropped
+   **/
+  size_t enqueue(const knowledge::KnowledgeMap& updates);
+
+  /**
+   * Blocks until every enqueued update has been passed to send_data
+   **/
+  void flush(void);
+
+  /**
+   * Returns the number of records waiting to be sent
+   * @return  the queue depth
+   **/
+  size_t depth(void) const;
+
+  /**
+   * Returns the number of records dropped because the queue was full
+   * @return  the number of dropped records
+   **/
+  uint64_t dropped(void) const;
+
+  /**
+   * Returns the number of updates that replaced a pending value
+   * @return  the number of coalesced records
+   **/
+  uint64_t coalesced(void) const;
+
+private:
+  /// sender thread entry point
+  void run(void);
+
+  /// the transport we send over
+  Base& transport_;
+
+  /// the context debug statistics are saved to
+  knowledge::ThreadSafeContext& context_;
+
+  /// max pending records
+  size_t max_depth_;
+
+  /// SEND_QUEUE_BLOCK or SEND_QUEUE_DROP
+  uint32_t policy_;
+
+  /// max ns a blocked enqueue waits for room
+  uint64_t timeout_;
+
+  /// protects everything below
+  mutable std::mutex mutex_;
+
+  /// signaled when updates are pending or on termination
+  std::condition_variable pending_cond_;
+
+  /// signaled when the sender takes the pending updates or finishes a send
+  std::condition_variable drained_cond_;
+
+  /// updates waiting for the sender thread
+  knowledge::KnowledgeMap pending_;
+
+  /// time the oldest pending update was enqueued
+  uint64_t pending_since_;
+
+  /// true while the sender thread is inside send_data
+  bool sending_;
+
+  /// true when the sender thread should exit
+  bool terminated_;
+
+  /// records dropped because the queue was full
+  uint64_t dropped_;
+
+  /// records that replaced a pending value
+  uint64_t coalesced_;
+
+  /// debug statistics, set only if debug_to_kb_prefix is not empty
+  bool debug_;
+  knowledge::VariableReference queue_depth_;
+  knowledge::VariableReference queue_max_depth_;
+  knowledge::VariableReference queue_dropped_;
+  knowledge::VariableReference queue_coalesced_;
+  knowledge::VariableReference send_latency_;
+  knowledge::VariableReference send_latency_max_;
+
+  /// the sender thread
+  std::thread thread_;
+};
+}
+}
+
+#endif  // _MADARA_TRANSPORT_SENDQUEUE_H_
@@ -56,6 +56,16 @@ int Base::setup(void)
   if (settings_.queue_length > 0)
     buffer_ = new char[settings_.queue_length];
 
+  // patches are made from the index ranges the context tracks
+  if (settings_.send_deltas)
+  {
+    madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+        "transport::Base::setup"
+        " sending arrays as patches. Tracking index changes.\n");
+
+    context_.track_index_changes(true);
+  }
+
   // if read domains has not been set, then set to write domain
   if (settings_.num_read_domains() == 0)
   {
@@ -106,6 +116,34 @@ void Base::close(void)
   invalidate_transport();
 }
 
+ReceiveScratch::ReceiveScratch() : num_updates(0)
+{
+  compact_header.names = &interned_names;
+}
+
+void ReceiveScratch::release(void)
+{
+  // keep the key strings (and their capacity) but drop references to
+  // shared values so they are not held until the next packet
+  for (size_t i = 0; i < num_updates; ++i)
+  {
+    updates[i].second.reset_value();
+  }
+
+  num_updates = 0;
+  aggregate.clear();
+}
+
+ReceiveScratch::Update& ReceiveScratch::next(void)
+{
+  if (num_updates == updates.size())
+  {
+    updates.emplace_back();
+  }
+
+  return updates[num_updates++];
+}
+
 int process_received_update(const char* buffer, uint32_t bytes_read,
     const std::string& id, knowledge::ThreadSafeContext& context,
     const QoSTransportSettings& settings, BandwidthMonitor& send_monitor,
@@ -117,7 +155,48 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
 
     const char* print_prefix, const char* remote_host, MessageHeader*& header)
 {
-  // reset header to 0, so it is safe to delete
+  ReceiveScratch scratch;
+  MessageHeader* received = 0;
+
+  int result = process_received_update(buffer, bytes_read, id, context,
+      settings, send_monitor, receive_monitor, rebroadcast_records,
+#ifndef _MADARA_NO_KARL_
+      on_data_received,
+#endif  // _MADARA_NO_KARL_
+      print_prefix, remote_host, scratch, received);
+
+  // callers of this version own the header, so copy it out of the scratch
+  header = 0;
+
+  if (received == &scratch.reduced_header)
+  {
+    header = new ReducedMessageHeader(scratch.reduced_header);
+  }
+  else if (received == &scratch.fragment_header)
+  {
+    header = new FragmentMessageHeader(scratch.fragment_header);
+  }
+  else if (received)
+  {
+    header = new MessageHeader(*received);
+  }
+
+  return result;
+}
+
+int process_received_update(const char* buffer, uint32_t bytes_read,
+    const std::string& id, knowledge::ThreadSafeContext& context,
+    const QoSTransportSettings& settings, BandwidthMonitor& send_monitor,
+    BandwidthMonitor& receive_monitor,
+    knowledge::KnowledgeMap& rebroadcast_records,
+#ifndef _MADARA_NO_KARL_
+    knowledge::CompiledExpression& on_data_received,
+#endif  // _MADARA_NO_KARL_
+
+    const char* print_prefix, const char* remote_host, ReceiveScratch& scratch,
+    MessageHeader*& header)
+{
+  // header will point into the scratch, so there is nothing to delete
   header = 0;
 
   int max_buffer_size = (int)bytes_read;
@@ -132,6 +211,8 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
 
   bool is_reduced = false;
   bool is_fragment = false;
+  bool is_keyed = false;
+  bool is_compact = false;
 
   madara_logger_log(context.get_logger(), logger::LOG_MAJOR,
       "%s:"
@@ -153,11 +234,8 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
   // clear the rebroadcast records
   rebroadcast_records.clear();
 
-  // receive records will be what we pass to the aggregate filter
-  knowledge::KnowledgeMap updates;
-
-  // if a key appears multiple times, keep to add to buffer history
-  std::map<std::string, std::vector<knowledge::KnowledgeRecord>> past_updates;
+  // drop anything left over from a previous packet
+  scratch.release();
 
   // check the buffer for a reduced message header
   if (bytes_read >= ReducedMessageHeader::static_encoded_size() &&
@@ -168,9 +246,20 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
         " processing reduced KaRL message from %s\n",
         print_prefix, remote_host);
 
-    header = new ReducedMessageHeader();
+    header = &scratch.reduced_header;
     is_reduced = true;
   }
+  else if (bytes_read >= KeyedMessageHeader::static_encoded_size() &&
+           KeyedMessageHeader::keyed_message_header_test(buffer))
+  {
+    madara_logger_log(context.get_logger(), logger::LOG_MINOR,
+        "%s:"
+        " processing keyed KaRL message from %s\n",
+        print_prefix, remote_host);
+
+    header = &scratch.keyed_header;
+    is_keyed = true;
+  }
   else if (bytes_read >= MessageHeader::static_encoded_size() &&
            MessageHeader::message_header_test(buffer))
   {
@@ -179,7 +268,18 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
         " processing KaRL message from %s\n",
         print_prefix, remote_host);
 
-    header = new MessageHeader();
+    header = &scratch.message_header;
+  }
+  else if (bytes_read > COMPACT_MADARA_ID_LENGTH &&
+           CompactMessageHeader::compact_message_header_test(buffer))
+  {
+    madara_logger_log(context.get_logger(), logger::LOG_MINOR,
+        "%s:"
+        " processing compact KaRL message from %s\n",
+        print_prefix, remote_host);
+
+    header = &scratch.compact_header;
+    is_compact = true;
   }
   else if (bytes_read >= FragmentMessageHeader::static_encoded_size() &&
            FragmentMessageHeader::fragment_message_header_test(buffer))
@@ -189,7 +289,7 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
         " processing KaRL fragment message from %s\n",
         print_prefix, remote_host);
 
-    header = new FragmentMessageHeader();
+    header = &scratch.fragment_header;
     is_fragment = true;
   }
   else if (bytes_read >= 8 + MADARA_IDENTIFIER_LENGTH)
@@ -223,6 +323,34 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
       " header info: %s\n",
       print_prefix, header->to_string().c_str());
 
+  if (is_compact)
+  {
+    if (buffer_remaining < 0)
+    {
+      madara_logger_log(context.get_logger(), logger::LOG_MAJOR,
+          "%s:"
+          " Compact message header from %s is malformed. Dropping message.\n",
+          print_prefix, remote_host);
+
+      return -1;
+    }
+
+    // the names behind a session are resent every key_id_refresh
+    // messages, so until then the sender is unknown
+    if (header->originator[0] == 0)
+    {
+      madara_logger_log(context.get_logger(), logger::LOG_MINOR,
+          "%s:"
+          " Compact message from %s has unknown session %" PRIu32
+          ". Dropping message.\n",
+          print_prefix, remote_host, scratch.compact_header.session);
+
+      return -1;
+    }
+
+    is_keyed = (scratch.compact_header.flags & CompactMessageHeader::KEYED) != 0;
+  }
+
   if (header->size < bytes_read)
   {
     madara_logger_log(context.get_logger(), logger::LOG_MAJOR,
@@ -278,7 +406,7 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
           " dropping message from untrusted peer (%s\n",
           print_prefix, remote_host);
 
-      // delete the header and continue to the svc loop
+      // continue to the svc loop
       return -3;
     }
 
@@ -309,7 +437,7 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
           " remote id (%s) has an untrusted domain (%s). Dropping message.\n",
           print_prefix, remote_host, header->domain);
 
-      // delete the header and continue to the svc loop
+      // continue to the svc loop
       return -5;
     }
     else
@@ -370,10 +498,21 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
               " processing reduced KaRL message from %s\n",
               print_prefix, remote_host);
 
-          header = new ReducedMessageHeader();
+          header = &scratch.reduced_header;
           is_reduced = true;
           update = header->read(buffer, buffer_remaining);
         }
+        else if (KeyedMessageHeader::keyed_message_header_test(buffer))
+        {
+          madara_logger_log(context.get_logger(), logger::LOG_MINOR,
+              "%s:"
+              " processing keyed KaRL message from %s\n",
+              print_prefix, remote_host);
+
+          header = &scratch.keyed_header;
+          is_keyed = true;
+          update = header->read(buffer, buffer_remaining);
+        }
         else if (MessageHeader::message_header_test(buffer))
         {
           madara_logger_log(context.get_logger(), logger::LOG_MINOR,
@@ -381,7 +520,7 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
               " processing KaRL message from %s\n",
               print_prefix, remote_host);
 
-          header = new MessageHeader();
+          header = &scratch.message_header;
           update = header->read(buffer, buffer_remaining);
         }
 
@@ -390,8 +529,32 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
     }
   }
 
+  // learn the key ids the message defines, even if its updates are not
+  // applied, so that later messages can be read
+  if (is_keyed)
+  {
+    update = scratch.peer_keys.read_definitions(
+        *(KeyedMessageHeader*)header, update, buffer_remaining);
+
+    if (buffer_remaining < 0)
+    {
+      madara_logger_log(context.get_logger(), logger::LOG_MAJOR,
+          "%s:"
+          " Key definitions from %s are malformed. Dropping message.\n",
+          print_prefix, header->originator);
+
+      return -1;
+    }
+  }
+
   int actual_updates = 0;
   uint64_t current_time = utility::get_time();
+
+  // compact messages are only timestamped if the sender has a deadline
+  if (is_compact && header->timestamp == 0)
+  {
+    header->timestamp = current_time;
+  }
   double deadline = settings.get_deadline();
   TransportContext transport_context(TransportContext::RECEIVING_OPERATION,
       receive_monitor.get_bytes_per_second(),
@@ -432,12 +595,6 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
       " iterating over the %" PRIu32 " updates\n",
       print_prefix, header->updates);
 
-  // temporary record for reading from the updates buffer
-  knowledge::KnowledgeRecord record;
-  record.quality = header->quality;
-  record.clock = header->clock;
-  std::string key;
-
   bool dropped = false;
 
   if (send_monitor.is_bandwidth_violated(settings.get_send_bandwidth_limit()))
@@ -474,28 +631,127 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
       " Applying %" PRIu32 " updates\n",
       print_prefix, header->updates);
 
-  const auto add_record = [&](const std::string& key,
-                              knowledge::KnowledgeRecord rec) {
-    auto& entry = updates[key];
-    if (entry.exists())
-    {
-      using std::swap;
-
-      swap(rec, entry);
+  // record filters copy their input, so only call them when they exist
+  const bool record_filters =
+      settings.get_number_of_receive_filtered_types() > 0;
 
-      past_updates[key].emplace_back(std::move(rec));
-    }
-    else
+  // the arrays this sender's patches may apply to, found on first use
+  std::unordered_map<std::string, ReceiveScratch::ArrayBase>* array_bases = 0;
+  const auto peer_array_bases = [&]()
+      -> std::unordered_map<std::string, ReceiveScratch::ArrayBase>& {
+    if (!array_bases)
     {
-      entry = std::move(rec);
+      array_bases = &scratch.array_bases[header->originator];
     }
+    return *array_bases;
   };
 
-  // iterate over the updates
+  // iterate over the updates. Each record is decoded straight into a
+  // reused scratch slot. Arrays and strings are decoded once and are
+  // shared (not copied) by the context when applied.
   for (uint32_t i = 0; i < header->updates; ++i)
   {
+    ReceiveScratch::Update& slot = scratch.next();
+    std::string& key = slot.first;
+    knowledge::KnowledgeRecord& record = slot.second;
+
+    record.quality = header->quality;
+    record.clock = header->clock;
+
+    // a patch is applied to the value it was made against, and the rest
+    // of the loop sees the patched value as any other record
+    if (ArrayPatch::is_patch(update, is_keyed, buffer_remaining))
+    {
+      bool known = true;
+
+      if (is_keyed)
+      {
+        uint32_t key_id = 0;
+        update = scratch.patch.read(update, key_id, buffer_remaining);
+
+        const std::string* found = scratch.peer_keys.get_key(key_id);
+
+        if (found)
+        {
+          key = *found;
+        }
+        else
+        {
+          known = false;
+        }
+      }
+      else
+      {
+        update = scratch.patch.read(update, key, buffer_remaining);
+      }
+
+      bool applied = false;
+
+      // receive filters have already changed the base, and would change
+      // it again along with the patched elements
+      if (known && buffer_remaining >= 0 && !record_filters &&
+          settings.get_number_of_receive_aggregate_filters() == 0)
+      {
+        auto& bases = peer_array_bases();
+        auto base = bases.find(key);
+
+        if (base != bases.end() &&
+            base->second.sent_toi == scratch.patch.base_toi)
+        {
+          knowledge::KnowledgeRecord current =
+              context.get(key, knowledge::KnowledgeReferenceSettings(false));
+
+          applied = current.toi() == base->second.toi &&
+                    scratch.patch.apply(current, record);
+        }
+      }
+
+      if (buffer_remaining >= 0 && !applied)
+      {
+        // we do not have the value the patch was made against. The
+        // sender will send the full value again.
+        madara_logger_log(context.get_logger(), logger::LOG_MINOR,
+            "%s:"
+            " skipping patch of %s @%" PRIu64 " from %s, which needs"
+            " @%" PRIu64 "\n",
+            print_prefix, known ? key.c_str() : "an undefined key id",
+            scratch.patch.toi, header->originator, scratch.patch.base_toi);
+
+        record.reset_value();
+        --scratch.num_updates;
+        continue;
+      }
+    }
     // read converts everything into host format from the update stream
-    update = record.read(update, key, buffer_remaining);
+    else if (is_keyed)
+    {
+      uint32_t key_id = 0;
+      update = record.read(update, key_id, buffer_remaining);
+
+      const std::string* known = scratch.peer_keys.get_key(key_id);
+
+      if (known)
+      {
+        key = *known;
+      }
+      else if (buffer_remaining >= 0)
+      {
+        // the definition was in a message we did not get. The sender
+        // will define the id again.
+        madara_logger_log(context.get_logger(), logger::LOG_MINOR,
+            "%s:"
+            " skipping update with undefined key id %" PRIu32 " from %s\n",
+            print_prefix, key_id, header->originator);
+
+        record.reset_value();
+        --scratch.num_updates;
+        continue;
+      }
+    }
+    else
+    {
+      update = record.read(update, key, buffer_remaining);
+    }
 
     if (buffer_remaining < 0)
     {
@@ -505,10 +761,12 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
           " Server is likely being targeted by custom KaRL tools.\n",
           print_prefix);
 
-      // we do not delete the header as this will be cleaned up later
+      // the partially read record is not applied
+      record.reset_value();
+      --scratch.num_updates;
       break;
     }
-    else
+    else if (record_filters)
     {
       madara_logger_log(context.get_logger(), logger::LOG_MINOR,
           "%s:"
@@ -524,8 +782,6 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
             "%s:"
             " Filter results for %s were %s\n",
             print_prefix, key.c_str(), record.to_string().c_str());
-
-        add_record(key, record);
       }
       else
       {
@@ -549,7 +805,9 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
     for (knowledge::KnowledgeMap::const_iterator i = additionals.begin();
          i != additionals.end(); ++i)
     {
-      add_record(i->first, i->second);
+      ReceiveScratch::Update& slot = scratch.next();
+      slot.first = i->first;
+      slot.second = i->second;
     }
 
     transport_context.clear_records();
@@ -561,16 +819,33 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
     strncpy(header->originator, id.c_str(), sizeof(header->originator) - 1);
   }
 
-  // apply aggregate receive filters
-  if (settings.get_number_of_receive_aggregate_filters() > 0 &&
-      (updates.size() > 0 || header->type == transport::REGISTER))
+  // aggregate filters work on a map of the newest value for each key, so
+  // one is only built when such filters exist. Older values for a key
+  // stay in the scratch and are applied before the newest, unfiltered.
+  const bool aggregate =
+      settings.get_number_of_receive_aggregate_filters() > 0 &&
+      (scratch.num_updates > 0 || header->type == transport::REGISTER);
+
+  if (aggregate)
   {
     madara_logger_log(context.get_logger(), logger::LOG_MAJOR,
         "%s:"
         " Applying aggregate receive filters.\n",
         print_prefix);
 
-    settings.filter_receive(updates, transport_context);
+    for (size_t i = scratch.num_updates; i > 0; --i)
+    {
+      ReceiveScratch::Update& cur = scratch.updates[i - 1];
+
+      if (cur.second.exists() &&
+          scratch.aggregate.find(cur.first) == scratch.aggregate.end())
+      {
+        scratch.aggregate.emplace(cur.first, std::move(cur.second));
+        cur.second.reset_value();
+      }
+    }
+
+    settings.filter_receive(scratch.aggregate, transport_context);
   }
   else
   {
@@ -594,47 +869,59 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
         print_prefix);
 
     uint64_t now = utility::get_time();
-    // apply updates from the update list
-    for (knowledge::KnowledgeMap::iterator i = updates.begin();
-         i != updates.end(); ++i)
-    {
-      const auto apply = [&](knowledge::KnowledgeRecord& record) {
-        int result = 0;
 
-        record.set_toi(now);
-        result = record.apply(
-            context, i->first, header->quality, header->clock, false);
-        ++actual_updates;
+    const auto apply = [&](const std::string& key,
+                           knowledge::KnowledgeRecord& record) {
+      int result = 0;
 
-        if (result != 1)
-        {
-          madara_logger_log(context.get_logger(), logger::LOG_MAJOR,
-              "%s:"
-              " update %s=%s was rejected\n",
-              print_prefix, key.c_str(), record.to_string().c_str());
-        }
-        else
-        {
-          madara_logger_log(context.get_logger(), logger::LOG_MAJOR,
-              "%s:"
-              " update %s=%s was accepted\n",
-              print_prefix, key.c_str(), record.to_string().c_str());
-        }
-      };
+      uint64_t sent_toi = record.toi();
+      record.set_toi(now);
+      result =
+          record.apply(context, key, header->quality, header->clock, false);
+      ++actual_updates;
 
-      auto iter = past_updates.find(i->first);
-      if (iter != past_updates.end())
+      // remember the arrays the sender may send patches of
+      if (result == 1 &&
+          (record.type() == knowledge::KnowledgeRecord::INTEGER_ARRAY ||
+              record.type() == knowledge::KnowledgeRecord::DOUBLE_ARRAY))
       {
-        for (auto& cur : iter->second)
-        {
-          if (cur.exists())
-          {
-            apply(cur);
-          }
-        }
+        ReceiveScratch::ArrayBase& base = peer_array_bases()[key];
+        base.sent_toi = sent_toi;
+        base.toi = now;
       }
 
-      apply(i->second);
+      if (result != 1)
+      {
+        madara_logger_log(context.get_logger(), logger::LOG_MAJOR,
+            "%s:"
+            " update %s=%s was rejected\n",
+            print_prefix, key.c_str(), record.to_string().c_str());
+      }
+      else
+      {
+        madara_logger_log(context.get_logger(), logger::LOG_MAJOR,
+            "%s:"
+            " update %s=%s was accepted\n",
+            print_prefix, key.c_str(), record.to_string().c_str());
+      }
+    };
+
+    // apply updates in the order they were received. Duplicate keys are
+    // applied oldest first, so the newest value wins.
+    for (size_t i = 0; i < scratch.num_updates; ++i)
+    {
+      ReceiveScratch::Update& cur = scratch.updates[i];
+
+      if (cur.second.exists())
+      {
+        apply(cur.first, cur.second);
+      }
+    }
+
+    for (knowledge::KnowledgeMap::iterator i = scratch.aggregate.begin();
+         i != scratch.aggregate.end(); ++i)
+    {
+      apply(i->first, i->second);
     }
   }
 
@@ -649,30 +936,49 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
         " Applying rebroadcast filters to receive results.\n",
         print_prefix);
 
-    // create a list of rebroadcast records from the updates
-    for (knowledge::KnowledgeMap::iterator i = updates.begin();
-         i != updates.end(); ++i)
-    {
-      i->second =
-          settings.filter_rebroadcast(i->second, i->first, transport_context);
+    const auto add_rebroadcast = [&](const std::string& key,
+                                     const knowledge::KnowledgeRecord& record) {
+      knowledge::KnowledgeRecord result =
+          settings.filter_rebroadcast(record, key, transport_context);
 
-      if (i->second.exists())
+      if (result.exists())
       {
-        if (i->second.to_string() != "")
-        {
-          madara_logger_log(context.get_logger(), logger::LOG_MINOR,
-              "%s:"
-              " Filter results for key %s were %s\n",
-              print_prefix, i->first.c_str(), i->second.to_string().c_str());
-        }
-        rebroadcast_records[i->first] = i->second;
+        madara_logger_log(context.get_logger(), logger::LOG_MINOR,
+            "%s:"
+            " Filter results for key %s were %s\n",
+            print_prefix, key.c_str(), result.to_string().c_str());
+
+        rebroadcast_records[key] = std::move(result);
       }
       else
       {
         madara_logger_log(context.get_logger(), logger::LOG_MINOR,
             "%s:"
             " Filter resulted in dropping %s\n",
-            print_prefix, i->first.c_str());
+            print_prefix, key.c_str());
+      }
+    };
+
+    // create a list of rebroadcast records from the newest value of each key
+    if (aggregate)
+    {
+      for (knowledge::KnowledgeMap::iterator i = scratch.aggregate.begin();
+           i != scratch.aggregate.end(); ++i)
+      {
+        add_rebroadcast(i->first, i->second);
+      }
+    }
+    else
+    {
+      for (size_t i = scratch.num_updates; i > 0; --i)
+      {
+        ReceiveScratch::Update& cur = scratch.updates[i - 1];
+
+        if (cur.second.exists() &&
+            rebroadcast_records.find(cur.first) == rebroadcast_records.end())
+        {
+          add_rebroadcast(cur.first, cur.second);
+        }
       }
     }
 
@@ -717,6 +1023,9 @@ int process_received_update(const char* buffer, uint32_t bytes_read,
         print_prefix);
   }
 
+  // values are now shared with the context, so let go of them
+  scratch.release();
+
   // before we send to others, we first execute rules
   if (settings.on_data_received_logic.length() != 0)
   {
@@ -747,6 +1056,17 @@ int prep_rebroadcast(knowledge::ThreadSafeContext& context, char* buffer,
 {
   int result = 0;
 
+  // key ids and compact sessions belong to the originator, so keyed and
+  // compact messages are rebroadcast with strings under a normal header
+  MessageHeader normal_header;
+  if (dynamic_cast<KeyedMessageHeader*>(header))
+  {
+    normal_header = *header;
+    memcpy(normal_header.madara_id, MADARA_IDENTIFIER, 7);
+    normal_header.madara_id[7] = 0;
+    header = &normal_header;
+  }
+
   if (header->ttl > 0 && records.size() > 0 && packet_scheduler.add())
   {
     // keep track of the message_size portion of buffer
@@ -1034,6 +1354,8 @@ long Base::prep_send(const knowledge::KnowledgeMap& orig_updates,
 
   // set the header to the beginning of the buffer
   MessageHeader* header = 0;
+  KeyedMessageHeader* keyed_header = 0;
+  CompactMessageHeader* compact_header = 0;
 
   if (settings_.send_reduced_message_header)
   {
@@ -1045,6 +1367,32 @@ long Base::prep_send(const knowledge::KnowledgeMap& orig_updates,
     header = new ReducedMessageHeader();
     reduced = true;
   }
+  else if (settings_.send_compact_message_header)
+  {
+    madara_logger_log(context_.get_logger(), logger::LOG_MINOR,
+        "%s:"
+        " Preparing message with compact message header.\n",
+        print_prefix);
+
+    compact_header = new CompactMessageHeader();
+    header = compact_header;
+
+    if (settings_.send_key_ids)
+    {
+      compact_header->flags |= CompactMessageHeader::KEYED;
+      keyed_header = compact_header;
+    }
+  }
+  else if (settings_.send_key_ids)
+  {
+    madara_logger_log(context_.get_logger(), logger::LOG_MINOR,
+        "%s:"
+        " Preparing message with keyed message header.\n",
+        print_prefix);
+
+    keyed_header = new KeyedMessageHeader();
+    header = keyed_header;
+  }
   else
   {
     madara_logger_log(context_.get_logger(), logger::LOG_MINOR,
@@ -1081,17 +1429,77 @@ long Base::prep_send(const knowledge::KnowledgeMap& orig_updates,
 
   header->updates = uint32_t(filtered_updates.size());
 
+  // look up the key ids first, as their definitions come before updates
+  if (keyed_header)
+  {
+    key_ids_.start_message(settings_.key_id_refresh);
+    update_key_ids_.clear();
+
+    for (knowledge::KnowledgeMap::const_iterator i = filtered_updates.begin();
+         i != filtered_updates.end(); ++i)
+    {
+      update_key_ids_.push_back(key_ids_.get_id(i->first));
+    }
+
+    keyed_header->epoch = key_ids_.get_epoch();
+    keyed_header->definitions = key_ids_.get_definitions();
+
+    madara_logger_log(context_.get_logger(), logger::LOG_MINOR,
+        "%s:"
+        " Defining %" PRIu32 " of %d key ids.\n",
+        print_prefix, keyed_header->definitions, (int)key_ids_.size());
+  }
+
+  if (compact_header)
+  {
+    // the key id epoch is random per transport, so it doubles as the
+    // session that receivers intern our names under
+    compact_header->session = key_ids_.get_epoch();
+
+    if (compact_messages_ == 0 ||
+        (settings_.key_id_refresh > 0 &&
+            compact_messages_ % settings_.key_id_refresh == 0))
+    {
+      compact_header->flags |= CompactMessageHeader::NAMES;
+    }
+
+    ++compact_messages_;
+
+    // receivers can only enforce deadlines on timestamped messages
+    if (settings_.get_deadline() > 0)
+    {
+      compact_header->flags |= CompactMessageHeader::TIMESTAMP;
+    }
+  }
+
   // compute size of this header
   header->size = header->encoded_size();
 
   // keep track of the maximum buffer size for encoding
   int max_buffer_size = (int)buffer_remaining;
 
-  // set the update to the end of the header
-  char* update = header->write(buffer, buffer_remaining);
+  // set the update to the end of the header. The size of a compact
+  // header depends on the size of the message, so room is left for the
+  // largest one (which is also larger than a full header) and it is
+  // written once the updates are.
+  char* update;
+  if (compact_header)
+  {
+    update = buffer + CompactMessageHeader::MAX_ENCODED_SIZE;
+    buffer_remaining -= CompactMessageHeader::MAX_ENCODED_SIZE;
+  }
+  else
+  {
+    update = header->write(buffer, buffer_remaining);
+  }
   uint64_t* message_size = (uint64_t*)buffer;
   uint32_t* message_updates = (uint32_t*)(buffer + 116);
 
+  if (keyed_header)
+  {
+    update = key_ids_.write_definitions(update, buffer_remaining);
+  }
+
   // Message header format
   // [size|id|domain|originator|type|updates|quality|clock|list of updates]
 
@@ -1112,12 +1520,19 @@ long Base::prep_send(const knowledge::KnowledgeMap& orig_updates,
   // memset(buffer, 0, MAX_PACKET_SIZE);
 
   // Message update format
-  // [key|value]
+  // [key|value], or [key id|value] for keyed messages
+
+  // patches are made against what was sent before, which filters may
+  // have changed
+  const bool deltas = settings_.send_deltas &&
+                      settings_.get_number_of_send_filtered_types() == 0 &&
+                      settings_.get_number_of_send_aggregate_filters() == 0;
 
   int j = 0;
   uint32_t actual_updates = 0;
+  size_t k = 0;
   for (knowledge::KnowledgeMap::const_iterator i = filtered_updates.begin();
-       i != filtered_updates.end(); ++i)
+       i != filtered_updates.end(); ++i, ++k)
   {
     const auto& key = i->first;
     const auto& rec = i->second;
@@ -1131,7 +1546,14 @@ long Base::prep_send(const knowledge::KnowledgeMap& orig_updates,
         return;
       }
 
-      update = rec.write(update, key, buffer_remaining);
+      if (keyed_header)
+      {
+        update = rec.write(update, update_key_ids_[k], buffer_remaining);
+      }
+      else
+      {
+        update = rec.write(update, key, buffer_remaining);
+      }
 
       if (buffer_remaining > 0)
       {
@@ -1153,7 +1575,54 @@ long Base::prep_send(const knowledge::KnowledgeMap& orig_updates,
       }
     };
 
-    if (!settings_.send_history || !rec.has_history())
+    if (deltas && !rec.has_history() &&
+        (rec.type() == knowledge::KnowledgeRecord::INTEGER_ARRAY ||
+            rec.type() == knowledge::KnowledgeRecord::DOUBLE_ARRAY))
+    {
+      DeltaState& state = deltas_[key];
+
+      // send the elements that changed since the array was last sent,
+      // unless the full value is due or the patch would not be smaller
+      if (state.toi != 0 &&
+          (settings_.delta_refresh == 0 ||
+              state.patches < settings_.delta_refresh) &&
+          context_.get_index_changes(key, state.toi, rec.toi(),
+              delta_ranges_) &&
+          !delta_ranges_.empty() &&
+          ArrayPatch::encoded_size(delta_ranges_) <
+              (int64_t)rec.get_encoded_size())
+      {
+        if (keyed_header)
+        {
+          update = ArrayPatch::write(update, update_key_ids_[k], rec,
+              state.toi, delta_ranges_, buffer_remaining);
+        }
+        else
+        {
+          update = ArrayPatch::write(
+              update, key, rec, state.toi, delta_ranges_, buffer_remaining);
+        }
+
+        madara_logger_log(context_.get_logger(), logger::LOG_MINOR,
+            "%s:"
+            " update[%d] => encoding %d ranges of %s of size %" PRIu32
+            " @%" PRIu64 " as a patch of @%" PRIu64 "\n",
+            print_prefix, j, (int)delta_ranges_.size(), key.c_str(),
+            rec.size(), rec.toi(), state.toi);
+
+        ++state.patches;
+        ++actual_updates;
+        ++j;
+      }
+      else
+      {
+        do_write(rec);
+        state.patches = 0;
+      }
+
+      state.toi = rec.toi();
+    }
+    else if (!settings_.send_history || !rec.has_history())
     {
       do_write(rec);
     }
@@ -1182,10 +1651,48 @@ long Base::prep_send(const knowledge::KnowledgeMap& orig_updates,
   if (buffer_remaining > 0)
   {
     size = (long)(settings_.queue_length - buffer_remaining);
-    header->size = size;
-    *message_size = utility::endian_swap((uint64_t)size);
-    header->updates = actual_updates;
-    *message_updates = utility::endian_swap(actual_updates);
+
+    if (compact_header)
+    {
+      // write the header right before the updates and move both to the
+      // front. Fragments need a full header, so messages too large to
+      // send whole get one instead.
+      char* payload = buffer + CompactMessageHeader::MAX_ENCODED_SIZE;
+      uint64_t payload_size = size - CompactMessageHeader::MAX_ENCODED_SIZE;
+      int64_t header_remaining = CompactMessageHeader::MAX_ENCODED_SIZE;
+      char* start;
+
+      compact_header->updates = actual_updates;
+      compact_header->set_payload_size(payload_size);
+
+      if (compact_header->size > settings_.max_fragment_size)
+      {
+        compact_header->size =
+            payload_size + compact_header->full_encoded_size();
+        start = payload - compact_header->full_encoded_size();
+        compact_header->write_full(start, header_remaining);
+
+        if (compact_header->flags & CompactMessageHeader::NAMES)
+        {
+          compact_messages_ = 0;
+        }
+      }
+      else
+      {
+        start = payload - compact_header->encoded_size();
+        compact_header->write(start, header_remaining);
+      }
+
+      size = (long)compact_header->size;
+      memmove(buffer, start, size);
+    }
+    else
+    {
+      header->size = size;
+      *message_size = utility::endian_swap((uint64_t)size);
+      header->updates = actual_updates;
+      *message_updates = utility::endian_swap(actual_updates);
+    }
 
     // before we send to others, we first execute rules
     if (settings_.on_data_received_logic.length() != 0)
@@ -16,6 +16,7 @@
 #include <string>
 #include <sstream>
 #include <vector>
+#include <unordered_map>
 #include <ostream>
 
 #include "madara/utility/ThreadSafeVector.h"
@@ -23,6 +24,11 @@
 #include "madara/transport/QoSTransportSettings.h"
 
 #include "ReducedMessageHeader.h"
+#include "KeyedMessageHeader.h"
+#include "KeyDictionary.h"
+#include "CompactMessageHeader.h"
+#include "ArrayPatch.h"
+#include "madara/transport/Fragmentation.h"
 #include "madara/transport/BandwidthMonitor.h"
 #include "madara/transport/PacketScheduler.h"
 
@@ -154,6 +160,112 @@ protected:
 
   /// Latest TOI the previous send operation included
   uint64_t last_toi_sent_ = 0;
+
+  /// ids of the keys sent, if settings_.send_key_ids
+  KeyDictionary key_ids_;
+
+  /// the id of each update in the message being sent
+  std::vector<uint32_t> update_key_ids_;
+
+  /// compact messages sent, to know when to resend the names
+  uint64_t compact_messages_ = 0;
+
+  /// what was last sent of an array, if settings_.send_deltas
+  struct DeltaState
+  {
+    /// the toi of the value sent
+    uint64_t toi = 0;
+
+    /// patches sent since the full value was
+    uint32_t patches = 0;
+  };
+
+  /// the arrays sent, by key
+  std::unordered_map<std::string, DeltaState> deltas_;
+
+  /// reused for the ranges of each patch
+  knowledge::IndexRanges delta_ranges_;
+};
+
+/**
+ * @class ReceiveScratch
+ * @brief Storage reused by process_received_update across packets. A
+ *        receive thread should own one of these and pass it to every
+ *        call, so that message headers, keys and the list of decoded
+ *        updates are not reallocated for each packet. Not thread-safe.
+ **/
+class MADARA_EXPORT ReceiveScratch
+{
+public:
+  /// a decoded key and record
+  typedef std::pair<std::string, knowledge::KnowledgeRecord> Update;
+
+  /**
+   * Constructor
+   **/
+  ReceiveScratch();
+
+  /**
+   * Releases the values held by the decoded updates. Key strings and
+   * slots are kept for reuse.
+   **/
+  void release(void);
+
+  /**
+   * Returns the next unused update slot, growing the list if necessary
+   * @return  a slot whose key and record should be overwritten
+   **/
+  Update& next(void);
+
+  /// header for standard messages
+  MessageHeader message_header;
+
+  /// header for reduced messages
+  ReducedMessageHeader reduced_header;
+
+  /// header for fragments
+  FragmentMessageHeader fragment_header;
+
+  /// header for messages keyed by ids
+  KeyedMessageHeader keyed_header;
+
+  /// the key ids defined by each sender of keyed messages
+  PeerKeyDictionaries peer_keys;
+
+  /// header for compact messages, which looks up interned_names
+  CompactMessageHeader compact_header;
+
+  /// the originator and domain behind each compact message session
+  InternedNames interned_names;
+
+  /// the last array patch read
+  ArrayPatch patch;
+
+  /// what was last applied of an array from a sender
+  struct ArrayBase
+  {
+    /// the toi the sender gave the value
+    uint64_t sent_toi = 0;
+
+    /// the toi the value was applied with, as receivers stamp their own
+    uint64_t toi = 0;
+  };
+
+  /// the arrays applied from each sender, by originator and key. A patch
+  /// only applies to the value its sender sent before, and only if
+  /// nothing else has changed that value since.
+  std::unordered_map<std::string,
+      std::unordered_map<std::string, ArrayBase>>
+      array_bases;
+
+  /// decoded updates in the order they were received
+  std::vector<Update> updates;
+
+  /// number of slots in updates that belong to the current packet
+  size_t num_updates;
+
+  /// newest value of each key, only used by aggregate receive filters
+  knowledge::KnowledgeMap aggregate;
 };
 
 /**
@@ -199,6 +311,52 @@ int MADARA_EXPORT process_received_update(const char* buffer,
 
     const char* print_prefix, const char* remote_host, MessageHeader*& header);
 
+/**
+ * Processes a received update like the method above, but decodes into
+ * storage that is reused across calls. Records are decoded directly from
+ * the buffer into the scratch and shared with the context when applied,
+ * so each value is copied out of the buffer once.
+ *
+ * @param  buffer           buffer containing all serialized updates
+ * @param   bytes_read       bytes in the buffer
+ * @param  id               unique identifier for originator strings
+ * @param  context          variable context of the knowledge base
+ * @param  settings         transport settings
+ * @param  send_monitor     monitor of send traffic
+ * @param  receive_monitor  monitor of receive traffice
+ * @param  rebroadcast_records  map of variables to records to be
+ *                              rebroadcasted (will be filled in by this
+ *                              method)
+ * @param  remote_host      ip:port who actually sent this message
+ * @param  on_data_received compiled expression tree of the
+ *                          settings.on_data_received_logic (you have to
+ *                          provide the compiled tree)
+ * @param  print_prefix     prefix to include before every log message,
+ *                          e.g., "MyTransport::svc"
+ * @param  scratch          storage reused between calls
+ * @param  header           will point to the message header inside
+ *                          scratch. Valid until scratch is next used.
+ *                          Do not delete.
+ * @return       -1   Rejected: Non-MADARA Message<br />
+ *               -2   Rejected: Message from Self<br />
+ *               -3   Rejected: Untrusted Peer<br />
+ *               -4   Rejected: Untrusted Originator<br />
+ *               -5   Rejected: Wrong domain<br />
+ *               >=   Number of accepted updates
+ **/
+int MADARA_EXPORT process_received_update(const char* buffer,
+    uint32_t bytes_read, const std::string& id,
+    knowledge::ThreadSafeContext& context, const QoSTransportSettings& settings,
+    BandwidthMonitor& send_monitor, BandwidthMonitor& receive_monitor,
+    knowledge::KnowledgeMap& rebroadcast_records,
+#ifndef _MADARA_NO_KARL_
+
+    knowledge::CompiledExpression& on_data_received,
+#endif  // _MADARA_NO_KARL_
+
+    const char* print_prefix, const char* remote_host, ReceiveScratch& scratch,
+    MessageHeader*& header);
+
 /**
  * Preps a buffer for rebroadcasting records to other agents
  * on the network.
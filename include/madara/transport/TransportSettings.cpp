@@ -27,7 +27,7 @@ std::string madara::transport::types_to_string(int id)
   }
   if (TCP == id)
   {
-    return "TCP (unsupported)";
+    return "TCP";
   }
   if (MULTICAST == id)
   {
@@ -49,6 +49,10 @@ std::string madara::transport::types_to_string(int id)
   {
     return "0MQ";
   }
+  if (SHMEM == id)
+  {
+    return "Shared Memory";
+  }
 
   // otherwise, it's a custom transport
   return "Custom";
@@ -70,14 +74,24 @@ madara::transport::TransportSettings::TransportSettings(
     delay_launch(settings.delay_launch),
     never_exit(settings.never_exit),
     send_reduced_message_header(settings.send_reduced_message_header),
+    send_key_ids(settings.send_key_ids),
+    key_id_refresh(settings.key_id_refresh),
+    send_compact_message_header(settings.send_compact_message_header),
+    send_deltas(settings.send_deltas),
+    delta_refresh(settings.delta_refresh),
     slack_time(settings.slack_time),
     read_thread_hertz(settings.read_thread_hertz),
     max_send_hertz(settings.max_send_hertz),
+    batch_datagrams(settings.batch_datagrams),
     hosts(),
     no_sending(settings.no_sending),
     no_receiving(settings.no_receiving),
     send_history(settings.send_history),
     debug_to_kb_prefix(settings.debug_to_kb_prefix),
+    send_async(settings.send_async),
+    send_queue_length(settings.send_queue_length),
+    send_queue_policy(settings.send_queue_policy),
+    send_queue_timeout(settings.send_queue_timeout),
     read_domains_(settings.read_domains_)
 {
   hosts.resize(settings.hosts.size());
@@ -105,9 +119,15 @@ void madara::transport::TransportSettings::operator=(
   never_exit = settings.never_exit;
 
   send_reduced_message_header = settings.send_reduced_message_header;
+  send_key_ids = settings.send_key_ids;
+  key_id_refresh = settings.key_id_refresh;
+  send_compact_message_header = settings.send_compact_message_header;
+  send_deltas = settings.send_deltas;
+  delta_refresh = settings.delta_refresh;
   slack_time = settings.slack_time;
   read_thread_hertz = settings.read_thread_hertz;
   max_send_hertz = settings.max_send_hertz;
+  batch_datagrams = settings.batch_datagrams;
 
   hosts.resize(settings.hosts.size());
   for (unsigned int i = 0; i < settings.hosts.size(); ++i)
@@ -119,6 +139,11 @@ void madara::transport::TransportSettings::operator=(
   send_history = settings.send_history;
 
   debug_to_kb_prefix = settings.debug_to_kb_prefix;
+
+  send_async = settings.send_async;
+  send_queue_length = settings.send_queue_length;
+  send_queue_policy = settings.send_queue_policy;
+  send_queue_timeout = settings.send_queue_timeout;
 }
 
 madara::transport::TransportSettings::~TransportSettings()
@@ -161,9 +186,18 @@ void madara::transport::TransportSettings::load(
 
   send_reduced_message_header =
       knowledge.get(prefix + ".send_reduced_message_header").is_true();
+  send_key_ids = knowledge.get(prefix + ".send_key_ids").is_true();
+  key_id_refresh =
+      (uint32_t)knowledge.get(prefix + ".key_id_refresh").to_integer();
+  send_compact_message_header =
+      knowledge.get(prefix + ".send_compact_message_header").is_true();
+  send_deltas = knowledge.get(prefix + ".send_deltas").is_true();
+  delta_refresh =
+      (uint32_t)knowledge.get(prefix + ".delta_refresh").to_integer();
   slack_time = knowledge.get(prefix + ".slack_time").to_double();
   read_thread_hertz = knowledge.get(prefix + ".read_thread_hertz").to_double();
   max_send_hertz = knowledge.get(prefix + ".max_send_hertz").to_double();
+  batch_datagrams = knowledge.get(prefix + ".batch_datagrams").is_true();
 
   containers::StringVector kb_hosts(prefix + ".hosts", knowledge);
 
@@ -185,6 +219,14 @@ void madara::transport::TransportSettings::load(
   no_receiving = knowledge.get(prefix + ".no_receiving").is_true();
   debug_to_kb_prefix =
       knowledge.get(prefix + ".debug_to_kb_prefix").to_string();
+
+  send_async = knowledge.get(prefix + ".send_async").is_true();
+  send_queue_length =
+      (uint32_t)knowledge.get(prefix + ".send_queue_length").to_integer();
+  send_queue_policy =
+      (uint32_t)knowledge.get(prefix + ".send_queue_policy").to_integer();
+  send_queue_timeout =
+      knowledge.get(prefix + ".send_queue_timeout").to_double();
 }
 
 void madara::transport::TransportSettings::load_text(
@@ -214,9 +256,18 @@ void madara::transport::TransportSettings::load_text(
 
   send_reduced_message_header =
       knowledge.get(prefix + ".send_reduced_message_header").is_true();
+  send_key_ids = knowledge.get(prefix + ".send_key_ids").is_true();
+  key_id_refresh =
+      (uint32_t)knowledge.get(prefix + ".key_id_refresh").to_integer();
+  send_compact_message_header =
+      knowledge.get(prefix + ".send_compact_message_header").is_true();
+  send_deltas = knowledge.get(prefix + ".send_deltas").is_true();
+  delta_refresh =
+      (uint32_t)knowledge.get(prefix + ".delta_refresh").to_integer();
   slack_time = knowledge.get(prefix + ".slack_time").to_double();
   read_thread_hertz = knowledge.get(prefix + ".read_thread_hertz").to_double();
   max_send_hertz = knowledge.get(prefix + ".max_send_hertz").to_double();
+  batch_datagrams = knowledge.get(prefix + ".batch_datagrams").is_true();
 
   containers::StringVector kb_hosts(prefix + ".hosts", knowledge);
 
@@ -238,6 +289,14 @@ void madara::transport::TransportSettings::load_text(
   no_receiving = knowledge.get(prefix + ".no_receiving").is_true();
   debug_to_kb_prefix =
       knowledge.get(prefix + ".debug_to_kb_prefix").to_string();
+
+  send_async = knowledge.get(prefix + ".send_async").is_true();
+  send_queue_length =
+      (uint32_t)knowledge.get(prefix + ".send_queue_length").to_integer();
+  send_queue_policy =
+      (uint32_t)knowledge.get(prefix + ".send_queue_policy").to_integer();
+  send_queue_timeout =
+      knowledge.get(prefix + ".send_queue_timeout").to_double();
 }
 
 void madara::transport::TransportSettings::save(
@@ -269,9 +328,16 @@ void madara::transport::TransportSettings::save(
 
   knowledge.set(prefix + ".send_reduced_message_header",
       Integer(send_reduced_message_header));
+  knowledge.set(prefix + ".send_key_ids", Integer(send_key_ids));
+  knowledge.set(prefix + ".key_id_refresh", Integer(key_id_refresh));
+  knowledge.set(prefix + ".send_compact_message_header",
+      Integer(send_compact_message_header));
+  knowledge.set(prefix + ".send_deltas", Integer(send_deltas));
+  knowledge.set(prefix + ".delta_refresh", Integer(delta_refresh));
   knowledge.set(prefix + ".slack_time", slack_time);
   knowledge.set(prefix + ".read_thread_hertz", read_thread_hertz);
   knowledge.set(prefix + ".max_send_hertz", max_send_hertz);
+  knowledge.set(prefix + ".batch_datagrams", Integer(batch_datagrams));
 
   for (size_t i = 0; i < hosts.size(); ++i)
     kb_hosts.set(i, hosts[i]);
@@ -280,6 +346,11 @@ void madara::transport::TransportSettings::save(
   knowledge.set(prefix + ".no_receiving", Integer(no_receiving));
   knowledge.set(prefix + ".debug_to_kb_prefix", debug_to_kb_prefix);
 
+  knowledge.set(prefix + ".send_async", Integer(send_async));
+  knowledge.set(prefix + ".send_queue_length", Integer(send_queue_length));
+  knowledge.set(prefix + ".send_queue_policy", Integer(send_queue_policy));
+  knowledge.set(prefix + ".send_queue_timeout", send_queue_timeout);
+
   knowledge::containers::Map kb_read_domains(
       prefix + ".read_domains", knowledge);
   for (std::map<std::string, int>::const_iterator i = read_domains_.begin();
@@ -321,9 +392,16 @@ void madara::transport::TransportSettings::save_text(
 
   knowledge.set(prefix + ".send_reduced_message_header",
       Integer(send_reduced_message_header));
+  knowledge.set(prefix + ".send_key_ids", Integer(send_key_ids));
+  knowledge.set(prefix + ".key_id_refresh", Integer(key_id_refresh));
+  knowledge.set(prefix + ".send_compact_message_header",
+      Integer(send_compact_message_header));
+  knowledge.set(prefix + ".send_deltas", Integer(send_deltas));
+  knowledge.set(prefix + ".delta_refresh", Integer(delta_refresh));
   knowledge.set(prefix + ".slack_time", slack_time);
   knowledge.set(prefix + ".read_thread_hertz", read_thread_hertz);
   knowledge.set(prefix + ".max_send_hertz", max_send_hertz);
+  knowledge.set(prefix + ".batch_datagrams", Integer(batch_datagrams));
 
   for (size_t i = 0; i < hosts.size(); ++i)
     kb_hosts.set(i, hosts[i]);
@@ -332,6 +410,11 @@ void madara::transport::TransportSettings::save_text(
   knowledge.set(prefix + ".no_receiving", Integer(no_receiving));
   knowledge.set(prefix + ".debug_to_kb_prefix", debug_to_kb_prefix);
 
+  knowledge.set(prefix + ".send_async", Integer(send_async));
+  knowledge.set(prefix + ".send_queue_length", Integer(send_queue_length));
+  knowledge.set(prefix + ".send_queue_policy", Integer(send_queue_policy));
+  knowledge.set(prefix + ".send_queue_timeout", send_queue_timeout);
+
   knowledge::containers::Map kb_read_domains(
       prefix + ".read_domains", knowledge);
   for (std::map<std::string, int>::const_iterator i = read_domains_.begin();
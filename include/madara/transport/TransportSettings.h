@@ -45,7 +45,8 @@ enum Types
   BROADCAST = 6,
   REGISTRY_SERVER = 7,
   REGISTRY_CLIENT = 8,
-  ZMQ = 9
+  ZMQ = 9,
+  SHMEM = 10
 };
 
 enum Reliabilities
@@ -66,6 +67,12 @@ enum Messages
   VOTE = 20
 };
 
+enum SendQueuePolicies
+{
+  SEND_QUEUE_BLOCK = 0,
+  SEND_QUEUE_DROP = 1
+};
+
 /**
  * Converts a transport type enum to a string equivalent
  * @param id  the id of the type to retrieve
@@ -259,6 +266,43 @@ public:
   /// Send a reduced message header (clock, size, updates, KaRL id)
   bool send_reduced_message_header = false;
 
+  /**
+   * Send updates with 32 bit key ids instead of key strings. Each key's
+   * id is defined in the first message that has the key and again every
+   * key_id_refresh messages, so receivers that missed a definition learn
+   * it. All receivers must support keyed messages. Not used with
+   * send_reduced_message_header.
+   **/
+  bool send_key_ids = false;
+
+  /// Messages between definitions of a key id, or of the names behind
+  /// a compact header's session. 0 defines each once.
+  uint32_t key_id_refresh = 100;
+
+  /**
+   * Send a compact header of varints, with the originator and domain
+   * replaced by a session id after they have been sent, and optional
+   * fields left out when they hold their defaults. Receivers detect it
+   * on their own. Messages that would be fragmented are sent with a full
+   * header instead. Not supported by TCP, which frames by the full header.
+   **/
+  bool send_compact_message_header = false;
+
+  /**
+   * Send only the elements of an integer or double array that set_index
+   * changed since the array was last sent, as a patch against the value
+   * sent before. Receivers that do not hold that value, or that filter
+   * what they receive, drop the patch and catch up when the full value
+   * is sent again, every delta_refresh sends of the array. All receivers
+   * must support patches. Not used for records with history or when
+   * send filters are set.
+   **/
+  bool send_deltas = false;
+
+  /// Patches sent between full values of an array. 0 sends the full value
+  /// only when no patch can be made.
+  uint32_t delta_refresh = 10;
+
   /// Map of fragments received by originator
   mutable OriginatorFragmentMap fragment_map;
 
@@ -280,6 +324,14 @@ public:
    **/
   double max_send_hertz = 0.0;
 
+  /**
+   * if true, UDP-based transports hand every fragment for every host to
+   * the OS in one system call and drain several datagrams per read, on
+   * platforms that support it (sendmmsg/recvmmsg). Sends that use
+   * max_send_hertz or slack_time are never batched.
+   **/
+  bool batch_datagrams = true;
+
   /**
    * Host information for transports that require it. The format of these
    * is transport specific, but for UDP, you might have "localhost:1234"
@@ -310,6 +362,31 @@ public:
    **/
   std::string debug_to_kb_prefix = "";
 
+  /**
+   * if true, updates are handed to a dedicated sender thread instead of
+   * being sent from the thread that modified the knowledge
+   **/
+  bool send_async = false;
+
+  /**
+   * maximum number of distinct records waiting for the sender thread.
+   * Updates to records that are already waiting replace the pending
+   * value and do not count against this limit.
+   **/
+  uint32_t send_queue_length = 10000;
+
+  /**
+   * what to do with new records when the send queue is full. See
+   * SendQueuePolicies
+   **/
+  uint32_t send_queue_policy = SEND_QUEUE_BLOCK;
+
+  /**
+   * maximum seconds a SEND_QUEUE_BLOCK send waits for room in the queue
+   * before dropping the records that do not fit
+   **/
+  double send_queue_timeout = 1.0;
+
 private:
   /**
    * Any acceptable read domain is added here
@@ -333,7 +410,7 @@ inline std::string type_name(const TransportSettings& settings)
       name = "RTI DDS";
       break;
     case 3:
-      name = "TCP (unsupported)";
+      name = "TCP";
       break;
     case 4:
       name = "UDP Unicast";
@@ -353,6 +430,9 @@ inline std::string type_name(const TransportSettings& settings)
     case 9:
       name = "ZeroMQ Pub/Sub";
       break;
+    case 10:
+      name = "Shared Memory";
+      break;
   }
 
   return name;
@@ -166,7 +166,7 @@ void madara::transport::NddsListener::on_data_available(DDSDataReader* reader)
             (char*)update_data_list[i].buffer.get_contiguous_buffer(),
             update_data_list[i].buffer.length(), id_, *context_, settings_,
             send_monitor_, receive_monitor_, rebroadcast_records,
-            on_data_received_, print_prefix, "", header);
+            on_data_received_, print_prefix, "", scratch_, header);
       }
     }
   }
@@ -87,6 +87,9 @@ private:
   /// buffer for receiving
   utility::ScopedArray<char> buffer_;
 
+  /// storage reused when decoding received packets
+  ReceiveScratch scratch_;
+
   /// monitor for sending bandwidth usage
   BandwidthMonitor& send_monitor_;
 
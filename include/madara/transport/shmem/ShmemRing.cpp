@@ -0,0 +1,480 @@
+#include "madara/transport/shmem/ShmemRing.h"
+
+#ifdef _MADARA_USE_SHMEM_
+
+#include <new>
+#include <thread>
+#include <chrono>
+
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <climits>
+#include <time.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+namespace madara
+{
+namespace transport
+{
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+    "shared memory rings need lock-free atomics");
+
+/// marks the control block as initialized
+static const uint32_t ring_magic = 0x4d524e47;  // "MRNG"
+
+/// bumped when the layout changes
+static const uint32_t ring_version = 1;
+
+/// record length that tells readers to continue at the start of the ring
+static const uint64_t wrap_marker = ~(uint64_t)0;
+
+/// bytes reserved for the control block, so messages start on a cache line
+static const size_t control_size = 128;
+
+struct ShmemRing::Control
+{
+  /// ring_magic once the writer has initialized the ring
+  std::atomic<uint32_t> magic;
+
+  /// ring_version
+  uint32_t version;
+
+  /// bytes of messages after the control block
+  uint64_t capacity;
+
+  /// end of the message being written
+  std::atomic<uint64_t> reserved;
+
+  /// end of the last complete message
+  std::atomic<uint64_t> published;
+
+  /// futex word, bumped after every message
+  std::atomic<uint32_t> notify;
+
+  /// readers sleeping on notify
+  std::atomic<uint32_t> waiters;
+
+  /// nonzero once the writer closed the ring
+  std::atomic<uint32_t> closed;
+};
+
+namespace
+{
+/// messages are stored 8-byte aligned, behind an 8-byte length
+inline uint64_t record_size(uint64_t size)
+{
+  return sizeof(uint64_t) + ((size + 7) & ~(uint64_t)7);
+}
+
+inline std::string segment_name(const std::string& name)
+{
+  return name.size() > 0 && name[0] == '/' ? name : "/" + name;
+}
+
+#ifdef __linux__
+inline void futex_wait(std::atomic<uint32_t>* word, uint32_t value,
+    double timeout)
+{
+  struct timespec ts;
+  ts.tv_sec = (time_t)timeout;
+  ts.tv_nsec = (long)((timeout - (double)ts.tv_sec) * 1000000000);
+
+  syscall(SYS_futex, (uint32_t*)word, FUTEX_WAIT, value, &ts, nullptr, 0);
+}
+
+inline void futex_wake(std::atomic<uint32_t>* word)
+{
+  syscall(SYS_futex, (uint32_t*)word, FUTEX_WAKE, INT_MAX, nullptr, nullptr,
+      0);
+}
+#endif
+}
+
+ShmemRing::ShmemRing()
+  : fd_(-1),
+    mapping_(nullptr),
+    mapping_size_(0),
+    control_(nullptr),
+    data_(nullptr),
+    writer_(false),
+    position_(0),
+    device_(0),
+    inode_(0)
+{
+  static_assert(sizeof(Control) <= control_size,
+      "the control block must fit before the messages");
+}
+
+ShmemRing::~ShmemRing()
+{
+  close();
+}
+
+bool ShmemRing::map(size_t size)
+{
+  void* mapping =
+      mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+
+  if (mapping == MAP_FAILED)
+  {
+    return false;
+  }
+
+  struct stat info;
+  if (fstat(fd_, &info) == 0)
+  {
+    device_ = info.st_dev;
+    inode_ = info.st_ino;
+  }
+
+  mapping_ = mapping;
+  mapping_size_ = size;
+  control_ = (Control*)mapping;
+  data_ = (char*)mapping + control_size;
+
+  return true;
+}
+
+bool ShmemRing::create(const std::string& name, size_t capacity)
+{
+  close();
+
+  name_ = segment_name(name);
+  writer_ = true;
+
+  uint64_t ring_capacity = (capacity + 7) & ~(uint64_t)7;
+  if (ring_capacity < 4096)
+    ring_capacity = 4096;
+
+  size_t size = control_size + (size_t)ring_capacity;
+
+  fd_ = shm_open(name_.c_str(), O_CREAT | O_RDWR, 0666);
+
+  if (fd_ < 0)
+  {
+    return false;
+  }
+
+  struct stat info;
+  if (fstat(fd_, &info) != 0)
+  {
+    close();
+    return false;
+  }
+
+  if ((size_t)info.st_size == size)
+  {
+    // a previous writer's ring, which its readers may still be reading
+    if (!map(size))
+    {
+      close();
+      return false;
+    }
+
+    if (control_->magic.load() == ring_magic &&
+        control_->version == ring_version &&
+        control_->capacity == ring_capacity)
+    {
+      position_ = control_->published.load();
+      control_->reserved.store(position_);
+      control_->closed.store(0);
+
+      return true;
+    }
+
+    munmap(mapping_, mapping_size_);
+    mapping_ = nullptr;
+  }
+  else if (info.st_size != 0)
+  {
+    // a ring of another size. Readers of the old one notice the new inode
+    ::close(fd_);
+    shm_unlink(name_.c_str());
+
+    fd_ = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0666);
+
+    if (fd_ < 0)
+    {
+      close();
+      return false;
+    }
+  }
+
+  if (ftruncate(fd_, (off_t)size) != 0 || !map(size))
+  {
+    close();
+    return false;
+  }
+
+  Control* control = new (mapping_) Control;
+  control->version = ring_version;
+  control->capacity = ring_capacity;
+  control->reserved.store(0);
+  control->published.store(0);
+  control->notify.store(0);
+  control->waiters.store(0);
+  control->closed.store(0);
+  control->magic.store(ring_magic, std::memory_order_release);
+
+  position_ = 0;
+
+  return true;
+}
+
+bool ShmemRing::open(const std::string& name)
+{
+  close();
+
+  name_ = segment_name(name);
+  writer_ = false;
+
+  fd_ = shm_open(name_.c_str(), O_RDWR, 0666);
+
+  if (fd_ < 0)
+  {
+    return false;
+  }
+
+  struct stat info;
+  if (fstat(fd_, &info) != 0 || (size_t)info.st_size <= control_size ||
+      !map((size_t)info.st_size))
+  {
+    close();
+    return false;
+  }
+
+  if (control_->magic.load(std::memory_order_acquire) != ring_magic ||
+      control_->version != ring_version ||
+      control_->capacity + control_size > mapping_size_ ||
+      control_->closed.load() != 0)
+  {
+    close();
+    return false;
+  }
+
+  position_ = control_->published.load();
+
+  return true;
+}
+
+void ShmemRing::close(void)
+{
+  if (mapping_)
+  {
+    if (writer_)
+    {
+      control_->closed.store(1);
+      control_->notify.fetch_add(1);
+
+#ifdef __linux__
+      futex_wake(&control_->notify);
+#endif
+    }
+
+    munmap(mapping_, mapping_size_);
+
+    if (writer_)
+    {
+      shm_unlink(name_.c_str());
+    }
+  }
+
+  if (fd_ >= 0)
+  {
+    ::close(fd_);
+  }
+
+  fd_ = -1;
+  mapping_ = nullptr;
+  mapping_size_ = 0;
+  control_ = nullptr;
+  data_ = nullptr;
+}
+
+bool ShmemRing::is_open(void) const
+{
+  return mapping_ != nullptr;
+}
+
+size_t ShmemRing::capacity(void) const
+{
+  return control_ ? (size_t)control_->capacity : 0;
+}
+
+bool ShmemRing::write(const char* buffer, size_t size)
+{
+  const uint64_t capacity = control_->capacity;
+  const uint64_t record = record_size(size);
+
+  if (record > capacity)
+  {
+    return false;
+  }
+
+  uint64_t offset = position_ % capacity;
+  uint64_t remaining = capacity - offset;
+  uint64_t end = position_ + record;
+
+  if (record > remaining)
+  {
+    end += remaining;
+  }
+
+  // readers discard anything they copied from below end - capacity
+  control_->reserved.store(end, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  if (record > remaining)
+  {
+    memcpy(data_ + offset, &wrap_marker, sizeof(uint64_t));
+    offset = 0;
+  }
+
+  uint64_t length = size;
+  memcpy(data_ + offset, &length, sizeof(uint64_t));
+  memcpy(data_ + offset + sizeof(uint64_t), buffer, size);
+
+  position_ = end;
+  control_->published.store(end, std::memory_order_release);
+
+  control_->notify.fetch_add(1);
+
+#ifdef __linux__
+  if (control_->waiters.load() > 0)
+  {
+    futex_wake(&control_->notify);
+  }
+#endif
+
+  return true;
+}
+
+int ShmemRing::read(std::vector<char>& buffer)
+{
+  const uint64_t capacity = control_->capacity;
+
+  for (;;)
+  {
+    uint64_t published = control_->published.load(std::memory_order_acquire);
+
+    if (published == position_)
+    {
+      return READ_EMPTY;
+    }
+
+    if (published < position_ || published - position_ > capacity)
+    {
+      // lapped by the writer, or the ring was reset
+      position_ = published;
+      return READ_LOST;
+    }
+
+    uint64_t offset = position_ % capacity;
+    uint64_t length;
+    memcpy(&length, data_ + offset, sizeof(uint64_t));
+
+    bool wrapped = length == wrap_marker;
+
+    if (!wrapped && length <= capacity - offset - sizeof(uint64_t))
+    {
+      buffer.resize((size_t)length);
+      memcpy(buffer.data(), data_ + offset + sizeof(uint64_t), (size_t)length);
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    if (control_->reserved.load(std::memory_order_relaxed) >
+        position_ + capacity)
+    {
+      // the writer overwrote what we were copying
+      position_ = control_->published.load(std::memory_order_acquire);
+      return READ_LOST;
+    }
+
+    if (wrapped)
+    {
+      position_ += capacity - offset;
+      continue;
+    }
+
+    if (length > capacity - offset - sizeof(uint64_t))
+    {
+      // cannot happen unless the segment is corrupt
+      position_ = published;
+      return READ_LOST;
+    }
+
+    position_ += record_size(length);
+    return READ_MESSAGE;
+  }
+}
+
+bool ShmemRing::wait(double timeout)
+{
+  uint32_t notify = control_->notify.load();
+
+  if (control_->published.load(std::memory_order_acquire) != position_)
+  {
+    return true;
+  }
+
+  if (control_->closed.load() != 0)
+  {
+    return false;
+  }
+
+#ifdef __linux__
+  control_->waiters.fetch_add(1);
+  futex_wait(&control_->notify, notify, timeout);
+  control_->waiters.fetch_sub(1);
+#else
+  (void)notify;
+
+  auto deadline = std::chrono::steady_clock::now() +
+                  std::chrono::nanoseconds((int64_t)(timeout * 1000000000));
+
+  while (control_->published.load(std::memory_order_acquire) == position_ &&
+         control_->closed.load() == 0 &&
+         std::chrono::steady_clock::now() < deadline)
+  {
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+#endif
+
+  return control_->published.load(std::memory_order_acquire) != position_;
+}
+
+bool ShmemRing::is_stale(void) const
+{
+  if (!control_ || control_->closed.load() != 0)
+  {
+    return true;
+  }
+
+  int fd = shm_open(name_.c_str(), O_RDONLY, 0666);
+
+  if (fd < 0)
+  {
+    return true;
+  }
+
+  struct stat info;
+  bool stale = fstat(fd, &info) != 0 || info.st_dev != device_ ||
+               info.st_ino != inode_;
+
+  ::close(fd);
+
+  return stale;
+}
+}
+}
+
+#endif  // _MADARA_USE_SHMEM_
@@ -0,0 +1,171 @@
+#ifndef _MADARA_SHMEM_RING_H_
+#define _MADARA_SHMEM_RING_H_
+
+/**
+ * @file ShmemRing.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the ShmemRing class, a single-writer, multi-reader
+ * ring of messages in POSIX shared memory
+ **/
+
+#ifndef _WIN32
+#define _MADARA_USE_SHMEM_
+#endif
+
+#ifdef _MADARA_USE_SHMEM_
+
+#include <string>
+#include <vector>
+#include <atomic>
+
+#include <sys/types.h>
+
+#include "madara/MadaraExport.h"
+#include "madara/utility/IntTypes.h"
+
+namespace madara
+{
+namespace transport
+{
+/**
+ * @class ShmemRing
+ * @brief A ring of variable-sized messages in a named POSIX shared memory
+ *        segment. One process creates the ring and writes to it, and any
+ *        number of processes open it and read at their own pace. The
+ *        writer never waits for readers. A reader that falls more than a
+ *        ring behind loses the messages that were overwritten, and is
+ *        told so by read.
+ *
+ *        Readers sleep on a futex in the segment on Linux, and poll
+ *        elsewhere.
+ **/
+class MADARA_EXPORT ShmemRing
+{
+public:
+  /// result of read: no message is available
+  static const int READ_EMPTY = 0;
+
+  /// result of read: a message was copied out
+  static const int READ_MESSAGE = 1;
+
+  /// result of read: messages were overwritten before they were read
+  static const int READ_LOST = -1;
+
+  ShmemRing();
+
+  /**
+   * Destructor. Closes the ring.
+   **/
+  ~ShmemRing();
+
+  ShmemRing(const ShmemRing&) = delete;
+  ShmemRing& operator=(const ShmemRing&) = delete;
+
+  /**
+   * Creates the ring for writing. A ring left behind by a previous
+   * writer with the same name and capacity is reused, so its readers
+   * keep reading.
+   * @param  name       the segment name, e.g. "/agent0"
+   * @param  capacity   bytes of messages the ring holds
+   * @return  true if the ring is ready
+   **/
+  bool create(const std::string& name, size_t capacity);
+
+  /**
+   * Opens an existing ring for reading. Reading starts with the next
+   * message written.
+   * @param  name       the segment name
+   * @return  true if the ring exists and is ready
+   **/
+  bool open(const std::string& name);
+
+  /**
+   * Unmaps the ring. A writer also marks the ring closed and removes its
+   * name, which tells readers to reopen it.
+   **/
+  void close(void);
+
+  /**
+   * Checks if the ring is mapped
+   * @return  true if create or open succeeded and close was not called
+   **/
+  bool is_open(void) const;
+
+  /**
+   * Appends a message and wakes waiting readers. Writer only.
+   * @param  buffer     the message
+   * @param  size       the size of the message
+   * @return  false if the message is larger than the ring
+   **/
+  bool write(const char* buffer, size_t size);
+
+  /**
+   * Copies out the next message. Reader only.
+   * @param  buffer     resized to hold the message
+   * @return  READ_MESSAGE, READ_EMPTY, or READ_LOST if the writer lapped
+   *          this reader, which then skips to the newest message
+   **/
+  int read(std::vector<char>& buffer);
+
+  /**
+   * Waits until a message may be available. Reader only.
+   * @param  timeout    max seconds to wait
+   * @return  false if the wait timed out
+   **/
+  bool wait(double timeout);
+
+  /**
+   * Checks if this reader should reopen the ring, because the writer
+   * closed it or a new writer replaced it
+   * @return  true if the mapped ring is no longer written to
+   **/
+  bool is_stale(void) const;
+
+  /**
+   * Returns the number of bytes of messages the ring holds
+   * @return  the capacity
+   **/
+  size_t capacity(void) const;
+
+private:
+  /// the start of the segment, shared by every process
+  struct Control;
+
+  /// maps the segment behind fd_
+  bool map(size_t size);
+
+  /// segment name
+  std::string name_;
+
+  /// segment file descriptor, or -1
+  int fd_;
+
+  /// the mapping
+  void* mapping_;
+
+  /// size of the mapping
+  size_t mapping_size_;
+
+  /// the control block at the start of the mapping
+  Control* control_;
+
+  /// the messages, after the control block
+  char* data_;
+
+  /// true if we created the ring
+  bool writer_;
+
+  /// next position to write (writer) or read (reader)
+  uint64_t position_;
+
+  /// identifies the segment, to notice when the name is reused
+  dev_t device_;
+  ino_t inode_;
+};
+}
+}
+
+#endif  // _MADARA_USE_SHMEM_
+
+#endif  // _MADARA_SHMEM_RING_H_
@@ -0,0 +1,196 @@
+#include "madara/transport/shmem/ShmemTransport.h"
+
+#ifdef _MADARA_USE_SHMEM_
+
+#include "madara/transport/shmem/ShmemTransportReadThread.h"
+#include "madara/transport/TransportContext.h"
+
+#include "madara/utility/Utility.h"
+
+#include <sstream>
+
+namespace madara
+{
+namespace transport
+{
+ShmemTransport::ShmemTransport(const std::string& id,
+    knowledge::ThreadSafeContext& context, TransportSettings& config,
+    bool launch_transport)
+  : Base(id, config, context)
+{
+  // create a reference to the knowledge base for threading
+  knowledge_.use(context);
+
+  // set the data plane for the read threads
+  read_threads_.set_data_plane(knowledge_);
+
+  if (config.debug_to_kb_prefix != "")
+  {
+    knowledge::KnowledgeBase kb;
+    kb.use(context);
+
+    sent_packets.set_name(config.debug_to_kb_prefix + ".sent_packets", kb);
+    failed_sends.set_name(config.debug_to_kb_prefix + ".failed_sends", kb);
+    sent_data_max.set_name(config.debug_to_kb_prefix + ".sent_data_max", kb);
+    sent_data_min.set_name(config.debug_to_kb_prefix + ".sent_data_min", kb);
+    sent_data.set_name(config.debug_to_kb_prefix + ".sent_data", kb);
+  }
+
+  if (launch_transport)
+    setup();
+}
+
+ShmemTransport::~ShmemTransport()
+{
+  ShmemTransport::close();
+}
+
+int ShmemTransport::reliability(void) const
+{
+  return BEST_EFFORT;
+}
+
+int ShmemTransport::reliability(const int&)
+{
+  return BEST_EFFORT;
+}
+
+int ShmemTransport::setup(void)
+{
+  // call base setup method to initialize certain common variables
+  if (Base::setup() < 0)
+  {
+    return -1;
+  }
+
+  if (settings_.hosts.size() == 0)
+  {
+    madara_logger_log(context_.get_logger(), logger::LOG_MINOR,
+        "ShmemTransport::setup:"
+        " No ring names. Aborting setup.\n");
+    this->invalidate_transport();
+    return -1;
+  }
+
+  if (!settings_.no_sending)
+  {
+    std::lock_guard<std::mutex> guard(ring_mutex_);
+
+    if (!ring_.create(settings_.hosts[0], settings_.queue_length))
+    {
+      madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+          "ShmemTransport::setup:"
+          " Unable to create ring %s\n",
+          settings_.hosts[0].c_str());
+
+      this->invalidate_transport();
+      return -1;
+    }
+
+    madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+        "ShmemTransport::setup:"
+        " Writing to ring %s of %d bytes\n",
+        settings_.hosts[0].c_str(), (int)ring_.capacity());
+  }
+
+  if (!settings_.no_receiving)
+  {
+    for (size_t i = 1; i < settings_.hosts.size(); ++i)
+    {
+      std::stringstream thread_name;
+      thread_name << "read";
+      thread_name << i - 1;
+
+      madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+          "ShmemTransport::setup:"
+          " starting thread %s for ring %s\n",
+          thread_name.str().c_str(), settings_.hosts[i].c_str());
+
+      // the thread sleeps on the ring, so it runs without a hertz limit
+      read_threads_.run(0.0, thread_name.str(),
+          new ShmemTransportReadThread(*this, settings_.hosts[i]));
+    }
+  }
+
+  return this->validate_transport();
+}
+
+void ShmemTransport::close(void)
+{
+  this->invalidate_transport();
+
+  read_threads_.terminate();
+
+  read_threads_.wait();
+
+  std::lock_guard<std::mutex> guard(ring_mutex_);
+  ring_.close();
+}
+
+long ShmemTransport::send_message(const char* buf, size_t size)
+{
+  bool written;
+
+  {
+    std::lock_guard<std::mutex> guard(ring_mutex_);
+    written = ring_.is_open() && ring_.write(buf, size);
+  }
+
+  if (!written)
+  {
+    madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+        "ShmemTransport::send_message:"
+        " Unable to write %d byte message to a ring of %d bytes\n",
+        (int)size, (int)ring_.capacity());
+
+    if (settings_.debug_to_kb_prefix != "")
+    {
+      ++failed_sends;
+    }
+
+    return -1;
+  }
+
+  madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+      "ShmemTransport::send_message: Wrote %d byte message\n", (int)size);
+
+  send_monitor_.add((uint32_t)size);
+
+  if (settings_.debug_to_kb_prefix != "")
+  {
+    ++sent_packets;
+    sent_data += size;
+    if (sent_data_max < size)
+    {
+      sent_data_max = size;
+    }
+    if (sent_data_min > size || sent_data_min == 0)
+    {
+      sent_data_min = size;
+    }
+  }
+
+  return (long)size;
+}
+
+long ShmemTransport::send_data(const knowledge::KnowledgeMap& orig_updates)
+{
+  long result(0);
+  const char* print_prefix = "ShmemTransport::send_data";
+
+  if (!settings_.no_sending)
+  {
+    result = prep_send(orig_updates, print_prefix);
+
+    if (result > 0)
+    {
+      result = send_message(buffer_.get_ptr(), result);
+    }
+  }
+
+  return result;
+}
+}
+}
+
+#endif  // _MADARA_USE_SHMEM_
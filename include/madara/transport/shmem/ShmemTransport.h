@@ -0,0 +1,141 @@
+#ifndef _MADARA_SHMEM_TRANSPORT_H_
+#define _MADARA_SHMEM_TRANSPORT_H_
+
+/**
+ * @file ShmemTransport.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the ShmemTransport class, which provides a
+ * shared memory transport for knowledge updates between processes on
+ * the same host
+ **/
+
+#include "madara/transport/shmem/ShmemRing.h"
+
+#ifdef _MADARA_USE_SHMEM_
+
+#include <string>
+#include <mutex>
+
+#include "madara/MadaraExport.h"
+#include "madara/transport/QoSTransportSettings.h"
+#include "madara/transport/Transport.h"
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/knowledge/containers/Integer.h"
+#include "madara/threads/Threader.h"
+
+namespace madara
+{
+namespace transport
+{
+/**
+ * @class ShmemTransport
+ * @brief Shared memory transport for knowledge. Every agent writes its
+ *        messages to its own ShmemRing and reads the rings of the
+ *        agents it listens to. Messages are the usual serialized updates,
+ *        so filters, QoS and rebroadcasts work as with the UDP
+ *        transports, but nothing is fragmented or sent through a socket.
+ *
+ *        Hosts are ring names. The first host is the ring we write to,
+ *        and each of the others is a ring we read with its own thread.
+ *        Readers wake on a futex as soon as a message is written, so
+ *        read_thread_hertz and read_threads are not used. Rings hold
+ *        queue_length bytes, and a reader that falls a ring behind loses
+ *        the overwritten messages. Rings that do not exist yet are
+ *        opened when their writer starts.
+ **/
+class MADARA_EXPORT ShmemTransport : public Base
+{
+public:
+  /**
+   * Constructor
+   * @param   id   unique identifer - usually a combination of host:port
+   * @param   context  knowledge context
+   * @param   config   transport configuration settings
+   * @param   launch_transport  whether or not to launch this transport
+   **/
+  ShmemTransport(const std::string& id,
+      madara::knowledge::ThreadSafeContext& context, TransportSettings& config,
+      bool launch_transport);
+
+  /**
+   * Destructor
+   **/
+  virtual ~ShmemTransport();
+
+  /**
+   * Sends a list of knowledge updates to listeners
+   * @param   updates listing of all updates that must be sent
+   * @return  result of write operation or -1 if we are shutting down
+   **/
+  long send_data(const madara::knowledge::KnowledgeMap& updates) override;
+
+  /**
+   * Closes the transport and removes our ring
+   **/
+  virtual void close(void) override;
+
+  /**
+   * Accesses reliability setting
+   * @return  whether we are using reliable dissemination or not
+   **/
+  int reliability(void) const;
+
+  /**
+   * Sets the reliability setting
+   * @return  the changed setting
+   **/
+  int reliability(const int& setting);
+
+  /**
+   * Initializes the transport
+   * @return  0 if success
+   **/
+  virtual int setup(void) override;
+
+  /// sent packets
+  knowledge::containers::Integer sent_packets;
+
+  /// failed sends
+  knowledge::containers::Integer failed_sends;
+
+  /// sent data
+  knowledge::containers::Integer sent_data;
+
+  /// max data sent
+  knowledge::containers::Integer sent_data_max;
+
+  /// min data sent
+  knowledge::containers::Integer sent_data_min;
+
+protected:
+  /**
+   * Writes a message to our ring
+   * @param   buf    the message, starting with its MessageHeader
+   * @param   size   the size of the message
+   * @return  bytes written, or -1 if the message does not fit
+   **/
+  long send_message(const char* buf, size_t size);
+
+  /// knowledge base for threads to use
+  knowledge::KnowledgeBase knowledge_;
+
+  /// the ring we write to
+  ShmemRing ring_;
+
+  /// serializes writers within this process
+  std::mutex ring_mutex_;
+
+  /// threads for reading knowledge updates
+  threads::Threader read_threads_;
+
+  friend class ShmemTransportReadThread;
+};
+}
+}
+
+#include "madara/transport/shmem/ShmemTransportReadThread.h"
+
+#endif  // _MADARA_USE_SHMEM_
+
+#endif  // _MADARA_SHMEM_TRANSPORT_H_
@@ -0,0 +1,219 @@
+#include "madara/transport/shmem/ShmemTransportReadThread.h"
+
+#ifdef _MADARA_USE_SHMEM_
+
+#include "madara/utility/Utility.h"
+
+#include <algorithm>
+
+namespace madara
+{
+namespace transport
+{
+/// how long a wait on the ring lasts, which bounds how long terminate takes
+static const double ring_wait_time = 0.1;
+
+/// most messages read per run, so terminate is noticed under load
+static const int max_messages_per_run = 1024;
+
+ShmemTransportReadThread::ShmemTransportReadThread(
+    ShmemTransport& transport, const std::string& ring_name)
+  : transport_(transport), ring_name_(ring_name)
+{
+}
+
+void ShmemTransportReadThread::init(knowledge::KnowledgeBase& knowledge)
+{
+  const QoSTransportSettings& settings_ = transport_.settings_;
+
+  context_ = &(knowledge.get_context());
+
+  // setup the rebroadcast buffer
+  if (settings_.queue_length > 0)
+    buffer_ = new char[settings_.queue_length];
+
+  madara_logger_log(this->context_->get_logger(), logger::LOG_MAJOR,
+      "ShmemTransportReadThread::init:"
+      " ShmemTransportReadThread started for ring %s\n",
+      ring_name_.c_str());
+
+  if (context_)
+  {
+    // check for an on_data_received ruleset
+    if (settings_.on_data_received_logic.length() != 0)
+    {
+      madara_logger_log(this->context_->get_logger(), logger::LOG_MAJOR,
+          "ShmemTransportReadThread::init:"
+          " setting rules to %s\n",
+          settings_.on_data_received_logic.c_str());
+
+#ifndef _MADARA_NO_KARL_
+      expression::Interpreter interpreter;
+      on_data_received_ = context_->compile(settings_.on_data_received_logic);
+#endif  // _MADARA_NO_KARL_
+    }
+    else
+    {
+      madara_logger_log(this->context_->get_logger(), logger::LOG_MAJOR,
+          "ShmemTransportReadThread::init:"
+          " no permanent rules were set\n");
+    }
+
+    if (settings_.debug_to_kb_prefix != "")
+    {
+      knowledge::KnowledgeBase kb;
+      kb.use(*context_);
+      received_packets_.set_name(
+          settings_.debug_to_kb_prefix + ".received_packets", kb);
+      failed_receives_.set_name(
+          settings_.debug_to_kb_prefix + ".failed_receives", kb);
+      received_data_max_.set_name(
+          settings_.debug_to_kb_prefix + ".received_data_max", kb);
+      received_data_min_.set_name(
+          settings_.debug_to_kb_prefix + ".received_data_min", kb);
+      received_data_.set_name(
+          settings_.debug_to_kb_prefix + ".received_data", kb);
+    }
+  }
+}
+
+void ShmemTransportReadThread::cleanup(void)
+{
+  ring_.close();
+}
+
+void ShmemTransportReadThread::run(void)
+{
+  const QoSTransportSettings& settings_ = transport_.settings_;
+  static const char print_prefix[] = "ShmemTransportReadThread::run";
+
+  if (!ring_.is_open())
+  {
+    if (!ring_.open(ring_name_))
+    {
+      // the writer has not started yet
+      utility::sleep(ring_wait_time);
+      return;
+    }
+
+    madara_logger_log(this->context_->get_logger(), logger::LOG_MAJOR,
+        "%s: reading ring %s of %d bytes\n", print_prefix, ring_name_.c_str(),
+        (int)ring_.capacity());
+  }
+
+  for (int i = 0; i < max_messages_per_run; ++i)
+  {
+    int result = ring_.read(message_);
+
+    if (result == ShmemRing::READ_EMPTY)
+    {
+      break;
+    }
+    else if (result == ShmemRing::READ_LOST)
+    {
+      madara_logger_log(this->context_->get_logger(), logger::LOG_MAJOR,
+          "%s: the writer of %s overwrote unread messages\n", print_prefix,
+          ring_name_.c_str());
+
+      if (settings_.debug_to_kb_prefix != "")
+      {
+        ++failed_receives_;
+      }
+    }
+    else
+    {
+      receive_message(print_prefix, message_.data(), message_.size());
+    }
+  }
+
+  // the writer may have closed or replaced the ring while it was idle
+  if (!ring_.wait(ring_wait_time) && ring_.is_stale())
+  {
+    madara_logger_log(this->context_->get_logger(), logger::LOG_MAJOR,
+        "%s: ring %s was closed. Reopening it.\n", print_prefix,
+        ring_name_.c_str());
+
+    ring_.close();
+  }
+}
+
+void ShmemTransportReadThread::receive_message(
+    const char* print_prefix, const char* buffer, size_t bytes_read)
+{
+  const QoSTransportSettings& settings_ = transport_.settings_;
+
+  if (settings_.debug_to_kb_prefix != "")
+  {
+    received_data_ += bytes_read;
+    ++received_packets_;
+
+    if (received_data_max_ < bytes_read)
+    {
+      received_data_max_ = bytes_read;
+    }
+    if (received_data_min_ > bytes_read || received_data_min_ == 0)
+    {
+      received_data_min_ = bytes_read;
+    }
+  }
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+      "%s:"
+      " received a message of %lld bytes from %s\n",
+      print_prefix, (long long)bytes_read, ring_name_.c_str());
+
+  MessageHeader* header = 0;
+
+  knowledge::KnowledgeMap rebroadcast_records;
+
+  process_received_update(buffer, (uint32_t)bytes_read, transport_.id_,
+      *context_, settings_, transport_.send_monitor_,
+      transport_.receive_monitor_, rebroadcast_records,
+#ifndef _MADARA_NO_KARL_
+      on_data_received_,
+#endif  // _MADARA_NO_KARL_
+      print_prefix, ring_name_.c_str(), scratch_, header);
+
+  if (header)
+  {
+    if (header->ttl > 0 && rebroadcast_records.size() > 0 &&
+        settings_.get_participant_ttl() > 0)
+    {
+      --header->ttl;
+      header->ttl = std::min(settings_.get_participant_ttl(), header->ttl);
+
+      rebroadcast(print_prefix, header, rebroadcast_records);
+    }
+  }
+}
+
+void ShmemTransportReadThread::rebroadcast(const char* print_prefix,
+    MessageHeader* header, const knowledge::KnowledgeMap& records)
+{
+  const QoSTransportSettings& settings_ = transport_.settings_;
+
+  int64_t buffer_remaining = (int64_t)settings_.queue_length;
+  char* buffer = buffer_.get_ptr();
+  int result(0);
+
+  if (!settings_.no_sending && buffer != 0)
+  {
+    result = prep_rebroadcast(*context_, buffer, buffer_remaining, settings_,
+        print_prefix, header, records, transport_.packet_scheduler_);
+
+    if (result > 0)
+    {
+      // statistics are kept by send_message
+      transport_.send_message(buffer, result);
+
+      madara_logger_log(this->context_->get_logger(), logger::LOG_MAJOR,
+          "%s:"
+          " Send bandwidth = %" PRIu64 " B/s\n",
+          print_prefix, transport_.send_monitor_.get_bytes_per_second());
+    }
+  }
+}
+}
+}
+
+#endif  // _MADARA_USE_SHMEM_
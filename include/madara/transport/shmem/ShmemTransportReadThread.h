@@ -0,0 +1,118 @@
+#ifndef _MADARA_SHMEM_TRANSPORT_READ_THREAD_H_
+#define _MADARA_SHMEM_TRANSPORT_READ_THREAD_H_
+
+#include "madara/transport/shmem/ShmemRing.h"
+
+#ifdef _MADARA_USE_SHMEM_
+
+#include <string>
+#include <vector>
+
+#include "madara/utility/ScopedArray.h"
+#include "madara/knowledge/ThreadSafeContext.h"
+#include "madara/transport/QoSTransportSettings.h"
+#include "madara/expression/ExpressionTree.h"
+#include "madara/transport/Transport.h"
+#include "madara/transport/MessageHeader.h"
+#include "madara/transport/shmem/ShmemTransport.h"
+#include "madara/threads/BaseThread.h"
+
+namespace madara
+{
+namespace transport
+{
+/**
+ * @class ShmemTransportReadThread
+ * @brief Thread for reading knowledge updates from one shared memory ring
+ **/
+class ShmemTransportReadThread : public threads::BaseThread
+{
+public:
+  /**
+   * Constructor
+   * @param  transport   the transport we read for
+   * @param  ring_name   the ring to read
+   **/
+  ShmemTransportReadThread(
+      ShmemTransport& transport, const std::string& ring_name);
+
+  /**
+   * Initializes MADARA context-related items
+   * @param   knowledge   context for querying current program state
+   **/
+  void init(knowledge::KnowledgeBase& knowledge) override;
+
+  /**
+   * Cleanup function called by thread manager
+   **/
+  void cleanup(void) override;
+
+  /**
+   * The main loop internals for the read thread
+   **/
+  void run(void) override;
+
+  /**
+   * Sends a rebroadcast packet.
+   * @param  print_prefix     prefix to include before every log message,
+   *                          e.g., "MyTransport::svc"
+   * @param   header   header for the rebroadcasted packet
+   * @param   records  records to rebroadcast (already filtered for
+   *                   rebroadcast)
+   **/
+  void rebroadcast(const char* print_prefix, MessageHeader* header,
+      const knowledge::KnowledgeMap& records);
+
+protected:
+  /**
+   * Updates receive statistics and applies a received message
+   * @param  print_prefix     prefix to include before every log message
+   * @param  buffer           the message
+   * @param  bytes_read       size of the message
+   **/
+  void receive_message(
+      const char* print_prefix, const char* buffer, size_t bytes_read);
+
+  ShmemTransport& transport_;
+
+  knowledge::ThreadSafeContext* context_ = nullptr;
+
+  /// the ring we read
+  std::string ring_name_;
+  ShmemRing ring_;
+
+#ifndef _MADARA_NO_KARL_
+  /// data received rules, defined in Transport settings
+  madara::knowledge::CompiledExpression on_data_received_;
+#endif  // _MADARA_NO_KARL_
+
+  /// the message being processed
+  std::vector<char> message_;
+
+  /// buffer for rebroadcasting
+  madara::utility::ScopedArray<char> buffer_;
+
+  /// storage reused when decoding received packets
+  ReceiveScratch scratch_;
+
+  /// received packets
+  knowledge::containers::Integer received_packets_;
+
+  /// messages lost because the writer lapped us
+  knowledge::containers::Integer failed_receives_;
+
+  /// received data
+  knowledge::containers::Integer received_data_;
+
+  /// max data received
+  knowledge::containers::Integer received_data_max_;
+
+  /// min data received
+  knowledge::containers::Integer received_data_min_;
+};
+}
+}
+
+#endif  // _MADARA_USE_SHMEM_
+
+#endif  // _MADARA_SHMEM_TRANSPORT_READ_THREAD_H_
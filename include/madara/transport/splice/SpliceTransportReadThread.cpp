@@ -183,7 +183,7 @@ void madara::transport::SpliceReadThread::run(void)
       process_received_update((char*)update_data_list_[i].buffer.get_buffer(),
           update_data_list_[i].buffer.length(), id_, *context_, settings_,
           send_monitor_, receive_monitor_, rebroadcast_records,
-          on_data_received_, print_prefix, "", header);
+          on_data_received_, print_prefix, "", scratch_, header);
 
       if (header)
       {
@@ -195,9 +195,6 @@ void madara::transport::SpliceReadThread::run(void)
 
           rebroadcast(print_prefix, header, rebroadcast_records);
         }
-
-        // delete header
-        delete header;
       }
     }
   }
@@ -117,6 +117,9 @@ public:
   /// buffer for receiving
   madara::utility::ScopedArray<char> buffer_;
 
+  /// storage reused when decoding received packets
+  ReceiveScratch scratch_;
+
   /// monitor for sending bandwidth usage
   BandwidthMonitor& send_monitor_;
 
@@ -0,0 +1,448 @@
+#include "madara/transport/tcp/TcpTransport.h"
+#include "madara/transport/tcp/TcpTransportReadThread.h"
+#include "madara/transport/TransportContext.h"
+
+#include "madara/utility/Utility.h"
+#include "madara/utility/Timer.h"
+
+#include <iostream>
+#include <chrono>
+
+namespace madara
+{
+namespace transport
+{
+/// how long to wait before reconnecting to a peer after a failure
+static const std::chrono::milliseconds reconnect_delay(500);
+
+/// how long close waits for queued messages to be written
+static const double close_flush_timeout = 1.0;
+
+TcpTransport::TcpTransport(const std::string& id,
+    knowledge::ThreadSafeContext& context, TransportSettings& config,
+    bool launch_transport)
+  : Base(id, config, context)
+{
+  // create a reference to the knowledge base for threading
+  knowledge_.use(context);
+
+  // set the data plane for the read threads
+  read_threads_.set_data_plane(knowledge_);
+
+  if (config.debug_to_kb_prefix != "")
+  {
+    knowledge::KnowledgeBase kb;
+    kb.use(context);
+
+    sent_packets.set_name(config.debug_to_kb_prefix + ".sent_packets", kb);
+    failed_sends.set_name(config.debug_to_kb_prefix + ".failed_sends", kb);
+    sent_data_max.set_name(config.debug_to_kb_prefix + ".sent_data_max", kb);
+    sent_data_min.set_name(config.debug_to_kb_prefix + ".sent_data_min", kb);
+    sent_data.set_name(config.debug_to_kb_prefix + ".sent_data", kb);
+  }
+
+  // the read threads find message boundaries by the size at the front
+  // of a full header
+  if (settings_.send_compact_message_header)
+  {
+    madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+        "TcpTransport::TcpTransport:"
+        " compact message headers are not supported. Sending full headers.\n");
+
+    settings_.send_compact_message_header = false;
+  }
+
+  if (launch_transport)
+    setup();
+}
+
+TcpTransport::~TcpTransport()
+{
+  TcpTransport::close();
+}
+
+int TcpTransport::reliability(void) const
+{
+  return RELIABLE;
+}
+
+int TcpTransport::reliability(const int&)
+{
+  return RELIABLE;
+}
+
+int TcpTransport::setup(void)
+{
+  // call base setup method to initialize certain common variables
+  if (Base::setup() < 0)
+  {
+    return -1;
+  }
+
+  if (settings_.hosts.size() == 0)
+  {
+    madara_logger_log(context_.get_logger(), logger::LOG_MINOR,
+        "TcpTransport::setup:"
+        " No host addresses. Aborting setup.\n");
+    this->invalidate_transport();
+    return -1;
+  }
+
+  std::vector<tcp::endpoint> addresses;
+
+  // convert the string host:port into an asio address
+  for (unsigned int i = 0; i < settings_.hosts.size(); ++i)
+  {
+    try
+    {
+      auto addr_parts = utility::parse_address(settings_.hosts[i]);
+
+      auto addr = ip::address::from_string(addr_parts.first);
+      addresses.emplace_back(addr, addr_parts.second);
+
+      madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+          "TcpTransport::setup:"
+          " settings address[%d] to %s:%d\n",
+          i, addresses.back().address().to_string().c_str(),
+          addresses.back().port());
+    }
+    catch (const boost::system::system_error& e)
+    {
+      madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+          "TcpTransport::setup:"
+          " Error parsing address %s: %s\n",
+          settings_.hosts[i].c_str(), e.what());
+
+      // the first host is who we are, so we cannot skip it
+      if (i == 0)
+      {
+        this->invalidate_transport();
+        return -1;
+      }
+    }
+  }
+
+  if (!settings_.no_receiving)
+  {
+    try
+    {
+      tcp::endpoint local(addresses[0].protocol(), addresses[0].port());
+
+      acceptor_.open(local.protocol());
+      acceptor_.set_option(tcp::acceptor::reuse_address(true));
+      acceptor_.bind(local);
+      acceptor_.listen();
+
+      madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+          "TcpTransport::setup:"
+          " Listening on port: %d\n",
+          (int)addresses[0].port());
+    }
+    catch (const boost::system::system_error& e)
+    {
+      madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+          "TcpTransport::setup:"
+          " Error listening on %s: %s\n",
+          settings_.hosts[0].c_str(), e.what());
+
+      this->invalidate_transport();
+      return -1;
+    }
+  }
+
+  peers_.clear();
+
+  for (size_t i = 1; i < addresses.size(); ++i)
+  {
+    peers_.emplace_back(new Peer(io_service_, addresses[i]));
+  }
+
+  work_.reset(new asio::io_service::work(io_service_));
+
+  // one thread drives every socket, so read_threads is not used
+  madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+      "TcpTransport::setup:"
+      " Starting TcpTransport I/O thread\n");
+
+  read_threads_.run(0.0, "io", new TcpTransportReadThread(*this));
+
+  return this->validate_transport();
+}
+
+void TcpTransport::close(void)
+{
+  // give the I/O thread a chance to write what is still queued
+  if (work_)
+  {
+    utility::Timer<std::chrono::steady_clock> timer;
+    timer.start();
+
+    bool busy = true;
+
+    while (busy)
+    {
+      busy = false;
+
+      for (auto& peer : peers_)
+      {
+        std::lock_guard<std::mutex> guard(peer->mutex);
+
+        if (peer->connected && (!peer->pending.empty() ||
+                                   !peer->writing.empty() || peer->write_posted))
+        {
+          busy = true;
+          break;
+        }
+      }
+
+      timer.stop();
+      if (busy && timer.duration_ds() < close_flush_timeout)
+      {
+        utility::sleep(0.001);
+      }
+      else
+      {
+        break;
+      }
+    }
+  }
+
+  this->invalidate_transport();
+
+  read_threads_.terminate();
+
+  io_service_.stop();
+
+  read_threads_.wait();
+
+  work_.reset();
+
+  boost::system::error_code err;
+
+  acceptor_.close(err);
+
+  for (auto& peer : peers_)
+  {
+    peer->retry_timer.cancel(err);
+    peer->socket.close(err);
+  }
+}
+
+long TcpTransport::send_message(const char* buf, size_t size)
+{
+  static const char print_prefix[] = "TcpTransport::send_message";
+
+  long bytes_queued = 0;
+
+  for (auto& peer : peers_)
+  {
+    bool post_write = false;
+
+    {
+      std::lock_guard<std::mutex> guard(peer->mutex);
+
+      if (peer->pending.size() + size > settings_.queue_length)
+      {
+        madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+            "%s:"
+            " %d byte message does not fit in the queue for %s:%d."
+            " Dropping it.\n",
+            print_prefix, (int)size,
+            peer->address.address().to_string().c_str(),
+            (int)peer->address.port());
+
+        if (settings_.debug_to_kb_prefix != "")
+        {
+          ++failed_sends;
+        }
+
+        continue;
+      }
+
+      peer->pending.insert(peer->pending.end(), buf, buf + size);
+      bytes_queued += (long)size;
+
+      // a running write picks up pending messages when it completes
+      if (peer->connected && peer->writing.empty() && !peer->write_posted)
+      {
+        peer->write_posted = true;
+        post_write = true;
+      }
+    }
+
+    if (post_write)
+    {
+      Peer* target = peer.get();
+      io_service_.post([this, target]() { start_write(*target); });
+    }
+  }
+
+  if (bytes_queued > 0)
+  {
+    send_monitor_.add((uint32_t)bytes_queued);
+  }
+
+  madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+      "%s:"
+      " Queued %d byte message for %d peers\n",
+      print_prefix, (int)size, (int)peers_.size());
+
+  return bytes_queued;
+}
+
+void TcpTransport::start_connect(Peer& peer)
+{
+  peer.socket.async_connect(
+      peer.address, [this, &peer](const boost::system::error_code& err) {
+        if (err == asio::error::operation_aborted)
+        {
+          return;
+        }
+
+        if (err)
+        {
+          madara_logger_log(context_.get_logger(), logger::LOG_MINOR,
+              "TcpTransport::start_connect:"
+              " Unable to connect to %s:%d: %s\n",
+              peer.address.address().to_string().c_str(),
+              (int)peer.address.port(), err.message().c_str());
+
+          reconnect_later(peer);
+          return;
+        }
+
+        boost::system::error_code option_err;
+        peer.socket.set_option(tcp::no_delay(true), option_err);
+
+        madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+            "TcpTransport::start_connect:"
+            " Connected to %s:%d\n",
+            peer.address.address().to_string().c_str(),
+            (int)peer.address.port());
+
+        {
+          std::lock_guard<std::mutex> guard(peer.mutex);
+          peer.connected = true;
+          peer.write_posted = true;
+        }
+
+        start_write(peer);
+      });
+}
+
+void TcpTransport::start_write(Peer& peer)
+{
+  {
+    std::lock_guard<std::mutex> guard(peer.mutex);
+
+    peer.write_posted = false;
+
+    if (!peer.connected || !peer.writing.empty() || peer.pending.empty())
+    {
+      return;
+    }
+
+    // everything queued so far goes out in a single write
+    peer.writing.swap(peer.pending);
+  }
+
+  asio::async_write(peer.socket, asio::buffer(peer.writing),
+      [this, &peer](const boost::system::error_code& err, size_t bytes_sent) {
+        if (err == asio::error::operation_aborted)
+        {
+          return;
+        }
+
+        if (err)
+        {
+          madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+              "TcpTransport::start_write:"
+              " Error writing to %s:%d: %s\n",
+              peer.address.address().to_string().c_str(),
+              (int)peer.address.port(), err.message().c_str());
+
+          if (settings_.debug_to_kb_prefix != "")
+          {
+            ++failed_sends;
+          }
+
+          {
+            // resend on the next connection. The peer may see a message
+            // twice, which the knowledge clocks resolve
+            std::lock_guard<std::mutex> guard(peer.mutex);
+            peer.pending.insert(
+                peer.pending.begin(), peer.writing.begin(), peer.writing.end());
+            peer.writing.clear();
+          }
+
+          reconnect_later(peer);
+          return;
+        }
+
+        madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+            "TcpTransport::start_write: Sent %d bytes to %s:%d\n",
+            (int)bytes_sent, peer.address.address().to_string().c_str(),
+            (int)peer.address.port());
+
+        if (settings_.debug_to_kb_prefix != "")
+        {
+          ++sent_packets;
+          sent_data += bytes_sent;
+          if (sent_data_max < bytes_sent)
+          {
+            sent_data_max = bytes_sent;
+          }
+          if (sent_data_min > bytes_sent || sent_data_min == 0)
+          {
+            sent_data_min = bytes_sent;
+          }
+        }
+
+        {
+          std::lock_guard<std::mutex> guard(peer.mutex);
+          peer.writing.clear();
+        }
+
+        start_write(peer);
+      });
+}
+
+void TcpTransport::reconnect_later(Peer& peer)
+{
+  {
+    std::lock_guard<std::mutex> guard(peer.mutex);
+    peer.connected = false;
+  }
+
+  boost::system::error_code err;
+  peer.socket.close(err);
+
+  peer.retry_timer.expires_after(reconnect_delay);
+  peer.retry_timer.async_wait(
+      [this, &peer](const boost::system::error_code& timer_err) {
+        if (!timer_err)
+        {
+          start_connect(peer);
+        }
+      });
+}
+
+long TcpTransport::send_data(const knowledge::KnowledgeMap& orig_updates)
+{
+  long result(0);
+  const char* print_prefix = "TcpTransport::send_data";
+
+  if (!settings_.no_sending)
+  {
+    result = prep_send(orig_updates, print_prefix);
+
+    if (peers_.size() > 0 && result > 0)
+    {
+      result = send_message(buffer_.get_ptr(), result);
+    }
+  }
+
+  return result;
+}
+}
+}
@@ -0,0 +1,201 @@
+#ifndef _MADARA_TCP_TRANSPORT_H_
+#define _MADARA_TCP_TRANSPORT_H_
+
+/**
+ * @file TcpTransport.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the TcpTransport class, which provides a
+ * stream-based transport for sending knowledge updates in KaRL
+ **/
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+
+#include "madara/MadaraExport.h"
+#include "madara/transport/QoSTransportSettings.h"
+#include "madara/transport/Transport.h"
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/knowledge/containers/Integer.h"
+#include "madara/threads/Threader.h"
+#include "madara/Boost.h"
+
+namespace madara
+{
+namespace transport
+{
+namespace asio = boost::asio;
+namespace ip = boost::asio::ip;
+using tcp = boost::asio::ip::tcp;
+
+/**
+ * @class TcpTransport
+ * @brief TCP-based transport for knowledge. Every message is the usual
+ *        MessageHeader followed by its updates. The header starts with
+ *        the size of the whole message, which frames it on the stream,
+ *        so nothing is ever fragmented. Large payloads only need a
+ *        queue_length that can hold them.
+ *
+ *        This transport currently supports the following transport
+ *        settings:<br />
+ *        1) multiple host:port pairing with self first in vector. We
+ *           listen on the first host and keep a connection open to each
+ *           of the others, reconnecting when a connection fails<br />
+ *        2) the reduced message header<br />
+ *        3) the normal message header<br />
+ *        4) domain differentiation<br />
+ *        5) on data received logic<br />
+ *        6) multi-assignment of records<br />
+ *        7) rebroadcasting<br />
+ *
+ *        Messages sent while a peer is busy or disconnected are queued
+ *        (up to queue_length bytes per peer) and written together in a
+ *        single write once the peer can take them. All socket I/O runs
+ *        on one read thread, regardless of read_threads.
+ **/
+class MADARA_EXPORT TcpTransport : public Base
+{
+public:
+  /**
+   * Constructor
+   * @param   id   unique identifer - usually a combination of host:port
+   * @param   context  knowledge context
+   * @param   config   transport configuration settings
+   * @param   launch_transport  whether or not to launch this transport
+   **/
+  TcpTransport(const std::string& id,
+      madara::knowledge::ThreadSafeContext& context, TransportSettings& config,
+      bool launch_transport);
+
+  /**
+   * Destructor
+   **/
+  virtual ~TcpTransport();
+
+  /**
+   * Sends a list of knowledge updates to listeners
+   * @param   updates listing of all updates that must be sent
+   * @return  result of write operation or -1 if we are shutting down
+   **/
+  long send_data(const madara::knowledge::KnowledgeMap& updates) override;
+
+  /**
+   * Closes the transport. Messages still queued for connected peers are
+   * written before the sockets are closed.
+   **/
+  virtual void close(void) override;
+
+  /**
+   * Accesses reliability setting
+   * @return  whether we are using reliable dissemination or not
+   **/
+  int reliability(void) const;
+
+  /**
+   * Sets the reliability setting
+   * @return  the changed setting
+   **/
+  int reliability(const int& setting);
+
+  /**
+   * Initializes the transport
+   * @return  0 if success
+   **/
+  virtual int setup(void) override;
+
+  /// sent packets (one per write, which may hold several messages)
+  knowledge::containers::Integer sent_packets;
+
+  /// failed sends
+  knowledge::containers::Integer failed_sends;
+
+  /// sent data
+  knowledge::containers::Integer sent_data;
+
+  /// max data sent
+  knowledge::containers::Integer sent_data_max;
+
+  /// min data sent
+  knowledge::containers::Integer sent_data_min;
+
+protected:
+  /**
+   * A persistent outgoing connection
+   **/
+  struct Peer
+  {
+    Peer(asio::io_service& io_service, const tcp::endpoint& target)
+      : address(target), socket(io_service), retry_timer(io_service)
+    {
+    }
+
+    /// where we connect to
+    tcp::endpoint address;
+
+    /// the connection, valid only if connected
+    tcp::socket socket;
+
+    /// delays reconnects after a failure
+    asio::steady_timer retry_timer;
+
+    /// protects everything below
+    std::mutex mutex;
+
+    /// messages waiting for the next write
+    std::vector<char> pending;
+
+    /// the messages being written
+    std::vector<char> writing;
+
+    /// true once connected, until a write fails
+    bool connected = false;
+
+    /// true while a start_write is posted but has not run
+    bool write_posted = false;
+  };
+
+  /**
+   * Queues a message for every peer and wakes the I/O thread
+   * @param   buf    the message, starting with its MessageHeader
+   * @param   size   the size of the message
+   * @return  bytes queued over all peers
+   **/
+  long send_message(const char* buf, size_t size);
+
+  /// starts a connection attempt. Must be called on the I/O thread
+  void start_connect(Peer& peer);
+
+  /// writes everything pending to a peer. Must be called on the I/O thread
+  void start_write(Peer& peer);
+
+  /// drops a failed connection and retries it later
+  void reconnect_later(Peer& peer);
+
+  /// knowledge base for threads to use
+  knowledge::KnowledgeBase knowledge_;
+
+  /// Boost::ASIO IO context, run by the read thread
+  asio::io_service io_service_;
+
+  /// keeps io_service_ running while there is nothing to do
+  std::unique_ptr<asio::io_service::work> work_;
+
+  /// accepts incoming connections on the first host
+  tcp::acceptor acceptor_{io_service_};
+
+  /// the other hosts
+  std::vector<std::unique_ptr<Peer>> peers_;
+
+  /// threads for reading knowledge updates
+  threads::Threader read_threads_;
+
+  friend class TcpTransportReadThread;
+};
+}
+}
+
+#include "madara/transport/tcp/TcpTransportReadThread.h"
+
+#endif  // _MADARA_TCP_TRANSPORT_H_
@@ -0,0 +1,332 @@
+#include "madara/transport/tcp/TcpTransportReadThread.h"
+
+#include "madara/utility/Utility.h"
+#include "madara/transport/ReducedMessageHeader.h"
+
+#include <iostream>
+#include <algorithm>
+#include <string.h>
+
+namespace madara
+{
+namespace transport
+{
+/// the least free space in a connection buffer before each read
+static const size_t min_read_size = 65536;
+
+TcpTransportReadThread::TcpTransportReadThread(TcpTransport& transport)
+  : transport_(transport)
+{
+}
+
+void TcpTransportReadThread::init(knowledge::KnowledgeBase& knowledge)
+{
+  const QoSTransportSettings& settings_ = transport_.settings_;
+
+  context_ = &(knowledge.get_context());
+
+  // setup the rebroadcast buffer
+  if (settings_.queue_length > 0)
+    buffer_ = new char[settings_.queue_length];
+
+  madara_logger_log(this->context_->get_logger(), logger::LOG_MAJOR,
+      "TcpTransportReadThread::init:"
+      " TcpTransportReadThread started with queue length %d\n",
+      settings_.queue_length);
+
+  if (context_)
+  {
+    // check for an on_data_received ruleset
+    if (settings_.on_data_received_logic.length() != 0)
+    {
+      madara_logger_log(this->context_->get_logger(), logger::LOG_MAJOR,
+          "TcpTransportReadThread::init:"
+          " setting rules to %s\n",
+          settings_.on_data_received_logic.c_str());
+
+#ifndef _MADARA_NO_KARL_
+      expression::Interpreter interpreter;
+      on_data_received_ = context_->compile(settings_.on_data_received_logic);
+#endif  // _MADARA_NO_KARL_
+    }
+    else
+    {
+      madara_logger_log(this->context_->get_logger(), logger::LOG_MAJOR,
+          "TcpTransportReadThread::init:"
+          " no permanent rules were set\n");
+    }
+
+    if (settings_.debug_to_kb_prefix != "")
+    {
+      knowledge::KnowledgeBase kb;
+      kb.use(*context_);
+      received_packets_.set_name(
+          settings_.debug_to_kb_prefix + ".received_packets", kb);
+      failed_receives_.set_name(
+          settings_.debug_to_kb_prefix + ".failed_receives", kb);
+      received_data_max_.set_name(
+          settings_.debug_to_kb_prefix + ".received_data_max", kb);
+      received_data_min_.set_name(
+          settings_.debug_to_kb_prefix + ".received_data_min", kb);
+      received_data_.set_name(
+          settings_.debug_to_kb_prefix + ".received_data", kb);
+    }
+  }
+
+  if (!settings_.no_receiving)
+  {
+    start_accept();
+  }
+
+  for (auto& peer : transport_.peers_)
+  {
+    transport_.start_connect(*peer);
+  }
+}
+
+void TcpTransportReadThread::cleanup(void)
+{
+  boost::system::error_code err;
+
+  for (auto& connection : connections_)
+  {
+    connection->socket.close(err);
+  }
+
+  connections_.clear();
+}
+
+void TcpTransportReadThread::run(void)
+{
+  // handlers run here, so terminate is noticed at least every 100ms
+  transport_.io_service_.run_for(std::chrono::milliseconds(100));
+}
+
+void TcpTransportReadThread::start_accept(void)
+{
+  auto connection = std::make_shared<Connection>(transport_.io_service_);
+
+  transport_.acceptor_.async_accept(connection->socket,
+      [this, connection](const boost::system::error_code& err) {
+        if (err == asio::error::operation_aborted)
+        {
+          return;
+        }
+
+        if (err)
+        {
+          madara_logger_log(this->context_->get_logger(), logger::LOG_MAJOR,
+              "TcpTransportReadThread::start_accept:"
+              " Error accepting a connection: %s\n",
+              err.message().c_str());
+        }
+        else
+        {
+          boost::system::error_code option_err;
+          connection->socket.set_option(tcp::no_delay(true), option_err);
+
+          auto remote = connection->socket.remote_endpoint(option_err);
+
+          std::stringstream remote_host;
+          remote_host << remote.address().to_string();
+          remote_host << ":";
+          remote_host << remote.port();
+          connection->remote_host = remote_host.str();
+
+          madara_logger_log(this->context_->get_logger(), logger::LOG_MAJOR,
+              "TcpTransportReadThread::start_accept:"
+              " Accepted a connection from %s\n",
+              connection->remote_host.c_str());
+
+          connections_.push_back(connection);
+          start_read(connection);
+        }
+
+        start_accept();
+      });
+}
+
+void TcpTransportReadThread::start_read(
+    const std::shared_ptr<Connection>& connection)
+{
+  std::vector<char>& buffer = connection->buffer;
+
+  if (buffer.size() - connection->used < min_read_size)
+  {
+    buffer.resize(connection->used + min_read_size);
+  }
+
+  connection->socket.async_read_some(
+      asio::buffer(buffer.data() + connection->used,
+          buffer.size() - connection->used),
+      [this, connection](
+          const boost::system::error_code& err, size_t bytes_read) {
+        static const char print_prefix[] = "TcpTransportReadThread::run";
+
+        if (err == asio::error::operation_aborted)
+        {
+          return;
+        }
+
+        if (err)
+        {
+          madara_logger_log(this->context_->get_logger(), logger::LOG_MAJOR,
+              "%s: closing connection from %s: %s\n", print_prefix,
+              connection->remote_host.c_str(), err.message().c_str());
+
+          drop(connection);
+          return;
+        }
+
+        connection->used += bytes_read;
+
+        if (!process_messages(print_prefix, *connection))
+        {
+          drop(connection);
+          return;
+        }
+
+        start_read(connection);
+      });
+}
+
+void TcpTransportReadThread::drop(
+    const std::shared_ptr<Connection>& connection)
+{
+  boost::system::error_code err;
+  connection->socket.close(err);
+
+  connections_.erase(
+      std::remove(connections_.begin(), connections_.end(), connection),
+      connections_.end());
+}
+
+bool TcpTransportReadThread::process_messages(
+    const char* print_prefix, Connection& connection)
+{
+  const QoSTransportSettings& settings_ = transport_.settings_;
+
+  const char* buffer = connection.buffer.data();
+  size_t offset = 0;
+
+  // every message starts with its total size, which frames the stream
+  while (connection.used - offset >= sizeof(uint64_t))
+  {
+    uint64_t size = MessageHeader::get_size(buffer + offset);
+
+    if (size < sizeof(uint64_t) || size > settings_.queue_length)
+    {
+      madara_logger_log(this->context_->get_logger(), logger::LOG_MAJOR,
+          "%s: %s sent a %" PRIu64 " byte message, but queue_length is %d."
+          " Closing the connection.\n",
+          print_prefix, connection.remote_host.c_str(), size,
+          (int)settings_.queue_length);
+
+      if (settings_.debug_to_kb_prefix != "")
+      {
+        ++failed_receives_;
+      }
+
+      return false;
+    }
+
+    if (connection.used - offset < size)
+    {
+      break;
+    }
+
+    receive_message(
+        print_prefix, buffer + offset, (size_t)size, connection.remote_host);
+
+    offset += (size_t)size;
+  }
+
+  // keep the start of the next message at the front of the buffer
+  if (offset > 0)
+  {
+    memmove(connection.buffer.data(), buffer + offset,
+        connection.used - offset);
+    connection.used -= offset;
+  }
+
+  return true;
+}
+
+void TcpTransportReadThread::receive_message(const char* print_prefix,
+    const char* buffer, size_t bytes_read, const std::string& remote_host)
+{
+  const QoSTransportSettings& settings_ = transport_.settings_;
+
+  if (settings_.debug_to_kb_prefix != "")
+  {
+    received_data_ += bytes_read;
+    ++received_packets_;
+
+    if (received_data_max_ < bytes_read)
+    {
+      received_data_max_ = bytes_read;
+    }
+    if (received_data_min_ > bytes_read || received_data_min_ == 0)
+    {
+      received_data_min_ = bytes_read;
+    }
+  }
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_MAJOR,
+      "%s:"
+      " received a message of %lld bytes from %s\n",
+      print_prefix, (long long)bytes_read, remote_host.c_str());
+
+  MessageHeader* header = 0;
+
+  knowledge::KnowledgeMap rebroadcast_records;
+
+  process_received_update(buffer, (uint32_t)bytes_read, transport_.id_,
+      *context_, settings_, transport_.send_monitor_,
+      transport_.receive_monitor_, rebroadcast_records,
+#ifndef _MADARA_NO_KARL_
+      on_data_received_,
+#endif  // _MADARA_NO_KARL_
+      print_prefix, remote_host.c_str(), scratch_, header);
+
+  if (header)
+  {
+    if (header->ttl > 0 && rebroadcast_records.size() > 0 &&
+        settings_.get_participant_ttl() > 0)
+    {
+      --header->ttl;
+      header->ttl = std::min(settings_.get_participant_ttl(), header->ttl);
+
+      rebroadcast(print_prefix, header, rebroadcast_records);
+    }
+  }
+}
+
+void TcpTransportReadThread::rebroadcast(const char* print_prefix,
+    MessageHeader* header, const knowledge::KnowledgeMap& records)
+{
+  const QoSTransportSettings& settings_ = transport_.settings_;
+
+  int64_t buffer_remaining = (int64_t)settings_.queue_length;
+  char* buffer = buffer_.get_ptr();
+  int result(0);
+
+  if (!settings_.no_sending && buffer != 0)
+  {
+    result = prep_rebroadcast(*context_, buffer, buffer_remaining, settings_,
+        print_prefix, header, records, transport_.packet_scheduler_);
+
+    if (result > 0)
+    {
+      // statistics are kept when the queued messages are written
+      transport_.send_message(buffer, result);
+
+      madara_logger_log(this->context_->get_logger(), logger::LOG_MAJOR,
+          "%s:"
+          " Send bandwidth = %" PRIu64 " B/s\n",
+          print_prefix, transport_.send_monitor_.get_bytes_per_second());
+    }
+  }
+}
+}
+}
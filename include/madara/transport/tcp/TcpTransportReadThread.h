@@ -0,0 +1,151 @@
+#ifndef _MADARA_TCP_TRANSPORT_READ_THREAD_H_
+#define _MADARA_TCP_TRANSPORT_READ_THREAD_H_
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "madara/utility/ScopedArray.h"
+#include "madara/knowledge/ThreadSafeContext.h"
+#include "madara/transport/BandwidthMonitor.h"
+#include "madara/transport/QoSTransportSettings.h"
+#include "madara/expression/ExpressionTree.h"
+#include "madara/transport/Transport.h"
+#include "madara/transport/MessageHeader.h"
+#include "madara/transport/tcp/TcpTransport.h"
+#include "madara/threads/BaseThread.h"
+#include "madara/Boost.h"
+
+namespace madara
+{
+namespace transport
+{
+namespace asio = boost::asio;
+namespace ip = boost::asio::ip;
+using tcp = boost::asio::ip::tcp;
+
+/**
+ * @class TcpTransportReadThread
+ * @brief Thread that runs all socket I/O of a TcpTransport: accepting
+ *        and reading incoming connections, and connecting and writing
+ *        to peers
+ **/
+class TcpTransportReadThread : public threads::BaseThread
+{
+public:
+  TcpTransportReadThread(TcpTransport& transport);
+
+  /**
+   * Initializes MADARA context-related items, starts accepting
+   * connections and connects to peers
+   * @param   knowledge   context for querying current program state
+   **/
+  void init(knowledge::KnowledgeBase& knowledge) override;
+
+  /**
+   * Cleanup function called by thread manager
+   **/
+  void cleanup(void) override;
+
+  /**
+   * The main loop internals for the read thread
+   **/
+  void run(void) override;
+
+  /**
+   * Sends a rebroadcast packet.
+   * @param  print_prefix     prefix to include before every log message,
+   *                          e.g., "MyTransport::svc"
+   * @param   header   header for the rebroadcasted packet
+   * @param   records  records to rebroadcast (already filtered for
+   *                   rebroadcast)
+   **/
+  void rebroadcast(const char* print_prefix, MessageHeader* header,
+      const knowledge::KnowledgeMap& records);
+
+protected:
+  /**
+   * An incoming connection
+   **/
+  struct Connection
+  {
+    Connection(asio::io_service& io_service) : socket(io_service) {}
+
+    /// the connection
+    tcp::socket socket;
+
+    /// bytes read but not yet processed
+    std::vector<char> buffer;
+
+    /// number of valid bytes in buffer
+    size_t used = 0;
+
+    /// host:port of the sender
+    std::string remote_host;
+  };
+
+  /// accepts the next incoming connection
+  void start_accept(void);
+
+  /// reads more of the stream from a connection
+  void start_read(const std::shared_ptr<Connection>& connection);
+
+  /// closes a connection and forgets it
+  void drop(const std::shared_ptr<Connection>& connection);
+
+  /**
+   * Applies every complete message in a connection's buffer
+   * @param  print_prefix     prefix to include before every log message
+   * @param  connection       the connection that was read from
+   * @return  false if the stream is corrupt and must be closed
+   **/
+  bool process_messages(
+      const char* print_prefix, Connection& connection);
+
+  /**
+   * Updates receive statistics and applies a received message
+   * @param  print_prefix     prefix to include before every log message
+   * @param  buffer           the message
+   * @param  bytes_read       size of the message
+   * @param  remote_host      the sender of the message
+   **/
+  void receive_message(const char* print_prefix, const char* buffer,
+      size_t bytes_read, const std::string& remote_host);
+
+  TcpTransport& transport_;
+
+  knowledge::ThreadSafeContext* context_ = nullptr;
+
+#ifndef _MADARA_NO_KARL_
+  /// data received rules, defined in Transport settings
+  madara::knowledge::CompiledExpression on_data_received_;
+#endif  // _MADARA_NO_KARL_
+
+  /// incoming connections
+  std::vector<std::shared_ptr<Connection>> connections_;
+
+  /// buffer for rebroadcasting
+  madara::utility::ScopedArray<char> buffer_;
+
+  /// storage reused when decoding received packets
+  ReceiveScratch scratch_;
+
+  /// received packets
+  knowledge::containers::Integer received_packets_;
+
+  /// bad receives
+  knowledge::containers::Integer failed_receives_;
+
+  /// received data
+  knowledge::containers::Integer received_data_;
+
+  /// max data received
+  knowledge::containers::Integer received_data_max_;
+
+  /// min data received
+  knowledge::containers::Integer received_data_min_;
+};
+}
+}
+
+#endif  // _MADARA_TCP_TRANSPORT_READ_THREAD_H_
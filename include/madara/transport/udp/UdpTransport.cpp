@@ -7,6 +7,14 @@
 #include "madara/utility/Utility.h"
 
 #include <iostream>
+#include <algorithm>
+
+#ifdef _MADARA_USE_MMSG_
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <errno.h>
+#include <string.h>
+#endif
 
 namespace madara
 {
@@ -169,12 +177,127 @@ long UdpTransport::send_buffer(
   return (long)bytes_sent;
 }
 
+long UdpTransport::send_batch(const std::vector<Datagram>& datagrams)
+{
+  uint64_t bytes_sent = 0;
+
+#ifdef _MADARA_USE_MMSG_
+  // the kernel caps the number of messages per sendmmsg call (UIO_MAXIOV)
+  static const size_t max_messages = 1024;
+
+  std::vector<struct iovec> iovecs;
+  std::vector<size_t> targets;
+  iovecs.reserve(datagrams.size() * addresses_.size());
+  targets.reserve(datagrams.size() * addresses_.size());
+
+  for (const auto& datagram : datagrams)
+  {
+    for (size_t i = 0; i < addresses_.size(); ++i)
+    {
+      if (pre_send_buffer(i))
+      {
+        struct iovec iov;
+        iov.iov_base = (void*)datagram.first;
+        iov.iov_len = datagram.second;
+        iovecs.push_back(iov);
+        targets.push_back(i);
+      }
+    }
+  }
+
+  std::vector<struct mmsghdr> messages(iovecs.size());
+
+  for (size_t i = 0; i < messages.size(); ++i)
+  {
+    struct msghdr& header = messages[i].msg_hdr;
+    memset(&header, 0, sizeof(header));
+    header.msg_name = (void*)addresses_[targets[i]].data();
+    header.msg_namelen = (socklen_t)addresses_[targets[i]].size();
+    header.msg_iov = &iovecs[i];
+    header.msg_iovlen = 1;
+  }
+
+  size_t sent = 0;
+
+  while (sent < messages.size() && batch_supported_)
+  {
+    int result = ::sendmmsg(socket_.native_handle(), &messages[sent],
+        (unsigned int)std::min(messages.size() - sent, max_messages), 0);
+
+    if (result <= 0)
+    {
+      if (result < 0 && errno == ENOSYS)
+      {
+        batch_supported_ = false;
+      }
+
+      madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+          "UdpTransport::send_batch:"
+          " sendmmsg stopped after %d of %d datagrams: %s\n",
+          (int)sent, (int)messages.size(), strerror(errno));
+      break;
+    }
+
+    for (size_t i = sent; i < sent + result; ++i)
+    {
+      uint64_t actual_sent = messages[i].msg_len;
+      bytes_sent += actual_sent;
+
+      if (settings_.debug_to_kb_prefix != "")
+      {
+        ++sent_packets;
+        sent_data += actual_sent;
+        if (sent_data_max < actual_sent)
+        {
+          sent_data_max = actual_sent;
+        }
+        if (sent_data_min > actual_sent || sent_data_min == 0)
+        {
+          sent_data_min = actual_sent;
+        }
+      }
+    }
+
+    madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+        "UdpTransport::send_batch: Sent %d datagrams in one call\n",
+        result);
+
+    sent += result;
+  }
+
+  // whatever the OS refused goes through the retrying path
+  for (; sent < messages.size(); ++sent)
+  {
+    bytes_sent += send_buffer(addresses_[targets[sent]],
+        (const char*)iovecs[sent].iov_base, iovecs[sent].iov_len);
+  }
+#else
+  for (const auto& datagram : datagrams)
+  {
+    for (size_t i = 0; i < addresses_.size(); ++i)
+    {
+      if (pre_send_buffer(i))
+      {
+        bytes_sent +=
+            send_buffer(addresses_[i], datagram.first, datagram.second);
+      }
+    }
+  }
+#endif
+
+  return (long)bytes_sent;
+}
+
 long UdpTransport::send_message(const char* buf, size_t packet_size)
 {
   static const char print_prefix[] = "UdpTransport::send_message";
 
   uint64_t bytes_sent = 0;
 
+  // rate limits and slack time need a pause between datagrams
+  bool batch = settings_.batch_datagrams && batch_supported_ &&
+               settings_.max_send_hertz <= 0 && settings_.slack_time <= 0;
+
   if (packet_size > settings_.max_fragment_size)
   {
     FragmentMap map;
@@ -188,26 +311,47 @@ long UdpTransport::send_message(const char* buf, size_t packet_size)
     // fragment the message
     frag(buf, settings_.max_fragment_size, map);
 
-    int j(0);
-    for (FragmentMap::iterator i = map.begin(); i != map.end(); ++i, ++j)
+    if (batch)
     {
+      std::vector<Datagram> fragments;
+      fragments.reserve(map.size());
+
+      for (FragmentMap::iterator i = map.begin(); i != map.end(); ++i)
+      {
+        fragments.emplace_back(
+            i->second, (size_t)MessageHeader::get_size(i->second));
+      }
+
       madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
           "%s:"
-          " Sending fragment %d\n",
-          print_prefix, j);
+          " Sending %d fragments as a batch\n",
+          print_prefix, (int)fragments.size());
 
-      for (const auto& address : addresses_)
+      bytes_sent += send_batch(fragments);
+    }
+    else
+    {
+      int j(0);
+      for (FragmentMap::iterator i = map.begin(); i != map.end(); ++i, ++j)
       {
-        if (pre_send_buffer(&address - &*addresses_.begin()))
+        madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+            "%s:"
+            " Sending fragment %d\n",
+            print_prefix, j);
+
+        for (const auto& address : addresses_)
         {
-          bytes_sent += send_buffer(
-              address, i->second, (size_t)MessageHeader::get_size(i->second));
+          if (pre_send_buffer(&address - &*addresses_.begin()))
+          {
+            bytes_sent += send_buffer(address, i->second,
+                (size_t)MessageHeader::get_size(i->second));
+          }
         }
-      }
 
-      // sleep between fragments, if such a slack time is specified
-      if (settings_.slack_time > 0)
-        utility::sleep(settings_.slack_time);
+        // sleep between fragments, if such a slack time is specified
+        if (settings_.slack_time > 0)
+          utility::sleep(settings_.slack_time);
+      }
     }
 
     madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
@@ -217,6 +361,16 @@ long UdpTransport::send_message(const char* buf, size_t packet_size)
 
     delete_fragments(map);
   }
+  else if (batch)
+  {
+    madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
+        "%s:"
+        " Sending packet of size %ld as a batch\n",
+        print_prefix, packet_size);
+
+    bytes_sent +=
+        send_batch(std::vector<Datagram>(1, Datagram(buf, packet_size)));
+  }
   else
   {
     madara_logger_log(context_.get_logger(), logger::LOG_MAJOR,
@@ -12,9 +12,16 @@
 
 #include <string>
 #include <map>
+#include <atomic>
 
 #include "madara/Boost.h"
 
+// sendmmsg and recvmmsg are Linux-only. Define _MADARA_NO_MMSG_ to always
+// use one system call per datagram.
+#if defined(__linux__) && !defined(_MADARA_NO_MMSG_)
+#define _MADARA_USE_MMSG_
+#endif
+
 namespace madara
 {
 namespace transport
@@ -84,6 +91,21 @@ protected:
 
   long send_message(const char* buf, size_t size);
   long send_buffer(const udp::endpoint& target, const char* buf, size_t size);
+
+  /// a datagram to send to every address that pre_send_buffer allows
+  typedef std::pair<const char*, size_t> Datagram;
+
+  /**
+   * Sends every datagram to every address, in as few system calls as the
+   * platform allows. Datagrams the OS does not accept in a batch are sent
+   * through send_buffer, which honors resend_attempts.
+   * @param  datagrams   the datagrams (e.g., fragments) to send, in order
+   * @return  total bytes sent
+   **/
+  long send_batch(const std::vector<Datagram>& datagrams);
+
+  /// false once the OS has told us sendmmsg is not implemented
+  std::atomic<bool> batch_supported_{true};
   virtual bool pre_send_buffer(size_t addr_index)
   {
     return addr_index != 0;
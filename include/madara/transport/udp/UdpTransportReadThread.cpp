@@ -4,6 +4,12 @@
 #include "madara/transport/ReducedMessageHeader.h"
 
 #include <iostream>
+#include <algorithm>
+
+#ifdef _MADARA_USE_MMSG_
+#include <errno.h>
+#include <string.h>
+#endif
 
 namespace madara
 {
@@ -67,6 +73,34 @@ void UdpTransportReadThread::init(knowledge::KnowledgeBase& knowledge)
           settings_.debug_to_kb_prefix + ".received_data", kb);
     }
   }
+
+#ifdef _MADARA_USE_MMSG_
+  if (settings_.batch_datagrams && transport_.batch_supported_)
+  {
+    // a UDP datagram is never larger than 64KB
+    batch_slot_size_ = std::min<size_t>(settings_.queue_length, 65536);
+
+    if (batch_slot_size_ > 0)
+    {
+      batch_buffer_.resize(receive_batch_size * batch_slot_size_);
+      batch_messages_.resize(receive_batch_size);
+      batch_iovecs_.resize(receive_batch_size);
+      batch_addresses_.resize(receive_batch_size);
+
+      for (size_t i = 0; i < receive_batch_size; ++i)
+      {
+        batch_iovecs_[i].iov_base = &batch_buffer_[i * batch_slot_size_];
+        batch_iovecs_[i].iov_len = batch_slot_size_;
+
+        struct msghdr& header = batch_messages_[i].msg_hdr;
+        memset(&header, 0, sizeof(header));
+        header.msg_name = &batch_addresses_[i];
+        header.msg_iov = &batch_iovecs_[i];
+        header.msg_iovlen = 1;
+      }
+    }
+  }
+#endif
 }
 
 void UdpTransportReadThread::cleanup(void) {}
@@ -151,6 +185,19 @@ void UdpTransportReadThread::run(void)
     return;
   }
 
+#ifdef _MADARA_USE_MMSG_
+  if (batch_messages_.size() > 0)
+  {
+    if (receive_batch(print_prefix))
+    {
+      return;
+    }
+
+    // recvmmsg is not implemented, so read one datagram at a time
+    batch_messages_.clear();
+  }
+#endif
+
   madara_logger_log(this->context_->get_logger(), logger::LOG_MINOR,
       "%s: entering a recv on the socket.\n", print_prefix);
 
@@ -186,6 +233,19 @@ void UdpTransportReadThread::run(void)
     return;
   }
 
+  receive_datagram(print_prefix, buffer, bytes_read, remote);
+
+  madara_logger_log(this->context_->get_logger(), logger::LOG_MAJOR,
+      "%s:"
+      " finished iteration.\n",
+      print_prefix);
+}
+
+void UdpTransportReadThread::receive_datagram(const char* print_prefix,
+    char* buffer, size_t bytes_read, const udp::endpoint& remote)
+{
+  const QoSTransportSettings& settings_ = transport_.settings_;
+
   if (settings_.debug_to_kb_prefix != "")
   {
     received_data_ += bytes_read;
@@ -232,7 +292,7 @@ void UdpTransportReadThread::run(void)
 #ifndef _MADARA_NO_KARL_
       on_data_received_,
 #endif  // _MADARA_NO_KARL_
-      print_prefix, remote_host.str().c_str(), header);
+      print_prefix, remote_host.str().c_str(), scratch_, header);
 
   if (header)
   {
@@ -244,15 +304,83 @@ void UdpTransportReadThread::run(void)
 
       rebroadcast(print_prefix, header, rebroadcast_records);
     }
+  }
+}
+
+#ifdef _MADARA_USE_MMSG_
+bool UdpTransportReadThread::receive_batch(const char* print_prefix)
+{
+  const QoSTransportSettings& settings_ = transport_.settings_;
+
+  madara_logger_log(this->context_->get_logger(), logger::LOG_MINOR,
+      "%s: entering a batched recv on the socket.\n", print_prefix);
 
-    // delete header
-    delete header;
+  for (auto& message : batch_messages_)
+  {
+    message.msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+    message.msg_hdr.msg_flags = 0;
+  }
+
+  int count = ::recvmmsg(transport_.socket_.native_handle(),
+      batch_messages_.data(), (unsigned int)batch_messages_.size(),
+      MSG_DONTWAIT, nullptr);
+
+  if (count <= 0)
+  {
+    if (count < 0 && errno == ENOSYS)
+    {
+      return false;
+    }
+
+    madara_logger_log(this->context_->get_logger(), logger::LOG_MINOR,
+        "%s: no bytes to read. Proceeding to next wait\n", print_prefix);
+
+    if (settings_.debug_to_kb_prefix != "")
+    {
+      ++failed_receives_;
+    }
+
+    return true;
+  }
+
+  madara_logger_log(this->context_->get_logger(), logger::LOG_MINOR,
+      "%s: received %d datagrams in one call\n", print_prefix, count);
+
+  for (int i = 0; i < count; ++i)
+  {
+    const struct msghdr& header = batch_messages_[i].msg_hdr;
+
+    if (header.msg_flags & MSG_TRUNC)
+    {
+      madara_logger_log(this->context_->get_logger(), logger::LOG_MAJOR,
+          "%s: dropping datagram larger than %d bytes\n", print_prefix,
+          (int)batch_slot_size_);
+
+      if (settings_.debug_to_kb_prefix != "")
+      {
+        ++failed_receives_;
+      }
+
+      continue;
+    }
+
+    udp::endpoint remote;
+    size_t address_size =
+        std::min<size_t>(header.msg_namelen, remote.capacity());
+    memcpy(remote.data(), header.msg_name, address_size);
+    remote.resize(address_size);
+
+    receive_datagram(print_prefix, &batch_buffer_[i * batch_slot_size_],
+        batch_messages_[i].msg_len, remote);
   }
 
   madara_logger_log(this->context_->get_logger(), logger::LOG_MAJOR,
       "%s:"
       " finished iteration.\n",
       print_prefix);
+
+  return true;
 }
+#endif
 }
 }
@@ -14,6 +14,11 @@
 #include "madara/threads/BaseThread.h"
 #include "madara/Boost.h"
 
+#ifdef _MADARA_USE_MMSG_
+#include <sys/socket.h>
+#include <vector>
+#endif
+
 namespace madara
 {
 namespace transport
@@ -59,6 +64,39 @@ public:
       const knowledge::KnowledgeMap& records);
 
 protected:
+  /**
+   * Updates receive statistics and applies a received datagram
+   * @param  print_prefix     prefix to include before every log message
+   * @param  buffer           the datagram
+   * @param  bytes_read       size of the datagram
+   * @param  remote           the sender of the datagram
+   **/
+  void receive_datagram(const char* print_prefix, char* buffer,
+      size_t bytes_read, const udp::endpoint& remote);
+
+#ifdef _MADARA_USE_MMSG_
+  /**
+   * Drains up to receive_batch_size datagrams with one recvmmsg call
+   * @param  print_prefix     prefix to include before every log message
+   * @return  false if recvmmsg is not supported
+   **/
+  bool receive_batch(const char* print_prefix);
+
+  /// max datagrams read per recvmmsg call
+  static const size_t receive_batch_size = 32;
+
+  /// receive_batch_size buffers, each large enough for one datagram
+  std::vector<char> batch_buffer_;
+
+  /// size of each buffer in batch_buffer_
+  size_t batch_slot_size_ = 0;
+
+  /// recvmmsg arguments, one per datagram
+  std::vector<struct mmsghdr> batch_messages_;
+  std::vector<struct iovec> batch_iovecs_;
+  std::vector<struct sockaddr_storage> batch_addresses_;
+#endif
+
   UdpTransport& transport_;
 
   knowledge::ThreadSafeContext* context_ = nullptr;
@@ -71,6 +109,9 @@ protected:
   /// buffer for receiving
   madara::utility::ScopedArray<char> buffer_;
 
+  /// storage reused when decoding received packets
+  ReceiveScratch scratch_;
+
   /// received packets
   knowledge::containers::Integer received_packets_;
 
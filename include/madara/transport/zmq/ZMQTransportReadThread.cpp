@@ -348,18 +348,12 @@ void madara::transport::ZMQTransportReadThread::run(void)
 #ifndef _MADARA_NO_KARL_
           on_data_received_,
 #endif  // _MADARA_NO_KARL_
-          print_prefix, header->originator, header);
+          print_prefix, header->originator, scratch_, header);
 
       madara_logger_log(context_->get_logger(), logger::LOG_MINOR,
           "%s:"
           " done processing %d byte update from %s.\n",
           print_prefix, (int)buffer_remaining, header->originator);
-
-      if (header)
-      {
-        // delete header
-        delete header;
-      }
     }
     else
     {
@@ -0,0 +1,180 @@
+#ifndef _MADARA_UTILITY_BOUNDED_QUEUE_H_
+#define _MADARA_UTILITY_BOUNDED_QUEUE_H_
+
+/**
+ * @file BoundedQueue.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the BoundedQueue class, a fixed-size lock-free queue
+ **/
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace madara
+{
+namespace utility
+{
+/**
+ * @class BoundedQueue
+ * @brief A lock-free queue of a fixed number of elements, which any number
+ *        of threads may push to and pop from at once. Each slot carries a
+ *        sequence number that says whether it is free to push to or ready
+ *        to pop from, so pushes and pops only contend on the head or tail
+ *        counter, and never wait on one another. Elements are moved into
+ *        and out of slots, and a popped slot keeps a moved-from element.
+ **/
+template<typename T>
+class BoundedQueue
+{
+public:
+  /**
+   * Constructor
+   * @param  capacity  the most elements the queue holds, rounded up to a
+   *                   power of two
+   **/
+  explicit BoundedQueue(size_t capacity)
+  {
+    size_t size = 2;
+    while (size < capacity)
+    {
+      size <<= 1;
+    }
+
+    slots_.reset(new Slot[size]);
+    mask_ = size - 1;
+
+    for (size_t i = 0; i < size; ++i)
+    {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  BoundedQueue(const BoundedQueue&) = delete;
+  BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+  /**
+   * Adds an element to the back of the queue
+   * @param  value  the element, which is only moved from if it was added
+   * @return false if the queue is full
+   **/
+  bool try_push(T& value)
+  {
+    size_t position = tail_.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+      Slot& slot = slots_[position & mask_];
+      size_t sequence = slot.sequence.load(std::memory_order_acquire);
+      intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+
+      if (difference == 0)
+      {
+        if (tail_.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed))
+        {
+          slot.value = std::move(value);
+          slot.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      }
+      else if (difference < 0)
+      {
+        return false;
+      }
+      else
+      {
+        position = tail_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /**
+   * Removes the element at the front of the queue
+   * @param  value  set to the element, if there was one
+   * @return false if the queue is empty
+   **/
+  bool try_pop(T& value)
+  {
+    size_t position = head_.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+      Slot& slot = slots_[position & mask_];
+      size_t sequence = slot.sequence.load(std::memory_order_acquire);
+      intptr_t difference = (intptr_t)sequence - (intptr_t)(position + 1);
+
+      if (difference == 0)
+      {
+        if (head_.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed))
+        {
+          value = std::move(slot.value);
+          slot.sequence.store(position + mask_ + 1, std::memory_order_release);
+          return true;
+        }
+      }
+      else if (difference < 0)
+      {
+        return false;
+      }
+      else
+      {
+        position = head_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /**
+   * Returns the most elements the queue holds
+   **/
+  size_t capacity(void) const
+  {
+    return mask_ + 1;
+  }
+
+  /**
+   * Returns the number of elements in the queue, which may already have
+   * changed if other threads are using it
+   **/
+  size_t size(void) const
+  {
+    size_t head = head_.load(std::memory_order_relaxed);
+    size_t tail = tail_.load(std::memory_order_relaxed);
+
+    return tail > head ? tail - head : 0;
+  }
+
+private:
+  struct Slot
+  {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  /// the slots, a power of two of them
+  std::unique_ptr<Slot[]> slots_;
+
+  /// the number of slots less one, to wrap positions
+  size_t mask_ = 0;
+
+  /// keeps the head and tail counters on separate cache lines
+  char padding0_[64];
+
+  /// the position of the next pop
+  std::atomic<size_t> head_{0};
+
+  char padding1_[64];
+
+  /// the position of the next push
+  std::atomic<size_t> tail_{0};
+
+  char padding2_[64];
+};
+}
+}
+
+#endif  // _MADARA_UTILITY_BOUNDED_QUEUE_H_
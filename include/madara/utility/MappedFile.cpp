@@ -0,0 +1,188 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace madara
+{
+namespace utility
+{
+MappedFile::~MappedFile()
+{
+  close();
+}
+
+MappedFile::MappedFile(MappedFile&& rhs) noexcept
+  : data_(rhs.data_),
+    size_(rhs.size_)
+#ifdef _WIN32
+    ,
+    mapping_(rhs.mapping_)
+#endif
+{
+  rhs.data_ = 0;
+  rhs.size_ = 0;
+#ifdef _WIN32
+  rhs.mapping_ = 0;
+#endif
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& rhs) noexcept
+{
+  if (this != &rhs)
+  {
+    close();
+
+    data_ = rhs.data_;
+    size_ = rhs.size_;
+    rhs.data_ = 0;
+    rhs.size_ = 0;
+#ifdef _WIN32
+    mapping_ = rhs.mapping_;
+    rhs.mapping_ = 0;
+#endif
+  }
+
+  return *this;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& filename)
+{
+  close();
+
+  HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+      0, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, 0);
+
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    return false;
+  }
+
+  LARGE_INTEGER size;
+
+  if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+  {
+    mapping_ = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+
+    if (mapping_)
+    {
+      data_ = (const char*)MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+
+      if (data_)
+      {
+        size_ = (size_t)size.QuadPart;
+      }
+      else
+      {
+        CloseHandle(mapping_);
+        mapping_ = 0;
+      }
+    }
+  }
+
+  // the mapping keeps the file open
+  CloseHandle(file);
+
+  return data_ != 0;
+}
+
+void MappedFile::close(void)
+{
+  if (data_)
+  {
+    UnmapViewOfFile(data_);
+    CloseHandle(mapping_);
+  }
+
+  data_ = 0;
+  size_ = 0;
+  mapping_ = 0;
+}
+
+void MappedFile::release(size_t offset, size_t length)
+{
+  // views of files cannot give back part of their pages
+  (void)offset;
+  (void)length;
+}
+
+#else
+
+bool MappedFile::open(const std::string& filename)
+{
+  close();
+
+  int file = ::open(filename.c_str(), O_RDONLY);
+
+  if (file < 0)
+  {
+    return false;
+  }
+
+  struct stat status;
+
+  if (fstat(file, &status) == 0 && status.st_size > 0)
+  {
+    void* data = mmap(
+        0, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+
+    if (data != MAP_FAILED)
+    {
+      data_ = (const char*)data;
+      size_ = (size_t)status.st_size;
+
+      madvise(data, size_, MADV_SEQUENTIAL);
+    }
+  }
+
+  // the mapping keeps the file open
+  ::close(file);
+
+  return data_ != 0;
+}
+
+void MappedFile::close(void)
+{
+  if (data_)
+  {
+    munmap((void*)data_, size_);
+  }
+
+  data_ = 0;
+  size_ = 0;
+}
+
+void MappedFile::release(size_t offset, size_t length)
+{
+  if (!data_ || offset >= size_)
+  {
+    return;
+  }
+
+  if (length > size_ - offset)
+  {
+    length = size_ - offset;
+  }
+
+  // only whole pages can be given back
+  size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  size_t first = (offset + page - 1) / page * page;
+  size_t end = (offset + length) / page * page;
+
+  if (first < end)
+  {
+    madvise((void*)(data_ + first), end - first, MADV_DONTNEED);
+  }
+}
+
+#endif
+}
+}
@@ -0,0 +1,115 @@
+#ifndef _MADARA_UTILITY_MAPPED_FILE_H_
+#define _MADARA_UTILITY_MAPPED_FILE_H_
+
+/**
+ * @file MappedFile.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the MappedFile class, which maps a file into memory
+ * for reading
+ **/
+
+#include <string>
+#include <stddef.h>
+
+#include "madara/MadaraExport.h"
+
+namespace madara
+{
+namespace utility
+{
+/**
+ * @class MappedFile
+ * @brief A whole file mapped read-only into memory. Pages are read from
+ *        the file as they are first touched, rather than copied into a
+ *        buffer up front, and can be given back once they have been read.
+ **/
+class MADARA_EXPORT MappedFile
+{
+public:
+  /**
+   * Constructor
+   **/
+  MappedFile() = default;
+
+  /**
+   * Destructor. Unmaps the file.
+   **/
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /**
+   * Move constructor
+   * @param  rhs   the mapping to take over
+   **/
+  MappedFile(MappedFile&& rhs) noexcept;
+
+  /**
+   * Move assignment
+   * @param  rhs   the mapping to take over
+   **/
+  MappedFile& operator=(MappedFile&& rhs) noexcept;
+
+  /**
+   * Maps a file, unmapping any file already mapped
+   * @param  filename  the file to map
+   * @return true if the file was mapped. Empty files cannot be mapped.
+   **/
+  bool open(const std::string& filename);
+
+  /**
+   * Unmaps the file
+   **/
+  void close(void);
+
+  /**
+   * Checks if a file is mapped
+   **/
+  bool is_open(void) const
+  {
+    return data_ != 0;
+  }
+
+  /**
+   * Returns the contents of the file
+   **/
+  const char* data(void) const
+  {
+    return data_;
+  }
+
+  /**
+   * Returns the size of the file in bytes
+   **/
+  size_t size(void) const
+  {
+    return size_;
+  }
+
+  /**
+   * Gives back the memory of the whole pages in a range of the file that
+   * will not be read again soon. They are read from the file again if
+   * they are touched later.
+   * @param  offset  the start of the range
+   * @param  length  the length of the range in bytes
+   **/
+  void release(size_t offset, size_t length);
+
+private:
+  /// the contents of the file
+  const char* data_ = 0;
+
+  /// the size of the file
+  size_t size_ = 0;
+
+#ifdef _WIN32
+  /// the file mapping object
+  void* mapping_ = 0;
+#endif
+};
+}
+}
+
+#endif  // _MADARA_UTILITY_MAPPED_FILE_H_
@@ -0,0 +1,286 @@
+#ifndef _MADARA_UTILITY_SHAREDRECURSIVEMUTEX_H_
+#define _MADARA_UTILITY_SHAREDRECURSIVEMUTEX_H_
+
+/**
+ * @file SharedRecursiveMutex.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains a recursive reader/writer mutex that can be used
+ * as the MADARA_LOCK_TYPE of a ThreadSafeContext
+ **/
+
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <utility>
+#include <condition_variable>
+
+namespace madara
+{
+namespace utility
+{
+/**
+ * @class SharedRecursiveMutex
+ * @brief A recursive mutex that allows multiple concurrent readers.
+ *
+ *        lock/unlock/try_lock provide exclusive, recursive ownership
+ *        and behave like std::recursive_mutex, so the class can be used
+ *        with std::lock_guard and std::condition_variable_any.
+ *        lock_shared/unlock_shared provide shared ownership. A thread
+ *        that holds exclusive ownership may take shared ownership (it
+ *        is treated as another level of exclusive ownership), and a
+ *        thread that holds shared ownership may reenter shared
+ *        ownership even while writers are waiting. Writers are given
+ *        preference over new readers to avoid writer starvation.
+ *
+ *        A reader that requests exclusive ownership is upgraded once
+ *        all other readers have left. Two readers upgrading at the same
+ *        time will deadlock, so read-only sections should never call
+ *        into methods that take exclusive ownership.
+ **/
+class SharedRecursiveMutex
+{
+public:
+  /**
+   * Constructor
+   **/
+  SharedRecursiveMutex() : depth_(0), readers_(0), waiting_writers_(0)
+  {
+    reader_depths_.reserve(16);
+  }
+
+  SharedRecursiveMutex(const SharedRecursiveMutex&) = delete;
+  SharedRecursiveMutex& operator=(const SharedRecursiveMutex&) = delete;
+
+  /**
+   * Acquires exclusive ownership, blocking until available
+   **/
+  inline void lock(void)
+  {
+    std::thread::id me = std::this_thread::get_id();
+    std::unique_lock<std::mutex> guard(mutex_);
+
+    if (depth_ > 0 && owner_ == me)
+    {
+      ++depth_;
+      return;
+    }
+
+    size_t mine = reader_depth(me);
+
+    ++waiting_writers_;
+    while (depth_ > 0 || readers_ > mine)
+    {
+      writers_.wait(guard);
+    }
+    --waiting_writers_;
+
+    owner_ = me;
+    depth_ = 1;
+  }
+
+  /**
+   * Attempts to acquire exclusive ownership without blocking
+   * @return  true if ownership was acquired
+   **/
+  inline bool try_lock(void)
+  {
+    std::thread::id me = std::this_thread::get_id();
+    std::lock_guard<std::mutex> guard(mutex_);
+
+    if (depth_ > 0)
+    {
+      if (owner_ != me)
+        return false;
+
+      ++depth_;
+      return true;
+    }
+
+    if (readers_ > reader_depth(me))
+      return false;
+
+    owner_ = me;
+    depth_ = 1;
+    return true;
+  }
+
+  /**
+   * Releases one level of exclusive ownership
+   **/
+  inline void unlock(void)
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+
+    if (depth_ > 0 && --depth_ == 0)
+    {
+      owner_ = std::thread::id();
+      notify();
+    }
+  }
+
+  /**
+   * Acquires shared ownership, blocking while another thread is
+   * writing or waiting to write
+   **/
+  inline void lock_shared(void)
+  {
+    std::thread::id me = std::this_thread::get_id();
+    std::unique_lock<std::mutex> guard(mutex_);
+
+    if (depth_ > 0 && owner_ == me)
+    {
+      ++depth_;
+      return;
+    }
+
+    // reentrant readers skip writer preference or they could deadlock
+    // against a writer that is waiting on them
+    if (reader_depth(me) == 0)
+    {
+      while (depth_ > 0 || waiting_writers_ > 0)
+      {
+        readers_cond_.wait(guard);
+      }
+    }
+
+    add_reader(me);
+  }
+
+  /**
+   * Releases one level of shared ownership
+   **/
+  inline void unlock_shared(void)
+  {
+    std::thread::id me = std::this_thread::get_id();
+    std::lock_guard<std::mutex> guard(mutex_);
+
+    if (remove_reader(me))
+    {
+      if (readers_ == 0 || waiting_writers_ > 0)
+        writers_.notify_all();
+    }
+    else if (depth_ > 0 && owner_ == me && --depth_ == 0)
+    {
+      owner_ = std::thread::id();
+      notify();
+    }
+  }
+
+private:
+  /// wakes up waiters after exclusive ownership has been released
+  inline void notify(void)
+  {
+    if (waiting_writers_ > 0)
+      writers_.notify_all();
+    else
+      readers_cond_.notify_all();
+  }
+
+  /// returns the shared depth held by a thread. Caller holds mutex_
+  inline size_t reader_depth(std::thread::id id) const
+  {
+    for (auto& entry : reader_depths_)
+    {
+      if (entry.first == id)
+        return entry.second;
+    }
+    return 0;
+  }
+
+  /// adds a level of shared ownership. Caller holds mutex_
+  inline void add_reader(std::thread::id id)
+  {
+    ++readers_;
+
+    for (auto& entry : reader_depths_)
+    {
+      if (entry.first == id)
+      {
+        ++entry.second;
+        return;
+      }
+    }
+    reader_depths_.emplace_back(id, 1);
+  }
+
+  /// removes a level of shared ownership. Caller holds mutex_
+  inline bool remove_reader(std::thread::id id)
+  {
+    for (auto i = reader_depths_.begin(); i != reader_depths_.end(); ++i)
+    {
+      if (i->first == id)
+      {
+        --readers_;
+
+        if (--i->second == 0)
+        {
+          *i = reader_depths_.back();
+          reader_depths_.pop_back();
+        }
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// protects all bookkeeping below
+  std::mutex mutex_;
+
+  /// writers wait here for readers and other writers to leave
+  std::condition_variable writers_;
+
+  /// new readers wait here for writers to leave
+  std::condition_variable readers_cond_;
+
+  /// thread holding exclusive ownership
+  std::thread::id owner_;
+
+  /// recursion depth of exclusive ownership
+  size_t depth_;
+
+  /// total shared ownership count across all threads
+  size_t readers_;
+
+  /// number of threads waiting for exclusive ownership
+  size_t waiting_writers_;
+
+  /// per-thread shared ownership depths
+  std::vector<std::pair<std::thread::id, size_t>> reader_depths_;
+};
+
+/**
+ * @class SharedGuard
+ * @brief RAII guard for shared ownership of a SharedRecursiveMutex
+ **/
+template<typename Mutex>
+class SharedGuard
+{
+public:
+  /**
+   * Constructor. Acquires shared ownership.
+   * @param  mutex   the mutex to hold in shared mode
+   **/
+  explicit SharedGuard(Mutex& mutex) : mutex_(mutex)
+  {
+    mutex_.lock_shared();
+  }
+
+  /**
+   * Destructor. Releases shared ownership.
+   **/
+  ~SharedGuard()
+  {
+    mutex_.unlock_shared();
+  }
+
+  SharedGuard(const SharedGuard&) = delete;
+  SharedGuard& operator=(const SharedGuard&) = delete;
+
+private:
+  Mutex& mutex_;
+};
+}
+}
+
+#endif  // _MADARA_UTILITY_SHAREDRECURSIVEMUTEX_H_
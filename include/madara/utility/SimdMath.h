@@ -0,0 +1,687 @@
+#ifndef _MADARA_UTILITY_SIMD_MATH_H_
+#define _MADARA_UTILITY_SIMD_MATH_H_
+
+/**
+ * @file SimdMath.h
+ * @author James Edmondson <jedmondson@gmail.com>
+ *
+ * This file contains the element-wise arithmetic, comparison and reduction
+ * kernels used for integer and double arrays. Where SSE2 is available, and
+ * MADARA_NO_SIMD is not defined, the kernels work on two elements at a time.
+ **/
+
+#include <stddef.h>
+#include <type_traits>
+
+#include "madara/utility/IntTypes.h"
+
+#if !defined(MADARA_NO_SIMD) &&                  \
+    (defined(__SSE2__) || defined(_M_X64) ||     \
+        (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define MADARA_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace madara
+{
+namespace utility
+{
+namespace simd
+{
+/// adds elements
+struct Add
+{
+  template<typename T>
+  static T scalar(T a, T b)
+  {
+    return a + b;
+  }
+
+#ifdef MADARA_SIMD_SSE2
+  static __m128d vector(__m128d a, __m128d b)
+  {
+    return _mm_add_pd(a, b);
+  }
+
+  static __m128i vector(__m128i a, __m128i b)
+  {
+    return _mm_add_epi64(a, b);
+  }
+#endif
+};
+
+/// subtracts elements
+struct Subtract
+{
+  template<typename T>
+  static T scalar(T a, T b)
+  {
+    return a - b;
+  }
+
+#ifdef MADARA_SIMD_SSE2
+  static __m128d vector(__m128d a, __m128d b)
+  {
+    return _mm_sub_pd(a, b);
+  }
+
+  static __m128i vector(__m128i a, __m128i b)
+  {
+    return _mm_sub_epi64(a, b);
+  }
+#endif
+};
+
+/// multiplies elements
+struct Multiply
+{
+  template<typename T>
+  static T scalar(T a, T b)
+  {
+    return a * b;
+  }
+
+#ifdef MADARA_SIMD_SSE2
+  static __m128d vector(__m128d a, __m128d b)
+  {
+    return _mm_mul_pd(a, b);
+  }
+#endif
+};
+
+/// divides elements. Integer divisors must not be zero.
+struct Divide
+{
+  template<typename T>
+  static T scalar(T a, T b)
+  {
+    return a / b;
+  }
+
+#ifdef MADARA_SIMD_SSE2
+  static __m128d vector(__m128d a, __m128d b)
+  {
+    return _mm_div_pd(a, b);
+  }
+#endif
+};
+
+/// takes the modulus of integer elements. Divisors must not be zero.
+struct Modulus
+{
+  static int64_t scalar(int64_t a, int64_t b)
+  {
+    return a % b;
+  }
+};
+
+/// compares elements with <
+struct Less
+{
+  template<typename T>
+  static bool scalar(T a, T b)
+  {
+    return a < b;
+  }
+
+#ifdef MADARA_SIMD_SSE2
+  static __m128d vector(__m128d a, __m128d b)
+  {
+    return _mm_cmplt_pd(a, b);
+  }
+#endif
+};
+
+/// compares elements with <=
+struct LessEqual
+{
+  template<typename T>
+  static bool scalar(T a, T b)
+  {
+    return a <= b;
+  }
+
+#ifdef MADARA_SIMD_SSE2
+  static __m128d vector(__m128d a, __m128d b)
+  {
+    return _mm_cmple_pd(a, b);
+  }
+#endif
+};
+
+/// compares elements with >
+struct Greater
+{
+  template<typename T>
+  static bool scalar(T a, T b)
+  {
+    return a > b;
+  }
+
+#ifdef MADARA_SIMD_SSE2
+  static __m128d vector(__m128d a, __m128d b)
+  {
+    return _mm_cmpgt_pd(a, b);
+  }
+#endif
+};
+
+/// compares elements with >=
+struct GreaterEqual
+{
+  template<typename T>
+  static bool scalar(T a, T b)
+  {
+    return a >= b;
+  }
+
+#ifdef MADARA_SIMD_SSE2
+  static __m128d vector(__m128d a, __m128d b)
+  {
+    return _mm_cmpge_pd(a, b);
+  }
+#endif
+};
+
+/// compares elements with ==
+struct Equal
+{
+  template<typename T>
+  static bool scalar(T a, T b)
+  {
+    return a == b;
+  }
+
+#ifdef MADARA_SIMD_SSE2
+  static __m128d vector(__m128d a, __m128d b)
+  {
+    return _mm_cmpeq_pd(a, b);
+  }
+#endif
+};
+
+/// compares elements with !=
+struct NotEqual
+{
+  template<typename T>
+  static bool scalar(T a, T b)
+  {
+    return a != b;
+  }
+
+#ifdef MADARA_SIMD_SSE2
+  static __m128d vector(__m128d a, __m128d b)
+  {
+    return _mm_cmpneq_pd(a, b);
+  }
+#endif
+};
+
+/**
+ * True if an operation has an SSE2 version for the element type
+ **/
+template<typename Op, typename T>
+struct Vectorized : std::false_type
+{
+};
+
+#ifdef MADARA_SIMD_SSE2
+template<>
+struct Vectorized<Add, double> : std::true_type
+{
+};
+template<>
+struct Vectorized<Add, int64_t> : std::true_type
+{
+};
+template<>
+struct Vectorized<Subtract, double> : std::true_type
+{
+};
+template<>
+struct Vectorized<Subtract, int64_t> : std::true_type
+{
+};
+template<>
+struct Vectorized<Multiply, double> : std::true_type
+{
+};
+template<>
+struct Vectorized<Divide, double> : std::true_type
+{
+};
+template<>
+struct Vectorized<Less, double> : std::true_type
+{
+};
+template<>
+struct Vectorized<LessEqual, double> : std::true_type
+{
+};
+template<>
+struct Vectorized<Greater, double> : std::true_type
+{
+};
+template<>
+struct Vectorized<GreaterEqual, double> : std::true_type
+{
+};
+template<>
+struct Vectorized<Equal, double> : std::true_type
+{
+};
+template<>
+struct Vectorized<NotEqual, double> : std::true_type
+{
+};
+#endif
+
+namespace detail
+{
+#ifdef MADARA_SIMD_SSE2
+inline __m128d load(const double* source)
+{
+  return _mm_loadu_pd(source);
+}
+
+inline __m128i load(const int64_t* source)
+{
+  return _mm_loadu_si128((const __m128i*)source);
+}
+
+inline void store(double* dest, __m128d value)
+{
+  _mm_storeu_pd(dest, value);
+}
+
+inline void store(int64_t* dest, __m128i value)
+{
+  _mm_storeu_si128((__m128i*)dest, value);
+}
+
+inline __m128d broadcast(double value)
+{
+  return _mm_set1_pd(value);
+}
+
+inline __m128i broadcast(int64_t value)
+{
+  return _mm_set1_epi64x(value);
+}
+
+/// stores a comparison mask as 0s and 1s
+inline void store_mask(int64_t* dest, __m128d mask)
+{
+  __m128i ones = _mm_set1_epi64x(1);
+  _mm_storeu_si128((__m128i*)dest, _mm_and_si128(_mm_castpd_si128(mask), ones));
+}
+
+template<typename Op, typename T>
+inline size_t apply(
+    T* out, const T* a, const T* b, size_t size, std::true_type)
+{
+  size_t i = 0;
+  for (; i + 2 <= size; i += 2)
+    store(out + i, Op::vector(load(a + i), load(b + i)));
+  return i;
+}
+
+template<typename Op, typename T>
+inline size_t apply(T* out, const T* a, T b, size_t size, std::true_type)
+{
+  auto right = broadcast(b);
+  size_t i = 0;
+  for (; i + 2 <= size; i += 2)
+    store(out + i, Op::vector(load(a + i), right));
+  return i;
+}
+
+template<typename Op, typename T>
+inline size_t apply(T* out, T a, const T* b, size_t size, std::true_type)
+{
+  auto left = broadcast(a);
+  size_t i = 0;
+  for (; i + 2 <= size; i += 2)
+    store(out + i, Op::vector(left, load(b + i)));
+  return i;
+}
+
+template<typename Op>
+inline size_t compare(int64_t* out, const double* a, const double* b,
+    size_t size, std::true_type)
+{
+  size_t i = 0;
+  for (; i + 2 <= size; i += 2)
+    store_mask(out + i, Op::vector(load(a + i), load(b + i)));
+  return i;
+}
+
+template<typename Op>
+inline size_t compare(
+    int64_t* out, const double* a, double b, size_t size, std::true_type)
+{
+  __m128d right = broadcast(b);
+  size_t i = 0;
+  for (; i + 2 <= size; i += 2)
+    store_mask(out + i, Op::vector(load(a + i), right));
+  return i;
+}
+#endif
+
+template<typename Op, typename T, typename A, typename B>
+inline size_t apply(T*, A, B, size_t, std::false_type)
+{
+  return 0;
+}
+
+template<typename Op, typename A, typename B>
+inline size_t compare(int64_t*, A, B, size_t, std::false_type)
+{
+  return 0;
+}
+}
+
+/**
+ * Applies an operation to each pair of elements (out[i] = a[i] op b[i]).
+ * The output may be one of the inputs.
+ * @param  out    the results
+ * @param  a      the left operands
+ * @param  b      the right operands
+ * @param  size   the number of elements
+ **/
+template<typename Op, typename T>
+inline void apply(T* out, const T* a, const T* b, size_t size)
+{
+  size_t i = detail::apply<Op>(out, a, b, size, Vectorized<Op, T>());
+  for (; i < size; ++i)
+    out[i] = Op::scalar(a[i], b[i]);
+}
+
+/**
+ * Applies an operation with a scalar right operand (out[i] = a[i] op b).
+ * The output may be the input.
+ * @param  out    the results
+ * @param  a      the left operands
+ * @param  b      the right operand
+ * @param  size   the number of elements
+ **/
+template<typename Op, typename T>
+inline void apply(T* out, const T* a, T b, size_t size)
+{
+  size_t i = detail::apply<Op>(out, a, b, size, Vectorized<Op, T>());
+  for (; i < size; ++i)
+    out[i] = Op::scalar(a[i], b);
+}
+
+/**
+ * Applies an operation with a scalar left operand (out[i] = a op b[i]).
+ * The output may be the input.
+ * @param  out    the results
+ * @param  a      the left operand
+ * @param  b      the right operands
+ * @param  size   the number of elements
+ **/
+template<typename Op, typename T>
+inline void apply(T* out, T a, const T* b, size_t size)
+{
+  size_t i = detail::apply<Op>(out, a, b, size, Vectorized<Op, T>());
+  for (; i < size; ++i)
+    out[i] = Op::scalar(a, b[i]);
+}
+
+/**
+ * Compares each pair of elements, storing 1 where a[i] op b[i] holds
+ * and 0 where it does not
+ * @param  out    the results
+ * @param  a      the left operands
+ * @param  b      the right operands
+ * @param  size   the number of elements
+ **/
+template<typename Op, typename T>
+inline void compare(int64_t* out, const T* a, const T* b, size_t size)
+{
+  size_t i = detail::compare<Op>(out, a, b, size, Vectorized<Op, T>());
+  for (; i < size; ++i)
+    out[i] = Op::scalar(a[i], b[i]) ? 1 : 0;
+}
+
+/**
+ * Compares each element with a scalar, storing 1 where a[i] op b holds
+ * and 0 where it does not
+ * @param  out    the results
+ * @param  a      the left operands
+ * @param  b      the right operand
+ * @param  size   the number of elements
+ **/
+template<typename Op, typename T>
+inline void compare(int64_t* out, const T* a, T b, size_t size)
+{
+  size_t i = detail::compare<Op>(out, a, b, size, Vectorized<Op, T>());
+  for (; i < size; ++i)
+    out[i] = Op::scalar(a[i], b) ? 1 : 0;
+}
+
+/**
+ * Sums elements. Doubles are summed in two lanes, so the result may
+ * differ from a sequential sum in the last bits.
+ * @param  a      the elements
+ * @param  size   the number of elements
+ * @return the sum, or 0 if there are no elements
+ **/
+inline int64_t sum(const int64_t* a, size_t size)
+{
+  size_t i = 0;
+  int64_t result = 0;
+
+#ifdef MADARA_SIMD_SSE2
+  __m128i lanes = _mm_setzero_si128();
+  for (; i + 2 <= size; i += 2)
+    lanes = _mm_add_epi64(lanes, detail::load(a + i));
+
+  int64_t parts[2];
+  detail::store(parts, lanes);
+  result = parts[0] + parts[1];
+#endif
+
+  for (; i < size; ++i)
+    result += a[i];
+
+  return result;
+}
+
+/**
+ * Sums elements. Doubles are summed in two lanes, so the result may
+ * differ from a sequential sum in the last bits.
+ * @param  a      the elements
+ * @param  size   the number of elements
+ * @return the sum, or 0 if there are no elements
+ **/
+inline double sum(const double* a, size_t size)
+{
+  size_t i = 0;
+  double result = 0;
+
+#ifdef MADARA_SIMD_SSE2
+  __m128d lanes = _mm_setzero_pd();
+  for (; i + 2 <= size; i += 2)
+    lanes = _mm_add_pd(lanes, detail::load(a + i));
+
+  double parts[2];
+  detail::store(parts, lanes);
+  result = parts[0] + parts[1];
+#endif
+
+  for (; i < size; ++i)
+    result += a[i];
+
+  return result;
+}
+
+/**
+ * Multiplies each pair of elements and sums the products
+ * @param  a      the left elements
+ * @param  b      the right elements
+ * @param  size   the number of elements
+ * @return the dot product, or 0 if there are no elements
+ **/
+inline int64_t dot(const int64_t* a, const int64_t* b, size_t size)
+{
+  int64_t result = 0;
+
+  for (size_t i = 0; i < size; ++i)
+    result += a[i] * b[i];
+
+  return result;
+}
+
+/**
+ * Multiplies each pair of elements and sums the products. The products
+ * are summed in two lanes, so the result may differ from a sequential
+ * sum in the last bits.
+ * @param  a      the left elements
+ * @param  b      the right elements
+ * @param  size   the number of elements
+ * @return the dot product, or 0 if there are no elements
+ **/
+inline double dot(const double* a, const double* b, size_t size)
+{
+  size_t i = 0;
+  double result = 0;
+
+#ifdef MADARA_SIMD_SSE2
+  __m128d lanes = _mm_setzero_pd();
+  for (; i + 2 <= size; i += 2)
+    lanes = _mm_add_pd(
+        lanes, _mm_mul_pd(detail::load(a + i), detail::load(b + i)));
+
+  double parts[2];
+  detail::store(parts, lanes);
+  result = parts[0] + parts[1];
+#endif
+
+  for (; i < size; ++i)
+    result += a[i] * b[i];
+
+  return result;
+}
+
+/**
+ * Finds the smallest element
+ * @param  a      the elements
+ * @param  size   the number of elements, which must not be 0
+ * @return the smallest element
+ **/
+inline int64_t minimum(const int64_t* a, size_t size)
+{
+  int64_t result = a[0];
+
+  for (size_t i = 1; i < size; ++i)
+    if (a[i] < result)
+      result = a[i];
+
+  return result;
+}
+
+/**
+ * Finds the smallest element. NaNs are skipped unless every element
+ * is a NaN.
+ * @param  a      the elements
+ * @param  size   the number of elements, which must not be 0
+ * @return the smallest element
+ **/
+inline double minimum(const double* a, size_t size)
+{
+  size_t i = 0;
+  double result = a[0];
+
+#ifdef MADARA_SIMD_SSE2
+  if (size >= 2)
+  {
+    // each lane takes the new element if it is smaller, or if the lane is a NaN
+    __m128d lanes = detail::load(a);
+    for (i = 2; i + 2 <= size; i += 2)
+    {
+      __m128d next = detail::load(a + i);
+      __m128d take = _mm_or_pd(
+          _mm_cmplt_pd(next, lanes), _mm_cmpunord_pd(lanes, lanes));
+      lanes = _mm_or_pd(
+          _mm_and_pd(take, next), _mm_andnot_pd(take, lanes));
+    }
+
+    double parts[2];
+    detail::store(parts, lanes);
+    result = parts[0];
+    if (parts[1] < result || result != result)
+      result = parts[1];
+  }
+#endif
+
+  for (; i < size; ++i)
+    if (a[i] < result || result != result)
+      result = a[i];
+
+  return result;
+}
+
+/**
+ * Finds the largest element
+ * @param  a      the elements
+ * @param  size   the number of elements, which must not be 0
+ * @return the largest element
+ **/
+inline int64_t maximum(const int64_t* a, size_t size)
+{
+  int64_t result = a[0];
+
+  for (size_t i = 1; i < size; ++i)
+    if (a[i] > result)
+      result = a[i];
+
+  return result;
+}
+
+/**
+ * Finds the largest element. NaNs are skipped unless every element
+ * is a NaN.
+ * @param  a      the elements
+ * @param  size   the number of elements, which must not be 0
+ * @return the largest element
+ **/
+inline double maximum(const double* a, size_t size)
+{
+  size_t i = 0;
+  double result = a[0];
+
+#ifdef MADARA_SIMD_SSE2
+  if (size >= 2)
+  {
+    // each lane takes the new element if it is larger, or if the lane is a NaN
+    __m128d lanes = detail::load(a);
+    for (i = 2; i + 2 <= size; i += 2)
+    {
+      __m128d next = detail::load(a + i);
+      __m128d take = _mm_or_pd(
+          _mm_cmpgt_pd(next, lanes), _mm_cmpunord_pd(lanes, lanes));
+      lanes = _mm_or_pd(
+          _mm_and_pd(take, next), _mm_andnot_pd(take, lanes));
+    }
+
+    double parts[2];
+    detail::store(parts, lanes);
+    result = parts[0];
+    if (parts[1] > result || result != result)
+      result = parts[1];
+  }
+#endif
+
+  for (; i < size; ++i)
+    if (a[i] > result || result != result)
+      result = a[i];
+
+  return result;
+}
+}
+}
+}
+
+#endif  // _MADARA_UTILITY_SIMD_MATH_H_
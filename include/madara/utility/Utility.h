@@ -337,6 +337,16 @@ int16_t endian_swap(int16_t value);
  **/
 double endian_swap(double value);
 
+/**
+ * Converts an array of 64 bit integers or doubles from host format into
+ * big endian, or back, in a single pass. Neither buffer needs to be
+ * aligned, but they must not overlap.
+ * @param     target     where to write the converted values
+ * @param     source     the values to convert
+ * @param     count      the number of 64 bit values
+ **/
+void endian_swap_array(void* target, const void* source, size_t count);
+
 /**
  * Reads a file into a provided void pointer. The void pointer will point
  * to an allocated buffer that the user will need to delete.
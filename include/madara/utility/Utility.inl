@@ -248,6 +248,32 @@ inline double endian_swap(double orig)
   return orig;
 }
 
+/**
+ * Converts an array of 64 bit values between host format and big endian
+ **/
+inline void endian_swap_array(void* target, const void* source, size_t count)
+{
+  // if host is little endian, then we have work to do
+  if (endian_is_little())
+  {
+    char* out = (char*)target;
+    const char* in = (const char*)source;
+
+    for (size_t i = 0; i < count; ++i, out += 8, in += 8)
+    {
+      uint64_t value;
+      memcpy(&value, in, sizeof(value));
+      value = endian_swap(value);
+      memcpy(out, &value, sizeof(value));
+    }
+  }
+  else if (count > 0)
+  {
+    // the byte orders agree, so the whole array is copied at once
+    memcpy(target, source, count * sizeof(uint64_t));
+  }
+}
+
 static const uint64_t milli_per = 1000;
 static const uint64_t micro_per = milli_per * 1000;
 static const uint64_t nano_per = micro_per * 1000;
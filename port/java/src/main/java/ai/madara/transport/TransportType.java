@@ -58,6 +58,7 @@ public enum TransportType
   REGISTRY_SERVER(7),
   REGISTRY_CLIENT(8),
   ZMQ_TRANSPORT(9),
+  SHMEM_TRANSPORT(10),
   INCONSISTENT_TRANSPORT(100);
 
   private int num;
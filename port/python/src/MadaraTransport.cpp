@@ -59,7 +59,8 @@ void define_transport(void)
       .value("BROADCAST", madara::transport::BROADCAST)
       .value("REGISTRY_SERVER", madara::transport::REGISTRY_SERVER)
       .value("REGISTRY_CLIENT", madara::transport::REGISTRY_CLIENT)
-      .value("ZMQ", madara::transport::ZMQ);
+      .value("ZMQ", madara::transport::ZMQ)
+      .value("SHMEM", madara::transport::SHMEM);
 
   {
     /********************************************************
@@ -190,6 +191,26 @@ void define_transport(void)
           &madara::transport::TransportSettings::send_reduced_message_header,
           "Indicates that a reduced message header should be used for messages")
 
+      .def_readwrite("send_key_ids",
+          &madara::transport::TransportSettings::send_key_ids,
+          "Indicates that updates should be keyed by ids instead of key strings")
+
+      .def_readwrite("key_id_refresh",
+          &madara::transport::TransportSettings::key_id_refresh,
+          "Messages between definitions of a key id. 0 defines each id once")
+
+      .def_readwrite("send_compact_message_header",
+          &madara::transport::TransportSettings::send_compact_message_header,
+          "Indicates that a compact varint message header should be sent")
+
+      .def_readwrite("send_deltas",
+          &madara::transport::TransportSettings::send_deltas,
+          "Indicates that arrays should be sent as patches of changed elements")
+
+      .def_readwrite("delta_refresh",
+          &madara::transport::TransportSettings::delta_refresh,
+          "Patches sent between full values of an array")
+
       .def_readwrite("hosts", &madara::transport::TransportSettings::hosts,
           "List of hosts for the transport layer")
 
@@ -0,0 +1,406 @@
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <random>
+#include <string.h>
+
+#include "madara/knowledge/KnowledgeRecord.h"
+#include "madara/transport/MessageHeader.h"
+#include "madara/filters/lz4/LZ4BufferFilter.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Timer.h"
+
+#include "../test.h"
+
+namespace knowledge = madara::knowledge;
+namespace filters = madara::filters;
+namespace logger = madara::logger;
+namespace transport = madara::transport;
+
+typedef std::chrono::steady_clock Clock;
+
+// the most bytes a packet may take, the default transport queue_length
+const int max_packet = 500000;
+
+// the number of packets to benchmark with (0 to skip)
+size_t benchmark_packets = 0;
+
+// command line arguments
+void handle_arguments(int argc, char* argv[]);
+
+/**
+ * Serializes an update from agent, like a transport sending the telemetry
+ * of one agent, and returns the bytes
+ **/
+std::string make_packet(size_t agent, uint64_t clock)
+{
+  std::vector<char> buffer(max_packet);
+  int64_t remaining = (int64_t)buffer.size();
+
+  transport::MessageHeader header;
+  strncpy(header.domain, "swarm", sizeof(header.domain) - 1);
+  std::stringstream originator;
+  originator << "192.168.1." << 10 + agent << ":40000";
+  strncpy(header.originator, originator.str().c_str(),
+      sizeof(header.originator) - 1);
+  header.clock = clock;
+  header.timestamp = 1700000000000000000ULL + clock * 500000;
+  header.updates = 6;
+
+  char* current = header.write(buffer.data(), remaining);
+
+  std::stringstream prefix;
+  prefix << "agent." << agent << ".";
+
+  double t = (double)clock / 2000;
+  std::vector<double> location = {
+      40.4433 + t * 1e-5, -79.9436 - t * 1e-5, 120.0 + (double)(clock % 7)};
+
+  current = knowledge::KnowledgeRecord(location).write(
+      current, prefix.str() + "location", remaining);
+  current = knowledge::KnowledgeRecord(100.0 - t * 0.01)
+                .write(current, prefix.str() + "battery", remaining);
+  current = knowledge::KnowledgeRecord(90.0 + (double)(clock % 360))
+                .write(current, prefix.str() + "heading", remaining);
+  current = knowledge::KnowledgeRecord(
+      knowledge::KnowledgeRecord::Integer(clock / 1000))
+                .write(current, prefix.str() + "mission.waypoint", remaining);
+  current = knowledge::KnowledgeRecord(std::string("flying"))
+                .write(current, prefix.str() + "state", remaining);
+  current = knowledge::KnowledgeRecord(std::string("nominal"))
+                .write(current, prefix.str() + "status", remaining);
+
+  // the header starts with the size of the message
+  uint64_t size = (uint64_t)(current - buffer.data());
+  *(uint64_t*)buffer.data() = madara::utility::endian_swap(size);
+
+  return std::string(buffer.data(), (size_t)size);
+}
+
+/// a dictionary of the content every packet shares, as a sender and its
+/// receivers would agree on from sample traffic
+std::string make_dictionary(void)
+{
+  std::string dictionary;
+  for (size_t agent = 0; agent < 4; ++agent)
+  {
+    dictionary += make_packet(agent, 1);
+  }
+  return dictionary;
+}
+
+/// encodes and decodes packet with encoder and decoder, returning the
+/// encoded size, or -1 if the packet did not come back the same
+int round_trip(const filters::LZ4BufferFilter& encoder,
+    const filters::LZ4BufferFilter& decoder, const std::string& packet,
+    std::vector<char>& buffer)
+{
+  memcpy(buffer.data(), packet.data(), packet.size());
+
+  int encoded = encoder.encode(buffer.data(), (int)packet.size(), max_packet);
+  if (encoded <= 0)
+  {
+    return -1;
+  }
+
+  int decoded = decoder.decode(buffer.data(), encoded, max_packet);
+  if (decoded != (int)packet.size() ||
+      memcmp(buffer.data(), packet.data(), packet.size()) != 0)
+  {
+    return -1;
+  }
+
+  return encoded;
+}
+
+void test_round_trips(void)
+{
+  std::cerr << "\n*********** TEST LZ4 ROUND TRIPS *************.\n";
+
+  std::vector<char> buffer(max_packet);
+  std::string packet = make_packet(3, 12345);
+  std::string dictionary = make_dictionary();
+
+  filters::LZ4BufferFilter fast;
+  filters::LZ4BufferFilter accelerated(8);
+  filters::LZ4BufferFilter hc(1, 9);
+  filters::LZ4BufferFilter fast_dict, hc_dict(1, 9);
+  fast_dict.set_dictionary(dictionary);
+  hc_dict.set_dictionary(dictionary);
+
+  TEST_GT(round_trip(fast, fast, packet, buffer), 0);
+  TEST_GT(round_trip(accelerated, accelerated, packet, buffer), 0);
+  TEST_GT(round_trip(hc, hc, packet, buffer), 0);
+  TEST_GT(round_trip(fast_dict, fast_dict, packet, buffer), 0);
+  TEST_GT(round_trip(hc_dict, hc_dict, packet, buffer), 0);
+
+  // every mode without a dictionary makes plain LZ4 blocks
+  TEST_GT(round_trip(accelerated, fast, packet, buffer), 0);
+  TEST_GT(round_trip(hc, fast, packet, buffer), 0);
+  TEST_GT(round_trip(hc_dict, fast_dict, packet, buffer), 0);
+
+  // the dictionary must shrink small packets
+  TEST_LT(round_trip(fast_dict, fast_dict, packet, buffer),
+      round_trip(fast, fast, packet, buffer));
+
+  // copies of the filter share its dictionary
+  filters::LZ4BufferFilter copy(fast_dict);
+  TEST_EQ(copy.get_dictionary() == dictionary, true);
+  TEST_GT(round_trip(fast_dict, copy, packet, buffer), 0);
+
+  fast_dict.set_dictionary("");
+  TEST_EQ(fast_dict.get_dictionary().empty(), true);
+  TEST_EQ(copy.get_dictionary() == dictionary, true);
+  TEST_GT(round_trip(fast_dict, fast, packet, buffer), 0);
+
+  // data that does not compress still round trips, if there is room
+  std::mt19937 random(42);
+  std::string noise(20000, '\0');
+  for (auto& c : noise)
+  {
+    c = (char)random();
+  }
+  TEST_GT(round_trip(fast, fast, noise, buffer), (int)noise.size());
+  TEST_GT(round_trip(hc_dict, hc_dict, noise, buffer), (int)noise.size());
+
+  // but not if the buffer cannot hold it
+  memcpy(buffer.data(), noise.data(), noise.size());
+  TEST_EQ(fast.encode(buffer.data(), (int)noise.size(), (int)noise.size()), 0);
+
+  // a packet larger than any before it grows the scratch space
+  std::string large;
+  for (uint64_t clock = 0; large.size() < 300000; ++clock)
+  {
+    large += make_packet((size_t)clock % 50, clock);
+  }
+  TEST_GT(round_trip(fast, fast, large, buffer), 0);
+  TEST_GT(round_trip(hc, hc, large, buffer), 0);
+
+  // a packet too large for the buffer fails to decode, not overrunning it
+  memcpy(buffer.data(), packet.data(), packet.size());
+  int encoded = fast.encode(buffer.data(), (int)packet.size(), max_packet);
+  TEST_EQ(fast.decode(buffer.data(), encoded, 16), 0);
+}
+
+void test_threads(void)
+{
+  std::cerr << "\n*********** TEST LZ4 ON MANY THREADS *************.\n";
+
+  // one filter, as a transport has, used by several threads at once
+  filters::LZ4BufferFilter filter;
+  filter.set_dictionary(make_dictionary());
+
+  filters::LZ4BufferFilter hc(1, 4);
+  hc.set_dictionary(filter.get_dictionary());
+
+  std::vector<int> failures(8, 0);
+  std::vector<std::thread> threads;
+
+  for (size_t i = 0; i < failures.size(); ++i)
+  {
+    threads.emplace_back([&, i]() {
+      std::vector<char> buffer(max_packet);
+      const filters::LZ4BufferFilter& encoder = i % 2 ? hc : filter;
+
+      for (uint64_t clock = 0; clock < 2000; ++clock)
+      {
+        std::string packet = make_packet(i, clock);
+        if (round_trip(encoder, filter, packet, buffer) < 0)
+        {
+          ++failures[i];
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  for (size_t i = 0; i < failures.size(); ++i)
+  {
+    TEST_EQ(failures[i], 0);
+  }
+}
+
+/// times encoding and decoding packets with a filter
+void benchmark(const std::string& name, const filters::LZ4BufferFilter& filter,
+    const std::vector<std::string>& packets)
+{
+  std::vector<char> buffer(max_packet);
+  size_t original = 0, compressed = 0;
+
+  // warm up the caches and this thread's scratch
+  for (size_t i = 0; i < packets.size() && i < 1000; ++i)
+  {
+    round_trip(filter, filter, packets[i], buffer);
+  }
+
+  // each packet is encoded in place, as in a transport's send buffer
+  std::vector<std::string> encoded(packets.size());
+  std::vector<int> sizes(packets.size());
+  for (size_t i = 0; i < packets.size(); ++i)
+  {
+    encoded[i] = packets[i];
+    encoded[i].resize(packets[i].size() * 2 + 64);
+  }
+
+  madara::utility::Timer<Clock> timer;
+
+  timer.start();
+  for (size_t i = 0; i < packets.size(); ++i)
+  {
+    sizes[i] = filter.encode(
+        &encoded[i][0], (int)packets[i].size(), (int)encoded[i].size());
+  }
+  timer.stop();
+  uint64_t encode_ns = timer.duration_ns();
+
+  int failures = 0;
+
+  timer.start();
+  for (size_t i = 0; i < packets.size(); ++i)
+  {
+    memcpy(buffer.data(), encoded[i].data(), (size_t)sizes[i]);
+    int size = filter.decode(buffer.data(), sizes[i], max_packet);
+    if (size != (int)packets[i].size())
+    {
+      ++failures;
+    }
+  }
+  timer.stop();
+  uint64_t decode_ns = timer.duration_ns();
+
+  TEST_EQ(failures, 0);
+
+  for (size_t i = 0; i < packets.size(); ++i)
+  {
+    original += packets[i].size();
+    compressed += (size_t)sizes[i];
+  }
+
+  std::stringstream line;
+  line << "  " << std::left << std::setw(22) << name << std::right
+       << std::setw(10) << encode_ns / packets.size() << std::setw(10)
+       << decode_ns / packets.size() << std::setw(10) << std::fixed
+       << std::setprecision(1) << (double)compressed / packets.size()
+       << std::setw(10) << std::setprecision(2)
+       << (double)original / compressed << "\n";
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "%s", line.str().c_str());
+}
+
+void benchmark_filters(size_t count)
+{
+  std::vector<std::string> packets;
+  packets.reserve(count);
+
+  size_t bytes = 0;
+  for (size_t i = 0; i < count; ++i)
+  {
+    packets.push_back(make_packet(i % 20, i));
+    bytes += packets.back().size();
+  }
+
+  std::string dictionary = make_dictionary();
+
+  filters::LZ4BufferFilter fast, accelerated(8), hc(1, 9);
+  filters::LZ4BufferFilter fast_dict, accelerated_dict(8), hc_dict(1, 9);
+  fast_dict.set_dictionary(dictionary);
+  accelerated_dict.set_dictionary(dictionary);
+  hc_dict.set_dictionary(dictionary);
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "\nLZ4BufferFilter over %zu update packets of %zu bytes on average:\n"
+      "  mode                  encode ns decode ns     bytes     ratio\n"
+      "========================================================================"
+      "=\n",
+      count, bytes / count);
+
+  benchmark("fast", fast, packets);
+  benchmark("fast, acceleration 8", accelerated, packets);
+  benchmark("hc 9", hc, packets);
+  benchmark("fast, dictionary", fast_dict, packets);
+  benchmark("accel 8, dictionary", accelerated_dict, packets);
+  benchmark("hc 9, dictionary", hc_dict, packets);
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "========================================================================"
+      "=\n\n");
+}
+
+void handle_arguments(int argc, char* argv[])
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-l" || arg1 == "--level")
+    {
+      if (i + 1 < argc)
+      {
+        int level;
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> level;
+        logger::global_logger->set_level(level);
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-b" || arg1 == "--benchmark")
+    {
+      benchmark_packets = 100000;
+
+      if (i + 1 < argc && argv[i + 1][0] != '-')
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> benchmark_packets;
+        ++i;
+      }
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+          "\nProgram summary for %s:\n\n"
+          "  Tests the LZ4 buffer filter.\n\n"
+          " [-l|--level level]         the logger level (0+, higher is higher "
+          "detail)\n"
+          " [-b|--benchmark [packets]] benchmark the modes of the filter over "
+          "packets\n"
+          "                            update packets (default 100000)\n"
+          "\n",
+          argv[0]);
+      exit(0);
+    }
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  handle_arguments(argc, argv);
+
+  test_round_trips();
+  test_threads();
+
+  if (benchmark_packets > 0)
+  {
+    benchmark_filters(benchmark_packets);
+  }
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
@@ -0,0 +1,344 @@
+#include <vector>
+#include <string>
+#include <set>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <string.h>
+
+#include "madara/filters/ssl/AESBufferFilter.h"
+#include "madara/filters/ssl/AESGCMBufferFilter.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Timer.h"
+
+#include "../test.h"
+
+namespace filters = madara::filters;
+namespace logger = madara::logger;
+
+typedef std::chrono::steady_clock Clock;
+
+// the number of seconds to benchmark each filter and size for (0 to skip)
+double benchmark_seconds = 0;
+
+// command line arguments
+void handle_arguments(int argc, char* argv[]);
+
+/// a message of size bytes that differs with seed
+std::string make_message(size_t size, size_t seed)
+{
+  std::string message(size, '\0');
+  for (size_t i = 0; i < size; ++i)
+  {
+    message[i] = (char)('a' + (i * 7 + seed) % 26);
+  }
+  return message;
+}
+
+/// encodes and decodes message, returning the encoded size, or -1 if the
+/// message did not come back the same
+int round_trip(const filters::BufferFilter& encoder,
+    const filters::BufferFilter& decoder, const std::string& message,
+    std::vector<char>& buffer)
+{
+  memcpy(buffer.data(), message.data(), message.size());
+
+  int encoded =
+      encoder.encode(buffer.data(), (int)message.size(), (int)buffer.size());
+  if (encoded <= 0)
+  {
+    return -1;
+  }
+
+  int decoded = decoder.decode(buffer.data(), encoded, (int)buffer.size());
+  if (decoded != (int)message.size() ||
+      memcmp(buffer.data(), message.data(), message.size()) != 0)
+  {
+    return -1;
+  }
+
+  return encoded;
+}
+
+void test_round_trips(void)
+{
+  std::cerr << "\n*********** TEST AES-GCM ROUND TRIPS *************.\n";
+
+  std::vector<char> buffer(70000);
+
+  filters::AESGCMBufferFilter sender, receiver;
+  TEST_EQ(sender.generate_key("testPassword#214"), 0);
+  TEST_EQ(receiver.generate_key("testPassword#214"), 0);
+
+  std::vector<size_t> sizes = {0, 1, 15, 16, 17, 1024, 60000};
+  for (size_t size : sizes)
+  {
+    std::string message = make_message(size, size);
+    TEST_EQ(round_trip(sender, receiver, message, buffer),
+        (int)size + filters::AESGCMBufferFilter::OVERHEAD);
+  }
+
+  // copies share the key
+  filters::AESGCMBufferFilter copy(receiver);
+  TEST_GT(round_trip(sender, copy, make_message(100, 1), buffer), 0);
+
+  // as do filters given the key directly
+  unsigned char key[32];
+  for (int i = 0; i < 32; ++i)
+  {
+    key[i] = (unsigned char)i;
+  }
+  filters::AESGCMBufferFilter keyed(key, 32), keyed2(key, 32);
+  TEST_GT(round_trip(keyed, keyed2, make_message(100, 2), buffer), 0);
+
+  // equal messages encrypt differently
+  std::string message = make_message(64, 3);
+  std::set<std::string> ciphertexts;
+  for (int i = 0; i < 100; ++i)
+  {
+    memcpy(buffer.data(), message.data(), message.size());
+    int size =
+        sender.encode(buffer.data(), (int)message.size(), (int)buffer.size());
+    ciphertexts.insert(std::string(buffer.data(), (size_t)size));
+  }
+  TEST_EQ(ciphertexts.size(), (size_t)100);
+
+  // there must be room for the nonce and tag
+  memcpy(buffer.data(), message.data(), message.size());
+  TEST_EQ(sender.encode(buffer.data(), (int)message.size(),
+              (int)message.size() + filters::AESGCMBufferFilter::OVERHEAD - 1),
+      0);
+}
+
+void test_authentication(void)
+{
+  std::cerr << "\n*********** TEST AES-GCM AUTHENTICATION *************.\n";
+
+  std::vector<char> buffer(2048);
+  std::string message = make_message(1024, 4);
+
+  filters::AESGCMBufferFilter sender, receiver, stranger;
+  sender.generate_key("testPassword#214");
+  receiver.generate_key("testPassword#214");
+  stranger.generate_key("anotherPassword");
+
+  // flip a bit in the ciphertext, the nonce and the tag
+  std::vector<int> offsets = {0, 1023, 1024, 1035, 1036, 1051};
+  for (int offset : offsets)
+  {
+    memcpy(buffer.data(), message.data(), message.size());
+    int size =
+        sender.encode(buffer.data(), (int)message.size(), (int)buffer.size());
+    buffer[offset] ^= 0x10;
+    TEST_EQ(receiver.decode(buffer.data(), size, (int)buffer.size()), 0);
+  }
+
+  // a truncated message
+  memcpy(buffer.data(), message.data(), message.size());
+  int size =
+      sender.encode(buffer.data(), (int)message.size(), (int)buffer.size());
+  TEST_EQ(receiver.decode(buffer.data(), size - 1, (int)buffer.size()), 0);
+  TEST_EQ(receiver.decode(buffer.data(), 10, (int)buffer.size()), 0);
+
+  // the wrong key
+  memcpy(buffer.data(), message.data(), message.size());
+  size = sender.encode(buffer.data(), (int)message.size(), (int)buffer.size());
+  TEST_EQ(stranger.decode(buffer.data(), size, (int)buffer.size()), 0);
+
+  TEST_EQ(receiver.get_rejected(), (uint64_t)offsets.size() + 2);
+  TEST_EQ(stranger.get_rejected(), (uint64_t)1);
+
+  // the receiver still decodes good messages after rejecting bad ones
+  TEST_GT(round_trip(sender, receiver, message, buffer), 0);
+
+  // and follows a change of key
+  receiver.generate_key("anotherPassword");
+  TEST_EQ(round_trip(sender, receiver, message, buffer), -1);
+  TEST_GT(round_trip(stranger, receiver, message, buffer), 0);
+}
+
+void test_threads(void)
+{
+  std::cerr << "\n*********** TEST AES-GCM ON MANY THREADS *************.\n";
+
+  // one filter, as a transport has, used by several threads at once
+  filters::AESGCMBufferFilter filter;
+  filter.generate_key("testPassword#214");
+
+  std::vector<int> failures(8, 0);
+  std::vector<std::thread> threads;
+
+  for (size_t i = 0; i < failures.size(); ++i)
+  {
+    threads.emplace_back([&, i]() {
+      std::vector<char> buffer(4096);
+
+      for (size_t j = 0; j < 2000; ++j)
+      {
+        if (round_trip(filter, filter, make_message(j % 3000, i), buffer) < 0)
+        {
+          ++failures[i];
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  for (size_t i = 0; i < failures.size(); ++i)
+  {
+    TEST_EQ(failures[i], 0);
+  }
+
+  TEST_EQ(filter.get_rejected(), (uint64_t)0);
+}
+
+/// encodes and decodes messages of size bytes for seconds, and returns the
+/// round trips per second
+double benchmark(
+    const filters::BufferFilter& filter, size_t size, double seconds)
+{
+  std::string message = make_message(size, 5);
+
+  // room for CBC padding as well as the GCM nonce and tag
+  std::vector<char> buffer(size + 64);
+
+  madara::utility::Timer<Clock> timer;
+  uint64_t limit = (uint64_t)(seconds * 1000000000);
+  size_t count = 0;
+  int failures = 0;
+
+  timer.start();
+  do
+  {
+    for (int i = 0; i < 100; ++i, ++count)
+    {
+      memcpy(buffer.data(), message.data(), size);
+      int encoded = filter.encode(buffer.data(), (int)size, (int)buffer.size());
+      if (filter.decode(buffer.data(), encoded, (int)buffer.size()) !=
+          (int)size)
+      {
+        ++failures;
+      }
+    }
+    timer.stop();
+  } while (timer.duration_ns() < limit);
+
+  TEST_EQ(failures, 0);
+
+  return count / (timer.duration_ns() / 1e9);
+}
+
+void benchmark_filters(double seconds)
+{
+  filters::AESBufferFilter cbc;
+  filters::AESGCMBufferFilter gcm;
+  cbc.generate_key("testPassword#214");
+  gcm.generate_key("testPassword#214");
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "\nEncode and decode round trips per second:\n"
+      "  size      AES-256-CBC (AESBufferFilter)   AES-256-GCM (AESGCMBuffer"
+      "Filter)\n"
+      "========================================================================"
+      "=\n");
+
+  std::vector<size_t> sizes = {1024, 60 * 1024};
+  for (size_t size : sizes)
+  {
+    double cbc_rate = benchmark(cbc, size, seconds);
+    double gcm_rate = benchmark(gcm, size, seconds);
+
+    std::stringstream line;
+    line << "  " << std::left << std::setw(10)
+         << (std::to_string(size / 1024) + " KB") << std::right << std::fixed
+         << std::setprecision(0) << std::setw(14) << cbc_rate << " ("
+         << std::setprecision(1) << std::setw(6)
+         << cbc_rate * size / (1024 * 1024) << " MB/s)" << std::setprecision(0)
+         << std::setw(14) << gcm_rate << " (" << std::setprecision(1)
+         << std::setw(6) << gcm_rate * size / (1024 * 1024) << " MB/s)\n";
+
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+        "%s", line.str().c_str());
+  }
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "========================================================================"
+      "=\n\n");
+}
+
+void handle_arguments(int argc, char* argv[])
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-l" || arg1 == "--level")
+    {
+      if (i + 1 < argc)
+      {
+        int level;
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> level;
+        logger::global_logger->set_level(level);
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-b" || arg1 == "--benchmark")
+    {
+      benchmark_seconds = 1;
+
+      if (i + 1 < argc && argv[i + 1][0] != '-')
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> benchmark_seconds;
+        ++i;
+      }
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+          "\nProgram summary for %s:\n\n"
+          "  Tests the AES-GCM buffer filter.\n\n"
+          " [-l|--level level]         the logger level (0+, higher is higher "
+          "detail)\n"
+          " [-b|--benchmark [secs]]    compare round trips per second with "
+          "AESBufferFilter\n"
+          "                            for secs seconds a size (default 1)\n"
+          "\n",
+          argv[0]);
+      exit(0);
+    }
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  handle_arguments(argc, argv);
+
+  test_round_trips();
+  test_authentication();
+  test_threads();
+
+  if (benchmark_seconds > 0)
+  {
+    benchmark_filters(benchmark_seconds);
+  }
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
@@ -0,0 +1,272 @@
+#include <string>
+#include <vector>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <math.h>
+
+#include "madara/knowledge/KnowledgeBase.h"
+
+#include "test.h"
+
+namespace knowledge = madara::knowledge;
+
+typedef knowledge::KnowledgeRecord KnowledgeRecord;
+typedef KnowledgeRecord::Integer Integer;
+
+/// makes an integer array record
+KnowledgeRecord integers(std::vector<Integer> values)
+{
+  return KnowledgeRecord(std::move(values));
+}
+
+/// makes a double array record
+KnowledgeRecord doubles(std::vector<double> values)
+{
+  return KnowledgeRecord(std::move(values));
+}
+
+/// prints array elements without the record's fixed double precision
+std::string text(const KnowledgeRecord& record)
+{
+  std::stringstream buffer;
+  std::vector<double> values = record.to_doubles();
+
+  for (size_t i = 0; i < values.size(); ++i)
+    buffer << (i > 0 ? ", " : "") << values[i];
+
+  return buffer.str();
+}
+
+void test_arithmetic(void)
+{
+  log("Testing element-wise arithmetic\n");
+
+  KnowledgeRecord a = integers({1, 2, 3, 4, 5});
+  KnowledgeRecord b = integers({10, 20, 30, 40, 50});
+  KnowledgeRecord c = doubles({0.5, 1.5, 2.5});
+
+  TEST_EQ(text(a + b), "11, 22, 33, 44, 55");
+  TEST_EQ(text(b - a), "9, 18, 27, 36, 45");
+  TEST_EQ(text(a * b), "10, 40, 90, 160, 250");
+  TEST_EQ(text(b / a), "10, 10, 10, 10, 10");
+  TEST_EQ(text(b % integers({3, 3, 7, 9, 11})), "1, 2, 2, 4, 6");
+  TEST_EQ((a + b).type(), KnowledgeRecord::INTEGER_ARRAY);
+
+  // scalars are broadcast to each element, on either side
+  TEST_EQ(text(a * KnowledgeRecord(Integer(3))), "3, 6, 9, 12, 15");
+  TEST_EQ(text(KnowledgeRecord(Integer(10)) - a), "9, 8, 7, 6, 5");
+  TEST_EQ(text(-a), "-1, -2, -3, -4, -5");
+
+  // integers and doubles combine into doubles
+  TEST_EQ((a + c).type(), KnowledgeRecord::DOUBLE_ARRAY);
+  TEST_EQ(text(a + c), "1.5, 3.5, 5.5");
+  TEST_EQ(text(c * KnowledgeRecord(Integer(2))), "1, 3, 5");
+  TEST_EQ(text(a / KnowledgeRecord(2.0)), "0.5, 1, 1.5, 2, 2.5");
+
+  // arrays of different lengths combine up to the shorter length
+  TEST_EQ((a + c).size(), 3u);
+  TEST_EQ((c + a).size(), 3u);
+
+  // dividing by zero gives NaNs, as it does for scalars
+  KnowledgeRecord by_zero = b / integers({1, 0, 2, 0, 5});
+  TEST_EQ(by_zero.type(), KnowledgeRecord::DOUBLE_ARRAY);
+  TEST_EQ(by_zero.retrieve_index(0).to_double(), 10.0);
+  TEST_EQ(isnan(by_zero.retrieve_index(1).to_double()), true);
+  TEST_EQ(by_zero.retrieve_index(2).to_double(), 15.0);
+  TEST_EQ(isnan((c / KnowledgeRecord(0.0)).retrieve_index(2).to_double()),
+      true);
+
+  // as with scalars, the modulus of doubles leaves the left operand
+  TEST_EQ(text(c % KnowledgeRecord(Integer(2))), "0.5, 1.5, 2.5");
+
+  // odd lengths exercise the kernels' remainders
+  KnowledgeRecord d = doubles({1, 2, 3, 4, 5, 6, 7});
+  TEST_EQ(text(d + d), "2, 4, 6, 8, 10, 12, 14");
+  TEST_EQ(text(d - KnowledgeRecord(1.0)), "0, 1, 2, 3, 4, 5, 6");
+  TEST_EQ((KnowledgeRecord(7.0) / d).retrieve_index(6).to_double(), 1.0);
+}
+
+void test_in_place(void)
+{
+  log("Testing in place arithmetic\n");
+
+  KnowledgeRecord a = doubles({1, 2, 3, 4});
+  const double* before = a.share_doubles()->data();
+
+  a += KnowledgeRecord(1.0);
+  a *= doubles({2, 2, 2, 2});
+
+  TEST_EQ(text(a), "4, 6, 8, 10");
+  TEST_EQ(a.share_doubles()->data() == before, true);
+
+  // a copy holds the same array, so neither changes the other's values
+  KnowledgeRecord copy = a;
+  a -= KnowledgeRecord(4.0);
+  copy += KnowledgeRecord(1.0);
+
+  TEST_EQ(text(a), "0, 2, 4, 6");
+  TEST_EQ(text(copy), "5, 7, 9, 11");
+
+  KnowledgeRecord b = integers({5, 6, 7});
+  const Integer* integers_before = b.share_integers()->data();
+  b %= KnowledgeRecord(Integer(4));
+  TEST_EQ(text(b), "1, 2, 3");
+  TEST_EQ(b.share_integers()->data() == integers_before, true);
+}
+
+void test_comparisons(void)
+{
+  log("Testing element-wise comparisons\n");
+
+  KnowledgeRecord a = integers({1, 5, 3, 7});
+  KnowledgeRecord b = doubles({2, 5, 1, 8, 9});
+  KnowledgeRecord three(Integer(3));
+
+  TEST_EQ(text(a.compare_less(b)), "1, 0, 0, 1");
+  TEST_EQ(text(a.compare_less_equal(b)), "1, 1, 0, 1");
+  TEST_EQ(text(a.compare_greater(b)), "0, 0, 1, 0");
+  TEST_EQ(text(a.compare_greater_equal(b)), "0, 1, 1, 0");
+  TEST_EQ(text(a.compare_equal(b)), "0, 1, 0, 0");
+  TEST_EQ(text(a.compare_not_equal(b)), "1, 0, 1, 1");
+  TEST_EQ(a.compare_less(b).type(), KnowledgeRecord::INTEGER_ARRAY);
+
+  TEST_EQ(text(a.compare_greater(three)), "0, 1, 0, 1");
+  TEST_EQ(text(three.compare_less(a)), "0, 1, 0, 1");
+  TEST_EQ(text(b.compare_less_equal(three)), "1, 0, 1, 0, 0");
+
+  // scalars compare as scalars
+  TEST_EQ(three.compare_less(KnowledgeRecord(4.0)).to_integer(), 1);
+}
+
+void test_reductions(void)
+{
+  log("Testing reductions\n");
+
+  KnowledgeRecord a = integers({4, -2, 9, 1, 3});
+  KnowledgeRecord b = doubles({0.5, NAN, -1.5, 2.5, 8.0});
+
+  TEST_EQ(a.sum().to_integer(), 15);
+  TEST_EQ(a.sum().type(), KnowledgeRecord::INTEGER);
+  TEST_EQ(a.minimum().to_integer(), -2);
+  TEST_EQ(a.maximum().to_integer(), 9);
+
+  // NaNs are skipped by min and max
+  TEST_EQ(b.minimum().to_double(), -1.5);
+  TEST_EQ(b.maximum().to_double(), 8.0);
+  TEST_EQ(doubles({NAN, NAN, 2.0}).minimum().to_double(), 2.0);
+  TEST_EQ(doubles({NAN, 3.0, NAN, 1.0, 2.0}).maximum().to_double(), 3.0);
+  TEST_EQ(doubles({1.5, 2.5, 3.0}).sum().to_double(), 7.0);
+
+  TEST_EQ(integers({}).minimum().type(), KnowledgeRecord::EMPTY);
+  TEST_EQ(integers({}).sum().to_integer(), 0);
+
+  TEST_EQ(a.dot(integers({1, 2, 3})).to_integer(), 4 - 4 + 27);
+  TEST_EQ(a.dot(doubles({0.5, 0.5})).to_double(), 1.0);
+  TEST_EQ(a.dot(KnowledgeRecord(Integer(2))).to_integer(), 30);
+}
+
+void test_karl(void)
+{
+  log("Testing array math in KaRL\n");
+
+  knowledge::KnowledgeBase kb;
+  kb.set("a", std::vector<Integer>({1, 2, 3}));
+  kb.set("b", std::vector<double>({0.5, 0.25, 2.0}));
+
+  TEST_EQ(text(kb.evaluate("c = a * 2 + b")), "2.5, 4.25, 8");
+  TEST_EQ(text(kb.get("c")), "2.5, 4.25, 8");
+  TEST_EQ(text(kb.evaluate("a += 10")), "11, 12, 13");
+  TEST_EQ(kb.evaluate("#sum (a)").to_integer(), 36);
+  TEST_EQ(kb.evaluate("#min (c)").to_double(), 2.5);
+  TEST_EQ(kb.evaluate("#max (c)").to_double(), 8.0);
+  TEST_EQ(kb.evaluate("#dot (a, b)").to_double(), 5.5 + 3 + 26);
+  TEST_EQ(kb.evaluate("#sum (a - a)").to_integer(), 0);
+}
+
+/// nanoseconds per element of an operation repeated on an array
+template<typename Function>
+double time_per_element(size_t size, int repeats, Function function)
+{
+  auto start = std::chrono::steady_clock::now();
+
+  for (int i = 0; i < repeats; ++i)
+    function();
+
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  return elapsed.count() / (double(size) * repeats);
+}
+
+void benchmark(size_t size, int repeats)
+{
+  std::vector<double> values(size);
+  for (size_t i = 0; i < size; ++i)
+    values[i] = (double)i;
+
+  KnowledgeRecord record(values);
+  KnowledgeRecord other(values);
+  KnowledgeRecord scale(1.0001);
+
+  // the way it was done before: copy out, loop, set back
+  double copied = time_per_element(size, repeats, [&]() {
+    std::vector<double> a = record.to_doubles();
+    std::vector<double> b = other.to_doubles();
+    for (size_t i = 0; i < a.size(); ++i)
+      a[i] = a[i] * 1.0001 + b[i];
+    record.set_value(std::move(a));
+  });
+
+  double in_place = time_per_element(size, repeats, [&]() {
+    record *= scale;
+    record += other;
+  });
+
+  double looped_sum = 0;
+  double summed = time_per_element(size, repeats, [&]() {
+    std::vector<double> a = record.to_doubles();
+    double total = 0;
+    for (size_t i = 0; i < a.size(); ++i)
+      total += a[i];
+    looped_sum += total;
+  });
+
+  double reduced = time_per_element(
+      size, repeats, [&]() { looped_sum += record.sum().to_double(); });
+
+  std::cerr << "  " << size << " doubles, a = a * s + b: copy and loop "
+            << copied << " ns/element, in place " << in_place
+            << " ns/element\n";
+  std::cerr << "  " << size << " doubles, sum: copy and loop " << summed
+            << " ns/element, sum () " << reduced << " ns/element\n";
+}
+
+int main(int argc, char** argv)
+{
+  test_arithmetic();
+  test_in_place();
+  test_comparisons();
+  test_reductions();
+  test_karl();
+
+  // benchmark only when asked, e.g., test_array_math -b
+  if (argc > 1 && std::string(argv[1]) == "-b")
+  {
+    std::cerr << "Benchmarking array math\n";
+    benchmark(1000, 100000);
+    benchmark(1000000, 100);
+  }
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
@@ -0,0 +1,436 @@
+#include <string>
+#include <iostream>
+#include <vector>
+#include <sstream>
+#include <iomanip>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/transport/Transport.h"
+#include "madara/transport/SendQueue.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Timer.h"
+
+#include "test.h"
+
+namespace knowledge = madara::knowledge;
+namespace transport = madara::transport;
+namespace logger = madara::logger;
+namespace utility = madara::utility;
+
+typedef knowledge::KnowledgeRecord::Integer Integer;
+typedef std::chrono::steady_clock Clock;
+
+// command line arguments
+void handle_arguments(int argc, char* argv[]);
+
+uint32_t num_updates = 2000;
+uint32_t send_cost_us = 50;
+
+// the last agent.0.pos any transport was asked to send
+Integer last_sent_pos = -1;
+
+// the number of send_data calls on any transport
+uint64_t num_sends = 0;
+
+/**
+ * A transport that records every batch it is asked to send. Sends can be
+ * held at a gate to fill the queue, or made to cost a fixed time.
+ **/
+class RecordingTransport : public transport::Base
+{
+public:
+  RecordingTransport(const std::string& id,
+      transport::TransportSettings& settings,
+      knowledge::ThreadSafeContext& context)
+    : transport::Base(id, settings, context),
+      gated_(false),
+      in_send_(false),
+      cost_us_(0)
+  {
+  }
+
+  ~RecordingTransport()
+  {
+    open_gate();
+  }
+
+  long send_data(const knowledge::KnowledgeMap& updates) override
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    batches_.push_back(updates);
+    ++num_sends;
+
+    auto pos = updates.find("agent.0.pos");
+    if (pos != updates.end())
+    {
+      last_sent_pos = pos->second.to_integer();
+    }
+
+    in_send_ = true;
+    cond_.notify_all();
+    cond_.wait(lock, [this] { return !gated_; });
+    in_send_ = false;
+
+    lock.unlock();
+
+    if (cost_us_ > 0)
+    {
+      utility::sleep(cost_us_ / 1000000.0);
+    }
+
+    return (long)updates.size();
+  }
+
+  /// holds every following send_data call until open_gate
+  void close_gate(void)
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    gated_ = true;
+  }
+
+  void open_gate(void)
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    gated_ = false;
+    cond_.notify_all();
+  }
+
+  /// waits until the sender thread is held at the gate
+  void wait_for_send(void)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this] { return in_send_; });
+  }
+
+  void set_cost(uint32_t cost_us)
+  {
+    cost_us_ = cost_us;
+  }
+
+  std::vector<knowledge::KnowledgeMap> batches(void)
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return batches_;
+  }
+
+private:
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::vector<knowledge::KnowledgeMap> batches_;
+  bool gated_;
+  bool in_send_;
+  uint32_t cost_us_;
+};
+
+knowledge::KnowledgeMap make_updates(
+    const std::vector<std::string>& keys, Integer value)
+{
+  knowledge::KnowledgeMap updates;
+
+  for (auto& key : keys)
+  {
+    updates[key] = knowledge::KnowledgeRecord(value);
+  }
+
+  return updates;
+}
+
+void test_coalescing(void)
+{
+  knowledge::KnowledgeBase kb;
+  transport::TransportSettings settings;
+  RecordingTransport transport("test", settings, kb.get_context());
+
+  transport::SendQueue queue(transport, kb.get_context());
+
+  transport.close_gate();
+  TEST_EQ(queue.enqueue(make_updates({"a"}, 1)), (size_t)0);
+  transport.wait_for_send();
+
+  // the sender is busy, so these wait in the queue and merge by key
+  queue.enqueue(make_updates({"a"}, 2));
+  queue.enqueue(make_updates({"a", "b"}, 3));
+
+  TEST_EQ(queue.depth(), (size_t)2);
+  TEST_EQ(queue.coalesced(), (uint64_t)1);
+
+  transport.open_gate();
+  queue.flush();
+
+  TEST_EQ(queue.depth(), (size_t)0);
+
+  auto batches = transport.batches();
+  TEST_EQ(batches.size(), (size_t)2);
+
+  if (batches.size() == 2)
+  {
+    TEST_EQ(batches[0]["a"].to_integer(), 1);
+    TEST_EQ(batches[1].size(), (size_t)2);
+    TEST_EQ(batches[1]["a"].to_integer(), 3);
+    TEST_EQ(batches[1]["b"].to_integer(), 3);
+  }
+}
+
+void test_drop_policy(void)
+{
+  knowledge::KnowledgeBase kb;
+  transport::TransportSettings settings;
+  settings.send_queue_length = 2;
+  settings.send_queue_policy = transport::SEND_QUEUE_DROP;
+  RecordingTransport transport("test", settings, kb.get_context());
+
+  transport::SendQueue queue(transport, kb.get_context());
+
+  transport.close_gate();
+  queue.enqueue(make_updates({"x"}, 1));
+  transport.wait_for_send();
+
+  TEST_EQ(queue.enqueue(make_updates({"a", "b"}, 1)), (size_t)0);
+  TEST_EQ(queue.enqueue(make_updates({"c"}, 1)), (size_t)1);
+
+  // updates to pending keys still fit
+  TEST_EQ(queue.enqueue(make_updates({"a"}, 2)), (size_t)0);
+
+  TEST_EQ(queue.dropped(), (uint64_t)1);
+  TEST_EQ(queue.depth(), (size_t)2);
+
+  transport.open_gate();
+  queue.flush();
+
+  auto batches = transport.batches();
+  TEST_EQ(batches.size(), (size_t)2);
+
+  if (batches.size() == 2)
+  {
+    TEST_EQ(batches[1].count("c"), (size_t)0);
+    TEST_EQ(batches[1]["a"].to_integer(), 2);
+  }
+
+  // a batch larger than the queue is accepted into an empty queue
+  TEST_EQ(queue.enqueue(make_updates({"d", "e", "f"}, 1)), (size_t)0);
+  queue.flush();
+}
+
+void test_block_policy(void)
+{
+  knowledge::KnowledgeBase kb;
+  transport::TransportSettings settings;
+  settings.send_queue_length = 1;
+  settings.send_queue_policy = transport::SEND_QUEUE_BLOCK;
+  settings.send_queue_timeout = 0.05;
+  RecordingTransport transport("test", settings, kb.get_context());
+
+  transport::SendQueue queue(transport, kb.get_context());
+
+  transport.close_gate();
+  queue.enqueue(make_updates({"x"}, 1));
+  transport.wait_for_send();
+
+  TEST_EQ(queue.enqueue(make_updates({"a"}, 1)), (size_t)0);
+
+  // nothing makes room, so the caller gives up after the timeout
+  utility::Timer<Clock> timer;
+  timer.start();
+  TEST_EQ(queue.enqueue(make_updates({"b", "c"}, 1)), (size_t)2);
+  timer.stop();
+
+  TEST_EQ(timer.duration_ns() >= 40000000, true);
+  TEST_EQ(timer.duration_ns() < 1000000000, true);
+  TEST_EQ(queue.dropped(), (uint64_t)2);
+
+  // the caller is released once the sender takes the pending updates
+  std::thread releaser([&transport] {
+    utility::sleep(0.01);
+    transport.open_gate();
+  });
+
+  TEST_EQ(queue.enqueue(make_updates({"d"}, 1)), (size_t)0);
+
+  releaser.join();
+  queue.flush();
+
+  auto batches = transport.batches();
+  TEST_EQ(batches.size() >= 2, true);
+  TEST_EQ(batches.back().count("d"), (size_t)1);
+}
+
+void test_knowledge_base(void)
+{
+  knowledge::KnowledgeBase kb;
+  transport::TransportSettings settings;
+  settings.send_async = true;
+  settings.debug_to_kb_prefix = "debug";
+  RecordingTransport* transport =
+      new RecordingTransport("test", settings, kb.get_context());
+  transport->set_cost(200);
+
+  kb.attach_transport(transport);
+
+  for (Integer i = 0; i < 100; ++i)
+  {
+    kb.set("agent.0.pos", i, knowledge::EvalSettings::SEND);
+  }
+
+  // closing sends everything still queued
+  kb.close_transport();
+
+  TEST_EQ(last_sent_pos, (Integer)99);
+  TEST_EQ(kb.get("debug.send_queue_max_depth").to_integer() >= 1, true);
+  TEST_EQ(kb.get("debug.send_latency").to_integer() > 0, true);
+  TEST_EQ(kb.exists("debug.send_queue_dropped"), true);
+  TEST_EQ(kb.exists("debug.send_queue_coalesced"), true);
+}
+
+/// returns the mean ns a kb.set waits before returning
+uint64_t benchmark(bool async, uint64_t& batches)
+{
+  knowledge::KnowledgeBase kb;
+  transport::TransportSettings settings;
+  settings.send_async = async;
+  RecordingTransport* transport =
+      new RecordingTransport("test", settings, kb.get_context());
+  transport->set_cost(send_cost_us);
+
+  kb.attach_transport(transport);
+  uint64_t start_sends = num_sends;
+
+  utility::Timer<Clock> timer;
+  timer.start();
+
+  for (uint32_t i = 0; i < num_updates; ++i)
+  {
+    kb.set("agent.0.pos", (Integer)i, knowledge::EvalSettings::SEND);
+  }
+
+  timer.stop();
+
+  kb.close_transport();
+  batches = num_sends - start_sends;
+
+  return timer.duration_ns() / num_updates;
+}
+
+int main(int argc, char* argv[])
+{
+  handle_arguments(argc, argv);
+
+  test_coalescing();
+  test_drop_policy();
+  test_block_policy();
+  test_knowledge_base();
+
+  if (num_updates == 0)
+  {
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+        "\nERROR: updates (%d) cannot be 0\n", num_updates);
+
+    exit(-1);
+  }
+
+  uint64_t sync_batches, async_batches;
+  uint64_t sync_ns = benchmark(false, sync_batches);
+  uint64_t async_ns = benchmark(true, async_batches);
+
+  if (async_ns == 0)
+    async_ns = 1;
+
+  std::stringstream buffer;
+
+  std::locale loc("C");
+  buffer.imbue(loc);
+
+  buffer << " Send from caller   " << std::setw(12) << sync_ns
+         << " ns/update  " << std::setw(8) << sync_batches << " sends\n";
+  buffer << " Send queue         " << std::setw(12) << async_ns
+         << " ns/update  " << std::setw(8) << async_batches << " sends";
+  buffer << std::fixed << std::setprecision(2) << "  ("
+         << (double)sync_ns / async_ns << "x)\n";
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "\nCaller latency for %d updates (%d us per send):\n"
+      "========================================================================"
+      "=\n%s"
+      "========================================================================"
+      "=\n\n",
+      num_updates, send_cost_us, buffer.str().c_str());
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
+
+void handle_arguments(int argc, char* argv[])
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-c" || arg1 == "--cost")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> send_cost_us;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-f" || arg1 == "--logfile")
+    {
+      if (i + 1 < argc)
+      {
+        logger::global_logger->add_file(argv[i + 1]);
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-l" || arg1 == "--level")
+    {
+      if (i + 1 < argc)
+      {
+        int level;
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> level;
+        logger::global_logger->set_level(level);
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-n" || arg1 == "--updates")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> num_updates;
+      }
+
+      ++i;
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(),
+          logger::LOG_ALWAYS, "Program Summary for %s:\n\n\
+This stand-alone application checks the transport send queue (coalescing,\n\
+drop and block policies, statistics) and compares how long a knowledge\n\
+base update takes to return with and without send_async.\n\n\
+-c (--cost)        microseconds each send takes\n\
+-f (--logfile)     log to a file             \n\
+-l (--level)       logger level              \n\
+-n (--updates)     number of updates to send \n\
+-h (--help)        print this menu           \n\n", argv[0]);
+      exit(0);
+    }
+  }
+}
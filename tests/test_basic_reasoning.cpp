@@ -1429,6 +1429,28 @@ void test_functions(madara::knowledge::KnowledgeBase& knowledge)
   knowledge.define_function("function1", return_named_1);
   result = knowledge.evaluate(".var2 = function1()");
   assert(result.to_integer() == 1);
+
+  // nested calls must not clobber the arguments of their callers
+  knowledge.print("Testing nested KaRL expression functions...\n");
+  knowledge.define_function("leaf", "leaf{.0} = 1");
+  knowledge.define_function("branch", "leaf (7); branch{.0} = 1");
+  knowledge.evaluate("branch (5)");
+  assert(knowledge.get("branch5").to_integer() == 1);
+  assert(knowledge.get("branch7").to_integer() == 0);
+
+  knowledge.evaluate("branch (leaf (3))");
+  assert(knowledge.get("leaf3").to_integer() == 1);
+  assert(knowledge.get("branch1").to_integer() == 1);
+
+  knowledge.print("Testing recursive KaRL expression functions...\n");
+  knowledge.define_function("down",
+      "n = #to_integer (#expand_statement ('{.0}'));"
+      "(n > 0 => down (n - 1)); visited{.0} = 1");
+  knowledge.evaluate("down (3)");
+  assert(knowledge.get("visited3").to_integer() == 1);
+  assert(knowledge.get("visited2").to_integer() == 1);
+  assert(knowledge.get("visited1").to_integer() == 1);
+  assert(knowledge.get("visited0").to_integer() == 1);
 }
 
 /// Test the ability to use for loops
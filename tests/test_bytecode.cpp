@@ -0,0 +1,210 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sstream>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/expression/Interpreter.h"
+#include "madara/expression/ExpressionTree.h"
+#include "madara/exceptions/UninitializedException.h"
+#include "madara/logger/GlobalLogger.h"
+
+#include "test.h"
+
+namespace knowledge = madara::knowledge;
+namespace expression = madara::expression;
+namespace logger = madara::logger;
+
+typedef knowledge::KnowledgeRecord::Integer Integer;
+
+/// expressions evaluated with and without bytecode
+const char* expressions[] = {
+    "a + b * 2 - 1",
+    "a / 0",
+    "a / 2; b / 2",
+    "a % 3",
+    "b % 2",
+    "-a",
+    "-d",
+    "!d",
+    "!b",
+    "a == 5 && b > 2 && d == 0",
+    "a < b || d",
+    "d || e",
+    "a > 3 => ++count",
+    "a < 3 => ++count",
+    "++a; a++; --b; b--",
+    "e++ + ++e",
+    "a += 2; b -= 0.5; c *= 3; a /= 4",
+    "a /= 0",
+    "a = b + 1; b = a * 2",
+    "d = e; e = 2; d",
+    "x = 'hello'; y = x + 1",
+    "s + 1",
+    "s == 'hello'",
+    "a > 2, b > 10, a",
+    "a ;> b ;> s",
+    "n < 5; n <= 5; n == 5; n > 5; n >= 5; n != 5",
+    "n < b; n == 5.0; n > d",
+    ".i[0->10)(sum += .i)",
+    "total = 0; .i[0->5)(.j[0->.i)(total += .j))",
+    "arr[1] = a; arr[1] + 1",
+    "#size (arr) + a",
+    ".i = 2; name{.i} = 3; name2 * 2",
+    "calls = 0; x = 5; countdown (); calls",
+    "f = 1.5; f += 1; f *= d; f",
+    "low = 3; low",
+    "a = b; a",
+};
+
+/// sets up a knowledge base for the expressions
+void setup(knowledge::KnowledgeBase& kb, bool bytecode)
+{
+  if (bytecode)
+    kb.get_context().use_bytecode();
+
+  kb.set("a", Integer(5));
+  kb.set("b", 2.5);
+  kb.set("c", Integer(3));
+  kb.set("n", Integer(5));
+  kb.set("s", std::string("hello"));
+  kb.set("arr", std::vector<Integer>({1, 2, 3}));
+
+  // a variable written with a lower quality than it has is not changed
+  kb.set_quality("low", 10);
+  kb.set("low", Integer(7));
+  kb.set_quality("low", 2);
+
+  // a recursive function evaluates its own bytecode while running it
+  kb.define_function("countdown", "x > 0 => (--x; ++calls; countdown ())");
+}
+
+/// checks that two records are the same
+void compare(const std::string& name, const knowledge::KnowledgeRecord& tree,
+    const knowledge::KnowledgeRecord& bytecode)
+{
+  if (tree.type() != bytecode.type() ||
+      tree.to_string() != bytecode.to_string() ||
+      tree.quality != bytecode.quality || tree.clock != bytecode.clock)
+  {
+    log("FAIL    : %s is %s (type %d, quality %d, clock %d) in the tree and "
+        "%s (type %d, quality %d, clock %d) in bytecode\n",
+        name.c_str(), tree.to_string().c_str(), (int)tree.type(),
+        (int)tree.quality, (int)tree.clock, bytecode.to_string().c_str(),
+        (int)bytecode.type(), (int)bytecode.quality, (int)bytecode.clock);
+    ++madara_tests_fail_count;
+  }
+}
+
+void test_results(void)
+{
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "Testing that bytecode matches the tree\n");
+
+  for (const char* expr : expressions)
+  {
+    knowledge::KnowledgeBase tree_kb, bytecode_kb;
+    setup(tree_kb, false);
+    setup(bytecode_kb, true);
+
+    knowledge::CompiledExpression tree_ce = tree_kb.compile(expr);
+    knowledge::CompiledExpression bytecode_ce = bytecode_kb.compile(expr);
+
+    // evaluate a few times, so later runs see what earlier runs changed
+    for (int i = 0; i < 3; ++i)
+    {
+      compare(
+          expr, tree_kb.evaluate(tree_ce), bytecode_kb.evaluate(bytecode_ce));
+    }
+
+    knowledge::KnowledgeMap tree_map = tree_kb.to_map("");
+    knowledge::KnowledgeMap bytecode_map = bytecode_kb.to_map("");
+
+    TEST_EQ(tree_map.size(), bytecode_map.size());
+
+    for (const auto& entry : tree_map)
+    {
+      compare(std::string(expr) + ": " + entry.first, entry.second,
+          bytecode_map[entry.first]);
+    }
+
+    TEST_EQ(tree_kb.get_context().get_clock(),
+        bytecode_kb.get_context().get_clock());
+  }
+}
+
+void test_lowering(void)
+{
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "Testing which expressions are lowered\n");
+
+  knowledge::KnowledgeBase kb;
+  knowledge::ThreadSafeContext& context = kb.get_context();
+  expression::Interpreter interpreter;
+
+  TEST_EQ(interpreter.interpret(context, "a + 1").has_bytecode(), false);
+
+  context.use_bytecode();
+  TEST_EQ(context.uses_bytecode(), true);
+
+  // trees cached before bytecode was enabled are lowered when reused
+  TEST_EQ(interpreter.interpret(context, "a + 1").has_bytecode(), true);
+  TEST_EQ(
+      interpreter.interpret(context, "++a; b = a * 2").has_bytecode(), true);
+  TEST_EQ(interpreter.interpret(context, "a > 1 => #size (b)").has_bytecode(),
+      true);
+
+  // roots that cannot be lowered are evaluated as trees
+  TEST_EQ(interpreter.interpret(context, "#size (b)").has_bytecode(), false);
+  TEST_EQ(interpreter.interpret(context, "b[1]").has_bytecode(), false);
+
+  context.use_bytecode(false);
+  TEST_EQ(interpreter.interpret(context, "a + 1").has_bytecode(), false);
+}
+
+void test_uninitialized(void)
+{
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "Testing reads of uninitialized variables\n");
+
+  knowledge::EvalSettings settings;
+  settings.exception_on_unitialized = true;
+
+  for (int i = 0; i < 2; ++i)
+  {
+    knowledge::KnowledgeBase kb;
+    setup(kb, i == 1);
+
+    bool thrown = false;
+
+    try
+    {
+      kb.evaluate("a + missing", settings);
+    }
+    catch (madara::exceptions::UninitializedException&)
+    {
+      thrown = true;
+    }
+
+    TEST_EQ(thrown, true);
+  }
+}
+
+int main(int, char**)
+{
+  test_results();
+  test_lowering();
+  test_uninitialized();
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
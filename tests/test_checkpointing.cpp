@@ -12,8 +12,10 @@
 #include "madara/knowledge/containers/Integer.h"
 #include "madara/exceptions/MemoryException.h"
 #include "madara/exceptions/FilterException.h"
+#include "madara/exceptions/FileException.h"
 #include "madara/knowledge/CheckpointStreamer.h"
 #include "madara/knowledge/CheckpointPlayer.h"
+#include "madara/knowledge/CheckpointWriter.h"
 #include "madara/knowledge/Any.h"
 
 #include "capnfiles/Geo.capnp.h"
@@ -21,6 +23,12 @@
 #include <stdio.h>
 #include <iostream>
 #include <chrono>
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <sstream>
 #include <thread>
 #include <string.h>
 
@@ -36,6 +44,9 @@ int madara_fails = 0;
 
 int log_level = 2;
 
+// size in MB of the recording to benchmark seeking in (0 to skip)
+size_t benchmark_mb = 0;
+
 void test_checkpoint_settings(void)
 {
   std::cerr << "\n*********** TEST CHECKPOINT SETTINGS *************.\n";
@@ -858,6 +869,17 @@ void handle_arguments(int argc, char** argv)
 
       ++i;
     }
+    else if (arg1 == "-b" || arg1 == "--benchmark")
+    {
+      benchmark_mb = 256;
+
+      if (i + 1 < argc && argv[i + 1][0] != '-')
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> benchmark_mb;
+        ++i;
+      }
+    }
     else
     {
       madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
@@ -865,6 +887,13 @@ void handle_arguments(int argc, char** argv)
           "  Test the checkpointing functionality.\n\n"
           " [-l|--level level]       the logger level (0+, higher is higher "
           "detail)\n"
+          " [-b|--benchmark [mb]]    benchmark seeking in an indexed recording "
+          "and\n"
+          "                          loading a checkpoint of mb megabytes "
+          "(default 256),\n"
+          "                          the cost of streaming updates, and writing "
+          "mb\n"
+          "                          megabytes through a CheckpointWriter\n"
           "\n",
           argv[0]);
       exit(0);
@@ -1199,6 +1228,789 @@ void test_streaming()
   }
 }
 
+void report(const std::string& test, bool success)
+{
+  std::cerr << test << ": " << (success ? "SUCCESS\n" : "FAIL\n");
+
+  if (!success)
+  {
+    ++madara_fails;
+  }
+}
+
+/// saves a state per step, with "rare" set on every fifth step
+std::vector<uint64_t> save_steps(knowledge::KnowledgeBase& kb,
+    knowledge::CheckpointSettings& settings, int first, int last)
+{
+  std::vector<uint64_t> tois;
+  knowledge::EvalSettings track_changes;
+  track_changes.track_local_changes = true;
+
+  for (int i = first; i < last; ++i)
+  {
+    kb.set("step", knowledge::KnowledgeRecord::Integer(i), track_changes);
+
+    if (i % 5 == 0)
+    {
+      kb.set("rare", knowledge::KnowledgeRecord::Integer(i * 10),
+          track_changes);
+    }
+
+    // give each state a lamport clock of its own
+    kb.get_context().inc_clock();
+
+    tois.push_back(kb.get("step").toi());
+    kb.save_checkpoint(settings);
+  }
+
+  return tois;
+}
+
+void test_indexed_checkpoints(void)
+{
+  std::cerr << "\n*********** TEST INDEXED CHECKPOINTS *************.\n";
+
+  remove("indexed_test.stk");
+  remove("unindexed_test.stk");
+
+  knowledge::KnowledgeBase kb;
+  knowledge::CheckpointSettings settings;
+  settings.filename = "indexed_test.stk";
+  settings.keep_index = true;
+
+  std::vector<uint64_t> tois = save_steps(kb, settings, 0, 20);
+
+  knowledge::CheckpointSettings load_settings;
+  load_settings.filename = "indexed_test.stk";
+
+  {
+    knowledge::CheckpointReader reader(load_settings);
+
+    report("File has an index of 20 states",
+        reader.has_index() && reader.get_index().size() == 20);
+
+    bool found = reader.seek_toi(tois[10]);
+    std::map<std::string, knowledge::KnowledgeRecord> updates;
+    updates.insert(reader.next());
+    updates.insert(reader.next());
+    report("Seeking to the time of step 10",
+        found && updates["step"] == 10 && updates["rare"] == 100);
+
+    report("Reading on after seeking", reader.next().second == 11);
+
+    found = reader.seek_clock(reader.get_index().state(7).clock);
+    report("Seeking to the clock of step 7",
+        found && reader.next().second.to_integer() == 7);
+
+    report("Seeking past the end", !reader.seek_toi(tois.back() + 1) &&
+                                       reader.next().first.empty());
+
+    std::vector<knowledge::KnowledgeRecord> rare = reader.history("rare");
+    report("History of rare",
+        rare.size() == 4 && rare[0] == 0 && rare[1] == 50 &&
+            rare[2] == 100 && rare[3] == 150);
+
+    report("History of a variable that was never saved",
+        reader.history("never").empty());
+  }
+
+  {
+    knowledge::KnowledgeBase player_kb;
+    knowledge::CheckpointPlayer player(player_kb.get_context(), load_settings);
+
+    bool reached = player.play_until(tois[12]);
+    report("Playing until step 12", reached && player_kb.get("step") == 12 &&
+                                        player_kb.get("rare") == 100);
+  }
+
+  // a file saved without an index is read through once to build it
+  knowledge::KnowledgeBase unindexed_kb;
+  knowledge::CheckpointSettings unindexed;
+  unindexed.filename = "unindexed_test.stk";
+
+  std::vector<uint64_t> unindexed_tois =
+      save_steps(unindexed_kb, unindexed, 0, 10);
+
+  {
+    knowledge::CheckpointSettings load_unindexed(unindexed);
+    knowledge::CheckpointReader reader(load_unindexed);
+
+    report("File saved without an index has none", !reader.has_index());
+
+    bool found = reader.seek_toi(unindexed_tois[6]);
+    report("Seeking without an index",
+        found && reader.next().second.to_integer() == 6);
+  }
+
+  // and given one when it is next saved with keep_index
+  unindexed.keep_index = true;
+  save_steps(unindexed_kb, unindexed, 10, 12);
+
+  {
+    knowledge::CheckpointSettings load_unindexed(unindexed);
+    knowledge::CheckpointReader reader(load_unindexed);
+
+    report("Adding an index to a file saved without one",
+        reader.has_index() && reader.get_index().size() == 12 &&
+            reader.history("step").size() == 12);
+  }
+
+  // saving without the index leaves the old footer behind, out of date
+  settings.keep_index = false;
+  save_steps(kb, settings, 20, 21);
+
+  {
+    knowledge::CheckpointReader reader(load_settings);
+    report("Index is ignored once a state is saved without it",
+        !reader.has_index() && reader.get_index().size() == 21);
+
+    knowledge::KnowledgeBase loader;
+    loader.load_context(load_settings);
+    report("Loading a file with an index",
+        loader.get("step") == 20 && loader.get("rare") == 200);
+  }
+
+  // the streamer writes its index once, when it stops
+  remove("indexed_stream_test.stk");
+
+  knowledge::CheckpointSettings stream_settings;
+  stream_settings.filename = "indexed_stream_test.stk";
+  stream_settings.keep_index = true;
+
+  {
+    knowledge::KnowledgeBase stream_kb;
+    stream_kb.attach_streamer(utility::mk_unique<knowledge::CheckpointStreamer>(
+        stream_settings, stream_kb, 100));
+
+    for (int i = 0; i < 5; ++i)
+    {
+      stream_kb.set("step", knowledge::KnowledgeRecord::Integer(i));
+      utility::sleep(0.05);
+    }
+
+    stream_kb.attach_streamer(nullptr);
+  }
+
+  {
+    knowledge::CheckpointReader reader(stream_settings);
+    report("Streamed file has an index",
+        reader.has_index() &&
+            reader.get_index().size() == reader.get_file_header()->states &&
+            reader.history("step").size() == 5);
+  }
+}
+
+/// milliseconds since a time point
+double elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+void benchmark_indexed_checkpoints(size_t megabytes)
+{
+  std::cerr << "\n*********** BENCHMARK INDEXED CHECKPOINTS *************.\n";
+
+  remove("indexed_benchmark.stk");
+
+  // each state holds a 64 KB array, a step counter and now and then a
+  // rarely updated variable
+  const size_t payload = 8192;
+  const size_t states = megabytes * 1024 * 1024 / (payload * sizeof(double));
+
+  knowledge::KnowledgeBase kb;
+  knowledge::CheckpointSettings settings;
+  settings.filename = "indexed_benchmark.stk";
+  settings.buffer_size = 2 * payload * sizeof(double);
+  settings.keep_index = true;
+
+  std::vector<double> values(payload);
+  std::vector<uint64_t> tois;
+  knowledge::EvalSettings track_changes;
+  track_changes.track_local_changes = true;
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (size_t i = 0; i < states; ++i)
+  {
+    values[i % payload] = (double)i;
+    kb.set("payload", values, track_changes);
+    kb.set("step", knowledge::KnowledgeRecord::Integer(i), track_changes);
+
+    if (i % 1000 == 0)
+    {
+      kb.set("rare", knowledge::KnowledgeRecord::Integer(i), track_changes);
+    }
+
+    tois.push_back(kb.get("step").toi());
+    kb.save_checkpoint(settings);
+  }
+
+  std::cerr << "  saved " << states << " states (" << megabytes << " MB) in "
+            << elapsed_ms(start) << " ms\n";
+
+  knowledge::CheckpointSettings load_settings;
+  load_settings.filename = settings.filename;
+  load_settings.buffer_size = settings.buffer_size;
+
+  // reach the state three quarters in by reading every state before it
+  uint64_t target = tois[states * 3 / 4];
+  start = std::chrono::steady_clock::now();
+  {
+    knowledge::CheckpointReader reader(load_settings);
+    for (auto cur = reader.next(); !cur.first.empty() &&
+                                   cur.second.toi() < target;
+         cur = reader.next())
+    {
+    }
+  }
+  double scanned = elapsed_ms(start);
+
+  start = std::chrono::steady_clock::now();
+  {
+    knowledge::CheckpointReader reader(load_settings);
+    reader.seek_toi(target);
+    reader.next();
+  }
+  double seeked = elapsed_ms(start);
+
+  std::cerr << "  reaching 3/4 of the way in: reading through " << scanned
+            << " ms, opening the index and seeking " << seeked << " ms\n";
+
+  start = std::chrono::steady_clock::now();
+  size_t found = 0;
+  {
+    knowledge::CheckpointReader reader(load_settings);
+    for (auto cur = reader.next(); !cur.first.empty(); cur = reader.next())
+    {
+      found += cur.first == "rare";
+    }
+  }
+  scanned = elapsed_ms(start);
+
+  start = std::chrono::steady_clock::now();
+  {
+    knowledge::CheckpointReader reader(load_settings);
+    found = reader.history("rare").size();
+  }
+  seeked = elapsed_ms(start);
+
+  std::cerr << "  history of a variable in " << found
+            << " states: reading through " << scanned << " ms, history () "
+            << seeked << " ms\n";
+
+  remove("indexed_benchmark.stk");
+}
+
+void test_mapped_load(void)
+{
+  std::cerr << "\n*********** TEST MAPPED LOADING *************.\n";
+
+  remove("mapped_test.stk");
+
+  knowledge::KnowledgeBase saver;
+  knowledge::EvalSettings track_changes;
+  track_changes.track_local_changes = true;
+
+  std::vector<double> doubles(100000);
+  for (size_t i = 0; i < doubles.size(); ++i)
+  {
+    doubles[i] = i * 0.5;
+  }
+
+  knowledge::CheckpointSettings settings;
+  settings.filename = "mapped_test.stk";
+  settings.buffer_size = 2000000;
+
+  saver.set("doubles", doubles, track_changes);
+  saver.set("text", std::string("some text"), track_changes);
+  saver.save_checkpoint(settings);
+
+  saver.set("count", knowledge::KnowledgeRecord::Integer(3), track_changes);
+  saver.set("text", std::string("more text"), track_changes);
+  saver.save_checkpoint(settings);
+
+  knowledge::CheckpointSettings load_settings;
+  load_settings.filename = "mapped_test.stk";
+  load_settings.map_file = true;
+
+  // the states do not fit into the default buffer, but need not
+  knowledge::KnowledgeBase loader;
+  loader.load_context(load_settings);
+
+  report("Loading a mapped file",
+      loader.get("doubles").to_doubles() == doubles &&
+          loader.get("text") == "more text" && loader.get("count") == 3);
+
+  {
+    knowledge::CheckpointReader reader(load_settings);
+    bool found = reader.seek_state(1);
+
+    std::map<std::string, knowledge::KnowledgeRecord> updates;
+    for (auto cur = reader.next(); !cur.first.empty(); cur = reader.next())
+    {
+      updates.insert(cur);
+    }
+
+    report("Seeking in a mapped file", found && updates.size() == 2 &&
+                                           updates["count"] == 3 &&
+                                           reader.history("text").size() == 2);
+  }
+}
+
+/// reads a field in kB from the memory status of the process
+size_t memory_kb(const std::string& field)
+{
+  size_t result = 0;
+
+#ifdef __linux__
+  std::ifstream status("/proc/self/status");
+  std::string line;
+
+  while (std::getline(status, line))
+  {
+    if (utility::begins_with(line, field + ":"))
+    {
+      std::stringstream buffer(line.substr(field.size() + 1));
+      buffer >> result;
+    }
+  }
+#endif
+
+  return result;
+}
+
+/// resets the peak resident memory of the process to the current
+void reset_peak_memory(void)
+{
+#ifdef __linux__
+  std::ofstream("/proc/self/clear_refs") << "5";
+#endif
+}
+
+void benchmark_mapped_load(size_t megabytes)
+{
+  std::cerr << "\n*********** BENCHMARK MAPPED LOADING *************.\n";
+
+  remove("mapped_benchmark.stk");
+
+  // a world model of 1 MB arrays, saved as a single state
+  const size_t elements = 1024 * 1024 / sizeof(double);
+
+  knowledge::CheckpointSettings settings;
+  settings.filename = "mapped_benchmark.stk";
+  settings.buffer_size = (megabytes + 1) * 1024 * 1024;
+
+  {
+    knowledge::KnowledgeBase kb;
+    std::vector<double> values(elements);
+
+    for (size_t i = 0; i < megabytes; ++i)
+    {
+      values[0] = (double)i;
+      kb.set("world.array." + std::to_string(i), values);
+    }
+
+    kb.save_context(settings);
+  }
+
+  for (int map_file = 0; map_file < 2; ++map_file)
+  {
+    knowledge::CheckpointSettings load_settings;
+    load_settings.filename = settings.filename;
+    load_settings.buffer_size = settings.buffer_size;
+    load_settings.map_file = map_file == 1;
+
+    size_t before = memory_kb("VmRSS");
+    reset_peak_memory();
+
+    auto start = std::chrono::steady_clock::now();
+    size_t loaded = 0;
+    {
+      knowledge::KnowledgeBase kb;
+      kb.load_context(load_settings);
+      loaded = kb.to_map("world.array.").size();
+    }
+    double took = elapsed_ms(start);
+
+    std::cerr << "  " << (map_file ? "mapped:  " : "buffered:") << " loaded "
+              << loaded << " MB in " << took << " ms, peak memory grew by "
+              << (memory_kb("VmHWM") - before) / 1024 << " MB\n";
+  }
+
+  remove("mapped_benchmark.stk");
+}
+
+/// streams count updates of "value" through a queue of queue_size updates
+void stream_to_queue(const std::string& filename, size_t queue_size,
+    knowledge::CheckpointSettings::StreamOverflow overflow, int count,
+    uint64_t& dropped, std::vector<int64_t>& written)
+{
+  remove(filename.c_str());
+
+  knowledge::CheckpointSettings settings;
+  settings.filename = filename;
+  settings.stream_queue_size = queue_size;
+  settings.stream_overflow = overflow;
+
+  knowledge::KnowledgeBase kb;
+  auto streamer =
+      utility::mk_unique<knowledge::CheckpointStreamer>(settings, kb, 10);
+  auto queue_streamer = streamer.get();
+  kb.attach_streamer(std::move(streamer));
+
+  for (int i = 0; i < count; ++i)
+  {
+    kb.set("value", knowledge::KnowledgeRecord::Integer(i));
+  }
+
+  auto detached = kb.attach_streamer(nullptr);
+  dropped = queue_streamer->dropped();
+
+  // writes what is left in the queue
+  detached.reset();
+
+  knowledge::CheckpointSettings read_settings;
+  read_settings.filename = filename;
+  knowledge::CheckpointReader reader(read_settings);
+
+  written.clear();
+  for (auto cur = reader.next(); !cur.first.empty(); cur = reader.next())
+  {
+    written.push_back(cur.second.to_integer());
+  }
+}
+
+void test_streamer_queue(void)
+{
+  std::cerr << "\n*********** TEST STREAMER QUEUE *************.\n";
+
+  const int count = 2000;
+  uint64_t dropped;
+  std::vector<int64_t> written;
+
+  stream_to_queue("queue_test.stk", 64,
+      knowledge::CheckpointSettings::STREAM_DROP_OLDEST, count, dropped,
+      written);
+
+  report("Dropping the oldest updates of a full queue",
+      dropped > 0 && written.size() + dropped == count &&
+          written.back() == count - 1 &&
+          std::is_sorted(written.begin(), written.end()));
+
+  stream_to_queue("queue_test.stk", 64,
+      knowledge::CheckpointSettings::STREAM_DROP_NEWEST, count, dropped,
+      written);
+
+  report("Dropping the newest updates of a full queue",
+      dropped > 0 && written.size() + dropped == count &&
+          written.front() == 0 &&
+          std::is_sorted(written.begin(), written.end()));
+
+  stream_to_queue("queue_test.stk", 64,
+      knowledge::CheckpointSettings::STREAM_BLOCK, count, dropped, written);
+
+  bool in_order = written.size() == count;
+  for (size_t i = 0; in_order && i < written.size(); ++i)
+  {
+    in_order = written[i] == (int64_t)i;
+  }
+
+  report("Blocking on a full queue", dropped == 0 && in_order);
+
+  remove("queue_test.stk");
+}
+
+void benchmark_streamer_queue(int updates)
+{
+  std::cerr << "\n*********** BENCHMARK STREAMER QUEUE *************.\n";
+
+  std::vector<double> points(64, 1.0);
+
+  for (int mode = 0; mode < 3; ++mode)
+  {
+    remove("queue_benchmark.stk");
+
+    knowledge::CheckpointSettings settings;
+    settings.filename = "queue_benchmark.stk";
+    settings.stream_queue_size = mode == 2 ? 1 << 16 : 0;
+
+    // a period of updates may pile up in a state
+    settings.buffer_size = 256 * 1024 * 1024;
+
+    knowledge::KnowledgeBase kb;
+    knowledge::CheckpointStreamer* streamer = nullptr;
+
+    if (mode > 0)
+    {
+      auto created =
+          utility::mk_unique<knowledge::CheckpointStreamer>(settings, kb, 100);
+      streamer = created.get();
+      kb.attach_streamer(std::move(created));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < updates; ++i)
+    {
+      kb.set("swarm.agent.17.sensor.lidar.points", points);
+      kb.set("swarm.agent.17.sensor.lidar.count",
+          knowledge::KnowledgeRecord::Integer(i));
+    }
+
+    double took = elapsed_ms(start);
+    uint64_t dropped = streamer ? streamer->dropped() : 0;
+
+    kb.attach_streamer(nullptr);
+
+    std::cerr << "  "
+              << (mode == 0 ? "no streamer:" : mode == 1 ? "buffered:   "
+                                                         : "queued:     ")
+              << " " << took * 1000000 / (updates * 2) << " ns per update, "
+              << dropped << " dropped\n";
+  }
+
+  remove("queue_benchmark.stk");
+}
+
+/// lists the records of a map, to save them with save_checkpoint
+class MapLister : public knowledge::VariablesLister
+{
+public:
+  MapLister(const knowledge::KnowledgeMap& records) : records_(&records) {}
+
+  void start(const knowledge::CheckpointSettings&) override
+  {
+    iter_ = records_->begin();
+  }
+
+  std::pair<const char*, const knowledge::KnowledgeRecord*> next() override
+  {
+    if (iter_ == records_->end())
+    {
+      return {nullptr, nullptr};
+    }
+
+    auto ret = std::make_pair(iter_->first.c_str(), &iter_->second);
+    ++iter_;
+    return ret;
+  }
+
+private:
+  const knowledge::KnowledgeMap* records_;
+  knowledge::KnowledgeMap::const_iterator iter_;
+};
+
+/// reads the "step" of every state in a checkpoint
+std::vector<int64_t> read_steps(knowledge::CheckpointSettings settings)
+{
+  std::vector<int64_t> steps;
+  knowledge::CheckpointReader reader(settings);
+
+  for (auto cur = reader.next(); !cur.first.empty(); cur = reader.next())
+  {
+    if (cur.first == "step")
+    {
+      steps.push_back(cur.second.to_integer());
+    }
+  }
+
+  return steps;
+}
+
+void test_checkpoint_writer(void)
+{
+  std::cerr << "\n*********** TEST CHECKPOINT WRITER *************.\n";
+
+  remove("writer_test.stk");
+
+  knowledge::CheckpointSettings settings;
+  settings.filename = "writer_test.stk";
+  settings.keep_index = true;
+
+#ifdef _USE_LZ4_
+  filters::LZ4BufferFilter lz4;
+  settings.buffer_filters.push_back(&lz4);
+#endif
+
+  // starts the file with save_checkpoint, to add to it
+  {
+    knowledge::KnowledgeBase kb;
+    knowledge::EvalSettings track_changes;
+    track_changes.track_local_changes = true;
+
+    kb.set("step", knowledge::KnowledgeRecord::Integer(0), track_changes);
+    kb.save_checkpoint(settings);
+  }
+
+  std::vector<int64_t> expected(1, 0);
+
+  {
+    knowledge::CheckpointWriter writer(settings, 3, 4096);
+
+    for (int step = 1; step <= 50; ++step)
+    {
+      knowledge::KnowledgeMap state;
+      state["step"] = knowledge::KnowledgeRecord::Integer(step);
+      state["values"] = std::vector<double>(step * 100, step * 0.5);
+
+      writer.save(state, step);
+      expected.push_back(step);
+    }
+
+    // states without records are not saved
+    writer.save(knowledge::KnowledgeMap(), 51);
+
+    writer.flush();
+    report("Writer counts its states", writer.states() == 51);
+  }
+
+  report("States are written in order", read_steps(settings) == expected);
+
+  {
+    knowledge::CheckpointReader reader(settings);
+    auto history = reader.history("values");
+
+    report("Written file has an index",
+        reader.has_index() && reader.get_index().size() == 51 &&
+            history.size() == 50 && history.back().size() == 5000);
+  }
+
+  {
+    knowledge::CheckpointSettings bad_settings;
+    bad_settings.filename = "writer_test.txt";
+    std::ofstream("writer_test.txt") << "not a checkpoint";
+
+    bool thrown = false;
+
+    try
+    {
+      knowledge::CheckpointWriter writer(bad_settings);
+    }
+    catch (exceptions::FileException&)
+    {
+      thrown = true;
+    }
+
+    report("Writer refuses files that are not checkpoints", thrown);
+    remove("writer_test.txt");
+  }
+
+  remove("writer_test.stk");
+
+  knowledge::CheckpointSettings stream_settings;
+  stream_settings.filename = "writer_stream_test.stk";
+  stream_settings.write_threads = 2;
+
+  remove(stream_settings.filename.c_str());
+
+  {
+    knowledge::KnowledgeBase kb;
+    kb.attach_streamer(utility::mk_unique<knowledge::CheckpointStreamer>(
+        stream_settings, kb, 100));
+
+    for (int step = 0; step < 20; ++step)
+    {
+      kb.set("step", knowledge::KnowledgeRecord::Integer(step));
+      utility::sleep(0.005);
+    }
+
+    kb.attach_streamer(nullptr);
+  }
+
+  std::vector<int64_t> steps = read_steps(stream_settings);
+
+  report("Streaming through a writer",
+      steps.size() == 20 && std::is_sorted(steps.begin(), steps.end()));
+
+  remove(stream_settings.filename.c_str());
+}
+
+void benchmark_checkpoint_writer(size_t megabytes)
+{
+  std::cerr << "\n*********** BENCHMARK CHECKPOINT WRITER *************.\n";
+
+  // 1 MB states of noisy sensor-like readings, which compress a few times
+  const size_t elements =
+      1024 * 1024 / sizeof(knowledge::KnowledgeRecord::Integer);
+  std::vector<knowledge::KnowledgeMap> states(8);
+
+  for (size_t i = 0; i < states.size(); ++i)
+  {
+    std::mt19937 noise((unsigned)i);
+    std::vector<knowledge::KnowledgeRecord::Integer> readings(elements);
+    for (size_t j = 0; j < elements; ++j)
+    {
+      readings[j] = (int64_t)(1000 + j % 100 + noise() % 256);
+    }
+
+    states[i]["sensor.readings"] = readings;
+    states[i]["sensor.step"] = knowledge::KnowledgeRecord::Integer(i);
+  }
+
+  knowledge::CheckpointSettings settings;
+  settings.filename = "writer_benchmark.stk";
+  settings.buffer_size = 2 * 1024 * 1024;
+
+  std::vector<filters::BufferFilter*> compression(1, nullptr);
+
+#ifdef _USE_LZ4_
+  filters::LZ4BufferFilter lz4;
+  compression.push_back(&lz4);
+#endif
+
+  for (filters::BufferFilter* filter : compression)
+  {
+    settings.buffer_filters.clear();
+    if (filter)
+    {
+      settings.buffer_filters.push_back(filter);
+    }
+
+    for (size_t threads = 0; threads <= 4; threads = threads ? threads * 2 : 1)
+    {
+      remove(settings.filename.c_str());
+
+      auto start = std::chrono::steady_clock::now();
+
+      if (threads == 0)
+      {
+        knowledge::KnowledgeBase kb;
+        knowledge::CheckpointSettings save_settings(settings);
+
+        for (size_t i = 0; i < megabytes; ++i)
+        {
+          MapLister lister(states[i % states.size()]);
+          save_settings.variables_lister = &lister;
+          kb.get_context().save_checkpoint(save_settings);
+        }
+      }
+      else
+      {
+        knowledge::CheckpointWriter writer(settings, threads);
+
+        for (size_t i = 0; i < megabytes; ++i)
+        {
+          writer.save(states[i % states.size()], i);
+        }
+      }
+
+      double took = elapsed_ms(start);
+
+      std::ifstream file(settings.filename, std::ios::binary | std::ios::ate);
+
+      std::cerr << "  " << (filter ? "lz4, " : "raw, ")
+                << (threads ? std::to_string(threads) + " thread writer:  "
+                            : "save_checkpoint: ")
+                << megabytes * 1000 / took << " MB/s, "
+                << (size_t)file.tellg() / (1024 * 1024) << " MB on disk\n";
+    }
+  }
+
+  remove(settings.filename.c_str());
+}
+
 int main(int argc, char* argv[])
 {
   handle_arguments(argc, argv);
@@ -1273,9 +2085,25 @@ int main(int argc, char* argv[])
 
   test_diff_filter_chains();
 
+  test_indexed_checkpoints();
+
+  test_mapped_load();
+
+  test_streamer_queue();
+
+  test_checkpoint_writer();
+
   logger::global_logger->set_level(log_level);
   test_streaming();
 
+  if (benchmark_mb > 0)
+  {
+    benchmark_indexed_checkpoints(benchmark_mb);
+    benchmark_mapped_load(benchmark_mb);
+    benchmark_streamer_queue(1000000);
+    benchmark_checkpoint_writer(benchmark_mb);
+  }
+
   if (madara_fails > 0)
   {
     std::cerr << "OVERALL: FAIL. " << madara_fails << " tests failed.\n";
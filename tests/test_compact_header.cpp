@@ -0,0 +1,561 @@
+#include <string>
+#include <iostream>
+#include <vector>
+#include <sstream>
+#include <iomanip>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/transport/Transport.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Timer.h"
+
+#include "test.h"
+
+namespace knowledge = madara::knowledge;
+namespace transport = madara::transport;
+namespace logger = madara::logger;
+namespace utility = madara::utility;
+
+typedef knowledge::KnowledgeRecord::Integer Integer;
+typedef std::chrono::steady_clock Clock;
+
+// command line arguments
+void handle_arguments(int argc, char* argv[]);
+
+// the number of headers to decode in the benchmark (0 to skip)
+uint32_t benchmark_iterations = 0;
+
+/**
+ * A transport that keeps the packets prep_send makes instead of sending
+ * them
+ **/
+class PacketTransport : public transport::Base
+{
+public:
+  PacketTransport(const std::string& id, transport::TransportSettings& settings,
+      knowledge::ThreadSafeContext& context)
+    : transport::Base(id, settings, context)
+  {
+    this->setup();
+    this->is_valid_ = true;
+  }
+
+  long send_data(const knowledge::KnowledgeMap& updates) override
+  {
+    long size = prep_send(updates, "PacketTransport::send_data");
+
+    if (size > 0)
+    {
+      packets.emplace_back(buffer_.get_ptr(), buffer_.get_ptr() + size);
+    }
+
+    return size;
+  }
+
+  /// the packets sent
+  std::vector<std::vector<char>> packets;
+};
+
+/**
+ * A knowledge base and what process_received_update needs to apply
+ * packets to it
+ **/
+class Receiver
+{
+public:
+  Receiver()
+  {
+    settings.add_read_domain(settings.write_domain);
+  }
+
+  /// applies a packet, returning what process_received_update returns
+  int receive(std::vector<char> packet)
+  {
+    return transport::process_received_update(packet.data(),
+        (uint32_t)packet.size(), "receiver:40000", kb.get_context(), settings,
+        send_monitor, receive_monitor, rebroadcast_records,
+#ifndef _MADARA_NO_KARL_
+        on_data_received,
+#endif  // _MADARA_NO_KARL_
+        "Receiver::receive", "sender:40000", scratch, header);
+  }
+
+  knowledge::KnowledgeBase kb;
+  transport::QoSTransportSettings settings;
+  transport::BandwidthMonitor send_monitor, receive_monitor;
+  knowledge::KnowledgeMap rebroadcast_records;
+  transport::ReceiveScratch scratch;
+  transport::MessageHeader* header = 0;
+
+#ifndef _MADARA_NO_KARL_
+  knowledge::CompiledExpression on_data_received;
+#endif  // _MADARA_NO_KARL_
+};
+
+/// settings for a sender of compact messages
+transport::QoSTransportSettings compact_settings(uint32_t refresh)
+{
+  transport::QoSTransportSettings settings;
+  settings.send_compact_message_header = true;
+  settings.key_id_refresh = refresh;
+  return settings;
+}
+
+/// a heartbeat: the few small updates an idle agent sends
+knowledge::KnowledgeMap heartbeat(const std::string& agent, Integer step)
+{
+  knowledge::KnowledgeMap updates;
+  updates[agent + ".heartbeat"] = knowledge::KnowledgeRecord(step);
+  updates[agent + ".battery"] = knowledge::KnowledgeRecord(12.0 - step * 0.01);
+  return updates;
+}
+
+void test_header(void)
+{
+  std::cerr << "\n*********** TEST COMPACT HEADER *************.\n";
+
+  transport::InternedNames names;
+  transport::CompactMessageHeader header;
+  strcpy(header.originator, "agent.0:40000");
+  strcpy(header.domain, "swarm");
+  header.session = 0x12345678;
+  header.updates = 3;
+  header.clock = 300;
+  header.flags = transport::CompactMessageHeader::NAMES;
+  header.set_payload_size(1000);
+
+  // the size counts the header, whose size depends on the size
+  TEST_EQ(header.size, (uint64_t)(1000 + header.encoded_size()));
+
+  // only a few bytes more than the names, and far less than a full header
+  TEST_LT(header.encoded_size(), (uint32_t)(strlen("agent.0:40000") +
+                                            strlen("swarm") + 16));
+  TEST_LT(header.encoded_size() + 100,
+      transport::MessageHeader::static_encoded_size());
+
+  char buffer[transport::CompactMessageHeader::MAX_ENCODED_SIZE];
+  int64_t remaining = sizeof(buffer);
+  char* end = header.write(buffer, remaining);
+  TEST_EQ((uint32_t)(end - buffer), header.encoded_size());
+  TEST_EQ(transport::CompactMessageHeader::compact_message_header_test(buffer),
+      true);
+  TEST_EQ(transport::MessageHeader::message_header_test(buffer), false);
+
+  transport::CompactMessageHeader read;
+  read.names = &names;
+  remaining = end - buffer;
+  read.read(buffer, remaining);
+  TEST_EQ(remaining, (int64_t)0);
+  TEST_EQ(read.equals(header), true);
+  TEST_EQ(std::string(read.originator), "agent.0:40000");
+  TEST_EQ(read.type, (uint32_t)transport::MULTIASSIGN);
+  TEST_EQ(names.size(), (size_t)1);
+
+  // without the names, they come from the session
+  header.flags = 0;
+  header.quality = 5;
+  header.ttl = 2;
+  header.timestamp = 1234567890123ULL;
+  header.flags |= transport::CompactMessageHeader::TIMESTAMP;
+  header.set_payload_size(20);
+  remaining = sizeof(buffer);
+  end = header.write(buffer, remaining);
+
+  transport::CompactMessageHeader later;
+  later.names = &names;
+  remaining = end - buffer;
+  later.read(buffer, remaining);
+  TEST_EQ(remaining, (int64_t)0);
+  TEST_EQ(std::string(later.originator), "agent.0:40000");
+  TEST_EQ(std::string(later.domain), "swarm");
+  TEST_EQ(later.quality, (uint32_t)5);
+  TEST_EQ((int)later.ttl, 2);
+  TEST_EQ(later.timestamp, (uint64_t)1234567890123ULL);
+  TEST_EQ(later.size, header.size);
+
+  // an unknown session leaves them empty
+  transport::InternedNames other;
+  transport::CompactMessageHeader unknown;
+  unknown.names = &other;
+  remaining = end - buffer;
+  unknown.read(buffer, remaining);
+  TEST_EQ(remaining, (int64_t)0);
+  TEST_EQ(unknown.originator[0], (char)0);
+
+  // every truncation is caught
+  int caught = 0;
+  for (int64_t length = 0; length < end - buffer; ++length)
+  {
+    remaining = length;
+    unknown.read(buffer, remaining);
+    if (remaining < 0)
+      ++caught;
+  }
+  TEST_EQ(caught, (int)(end - buffer));
+
+  // as are names longer than their fields
+  std::vector<char> bad(buffer, buffer + 3);
+  bad.push_back(20);
+  bad.push_back(1);
+  bad.push_back((char)MAX_ORIGINATOR_LENGTH);
+  bad.resize(bad.size() + MAX_ORIGINATOR_LENGTH + 20, 'a');
+  bad[2] = transport::CompactMessageHeader::NAMES;
+  remaining = (int64_t)bad.size();
+  unknown.read(bad.data(), remaining);
+  TEST_EQ(remaining, (int64_t)-1);
+}
+
+void test_round_trip(void)
+{
+  std::cerr << "\n*********** TEST COMPACT ROUND TRIP *************.\n";
+
+  knowledge::KnowledgeBase sender_kb;
+  transport::QoSTransportSettings settings = compact_settings(100);
+  PacketTransport sender("agent.0:40000", settings, sender_kb.get_context());
+  Receiver receiver;
+
+  sender.send_data(heartbeat("swarm.agent.0", 1));
+  sender.send_data(heartbeat("swarm.agent.0", 2));
+
+  knowledge::KnowledgeBase plain_kb;
+  transport::TransportSettings plain_settings;
+  PacketTransport plain("agent.0:40000", plain_settings, plain_kb.get_context());
+  plain.send_data(heartbeat("swarm.agent.0", 2));
+
+  // the first message has the names, and later ones only the session
+  TEST_EQ(sender.packets.size(), (size_t)2);
+  TEST_EQ(transport::CompactMessageHeader::compact_message_header_test(
+              sender.packets[0].data()),
+      true);
+  TEST_LT(sender.packets[1].size() + 10, sender.packets[0].size());
+  TEST_LT(sender.packets[1].size() + 100, plain.packets[0].size());
+
+  TEST_EQ(receiver.receive(sender.packets[0]), 2);
+  TEST_EQ(receiver.header == &receiver.scratch.compact_header, true);
+  TEST_EQ(receiver.receive(sender.packets[1]), 2);
+  TEST_EQ(receiver.kb.get("swarm.agent.0.heartbeat").to_integer(), 2);
+  TEST_EQ(std::string(receiver.header->originator), "agent.0:40000");
+
+  // rebroadcasts carry the names under a normal header
+  std::vector<char> rebroadcast(64000);
+  int64_t remaining = (int64_t)rebroadcast.size();
+  receiver.header->ttl = 1;
+  transport::QoSTransportSettings rebroadcast_settings;
+  rebroadcast_settings.queue_length = (uint32_t)rebroadcast.size();
+  transport::PacketScheduler scheduler(&rebroadcast_settings);
+  int size = transport::prep_rebroadcast(receiver.kb.get_context(),
+      rebroadcast.data(), remaining, rebroadcast_settings, "test_round_trip",
+      receiver.header, receiver.rebroadcast_records, scheduler);
+
+  TEST_GT(size, 0);
+  TEST_EQ(transport::MessageHeader::message_header_test(rebroadcast.data()),
+      true);
+
+  rebroadcast.resize((size_t)size);
+  Receiver relay;
+  TEST_EQ(relay.receive(rebroadcast), 2);
+  TEST_EQ(relay.kb.get("swarm.agent.0.heartbeat").to_integer(), 2);
+
+  // a sender with a ttl and deadline writes them
+  knowledge::KnowledgeBase timed_kb;
+  transport::QoSTransportSettings timed_settings = compact_settings(100);
+  timed_settings.set_rebroadcast_ttl(3);
+  timed_settings.set_deadline(5);
+  PacketTransport timed("agent.1:40000", timed_settings, timed_kb.get_context());
+  timed.send_data(heartbeat("swarm.agent.1", 1));
+
+  TEST_EQ(receiver.receive(timed.packets[0]), 2);
+  TEST_EQ((int)receiver.header->ttl, 3);
+  TEST_EQ((receiver.scratch.compact_header.flags &
+              transport::CompactMessageHeader::TIMESTAMP) != 0,
+      true);
+  TEST_EQ(receiver.scratch.interned_names.size(), (size_t)2);
+}
+
+void test_unknown_session(void)
+{
+  std::cerr << "\n*********** TEST COMPACT UNKNOWN SESSION *************.\n";
+
+  knowledge::KnowledgeBase sender_kb;
+  transport::QoSTransportSettings settings = compact_settings(4);
+  PacketTransport sender("agent.2:40000", settings, sender_kb.get_context());
+
+  for (Integer step = 1; step <= 6; ++step)
+  {
+    sender.send_data(heartbeat("swarm.agent.2", step));
+  }
+
+  // a receiver that missed the names drops messages until they are resent
+  Receiver late;
+  TEST_EQ(late.receive(sender.packets[1]), -1);
+  TEST_EQ(late.receive(sender.packets[3]), -1);
+  TEST_EQ(late.kb.exists("swarm.agent.2.heartbeat"), false);
+  TEST_EQ(late.receive(sender.packets[4]), 2);
+  TEST_EQ(late.receive(sender.packets[5]), 2);
+  TEST_EQ(late.kb.get("swarm.agent.2.heartbeat").to_integer(), 6);
+
+  // a restarted sender has a new session, which it names first
+  knowledge::KnowledgeBase restarted_kb;
+  PacketTransport restarted(
+      "agent.2:40000", settings, restarted_kb.get_context());
+  restarted.send_data(heartbeat("swarm.agent.2", 7));
+  TEST_EQ(late.receive(restarted.packets[0]), 2);
+  TEST_EQ(late.kb.get("swarm.agent.2.heartbeat").to_integer(), 7);
+
+  // a corrupted header is dropped
+  std::vector<char> packet(sender.packets[5]);
+  packet.resize(4);
+  TEST_EQ(late.receive(packet), -1);
+}
+
+void test_keyed(void)
+{
+  std::cerr << "\n*********** TEST COMPACT KEYED *************.\n";
+
+  knowledge::KnowledgeBase sender_kb;
+  transport::QoSTransportSettings settings = compact_settings(100);
+  settings.send_key_ids = true;
+  PacketTransport sender("agent.3:40000", settings, sender_kb.get_context());
+  Receiver receiver;
+
+  for (Integer step = 1; step <= 3; ++step)
+  {
+    sender.send_data(heartbeat("swarm.agent.3", step));
+  }
+
+  // with neither names nor key strings, a heartbeat is smaller still
+  knowledge::KnowledgeBase unkeyed_kb;
+  transport::QoSTransportSettings unkeyed_settings = compact_settings(100);
+  PacketTransport unkeyed(
+      "agent.3:40000", unkeyed_settings, unkeyed_kb.get_context());
+  for (Integer step = 1; step <= 3; ++step)
+  {
+    unkeyed.send_data(heartbeat("swarm.agent.3", step));
+  }
+  TEST_LT(sender.packets[2].size() + 20, unkeyed.packets[2].size());
+
+  for (auto& packet : sender.packets)
+  {
+    TEST_EQ(receiver.receive(packet), 2);
+  }
+  TEST_EQ(receiver.kb.get("swarm.agent.3.heartbeat").to_integer(), 3);
+  TEST_EQ(receiver.scratch.peer_keys.size(), (size_t)1);
+}
+
+void test_large(void)
+{
+  std::cerr << "\n*********** TEST COMPACT LARGE MESSAGES *************.\n";
+
+  knowledge::KnowledgeBase sender_kb;
+  transport::QoSTransportSettings settings = compact_settings(100);
+  settings.max_fragment_size = 500;
+  PacketTransport sender("agent.4:40000", settings, sender_kb.get_context());
+  Receiver receiver;
+
+  knowledge::KnowledgeMap updates = heartbeat("swarm.agent.4", 1);
+  updates["swarm.agent.4.map"] =
+      knowledge::KnowledgeRecord(std::vector<double>(100, 1.5));
+  sender.send_data(updates);
+  sender.send_data(heartbeat("swarm.agent.4", 2));
+
+  // messages that may be fragmented get a full header
+  TEST_EQ(transport::MessageHeader::message_header_test(
+              sender.packets[0].data()),
+      true);
+  TEST_EQ(transport::CompactMessageHeader::compact_message_header_test(
+              sender.packets[1].data()),
+      true);
+
+  TEST_EQ(receiver.receive(sender.packets[0]), 3);
+  TEST_EQ(
+      receiver.kb.get("swarm.agent.4.map").retrieve_index(99).to_double(), 1.5);
+
+  // which does not name the session, so the next message does
+  TEST_EQ(receiver.receive(sender.packets[1]), 2);
+  TEST_EQ(receiver.kb.get("swarm.agent.4.heartbeat").to_integer(), 2);
+
+  // and so does a keyed one
+  settings.send_key_ids = true;
+  knowledge::KnowledgeBase keyed_kb;
+  PacketTransport keyed("agent.5:40000", settings, keyed_kb.get_context());
+  updates = heartbeat("swarm.agent.5", 1);
+  updates["swarm.agent.5.map"] =
+      knowledge::KnowledgeRecord(std::vector<double>(100, 2.5));
+  keyed.send_data(updates);
+
+  TEST_EQ(transport::KeyedMessageHeader::keyed_message_header_test(
+              keyed.packets[0].data()),
+      true);
+  TEST_EQ(receiver.receive(keyed.packets[0]), 3);
+  TEST_EQ(
+      receiver.kb.get("swarm.agent.5.map").retrieve_index(0).to_double(), 2.5);
+}
+
+/// decodes the header of each packet iterations times
+uint64_t time_decode(transport::MessageHeader& header,
+    const std::vector<std::vector<char>>& packets, uint32_t iterations)
+{
+  utility::Timer<Clock> timer;
+  uint64_t total = 0;
+
+  timer.start();
+  for (uint32_t i = 0; i < iterations; ++i)
+  {
+    const std::vector<char>& packet = packets[i % packets.size()];
+    int64_t remaining = (int64_t)packet.size();
+    header.read(packet.data(), remaining);
+    total += header.size;
+  }
+  timer.stop();
+
+  // keep the reads from being optimized away
+  if (total == 0)
+  {
+    std::cerr << "no sizes were read\n";
+  }
+
+  return timer.duration_ns();
+}
+
+void benchmark_headers(uint32_t iterations)
+{
+  struct Result
+  {
+    const char* name;
+    uint32_t header_bytes;
+    double packet_bytes;
+    uint64_t decode_ns;
+  };
+  std::vector<Result> results;
+
+  // heartbeats from an agent, as sent with each kind of header
+  auto measure = [&](const char* name, transport::QoSTransportSettings settings,
+                     transport::MessageHeader& header) {
+    knowledge::KnowledgeBase kb;
+    PacketTransport sender("swarm.agent.17:40000", settings, kb.get_context());
+
+    uint64_t bytes = 0;
+    for (Integer step = 1; step <= 100; ++step)
+    {
+      sender.send_data(heartbeat("swarm.agent.17", step));
+      bytes += sender.packets.back().size();
+    }
+
+    // the steady state, which has only the session
+    int64_t remaining = (int64_t)sender.packets[1].size();
+    const char* end = header.read(sender.packets[1].data(), remaining);
+    uint32_t header_bytes = (uint32_t)(end - sender.packets[1].data());
+
+    time_decode(header, sender.packets, iterations / 10 + 1);
+    results.push_back(Result{name, header_bytes, (double)bytes / 100,
+        time_decode(header, sender.packets, iterations)});
+  };
+
+  transport::MessageHeader full;
+  transport::CompactMessageHeader compact;
+  transport::InternedNames names;
+  compact.names = &names;
+
+  transport::QoSTransportSettings settings;
+  measure("full", settings, full);
+  measure("compact", compact_settings(100), compact);
+
+  std::stringstream buffer;
+  buffer << std::fixed;
+
+  for (auto& result : results)
+  {
+    buffer << "  " << std::left << std::setw(10) << result.name << std::right
+           << std::setw(12) << result.header_bytes << std::setprecision(1)
+           << std::setw(14) << result.packet_bytes << std::setw(14)
+           << (double)result.decode_ns / iterations << "\n";
+  }
+
+  buffer << "  compact heartbeats use "
+         << 100.0 * results[1].packet_bytes / results[0].packet_bytes
+         << "% of the bytes and their headers "
+         << 100.0 * results[1].decode_ns / results[0].decode_ns
+         << "% of the decode time\n";
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "\nHeartbeat headers, %d decodes:\n"
+      "              header B    B/packet    decode ns\n"
+      "=================================================\n%s"
+      "=================================================\n\n",
+      (int)iterations, buffer.str().c_str());
+}
+
+int main(int argc, char* argv[])
+{
+  handle_arguments(argc, argv);
+
+  test_header();
+  test_round_trip();
+  test_unknown_session();
+  test_keyed();
+  test_large();
+
+  if (benchmark_iterations > 0)
+  {
+    benchmark_headers(benchmark_iterations);
+  }
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
+
+void handle_arguments(int argc, char* argv[])
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-l" || arg1 == "--level")
+    {
+      if (i + 1 < argc)
+      {
+        int level;
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> level;
+        logger::global_logger->set_level(level);
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-b" || arg1 == "--benchmark")
+    {
+      benchmark_iterations = 1000000;
+
+      if (i + 1 < argc && argv[i + 1][0] != '-')
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> benchmark_iterations;
+        ++i;
+      }
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+          "\nProgram summary for %s:\n\n"
+          "  Tests the compact message header.\n\n"
+          " [-l|--level level]              the logger level (0+, higher is "
+          "higher detail)\n"
+          " [-b|--benchmark [iterations]]   compare bytes and decode time "
+          "with the full\n"
+          "                                 header (default 1000000 "
+          "decodes)\n"
+          "\n",
+          argv[0]);
+      exit(0);
+    }
+  }
+}
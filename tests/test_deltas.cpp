@@ -0,0 +1,659 @@
+#include <string>
+#include <iostream>
+#include <vector>
+#include <sstream>
+#include <iomanip>
+#include <random>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/knowledge/containers/NativeDoubleVector.h"
+#include "madara/transport/Transport.h"
+#include "madara/logger/GlobalLogger.h"
+
+#include "test.h"
+
+namespace knowledge = madara::knowledge;
+namespace containers = knowledge::containers;
+namespace transport = madara::transport;
+namespace logger = madara::logger;
+namespace utility = madara::utility;
+
+typedef knowledge::KnowledgeRecord::Integer Integer;
+typedef std::chrono::steady_clock Clock;
+
+// command line arguments
+void handle_arguments(int argc, char* argv[]);
+
+// the number of sends of each benchmark workload (0 to skip)
+uint32_t benchmark_steps = 0;
+
+/**
+ * A transport that keeps the packets prep_send makes instead of sending
+ * them
+ **/
+class PacketTransport : public transport::Base
+{
+public:
+  PacketTransport(const std::string& id, transport::TransportSettings& settings,
+      knowledge::ThreadSafeContext& context)
+    : transport::Base(id, settings, context)
+  {
+    this->setup();
+    this->is_valid_ = true;
+  }
+
+  long send_data(const knowledge::KnowledgeMap& updates) override
+  {
+    long size = prep_send(updates, "PacketTransport::send_data");
+
+    if (size > 0)
+    {
+      packets.emplace_back(buffer_.get_ptr(), buffer_.get_ptr() + size);
+    }
+
+    return size;
+  }
+
+  /// the packets sent
+  std::vector<std::vector<char>> packets;
+};
+
+/**
+ * A knowledge base and what process_received_update needs to apply
+ * packets to it
+ **/
+class Receiver
+{
+public:
+  Receiver()
+  {
+    settings.add_read_domain(settings.write_domain);
+  }
+
+  /// applies a packet, returning what process_received_update returns
+  int receive(std::vector<char> packet)
+  {
+    return transport::process_received_update(packet.data(),
+        (uint32_t)packet.size(), "receiver:40000", kb.get_context(), settings,
+        send_monitor, receive_monitor, rebroadcast_records,
+#ifndef _MADARA_NO_KARL_
+        on_data_received,
+#endif  // _MADARA_NO_KARL_
+        "Receiver::receive", "sender:40000", scratch, header);
+  }
+
+  knowledge::KnowledgeBase kb;
+  transport::QoSTransportSettings settings;
+  transport::BandwidthMonitor send_monitor, receive_monitor;
+  knowledge::KnowledgeMap rebroadcast_records;
+  transport::ReceiveScratch scratch;
+  transport::MessageHeader* header = 0;
+
+#ifndef _MADARA_NO_KARL_
+  knowledge::CompiledExpression on_data_received;
+#endif  // _MADARA_NO_KARL_
+};
+
+/**
+ * A knowledge base whose modifieds are sent through a PacketTransport
+ **/
+class Sender
+{
+public:
+  Sender(const std::string& id, const transport::TransportSettings& settings)
+    : settings_(settings)
+  {
+    transport = new PacketTransport(id, settings_, kb.get_context());
+    kb.attach_transport(transport);
+  }
+
+  /// sends the modifieds, returning the packet
+  const std::vector<char>& send(void)
+  {
+    kb.send_modifieds();
+    return transport->packets.back();
+  }
+
+  knowledge::KnowledgeBase kb;
+
+  /// owned by kb
+  PacketTransport* transport;
+
+private:
+  transport::TransportSettings settings_;
+};
+
+/// settings for a sender of patches
+transport::TransportSettings delta_settings(uint32_t refresh)
+{
+  transport::TransportSettings settings;
+  settings.send_deltas = true;
+  settings.delta_refresh = refresh;
+  return settings;
+}
+
+/// a vector of nonzero values, as falsy records are not sent
+std::vector<double> make_doubles(size_t size)
+{
+  std::vector<double> values(size);
+  for (size_t i = 0; i < size; ++i)
+  {
+    values[i] = (double)i + 1.5;
+  }
+  return values;
+}
+
+/// checks that two knowledge bases hold the same array
+void check_same(knowledge::KnowledgeBase& lhs, knowledge::KnowledgeBase& rhs,
+    const std::string& key)
+{
+  knowledge::KnowledgeRecord left = lhs.get(key);
+  knowledge::KnowledgeRecord right = rhs.get(key);
+
+  TEST_EQ(left.type(), right.type());
+  TEST_EQ(left.size(), right.size());
+
+  bool same = left.size() == right.size();
+  for (size_t i = 0; same && i < left.size(); ++i)
+  {
+    same = left.retrieve_index(i).to_double() ==
+           right.retrieve_index(i).to_double();
+  }
+  TEST_EQ(same, true);
+}
+
+void test_index_change_log(void)
+{
+  std::cerr << "\n*********** TEST INDEX CHANGE LOG *************.\n";
+
+  knowledge::IndexChangeLog changes;
+  knowledge::IndexRanges ranges;
+
+  // neighboring changes to a value merge
+  changes.add(10, 11, 5, 6);
+  changes.add(11, 12, 6, 7);
+  changes.add(12, 13, 7, 8);
+  changes.add(13, 14, 100, 101);
+  TEST_EQ(changes.size(), (size_t)1);
+  TEST_EQ(changes.changed(10, 14, ranges), true);
+  TEST_EQ(ranges.size(), (size_t)2);
+  TEST_EQ(ranges[0].first, (size_t)5);
+  TEST_EQ(ranges[0].second, (size_t)8);
+  TEST_EQ(ranges[1].first, (size_t)100);
+
+  // values in between that were never sent are not known
+  TEST_EQ(changes.changed(12, 14, ranges), false);
+  TEST_EQ(changes.changed(14, 14, ranges), true);
+  TEST_EQ(ranges.empty(), true);
+
+  // changes after a value is taken are kept apart from it
+  changes.mark_taken();
+  changes.add(14, 15, 0, 1);
+  TEST_EQ(changes.size(), (size_t)2);
+  TEST_EQ(changes.changed(14, 15, ranges), true);
+  TEST_EQ(ranges.size(), (size_t)1);
+  TEST_EQ(changes.changed(10, 15, ranges), true);
+  TEST_EQ(ranges.size(), (size_t)3);
+  TEST_EQ(ranges[0].first, (size_t)0);
+
+  // a change from a value the changes did not see starts it over
+  changes.add(20, 21, 3, 4);
+  TEST_EQ(changes.size(), (size_t)1);
+  TEST_EQ(changes.changed(10, 21, ranges), false);
+  TEST_EQ(changes.changed(20, 21, ranges), true);
+
+  // only the newest entries are kept
+  uint64_t toi = 21;
+  for (size_t i = 0; i < knowledge::IndexChangeLog::MAX_ENTRIES + 4; ++i)
+  {
+    changes.mark_taken();
+    changes.add(toi, toi + 1, i, i + 1);
+    ++toi;
+  }
+  TEST_EQ(changes.size(), (size_t)knowledge::IndexChangeLog::MAX_ENTRIES);
+  TEST_EQ(changes.changed(20, toi, ranges), false);
+  TEST_EQ(changes.changed(toi - 4, toi, ranges), true);
+  TEST_EQ(ranges.size(), (size_t)1);
+
+  // scattered changes merge their closest neighbors
+  knowledge::IndexRanges scattered;
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    scattered.emplace_back(i * 3, i * 3 + 1);
+  }
+  scattered.emplace_back(10, 20);
+  knowledge::IndexChangeLog::normalize(scattered, 64);
+  TEST_LE(scattered.size(), (size_t)64);
+  TEST_EQ(scattered.front().first, (size_t)0);
+  TEST_EQ(scattered.back().second, (size_t)2998);
+
+  bool sorted = true;
+  for (size_t i = 1; i < scattered.size(); ++i)
+  {
+    sorted = sorted && scattered[i - 1].second < scattered[i].first;
+  }
+  TEST_EQ(sorted, true);
+}
+
+void test_context_tracking(void)
+{
+  std::cerr << "\n*********** TEST CONTEXT INDEX TRACKING *************.\n";
+
+  knowledge::KnowledgeBase kb;
+  knowledge::ThreadSafeContext& context = kb.get_context();
+  knowledge::IndexRanges ranges;
+
+  kb.set("data", make_doubles(100));
+  uint64_t first = kb.get("data").toi();
+
+  // nothing is tracked until asked for
+  kb.set_index("data", 3, 7.0);
+  TEST_EQ(context.get_index_changes("data", first, kb.get("data").toi(),
+              ranges),
+      false);
+
+  context.track_index_changes(true);
+  TEST_EQ(context.tracks_index_changes(), true);
+
+  uint64_t second = kb.get("data").toi();
+  kb.set_index("data", 3, 8.0);
+  kb.set_index("data", 4, 9.0);
+  kb.set_index("data", 90, 10.0);
+  uint64_t third = kb.get("data").toi();
+
+  TEST_NE(second, third);
+  TEST_EQ(context.get_index_changes("data", second, third, ranges), true);
+  TEST_EQ(ranges.size(), (size_t)2);
+  TEST_EQ(ranges[0].first, (size_t)3);
+  TEST_EQ(ranges[0].second, (size_t)5);
+  TEST_EQ(ranges[1].first, (size_t)90);
+
+  // the containers change arrays through set_index too
+  containers::NativeDoubleVector vector("data", kb);
+  vector.set(50, 11.0);
+  TEST_EQ(context.get_index_changes(
+              "data", second, kb.get("data").toi(), ranges),
+      true);
+  TEST_EQ(ranges.size(), (size_t)3);
+
+#ifndef _MADARA_NO_KARL_
+  // and so do expressions
+  kb.evaluate("data[60] = 14.5; data[61] = 15.5");
+  TEST_EQ(kb.get("data").retrieve_index(61).to_double(), 15.5);
+  TEST_EQ(context.get_index_changes(
+              "data", second, kb.get("data").toi(), ranges),
+      true);
+  TEST_EQ(ranges.size(), (size_t)4);
+  TEST_EQ(ranges[2].first, (size_t)60);
+  TEST_EQ(ranges[2].second, (size_t)62);
+#endif  // _MADARA_NO_KARL_
+
+  // growing the array or setting it whole is not a change of indices
+  kb.set_index("data", 100, 12.0);
+  TEST_EQ(context.get_index_changes(
+              "data", second, kb.get("data").toi(), ranges),
+      false);
+
+  uint64_t fourth = kb.get("data").toi();
+  kb.set("data", make_doubles(100));
+  kb.set_index("data", 1, 13.0);
+  TEST_EQ(context.get_index_changes(
+              "data", fourth, kb.get("data").toi(), ranges),
+      false);
+
+  TEST_EQ(context.get_index_changes("missing", 1, 2, ranges), false);
+
+  context.track_index_changes(false);
+  TEST_EQ(context.tracks_index_changes(), false);
+}
+
+void test_patches(const std::string& name, transport::TransportSettings settings)
+{
+  std::cerr << "\n*********** TEST PATCHES (" << name << ") *************.\n";
+
+  Sender sender("agent.0:40000", settings);
+  Receiver receiver;
+
+  const std::string key = "swarm.agent.0.map";
+  sender.kb.set(key, make_doubles(1000));
+  sender.kb.set("swarm.agent.0.ids", std::vector<Integer>(500, 7));
+
+  // the first send has the full values
+  size_t full = sender.send().size();
+  TEST_GT(full, (size_t)(1000 * 8 + 500 * 8));
+  TEST_EQ(receiver.receive(sender.transport->packets.back()), 2);
+  check_same(sender.kb, receiver.kb, key);
+
+  // and later ones only the elements that changed
+  sender.kb.set_index(key, 10, 100.5);
+  sender.kb.set_index(key, 11, 101.5);
+  sender.kb.set_index(key, 900, 102.5);
+  sender.kb.set_index("swarm.agent.0.ids", 499, Integer(8));
+
+  size_t patch = sender.send().size();
+  TEST_LT(patch, (size_t)400);
+  TEST_EQ(receiver.receive(sender.transport->packets.back()), 2);
+  check_same(sender.kb, receiver.kb, key);
+  check_same(sender.kb, receiver.kb, "swarm.agent.0.ids");
+  TEST_EQ(receiver.kb.get(key).retrieve_index(900).to_double(), 102.5);
+  TEST_EQ(
+      receiver.kb.get("swarm.agent.0.ids").retrieve_index(499).to_integer(),
+      8);
+
+  // a value that changed everywhere is sent whole
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    sender.kb.set_index(key, i, (double)i + 2.5);
+  }
+  TEST_GT(sender.send().size(), (size_t)(1000 * 8));
+  TEST_EQ(receiver.receive(sender.transport->packets.back()), 1);
+  check_same(sender.kb, receiver.kb, key);
+
+  // as is a value that was set whole
+  sender.kb.set(key, make_doubles(1000));
+  TEST_GT(sender.send().size(), (size_t)(1000 * 8));
+  TEST_EQ(receiver.receive(sender.transport->packets.back()), 1);
+  check_same(sender.kb, receiver.kb, key);
+}
+
+void test_loss(void)
+{
+  std::cerr << "\n*********** TEST PATCH LOSS *************.\n";
+
+  Sender sender("agent.1:40000", delta_settings(4));
+  Receiver receiver;
+  Receiver late;
+
+  const std::string key = "swarm.agent.1.map";
+  sender.kb.set(key, make_doubles(1000));
+  receiver.receive(sender.send());
+
+  // the first patch is lost, so the next ones do not apply
+  sender.kb.set_index(key, 1, 50.5);
+  sender.send();
+
+  for (size_t step = 2; step <= 4; ++step)
+  {
+    sender.kb.set_index(key, step, 50.5);
+    TEST_LT(sender.send().size(), (size_t)200);
+    TEST_EQ(receiver.receive(sender.transport->packets.back()), 0);
+    TEST_EQ(late.receive(sender.transport->packets.back()), 0);
+    TEST_EQ(receiver.kb.get(key).retrieve_index(step).to_double(),
+        (double)step + 1.5);
+    TEST_EQ(late.kb.exists(key), false);
+  }
+
+  // until the full value is sent again, which late joiners also get
+  sender.kb.set_index(key, 5, 50.5);
+  TEST_GT(sender.send().size(), (size_t)(1000 * 8));
+  TEST_EQ(receiver.receive(sender.transport->packets.back()), 1);
+  TEST_EQ(late.receive(sender.transport->packets.back()), 1);
+  check_same(sender.kb, receiver.kb, key);
+  check_same(sender.kb, late.kb, key);
+
+  // and patches apply again
+  sender.kb.set_index(key, 6, 50.5);
+  TEST_LT(sender.send().size(), (size_t)200);
+  TEST_EQ(receiver.receive(sender.transport->packets.back()), 1);
+  TEST_EQ(late.receive(sender.transport->packets.back()), 1);
+  check_same(sender.kb, late.kb, key);
+
+  // a value changed locally is not patched
+  late.kb.set_index(key, 7, 1.0);
+  sender.kb.set_index(key, 8, 50.5);
+  sender.send();
+  TEST_EQ(receiver.receive(sender.transport->packets.back()), 1);
+  TEST_EQ(late.receive(sender.transport->packets.back()), 0);
+  TEST_EQ(late.kb.get(key).retrieve_index(8).to_double(), 9.5);
+}
+
+void test_malformed(void)
+{
+  std::cerr << "\n*********** TEST MALFORMED PATCHES *************.\n";
+
+  Sender sender("agent.2:40000", delta_settings(0));
+  Receiver receiver;
+
+  const std::string key = "swarm.agent.2.map";
+  sender.kb.set(key, make_doubles(100));
+  receiver.receive(sender.send());
+
+  sender.kb.set_index(key, 99, 50.5);
+  std::vector<char> packet(sender.send());
+
+  // the patch is [key size|key|type|body size|toi|array type|length|base
+  // toi|ranges|first|count|value] and ends the packet
+  size_t range = packet.size() - 16;
+  knowledge::KnowledgeRecord before = receiver.kb.get(key);
+
+  // a range past the end of the array
+  std::vector<char> bad(packet);
+  uint32_t first = utility::endian_swap((uint32_t)100);
+  memcpy(bad.data() + range, &first, sizeof(first));
+  receiver.receive(bad);
+  TEST_EQ(receiver.kb.get(key).toi(), before.toi());
+
+  // a range longer than the body
+  bad = packet;
+  uint32_t count = utility::endian_swap((uint32_t)2);
+  memcpy(bad.data() + range + 4, &count, sizeof(count));
+  receiver.receive(bad);
+  TEST_EQ(receiver.kb.get(key).toi(), before.toi());
+
+  // a patch cut short
+  bad = packet;
+  bad.resize(bad.size() - 4);
+  receiver.receive(bad);
+  TEST_EQ(receiver.kb.get(key).toi(), before.toi());
+
+  // the good packet still works
+  TEST_EQ(receiver.receive(packet), 1);
+  check_same(sender.kb, receiver.kb, key);
+}
+
+/// the bytes and times of sending a workload
+struct Totals
+{
+  size_t packets = 0;
+  size_t bytes = 0;
+  double send_ns = 0;
+  double receive_ns = 0;
+};
+
+/**
+ * Sends a large vector that a few elements of change each step, as a
+ * map or a model that is updated in place would
+ **/
+Totals run_sparse(
+    bool deltas, size_t size, size_t changes, uint32_t steps, bool check)
+{
+  transport::TransportSettings settings = delta_settings(10);
+  settings.send_deltas = deltas;
+
+  Sender sender("agent.3:40000", settings);
+  Receiver receiver;
+  Totals totals;
+
+  const std::string key = "swarm.agent.3.map";
+  containers::NativeDoubleVector vector(key, sender.kb);
+  vector.resize(size);
+  for (size_t i = 0; i < size; ++i)
+  {
+    vector.set(i, (double)i + 1.5);
+  }
+
+  std::mt19937 random(42);
+  std::uniform_int_distribution<size_t> index(0, size - 1);
+
+  for (uint32_t step = 0; step < steps; ++step)
+  {
+    // the first step sends the whole vector
+    if (step > 0)
+    {
+      for (size_t i = 0; i < changes; ++i)
+      {
+        vector.set(index(random), (double)step + 0.25);
+      }
+    }
+
+    Clock::time_point start = Clock::now();
+    const std::vector<char>& packet = sender.send();
+    Clock::time_point sent = Clock::now();
+    receiver.receive(packet);
+    Clock::time_point received = Clock::now();
+
+    ++totals.packets;
+    totals.bytes += packet.size();
+    totals.send_ns += std::chrono::duration<double, std::nano>(sent - start)
+                          .count();
+    totals.receive_ns +=
+        std::chrono::duration<double, std::nano>(received - sent).count();
+
+    // a few steps are enough to check, as sends do not depend on steps
+    if (check && step < 24)
+    {
+      check_same(sender.kb, receiver.kb, key);
+    }
+  }
+
+  if (check)
+  {
+    check_same(sender.kb, receiver.kb, key);
+  }
+
+  return totals;
+}
+
+void test_sparse_workload(void)
+{
+  std::cerr << "\n*********** TEST SPARSE VECTOR WORKLOAD *************.\n";
+
+  Totals full = run_sparse(false, 10000, 4, 30, true);
+  Totals delta = run_sparse(true, 10000, 4, 30, true);
+
+  TEST_EQ(full.packets, delta.packets);
+  TEST_LT(delta.bytes * 5, full.bytes);
+}
+
+void benchmark_sparse(uint32_t steps)
+{
+  std::stringstream buffer;
+  buffer << std::fixed;
+
+  const size_t size = 10000;
+
+  for (size_t changes : {1, 4, 16, 64, 256, 1024})
+  {
+    Totals full = run_sparse(false, size, changes, steps, false);
+    Totals delta = run_sparse(true, size, changes, steps, false);
+
+    buffer << std::setw(8) << changes << std::setw(14) << std::setprecision(0)
+           << (double)full.bytes / full.packets << std::setw(14)
+           << (double)delta.bytes / delta.packets << std::setw(10)
+           << std::setprecision(1)
+           << 100.0 * (1.0 - (double)delta.bytes / full.bytes) << "%"
+           << std::setw(12) << std::setprecision(0)
+           << full.send_ns / full.packets << std::setw(10)
+           << delta.send_ns / delta.packets << std::setw(12)
+           << full.receive_ns / full.packets << std::setw(10)
+           << delta.receive_ns / delta.packets << "\n";
+  }
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "\nSparse updates to a %d element double vector, %d sends, full "
+      "value every 10:\n"
+      " changed     B/pkt full   B/pkt delta    saved   send ns full/delta"
+      "   recv ns full/delta\n"
+      "========================================================================"
+      "=========\n%s"
+      "========================================================================"
+      "=========\n\n",
+      (int)size, (int)steps, buffer.str().c_str());
+}
+
+int main(int argc, char* argv[])
+{
+  handle_arguments(argc, argv);
+
+  test_index_change_log();
+  test_context_tracking();
+
+  test_patches("key strings", delta_settings(10));
+
+  transport::TransportSettings keyed = delta_settings(10);
+  keyed.send_key_ids = true;
+  test_patches("key ids", keyed);
+
+  transport::TransportSettings compact = delta_settings(10);
+  compact.send_key_ids = true;
+  compact.send_compact_message_header = true;
+  test_patches("compact header", compact);
+
+  test_loss();
+  test_malformed();
+  test_sparse_workload();
+
+  if (benchmark_steps > 0)
+  {
+    benchmark_sparse(benchmark_steps);
+  }
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
+
+void handle_arguments(int argc, char* argv[])
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-l" || arg1 == "--level")
+    {
+      if (i + 1 < argc)
+      {
+        int level;
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> level;
+        logger::global_logger->set_level(level);
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-b" || arg1 == "--benchmark")
+    {
+      benchmark_steps = 1000;
+
+      if (i + 1 < argc && argv[i + 1][0] != '-')
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> benchmark_steps;
+        ++i;
+      }
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+          "\nProgram summary for %s:\n\n"
+          "  Tests sending patches of the array elements that changed.\n\n"
+          " [-l|--level level]         the logger level (0+, higher is higher "
+          "detail)\n"
+          " [-b|--benchmark [sends]]   compare bytes and time with full "
+          "values for\n"
+          "                            sparse updates to a large vector "
+          "(default 1000)\n"
+          "\n",
+          argv[0]);
+      exit(0);
+    }
+  }
+}
@@ -6,7 +6,9 @@
 
 #include "madara/utility/Utility.h"
 #include <stdio.h>
+#include <chrono>
 #include <iostream>
+#include <vector>
 
 #define BUFFER_SIZE 1000
 #define LARGE_BUFFER_SIZE 500000
@@ -397,11 +399,109 @@ void test_key_id_encoding(void)
   }
 }
 
+void test_array_encoding(void)
+{
+  std::cerr << "\n*************TEST ARRAY ENCODING*****************\n\n";
+
+  typedef madara::knowledge::KnowledgeRecord::Integer Integer;
+
+  // odd sizes make sure no element is dropped from the bulk conversion
+  std::vector<Integer> integers(1001);
+  std::vector<double> doubles(100001);
+
+  for (size_t i = 0; i < integers.size(); ++i)
+  {
+    integers[i] = (Integer)i * 0x0102030405LL - 7;
+  }
+
+  for (size_t i = 0; i < doubles.size(); ++i)
+  {
+    doubles[i] = i * 0.25 - 1000.125;
+  }
+
+  madara::knowledge::KnowledgeRecord integers_source(integers);
+  madara::knowledge::KnowledgeRecord doubles_source(doubles);
+  madara::knowledge::KnowledgeRecord dest;
+
+  std::vector<char> buffer(LARGE_BUFFER_SIZE * 2);
+  int64_t buffer_remaining;
+  std::string key;
+  bool integers_decoded, doubles_decoded;
+
+  std::cerr << "Test 1: encoding and decoding a 1001 element integer array.\n";
+
+  buffer_remaining = (int64_t)buffer.size();
+  integers_source.write(buffer.data(), "integers", buffer_remaining);
+  buffer_remaining = (int64_t)buffer.size() - buffer_remaining;
+  dest.read(buffer.data(), key, buffer_remaining);
+
+  integers_decoded = key == "integers" &&
+                     dest.type() == integers_source.type() &&
+                     dest.to_integers() == integers;
+
+  std::cerr << "Test 1: decoded integer array is equal to source? "
+            << (integers_decoded ? "true" : "false") << std::endl;
+
+  std::cerr << "Test 2: encoding and decoding a 100001 element double array.\n";
+
+  buffer_remaining = (int64_t)buffer.size();
+  doubles_source.write(buffer.data(), "doubles", buffer_remaining);
+  buffer_remaining = (int64_t)buffer.size() - buffer_remaining;
+  dest.read(buffer.data(), key, buffer_remaining);
+
+  doubles_decoded = key == "doubles" &&
+                    dest.type() == doubles_source.type() &&
+                    dest.to_doubles() == doubles;
+
+  std::cerr << "Test 2: decoded double array is equal to source? "
+            << (doubles_decoded ? "true" : "false") << std::endl;
+
+  std::cerr << "Test 3: measuring throughput of 100001 element double array.\n";
+
+  const int iterations = 1000;
+  int64_t bytes = doubles_source.get_encoded_size();
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i)
+  {
+    buffer_remaining = (int64_t)buffer.size();
+    doubles_source.write(buffer.data(), "doubles", buffer_remaining);
+  }
+  std::chrono::duration<double> encode_time =
+      std::chrono::steady_clock::now() - start;
+
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i)
+  {
+    buffer_remaining = (int64_t)buffer.size();
+    dest.read(buffer.data(), key, buffer_remaining);
+  }
+  std::chrono::duration<double> decode_time =
+      std::chrono::steady_clock::now() - start;
+
+  std::cerr << "Test 3: encode "
+            << bytes * iterations / encode_time.count() / 1e6
+            << " MB/s, decode "
+            << bytes * iterations / decode_time.count() / 1e6 << " MB/s\n";
+
+  std::cerr << "\nRESULT: ";
+  if (integers_decoded && doubles_decoded)
+  {
+    std::cerr << "SUCCESS\n";
+  }
+  else
+  {
+    std::cerr << "FAIL\n";
+    ++madara_fails;
+  }
+}
+
 int main(int, char**)
 {
   test_image_encoding();
   test_primitive_encoding();
   test_key_id_encoding();
+  test_array_encoding();
 
   if (madara_fails > 0)
   {
@@ -1,3 +1,4 @@
+#include <chrono>
 #include <iostream>
 
 #include "madara/knowledge/KnowledgeRecord.h"
@@ -10,6 +11,7 @@
 #include "madara/filters/PrefixIntConvert.h"
 #include "madara/filters/FragmentsToFilesFilter.h"
 #include "madara/filters/VariableMapFilter.h"
+#include "madara/filters/KeyedRecordFilter.h"
 #include "madara/utility/Utility.h"
 #include "madara/knowledge/FileFragmenter.h"
 #include "madara/knowledge/FileRequester.h"
@@ -447,6 +449,184 @@ void test_variable_map_filter(void)
   }
 }
 
+/**
+ * Keyed filter that decrements integers in place and removes anything
+ * else, remembering the last name it saw
+ **/
+class DecrementKeyed : public filters::KeyedRecordFilter
+{
+public:
+  virtual void filter(const std::string& name, KnowledgeRecord& record,
+      transport::TransportContext&, knowledge::Variables&)
+  {
+    last_name = name;
+
+    if (record.type() == KnowledgeRecord::INTEGER)
+      --record;
+    else
+      record.clear_value();
+  }
+
+  std::string last_name;
+};
+
+/// filter that passes records through unchanged
+madara::knowledge::KnowledgeRecord pass_through(
+    madara::knowledge::FunctionArguments& args, madara::knowledge::Variables&)
+{
+  return args[0];
+}
+
+/// filter functor that passes records through unchanged
+class PassThrough : public filters::RecordFilter
+{
+public:
+  virtual KnowledgeRecord filter(
+      knowledge::FunctionArguments& args, knowledge::Variables&)
+  {
+    return args[0];
+  }
+};
+
+/// keyed filter that passes records through unchanged
+class KeyedPassThrough : public filters::KeyedRecordFilter
+{
+public:
+  virtual void filter(const std::string&, KnowledgeRecord&,
+      transport::TransportContext&, knowledge::Variables&)
+  {
+  }
+};
+
+/// filters used by a filter that runs another filter chain
+knowledge::KnowledgeRecordFilters* inner_filters = 0;
+
+/**
+ * Filter that runs another filter chain from inside the filter, as a
+ * filter that sends would, then returns its own record name
+ **/
+madara::knowledge::KnowledgeRecord nested_filter(
+    madara::knowledge::FunctionArguments& args, madara::knowledge::Variables&)
+{
+  transport::TransportContext context;
+  inner_filters->filter(
+      KnowledgeRecord(KnowledgeRecord::Integer(1)), "inner", context);
+
+  return args[1];
+}
+
+void test_keyed_filters(void)
+{
+  std::cerr << "Testing keyed record filters: ";
+
+  knowledge::KnowledgeRecordFilters filters;
+  DecrementKeyed keyed;
+  transport::TransportContext context;
+
+  filters.add(KnowledgeRecord::INTEGER | KnowledgeRecord::STRING, &keyed);
+  filters.add(KnowledgeRecord::INTEGER, decrement_primitives);
+  filters.add(KnowledgeRecord::INTEGER, &keyed);
+
+  KnowledgeRecord integer_result =
+      filters.filter(KnowledgeRecord(KnowledgeRecord::Integer(10)), "x",
+          context);
+  std::string integer_name = keyed.last_name;
+
+  KnowledgeRecord string_result =
+      filters.filter(KnowledgeRecord("removed"), "y", context);
+
+  if (integer_result == KnowledgeRecord::Integer(7) && integer_name == "x" &&
+      !string_result.exists() && keyed.last_name == "y")
+  {
+    std::cerr << "SUCCESS\n";
+  }
+  else
+  {
+    std::cerr << "FAIL\n";
+    std::cerr << "  integer result = " << integer_result << " for "
+              << integer_name << ", string result = " << string_result
+              << " for " << keyed.last_name << "\n";
+    ++madara_fails;
+  }
+
+  std::cerr << "Testing filter chain run from inside a filter: ";
+
+  knowledge::KnowledgeRecordFilters inner;
+  knowledge::KnowledgeRecordFilters outer;
+  inner.add(KnowledgeRecord::INTEGER, decrement_primitives);
+  outer.add(KnowledgeRecord::INTEGER, nested_filter);
+  inner_filters = &inner;
+
+  KnowledgeRecord outer_result = outer.filter(
+      KnowledgeRecord(KnowledgeRecord::Integer(1)), "outer", context);
+
+  if (outer_result == "outer")
+  {
+    std::cerr << "SUCCESS\n";
+  }
+  else
+  {
+    std::cerr << "FAIL (" << outer_result << ")\n";
+    ++madara_fails;
+  }
+}
+
+/// time per record of a chain of filters
+double time_filter_chain(
+    const knowledge::KnowledgeRecordFilters& filters, int records)
+{
+  transport::TransportContext context(
+      transport::TransportContext::SENDING_OPERATION, 1000, 1000, 0, 0,
+      "benchmark", "localhost:40000");
+  KnowledgeRecord record(KnowledgeRecord::Integer(42));
+  KnowledgeRecord::Integer total = 0;
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (int i = 0; i < records; ++i)
+  {
+    total += filters.filter(record, "agent.0.location", context).to_integer();
+  }
+
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  if (total != KnowledgeRecord::Integer(42) * records)
+  {
+    std::cerr << "FAIL. Benchmark filters changed records\n";
+    ++madara_fails;
+  }
+
+  return elapsed.count() / records;
+}
+
+void benchmark_filters(void)
+{
+  const int records = 200000;
+
+  knowledge::KnowledgeRecordFilters functions;
+  knowledge::KnowledgeRecordFilters functors;
+  knowledge::KnowledgeRecordFilters keyed;
+
+  PassThrough pass_functor;
+  KeyedPassThrough pass_keyed;
+
+  for (int i = 0; i < 3; ++i)
+  {
+    functions.add(KnowledgeRecord::INTEGER, pass_through);
+    functors.add(KnowledgeRecord::INTEGER, &pass_functor);
+    keyed.add(KnowledgeRecord::INTEGER, &pass_keyed);
+  }
+
+  std::cerr << "Benchmarking 3 chained filters per record:\n";
+  std::cerr << "  C functions: " << time_filter_chain(functions, records)
+            << " ns/record\n";
+  std::cerr << "  RecordFilter functors: "
+            << time_filter_chain(functors, records) << " ns/record\n";
+  std::cerr << "  KeyedRecordFilter functors: "
+            << time_filter_chain(keyed, records) << " ns/record\n";
+}
+
 int main(int, char**)
 {
   test_dynamic_predicate_filter();
@@ -456,6 +636,8 @@ int main(int, char**)
   test_print_filter_compile();
   test_variable_map_filter();
   test_fragments_to_files_filter();
+  test_keyed_filters();
+  benchmark_filters();
 
   madara::knowledge::KnowledgeRecordFilters filters;
 
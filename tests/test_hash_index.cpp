@@ -0,0 +1,238 @@
+#include <string>
+#include <iostream>
+#include <vector>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <random>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Timer.h"
+
+#include "test.h"
+
+namespace knowledge = madara::knowledge;
+namespace logger = madara::logger;
+
+typedef knowledge::KnowledgeRecord::Integer Integer;
+typedef std::chrono::steady_clock Clock;
+
+// command line arguments
+void handle_arguments(int argc, char* argv[]);
+
+std::vector<size_t> key_counts = {1000, 100000, 1000000};
+
+std::string key_for(size_t index)
+{
+  std::stringstream buffer;
+  buffer << "swarm.agent." << index / 100 << ".sensor." << index % 100;
+  return buffer.str();
+}
+
+void test_correctness(void)
+{
+  knowledge::KnowledgeBase kb;
+  knowledge::ThreadSafeContext& context = kb.get_context();
+
+  kb.set("agent.0.pos", Integer(1));
+  kb.set("agent.1.pos", Integer(2));
+  knowledge::VariableReference ref = kb.get_ref("agent.1.pos");
+
+  context.use_hash_index(true);
+  TEST_EQ(context.uses_hash_index(), true);
+
+  // existing references remain valid and resolve to the same record
+  TEST_EQ(kb.get(ref).to_integer(), 2);
+  TEST_EQ(kb.get("agent.1.pos").to_integer(), 2);
+  TEST_EQ(kb.get_ref("agent.1.pos").get_record_unsafe(),
+      ref.get_record_unsafe());
+
+  // new keys are indexed and visible to prefix scans
+  kb.set("agent.2.pos", Integer(3));
+  TEST_EQ(kb.get("agent.2.pos").to_integer(), 3);
+  TEST_EQ(kb.to_map("agent.").size(), (size_t)3);
+
+  // deletions purge the index
+  context.delete_variable("agent.0.pos");
+  TEST_EQ(kb.exists("agent.0.pos"), false);
+  TEST_EQ(kb.get("agent.0.pos").to_integer(), 0);
+
+  context.delete_prefix("agent.");
+  TEST_EQ(kb.exists("agent.1.pos"), false);
+  TEST_EQ(kb.exists("agent.2.pos"), false);
+
+  kb.set("agent.1.pos", Integer(5));
+  TEST_EQ(kb.get("agent.1.pos").to_integer(), 5);
+
+  kb.clear(true);
+  TEST_EQ(kb.exists("agent.1.pos"), false);
+
+  context.use_hash_index(false);
+  TEST_EQ(context.uses_hash_index(), false);
+}
+
+void print_result(const std::string& type, size_t keys, uint64_t ordered_ns,
+    uint64_t hashed_ns, size_t ops)
+{
+  std::stringstream buffer;
+
+  std::locale loc("C");
+  buffer.imbue(loc);
+
+  if (ordered_ns == 0)
+    ordered_ns = 1;
+  if (hashed_ns == 0)
+    hashed_ns = 1;
+
+  buffer << " " << std::left << std::setw(14) << type << std::right
+         << " keys=" << std::setw(8) << keys;
+  buffer << std::fixed << std::setprecision(0);
+  buffer << "  map=" << std::setw(12) << (1000000000.0 * ops / ordered_ns)
+         << " ops/s";
+  buffer << "  hash=" << std::setw(12) << (1000000000.0 * ops / hashed_ns)
+         << " ops/s";
+  buffer << std::setprecision(2) << "  (" << (double)ordered_ns / hashed_ns
+         << "x)\n";
+
+  madara_logger_ptr_log(
+      logger::global_logger.get(), logger::LOG_ALWAYS, buffer.str().c_str());
+}
+
+/// runs insert, lookup and prefix scan benchmarks on a knowledge base
+void benchmark(size_t keys, bool hashed, uint64_t& insert_ns,
+    uint64_t& lookup_ns, uint64_t& scan_ns, size_t& scans)
+{
+  knowledge::KnowledgeBase kb;
+  kb.get_context().use_hash_index(hashed);
+
+  knowledge::EvalSettings settings(false, false, false);
+
+  std::vector<std::string> names;
+  names.reserve(keys);
+  for (size_t i = 0; i < keys; ++i)
+  {
+    names.push_back(key_for(i));
+  }
+
+  madara::utility::Timer<Clock> timer;
+
+  timer.start();
+  for (size_t i = 0; i < keys; ++i)
+  {
+    kb.set(names[i], (Integer)i, settings);
+  }
+  timer.stop();
+  insert_ns = timer.duration_ns();
+
+  // look the keys up in a random order to defeat the caches
+  std::shuffle(names.begin(), names.end(), std::mt19937(42));
+
+  Integer total = 0;
+  timer.start();
+  for (size_t i = 0; i < keys; ++i)
+  {
+    total += kb.get(names[i]).to_integer();
+  }
+  timer.stop();
+  lookup_ns = timer.duration_ns();
+
+  TEST_EQ(total, (Integer)((keys - 1) * keys / 2));
+
+  scans = std::min(keys / 100, (size_t)1000);
+  timer.start();
+  for (size_t i = 0; i < scans; ++i)
+  {
+    std::stringstream prefix;
+    prefix << "swarm.agent." << i << ".";
+    total += (Integer)kb.to_map(prefix.str()).size();
+  }
+  timer.stop();
+  scan_ns = timer.duration_ns();
+}
+
+int main(int argc, char* argv[])
+{
+  handle_arguments(argc, argv);
+
+  test_correctness();
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "\nOrdered map vs. hash index throughput:\n"
+      "========================================================================"
+      "=\n");
+
+  for (auto keys : key_counts)
+  {
+    uint64_t ordered[3], hashed[3];
+    size_t scans;
+
+    benchmark(keys, false, ordered[0], ordered[1], ordered[2], scans);
+    benchmark(keys, true, hashed[0], hashed[1], hashed[2], scans);
+
+    print_result("insert", keys, ordered[0], hashed[0], keys);
+    print_result("lookup", keys, ordered[1], hashed[1], keys);
+    print_result("prefix scan", keys, ordered[2], hashed[2], scans);
+  }
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "========================================================================"
+      "=\n\n");
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
+
+void handle_arguments(int argc, char* argv[])
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-k" || arg1 == "--keys")
+    {
+      if (i + 1 < argc)
+      {
+        size_t keys;
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> keys;
+        key_counts = {keys};
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-l" || arg1 == "--level")
+    {
+      if (i + 1 < argc)
+      {
+        int level;
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> level;
+        logger::global_logger->set_level(level);
+      }
+
+      ++i;
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(),
+          logger::LOG_ALWAYS, "Program Summary for %s:\n\n\
+This stand-alone application tests the context hash index and compares\n\
+lookup, insert and prefix scan throughput against the ordered map at\n\
+1k, 100k and 1M keys.\n\n\
+-k (--keys)        only benchmark this number of keys\n\
+-l (--level)       logger level              \n\
+-h (--help)        print this menu           \n\n", argv[0]);
+      exit(0);
+    }
+  }
+}
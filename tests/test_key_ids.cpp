@@ -0,0 +1,647 @@
+#include <string>
+#include <iostream>
+#include <vector>
+#include <sstream>
+#include <iomanip>
+#include <random>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/transport/Transport.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Timer.h"
+
+#include "test.h"
+
+namespace knowledge = madara::knowledge;
+namespace transport = madara::transport;
+namespace logger = madara::logger;
+namespace utility = madara::utility;
+
+typedef knowledge::KnowledgeRecord::Integer Integer;
+typedef std::chrono::steady_clock Clock;
+
+// command line arguments
+void handle_arguments(int argc, char* argv[]);
+
+// the number of steps of the recorded workload to benchmark (0 to skip)
+uint32_t benchmark_steps = 0;
+
+/**
+ * A transport that keeps the packets prep_send makes instead of sending
+ * them
+ **/
+class PacketTransport : public transport::Base
+{
+public:
+  PacketTransport(const std::string& id, transport::TransportSettings& settings,
+      knowledge::ThreadSafeContext& context)
+    : transport::Base(id, settings, context)
+  {
+    this->setup();
+    this->is_valid_ = true;
+  }
+
+  long send_data(const knowledge::KnowledgeMap& updates) override
+  {
+    long size = prep_send(updates, "PacketTransport::send_data");
+
+    if (size > 0)
+    {
+      packets.emplace_back(buffer_.get_ptr(), buffer_.get_ptr() + size);
+    }
+
+    return size;
+  }
+
+  /// the packets sent
+  std::vector<std::vector<char>> packets;
+};
+
+/**
+ * A knowledge base and what process_received_update needs to apply
+ * packets to it
+ **/
+class Receiver
+{
+public:
+  Receiver()
+  {
+    settings.add_read_domain(settings.write_domain);
+  }
+
+  /// applies a packet, returning what process_received_update returns
+  int receive(std::vector<char> packet)
+  {
+    return transport::process_received_update(packet.data(),
+        (uint32_t)packet.size(), "receiver:40000", kb.get_context(), settings,
+        send_monitor, receive_monitor, rebroadcast_records,
+#ifndef _MADARA_NO_KARL_
+        on_data_received,
+#endif  // _MADARA_NO_KARL_
+        "Receiver::receive", "sender:40000", scratch, header);
+  }
+
+  knowledge::KnowledgeBase kb;
+  transport::QoSTransportSettings settings;
+  transport::BandwidthMonitor send_monitor, receive_monitor;
+  knowledge::KnowledgeMap rebroadcast_records;
+  transport::ReceiveScratch scratch;
+  transport::MessageHeader* header = 0;
+
+#ifndef _MADARA_NO_KARL_
+  knowledge::CompiledExpression on_data_received;
+#endif  // _MADARA_NO_KARL_
+};
+
+/// settings for a sender of keyed messages
+transport::TransportSettings keyed_settings(uint32_t refresh)
+{
+  transport::TransportSettings settings;
+  settings.send_key_ids = true;
+  settings.key_id_refresh = refresh;
+  return settings;
+}
+
+void test_key_dictionary(void)
+{
+  std::cerr << "\n*********** TEST KEY DICTIONARY *************.\n";
+
+  transport::KeyDictionary ids;
+
+  std::vector<std::string> keys;
+  for (int i = 0; i < 16; ++i)
+  {
+    keys.push_back("swarm.agent." + std::to_string(i) + ".sensor.lidar.points");
+  }
+
+  // new keys are defined in the first message that has them
+  ids.start_message(8);
+  for (size_t i = 0; i < keys.size(); ++i)
+  {
+    TEST_EQ(ids.get_id(keys[i]), (uint32_t)i);
+  }
+  TEST_EQ(ids.get_definitions(), (uint32_t)16);
+  TEST_EQ(ids.get_id(keys[3]), (uint32_t)3);
+  TEST_EQ(ids.get_definitions(), (uint32_t)16);
+
+  // and redefined once every 8 messages, spread over those messages
+  uint32_t total = 0, most = 0;
+  for (int message = 0; message < 8; ++message)
+  {
+    ids.start_message(8);
+    for (auto& key : keys)
+    {
+      ids.get_id(key);
+    }
+
+    total += ids.get_definitions();
+    most = std::max(most, ids.get_definitions());
+  }
+  TEST_EQ(total, (uint32_t)16);
+  TEST_EQ(most, (uint32_t)2);
+
+  // 0 only defines them once
+  transport::KeyDictionary once;
+  once.start_message(0);
+  once.get_id(keys[0]);
+  TEST_EQ(once.get_definitions(), (uint32_t)1);
+  for (int message = 0; message < 100; ++message)
+  {
+    once.start_message(0);
+    once.get_id(keys[0]);
+    TEST_EQ(once.get_definitions(), (uint32_t)0);
+  }
+
+  // clearing forgets the ids and changes the epoch
+  uint32_t epoch = ids.get_epoch();
+  ids.clear();
+  TEST_EQ(ids.size(), (size_t)0);
+  TEST_NE(ids.get_epoch(), epoch);
+}
+
+void test_round_trip(void)
+{
+  std::cerr << "\n*********** TEST KEYED ROUND TRIP *************.\n";
+
+  knowledge::KnowledgeBase sender_kb;
+  transport::TransportSettings settings = keyed_settings(100);
+  PacketTransport sender("agent.0:40000", settings, sender_kb.get_context());
+  Receiver receiver;
+
+  knowledge::KnowledgeMap updates;
+  updates["swarm.agent.0.pose.position"] =
+      knowledge::KnowledgeRecord(std::vector<double>{1.0, 2.0, 3.0});
+  updates["swarm.agent.0.sensor.battery.voltage"] =
+      knowledge::KnowledgeRecord(11.9);
+  updates["swarm.agent.0.status.mode"] = knowledge::KnowledgeRecord("search");
+  updates["swarm.agent.0.sensor.gps.fix"] =
+      knowledge::KnowledgeRecord(Integer(3));
+
+  sender.send_data(updates);
+
+  updates["swarm.agent.0.sensor.battery.voltage"] =
+      knowledge::KnowledgeRecord(11.8);
+  updates["swarm.agent.0.sensor.gps.fix"] =
+      knowledge::KnowledgeRecord(Integer(2));
+  sender.send_data(updates);
+
+  TEST_EQ(sender.packets.size(), (size_t)2);
+
+  // the second message has no definitions, and is smaller than the same
+  // updates with key strings
+  TEST_EQ(transport::KeyedMessageHeader::keyed_message_header_test(
+              sender.packets[0].data()),
+      true);
+  TEST_LT(sender.packets[1].size(), sender.packets[0].size());
+
+  knowledge::KnowledgeBase plain_kb;
+  transport::TransportSettings plain_settings;
+  PacketTransport plain("agent.0:40000", plain_settings, plain_kb.get_context());
+  plain.send_data(updates);
+  TEST_LT(sender.packets[1].size() + 100, plain.packets[0].size());
+
+  TEST_EQ(receiver.receive(sender.packets[0]), 4);
+  TEST_EQ(receiver.header == &receiver.scratch.keyed_header, true);
+  TEST_EQ(receiver.kb.get("swarm.agent.0.status.mode").to_string(), "search");
+  TEST_EQ(receiver.kb.get("swarm.agent.0.sensor.gps.fix").to_integer(), 3);
+
+  TEST_EQ(receiver.receive(sender.packets[1]), 4);
+  TEST_EQ(
+      receiver.kb.get("swarm.agent.0.sensor.battery.voltage").to_double(), 11.8);
+  TEST_EQ(receiver.kb.get("swarm.agent.0.sensor.gps.fix").to_integer(), 2);
+  TEST_EQ(receiver.kb.get("swarm.agent.0.pose.position")
+              .retrieve_index(2)
+              .to_double(),
+      3.0);
+
+  // rebroadcasts carry key strings, as the ids belong to the originator
+  std::vector<char> rebroadcast(64000);
+  int64_t remaining = (int64_t)rebroadcast.size();
+  receiver.header->ttl = 1;
+  transport::QoSTransportSettings rebroadcast_settings;
+  rebroadcast_settings.queue_length = (uint32_t)rebroadcast.size();
+  transport::PacketScheduler scheduler(&rebroadcast_settings);
+  int size = transport::prep_rebroadcast(receiver.kb.get_context(),
+      rebroadcast.data(), remaining, rebroadcast_settings, "test_round_trip",
+      receiver.header, receiver.rebroadcast_records, scheduler);
+
+  TEST_GT(size, 0);
+  TEST_EQ(transport::MessageHeader::message_header_test(rebroadcast.data()),
+      true);
+
+  rebroadcast.resize((size_t)size);
+  Receiver relay;
+  TEST_EQ(relay.receive(rebroadcast), 4);
+  TEST_EQ(relay.kb.get("swarm.agent.0.status.mode").to_string(), "search");
+}
+
+void test_packet_loss(void)
+{
+  std::cerr << "\n*********** TEST KEYED PACKET LOSS *************.\n";
+
+  knowledge::KnowledgeBase sender_kb;
+  transport::TransportSettings settings = keyed_settings(4);
+  PacketTransport sender("agent.1:40000", settings, sender_kb.get_context());
+  Receiver receiver;
+
+  std::vector<std::string> keys = {"swarm.agent.1.sensor.lidar.range",
+      "swarm.agent.1.sensor.battery.voltage", "swarm.agent.1.status.mode",
+      "swarm.agent.1.sensor.gps.fix"};
+
+  for (Integer step = 1; step <= 5; ++step)
+  {
+    knowledge::KnowledgeMap updates;
+    for (auto& key : keys)
+    {
+      updates[key] = knowledge::KnowledgeRecord(step);
+    }
+    sender.send_data(updates);
+  }
+
+  // the packet with the definitions is lost, so only the keys that are
+  // defined again can be read
+  int applied = receiver.receive(sender.packets[1]);
+  TEST_LT(applied, (int)keys.size());
+  TEST_EQ(receiver.kb.exists(keys[0]), false);
+
+  // the ids are redefined over the next messages, so after a refresh
+  // period every key has arrived
+  int total = 0;
+  for (size_t i = 2; i < sender.packets.size(); ++i)
+  {
+    total += receiver.receive(sender.packets[i]);
+  }
+
+  TEST_GT(total, 0);
+  TEST_LT(total, (int)(keys.size() * 3));
+
+  for (auto& key : keys)
+  {
+    TEST_EQ(receiver.kb.get(key).to_integer(), 5);
+  }
+
+  // a receiver that joins late also catches up
+  Receiver late;
+  for (Integer step = 6; step <= 10; ++step)
+  {
+    knowledge::KnowledgeMap updates;
+    for (auto& key : keys)
+    {
+      updates[key] = knowledge::KnowledgeRecord(step);
+    }
+    sender.send_data(updates);
+    late.receive(sender.packets.back());
+  }
+
+  for (auto& key : keys)
+  {
+    TEST_EQ(late.kb.get(key).to_integer(), 10);
+  }
+}
+
+void test_epochs(void)
+{
+  std::cerr << "\n*********** TEST KEYED SENDER RESTART *************.\n";
+
+  Receiver receiver;
+
+  knowledge::KnowledgeMap first;
+  first["swarm.agent.2.a"] = knowledge::KnowledgeRecord(Integer(1));
+  first["swarm.agent.2.b"] = knowledge::KnowledgeRecord(Integer(2));
+
+  {
+    knowledge::KnowledgeBase sender_kb;
+    transport::TransportSettings settings = keyed_settings(0);
+    PacketTransport sender("agent.2:40000", settings, sender_kb.get_context());
+    sender.send_data(first);
+    TEST_EQ(receiver.receive(sender.packets[0]), 2);
+  }
+
+  // the restarted sender gives b the id a had
+  knowledge::KnowledgeMap second;
+  second["swarm.agent.2.b"] = knowledge::KnowledgeRecord(Integer(20));
+
+  knowledge::KnowledgeBase sender_kb;
+  transport::TransportSettings settings = keyed_settings(0);
+  PacketTransport sender("agent.2:40000", settings, sender_kb.get_context());
+  sender.send_data(second);
+  TEST_EQ(receiver.receive(sender.packets[0]), 1);
+
+  TEST_EQ(receiver.kb.get("swarm.agent.2.a").to_integer(), 1);
+  TEST_EQ(receiver.kb.get("swarm.agent.2.b").to_integer(), 20);
+
+  // the ids of the old epoch are forgotten, so b is not defined twice
+  sender.packets.clear();
+  second["swarm.agent.2.b"] = knowledge::KnowledgeRecord(Integer(21));
+  sender.send_data(second);
+  TEST_EQ(receiver.receive(sender.packets[0]), 1);
+  TEST_EQ(receiver.kb.get("swarm.agent.2.b").to_integer(), 21);
+  TEST_EQ(receiver.scratch.peer_keys.size(), (size_t)1);
+}
+
+void test_malformed(void)
+{
+  std::cerr << "\n*********** TEST KEYED MALFORMED DEFINITIONS *************.\n";
+
+  knowledge::KnowledgeBase sender_kb;
+  transport::TransportSettings settings = keyed_settings(100);
+  PacketTransport sender("agent.3:40000", settings, sender_kb.get_context());
+
+  knowledge::KnowledgeMap updates;
+  updates["swarm.agent.3.x"] = knowledge::KnowledgeRecord(Integer(1));
+  sender.send_data(updates);
+
+  size_t definition = transport::KeyedMessageHeader::static_encoded_size();
+
+  // a key that is not terminated
+  std::vector<char> packet(sender.packets[0]);
+  packet[definition + 8 + strlen("swarm.agent.3.x")] = 'x';
+  Receiver receiver;
+  TEST_EQ(receiver.receive(packet), -1);
+  TEST_EQ(receiver.kb.exists("swarm.agent.3.x"), false);
+
+  // an id too large to keep
+  packet = sender.packets[0];
+  uint32_t id =
+      utility::endian_swap(transport::PeerKeyDictionaries::MAX_KEY_ID);
+  memcpy(packet.data() + definition, &id, sizeof(id));
+  TEST_EQ(receiver.receive(packet), -1);
+
+  // the good packet still works
+  TEST_EQ(receiver.receive(sender.packets[0]), 1);
+}
+
+/**
+ * A recorded telemetry workload: each agent publishes its pose, sensors
+ * and status every step, but only the values that changed
+ **/
+class Workload
+{
+public:
+  Workload(size_t agents) : random_(42)
+  {
+    for (size_t i = 0; i < agents; ++i)
+    {
+      std::string prefix = "swarm.agent." + std::to_string(i) + ".";
+      std::vector<std::string> keys = {prefix + "pose.position",
+          prefix + "pose.orientation", prefix + "pose.velocity",
+          prefix + "sensor.lidar.range", prefix + "sensor.lidar.points",
+          prefix + "sensor.battery.voltage", prefix + "sensor.battery.current",
+          prefix + "sensor.gps.fix", prefix + "sensor.gps.satellites",
+          prefix + "status.mode", prefix + "status.task.id",
+          prefix + "status.heartbeat"};
+      agent_keys.push_back(keys);
+    }
+  }
+
+  /// the updates agent makes at a step. Values, and the first element of
+  /// arrays, are never 0, which prep_send treats as missing.
+  knowledge::KnowledgeMap step(size_t agent, Integer step)
+  {
+    const std::vector<std::string>& keys = agent_keys[agent];
+    knowledge::KnowledgeMap updates;
+
+    double t = step * 0.1;
+
+    // the pose and heartbeat change every step
+    updates[keys[0]] = knowledge::KnowledgeRecord(
+        std::vector<double>{t + 1, t * 0.5, 10.0 + agent});
+    updates[keys[1]] = knowledge::KnowledgeRecord(
+        std::vector<double>{1.0, 0.0, 0.0, t * 0.01});
+    updates[keys[2]] =
+        knowledge::KnowledgeRecord(std::vector<double>{1.0, 0.5, 0.0});
+    updates[keys[11]] = knowledge::KnowledgeRecord(step + 1);
+
+    // the sensors change some of the time
+    if (random_() % 2 == 0)
+    {
+      updates[keys[3]] = knowledge::KnowledgeRecord(5.0 + random_() % 100);
+      updates[keys[4]] = knowledge::KnowledgeRecord(Integer(1 + random_() % 4000));
+    }
+    if (random_() % 4 == 0)
+    {
+      updates[keys[5]] = knowledge::KnowledgeRecord(12.0 - step * 0.0001);
+      updates[keys[6]] = knowledge::KnowledgeRecord(1.5 + random_() % 10 * 0.1);
+    }
+    if (random_() % 10 == 0)
+    {
+      updates[keys[7]] = knowledge::KnowledgeRecord(Integer(3));
+      updates[keys[8]] = knowledge::KnowledgeRecord(Integer(1 + random_() % 12));
+    }
+
+    // and the status rarely does
+    if (random_() % 50 == 0)
+    {
+      updates[keys[9]] = knowledge::KnowledgeRecord(
+          random_() % 2 == 0 ? "search" : "return");
+      updates[keys[10]] = knowledge::KnowledgeRecord(Integer(1 + step / 50));
+    }
+
+    return updates;
+  }
+
+  /// the keys of each agent
+  std::vector<std::vector<std::string>> agent_keys;
+
+private:
+  std::mt19937 random_;
+};
+
+/// what it cost to send and receive the workload
+struct Cost
+{
+  uint64_t bytes = 0;
+  uint64_t packets = 0;
+  uint64_t records = 0;
+  uint64_t send_ns = 0;
+  uint64_t receive_ns = 0;
+};
+
+/// sends steps of the workload from agents agents to one receiver
+Cost run_workload(size_t agents, uint32_t steps, bool send_key_ids)
+{
+  Workload workload(agents);
+  Receiver receiver;
+
+  std::vector<std::unique_ptr<knowledge::KnowledgeBase>> kbs;
+  std::vector<std::unique_ptr<PacketTransport>> senders;
+  transport::TransportSettings settings;
+  settings.send_key_ids = send_key_ids;
+
+  for (size_t i = 0; i < agents; ++i)
+  {
+    kbs.emplace_back(new knowledge::KnowledgeBase);
+    senders.emplace_back(new PacketTransport("agent." + std::to_string(i) +
+                                                 ":40000",
+        settings, kbs.back()->get_context()));
+  }
+
+  Cost cost;
+  utility::Timer<Clock> send_timer, receive_timer;
+  std::vector<char> buffer;
+
+  for (uint32_t step = 0; step < steps; ++step)
+  {
+    for (size_t i = 0; i < agents; ++i)
+    {
+      knowledge::KnowledgeMap updates = workload.step(i, step);
+      PacketTransport& sender = *senders[i];
+
+      send_timer.start();
+      sender.send_data(updates);
+      send_timer.stop();
+      cost.send_ns += send_timer.duration_ns();
+
+      const std::vector<char>& packet = sender.packets.back();
+      cost.bytes += packet.size();
+      ++cost.packets;
+
+      // decode filters may modify the buffer in place
+      buffer.assign(packet.begin(), packet.end());
+
+      receive_timer.start();
+      int applied = transport::process_received_update(buffer.data(),
+          (uint32_t)buffer.size(), "receiver:40000",
+          receiver.kb.get_context(), receiver.settings, receiver.send_monitor,
+          receiver.receive_monitor, receiver.rebroadcast_records,
+#ifndef _MADARA_NO_KARL_
+          receiver.on_data_received,
+#endif  // _MADARA_NO_KARL_
+          "run_workload", "sender:40000", receiver.scratch, receiver.header);
+      receive_timer.stop();
+      cost.receive_ns += receive_timer.duration_ns();
+
+      TEST_EQ(applied, (int)updates.size());
+      cost.records += updates.size();
+
+      sender.packets.clear();
+    }
+  }
+
+  TEST_EQ(receiver.kb.get(workload.agent_keys[0][11]).to_integer(),
+      (Integer)steps);
+
+  return cost;
+}
+
+void benchmark_workload(uint32_t steps)
+{
+  size_t agents = 20;
+
+  // warm up
+  run_workload(agents, steps / 10 + 1, false);
+  run_workload(agents, steps / 10 + 1, true);
+
+  Cost full = run_workload(agents, steps, false);
+  Cost ids = run_workload(agents, steps, true);
+
+  std::stringstream buffer;
+  buffer << std::fixed;
+
+  auto line = [&](const char* name, const Cost& cost) {
+    buffer << "  " << std::left << std::setw(14) << name << std::right
+           << std::setprecision(1) << std::setw(10)
+           << (double)cost.bytes / cost.packets << std::setw(12)
+           << (double)cost.bytes / cost.records << std::setprecision(0)
+           << std::setw(14) << (double)cost.send_ns / cost.packets
+           << std::setw(14) << (double)cost.receive_ns / cost.packets << "\n";
+  };
+
+  line("key strings", full);
+  line("key ids", ids);
+
+  buffer << std::setprecision(1) << "  key ids use "
+         << 100.0 * ids.bytes / full.bytes << "% of the bytes, "
+         << 100.0 * ids.send_ns / full.send_ns << "% of the send time and "
+         << 100.0 * ids.receive_ns / full.receive_ns
+         << "% of the receive time\n";
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "\nTelemetry workload, %d agents for %d steps (%d packets, %d "
+      "records):\n"
+      "                   B/packet    B/record   send ns/pkt   recv ns/pkt\n"
+      "========================================================================"
+      "=\n%s"
+      "========================================================================"
+      "=\n\n",
+      (int)agents, (int)steps, (int)full.packets, (int)full.records,
+      buffer.str().c_str());
+}
+
+int main(int argc, char* argv[])
+{
+  handle_arguments(argc, argv);
+
+  test_key_dictionary();
+  test_round_trip();
+  test_packet_loss();
+  test_epochs();
+  test_malformed();
+
+  // the workload is checked, if not timed, in every run
+  run_workload(4, 200, true);
+
+  if (benchmark_steps > 0)
+  {
+    benchmark_workload(benchmark_steps);
+  }
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
+
+void handle_arguments(int argc, char* argv[])
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-l" || arg1 == "--level")
+    {
+      if (i + 1 < argc)
+      {
+        int level;
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> level;
+        logger::global_logger->set_level(level);
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-b" || arg1 == "--benchmark")
+    {
+      benchmark_steps = 2000;
+
+      if (i + 1 < argc && argv[i + 1][0] != '-')
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> benchmark_steps;
+        ++i;
+      }
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+          "\nProgram summary for %s:\n\n"
+          "  Tests sending updates keyed by ids instead of key strings.\n\n"
+          " [-l|--level level]         the logger level (0+, higher is higher "
+          "detail)\n"
+          " [-b|--benchmark [steps]]   compare bytes and time with key "
+          "strings over\n"
+          "                            steps of a telemetry workload "
+          "(default 2000)\n"
+          "\n",
+          argv[0]);
+      exit(0);
+    }
+  }
+}
@@ -0,0 +1,225 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <thread>
+#include <cstdio>
+
+#include "madara/logger/Logger.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Utility.h"
+#include "madara/utility/Timer.h"
+
+#include "test.h"
+
+namespace logger = madara::logger;
+namespace utility = madara::utility;
+
+const std::string log_file("test_logger_async.txt");
+
+int num_threads = 8;
+int num_messages = 20000;
+
+void handle_arguments(int argc, char** argv)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-m" || arg1 == "--messages")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> num_messages;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-t" || arg1 == "--threads")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> num_threads;
+      }
+
+      ++i;
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+          "\nProgram summary for %s:\n\n"
+          "  Checks that asynchronous logging writes every message that\n"
+          "  fits in its ring and counts the rest, and compares log calls\n"
+          "  per second with synchronous logging.\n\n"
+          " [-m|--messages num]      messages logged by each thread\n"
+          " [-t|--threads num]       threads that log at the same time\n"
+          "\n",
+          argv[0]);
+      exit(0);
+    }
+  }
+}
+
+/// counts the lines in the log file
+size_t count_lines(void)
+{
+  std::ifstream input(log_file.c_str());
+  std::string line;
+  size_t lines = 0;
+
+  while (std::getline(input, line))
+    ++lines;
+
+  return lines;
+}
+
+/// logs from many threads at once and returns the log calls per second
+double log_messages(logger::Logger& file_log, int threads, int messages)
+{
+  std::vector<std::thread> loggers;
+
+  utility::Timer<utility::Clock> timer;
+  timer.start();
+
+  for (int t = 0; t < threads; ++t)
+  {
+    loggers.emplace_back([&file_log, t, messages]() {
+      for (int i = 0; i < messages; ++i)
+      {
+        madara_logger_log(file_log, logger::LOG_MAJOR,
+            "thread %d logged message %d of a long running benchmark\n", t,
+            i);
+      }
+    });
+  }
+
+  for (std::thread& thread : loggers)
+  {
+    thread.join();
+  }
+
+  timer.stop();
+
+  return (double)threads * messages / timer.duration_ds();
+}
+
+void test_delivery(void)
+{
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "Testing that asynchronous logging writes every message\n");
+
+  std::remove(log_file.c_str());
+
+  logger::Logger file_log(false);
+  file_log.set_level(logger::LOG_MAJOR);
+  file_log.add_file(log_file);
+
+  file_log.enable_async(4 * 1024 * 1024);
+  TEST_EQ(file_log.is_async(), true);
+
+  log_messages(file_log, num_threads, 1000);
+  file_log.flush();
+
+  TEST_EQ(file_log.get_dropped(), 0);
+  TEST_EQ(count_lines(), (size_t)num_threads * 1000);
+
+  // the rings of exited threads are retired, and new threads get new rings
+  log_messages(file_log, num_threads, 1000);
+  file_log.disable_async();
+  TEST_EQ(file_log.is_async(), false);
+
+  file_log.clear();
+  TEST_EQ(count_lines(), (size_t)num_threads * 2000);
+}
+
+void test_overflow(void)
+{
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "Testing that messages that do not fit are counted\n");
+
+  std::remove(log_file.c_str());
+
+  logger::Logger file_log(false);
+  file_log.set_level(logger::LOG_MAJOR);
+  file_log.add_file(log_file);
+
+  // a ring of a few messages, filled faster than it can be written
+  file_log.enable_async(512);
+
+  log_messages(file_log, 1, 10000);
+  file_log.flush();
+
+  uint64_t dropped = file_log.get_dropped();
+  TEST_GT(dropped, 0);
+
+  file_log.disable_async();
+  file_log.clear();
+
+  TEST_EQ(count_lines() + dropped, 10000);
+}
+
+int main(int argc, char** argv)
+{
+  handle_arguments(argc, argv);
+
+  test_delivery();
+  test_overflow();
+
+  std::remove(log_file.c_str());
+
+  double sync_rate, async_rate;
+  uint64_t dropped;
+
+  {
+    logger::Logger file_log(false);
+    file_log.set_level(logger::LOG_MAJOR);
+    file_log.add_file(log_file);
+
+    sync_rate = log_messages(file_log, num_threads, num_messages);
+  }
+
+  std::remove(log_file.c_str());
+
+  {
+    logger::Logger file_log(false);
+    file_log.set_level(logger::LOG_MAJOR);
+    file_log.add_file(log_file);
+    file_log.enable_async();
+
+    async_rate = log_messages(file_log, num_threads, num_messages);
+
+    file_log.flush();
+    dropped = file_log.get_dropped();
+  }
+
+  std::remove(log_file.c_str());
+
+  TEST_GT(async_rate, 0.0);
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "\nLog calls per second (%d threads, %d messages each):\n"
+      "========================================================================"
+      "=\n"
+      " synchronous   %12.0f\n"
+      " asynchronous  %12.0f (%llu dropped)\n"
+      "========================================================================"
+      "=\n\n",
+      num_threads, num_messages, sync_rate, async_rate,
+      (unsigned long long)dropped);
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
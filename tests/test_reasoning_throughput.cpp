@@ -77,6 +77,9 @@ uint64_t test_compiled_sfi(
 uint64_t test_compiled_lfi(
     madara::knowledge::KnowledgeBase& knowledge, uint32_t iterations);
 
+uint64_t test_compiled_nfc(
+    madara::knowledge::KnowledgeBase& knowledge, uint32_t iterations);
+
 uint64_t test_extern_call(
     madara::knowledge::KnowledgeBase& knowledge, uint32_t iterations);
 
@@ -120,6 +123,7 @@ long increment(long value);
 uint32_t num_iterations = 100000;
 uint32_t num_runs = 10;
 bool conditional = true;
+bool bytecode = false;
 uint32_t step = 1;
 
 // still trying to stop this darn thing from optimizing the increments
@@ -286,6 +290,9 @@ int main(int argc, char* argv[])
   madara::knowledge::KnowledgeBase knowledge;
 
 #ifndef _MADARA_NO_KARL_
+  if (bytecode)
+    knowledge.get_context().use_bytecode();
+
   increment_ce = knowledge.compile("++.var1");
 #endif
 
@@ -300,7 +307,7 @@ int main(int argc, char* argv[])
     exit(-1);
   }
 
-  const int num_test_types = 36;
+  const int num_test_types = 37;
 
   // make everything all pretty and for-loopy
   uint64_t results[num_test_types];
@@ -320,6 +327,7 @@ int main(int argc, char* argv[])
       "KaRL: Extern Function Call        ",
       "KaRL: Compiled Extern Inc Func    ",
       "KaRL: Compiled Extern Multi Calls ",
+      "KaRL: Compiled Nested Func Calls  ",
       "KaRL: Looped Simple Increments    ",
       "KaRL: Optimized Loop              ",
       "KaRL: Looped Simple Ternary Inc   ",
@@ -360,6 +368,7 @@ int main(int argc, char* argv[])
     ExternCall,
     CompiledSFI,
     CompiledLFI,
+    CompiledNFC,
     LoopedSR,
     OptimalLoop,
     LoopedSI,
@@ -404,6 +413,7 @@ int main(int argc, char* argv[])
   test_functions[ExternCall] = test_extern_call;
   test_functions[CompiledSFI] = test_compiled_sfi;
   test_functions[CompiledLFI] = test_compiled_lfi;
+  test_functions[CompiledNFC] = test_compiled_nfc;
 
   test_functions[LoopedSR] = test_looped_sr;
   test_functions[OptimalLoop] = test_optimal_loop;
@@ -437,6 +447,8 @@ int main(int argc, char* argv[])
   knowledge.define_function("inc", increment_var1);
   knowledge.define_function("no_op", no_op);
   knowledge.define_function("inc_var_ref", increment_var1_through_variables);
+  knowledge.define_function("inc_arg", "++.var1");
+  knowledge.define_function("inc_twice", "inc_arg (.var1); inc_arg (.var1)");
 #endif
 
   madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
@@ -825,6 +837,40 @@ uint64_t test_compiled_sfi(
 #endif
 }
 
+/// Tests KaRL functions called from KaRL functions
+uint64_t test_compiled_nfc(
+    madara::knowledge::KnowledgeBase& knowledge, uint32_t iterations)
+{
+  knowledge.clear();
+#ifndef _MADARA_NO_KARL_
+  madara::knowledge::CompiledExpression ce;
+
+  ce = knowledge.compile("inc_twice (.var1)");
+
+  // keep track of time
+  uint64_t measured(0);
+  madara::utility::Timer<Clock> timer;
+
+  timer.start();
+
+  for (uint32_t i = 0; i < iterations; ++i)
+  {
+    knowledge.evaluate(
+        ce, madara::knowledge::EvalSettings(false, false, false));
+  }
+
+  timer.stop();
+  measured = timer.duration_ns();
+
+  print(measured, knowledge.get(".var1"), iterations,
+      "Compiled Nested KaRL Function Calls: ");
+
+  return measured;
+#else
+  return 0;
+#endif
+}
+
 uint64_t test_extern_call(
     madara::knowledge::KnowledgeBase& knowledge, uint32_t iterations)
 {
@@ -1836,7 +1882,11 @@ void handle_arguments(int argc, char* argv[])
   {
     std::string arg1(argv[i]);
 
-    if (arg1 == "-c" || arg1 == "--conditional")
+    if (arg1 == "-b" || arg1 == "--bytecode")
+    {
+      bytecode = true;
+    }
+    else if (arg1 == "-c" || arg1 == "--conditional")
     {
       if (i + 1 < argc)
       {
@@ -1912,6 +1962,7 @@ void handle_arguments(int argc, char* argv[])
 This stand-alone application runs a variety of tests to determine\n\
 performance on a host system. For a more comprehensive and\n\
 customizeable tests, see profile_architecture\n\n\
+-b (--bytecode)    lower compiled KaRL to bytecode\n\
 -n (--iterations)  number of iterations      \n\
 -r (--runs)        number of runs            \n\
 -s (--step)        number of iterations      \n\
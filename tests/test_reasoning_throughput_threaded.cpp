@@ -0,0 +1,326 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <thread>
+#include <atomic>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/knowledge/EvalSettings.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Utility.h"
+#include "madara/utility/Timer.h"
+
+namespace logger = madara::logger;
+namespace knowledge = madara::knowledge;
+
+typedef knowledge::KnowledgeRecord::Integer Integer;
+typedef std::chrono::steady_clock Clock;
+
+// command line arguments
+void handle_arguments(int argc, char* argv[]);
+
+// default iterations per thread
+uint32_t num_iterations = 100000;
+uint32_t max_threads = std::thread::hardware_concurrency();
+uint32_t num_keys = 10000;
+
+// every thread waits on this before starting so timings overlap
+std::atomic<uint32_t> ready(0);
+std::atomic<bool> go(false);
+
+/// a workload run by each thread. Returns a value to defeat optimization.
+typedef Integer (*Workload)(knowledge::KnowledgeBase& knowledge,
+    uint32_t thread_id, uint32_t iterations);
+
+std::string key_for(uint32_t index)
+{
+  std::stringstream buffer;
+  buffer << "agent." << index << ".pos";
+  return buffer.str();
+}
+
+/// reads a per-thread key through the string interface
+Integer workload_get(
+    knowledge::KnowledgeBase& knowledge, uint32_t thread_id, uint32_t iterations)
+{
+  Integer result = 0;
+  std::string key = key_for(thread_id % num_keys);
+
+  for (uint32_t i = 0; i < iterations; ++i)
+  {
+    result += knowledge.get(key).to_integer();
+  }
+
+  return result;
+}
+
+/// reads a per-thread key through a variable reference
+Integer workload_get_ref(
+    knowledge::KnowledgeBase& knowledge, uint32_t thread_id, uint32_t iterations)
+{
+  Integer result = 0;
+  knowledge::VariableReference ref =
+      knowledge.get_ref(key_for(thread_id % num_keys));
+
+  for (uint32_t i = 0; i < iterations; ++i)
+  {
+    result += knowledge.get(ref).to_integer();
+  }
+
+  return result;
+}
+
+/// scans the key space with exists checks
+Integer workload_exists(
+    knowledge::KnowledgeBase& knowledge, uint32_t thread_id, uint32_t iterations)
+{
+  Integer result = 0;
+  std::vector<std::string> keys;
+  keys.reserve(64);
+
+  for (uint32_t i = 0; i < 64; ++i)
+  {
+    keys.push_back(key_for((thread_id * 64 + i) % num_keys));
+  }
+
+  for (uint32_t i = 0; i < iterations; ++i)
+  {
+    result += knowledge.exists(keys[i % keys.size()]) ? 1 : 0;
+  }
+
+  return result;
+}
+
+/// 90% reads of shared keys, 10% writes to a per-thread key
+Integer workload_mixed(
+    knowledge::KnowledgeBase& knowledge, uint32_t thread_id, uint32_t iterations)
+{
+  Integer result = 0;
+  knowledge::EvalSettings settings(false, false, false);
+  knowledge::VariableReference read_ref =
+      knowledge.get_ref(key_for(thread_id % num_keys));
+  knowledge::VariableReference write_ref =
+      knowledge.get_ref(".thread." + std::to_string(thread_id));
+
+  for (uint32_t i = 0; i < iterations; ++i)
+  {
+    if (i % 10 == 0)
+    {
+      knowledge.set(write_ref, (Integer)i, settings);
+    }
+    else
+    {
+      result += knowledge.get(read_ref).to_integer();
+    }
+  }
+
+  return result;
+}
+
+/// runs a workload on a number of threads and returns the elapsed ns
+uint64_t run(knowledge::KnowledgeBase& knowledge, Workload workload,
+    uint32_t threads, uint32_t iterations)
+{
+  std::vector<std::thread> workers;
+  std::atomic<Integer> sink(0);
+
+  ready = 0;
+  go = false;
+
+  for (uint32_t t = 0; t < threads; ++t)
+  {
+    workers.emplace_back([&, t]() {
+      ++ready;
+      while (!go)
+      {
+        std::this_thread::yield();
+      }
+      sink += workload(knowledge, t, iterations);
+    });
+  }
+
+  while (ready < threads)
+  {
+    std::this_thread::yield();
+  }
+
+  madara::utility::Timer<Clock> timer;
+  timer.start();
+  go = true;
+
+  for (auto& worker : workers)
+  {
+    worker.join();
+  }
+
+  timer.stop();
+
+  return timer.duration_ns();
+}
+
+int main(int argc, char* argv[])
+{
+  handle_arguments(argc, argv);
+
+  if (max_threads == 0)
+    max_threads = 1;
+
+  if (num_iterations == 0 || num_keys == 0)
+  {
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+        "\nERROR: num_iterations (%d) and num_keys (%d) cannot be 0\n",
+        num_iterations, num_keys);
+
+    exit(-1);
+  }
+
+  knowledge::KnowledgeBase knowledge;
+
+  for (uint32_t i = 0; i < num_keys; ++i)
+  {
+    knowledge.set(key_for(i), (Integer)i);
+  }
+
+  const int num_test_types = 4;
+  Workload workloads[num_test_types] = {
+      workload_get, workload_get_ref, workload_exists, workload_mixed};
+  const char* printouts[num_test_types] = {"Get by name               ",
+      "Get by variable reference ", "Exists checks             ",
+      "90% read / 10% write      "};
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "Testing threaded throughput for MADARA v%s\n"
+      "  keys=%d, iterations per thread=%d, max threads=%d\n",
+      madara::utility::get_version().c_str(), num_keys, num_iterations,
+      max_threads);
+
+  std::vector<uint32_t> thread_counts;
+  for (uint32_t threads = 1; threads < max_threads; threads *= 2)
+  {
+    thread_counts.push_back(threads);
+  }
+  thread_counts.push_back(max_threads);
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "\nAggregate operations per second (speedup over 1 thread):\n");
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "========================================================================"
+      "=\n");
+
+  for (int i = 0; i < num_test_types; ++i)
+  {
+    double baseline = 0;
+
+    for (auto threads : thread_counts)
+    {
+      uint64_t elapsed = run(knowledge, workloads[i], threads, num_iterations);
+
+      if (elapsed == 0)
+        elapsed = 1;
+
+      double ops_per_sec =
+          1000000000.0 * (double)threads * num_iterations / elapsed;
+
+      if (threads == 1)
+        baseline = ops_per_sec;
+
+      std::stringstream buffer;
+
+      std::locale loc("C");
+      buffer.imbue(loc);
+
+      buffer << " " << printouts[i] << " threads=" << std::setw(3) << threads;
+      buffer << "\t" << std::setw(16) << std::fixed << std::setprecision(0)
+             << ops_per_sec << " ops/s";
+      buffer << "  (" << std::setprecision(2)
+             << (baseline > 0 ? ops_per_sec / baseline : 0) << "x)\n";
+
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+          buffer.str().c_str());
+    }
+  }
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "========================================================================"
+      "=\n\n");
+
+  return 0;
+}
+
+void handle_arguments(int argc, char* argv[])
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-f" || arg1 == "--logfile")
+    {
+      if (i + 1 < argc)
+      {
+        logger::global_logger->add_file(argv[i + 1]);
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-k" || arg1 == "--keys")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> num_keys;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-l" || arg1 == "--level")
+    {
+      if (i + 1 < argc)
+      {
+        int level;
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> level;
+        logger::global_logger->set_level(level);
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-n" || arg1 == "--iterations")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> num_iterations;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-t" || arg1 == "--threads")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> max_threads;
+      }
+
+      ++i;
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(),
+          logger::LOG_ALWAYS, "Program Summary for %s:\n\n\
+This stand-alone application measures how knowledge base throughput\n\
+scales as the number of concurrent threads grows from 1 to N. Build\n\
+with the shared_lock feature to allow concurrent readers.\n\n\
+-f (--logfile)     log to a file             \n\
+-k (--keys)        number of keys to prefill \n\
+-l (--level)       logger level              \n\
+-n (--iterations)  iterations per thread     \n\
+-t (--threads)     max number of threads     \n\
+-h (--help)        print this menu           \n\n", argv[0]);
+      exit(0);
+    }
+  }
+}
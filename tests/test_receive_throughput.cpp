@@ -0,0 +1,341 @@
+#include <string>
+#include <iostream>
+#include <vector>
+#include <sstream>
+#include <iomanip>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/transport/Transport.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Timer.h"
+
+#include "test.h"
+
+namespace knowledge = madara::knowledge;
+namespace transport = madara::transport;
+namespace logger = madara::logger;
+namespace utility = madara::utility;
+
+typedef knowledge::KnowledgeRecord::Integer Integer;
+typedef std::chrono::steady_clock Clock;
+
+// command line arguments
+void handle_arguments(int argc, char* argv[]);
+
+uint32_t num_packets = 10000;
+uint32_t records_per_packet = 50;
+
+/// encodes a packet from another agent with records_per_packet updates
+std::vector<char> make_packet(const std::string& domain, uint32_t records,
+    const std::vector<std::string>& keys)
+{
+  std::vector<char> buffer(64000);
+  int64_t buffer_remaining = (int64_t)buffer.size();
+
+  transport::MessageHeader header;
+  header.clock = 10;
+  header.quality = 1;
+  header.ttl = 0;
+  header.updates = records;
+  header.timestamp = utility::get_time();
+  strncpy(header.domain, domain.c_str(), sizeof(header.domain) - 1);
+  strncpy(header.originator, "remote:40000", sizeof(header.originator) - 1);
+
+  char* update = header.write(buffer.data(), buffer_remaining);
+
+  for (uint32_t i = 0; i < records; ++i)
+  {
+    knowledge::KnowledgeRecord record;
+
+    switch (i % 4)
+    {
+      case 0:
+        record.set_value((Integer)i);
+        break;
+      case 1:
+        record.set_value(i * 1.5);
+        break;
+      case 2:
+        record.set_value(std::vector<double>(16, i * 0.5));
+        break;
+      default:
+        record.set_value("payload string for " + keys[i]);
+        break;
+    }
+
+    update = record.write(update, keys[i], buffer_remaining);
+  }
+
+  // fill in the size now that the records are written
+  uint64_t size = buffer.size() - buffer_remaining;
+  header.size = size;
+  int64_t header_remaining = (int64_t)header.encoded_size();
+  header.write(buffer.data(), header_remaining);
+
+  buffer.resize(size);
+  return buffer;
+}
+
+void test_receive(void)
+{
+  knowledge::KnowledgeBase kb;
+  transport::QoSTransportSettings settings;
+  settings.add_read_domain(settings.write_domain);
+  transport::BandwidthMonitor send_monitor, receive_monitor;
+  knowledge::KnowledgeMap rebroadcast_records;
+  transport::ReceiveScratch scratch;
+  transport::MessageHeader* header = 0;
+
+#ifndef _MADARA_NO_KARL_
+  knowledge::CompiledExpression on_data_received;
+#endif  // _MADARA_NO_KARL_
+
+  std::vector<std::string> keys = {"agent.1.pos", "agent.1.speed",
+      "agent.1.path", "agent.1.name", "agent.1.pos"};
+
+  std::vector<char> packet = make_packet(settings.write_domain, 5, keys);
+
+  int result = transport::process_received_update(packet.data(),
+      (uint32_t)packet.size(), "local:40000", kb.get_context(), settings,
+      send_monitor, receive_monitor, rebroadcast_records,
+#ifndef _MADARA_NO_KARL_
+      on_data_received,
+#endif  // _MADARA_NO_KARL_
+      "test_receive", "remote:40000", scratch, header);
+
+  TEST_EQ(result, 5);
+  TEST_NE(header, (transport::MessageHeader*)0);
+  TEST_EQ(header == &scratch.message_header, true);
+  TEST_EQ(std::string(header->originator), "remote:40000");
+
+  // the duplicate key is applied in order, so the last value wins
+  TEST_EQ(kb.get("agent.1.pos").to_integer(), 4);
+  TEST_EQ(kb.get("agent.1.speed").to_double(), 1.5);
+  TEST_EQ(kb.get("agent.1.path").size(), (size_t)16);
+  TEST_EQ(kb.get("agent.1.name").to_string(),
+      "payload string for agent.1.name");
+
+  TEST_EQ(rebroadcast_records.size(), (size_t)4);
+  TEST_EQ(rebroadcast_records["agent.1.pos"].to_integer(), 4);
+
+  // values are shared with the context, not held by the scratch
+  TEST_EQ(scratch.num_updates, (size_t)0);
+
+  // messages from ourselves are rejected
+  packet = make_packet(settings.write_domain, 5, keys);
+  result = transport::process_received_update(packet.data(),
+      (uint32_t)packet.size(), "remote:40000", kb.get_context(), settings,
+      send_monitor, receive_monitor, rebroadcast_records,
+#ifndef _MADARA_NO_KARL_
+      on_data_received,
+#endif  // _MADARA_NO_KARL_
+      "test_receive", "remote:40000", scratch, header);
+
+  TEST_EQ(result, -2);
+
+  // the original interface still hands back a header the caller deletes
+  packet = make_packet(settings.write_domain, 5, keys);
+  header = 0;
+  result = transport::process_received_update(packet.data(),
+      (uint32_t)packet.size(), "local:40000", kb.get_context(), settings,
+      send_monitor, receive_monitor, rebroadcast_records,
+#ifndef _MADARA_NO_KARL_
+      on_data_received,
+#endif  // _MADARA_NO_KARL_
+      "test_receive", "remote:40000", header);
+
+  TEST_EQ(result, 5);
+  TEST_NE(header, (transport::MessageHeader*)0);
+  TEST_EQ(header->updates, (uint32_t)5);
+  delete header;
+}
+
+/// decodes and applies num_packets packets, returning the elapsed ns
+uint64_t benchmark(bool reuse_scratch)
+{
+  knowledge::KnowledgeBase kb;
+  transport::QoSTransportSettings settings;
+  settings.add_read_domain(settings.write_domain);
+  transport::BandwidthMonitor send_monitor, receive_monitor;
+  knowledge::KnowledgeMap rebroadcast_records;
+  transport::ReceiveScratch scratch;
+
+#ifndef _MADARA_NO_KARL_
+  knowledge::CompiledExpression on_data_received;
+#endif  // _MADARA_NO_KARL_
+
+  std::vector<std::string> keys;
+  for (uint32_t i = 0; i < records_per_packet; ++i)
+  {
+    std::stringstream buffer;
+    buffer << "agent." << i % 10 << ".field." << i;
+    keys.push_back(buffer.str());
+  }
+
+  std::vector<char> packet =
+      make_packet(settings.write_domain, records_per_packet, keys);
+  std::vector<char> buffer(packet);
+
+  utility::Timer<Clock> timer;
+  timer.start();
+
+  for (uint32_t i = 0; i < num_packets; ++i)
+  {
+    // decode filters may modify the buffer in place
+    memcpy(buffer.data(), packet.data(), packet.size());
+
+    transport::MessageHeader* header = 0;
+
+    if (reuse_scratch)
+    {
+      transport::process_received_update(buffer.data(),
+          (uint32_t)buffer.size(), "local:40000", kb.get_context(), settings,
+          send_monitor, receive_monitor, rebroadcast_records,
+#ifndef _MADARA_NO_KARL_
+          on_data_received,
+#endif  // _MADARA_NO_KARL_
+          "benchmark", "remote:40000", scratch, header);
+    }
+    else
+    {
+      transport::process_received_update(buffer.data(),
+          (uint32_t)buffer.size(), "local:40000", kb.get_context(), settings,
+          send_monitor, receive_monitor, rebroadcast_records,
+#ifndef _MADARA_NO_KARL_
+          on_data_received,
+#endif  // _MADARA_NO_KARL_
+          "benchmark", "remote:40000", header);
+
+      delete header;
+    }
+  }
+
+  timer.stop();
+
+  TEST_EQ(kb.get(keys[0]).to_integer(), 0);
+
+  return timer.duration_ns();
+}
+
+int main(int argc, char* argv[])
+{
+  handle_arguments(argc, argv);
+
+  test_receive();
+
+  if (num_packets == 0 || records_per_packet == 0)
+  {
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+        "\nERROR: packets (%d) and records (%d) cannot be 0\n", num_packets,
+        records_per_packet);
+
+    exit(-1);
+  }
+
+  uint64_t heap_ns = benchmark(false);
+  uint64_t scratch_ns = benchmark(true);
+
+  if (heap_ns == 0)
+    heap_ns = 1;
+  if (scratch_ns == 0)
+    scratch_ns = 1;
+
+  double records = (double)num_packets * records_per_packet;
+
+  std::stringstream buffer;
+
+  std::locale loc("C");
+  buffer.imbue(loc);
+
+  buffer << std::fixed << std::setprecision(0);
+  buffer << " Per-call header and maps  " << std::setw(16)
+         << (1000000000.0 * records / heap_ns) << " records/s\n";
+  buffer << " Reused receive scratch    " << std::setw(16)
+         << (1000000000.0 * records / scratch_ns) << " records/s";
+  buffer << "  (" << std::setprecision(2) << (double)heap_ns / scratch_ns
+         << "x)\n";
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "\nRecords decoded and applied (%d packets of %d records):\n"
+      "========================================================================"
+      "=\n%s"
+      "========================================================================"
+      "=\n\n",
+      num_packets, records_per_packet, buffer.str().c_str());
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
+
+void handle_arguments(int argc, char* argv[])
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-f" || arg1 == "--logfile")
+    {
+      if (i + 1 < argc)
+      {
+        logger::global_logger->add_file(argv[i + 1]);
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-l" || arg1 == "--level")
+    {
+      if (i + 1 < argc)
+      {
+        int level;
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> level;
+        logger::global_logger->set_level(level);
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-n" || arg1 == "--packets")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> num_packets;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-r" || arg1 == "--records")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> records_per_packet;
+      }
+
+      ++i;
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(),
+          logger::LOG_ALWAYS, "Program Summary for %s:\n\n\
+This stand-alone application checks process_received_update and measures\n\
+how many records per second it decodes and applies to a context, with and\n\
+without a reused ReceiveScratch.\n\n\
+-f (--logfile)     log to a file             \n\
+-l (--level)       logger level              \n\
+-n (--packets)     number of packets to apply\n\
+-r (--records)     records per packet        \n\
+-h (--help)        print this menu           \n\n", argv[0]);
+      exit(0);
+    }
+  }
+}
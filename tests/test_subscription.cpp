@@ -0,0 +1,362 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <thread>
+#include <atomic>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/knowledge/Subscription.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Utility.h"
+#include "madara/utility/Timer.h"
+
+#include "test.h"
+
+namespace knowledge = madara::knowledge;
+namespace logger = madara::logger;
+namespace utility = madara::utility;
+
+typedef knowledge::KnowledgeRecord::Integer Integer;
+
+int num_waiters = 100;
+double hertz = 10000;
+double duration = 1.0;
+
+void handle_arguments(int argc, char** argv)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-d" || arg1 == "--duration")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> duration;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-w" || arg1 == "--waiters")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> num_waiters;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-z" || arg1 == "--hertz")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> hertz;
+      }
+
+      ++i;
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+          "\nProgram summary for %s:\n\n"
+          "  Checks that subscriptions and waits only wake for changes to\n"
+          "  the variables they read, and compares waiters woken by every\n"
+          "  change with waiters woken by their own variables.\n\n"
+          " [-d|--duration seconds]  how long updates are streamed\n"
+          " [-w|--waiters num]       threads waiting on distinct keys\n"
+          " [-z|--hertz hertz]       the rate of updates\n"
+          "\n",
+          argv[0]);
+      exit(0);
+    }
+  }
+}
+
+void test_subscriptions(void)
+{
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "Testing which changes wake a subscription\n");
+
+  knowledge::KnowledgeBase kb;
+
+  knowledge::Subscription keys(kb);
+  keys.add("a");
+  keys.add(kb.get_ref("b"));
+
+  kb.set("c", Integer(1));
+  TEST_EQ(keys.poll(), 0);
+
+  kb.set("a", Integer(1));
+  kb.set("b", Integer(1));
+  TEST_EQ(keys.poll(), 2);
+  TEST_EQ(keys.poll(), 0);
+
+  // only updates that signal changes count
+  knowledge::EvalSettings quiet;
+  quiet.signal_changes = false;
+  kb.set("a", Integer(2), quiet);
+  TEST_EQ(keys.poll(), 0);
+
+  knowledge::Subscription prefix(kb);
+  prefix.add_prefix("agent.1.");
+
+  kb.set("agent.10.x", Integer(1));
+  kb.set("agent.2.x", Integer(1));
+  TEST_EQ(prefix.poll(), 0);
+
+  kb.set("agent.1.x", Integer(1));
+  kb.set("agent.1.y", Integer(1));
+  TEST_EQ(prefix.poll(), 2);
+
+  knowledge::Subscription all(kb);
+  all.add_all();
+
+  kb.set("anything", Integer(1));
+  TEST_EQ(all.poll(), 1);
+
+  // waits with changes return at once, and time out without them
+  kb.set("a", Integer(3));
+  TEST_EQ(keys.wait(1.0), 1);
+
+  utility::Timer<utility::Clock> timer;
+  timer.start();
+  TEST_EQ(keys.wait(0.05), 0);
+  timer.stop();
+  TEST_GE(timer.duration_ds(), 0.05);
+
+  std::thread setter([&kb]() {
+    utility::sleep(0.05);
+    kb.set("b", Integer(2));
+  });
+
+  TEST_EQ(keys.wait(5.0), 1);
+  setter.join();
+}
+
+void test_dependencies(void)
+{
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "Testing subscriptions to the variables of expressions\n");
+
+  knowledge::KnowledgeBase kb;
+
+  knowledge::Subscription reads(kb);
+  reads.add(kb.compile("a > 5 && b[2] == 2 || (c = d)"));
+
+  kb.set("e", Integer(1));
+  kb.set("c", Integer(1));
+  TEST_EQ(reads.poll(), 0);
+
+  kb.set("a", Integer(1));
+  kb.set_index("b", 2, Integer(2));
+  kb.set("d", Integer(1));
+  TEST_EQ(reads.poll(), 3);
+
+  // function calls and expanded names may read any variable
+  knowledge::Subscription expanded(kb);
+  expanded.add(kb.compile("agent{.id}.ready"));
+
+  knowledge::Subscription system(kb);
+  system.add(kb.compile("#get_time () > deadline"));
+
+  kb.set("e", Integer(2));
+  TEST_EQ(expanded.poll(), 1);
+  TEST_EQ(system.poll(), 1);
+}
+
+void test_wait(void)
+{
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "Testing that waits only wake for changes to what they read\n");
+
+  knowledge::KnowledgeBase kb;
+
+  knowledge::WaitSettings settings;
+  settings.poll_frequency = -1;
+  settings.max_wait_time = 5.0;
+
+  std::thread setter([&kb]() {
+    utility::sleep(0.05);
+
+    for (Integer i = 1; i <= 1000; ++i)
+    {
+      kb.set("noise", i);
+    }
+
+    kb.set("ready", Integer(1));
+  });
+
+  // the wait's own increment of .evals does not wake it again
+  TEST_EQ(kb.wait("++.evals && ready", settings).is_true(), true);
+  setter.join();
+
+  TEST_EQ(kb.get(".evals").to_integer(), 2);
+
+  // waits without polling still stop at the max wait time
+  settings.max_wait_time = 0.1;
+
+  utility::Timer<utility::Clock> timer;
+  timer.start();
+  TEST_EQ(kb.wait("never", settings).is_true(), false);
+  timer.stop();
+
+  TEST_GE(timer.duration_ds(), 0.1);
+  TEST_LT(timer.duration_ds(), 2.0);
+}
+
+double cpu_seconds(void)
+{
+#ifndef _WIN32
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+  {
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000000.0;
+  }
+#endif
+
+  return -1;
+}
+
+/// results of streaming updates to many waiters
+struct Result
+{
+  double updates = 0;
+  double evaluations = 0;
+  double cpu = 0;
+};
+
+Result benchmark(bool keyed)
+{
+  knowledge::KnowledgeBase kb;
+  std::atomic<uint64_t> evaluations(0);
+  std::vector<std::thread> waiters;
+  std::vector<knowledge::VariableReference> keys;
+
+  for (int i = 0; i < num_waiters; ++i)
+  {
+    std::stringstream buffer;
+    buffer << "key" << i;
+    std::string key = buffer.str();
+    keys.push_back(kb.get_ref(key));
+
+    waiters.emplace_back([&kb, &evaluations, keyed, key]() {
+      knowledge::CompiledExpression done = kb.compile(key + " < 0");
+      knowledge::Subscription subscription(kb);
+
+      if (keyed)
+        subscription.add(done);
+      else
+        subscription.add_all();
+
+      while (!kb.evaluate(done).is_true())
+      {
+        ++evaluations;
+        subscription.wait();
+      }
+    });
+  }
+
+  // let every waiter subscribe
+  utility::sleep(0.2);
+
+  double cpu = cpu_seconds();
+  uint64_t evaluated = evaluations.load();
+
+  utility::Duration period = utility::seconds_to_duration(1.0 / hertz);
+  utility::TimeValue start = utility::get_time_value();
+  utility::TimeValue end = utility::add_seconds(start, duration);
+  utility::TimeValue next = start;
+  uint64_t updates = 0;
+
+  for (; next < end; next += period, ++updates)
+  {
+    std::this_thread::sleep_until(next);
+    kb.set(keys[updates % keys.size()], (Integer)updates);
+  }
+
+  double elapsed =
+      utility::SecondsDuration(utility::get_time_value() - start).count();
+
+  Result result;
+  result.updates = updates / elapsed;
+  result.evaluations = (double)(evaluations.load() - evaluated) / updates;
+  result.cpu = cpu_seconds() - cpu;
+
+  for (auto& key : keys)
+  {
+    kb.set(key, Integer(-1));
+  }
+
+  for (std::thread& waiter : waiters)
+  {
+    waiter.join();
+  }
+
+  return result;
+}
+
+std::string format_result(const std::string& name, const Result& result)
+{
+  std::stringstream buffer;
+
+  buffer << " " << std::left << std::setw(14) << name << std::right
+         << std::fixed << std::setprecision(0) << std::setw(12)
+         << result.updates << std::setprecision(2) << std::setw(14)
+         << result.evaluations << std::setw(12) << result.cpu << "\n";
+
+  return buffer.str();
+}
+
+int main(int argc, char** argv)
+{
+  handle_arguments(argc, argv);
+
+#ifndef _MADARA_NO_KARL_
+  test_subscriptions();
+  test_dependencies();
+  test_wait();
+
+  Result all = benchmark(false);
+  Result keyed = benchmark(true);
+
+  // each update is read by one waiter
+  TEST_LE(keyed.evaluations, 1.0);
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "\n%d waiters on distinct keys, %.0f updates/s for %.1f s:\n"
+      "========================================================================"
+      "=\n"
+      " Woken by        Updates/s  Evals/update     CPU (s)\n"
+      "%s%s"
+      "========================================================================"
+      "=\n\n",
+      num_waiters, hertz, duration,
+      format_result("any change", all).c_str(),
+      format_result("own key", keyed).c_str());
+#else
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "This test is disabled due to karl feature being disabled.\n");
+#endif
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
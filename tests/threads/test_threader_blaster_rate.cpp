@@ -0,0 +1,261 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <atomic>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/logger/GlobalLogger.h"
+
+#include "madara/threads/Threader.h"
+#include "madara/utility/Utility.h"
+#include "madara/utility/Timer.h"
+
+#include "../test.h"
+
+// shortcuts
+namespace knowledge = madara::knowledge;
+namespace utility = madara::utility;
+namespace threads = madara::threads;
+namespace logger = madara::logger;
+
+typedef madara::knowledge::KnowledgeRecord::Integer Integer;
+
+double duration(1.0);
+int max_threads(32);
+
+// handle command line arguments
+void handle_arguments(int argc, char** argv)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-d" || arg1 == "--duration")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> duration;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-l" || arg1 == "--level")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        int level;
+        buffer >> level;
+        logger::global_logger->set_level(level);
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-t" || arg1 == "--threads")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> max_threads;
+      }
+
+      ++i;
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+          "\nProgram summary for %s:\n\n"
+          "  Checks that pause, resume, hertz changes and termination reach\n"
+          "  running threads, and measures the loop rate of 1 up to the\n"
+          "  maximum number of threads running at infinite hertz.\n\n"
+          " [-d|--duration seconds]  how long each benchmark runs\n"
+          " [-l|--level level]       the logger level (0+, higher is higher "
+          "detail)\n"
+          " [-t|--threads threads]   the maximum number of threads\n"
+          "\n",
+          argv[0]);
+      exit(0);
+    }
+  }
+}
+
+/**
+ * Counts its executions, optionally terminating itself
+ **/
+class LoopThread : public threads::BaseThread
+{
+public:
+  LoopThread(std::atomic<uint64_t>& count, uint64_t stop_at = 0)
+    : count_(count), stop_at_(stop_at)
+  {
+  }
+
+  /**
+   * Executes the main thread logic
+   **/
+  virtual void run(void)
+  {
+    uint64_t count = count_.fetch_add(1, std::memory_order_relaxed) + 1;
+
+    if (count == stop_at_)
+    {
+      this->terminated = 1;
+    }
+  }
+
+private:
+  std::atomic<uint64_t>& count_;
+  uint64_t stop_at_;
+};
+
+void test_control(void)
+{
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "Testing pause, resume, change_hertz and terminate\n");
+
+  knowledge::KnowledgeBase kb;
+  threads::Threader threader(kb);
+  knowledge::KnowledgeBase control = threader.get_control_plane();
+
+  std::atomic<uint64_t> count(0);
+
+  threader.run(0.0, "blaster", new LoopThread(count), true);
+
+  utility::sleep(0.1);
+  TEST_EQ(count.load(), 0);
+
+  threader.resume("blaster");
+  utility::sleep(0.1);
+  TEST_GT(count.load(), 0);
+
+  // requests are mirrored into the control plane for observers
+  threader.pause("blaster");
+  TEST_EQ(control.get("blaster.paused").to_integer(), 1);
+
+  // an execution may have been underway
+  utility::sleep(0.05);
+  uint64_t paused_count = count.load();
+  utility::sleep(0.1);
+  TEST_EQ(count.load(), paused_count);
+
+  threader.change_hertz("blaster", 20);
+  TEST_EQ(control.get("blaster.hertz").to_double(), 20.0);
+  threader.resume("blaster");
+
+  utility::sleep(0.5);
+  TEST_LE(count.load() - paused_count, 15);
+
+  // writes straight to the control plane are picked up as well
+  control.set("blaster.paused", Integer(1));
+  utility::sleep(0.2);
+  paused_count = count.load();
+  utility::sleep(0.2);
+  TEST_EQ(count.load(), paused_count);
+  control.set("blaster.paused", Integer(0));
+
+  utility::Timer<utility::Clock> timer;
+  timer.start();
+
+  threader.terminate("blaster");
+  TEST_EQ(control.get("blaster.terminated").to_integer(), 1);
+
+  knowledge::WaitSettings ws;
+  ws.max_wait_time = 5.0;
+  TEST_EQ(threader.wait("blaster", ws), true);
+
+  timer.stop();
+  TEST_LT(timer.duration_ds(), 0.2);
+
+  // a thread may terminate itself through its control plane flag
+  count = 0;
+  threader.run(0.0, "self", new LoopThread(count, 1000));
+
+  TEST_EQ(threader.wait("self", ws), true);
+  TEST_GE(count.load(), 1000);
+}
+
+/// runs threads at infinite hertz and returns their total loop rate
+double benchmark(int num_threads, bool debug)
+{
+  knowledge::KnowledgeBase kb;
+  threads::Threader threader(kb);
+
+  if (debug)
+    threader.enable_debug();
+
+  std::atomic<uint64_t> count(0);
+
+  for (int i = 0; i < num_threads; ++i)
+  {
+    std::stringstream buffer;
+    buffer << "blaster";
+    buffer << i;
+
+    threader.run(0.0, buffer.str(), new LoopThread(count), true);
+  }
+
+  utility::Timer<utility::Clock> timer;
+  timer.start();
+
+  threader.resume();
+  utility::sleep(duration);
+  threader.pause();
+
+  timer.stop();
+
+  uint64_t loops = count.load();
+
+  threader.terminate();
+  threader.wait();
+
+  return loops / timer.duration_ds();
+}
+
+int main(int argc, char** argv)
+{
+  // handle all user arguments
+  handle_arguments(argc, argv);
+
+  test_control();
+
+  std::stringstream results;
+
+  results << std::fixed << std::setprecision(0);
+
+  for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2)
+  {
+    double rate = benchmark(num_threads, false);
+    double debug_rate = benchmark(num_threads, true);
+
+    TEST_GT(rate, 0.0);
+
+    results << " " << std::setw(7) << num_threads << std::setw(16) << rate
+            << std::setw(16) << rate / num_threads << std::setw(16)
+            << debug_rate << "\n";
+  }
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "\nLoop rates of threads at infinite hertz (loops/s):\n"
+      "========================================================================"
+      "=\n"
+      " Threads           Total      Per thread   Total (debug)\n"
+      "%s"
+      "========================================================================"
+      "=\n\n",
+      results.str().c_str());
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
@@ -0,0 +1,374 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <atomic>
+#include <cmath>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/logger/GlobalLogger.h"
+
+#include "madara/threads/Threader.h"
+#include "madara/utility/Utility.h"
+#include "madara/utility/Timer.h"
+
+#include "../test.h"
+
+// shortcuts
+namespace knowledge = madara::knowledge;
+namespace utility = madara::utility;
+namespace threads = madara::threads;
+namespace logger = madara::logger;
+
+typedef madara::knowledge::KnowledgeRecord::Integer Integer;
+
+double duration(2.0);
+double hertz(100.0);
+int num_tasks(200);
+int pool_size(0);
+
+// handle command line arguments
+void handle_arguments(int argc, char** argv)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-d" || arg1 == "--duration")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> duration;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-l" || arg1 == "--level")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        int level;
+        buffer >> level;
+        logger::global_logger->set_level(level);
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-p" || arg1 == "--pool")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> pool_size;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-t" || arg1 == "--tasks")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> num_tasks;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-z" || arg1 == "--hertz")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> hertz;
+      }
+
+      ++i;
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+          "\nProgram summary for %s:\n\n"
+          "  Checks that pooled threads can be paused, resumed, changed\n"
+          "  and terminated, and compares context switches and jitter of\n"
+          "  many periodic threads on a pool and on one OS thread each.\n\n"
+          " [-d|--duration seconds]  how long each benchmark runs\n"
+          " [-l|--level level]       the logger level (0+, higher is higher "
+          "detail)\n"
+          " [-p|--pool threads]      pool threads (0 for one per core)\n"
+          " [-t|--tasks tasks]       periodic threads in the benchmark\n"
+          " [-z|--hertz hertz]       hertz rate of the benchmark threads\n"
+          "\n",
+          argv[0]);
+      exit(0);
+    }
+  }
+}
+
+/// execution statistics that outlive the thread
+struct Stats
+{
+  std::atomic<uint64_t> count{0};
+  utility::TimeValue last;
+  double total_error = 0;
+  double max_error = 0;
+  uint64_t intervals = 0;
+};
+
+/**
+ * Counts its executions and how far apart they are from its period,
+ * optionally terminating itself
+ **/
+class TaskThread : public threads::BaseThread
+{
+public:
+  TaskThread(Stats& stats, double period = 0, uint64_t stop_at = 0)
+    : stats_(stats), period_(period), stop_at_(stop_at)
+  {
+  }
+
+  /**
+   * Executes the main thread logic
+   **/
+  virtual void run(void)
+  {
+    utility::TimeValue now = utility::get_time_value();
+    uint64_t count = stats_.count.load(std::memory_order_relaxed) + 1;
+
+    if (period_ > 0 && count > 1)
+    {
+      double error = std::fabs(
+          utility::SecondsDuration(now - stats_.last).count() - period_);
+
+      stats_.total_error += error;
+      ++stats_.intervals;
+
+      if (error > stats_.max_error)
+        stats_.max_error = error;
+    }
+
+    stats_.last = now;
+    stats_.count.store(count, std::memory_order_relaxed);
+
+    if (count == stop_at_)
+    {
+      this->terminated = 1;
+    }
+  }
+
+private:
+  Stats& stats_;
+  double period_;
+  uint64_t stop_at_;
+};
+
+void test_pool_control(void)
+{
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "Testing pause, resume, change_hertz and terminate on a pool\n");
+
+  knowledge::KnowledgeBase kb;
+  threads::Threader threader(kb);
+  threader.use_pool(2);
+
+  knowledge::WaitSettings ws;
+  ws.max_wait_time = 5.0;
+
+  // run once threads finish on their own
+  Stats once;
+  threader.run("once", new TaskThread(once));
+  TEST_EQ(threader.wait("once", ws), true);
+  TEST_EQ(once.count.load(), 1);
+
+  Stats blaster, periodic;
+  threader.run(0.0, "blaster", new TaskThread(blaster), true);
+  threader.run(20.0, "periodic", new TaskThread(periodic), true);
+
+  utility::sleep(0.1);
+  TEST_EQ(blaster.count.load(), 0);
+  TEST_EQ(periodic.count.load(), 0);
+
+  threader.resume();
+  utility::sleep(0.5);
+  TEST_GT(blaster.count.load(), 100);
+  TEST_GE(periodic.count.load(), 8);
+  TEST_LE(periodic.count.load(), 12);
+
+  threader.pause("blaster");
+  utility::sleep(0.05);
+  uint64_t paused_count = blaster.count.load();
+  utility::sleep(0.1);
+  TEST_EQ(blaster.count.load(), paused_count);
+
+  // the periodic thread keeps its own schedule meanwhile
+  TEST_GE(periodic.count.load(), 10);
+
+  threader.change_hertz("blaster", 50);
+  threader.resume("blaster");
+  utility::sleep(0.5);
+  TEST_LE(blaster.count.load() - paused_count, 30);
+
+  threader.change_hertz("periodic", 0);
+  utility::sleep(0.2);
+  TEST_GT(periodic.count.load(), 1000);
+
+  threader.terminate();
+  TEST_EQ(threader.wait(ws), true);
+
+  // a thread may terminate itself through its control plane flag
+  Stats self;
+  threader.run(0.0, "self", new TaskThread(self, 0, 1000));
+  TEST_EQ(threader.wait("self", ws), true);
+  TEST_GE(self.count.load(), 1000);
+}
+
+/// results of running many periodic threads
+struct Result
+{
+  int os_threads = 0;
+  long context_switches = -1;
+  double executions = 0;
+  double mean_error_us = 0;
+  double max_error_us = 0;
+};
+
+long count_context_switches(void)
+{
+#ifndef _WIN32
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+    return usage.ru_nvcsw + usage.ru_nivcsw;
+#endif
+
+  return -1;
+}
+
+Result benchmark(bool pooled)
+{
+  Result result;
+
+  knowledge::KnowledgeBase kb;
+  threads::Threader threader(kb);
+
+  if (pooled)
+  {
+    threader.use_pool(pool_size);
+    result.os_threads = pool_size > 0 ? pool_size :
+        (int)std::thread::hardware_concurrency();
+
+    // the timer thread
+    ++result.os_threads;
+  }
+  else
+  {
+    result.os_threads = num_tasks;
+  }
+
+  std::vector<Stats> stats(num_tasks);
+
+  for (int i = 0; i < num_tasks; ++i)
+  {
+    std::stringstream buffer;
+    buffer << "task";
+    buffer << i;
+
+    threader.run(
+        hertz, buffer.str(), new TaskThread(stats[i], 1.0 / hertz), true);
+  }
+
+  // let every thread settle before measuring
+  utility::sleep(0.1);
+
+  long switches = count_context_switches();
+
+  threader.resume();
+  utility::sleep(duration);
+  threader.pause();
+
+  long after = count_context_switches();
+
+  threader.terminate();
+  threader.wait();
+
+  if (switches >= 0 && after >= 0)
+    result.context_switches = after - switches;
+
+  uint64_t executions = 0, intervals = 0;
+  double total_error = 0;
+
+  for (const Stats& stat : stats)
+  {
+    executions += stat.count.load();
+    intervals += stat.intervals;
+    total_error += stat.total_error;
+
+    if (stat.max_error > result.max_error_us)
+      result.max_error_us = stat.max_error;
+  }
+
+  result.executions = (double)executions / (num_tasks * hertz * duration);
+
+  if (intervals > 0)
+    result.mean_error_us = total_error / intervals * 1000000;
+  result.max_error_us *= 1000000;
+
+  return result;
+}
+
+std::string format_result(const std::string& name, const Result& result)
+{
+  std::stringstream buffer;
+
+  buffer << " " << std::left << std::setw(12) << name << std::right
+         << std::setw(8) << result.os_threads << std::setw(12)
+         << result.context_switches << std::fixed << std::setprecision(1)
+         << std::setw(10) << result.executions * 100 << "%" << std::setw(12)
+         << result.mean_error_us << std::setw(12) << result.max_error_us
+         << "\n";
+
+  return buffer.str();
+}
+
+int main(int argc, char** argv)
+{
+  // handle all user arguments
+  handle_arguments(argc, argv);
+
+  test_pool_control();
+
+  Result threaded = benchmark(false);
+  Result pooled = benchmark(true);
+
+  // a loaded host may miss epochs, but most should run
+  TEST_GT(pooled.executions, 0.5);
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "\n%d threads at %.0f hz for %.1f s:\n"
+      "========================================================================"
+      "=\n"
+      " Model       Threads    Switches  Executed  Jitter (us)  Max (us)\n"
+      "%s%s"
+      "========================================================================"
+      "=\n\n",
+      num_tasks, hertz, duration,
+      format_result("own thread", threaded).c_str(),
+      format_result("pool", pooled).c_str());
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
@@ -0,0 +1,380 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <thread>
+#include <atomic>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Utility.h"
+#include "madara/utility/Timer.h"
+
+#include "../../test.h"
+
+namespace knowledge = madara::knowledge;
+namespace transport = madara::transport;
+namespace logger = madara::logger;
+namespace utility = madara::utility;
+
+typedef knowledge::KnowledgeRecord::Integer Integer;
+typedef std::chrono::steady_clock Clock;
+
+const std::string ring_a("/madara_test_shmem_a");
+const std::string ring_b("/madara_test_shmem_b");
+const std::string multicast_group("239.255.0.1:43140");
+
+size_t payload_size = 2000000;
+size_t num_updates = 20000;
+size_t num_pings = 2000;
+
+void handle_arguments(int argc, char** argv)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-l" || arg1 == "--level")
+    {
+      if (i + 1 < argc)
+      {
+        int level;
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> level;
+        logger::global_logger->set_level(level);
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-n" || arg1 == "--updates")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> num_updates;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-p" || arg1 == "--pings")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> num_pings;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-s" || arg1 == "--size")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> payload_size;
+      }
+
+      ++i;
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+          "\nProgram summary for %s:\n\n"
+          "  Checks that shared memory transports deliver large payloads\n"
+          "  and bursts, find rings that are created late or recreated,\n"
+          "  and compares round trip latency and throughput with\n"
+          "  multicast over loopback.\n\n"
+          " [-l|--level level]       the logger level (0+, higher is "
+          "higher detail)\n"
+          " [-n|--updates num]       updates in the burst\n"
+          " [-p|--pings num]         round trips for the latency benchmark\n"
+          " [-s|--size bytes]        size of the large payload\n"
+          "\n",
+          argv[0]);
+      exit(0);
+    }
+  }
+}
+
+transport::QoSTransportSettings make_settings(
+    const std::string& self, const std::string& other)
+{
+  transport::QoSTransportSettings settings;
+  settings.type = transport::SHMEM;
+  settings.queue_length = (uint32_t)(payload_size * 4 + 1000000);
+  settings.hosts.push_back(self);
+  settings.hosts.push_back(other);
+
+  return settings;
+}
+
+/// waits up to max_wait seconds for a variable to reach a value
+bool wait_for(knowledge::KnowledgeBase& kb, const std::string& key,
+    Integer value, double max_wait)
+{
+  utility::Timer<Clock> timer;
+  timer.start();
+
+  while (kb.get(key).to_integer() < value)
+  {
+    timer.stop();
+    if (timer.duration_ds() > max_wait)
+      return false;
+
+    std::this_thread::yield();
+  }
+
+  return true;
+}
+
+void test_delivery(void)
+{
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "Testing a %d byte payload and a burst of %d updates\n",
+      (int)payload_size, (int)num_updates);
+
+  transport::QoSTransportSettings settings = make_settings(ring_b, ring_a);
+  settings.debug_to_kb_prefix = "receive";
+  knowledge::KnowledgeBase receiver("", settings);
+
+  settings = make_settings(ring_a, ring_b);
+  settings.debug_to_kb_prefix = "send";
+  knowledge::KnowledgeBase sender("", settings);
+
+  // the reader opens the ring within a wait period of it being created
+  utility::sleep(0.3);
+
+  std::vector<double> image(payload_size / sizeof(double), 1.5);
+  image.back() = 42;
+
+  sender.set("image", image, knowledge::EvalSettings::DELAY);
+  sender.set("counter", Integer(1), knowledge::EvalSettings::SEND);
+
+  TEST_EQ(wait_for(receiver, "counter", 1, 5.0), true);
+
+  knowledge::KnowledgeRecord received = receiver.get("image");
+  TEST_EQ(received.size(), image.size());
+  TEST_EQ(received.retrieve_index(image.size() - 1).to_double(), 42.0);
+
+  for (size_t i = 2; i <= num_updates + 1; ++i)
+  {
+    sender.set("counter", (Integer)i, knowledge::EvalSettings::SEND);
+  }
+
+  TEST_EQ(
+      wait_for(receiver, "counter", (Integer)num_updates + 1, 10.0), true);
+
+  // the ring holds the whole burst, so nothing is overwritten
+  TEST_EQ(receiver.get("receive.received_packets").to_integer(),
+      (Integer)num_updates + 1);
+  TEST_EQ(receiver.get("receive.failed_receives").to_integer(), 0);
+  TEST_EQ(sender.get("send.failed_sends").to_integer(), 0);
+}
+
+void test_writer_restart(void)
+{
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "Testing a writer that restarts\n");
+
+  transport::QoSTransportSettings settings = make_settings(ring_b, ring_a);
+  knowledge::KnowledgeBase receiver("", settings);
+
+  for (Integer round = 1; round <= 2; ++round)
+  {
+    settings = make_settings(ring_a, ring_b);
+    knowledge::KnowledgeBase sender("", settings);
+
+    // the reader retries closed and missing rings every wait period
+    utility::sleep(0.5);
+
+    sender.set("round", round, knowledge::EvalSettings::SEND);
+
+    TEST_EQ(wait_for(receiver, "round", round, 5.0), true);
+  }
+}
+
+/// round trip latency and throughput between two transports
+struct Result
+{
+  bool available = false;
+  double latency_us = 0;
+  double updates_per_second = 0;
+  Integer received = 0;
+};
+
+Result benchmark(knowledge::KnowledgeBase& a, knowledge::KnowledgeBase& b)
+{
+  Result result;
+
+  std::atomic<bool> done(false);
+
+  // answers every ping, like a co-located agent would
+  std::thread responder([&b, &done]() {
+    Integer last = 0;
+    while (!done)
+    {
+      Integer ping = b.get("ping").to_integer();
+      if (ping > last)
+      {
+        last = ping;
+        b.set("pong", ping, knowledge::EvalSettings::SEND);
+      }
+      else
+      {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  // the first round trip also waits for both transports to be ready
+  utility::Timer<Clock> timer;
+  timer.start();
+
+  a.set("ping", Integer(1), knowledge::EvalSettings::SEND);
+
+  while (!wait_for(a, "pong", 1, 0.1))
+  {
+    timer.stop();
+    if (timer.duration_ds() > 3.0)
+      break;
+
+    a.set("ping", Integer(1), knowledge::EvalSettings::SEND);
+  }
+
+  result.available = a.get("pong").to_integer() >= 1;
+
+  if (result.available)
+  {
+    size_t completed = 0;
+    timer.start();
+
+    for (size_t i = 2; i <= num_pings + 1; ++i)
+    {
+      a.set("ping", (Integer)i, knowledge::EvalSettings::SEND);
+      if (wait_for(a, "pong", (Integer)i, 0.5))
+        ++completed;
+    }
+
+    timer.stop();
+
+    if (completed > 0)
+      result.latency_us = timer.duration_ns() / 1000.0 / completed;
+
+    Integer before = b.get("b.received_packets").to_integer();
+    timer.start();
+
+    for (size_t i = 1; i <= num_updates; ++i)
+    {
+      a.set("counter", (Integer)i, knowledge::EvalSettings::SEND);
+    }
+
+    wait_for(b, "counter", (Integer)num_updates, 5.0);
+    timer.stop();
+
+    result.received = b.get("b.received_packets").to_integer() - before;
+
+    uint64_t elapsed_ns = timer.duration_ns();
+    if (elapsed_ns == 0)
+      elapsed_ns = 1;
+
+    result.updates_per_second = 1000000000.0 * result.received / elapsed_ns;
+  }
+
+  done = true;
+  responder.join();
+
+  return result;
+}
+
+Result benchmark_shmem(void)
+{
+  transport::QoSTransportSettings settings = make_settings(ring_b, ring_a);
+  settings.debug_to_kb_prefix = "b";
+  knowledge::KnowledgeBase b("", settings);
+
+  settings = make_settings(ring_a, ring_b);
+  knowledge::KnowledgeBase a("", settings);
+
+  return benchmark(a, b);
+}
+
+Result benchmark_multicast(void)
+{
+  transport::QoSTransportSettings settings;
+  settings.type = transport::MULTICAST;
+  settings.hosts.push_back(multicast_group);
+  settings.queue_length = (uint32_t)(payload_size * 4 + 1000000);
+
+  transport::QoSTransportSettings b_settings(settings);
+  b_settings.debug_to_kb_prefix = "b";
+  knowledge::KnowledgeBase b("", b_settings);
+  knowledge::KnowledgeBase a("", settings);
+
+  return benchmark(a, b);
+}
+
+std::string format_result(const std::string& name, const Result& result)
+{
+  std::stringstream buffer;
+
+  buffer << " " << std::left << std::setw(10) << name << std::right;
+
+  if (!result.available)
+  {
+    buffer << " unavailable\n";
+    return buffer.str();
+  }
+
+  buffer << std::fixed << std::setprecision(1) << std::setw(9)
+         << result.latency_us << " us round trip " << std::setprecision(0)
+         << std::setw(10) << result.updates_per_second << " updates/s ("
+         << result.received << "/" << num_updates << " received)\n";
+
+  return buffer.str();
+}
+
+int main(int argc, char** argv)
+{
+  handle_arguments(argc, argv);
+
+  if (num_updates == 0 || num_pings == 0 || payload_size < sizeof(double))
+  {
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+        "\nERROR: updates and pings cannot be 0 and size must hold a "
+        "double\n");
+
+    exit(-1);
+  }
+
+  test_delivery();
+  test_writer_restart();
+
+  Result shmem = benchmark_shmem();
+  TEST_EQ(shmem.available, true);
+  TEST_EQ(shmem.received, (Integer)num_updates);
+
+  Result multicast = benchmark_multicast();
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "\nSame host transports (%d round trips, %d updates):\n"
+      "========================================================================"
+      "=\n%s%s"
+      "========================================================================"
+      "=\n\n",
+      (int)num_pings, (int)num_updates,
+      format_result("shmem", shmem).c_str(),
+      format_result("multicast", multicast).c_str());
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
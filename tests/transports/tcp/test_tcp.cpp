@@ -0,0 +1,248 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Utility.h"
+#include "madara/utility/Timer.h"
+
+#include "../../test.h"
+
+namespace knowledge = madara::knowledge;
+namespace transport = madara::transport;
+namespace logger = madara::logger;
+namespace utility = madara::utility;
+
+typedef knowledge::KnowledgeRecord::Integer Integer;
+typedef std::chrono::steady_clock Clock;
+
+const std::string sender_host("127.0.0.1:43130");
+const std::string receiver_host("127.0.0.1:43131");
+
+size_t payload_size = 2000000;
+size_t num_updates = 20000;
+
+void handle_arguments(int argc, char** argv)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-l" || arg1 == "--level")
+    {
+      if (i + 1 < argc)
+      {
+        int level;
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> level;
+        logger::global_logger->set_level(level);
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-n" || arg1 == "--updates")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> num_updates;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-s" || arg1 == "--size")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> payload_size;
+      }
+
+      ++i;
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+          "\nProgram summary for %s:\n\n"
+          "  Checks that TCP transports deliver large payloads without\n"
+          "  fragmentation, deliver every update of a burst, and deliver\n"
+          "  updates to a peer that starts late. Reports updates per\n"
+          "  second over loopback.\n\n"
+          " [-l|--level level]       the logger level (0+, higher is "
+          "higher detail)\n"
+          " [-n|--updates num]       updates in the burst\n"
+          " [-s|--size bytes]        size of the large payload\n"
+          "\n",
+          argv[0]);
+      exit(0);
+    }
+  }
+}
+
+transport::QoSTransportSettings make_settings(const std::string& self)
+{
+  transport::QoSTransportSettings settings;
+  settings.type = transport::TCP;
+  settings.queue_length = (uint32_t)(payload_size * 2 + 1000000);
+  settings.hosts.push_back(self);
+
+  return settings;
+}
+
+/// waits up to max_wait seconds for a variable to reach a value
+bool wait_for(knowledge::KnowledgeBase& kb, const std::string& key,
+    Integer value, double max_wait)
+{
+  utility::Timer<Clock> timer;
+  timer.start();
+
+  while (kb.get(key).to_integer() < value)
+  {
+    timer.stop();
+    if (timer.duration_ds() > max_wait)
+      return false;
+
+    utility::sleep(0.0001);
+  }
+
+  return true;
+}
+
+void test_large_payload(void)
+{
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "Testing a %d byte payload\n", (int)payload_size);
+
+  transport::QoSTransportSettings settings = make_settings(receiver_host);
+  knowledge::KnowledgeBase receiver("", settings);
+
+  settings = make_settings(sender_host);
+  settings.hosts.push_back(receiver_host);
+  knowledge::KnowledgeBase sender("", settings);
+
+  std::vector<double> image(payload_size / sizeof(double), 1.5);
+  image.back() = 42;
+
+  sender.set("image", image, knowledge::EvalSettings::DELAY);
+  sender.set("counter", Integer(1), knowledge::EvalSettings::SEND);
+
+  TEST_EQ(wait_for(receiver, "counter", 1, 5.0), true);
+
+  knowledge::KnowledgeRecord received = receiver.get("image");
+  TEST_EQ(received.size(), image.size());
+  TEST_EQ(received.retrieve_index(image.size() - 1).to_double(), 42.0);
+}
+
+void test_burst(double& updates_per_second, Integer& writes)
+{
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "Testing a burst of %d updates\n", (int)num_updates);
+
+  transport::QoSTransportSettings settings = make_settings(receiver_host);
+  settings.debug_to_kb_prefix = "receive";
+  knowledge::KnowledgeBase receiver("", settings);
+
+  settings = make_settings(sender_host);
+  settings.no_receiving = true;
+  settings.debug_to_kb_prefix = "send";
+  settings.hosts.push_back(receiver_host);
+  knowledge::KnowledgeBase sender("", settings);
+
+  // let the connection come up, so the burst is not queued behind it
+  sender.set("ready", Integer(1), knowledge::EvalSettings::SEND);
+  TEST_EQ(wait_for(receiver, "receive.received_packets", 1, 5.0), true);
+
+  utility::Timer<Clock> timer;
+  timer.start();
+
+  for (size_t i = 1; i <= num_updates; ++i)
+  {
+    sender.set("counter", (Integer)i, knowledge::EvalSettings::SEND);
+  }
+
+  TEST_EQ(wait_for(receiver, "counter", (Integer)num_updates, 10.0), true);
+
+  timer.stop();
+
+  // a stream never loses a message
+  TEST_EQ(receiver.get("receive.received_packets").to_integer(),
+      (Integer)num_updates + 1);
+  TEST_EQ(sender.get("send.failed_sends").to_integer(), 0);
+
+  uint64_t elapsed_ns = timer.duration_ns();
+  if (elapsed_ns == 0)
+    elapsed_ns = 1;
+
+  updates_per_second = 1000000000.0 * num_updates / elapsed_ns;
+  writes = sender.get("send.sent_packets").to_integer();
+}
+
+void test_late_peer(void)
+{
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "Testing a peer that starts after the sender\n");
+
+  transport::QoSTransportSettings settings = make_settings(sender_host);
+  settings.no_receiving = true;
+  settings.hosts.push_back(receiver_host);
+  knowledge::KnowledgeBase sender("", settings);
+
+  sender.set("counter", Integer(7), knowledge::EvalSettings::SEND);
+
+  utility::sleep(0.2);
+
+  // the sender keeps retrying, and writes what it queued once connected
+  settings = make_settings(receiver_host);
+  knowledge::KnowledgeBase receiver("", settings);
+
+  TEST_EQ(wait_for(receiver, "counter", 7, 5.0), true);
+}
+
+int main(int argc, char** argv)
+{
+  handle_arguments(argc, argv);
+
+  if (num_updates == 0 || payload_size < sizeof(double))
+  {
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+        "\nERROR: updates cannot be 0 and size must hold a double\n");
+
+    exit(-1);
+  }
+
+  test_large_payload();
+
+  double updates_per_second;
+  Integer writes;
+  test_burst(updates_per_second, writes);
+
+  test_late_peer();
+
+  std::stringstream buffer;
+  buffer << std::fixed << std::setprecision(0);
+  buffer << " burst    " << std::setw(10) << updates_per_second
+         << " updates/s in " << writes << " writes\n";
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "\nLoopback TCP (%d updates):\n"
+      "========================================================================"
+      "=\n%s"
+      "========================================================================"
+      "=\n\n",
+      (int)num_updates, buffer.str().c_str());
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
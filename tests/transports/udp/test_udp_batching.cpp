@@ -0,0 +1,341 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <ctime>
+
+#include "madara/knowledge/KnowledgeBase.h"
+#include "madara/logger/GlobalLogger.h"
+#include "madara/utility/Utility.h"
+#include "madara/utility/Timer.h"
+
+#include "../../test.h"
+
+namespace knowledge = madara::knowledge;
+namespace transport = madara::transport;
+namespace logger = madara::logger;
+namespace utility = madara::utility;
+
+typedef knowledge::KnowledgeRecord::Integer Integer;
+typedef std::chrono::steady_clock Clock;
+
+const std::string sender_host("127.0.0.1:43120");
+const std::string receiver_host("127.0.0.1:43121");
+
+// nothing listens here, so the kernel discards what we send
+const std::string sink_host("127.0.0.1:43129");
+
+size_t num_peers = 40;
+size_t payload_size = 200000;
+size_t num_sends = 100;
+size_t num_bursts = 200;
+
+void handle_arguments(int argc, char** argv)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg1(argv[i]);
+
+    if (arg1 == "-b" || arg1 == "--bursts")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> num_bursts;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-l" || arg1 == "--level")
+    {
+      if (i + 1 < argc)
+      {
+        int level;
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> level;
+        logger::global_logger->set_level(level);
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-n" || arg1 == "--sends")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> num_sends;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-p" || arg1 == "--peers")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> num_peers;
+      }
+
+      ++i;
+    }
+    else if (arg1 == "-s" || arg1 == "--size")
+    {
+      if (i + 1 < argc)
+      {
+        std::stringstream buffer(argv[i + 1]);
+        buffer >> payload_size;
+      }
+
+      ++i;
+    }
+    else
+    {
+      madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+          "\nProgram summary for %s:\n\n"
+          "  Checks that UDP transports deliver fragmented and small updates\n"
+          "  with and without batched datagrams (sendmmsg/recvmmsg), and\n"
+          "  measures datagrams per second and CPU per datagram over\n"
+          "  loopback for both.\n\n"
+          " [-b|--bursts num]        bursts for the receive benchmark\n"
+          " [-l|--level level]       the logger level (0+, higher is "
+          "higher detail)\n"
+          " [-n|--sends num]         sends for the send benchmark\n"
+          " [-p|--peers num]         unicast peers per send\n"
+          " [-s|--size bytes]        payload size for the send benchmark\n"
+          "\n",
+          argv[0]);
+      exit(0);
+    }
+  }
+}
+
+transport::QoSTransportSettings make_settings(
+    const std::string& self, bool batch)
+{
+  transport::QoSTransportSettings settings;
+  settings.type = transport::UDP;
+  settings.batch_datagrams = batch;
+  settings.hosts.push_back(self);
+
+  return settings;
+}
+
+/// waits up to max_wait seconds for a variable to reach a value
+bool wait_for(knowledge::KnowledgeBase& kb, const std::string& key,
+    Integer value, double max_wait)
+{
+  utility::Timer<Clock> timer;
+  timer.start();
+
+  while (kb.get(key).to_integer() < value)
+  {
+    timer.stop();
+    if (timer.duration_ds() > max_wait)
+      return false;
+
+    utility::sleep(0.0001);
+  }
+
+  return true;
+}
+
+void test_delivery(bool batch)
+{
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "Testing delivery with batch_datagrams=%d\n", (int)batch);
+
+  transport::QoSTransportSettings settings = make_settings(receiver_host, batch);
+  knowledge::KnowledgeBase receiver("", settings);
+
+  settings = make_settings(sender_host, batch);
+  settings.hosts.push_back(receiver_host);
+  knowledge::KnowledgeBase sender("", settings);
+
+  // large enough to need several fragments
+  std::vector<double> image(payload_size / sizeof(double), 1.5);
+  image.back() = 42;
+
+  sender.set("image", image, knowledge::EvalSettings::DELAY);
+  sender.set("counter", Integer(1), knowledge::EvalSettings::SEND);
+
+  TEST_EQ(wait_for(receiver, "counter", 1, 5.0), true);
+
+  knowledge::KnowledgeRecord received = receiver.get("image");
+  TEST_EQ(received.size(), image.size());
+  TEST_EQ(received.retrieve_index(image.size() - 1).to_double(), 42.0);
+
+  // small updates go out as a single datagram
+  for (Integer i = 2; i <= 10; ++i)
+  {
+    sender.set("counter", i, knowledge::EvalSettings::SEND);
+  }
+
+  TEST_EQ(wait_for(receiver, "counter", 10, 5.0), true);
+}
+
+/// sends a fragmented payload to num_peers peers num_sends times
+void benchmark_send(bool batch, double& datagrams_per_second,
+    double& cpu_ns_per_datagram)
+{
+  transport::QoSTransportSettings settings = make_settings(sender_host, batch);
+  settings.no_receiving = true;
+  settings.debug_to_kb_prefix = "send";
+
+  for (size_t i = 0; i < num_peers; ++i)
+  {
+    settings.hosts.push_back(sink_host);
+  }
+
+  knowledge::KnowledgeBase sender("", settings);
+
+  std::vector<double> image(payload_size / sizeof(double), 1.5);
+
+  std::clock_t cpu_start = std::clock();
+  utility::Timer<Clock> timer;
+  timer.start();
+
+  for (size_t i = 0; i < num_sends; ++i)
+  {
+    image[0] = (double)i + 1;
+    sender.set("image", image, knowledge::EvalSettings::SEND);
+  }
+
+  timer.stop();
+  std::clock_t cpu_end = std::clock();
+
+  Integer datagrams = sender.get("send.sent_packets").to_integer();
+  TEST_NE(datagrams, 0);
+
+  if (datagrams == 0)
+    datagrams = 1;
+
+  uint64_t elapsed_ns = timer.duration_ns();
+  if (elapsed_ns == 0)
+    elapsed_ns = 1;
+
+  datagrams_per_second = 1000000000.0 * datagrams / elapsed_ns;
+  cpu_ns_per_datagram =
+      1000000000.0 * (cpu_end - cpu_start) / CLOCKS_PER_SEC / datagrams;
+}
+
+/// delivers bursts of num_peers small datagrams to one reader
+void benchmark_receive(bool batch, double& datagrams_per_second,
+    double& cpu_ns_per_datagram)
+{
+  transport::QoSTransportSettings settings = make_settings(receiver_host, batch);
+  settings.debug_to_kb_prefix = "receive";
+  knowledge::KnowledgeBase receiver("", settings);
+
+  // every burst is sent as one batch, so only the reader differs
+  settings = make_settings(sender_host, true);
+  settings.no_receiving = true;
+
+  for (size_t i = 0; i < num_peers; ++i)
+  {
+    settings.hosts.push_back(receiver_host);
+  }
+
+  knowledge::KnowledgeBase sender("", settings);
+
+  std::clock_t cpu_start = std::clock();
+  utility::Timer<Clock> timer;
+  timer.start();
+
+  for (size_t i = 0; i < num_bursts; ++i)
+  {
+    sender.set("counter", (Integer)i + 1, knowledge::EvalSettings::SEND);
+
+    // let the reader drain the burst, so the socket buffer never overflows
+    wait_for(receiver, "receive.received_packets",
+        (Integer)((i + 1) * num_peers), 1.0);
+  }
+
+  timer.stop();
+  std::clock_t cpu_end = std::clock();
+
+  Integer datagrams = receiver.get("receive.received_packets").to_integer();
+  TEST_EQ(datagrams, (Integer)(num_bursts * num_peers));
+
+  if (datagrams == 0)
+    datagrams = 1;
+
+  uint64_t elapsed_ns = timer.duration_ns();
+  if (elapsed_ns == 0)
+    elapsed_ns = 1;
+
+  datagrams_per_second = 1000000000.0 * datagrams / elapsed_ns;
+  cpu_ns_per_datagram =
+      1000000000.0 * (cpu_end - cpu_start) / CLOCKS_PER_SEC / datagrams;
+}
+
+std::string format_result(const std::string& name, double single_rate,
+    double single_cpu, double batch_rate, double batch_cpu)
+{
+  std::stringstream buffer;
+
+  std::locale loc("C");
+  buffer.imbue(loc);
+
+  buffer << std::fixed << std::setprecision(0);
+  buffer << " " << std::left << std::setw(8) << name << std::right
+         << " per datagram " << std::setw(10) << single_rate << " dgram/s "
+         << std::setw(7) << single_cpu << " cpu ns/dgram\n";
+  buffer << " " << std::left << std::setw(8) << name << std::right
+         << " batched      " << std::setw(10) << batch_rate << " dgram/s "
+         << std::setw(7) << batch_cpu << " cpu ns/dgram";
+  buffer << std::setprecision(2) << "  (" << batch_rate / single_rate
+         << "x)\n";
+
+  return buffer.str();
+}
+
+int main(int argc, char** argv)
+{
+  handle_arguments(argc, argv);
+
+  if (num_peers == 0 || num_sends == 0 || num_bursts == 0)
+  {
+    madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+        "\nERROR: peers, sends and bursts cannot be 0\n");
+
+    exit(-1);
+  }
+
+  test_delivery(false);
+  test_delivery(true);
+
+  double single_send_rate, single_send_cpu, batch_send_rate, batch_send_cpu;
+  benchmark_send(false, single_send_rate, single_send_cpu);
+  benchmark_send(true, batch_send_rate, batch_send_cpu);
+
+  double single_recv_rate, single_recv_cpu, batch_recv_rate, batch_recv_cpu;
+  benchmark_receive(false, single_recv_rate, single_recv_cpu);
+  benchmark_receive(true, batch_recv_rate, batch_recv_cpu);
+
+  madara_logger_ptr_log(logger::global_logger.get(), logger::LOG_ALWAYS,
+      "\nLoopback datagrams (%d peers, %d byte payload):\n"
+      "========================================================================"
+      "=\n%s%s"
+      "========================================================================"
+      "=\n\n",
+      (int)num_peers, (int)payload_size,
+      format_result("send", single_send_rate, single_send_cpu,
+          batch_send_rate, batch_send_cpu)
+          .c_str(),
+      format_result("receive", single_recv_rate, single_recv_cpu,
+          batch_recv_rate, batch_recv_cpu)
+          .c_str());
+
+  if (madara_tests_fail_count > 0)
+  {
+    std::cerr << "OVERALL: FAIL. " << madara_tests_fail_count
+              << " tests failed.\n";
+  }
+  else
+  {
+    std::cerr << "OVERALL: SUCCESS.\n";
+  }
+
+  return madara_tests_fail_count;
+}
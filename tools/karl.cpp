@@ -427,6 +427,8 @@ void handle_arguments(int argc, const char** argv, size_t recursion_limit = 10)
           "checkpoint\n"
           "  [-sj|--save-json file]   save the resulting knowledge base as "
           "JSON\n"
+          "  [--shmem name]           the shared memory rings to read (first is\n"
+          "                           self to write to)\n"
           "  [-sff|--stream-from file] stream knowledge from a file\n"
           "  [-ss|--save-size bytes]  size of buffer needed for file saves\n"
           "  [-st|--save-transsport file] a file to save transport settings "
@@ -438,6 +440,9 @@ void handle_arguments(int argc, const char** argv, size_t recursion_limit = 10)
           "  [-t|--time time]         time to wait for results. Same as -w.\n"
           "  [-tdp|--transport-debug-prefix pfx] prefix in the knowledge base\n"
           "                           to save transport debug info\n"
+          "  [--tcp ip:port]          the tcp ips to connect to (first is self "
+          "to\n"
+          "                           listen on)\n"
           "  [-u|--udp ip:port]       the udp ips to send to (first is self to "
           "bind to)\n"
           "  [-w|--wait seconds]      Wait for number of seconds before "
@@ -979,6 +984,24 @@ void handle_arguments(int argc, const char** argv, size_t recursion_limit = 10)
 
       ++i;
     }
+    else if (arg1 == "--shmem")
+    {
+      if (i + 1 < argc)
+      {
+        settings.hosts.push_back(argv[i + 1]);
+        settings.type = transport::SHMEM;
+      }
+      ++i;
+    }
+    else if (arg1 == "--tcp")
+    {
+      if (i + 1 < argc)
+      {
+        settings.hosts.push_back(argv[i + 1]);
+        settings.type = transport::TCP;
+      }
+      ++i;
+    }
     else if (arg1 == "-u" || arg1 == "--udp")
     {
       if (i + 1 < argc)